@@ -69,12 +69,16 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/blackoil/blackoildarcyfluxmodule.hh
              opm/models/blackoil/blackoilratevector.hh
              opm/models/blackoil/blackoilbrinemodules.hh
+             opm/models/blackoil/blackoilcompactfluidstate.hh
+             opm/models/blackoil/blackoilenergyquantitycache.hh
+             opm/models/blackoil/blackoilrockcompactioncache.hh
              opm/models/blackoil/blackoilbrineparams.hh
              opm/models/blackoil/blackoilfoammodules.hh
              opm/models/blackoil/blackoilfoamparams.hh
              opm/models/blackoil/blackoilindices.hh
              opm/models/blackoil/blackoillocalresidual.hh
              opm/models/blackoil/blackoillocalresidualtpfa.hh
+             opm/models/blackoil/blackoiloffloadfluxkernel.hh
              opm/models/blackoil/blackoilnewtonmethod.hh
              opm/models/blackoil/blackoilonephaseindices.hh
              opm/models/blackoil/blackoilsolventmodules.hh
@@ -96,6 +100,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/common/quantitycallbacks.hh
              opm/models/common/multiphasebaseextensivequantities.hh
              opm/models/common/multiphasebaseproblem.hh
+             opm/models/common/regionalmateriallawparams.hh
              opm/models/common/diffusionmodule.hh
              opm/models/common/flux.hh
              opm/models/common/forchheimerfluxmodule.hh
@@ -113,6 +118,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/discretefracture/discretefracturelocalresidual.hh
              opm/models/discretization/vcfv/vcfvbaseoutputmodule.hh
              opm/models/discretization/vcfv/vcfvdiscretization.hh
+             opm/models/discretization/vcfv/vcfvfacetablelinearizer.hh
              opm/models/discretization/vcfv/p1fegradientcalculator.hh
              opm/models/discretization/vcfv/vcfvgridcommhandlefactory.hh
              opm/models/discretization/vcfv/vcfvproperties.hh
@@ -122,6 +128,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/discretization/common/fvbaseintensivequantities.hh
              opm/models/discretization/common/fvbaseconstraintscontext.hh
              opm/models/discretization/common/baseauxiliarymodule.hh
+             opm/models/discretization/common/basesparsesourceterm.hh
              opm/models/discretization/common/fvbaseelementcontext.hh
              opm/models/discretization/common/fvbaselocalresidual.hh
              opm/models/discretization/common/fvbasefdlocallinearizer.hh
@@ -129,9 +136,12 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/discretization/common/fvbaseadlocallinearizer.hh
              opm/models/discretization/common/fvbaseconstraints.hh
              opm/models/discretization/common/fvbaseproperties.hh
+             opm/models/discretization/common/multiratetimestepper.hh
              opm/models/discretization/common/fvbaseextensivequantities.hh
              opm/models/discretization/common/fvbaselinearizer.hh
              opm/models/discretization/common/tpfalinearizer.hh
+             opm/models/discretization/common/tpfaneighbortable.hh
+             opm/models/discretization/common/tpfaflowtable.hh
              opm/models/discretization/common/restrictprolong.hh
              opm/models/discretization/common/fvbasediscretization.hh
              opm/models/discretization/common/fvbasediscretizationfemadapt.hh
@@ -144,6 +154,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/discretization/ecfv/ecfvbaseoutputmodule.hh
              opm/models/discretization/ecfv/ecfvdiscretization.hh
              opm/models/discretization/ecfv/ecfvproperties.hh
+             opm/models/discretization/ecfv/ecfvtpfalinearizer.hh
              opm/models/flash/flashmodel.hh
              opm/models/flash/flashintensivequantities.hh
              opm/models/flash/flashindices.hh
@@ -153,6 +164,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/flash/flashprimaryvariables.hh
              opm/models/flash/flashextensivequantities.hh
              opm/models/flash/flashproperties.hh
+             opm/models/immiscible/immiscibleanalyticlocallinearizer.hh
              opm/models/immiscible/immisciblelocalresidual.hh
              opm/models/immiscible/immiscibleproperties.hh
              opm/models/immiscible/immisciblemodel.hh
@@ -164,12 +176,19 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/immiscible/immiscibleintensivequantities.hh
              opm/models/io/vtktensorfunction.hh
              opm/models/io/dgfvanguard.hh
+             opm/models/io/vtkarrayfunction.hh
              opm/models/io/vtkscalarfunction.hh
              opm/models/io/vtkenergymodule.hh
              opm/models/io/restart.hh
+             opm/models/io/sharedmemorywriter.hh
+             opm/models/io/statisticswriter.hh
+             opm/models/io/outputplan.hh
+             opm/models/io/collectivefile.hh
              opm/models/io/cubegridvanguard.hh
              opm/models/io/baseoutputwriter.hh
              opm/models/io/vtkmultiwriter.hh
+             opm/models/io/vtkappendedwriter.hh
+             opm/models/io/hdf5multiwriter.hh
              opm/models/io/vtkmultiphasemodule.hh
              opm/models/io/vtkdiscretefracturemodule.hh
              opm/models/io/vtkdiffusionmodule.hh
@@ -200,12 +219,17 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/ncp/ncplocalresidual.hh
              opm/models/ncp/ncpboundaryratevector.hh
              opm/models/nonlinear/nullconvergencewriter.hh
+             opm/models/nonlinear/newtoniterationlog.hh
              opm/models/nonlinear/newtonmethod.hh
              opm/models/nonlinear/newtonmethodproperties.hh
+             opm/models/nonlinear/nonlineardomainsolver.hh
+             opm/models/nonlinear/sequentialimplicitsolver.hh
              opm/models/parallel/mpiutil.hh
              opm/models/parallel/tasklets.hh
+             opm/models/parallel/threadloadstatistics.hh
              opm/models/parallel/threadmanager.hh
              opm/models/parallel/gridcommhandles.hh
+             opm/models/parallel/gridghostexchange.hh
              opm/models/parallel/mpibuffer.hh
              opm/models/parallel/threadedentityiterator.hh
              opm/models/pvs/pvsboundaryratevector.hh
@@ -228,7 +252,13 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/richards/richardsproperties.hh
              opm/models/richards/richardsintensivequantities.hh
              opm/models/richards/richardslocalresidual.hh
+             opm/models/richards/richardstpfalinearizer.hh
+             opm/models/utils/cellordering.hh
+             opm/models/utils/hardwarecounters.hh
              opm/models/utils/start.hh
+             opm/models/utils/explicitinstantiation.hh
+             opm/models/utils/ensemblerunner.hh
+             opm/models/utils/regionprofiler.hh
              opm/models/utils/timerguard.hh
              opm/models/utils/propertysystem.hh
              opm/models/utils/pffgridvector.hh
@@ -237,6 +267,11 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/utils/simulator.hh
              opm/models/utils/quadraturegeometries.hh
              opm/models/utils/alignedallocator.hh
+             opm/models/utils/autotuner.hh
+             opm/models/utils/memoryusage.hh
+             opm/models/utils/objectpool.hh
+             opm/models/utils/resampledtabulated1dfunction.hh
+             opm/models/utils/resampleduniformxtabulated2dfunction.hh
              opm/models/utils/timer.hh
              opm/models/utils/signum.hh
              opm/models/utils/genericguard.hh
@@ -247,28 +282,37 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/simulators/linalg/vertexborderlistfromgrid.hh
              opm/simulators/linalg/linalgproperties.hh
              opm/simulators/linalg/linearsolverreport.hh
+             opm/simulators/linalg/linearsystemio.hh
              opm/simulators/linalg/istlsparsematrixadapter.hh
              opm/simulators/linalg/istlpreconditionerwrappers.hh
              opm/simulators/linalg/residreductioncriterion.hh
+             opm/simulators/linalg/ruizequilibration.hh
              opm/simulators/linalg/overlappingbcrsmatrix.hh
              opm/simulators/linalg/blacklist.hh
              opm/simulators/linalg/parallelbasebackend.hh
              opm/simulators/linalg/overlappingblockvector.hh
              opm/simulators/linalg/parallelbicgstabbackend.hh
              opm/simulators/linalg/nullborderlistmanager.hh
+             opm/simulators/linalg/offloadbicgstabbackend.hh
              opm/simulators/linalg/overlappingoperator.hh
              opm/simulators/linalg/elementborderlistfromgrid.hh
              opm/simulators/linalg/combinedcriterion.hh
              opm/simulators/linalg/bicgstabsolver.hh
+             opm/simulators/linalg/fgmressolver.hh
+             opm/simulators/linalg/parallelfgmresbackend.hh
+             opm/simulators/linalg/blockspmv.hh
              opm/simulators/linalg/globalindices.hh
              opm/simulators/linalg/superlubackend.hh
              opm/simulators/linalg/matrixblock.hh
+             opm/simulators/linalg/mixedprecisionpreconditioner.hh
              opm/simulators/linalg/istlsolverwrappers.hh
              opm/simulators/linalg/overlaptypes.hh
              opm/simulators/linalg/overlappingpreconditioner.hh
+             opm/simulators/linalg/overlappingcoarsespace.hh
              opm/simulators/linalg/domesticoverlapfrombcrsmatrix.hh
              opm/simulators/linalg/fixpointcriterion.hh
              opm/simulators/linalg/parallelamgbackend.hh
+             opm/simulators/linalg/parallelilu0.hh
              opm/simulators/linalg/foreignoverlapfrombcrsmatrix.hh
              opm/simulators/linalg/overlappingscalarproduct.hh
              opm/simulators/linalg/convergencecriterion.hh)
@@ -0,0 +1,162 @@
+#! /bin/bash
+#
+# Runs a simulator for a matrix of MPI process counts, thread counts and
+# grid refinements and collects the timing report of each run into a
+# CSV file.
+#
+# Usage:
+#
+# runscaling.sh [OPTIONS] BINARY [SIMULATOR_ARGS]
+#
+
+usage() {
+    echo "Usage:"
+    echo
+    echo "runscaling.sh [OPTIONS] BINARY [SIMULATOR_ARGS]"
+    echo
+    echo "Options:"
+    echo "  --ranks=\"LIST\"        MPI process counts (default: \"1\")"
+    echo "  --threads=\"LIST\"      threads per process (default: \"1\")"
+    echo "  --refinements=\"LIST\"  global grid refinements (default: \"0\")"
+    echo "  --dim=DIM             dimension of the grid, used to compute the work of"
+    echo "                        a refinement (default: 2)"
+    echo "  --output=FILE         name of the report (default: scaling.csv)"
+    echo
+    echo "The strong scaling efficiency of a run is relative to the run with one"
+    echo "process and one thread on the same grid. The weak scaling efficiency is"
+    echo "relative to the run with one process and one thread on the coarsest grid,"
+    echo "assuming that each refinement increases the work by a factor of 2^DIM."
+};
+
+RANKS="1"
+THREADS="1"
+REFINEMENTS="0"
+DIM="2"
+OUTPUT="scaling.csv"
+
+while test "$#" -gt 0; do
+    case "$1" in
+        --ranks=*)
+            RANKS="${1/--ranks=/}"
+            ;;
+        --threads=*)
+            THREADS="${1/--threads=/}"
+            ;;
+        --refinements=*)
+            REFINEMENTS="${1/--refinements=/}"
+            ;;
+        --dim=*)
+            DIM="${1/--dim=/}"
+            ;;
+        --output=*)
+            OUTPUT="${1/--output=/}"
+            ;;
+        --help|-h)
+            usage
+            exit 0
+            ;;
+        *)
+            break
+            ;;
+    esac
+    shift
+done
+
+if test "$#" -lt 1; then
+    echo "No simulator binary specified"
+    echo
+    usage
+    exit 1
+fi
+
+BINARY="$1"
+shift
+SIM_ARGS="$@"
+
+if ! test -x "$BINARY"; then
+    echo "$BINARY does not exist or is not executable"
+    exit 1
+fi
+
+# extract the number of seconds of a line of the timing report
+getTime()
+{
+    grep "^ *$1:" "$2" | head -n1 | sed "s/^ *$1: *\([^ ]*\) seconds.*/\1/"
+}
+
+RND="$RANDOM"
+RAW_FILE="scaling-$RND.raw"
+rm -f "$RAW_FILE"
+
+for REFINEMENT in $REFINEMENTS; do
+    for NUM_RANKS in $RANKS; do
+        for NUM_THREADS in $THREADS; do
+            LOG_FILE="scaling-$RND.log"
+            ARGS="--threads-per-process=$NUM_THREADS --grid-global-refinements=$REFINEMENT --enable-vtk-output=false $SIM_ARGS"
+            if test "$NUM_RANKS" = "1"; then
+                CMD="$BINARY $ARGS"
+            else
+                CMD="mpirun -np $NUM_RANKS $BINARY $ARGS"
+            fi
+
+            echo "executing \"$CMD\""
+            $CMD > "$LOG_FILE" 2>&1
+            RET="$?"
+            if test "$RET" != "0"; then
+                echo "Executing the binary failed! The output was:"
+                cat "$LOG_FILE"
+                rm -f "$LOG_FILE" "$RAW_FILE"
+                exit 1
+            fi
+
+            SETUP=$(getTime "Setup time" "$LOG_FILE")
+            TOTAL=$(getTime "Simulation time" "$LOG_FILE")
+            LINEARIZE=$(getTime "Linearization time" "$LOG_FILE")
+            SOLVE=$(getTime "Linear solve time" "$LOG_FILE")
+            UPDATE=$(getTime "Newton update time" "$LOG_FILE")
+            WRITE=$(getTime "Output write time" "$LOG_FILE")
+            NUM_TIMESTEPS=$(grep "Time step [0-9]* done" "$LOG_FILE" | wc -l | tr -d '[:space:]')
+            rm -f "$LOG_FILE"
+
+            if test -z "$TOTAL"; then
+                echo "The output of the simulator does not contain a timing report"
+                rm -f "$RAW_FILE"
+                exit 1
+            fi
+
+            echo "$REFINEMENT $NUM_RANKS $NUM_THREADS $NUM_TIMESTEPS $SETUP $TOTAL $LINEARIZE $SOLVE $UPDATE $WRITE" >> "$RAW_FILE"
+        done
+    done
+done
+
+# compute the efficiencies and write the report
+awk -v dim="$DIM" '
+    {
+        n++
+        ref[n] = $1; ranks[n] = $2; threads[n] = $3; line[n] = $0; total[n] = $6
+        if ($2*$3 == 1 && !($1 in serial))
+            serial[$1] = $6
+        if (n == 1 || $1 < coarsest)
+            coarsest = $1
+    }
+    END {
+        print "refinements,ranks,threads,cores,timeSteps,setupTime,simulationTime," \
+              "linearizeTime,solveTime,updateTime,writeTime,strongEfficiency,weakEfficiency"
+        for (i = 1; i <= n; i++) {
+            split(line[i], f, " ")
+            cores = ranks[i]*threads[i]
+            strong = ""
+            if (ref[i] in serial)
+                strong = serial[ref[i]]/(cores*total[i])
+            weak = ""
+            if (coarsest in serial)
+                weak = serial[coarsest]*2^(dim*(ref[i] - coarsest))/(cores*total[i])
+            print f[1] "," f[2] "," f[3] "," cores "," f[4] "," f[5] "," f[6] "," \
+                  f[7] "," f[8] "," f[9] "," f[10] "," strong "," weak
+        }
+    }' "$RAW_FILE" > "$OUTPUT"
+rm -f "$RAW_FILE"
+
+echo "Wrote the scaling report to '$OUTPUT':"
+cat "$OUTPUT"
+exit 0
@@ -297,8 +297,8 @@ public:
         return static_cast<Scalar>(0.0);
     }
 
-    template <class DofEntity>
-    static void serializeEntity(const Model& model, std::ostream& outstream, const DofEntity& dof)
+    template <class OutStream, class DofEntity>
+    static void serializeEntity(const Model& model, OutStream& outstream, const DofEntity& dof)
     {
         if constexpr (enableBrine) {
             unsigned dofIdx = model.dofMapper().index(dof);
@@ -307,8 +307,8 @@ public:
         }
     }
 
-    template <class DofEntity>
-    static void deserializeEntity(Model& model, std::istream& instream, const DofEntity& dof)
+    template <class InStream, class DofEntity>
+    static void deserializeEntity(Model& model, InStream& instream, const DofEntity& dof)
     {
         if constexpr (enableBrine) {
             unsigned dofIdx = model.dofMapper().index(dof);
@@ -479,11 +479,24 @@ public:
                                [[maybe_unused]] unsigned timeIdx)
     {
         if constexpr (enableSaltPrecipitation) {
-            const Evaluation porosityFactor  = min(1.0 - saltSaturation(), 1.0); //phi/phi_0
-
             const auto& permfactTable = BrineModule::permfactTable(elemCtx, dofIdx, timeIdx);
 
-            permFactor_ = permfactTable.eval(porosityFactor);
+            const PrimaryVariables& priVars = elemCtx.primaryVars(dofIdx, timeIdx);
+            if (priVars.primaryVarsMeaningBrine() != PrimaryVariables::BrineMeaning::Sp) {
+                // the brine is undersaturated, i.e., no salt has precipitated and the
+                // permeability multiplier does not depend on the primary variables. We
+                // thus avoid to evaluate the table with derivatives and leave the
+                // mobilities alone if the multiplier is unity.
+                const Scalar permFactor = permfactTable.eval(Scalar{1.0});
+                permFactor_ = permFactor;
+                if (permFactor == 1.0)
+                    return;
+            }
+            else {
+                const Evaluation porosityFactor  = min(1.0 - saltSaturation(), 1.0); //phi/phi_0
+                permFactor_ = permfactTable.eval(porosityFactor);
+            }
+
             for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
                 if (!FluidSystem::phaseIsActive(phaseIdx))
                     continue;
@@ -0,0 +1,349 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::BlackOilCompactFluidState
+ */
+#ifndef EWOMS_BLACK_OIL_COMPACT_FLUID_STATE_HH
+#define EWOMS_BLACK_OIL_COMPACT_FLUID_STATE_HH
+
+#include <opm/material/common/ConditionalStorage.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/Valgrind.hpp>
+#include <opm/material/fluidstates/BlackOilFluidState.hpp>
+
+#include <array>
+#include <cassert>
+#include <type_traits>
+#include <utility>
+
+namespace Opm {
+
+/*!
+ * \ingroup BlackOilModel
+ *
+ * \brief A fluid state for the intensive quantities of the black-oil model which only
+ *        stores the quantities read by the storage and flux terms.
+ *
+ * These are the pressures, saturations, inverse formation volume factors and
+ * densities of the phases, the dissolution factors, the salt concentration and
+ * saturation, the phase enthalpies and the temperature. If the energy equation is
+ * disabled, the temperature does not depend on the primary variables and it is thus
+ * stored without derivatives. Nothing else is stored, so code which relies on
+ * further quantities, e.g. the capillary pressures, does not compile with this fluid
+ * state.
+ *
+ * The quantities which are derived from the stored ones, like mole fractions and
+ * viscosities, are only needed for output. They are computed using a temporary
+ * BlackOilFluidState, i.e., they are expensive.
+ */
+template <class ValueType,
+          class FluidSystem,
+          bool enableTemperature,
+          bool enableEnergy,
+          bool enableDissolution,
+          bool enableVapwat,
+          bool enableBrine,
+          bool enableSaltPrecipitation,
+          bool enableDissolutionInWater,
+          unsigned numStoragePhases>
+class BlackOilCompactFluidState
+{
+    using RawScalar = std::remove_cv_t<
+        std::remove_reference_t<decltype(scalarValue(std::declval<ValueType>()))>>;
+
+public:
+    using Scalar = ValueType;
+    using FullFluidState = BlackOilFluidState<ValueType,
+                                              FluidSystem,
+                                              enableTemperature,
+                                              enableEnergy,
+                                              enableDissolution,
+                                              enableVapwat,
+                                              enableBrine,
+                                              enableSaltPrecipitation,
+                                              enableDissolutionInWater,
+                                              numStoragePhases>;
+
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+
+    /*!
+     * \brief Make sure that all attributes are defined.
+     *
+     * This method does not do anything if the program is not run
+     * under valgrind. If it is, then valgrind will print an error
+     * message if some attributes of the object have not been properly
+     * defined.
+     */
+    void checkDefined() const
+    {
+#ifndef NDEBUG
+        Valgrind::CheckDefined(pvtRegionIdx_);
+        for (unsigned storagePhaseIdx = 0; storagePhaseIdx < numStoragePhases; ++storagePhaseIdx) {
+            Valgrind::CheckDefined(pressure_[storagePhaseIdx]);
+            Valgrind::CheckDefined(saturation_[storagePhaseIdx]);
+            Valgrind::CheckDefined(invB_[storagePhaseIdx]);
+            Valgrind::CheckDefined(density_[storagePhaseIdx]);
+        }
+#endif
+    }
+
+    /*!
+     * \brief Retrieve all parameters from an arbitrary fluid state.
+     */
+    template <class FluidState>
+    void assign(const FluidState& fs)
+    {
+        FullFluidState fullFs;
+        fullFs.assign(fs);
+
+        setPvtRegionIndex(fullFs.pvtRegionIndex());
+        if constexpr (enableTemperature || enableEnergy)
+            setTemperature(fullFs.temperature(/*phaseIdx=*/0));
+        if constexpr (enableDissolution) {
+            setRs(fullFs.Rs());
+            setRv(fullFs.Rv());
+        }
+        if constexpr (enableVapwat)
+            setRvw(fullFs.Rvw());
+        if constexpr (enableDissolutionInWater)
+            setRsw(fullFs.Rsw());
+        if constexpr (enableBrine)
+            setSaltConcentration(fullFs.saltConcentration());
+        if constexpr (enableSaltPrecipitation)
+            setSaltSaturation(fullFs.saltSaturation());
+
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!FluidSystem::phaseIsActive(phaseIdx))
+                continue;
+
+            setPressure(phaseIdx, fullFs.pressure(phaseIdx));
+            setSaturation(phaseIdx, fullFs.saturation(phaseIdx));
+            setInvB(phaseIdx, fullFs.invB(phaseIdx));
+            setDensity(phaseIdx, fullFs.density(phaseIdx));
+            if constexpr (enableEnergy)
+                setEnthalpy(phaseIdx, fullFs.enthalpy(phaseIdx));
+        }
+    }
+
+    void setPvtRegionIndex(unsigned newPvtRegionIdx)
+    { pvtRegionIdx_ = static_cast<unsigned short>(newPvtRegionIdx); }
+
+    void setPressure(unsigned phaseIdx, const Scalar& p)
+    { pressure_[canonicalToStoragePhaseIndex_(phaseIdx)] = p; }
+
+    void setSaturation(unsigned phaseIdx, const Scalar& S)
+    { saturation_[canonicalToStoragePhaseIndex_(phaseIdx)] = S; }
+
+    void setTemperature(const Scalar& value)
+    {
+        assert(enableTemperature || enableEnergy);
+        if constexpr (enableEnergy)
+            *temperature_ = value;
+        else if constexpr (enableTemperature)
+            *temperature_ = scalarValue(value);
+    }
+
+    void setEnthalpy(unsigned phaseIdx, const Scalar& value)
+    {
+        assert(enableEnergy);
+        (*enthalpy_)[canonicalToStoragePhaseIndex_(phaseIdx)] = value;
+    }
+
+    void setInvB(unsigned phaseIdx, const Scalar& b)
+    { invB_[canonicalToStoragePhaseIndex_(phaseIdx)] = b; }
+
+    void setDensity(unsigned phaseIdx, const Scalar& rho)
+    { density_[canonicalToStoragePhaseIndex_(phaseIdx)] = rho; }
+
+    void setRs(const Scalar& newRs)
+    { *Rs_ = newRs; }
+
+    void setRv(const Scalar& newRv)
+    { *Rv_ = newRv; }
+
+    void setRvw(const Scalar& newRvw)
+    { *Rvw_ = newRvw; }
+
+    void setRsw(const Scalar& newRsw)
+    { *Rsw_ = newRsw; }
+
+    void setSaltConcentration(const Scalar& newSaltConcentration)
+    { *saltConcentration_ = newSaltConcentration; }
+
+    void setSaltSaturation(const Scalar& newSaltSaturation)
+    { *saltSaturation_ = newSaltSaturation; }
+
+    unsigned short pvtRegionIndex() const
+    { return pvtRegionIdx_; }
+
+    const Scalar& pressure(unsigned phaseIdx) const
+    { return pressure_[canonicalToStoragePhaseIndex_(phaseIdx)]; }
+
+    const Scalar& saturation(unsigned phaseIdx) const
+    { return saturation_[canonicalToStoragePhaseIndex_(phaseIdx)]; }
+
+    Scalar temperature(unsigned) const
+    {
+        if constexpr (enableTemperature || enableEnergy)
+            return *temperature_;
+        else
+            return FluidSystem::reservoirTemperature(pvtRegionIdx_);
+    }
+
+    const Scalar& enthalpy(unsigned phaseIdx) const
+    { return (*enthalpy_)[canonicalToStoragePhaseIndex_(phaseIdx)]; }
+
+    Scalar internalEnergy(unsigned phaseIdx) const
+    { return enthalpy(phaseIdx) - pressure(phaseIdx)/density(phaseIdx); }
+
+    const Scalar& invB(unsigned phaseIdx) const
+    { return invB_[canonicalToStoragePhaseIndex_(phaseIdx)]; }
+
+    const Scalar& density(unsigned phaseIdx) const
+    { return density_[canonicalToStoragePhaseIndex_(phaseIdx)]; }
+
+    const Scalar& Rs() const
+    {
+        if constexpr (enableDissolution)
+            return *Rs_;
+        else
+            return zero_();
+    }
+
+    const Scalar& Rv() const
+    {
+        if constexpr (enableDissolution)
+            return *Rv_;
+        else
+            return zero_();
+    }
+
+    const Scalar& Rvw() const
+    {
+        if constexpr (enableVapwat)
+            return *Rvw_;
+        else
+            return zero_();
+    }
+
+    const Scalar& Rsw() const
+    {
+        if constexpr (enableDissolutionInWater)
+            return *Rsw_;
+        else
+            return zero_();
+    }
+
+    const Scalar& saltConcentration() const
+    {
+        if constexpr (enableBrine)
+            return *saltConcentration_;
+        else
+            return zero_();
+    }
+
+    const Scalar& saltSaturation() const
+    {
+        if constexpr (enableSaltPrecipitation)
+            return *saltSaturation_;
+        else
+            return zero_();
+    }
+
+    /*!
+     * \brief Returns a fluid state which provides all quantities of the black-oil model.
+     *
+     * This is expensive and should only be used for output.
+     */
+    FullFluidState fullFluidState() const
+    {
+        FullFluidState fs;
+        fs.assign(*this);
+        return fs;
+    }
+
+    Scalar viscosity(unsigned phaseIdx) const
+    { return fullFluidState().viscosity(phaseIdx); }
+
+    Scalar moleFraction(unsigned phaseIdx, unsigned compIdx) const
+    { return fullFluidState().moleFraction(phaseIdx, compIdx); }
+
+    Scalar massFraction(unsigned phaseIdx, unsigned compIdx) const
+    { return fullFluidState().massFraction(phaseIdx, compIdx); }
+
+    Scalar molarity(unsigned phaseIdx, unsigned compIdx) const
+    { return fullFluidState().molarity(phaseIdx, compIdx); }
+
+    Scalar molarDensity(unsigned phaseIdx) const
+    { return fullFluidState().molarDensity(phaseIdx); }
+
+    Scalar molarVolume(unsigned phaseIdx) const
+    { return fullFluidState().molarVolume(phaseIdx); }
+
+    Scalar averageMolarMass(unsigned phaseIdx) const
+    { return fullFluidState().averageMolarMass(phaseIdx); }
+
+    Scalar fugacity(unsigned phaseIdx, unsigned compIdx) const
+    { return fullFluidState().fugacity(phaseIdx, compIdx); }
+
+    Scalar fugacityCoefficient(unsigned phaseIdx, unsigned compIdx) const
+    { return fullFluidState().fugacityCoefficient(phaseIdx, compIdx); }
+
+private:
+    static unsigned canonicalToStoragePhaseIndex_(unsigned phaseIdx)
+    {
+        if constexpr (numStoragePhases == static_cast<unsigned>(numPhases))
+            return phaseIdx;
+        else
+            return FluidSystem::canonicalToActivePhaseIdx(phaseIdx);
+    }
+
+    static const Scalar& zero_()
+    {
+        static const Scalar zero = 0.0;
+        return zero;
+    }
+
+    using TemperatureType = std::conditional_t<enableEnergy, Scalar, RawScalar>;
+
+    std::array<Scalar, numStoragePhases> pressure_;
+    std::array<Scalar, numStoragePhases> saturation_;
+    std::array<Scalar, numStoragePhases> invB_;
+    std::array<Scalar, numStoragePhases> density_;
+    ConditionalStorage<enableEnergy, std::array<Scalar, numStoragePhases>> enthalpy_;
+    ConditionalStorage<enableTemperature || enableEnergy, TemperatureType> temperature_;
+    ConditionalStorage<enableDissolution, Scalar> Rs_;
+    ConditionalStorage<enableDissolution, Scalar> Rv_;
+    ConditionalStorage<enableVapwat, Scalar> Rvw_;
+    ConditionalStorage<enableDissolutionInWater, Scalar> Rsw_;
+    ConditionalStorage<enableBrine, Scalar> saltConcentration_;
+    ConditionalStorage<enableSaltPrecipitation, Scalar> saltSaturation_;
+    unsigned short pvtRegionIdx_ = 0;
+};
+
+} // namespace Opm
+
+#endif
@@ -360,24 +360,22 @@ protected:
             return;
         }
         const auto& problem = elemCtx.simulator().problem();
-        if (problem.model().linearizer().getVelocityInfo().empty()) {
+        const auto& cellNormVelocity = problem.model().linearizer().getCellNormVelocity();
+        if (cellNormVelocity.empty()) {
             return;
         }
+        // the linearizer already reduced the face velocities of the cell to their maxima
         const std::array<int, 3> phaseIdxs = { gasPhaseIdx, oilPhaseIdx, waterPhaseIdx };
         const std::array<int, 3> compIdxs = { gasCompIdx, oilCompIdx, waterCompIdx };
-        const auto& velocityInf = problem.model().linearizer().getVelocityInfo();
         unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
-        auto velocityInfos = velocityInf[globalDofIdx];
+        const auto& normVelocity = cellNormVelocity[globalDofIdx];
         for (unsigned i = 0; i < phaseIdxs.size(); ++i) {
             normVelocityCell_[i] = 0;
         }
-        for (auto& velocityInfo : velocityInfos) {
-            for (unsigned i = 0; i < phaseIdxs.size(); ++i) {
-                if (FluidSystem::phaseIsActive(phaseIdxs[i])) {
-                    normVelocityCell_[phaseIdxs[i]] = max( normVelocityCell_[phaseIdxs[i]], 
-                        std::abs( velocityInfo.velocity[conti0EqIdx
-                            + Indices::canonicalToActiveComponentIndex(compIdxs[i])] ));
-                }
+        for (unsigned i = 0; i < phaseIdxs.size(); ++i) {
+            if (FluidSystem::phaseIsActive(phaseIdxs[i])) {
+                normVelocityCell_[phaseIdxs[i]] =
+                    normVelocity[conti0EqIdx + Indices::canonicalToActiveComponentIndex(compIdxs[i])];
             }
         }
     }
@@ -29,6 +29,7 @@
 #define EWOMS_BLACK_OIL_ENERGY_MODULE_HH
 
 #include "blackoilproperties.hh"
+#include "blackoilenergyquantitycache.hh"
 #include <opm/models/io/vtkblackoilenergymodule.hh>
 #include <opm/models/common/quantitycallbacks.hh>
 #include <opm/models/discretization/common/linearizationtype.hh>
@@ -40,6 +41,7 @@
 #include <dune/common/fvector.hh>
 
 #include <string>
+#include <type_traits>
 
 namespace Opm {
 /*!
@@ -76,8 +78,15 @@ public:
      */
     static void registerParameters()
     {
-        if constexpr (enableEnergy)
+        if constexpr (enableEnergy) {
             VtkBlackOilEnergyModule<TypeTag>::registerParameters();
+
+            Parameters::registerParam<TypeTag, Properties::EnergyQuantityReuseTolerance>
+                ("The maximum change of the temperature [K] of a cell since the last "
+                 "complete evaluation of its enthalpies, rock internal energy and thermal "
+                 "conductivity for which these are extrapolated linearly instead. Zero "
+                 "disables the extrapolation");
+        }
     }
 
     /*!
@@ -295,8 +304,8 @@ public:
         return std::abs(scalarValue(resid[contiEnergyEqIdx]));
     }
 
-    template <class DofEntity>
-    static void serializeEntity(const Model& model, std::ostream& outstream, const DofEntity& dof)
+    template <class OutStream, class DofEntity>
+    static void serializeEntity(const Model& model, OutStream& outstream, const DofEntity& dof)
     {
         if constexpr (enableEnergy) {
             unsigned dofIdx = model.dofMapper().index(dof);
@@ -305,8 +314,8 @@ public:
         }
     }
 
-    template <class DofEntity>
-    static void deserializeEntity(Model& model, std::istream& instream, const DofEntity& dof)
+    template <class InStream, class DofEntity>
+    static void deserializeEntity(Model& model, InStream& instream, const DofEntity& dof)
     {
         if constexpr (enableEnergy) {
             unsigned dofIdx = model.dofMapper().index(dof);
@@ -344,6 +353,8 @@ class BlackOilEnergyIntensiveQuantities
     using Problem = GetPropType<TypeTag, Properties::Problem>;
 
     using EnergyModule = BlackOilEnergyModule<TypeTag>;
+    using EnergyQuantityCache = BlackOilEnergyQuantityCache<Scalar, Evaluation, PrimaryVariables,
+                                                            getPropValue<TypeTag, Properties::NumPhases>()>;
 
     enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
     static constexpr int temperatureIdx = Indices::temperatureIdx;
@@ -391,6 +402,47 @@ public:
     {
         auto& fs = asImp_().fluidState_;
 
+        // Retrieve the rock fraction from the problem
+        // Usually 1 - porosity, but if pvmult is used to modify porosity
+        // we will apply the same multiplier to the rock fraction
+        // i.e. pvmult*(1 - porosity) and thus interpret multpv as a volume
+        // multiplier. This is to avoid negative rock volume for pvmult*porosity > 1
+        const unsigned cell_idx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
+        rockFraction_ = elemCtx.problem().rockFraction(cell_idx, timeIdx);
+
+        // the derivatives of the stored quantities are only meaningful for the
+        // variables of the current linearization. Also, each entry may only be
+        // accessed by a single thread, which is only guaranteed if every element
+        // exclusively owns its primary degree of freedom (i.e., for the ECFV
+        // discretization)
+        typename EnergyQuantityCache::Entry* cacheEntry = nullptr;
+        if constexpr (!std::is_same_v<Evaluation, Scalar>) {
+            auto* cache = elemCtx.model().energyQuantityCache();
+            if (cache && timeIdx == 0 && elemCtx.linearizationType().time == 0
+                && dofIdx == 0 && elemCtx.numPrimaryDof(timeIdx) == 1)
+            {
+                cacheEntry = &cache->entry(cell_idx);
+                const PrimaryVariables& priVars = elemCtx.primaryVars(dofIdx, timeIdx);
+                if (cache->isApplicable(*cacheEntry, priVars, temperatureIdx)) {
+                    const PrimaryVariables& ref = cacheEntry->priVars;
+                    for (int phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+                        if (!FluidSystem::phaseIsActive(phaseIdx)) {
+                            continue;
+                        }
+
+                        fs.setEnthalpy(phaseIdx,
+                                       EnergyQuantityCache::extrapolate(cacheEntry->enthalpy[phaseIdx],
+                                                                        ref, priVars));
+                    }
+                    rockInternalEnergy_ =
+                        EnergyQuantityCache::extrapolate(cacheEntry->rockInternalEnergy, ref, priVars);
+                    totalThermalConductivity_ =
+                        EnergyQuantityCache::extrapolate(cacheEntry->totalThermalConductivity, ref, priVars);
+                    return;
+                }
+            }
+        }
+
         // compute the specific enthalpy of the fluids, the specific enthalpy of the rock
         // and the thermal condictivity coefficients
         for (int phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
@@ -408,13 +460,17 @@ public:
         const auto& thermalConductionLawParams = elemCtx.problem().thermalConductionLawParams(elemCtx, dofIdx, timeIdx);
         totalThermalConductivity_ = ThermalConductionLaw::thermalConductivity(thermalConductionLawParams, fs);
 
-        // Retrieve the rock fraction from the problem
-        // Usually 1 - porosity, but if pvmult is used to modify porosity
-        // we will apply the same multiplier to the rock fraction
-        // i.e. pvmult*(1 - porosity) and thus interpret multpv as a volume
-        // multiplier. This is to avoid negative rock volume for pvmult*porosity > 1
-        const unsigned cell_idx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
-        rockFraction_ = elemCtx.problem().rockFraction(cell_idx, timeIdx);
+        if (cacheEntry) {
+            cacheEntry->priVars = elemCtx.primaryVars(dofIdx, timeIdx);
+            for (int phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+                if (FluidSystem::phaseIsActive(phaseIdx)) {
+                    cacheEntry->enthalpy[phaseIdx] = fs.enthalpy(phaseIdx);
+                }
+            }
+            cacheEntry->rockInternalEnergy = rockInternalEnergy_;
+            cacheEntry->totalThermalConductivity = totalThermalConductivity_;
+            cacheEntry->valid = true;
+        }
     }
 
     const Evaluation& rockInternalEnergy() const
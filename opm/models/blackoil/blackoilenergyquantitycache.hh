@@ -0,0 +1,137 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::BlackOilEnergyQuantityCache
+ */
+#ifndef EWOMS_BLACK_OIL_ENERGY_QUANTITY_CACHE_HH
+#define EWOMS_BLACK_OIL_ENERGY_QUANTITY_CACHE_HH
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup BlackOil
+ *
+ * \brief Stores the energy related intensive quantities of the last complete
+ *        evaluation of each degree of freedom.
+ *
+ * If the temperature of a degree of freedom changed by less than a tolerance since
+ * the last complete evaluation, the phase enthalpies, the internal energy of the rock
+ * and the thermal conductivity are extrapolated linearly from the stored values
+ * using their derivatives with regard to the primary variables. The derivatives
+ * themselves are those of the stored evaluation.
+ *
+ * The entries are not protected against concurrent accesses, i.e., each entry must
+ * only be used by the thread which linearizes the degree of freedom.
+ */
+template <class Scalar, class Evaluation, class PrimaryVariables, unsigned numPhases>
+class BlackOilEnergyQuantityCache
+{
+public:
+    struct Entry
+    {
+        PrimaryVariables priVars;
+        std::array<Evaluation, numPhases> enthalpy;
+        Evaluation rockInternalEnergy;
+        Evaluation totalThermalConductivity;
+        bool valid = false;
+    };
+
+    BlackOilEnergyQuantityCache(Scalar temperatureTolerance = 0.0)
+        : temperatureTolerance_(temperatureTolerance)
+    {}
+
+    /*!
+     * \brief Discard all entries and allocate storage for a given number of degrees
+     *        of freedom.
+     */
+    void resize(std::size_t numDof)
+    {
+        entries_.clear();
+        entries_.resize(numDof);
+    }
+
+    /*!
+     * \brief Returns the entry of a degree of freedom.
+     */
+    Entry& entry(std::size_t dofIdx)
+    { return entries_[dofIdx]; }
+
+    /*!
+     * \brief Returns true if the energy quantities of an entry may be extrapolated to
+     *        a given set of primary variables.
+     *
+     * This requires the meanings of the primary variables and the PVT region to be
+     * unchanged and the temperature to differ by at most the tolerance.
+     */
+    bool isApplicable(const Entry& entry,
+                      const PrimaryVariables& priVars,
+                      unsigned temperatureIdx) const
+    {
+        if (!entry.valid)
+            return false;
+
+        const PrimaryVariables& ref = entry.priVars;
+        if (priVars.primaryVarsMeaningWater() != ref.primaryVarsMeaningWater()
+            || priVars.primaryVarsMeaningPressure() != ref.primaryVarsMeaningPressure()
+            || priVars.primaryVarsMeaningGas() != ref.primaryVarsMeaningGas()
+            || priVars.primaryVarsMeaningBrine() != ref.primaryVarsMeaningBrine()
+            || priVars.primaryVarsMeaningSolvent() != ref.primaryVarsMeaningSolvent()
+            || priVars.pvtRegionIndex() != ref.pvtRegionIndex())
+        {
+            return false;
+        }
+
+        return std::abs(priVars[temperatureIdx] - ref[temperatureIdx]) <= temperatureTolerance_;
+    }
+
+    /*!
+     * \brief Extrapolate a stored quantity linearly to a given set of primary
+     *        variables.
+     */
+    static Evaluation extrapolate(const Evaluation& stored,
+                                  const PrimaryVariables& ref,
+                                  const PrimaryVariables& priVars)
+    {
+        Evaluation result = stored;
+        Scalar value = stored.value();
+        for (unsigned pvIdx = 0; pvIdx < priVars.size(); ++pvIdx)
+            value += stored.derivative(pvIdx)*(priVars[pvIdx] - ref[pvIdx]);
+        result.setValue(value);
+        return result;
+    }
+
+private:
+    Scalar temperatureTolerance_;
+    std::vector<Entry> entries_;
+};
+
+} // namespace Opm
+
+#endif
@@ -34,6 +34,7 @@
 
 #include "blackoilproperties.hh"
 
+#include <opm/models/utils/parametersystem.hh>
 #include <opm/models/blackoil/blackoilextboparams.hh>
 
 //#include <opm/models/io/vtkBlackOilExtboModule.hh> //TODO: Missing ...
@@ -252,6 +253,10 @@ public:
         }
         else
            throw std::runtime_error("Extbo:  kw SDENSITY is missing or not aligned with NTPVT\n");
+
+        const Scalar resamplingTolerance = Parameters::get<TypeTag, Properties::TableResamplingTolerance>();
+        if (resamplingTolerance > 0.0)
+            params_.resampleTables(resamplingTolerance);
     }
 #endif
 
@@ -447,8 +452,8 @@ public:
         return std::abs(Toolbox::scalarValue(resid[contiZfracEqIdx]));
     }
 
-    template <class DofEntity>
-    static void serializeEntity(const Model& model, std::ostream& outstream, const DofEntity& dof)
+    template <class OutStream, class DofEntity>
+    static void serializeEntity(const Model& model, OutStream& outstream, const DofEntity& dof)
     {
         if constexpr (enableExtbo) {
             unsigned dofIdx = model.dofMapper().index(dof);
@@ -458,8 +463,8 @@ public:
         }
     }
 
-    template <class DofEntity>
-    static void deserializeEntity(Model& model, std::istream& instream, const DofEntity& dof)
+    template <class InStream, class DofEntity>
+    static void deserializeEntity(Model& model, InStream& instream, const DofEntity& dof)
     {
         if constexpr (enableExtbo) {
             unsigned dofIdx = model.dofMapper().index(dof);
@@ -33,7 +33,8 @@
 #define EWOMS_BLACK_OIL_EXTBO_PARAMS_HH
 
 #include <opm/material/common/Tabulated1DFunction.hpp>
-#include <opm/material/common/UniformXTabulated2DFunction.hpp>
+
+#include <opm/models/utils/resampleduniformxtabulated2dfunction.hh>
 
 #include <vector>
 
@@ -43,7 +44,7 @@ namespace Opm {
 template<class Scalar>
 struct BlackOilExtboParams {
     using TabulatedFunction = Tabulated1DFunction<Scalar>;
-    using Tabulated2DFunction = UniformXTabulated2DFunction<Scalar>;
+    using Tabulated2DFunction = ResampledUniformXTabulated2DFunction<Scalar>;
 
     std::vector<Tabulated2DFunction> X_;
     std::vector<Tabulated2DFunction> Y_;
@@ -61,6 +62,21 @@ struct BlackOilExtboParams {
     std::vector<Scalar> zLim_;
     std::vector<TabulatedFunction> oilCmp_;
     std::vector<TabulatedFunction> gasCmp_;
+
+    /*!
+     * \brief Resample the two-dimensional PVTSOL tables on regular grids.
+     *
+     * Tables which cannot be resampled to the given relative tolerance are kept.
+     */
+    void resampleTables(Scalar tolerance)
+    {
+        for (auto* tables : { &X_, &Y_, &PBUB_RS_, &PBUB_RV_, &VISCO_,
+                              &VISCG_, &BO_, &BG_, &RS_, &RV_ })
+        {
+            for (auto& table : *tables)
+                table.resample(tolerance);
+        }
+    }
 };
 
 } // namespace Opm
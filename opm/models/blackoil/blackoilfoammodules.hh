@@ -367,9 +367,9 @@ public:
         return static_cast<Scalar>(0.0);
     }
 
-    template <class DofEntity>
+    template <class OutStream, class DofEntity>
     static void serializeEntity([[maybe_unused]] const Model& model,
-                                [[maybe_unused]] std::ostream& outstream,
+                                [[maybe_unused]] OutStream& outstream,
                                 [[maybe_unused]] const DofEntity& dof)
     {
         if constexpr (enableFoam) {
@@ -379,9 +379,9 @@ public:
         }
     }
 
-    template <class DofEntity>
+    template <class InStream, class DofEntity>
     static void deserializeEntity([[maybe_unused]] Model& model,
-                                  [[maybe_unused]] std::istream& instream,
+                                  [[maybe_unused]] InStream& instream,
                                   [[maybe_unused]] const DofEntity& dof)
     {
         if constexpr (enableFoam) {
@@ -428,6 +428,25 @@ public:
        return params_.gasMobilityMultiplierTable_[pvtnumRegionIdx];
     }
 
+    /*!
+     * \brief Returns the rock density of a saturation region for the adsorption of
+     *        foam.
+     *
+     * The overloads which take a region index allow to determine the region of a
+     * degree of freedom once for all foam properties.
+     */
+    static Scalar foamRockDensity(unsigned satnumRegionIdx)
+    { return params_.foamRockDensity_[satnumRegionIdx]; }
+
+    static bool foamAllowDesorption(unsigned satnumRegionIdx)
+    { return params_.foamAllowDesorption_[satnumRegionIdx]; }
+
+    static const TabulatedFunction& adsorbedFoamTable(unsigned satnumRegionIdx)
+    { return params_.adsorbedFoamTable_[satnumRegionIdx]; }
+
+    static const TabulatedFunction& gasMobilityMultiplierTable(unsigned pvtnumRegionIdx)
+    { return params_.gasMobilityMultiplierTable_[pvtnumRegionIdx]; }
+
     static const typename BlackOilFoamParams<Scalar>::FoamCoefficients&
     foamCoefficients(const ElementContext& elemCtx,
                      const unsigned scvIdx,
@@ -532,9 +551,11 @@ public:
             // The tabular model is used.
             // Note that the current implementation only includes the effect of foam concentration (FOAMMOB),
             // and not the optional pressure dependence (FOAMMOBP) or shear dependence (FOAMMOBS).
-            const auto& gasMobilityMultiplier = FoamModule::gasMobilityMultiplierTable(elemCtx, dofIdx, timeIdx);
+            const unsigned pvtnumRegionIdx = fs.pvtRegionIndex();
+            const auto& gasMobilityMultiplier = FoamModule::gasMobilityMultiplierTable(pvtnumRegionIdx);
             mobilityReductionFactor = gasMobilityMultiplier.eval(foamConcentration_, /* extrapolate = */ true);
         }
+        mobilityReductionFactor_ = mobilityReductionFactor;
 
         // adjust mobility
         switch (FoamModule::transportPhase()) {
@@ -559,11 +580,13 @@ public:
             }
         }
 
-        foamRockDensity_ = FoamModule::foamRockDensity(elemCtx, dofIdx, timeIdx);
+        // all properties of the adsorption use the same saturation region
+        const unsigned satnumRegionIdx = elemCtx.problem().satnumRegionIndex(elemCtx, dofIdx, timeIdx);
+        foamRockDensity_ = FoamModule::foamRockDensity(satnumRegionIdx);
 
-        const auto& adsorbedFoamTable = FoamModule::adsorbedFoamTable(elemCtx, dofIdx, timeIdx);
+        const auto& adsorbedFoamTable = FoamModule::adsorbedFoamTable(satnumRegionIdx);
         foamAdsorbed_ = adsorbedFoamTable.eval(foamConcentration_, /*extrapolate=*/true);
-        if (!FoamModule::foamAllowDesorption(elemCtx, dofIdx, timeIdx)) {
+        if (!FoamModule::foamAllowDesorption(satnumRegionIdx)) {
             throw std::runtime_error("Foam module does not support the 'no desorption' option.");
         }
     }
@@ -577,6 +600,16 @@ public:
     const Evaluation& foamAdsorbed() const
     { return foamAdsorbed_; }
 
+    /*!
+     * \brief Returns the factor by which the mobility of the foam transport phase is
+     *        reduced.
+     *
+     * This is already applied to the mobility of the phase, so flux kernels do not
+     * need to evaluate the foam tables again.
+     */
+    const Evaluation& foamMobilityReductionFactor() const
+    { return mobilityReductionFactor_; }
+
 protected:
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
@@ -584,6 +617,7 @@ protected:
     Evaluation foamConcentration_;
     Scalar foamRockDensity_;
     Evaluation foamAdsorbed_;
+    Evaluation mobilityReductionFactor_;
 };
 
 template <class TypeTag>
@@ -608,6 +642,9 @@ public:
 
     Scalar foamAdsorbed() const
     { throw std::runtime_error("foamAdsorbed() called but foam is disabled"); }
+
+    Scalar foamMobilityReductionFactor() const
+    { throw std::runtime_error("foamMobilityReductionFactor() called but foam is disabled"); }
 };
 
 } // namespace Opm
@@ -46,6 +46,16 @@ struct BlackOilIndices
     static const bool waterEnabled = true;
     static const bool gasEnabled = true;
 
+    /*!
+     * \brief Returns whether a fluid phase is active.
+     *
+     * All phases are possible with these indices, so this is decided at runtime by
+     * the fluid system.
+     */
+    template <class FluidSystem>
+    static bool phaseIsActive(unsigned phaseIdx)
+    { return FluidSystem::phaseIsActive(phaseIdx); }
+
     //! Are solvents involved?
     static const bool enableSolvent = numSolventsV > 0;
 
@@ -29,6 +29,7 @@
 #define EWOMS_BLACK_OIL_INTENSIVE_QUANTITIES_HH
 
 #include "blackoilproperties.hh"
+#include "blackoilcompactfluidstate.hh"
 #include "blackoilsolventmodules.hh"
 #include "blackoilextbomodules.hh"
 #include "blackoilpolymermodules.hh"
@@ -38,12 +39,14 @@
 #include "blackoildiffusionmodule.hh"
 #include "blackoildispersionmodule.hh"
 #include "blackoilmicpmodules.hh"
+#include "blackoilrockcompactioncache.hh"
 
 #include <opm/common/TimingMacros.hpp>
 #include <opm/common/OpmLog/OpmLog.hpp>
 
 #include <opm/input/eclipse/EclipseState/Grid/FaceDir.hpp>
 
+#include <opm/material/densead/Evaluation.hpp>
 #include <opm/material/fluidstates/BlackOilFluidState.hpp>
 #include <opm/material/common/Valgrind.hpp>
 
@@ -53,7 +56,9 @@
 
 #include <dune/common/fmatrix.hh>
 
+#include <array>
 #include <cstring>
+#include <type_traits>
 #include <utility>
 
 #include <fmt/format.h>
@@ -90,6 +95,7 @@ class BlackOilIntensiveQuantities
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
     using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
     using Indices = GetPropType<TypeTag, Properties::Indices>;
+    using RockCompactionCache = BlackOilRockCompactionCache<Scalar, Evaluation, PrimaryVariables>;
     using GridView = GetPropType<TypeTag, Properties::GridView>;
     using FluxModule = GetPropType<TypeTag, Properties::FluxModule>;
 
@@ -123,6 +129,11 @@ class BlackOilIntensiveQuantities
     static constexpr bool gasEnabled = Indices::gasEnabled;
     static constexpr bool oilEnabled = Indices::oilEnabled;
 
+    // the active phases are known at compile time for the one- and two-phase indices,
+    // so branches on the disabled phases are optimized away
+    static bool phaseIsActive_(unsigned phaseIdx)
+    { return Indices::template phaseIsActive<FluidSystem>(phaseIdx); }
+
     using Toolbox = MathToolbox<Evaluation>;
     using DimMatrix = Dune::FieldMatrix<Scalar, dimWorld, dimWorld>;
     using FluxIntensiveQuantities = typename FluxModule::FluxIntensiveQuantities;
@@ -132,18 +143,52 @@ class BlackOilIntensiveQuantities
     using DirectionalMobilityPtr = Opm::Utility::CopyablePtr<DirectionalMobility<TypeTag, Evaluation>>;
     using BrineModule = BlackOilBrineModule<TypeTag>;
 
+    // The PVT relations of a phase only depend on the pressure of the phase, the
+    // temperature, the dissolution factors and the salt concentration. If there are
+    // fewer of these quantities than primary variables, the formation volume factors
+    // and viscosities are evaluated for derivatives with regard to these quantities and
+    // the chain rule is applied afterwards.
+    static constexpr int pvtPressureVarIdx = 0;
+    static constexpr int pvtTemperatureVarIdx =
+        (enableTemperature || enableEnergy) ? pvtPressureVarIdx + 1 : pvtPressureVarIdx;
+    static constexpr int pvtDissolutionVarIdx =
+        (compositionSwitchEnabled || has_disgas_in_water) ? pvtTemperatureVarIdx + 1 : pvtTemperatureVarIdx;
+    static constexpr int pvtVapwatVarIdx = enableVapwat ? pvtDissolutionVarIdx + 1 : pvtDissolutionVarIdx;
+    static constexpr int pvtSaltVarIdx = enableBrine ? pvtVapwatVarIdx + 1 : pvtVapwatVarIdx;
+    static constexpr int numPvtVars = pvtSaltVarIdx + 1;
+    static constexpr bool reducedPvtDerivatives = numPvtVars < numEq;
+
+    using PvtEvaluation = DenseAd::Evaluation<Scalar, numPvtVars>;
+    using PvtFluidState = BlackOilFluidState<PvtEvaluation,
+                                             FluidSystem,
+                                             enableTemperature,
+                                             enableEnergy,
+                                             compositionSwitchEnabled,
+                                             enableVapwat,
+                                             enableBrine,
+                                             enableSaltPrecipitation,
+                                             has_disgas_in_water,
+                                             Indices::numPhases>;
+
+
+    // the fluid state which only stores the quantities needed by the storage and flux
+    // terms, see BlackOilCompactFluidState
+    using CompactFluidState = BlackOilCompactFluidState<Evaluation,
+                                                        FluidSystem,
+                                                        enableTemperature,
+                                                        enableEnergy,
+                                                        compositionSwitchEnabled,
+                                                        enableVapwat,
+                                                        enableBrine,
+                                                        enableSaltPrecipitation,
+                                                        has_disgas_in_water,
+                                                        Indices::numPhases>;
 
 public:
-    using FluidState = BlackOilFluidState<Evaluation,
-                                          FluidSystem,
-                                          enableTemperature,
-                                          enableEnergy,
-                                          compositionSwitchEnabled,
-                                          enableVapwat,
-                                          enableBrine,
-                                          enableSaltPrecipitation,
-                                          has_disgas_in_water,
-                                          Indices::numPhases>;
+    using FluidState =
+        std::conditional_t<getPropValue<TypeTag, Properties::EnableCompactFluidState>(),
+                           CompactFluidState,
+                           typename CompactFluidState::FullFluidState>;
     using ScalarFluidState = BlackOilFluidState<Scalar,
                                                 FluidSystem,
                                                 enableTemperature,
@@ -233,21 +278,21 @@ public:
         // deal with solvent
         if constexpr (enableSolvent) {
             if(priVars.primaryVarsMeaningSolvent() == PrimaryVariables::SolventMeaning::Ss) {
-                if (FluidSystem::phaseIsActive(oilPhaseIdx)) {
+                if (phaseIsActive_(oilPhaseIdx)) {
                     So -= priVars.makeEvaluation(Indices::solventSaturationIdx, timeIdx);
-                } else if (FluidSystem::phaseIsActive(gasPhaseIdx)) {
+                } else if (phaseIsActive_(gasPhaseIdx)) {
                     Sg -= priVars.makeEvaluation(Indices::solventSaturationIdx, timeIdx);
                 }
             }
         }
 
-        if (FluidSystem::phaseIsActive(waterPhaseIdx))
+        if (phaseIsActive_(waterPhaseIdx))
             fluidState_.setSaturation(waterPhaseIdx, Sw);
 
-        if (FluidSystem::phaseIsActive(gasPhaseIdx))
+        if (phaseIsActive_(gasPhaseIdx))
             fluidState_.setSaturation(gasPhaseIdx, Sg);
 
-        if (FluidSystem::phaseIsActive(oilPhaseIdx))
+        if (phaseIsActive_(oilPhaseIdx))
             fluidState_.setSaturation(oilPhaseIdx, So);
 
         asImp_().solventPreSatFuncUpdate_(elemCtx, dofIdx, timeIdx);
@@ -266,7 +311,7 @@ public:
             const auto& pcfactTable = BrineModule::pcfactTable(satnumRegionIdx);
             const Evaluation pcFactor = pcfactTable.eval(porosityFactor, /*extrapolation=*/true);
             for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
-                if (FluidSystem::phaseIsActive(phaseIdx)) {
+                if (phaseIsActive_(phaseIdx)) {
                     pC[phaseIdx] *= pcFactor;
                 }
         }
@@ -275,18 +320,18 @@ public:
         if (priVars.primaryVarsMeaningPressure() == PrimaryVariables::PressureMeaning::Pg) {
             const Evaluation& pg = priVars.makeEvaluation(Indices::pressureSwitchIdx, timeIdx);
             for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
-                if (FluidSystem::phaseIsActive(phaseIdx))
+                if (phaseIsActive_(phaseIdx))
                     fluidState_.setPressure(phaseIdx, pg + (pC[phaseIdx] - pC[gasPhaseIdx]));
         } else if (priVars.primaryVarsMeaningPressure() == PrimaryVariables::PressureMeaning::Pw) {
             const Evaluation& pw = priVars.makeEvaluation(Indices::pressureSwitchIdx, timeIdx);
             for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
-                if (FluidSystem::phaseIsActive(phaseIdx))
+                if (phaseIsActive_(phaseIdx))
                     fluidState_.setPressure(phaseIdx, pw + (pC[phaseIdx] - pC[waterPhaseIdx]));
         } else {
-            assert(FluidSystem::phaseIsActive(oilPhaseIdx));
+            assert(phaseIsActive_(oilPhaseIdx));
             const Evaluation& po = priVars.makeEvaluation(Indices::pressureSwitchIdx, timeIdx);
             for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
-                if (FluidSystem::phaseIsActive(phaseIdx))
+                if (phaseIsActive_(phaseIdx))
                     fluidState_.setPressure(phaseIdx, po + (pC[phaseIdx] - pC[oilPhaseIdx]));
         }
 
@@ -297,7 +342,7 @@ public:
         asImp_().zFractionUpdate_(elemCtx, dofIdx, timeIdx);
 
         Evaluation SoMax = 0.0;
-        if (FluidSystem::phaseIsActive(FluidSystem::oilPhaseIdx)) {
+        if (phaseIsActive_(FluidSystem::oilPhaseIdx)) {
             SoMax = max(fluidState_.saturation(oilPhaseIdx),
                         problem.maxOilSaturation(globalSpaceIdx));
         }
@@ -362,7 +407,7 @@ public:
 
         typename FluidSystem::template ParameterCache<Evaluation> paramCache;
         paramCache.setRegionIndex(pvtRegionIdx);
-        if (FluidSystem::phaseIsActive(FluidSystem::oilPhaseIdx)) {
+        if (phaseIsActive_(FluidSystem::oilPhaseIdx)) {
             paramCache.setMaxOilSat(SoMax);
         }
         paramCache.updateAll(fluidState_);
@@ -377,11 +422,18 @@ public:
             }
         }
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
-            if (!FluidSystem::phaseIsActive(phaseIdx))
+            if (!phaseIsActive_(phaseIdx))
                 continue;
-            const auto& b = FluidSystem::inverseFormationVolumeFactor(fluidState_, phaseIdx, pvtRegionIdx);
+            Evaluation b;
+            Evaluation mu;
+            if constexpr (reducedPvtDerivatives) {
+                updatePvtQuantities_(b, mu, phaseIdx, pvtRegionIdx, SoMax);
+            }
+            else {
+                b = FluidSystem::inverseFormationVolumeFactor(fluidState_, phaseIdx, pvtRegionIdx);
+                mu = FluidSystem::viscosity(fluidState_, paramCache, phaseIdx);
+            }
             fluidState_.setInvB(phaseIdx, b);
-            const auto& mu = FluidSystem::viscosity(fluidState_, paramCache, phaseIdx);
             for (int i = 0; i<nmobilities; i++) {
                 if (enableExtbo && phaseIdx == oilPhaseIdx) {
                     (*mobilities[i])[phaseIdx] /= asImp_().oilViscosity();
@@ -398,7 +450,7 @@ public:
 
         // calculate the phase densities
         Evaluation rho;
-        if (FluidSystem::phaseIsActive(waterPhaseIdx)) {
+        if (phaseIsActive_(waterPhaseIdx)) {
             rho = fluidState_.invB(waterPhaseIdx);
             rho *= FluidSystem::referenceDensity(waterPhaseIdx, pvtRegionIdx);
             if (FluidSystem::enableDissolvedGasInWater()) {
@@ -410,7 +462,7 @@ public:
             fluidState_.setDensity(waterPhaseIdx, rho);
         }
 
-        if (FluidSystem::phaseIsActive(gasPhaseIdx)) {
+        if (phaseIsActive_(gasPhaseIdx)) {
             rho = fluidState_.invB(gasPhaseIdx);
             rho *= FluidSystem::referenceDensity(gasPhaseIdx, pvtRegionIdx);
             if (FluidSystem::enableVaporizedOil()) {
@@ -428,7 +480,7 @@ public:
             fluidState_.setDensity(gasPhaseIdx, rho);
         }
 
-        if (FluidSystem::phaseIsActive(oilPhaseIdx)) {
+        if (phaseIsActive_(oilPhaseIdx)) {
             rho = fluidState_.invB(oilPhaseIdx);
             rho *= FluidSystem::referenceDensity(oilPhaseIdx, pvtRegionIdx);
             if (FluidSystem::enableDissolvedGas()) {
@@ -450,9 +502,9 @@ public:
         if (rockCompressibility > 0.0) {
             Scalar rockRefPressure = problem.rockReferencePressure(globalSpaceIdx);
             Evaluation x;
-            if (FluidSystem::phaseIsActive(oilPhaseIdx)) {
+            if (phaseIsActive_(oilPhaseIdx)) {
                 x = rockCompressibility*(fluidState_.pressure(oilPhaseIdx) - rockRefPressure);
-            } else if (FluidSystem::phaseIsActive(waterPhaseIdx)){
+            } else if (phaseIsActive_(waterPhaseIdx)){
                 x = rockCompressibility*(fluidState_.pressure(waterPhaseIdx) - rockRefPressure);
             } else {
                 x = rockCompressibility*(fluidState_.pressure(gasPhaseIdx) - rockRefPressure);
@@ -460,8 +512,47 @@ public:
             porosity_ *= 1.0 + x + 0.5*x*x;
         }
 
-        // deal with water induced rock compaction
-        porosity_ *= problem.template rockCompPoroMultiplier<Evaluation>(*this, globalSpaceIdx);
+        // deal with water induced rock compaction. The multipliers of the last
+        // complete evaluation are extrapolated if the pressure did not change much.
+        // Like for the energy quantities, the derivatives of the stored multipliers
+        // are only meaningful for the variables of the current linearization and
+        // each entry may only be accessed by the thread which owns the degree of
+        // freedom.
+        typename RockCompactionCache::Entry* rockCompCacheEntry = nullptr;
+        bool rockCompCacheHit = false;
+        if constexpr (!std::is_same_v<Evaluation, Scalar>) {
+            auto* cache = problem.model().rockCompactionCache();
+            if (cache && timeIdx == 0 && linearizationType.time == 0
+                && dofIdx == 0 && elemCtx.numPrimaryDof(timeIdx) == 1)
+            {
+                rockCompCacheEntry = &cache->entry(globalSpaceIdx);
+                rockCompCacheHit = cache->isApplicable(*rockCompCacheEntry, priVars,
+                                                       Indices::pressureSwitchIdx);
+            }
+        }
+
+        if (rockCompCacheHit) {
+            const PrimaryVariables& ref = rockCompCacheEntry->priVars;
+            porosity_ *= RockCompactionCache::extrapolate(rockCompCacheEntry->poroMultiplier,
+                                                          ref, priVars);
+            rockCompTransMultiplier_ =
+                RockCompactionCache::extrapolate(rockCompCacheEntry->transMultiplier,
+                                                 ref, priVars);
+        }
+        else {
+            const Evaluation poroMultiplier =
+                problem.template rockCompPoroMultiplier<Evaluation>(*this, globalSpaceIdx);
+            porosity_ *= poroMultiplier;
+            rockCompTransMultiplier_ =
+                problem.template rockCompTransMultiplier<Evaluation>(*this, globalSpaceIdx);
+
+            if (rockCompCacheEntry) {
+                rockCompCacheEntry->priVars = priVars;
+                rockCompCacheEntry->poroMultiplier = poroMultiplier;
+                rockCompCacheEntry->transMultiplier = rockCompTransMultiplier_;
+                rockCompCacheEntry->valid = true;
+            }
+        }
 
         // the MICP processes change the porosity
         if constexpr (enableMICP){
@@ -476,8 +567,6 @@ public:
             porosity_ *= (1.0 - Sp);
         }
 
-        rockCompTransMultiplier_ = problem.template rockCompTransMultiplier<Evaluation>(*this, globalSpaceIdx);
-
         asImp_().solventPvtUpdate_(elemCtx, dofIdx, timeIdx);
         asImp_().zPvtUpdate_();
         asImp_().polymerPropertiesUpdate_(elemCtx, dofIdx, timeIdx);
@@ -499,7 +588,7 @@ public:
 #ifndef NDEBUG
         // some safety checks in debug mode
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
-            if (!FluidSystem::phaseIsActive(phaseIdx))
+            if (!phaseIsActive_(phaseIdx))
                 continue;
 
             assert(isfinite(fluidState_.density(phaseIdx)));
@@ -603,6 +692,83 @@ private:
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
 
+    // Compute the inverse formation volume factor and the viscosity of a phase using
+    // evaluations which only have derivatives with regard to the inputs of the PVT
+    // relations and expand the result to derivatives with regard to the primary
+    // variables afterwards.
+    void updatePvtQuantities_(Evaluation& b,
+                              Evaluation& mu,
+                              unsigned phaseIdx,
+                              unsigned pvtRegionIdx,
+                              const Evaluation& SoMax) const
+    {
+        // the inputs of the PVT relations of the phase. the quantities which do not
+        // affect the phase are passed without derivatives.
+        std::array<Evaluation, numPvtVars> inputs;
+        inputs.fill(0.0);
+        const auto seed = [&inputs](const Evaluation& input, int varIdx)
+        {
+            inputs[varIdx] = input;
+            return PvtEvaluation::createVariable(Toolbox::value(input), varIdx);
+        };
+
+        PvtFluidState pvtFs;
+        pvtFs.setPvtRegionIndex(pvtRegionIdx);
+        for (unsigned otherPhaseIdx = 0; otherPhaseIdx < numPhases; ++otherPhaseIdx) {
+            if (!phaseIsActive_(otherPhaseIdx))
+                continue;
+            pvtFs.setSaturation(otherPhaseIdx, Toolbox::value(fluidState_.saturation(otherPhaseIdx)));
+            pvtFs.setPressure(otherPhaseIdx, Toolbox::value(fluidState_.pressure(otherPhaseIdx)));
+        }
+        pvtFs.setPressure(phaseIdx, seed(fluidState_.pressure(phaseIdx), pvtPressureVarIdx));
+
+        if constexpr (enableTemperature || enableEnergy)
+            pvtFs.setTemperature(seed(fluidState_.temperature(phaseIdx), pvtTemperatureVarIdx));
+
+        // only a single dissolution factor affects a given phase, except for the
+        // vaporized water in the gas phase
+        if constexpr (compositionSwitchEnabled) {
+            pvtFs.setRs(phaseIdx == oilPhaseIdx
+                        ? seed(fluidState_.Rs(), pvtDissolutionVarIdx)
+                        : PvtEvaluation(Toolbox::value(fluidState_.Rs())));
+            pvtFs.setRv(phaseIdx == gasPhaseIdx
+                        ? seed(fluidState_.Rv(), pvtDissolutionVarIdx)
+                        : PvtEvaluation(Toolbox::value(fluidState_.Rv())));
+        }
+        if constexpr (has_disgas_in_water) {
+            pvtFs.setRsw(phaseIdx == waterPhaseIdx
+                         ? seed(fluidState_.Rsw(), pvtDissolutionVarIdx)
+                         : PvtEvaluation(Toolbox::value(fluidState_.Rsw())));
+        }
+        if constexpr (enableVapwat) {
+            pvtFs.setRvw(phaseIdx == gasPhaseIdx
+                         ? seed(fluidState_.Rvw(), pvtVapwatVarIdx)
+                         : PvtEvaluation(Toolbox::value(fluidState_.Rvw())));
+        }
+        if constexpr (enableBrine)
+            pvtFs.setSaltConcentration(seed(fluidState_.saltConcentration(), pvtSaltVarIdx));
+        if constexpr (enableSaltPrecipitation)
+            pvtFs.setSaltSaturation(Toolbox::value(fluidState_.saltSaturation()));
+
+        typename FluidSystem::template ParameterCache<PvtEvaluation> pvtParamCache;
+        pvtParamCache.setRegionIndex(pvtRegionIdx);
+        if (phaseIsActive_(oilPhaseIdx))
+            pvtParamCache.setMaxOilSat(Toolbox::value(SoMax));
+        pvtParamCache.updateAll(pvtFs);
+
+        const PvtEvaluation pvtB = FluidSystem::inverseFormationVolumeFactor(pvtFs, phaseIdx, pvtRegionIdx);
+        const PvtEvaluation pvtMu = FluidSystem::viscosity(pvtFs, pvtParamCache, phaseIdx);
+
+        // apply the chain rule
+        b = pvtB.value();
+        mu = pvtMu.value();
+        for (int varIdx = 0; varIdx < numPvtVars; ++varIdx) {
+            const Evaluation inputDerivatives = inputs[varIdx] - Toolbox::value(inputs[varIdx]);
+            b += pvtB.derivative(varIdx) * inputDerivatives;
+            mu += pvtMu.derivative(varIdx) * inputDerivatives;
+        }
+    }
+
     FluidState fluidState_;
     Scalar referencePorosity_;
     Evaluation porosity_;
@@ -75,6 +75,11 @@ class BlackOilLocalResidual : public GetPropType<TypeTag, Properties::DiscLocalR
     static const bool waterEnabled = Indices::waterEnabled;
     static const bool gasEnabled = Indices::gasEnabled;
     static const bool oilEnabled = Indices::oilEnabled;
+
+    // the active phases are known at compile time for the one- and two-phase indices,
+    // so branches on the disabled phases are optimized away
+    static bool phaseIsActive_(unsigned phaseIdx)
+    { return Indices::template phaseIsActive<FluidSystem>(phaseIdx); }
     static const bool compositionSwitchEnabled = (compositionSwitchIdx >= 0);
 
     static constexpr bool blackoilConserveSurfaceVolume = getPropValue<TypeTag, Properties::BlackoilConserveSurfaceVolume>();
@@ -108,7 +113,7 @@ public:
         storage = 0.0;
 
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
-            if (!FluidSystem::phaseIsActive(phaseIdx)) {
+            if (!phaseIsActive_(phaseIdx)) {
                 if (Indices::numPhases == 3) { // add trivial equation for the pseudo phase
                     unsigned activeCompIdx = Indices::canonicalToActiveComponentIndex(FluidSystem::solventComponentIndex(phaseIdx));
                     if (timeIdx == 0)
@@ -199,7 +204,7 @@ public:
         const ExtensiveQuantities& extQuants = elemCtx.extensiveQuantities(scvfIdx, timeIdx);
         unsigned focusDofIdx = elemCtx.focusDofIndex();
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
-            if (!FluidSystem::phaseIsActive(phaseIdx))
+            if (!phaseIsActive_(phaseIdx))
                 continue;
 
             unsigned upIdx = static_cast<unsigned>(extQuants.upstreamIndex(phaseIdx));
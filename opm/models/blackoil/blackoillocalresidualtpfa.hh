@@ -38,10 +38,15 @@
 #include "blackoildiffusionmodule.hh"
 #include "blackoildispersionmodule.hh"
 #include "blackoilmicpmodules.hh"
+#include "blackoiloffloadfluxkernel.hh"
 #include <opm/material/fluidstates/BlackOilFluidState.hpp>
 #include <opm/input/eclipse/EclipseState/Grid/FaceDir.hpp>
 #include <opm/input/eclipse/Schedule/BCProp.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
 namespace Opm {
 /*!
  * \ingroup BlackOilModel
@@ -82,6 +87,11 @@ class BlackOilLocalResidualTPFA : public GetPropType<TypeTag, Properties::DiscLo
     static const bool waterEnabled = Indices::waterEnabled;
     static const bool gasEnabled = Indices::gasEnabled;
     static const bool oilEnabled = Indices::oilEnabled;
+
+    // the active phases are known at compile time for the one- and two-phase indices,
+    // so branches on the disabled phases are optimized away
+    static bool phaseIsActive_(unsigned phaseIdx)
+    { return Indices::template phaseIsActive<FluidSystem>(phaseIdx); }
     static const bool compositionSwitchEnabled = (compositionSwitchIdx >= 0);
 
     static constexpr bool blackoilConserveSurfaceVolume = getPropValue<TypeTag, Properties::BlackoilConserveSurfaceVolume>();
@@ -109,6 +119,23 @@ class BlackOilLocalResidualTPFA : public GetPropType<TypeTag, Properties::DiscLo
     using Toolbox = MathToolbox<Evaluation>;
 
 public:
+    //! Specifies whether computeStorageBatch() can be used for the current model,
+    //! i.e., whether none of the modules which contribute to the storage term is enabled
+    static constexpr bool batchedStorageSupported =
+        !enableSolvent && !enableExtbo && !enablePolymer && !enableEnergy
+        && !enableFoam && !enableBrine && !enableMICP;
+
+    //! Specifies whether computeFluxBatch() can be used for the current model
+    static constexpr bool batchedFluxSupported =
+        batchedStorageSupported && !enableDiffusion && !enableDispersion;
+
+    //! The number of cells or faces which are processed concurrently by the batched
+    //! storage and flux kernels
+    static constexpr unsigned batchSize = 8;
+
+    //! Computes the fluxes of all cells on an accelerator device, see
+    //! BlackOilOffloadFluxKernel::supported for the models which it can handle
+    using OffloadFluxKernel = BlackOilOffloadFluxKernel<TypeTag>;
 
     struct ResidualNBInfo
     {
@@ -117,6 +144,8 @@ public:
         double thpres;
         double dZg;
         int dirId;
+        //! true if the rock compaction transmissibility multipliers can be skipped
+        bool skipTransMult = false;
         double Vin;
         double Vex;
         double inAlpha;
@@ -148,7 +177,7 @@ public:
         storage = 0.0;
 
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
-            if (!FluidSystem::phaseIsActive(phaseIdx)) {
+            if (!phaseIsActive_(phaseIdx)) {
                 continue;
             }
             unsigned activeCompIdx = Indices::canonicalToActiveComponentIndex(FluidSystem::solventComponentIndex(phaseIdx));
@@ -216,6 +245,124 @@ public:
         MICPModule::addStorage(storage, intQuants);
     }
 
+    /*!
+     * \brief Compute the storage term and its derivatives for a range of cells.
+     *
+     * This produces the same result as calling computeStorage() for the cells one by
+     * one, but the cells are processed in batches of batchSize: the values and
+     * derivatives of the quantities of each batch are gathered into arrays whose
+     * innermost index is the cell, so the arithmetic of the product rule is done for
+     * all cells of the batch at once and can be vectorized by the compiler.
+     *
+     * \param res The value of the storage term for each cell
+     * \param jac The derivatives of the storage term with regard to the primary
+     *            variables of each cell, i.e., its diagonal Jacobian block
+     * \param intQuants Pointers to the intensive quantities of the cells
+     * \param numCells The number of cells
+     */
+    template <class ResBlock, class MatrixBlock>
+    static void computeStorageBatch(ResBlock* res,
+                                    MatrixBlock* jac,
+                                    const IntensiveQuantities* const* intQuants,
+                                    std::size_t numCells)
+    {
+        static_assert(batchedStorageSupported,
+                      "The batched storage term is only available for black-oil models "
+                      "which do not enable any additional modules");
+
+        OPM_TIMEBLOCK_LOCAL(computeStorageBatch);
+        for (std::size_t batchBegin = 0; batchBegin < numCells; batchBegin += batchSize) {
+            const unsigned batchCells =
+                static_cast<unsigned>(std::min<std::size_t>(batchSize, numCells - batchBegin));
+            computeStorageBatch_(res + batchBegin,
+                                 jac + batchBegin,
+                                 intQuants + batchBegin,
+                                 batchCells);
+        }
+    }
+
+    /*!
+     * \brief Compute the values of the fluxes over a face, without derivatives.
+     *
+     * This is intended for the code which only needs the fluxes themselves, e.g. the
+     * output of the inter-cell flows. Unless the energy, diffusion or dispersion
+     * modules are enabled, the fluxes are computed using scalars instead of
+     * evaluations.
+     */
+    static void computeFluxValues(Dune::FieldVector<Scalar, numEq>& flux,
+                                  RateVector& darcy,
+                                  const unsigned globalIndexIn,
+                                  const unsigned globalIndexEx,
+                                  const IntensiveQuantities& intQuantsIn,
+                                  const IntensiveQuantities& intQuantsEx,
+                                  const ResidualNBInfo& nbInfo)
+    {
+        OPM_TIMEBLOCK_LOCAL(computeFluxValues);
+        if constexpr (enableEnergy || enableDiffusion || enableDispersion) {
+            RateVector evalFlux;
+            computeFlux(evalFlux, darcy, globalIndexIn, globalIndexEx, intQuantsIn, intQuantsEx, nbInfo);
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                flux[eqIdx] = getValue(evalFlux[eqIdx]);
+        }
+        else {
+            flux = 0.0;
+            darcy = 0.0;
+            calculatePhaseFluxes_<Scalar>(flux,
+                                          darcy,
+                                          intQuantsIn,
+                                          intQuantsEx,
+                                          globalIndexIn,
+                                          globalIndexEx,
+                                          nbInfo);
+        }
+    }
+
+    /*!
+     * \brief Compute the fluxes over a range of faces.
+     *
+     * The result is the same as the one of calling computeFlux() for the faces one by
+     * one, up to rounding. The upstream decision and the pressure differences are
+     * determined face by face, but the remaining arithmetic is done on arrays whose
+     * innermost index is the face of a batch of batchSize faces. The derivatives of
+     * the quantities of faces whose upstream cell is the exterior one are masked out.
+     *
+     * \param flux The mass fluxes over the faces
+     * \param darcy The volume fluxes of the phases over the faces, without derivatives
+     * \param globalIndexIn The indices of the interior cells of the faces
+     * \param globalIndexEx The indices of the exterior cells of the faces
+     * \param intQuantsIn Pointers to the intensive quantities of the interior cells
+     * \param intQuantsEx Pointers to the intensive quantities of the exterior cells
+     * \param nbInfo Pointers to the geometric information of the faces
+     * \param numFaces The number of faces
+     */
+    static void computeFluxBatch(RateVector* flux,
+                                 RateVector* darcy,
+                                 const unsigned* globalIndexIn,
+                                 const unsigned* globalIndexEx,
+                                 const IntensiveQuantities* const* intQuantsIn,
+                                 const IntensiveQuantities* const* intQuantsEx,
+                                 const ResidualNBInfo* const* nbInfo,
+                                 std::size_t numFaces)
+    {
+        static_assert(batchedFluxSupported,
+                      "The batched fluxes are only available for black-oil models which "
+                      "do not enable any additional modules");
+
+        OPM_TIMEBLOCK_LOCAL(computeFluxBatch);
+        for (std::size_t batchBegin = 0; batchBegin < numFaces; batchBegin += batchSize) {
+            const unsigned batchFaces =
+                static_cast<unsigned>(std::min<std::size_t>(batchSize, numFaces - batchBegin));
+            computeFluxBatch_(flux + batchBegin,
+                              darcy + batchBegin,
+                              globalIndexIn + batchBegin,
+                              globalIndexEx + batchBegin,
+                              intQuantsIn + batchBegin,
+                              intQuantsEx + batchBegin,
+                              nbInfo + batchBegin,
+                              batchFaces);
+        }
+    }
+
     /*!
      * This function works like the ElementContext-based version with
      * one main difference: The darcy flux is calculated here, not
@@ -298,7 +445,9 @@ public:
         const Scalar diffusivity = problem.diffusivity(globalIndexEx, globalIndexIn);
         const Scalar dispersivity = problem.dispersivity(globalIndexEx, globalIndexIn);
 
-        const ResidualNBInfo res_nbinfo {trans, faceArea, thpres, distZ * g, dirid, Vin, Vex, inAlpha, outAlpha, diffusivity, dispersivity};
+        const bool skipTransMult = !problem.hasRockCompTransMultiplier();
+        const ResidualNBInfo res_nbinfo {trans, faceArea, thpres, distZ * g, dirid, skipTransMult,
+                                         Vin, Vex, inAlpha, outAlpha, diffusivity, dispersivity};
 
         calculateFluxes_(flux,
                          darcy,
@@ -309,15 +458,17 @@ public:
                          res_nbinfo);
     }
 
-    static void calculateFluxes_(RateVector& flux,
-                                 RateVector& darcy,
-                                 const IntensiveQuantities& intQuantsIn,
-                                 const IntensiveQuantities& intQuantsEx,
-                                 const unsigned& globalIndexIn,
-                                 const unsigned& globalIndexEx,
-                                 const ResidualNBInfo& nbInfo)
+    // Compute the advective fluxes of all phases over a face. FluxEval is either
+    // Evaluation or Scalar; in the latter case the derivatives are not computed.
+    template <class FluxEval, class FluxVector>
+    static void calculatePhaseFluxes_(FluxVector& flux,
+                                      RateVector& darcy,
+                                      const IntensiveQuantities& intQuantsIn,
+                                      const IntensiveQuantities& intQuantsEx,
+                                      const unsigned& globalIndexIn,
+                                      const unsigned& globalIndexEx,
+                                      const ResidualNBInfo& nbInfo)
     {
-        OPM_TIMEBLOCK_LOCAL(calculateFluxes);
         const Scalar Vin = nbInfo.Vin;
         const Scalar Vex = nbInfo.Vex;
         const Scalar distZg = nbInfo.dZg;
@@ -326,8 +477,16 @@ public:
         const Scalar faceArea = nbInfo.faceArea;
         FaceDir::DirEnum facedir = faceDirFromDirId(nbInfo.dirId);
 
+        // the combined face multiplier: Use arithmetic average of the rock compaction
+        // multipliers (more accurate with harmonic, but that requires recomputing the
+        // transmissbility)
+        FluxEval faceFactor = -trans / faceArea;
+        if (!nbInfo.skipTransMult)
+            faceFactor *= (Toolbox::template decay<FluxEval>(intQuantsIn.rockCompTransMultiplier())
+                           + Toolbox::value(intQuantsEx.rockCompTransMultiplier()))/2;
+
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
-            if (!FluidSystem::phaseIsActive(phaseIdx))
+            if (!phaseIsActive_(phaseIdx))
                 continue;
             // darcy flux calculation
             short dnIdx;
@@ -356,28 +515,27 @@ public:
 
             const IntensiveQuantities& up = (upIdx == interiorDofIdx) ? intQuantsIn : intQuantsEx;
             unsigned globalUpIndex = (upIdx == interiorDofIdx) ? globalIndexIn : globalIndexEx;
-            // Use arithmetic average (more accurate with harmonic, but that requires recomputing the transmissbility)
-            const Evaluation transMult = (intQuantsIn.rockCompTransMultiplier() + Toolbox::value(intQuantsEx.rockCompTransMultiplier()))/2;
-            Evaluation darcyFlux;
+            FluxEval darcyFlux;
             if (pressureDifference == 0) {
                 darcyFlux = 0.0; // NB maybe we could drop calculations
             } else {
                 if (globalUpIndex == globalIndexIn)
-                    darcyFlux = pressureDifference * up.mobility(phaseIdx, facedir) * transMult * (-trans / faceArea);
+                    darcyFlux = Toolbox::template decay<FluxEval>(pressureDifference)
+                        * Toolbox::template decay<FluxEval>(up.mobility(phaseIdx, facedir)) * faceFactor;
                 else
-                    darcyFlux = pressureDifference *
-                       (Toolbox::value(up.mobility(phaseIdx, facedir)) * transMult * (-trans / faceArea));
+                    darcyFlux = Toolbox::template decay<FluxEval>(pressureDifference) *
+                       (Toolbox::value(up.mobility(phaseIdx, facedir)) * faceFactor);
             }
             unsigned activeCompIdx = Indices::canonicalToActiveComponentIndex(FluidSystem::solventComponentIndex(phaseIdx));
-            darcy[conti0EqIdx + activeCompIdx] = darcyFlux.value() * faceArea; // NB! For the FLORES fluxes without derivatives
+            darcy[conti0EqIdx + activeCompIdx] = getValue(darcyFlux) * faceArea; // NB! For the FLORES fluxes without derivatives
 
             unsigned pvtRegionIdx = up.pvtRegionIndex();
             // if (upIdx == globalFocusDofIdx){
             if (globalUpIndex == globalIndexIn) {
                 const auto& invB
-                    = getInvB_<FluidSystem, FluidState, Evaluation>(up.fluidState(), phaseIdx, pvtRegionIdx);
+                    = getInvB_<FluidSystem, FluidState, FluxEval>(up.fluidState(), phaseIdx, pvtRegionIdx);
                 const auto& surfaceVolumeFlux = invB * darcyFlux;
-                evalPhaseFluxes_<Evaluation, Evaluation, FluidState>(
+                evalPhaseFluxes_<FluxEval, FluxEval, FluidState>(
                     flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, up.fluidState());
                 if constexpr (enableEnergy) {
                     EnergyModule::template addPhaseEnthalpyFluxes_<Evaluation, Evaluation, FluidState>(
@@ -386,7 +544,7 @@ public:
             } else {
                 const auto& invB = getInvB_<FluidSystem, FluidState, Scalar>(up.fluidState(), phaseIdx, pvtRegionIdx);
                 const auto& surfaceVolumeFlux = invB * darcyFlux;
-                evalPhaseFluxes_<Scalar, Evaluation, FluidState>(
+                evalPhaseFluxes_<Scalar, FluxEval, FluidState>(
                     flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, up.fluidState());
                 if constexpr (enableEnergy) {
                     EnergyModule::template
@@ -396,6 +554,26 @@ public:
             }
 
         }
+    }
+
+    static void calculateFluxes_(RateVector& flux,
+                                 RateVector& darcy,
+                                 const IntensiveQuantities& intQuantsIn,
+                                 const IntensiveQuantities& intQuantsEx,
+                                 const unsigned& globalIndexIn,
+                                 const unsigned& globalIndexEx,
+                                 const ResidualNBInfo& nbInfo)
+    {
+        OPM_TIMEBLOCK_LOCAL(calculateFluxes);
+        const Scalar faceArea = nbInfo.faceArea;
+
+        calculatePhaseFluxes_<Evaluation>(flux,
+                                          darcy,
+                                          intQuantsIn,
+                                          intQuantsEx,
+                                          globalIndexIn,
+                                          globalIndexEx,
+                                          nbInfo);
 
         // deal with solvents (if present)
         static_assert(!enableSolvent, "Relevant computeFlux() method must be implemented for this module before enabling.");
@@ -532,7 +710,7 @@ public:
         ////////
         bdyFlux = 0.0;
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
-            if (!FluidSystem::phaseIsActive(phaseIdx)) {
+            if (!phaseIsActive_(phaseIdx)) {
                 continue;
             }
             const auto& pBoundary = bdyInfo.exFluidState.pressure(phaseIdx);
@@ -721,8 +899,8 @@ public:
      * \brief Helper function to calculate the flux of mass in terms of conservation
      *        quantities via specific fluid phase over a face.
      */
-    template <class UpEval, class Eval,class FluidState>
-    static void evalPhaseFluxes_(RateVector& flux,
+    template <class UpEval, class Eval, class FluidState, class FluxVector>
+    static void evalPhaseFluxes_(FluxVector& flux,
                                  unsigned phaseIdx,
                                  unsigned pvtRegionIdx,
                                  const Eval& surfaceVolumeFlux,
@@ -823,6 +1001,312 @@ public:
     }
 
 
+    // the value (index 0) and the derivatives (indices 1 to numEq) of a quantity for
+    // each cell of a batch
+    using BatchEval_ = std::array<std::array<Scalar, batchSize>, numEq + 1>;
+
+    static void gatherBatch_(BatchEval_& dst, unsigned lane, const Evaluation& eval)
+    {
+        dst[0][lane] = eval.value();
+        for (unsigned varIdx = 0; varIdx < numEq; ++varIdx)
+            dst[varIdx + 1][lane] = eval.derivative(varIdx);
+    }
+
+    // dst = a*b
+    static void multiplyBatch_(BatchEval_& dst, const BatchEval_& a, const BatchEval_& b)
+    {
+        for (unsigned varIdx = 1; varIdx <= numEq; ++varIdx)
+            for (unsigned lane = 0; lane < batchSize; ++lane)
+                dst[varIdx][lane] = a[varIdx][lane]*b[0][lane] + a[0][lane]*b[varIdx][lane];
+        for (unsigned lane = 0; lane < batchSize; ++lane)
+            dst[0][lane] = a[0][lane]*b[0][lane];
+    }
+
+    // dst += a*b
+    static void addMultipliedBatch_(BatchEval_& dst, const BatchEval_& a, const BatchEval_& b)
+    {
+        for (unsigned varIdx = 0; varIdx <= numEq; ++varIdx)
+            for (unsigned lane = 0; lane < batchSize; ++lane)
+                dst[varIdx][lane] += (varIdx == 0)
+                    ? a[0][lane]*b[0][lane]
+                    : a[varIdx][lane]*b[0][lane] + a[0][lane]*b[varIdx][lane];
+    }
+
+    using BatchScalar_ = std::array<Scalar, batchSize>;
+
+    // zero the derivatives of the cells or faces for which the mask is zero
+    static void maskDerivativesBatch_(BatchEval_& x, const BatchScalar_& mask)
+    {
+        for (unsigned varIdx = 1; varIdx <= numEq; ++varIdx)
+            for (unsigned lane = 0; lane < batchSize; ++lane)
+                x[varIdx][lane] *= mask[lane];
+    }
+
+    // x *= factor
+    static void scaleBatch_(BatchEval_& x, const BatchScalar_& factor)
+    {
+        for (unsigned varIdx = 0; varIdx <= numEq; ++varIdx)
+            for (unsigned lane = 0; lane < batchSize; ++lane)
+                x[varIdx][lane] *= factor[lane];
+    }
+
+    // dst += factor*x
+    static void addScaledBatch_(BatchEval_& dst, const BatchEval_& x, const BatchScalar_& factor)
+    {
+        for (unsigned varIdx = 0; varIdx <= numEq; ++varIdx)
+            for (unsigned lane = 0; lane < batchSize; ++lane)
+                dst[varIdx][lane] += factor[lane]*x[varIdx][lane];
+    }
+
+    static void computeFluxBatch_(RateVector* flux,
+                                  RateVector* darcy,
+                                  const unsigned* globalIndexIn,
+                                  const unsigned* globalIndexEx,
+                                  const IntensiveQuantities* const* intQuantsIn,
+                                  const IntensiveQuantities* const* intQuantsEx,
+                                  const ResidualNBInfo* const* nbInfo,
+                                  unsigned batchFaces)
+    {
+        // the unused faces of the last batch are zero, their results are discarded
+        std::array<BatchEval_, numEq> fluxBatch{};
+        BatchEval_ transMult{};
+        BatchEval_ pressureDifference{};
+        BatchEval_ mobility{};
+        BatchEval_ invB{};
+        BatchEval_ dissolution{};
+        BatchEval_ darcyFlux;
+        BatchEval_ surfaceVolumeFlux;
+        BatchEval_ tmp;
+        BatchScalar_ transFactor{};
+        BatchScalar_ upIsInterior{};
+        BatchScalar_ density{};
+        std::array<const IntensiveQuantities*, batchSize> up{};
+        std::array<unsigned, batchSize> pvtRegionIdx{};
+
+        bool skipTransMult = true;
+        for (unsigned lane = 0; lane < batchFaces; ++lane) {
+            darcy[lane] = 0.0;
+            transFactor[lane] = -nbInfo[lane]->trans / nbInfo[lane]->faceArea;
+            skipTransMult = skipTransMult && nbInfo[lane]->skipTransMult;
+        }
+
+        if (!skipTransMult) {
+            for (unsigned lane = 0; lane < batchFaces; ++lane) {
+                // use arithmetic average (more accurate with harmonic, but that requires
+                // recomputing the transmissbility)
+                const Evaluation faceTransMult =
+                    (intQuantsIn[lane]->rockCompTransMultiplier()
+                     + Toolbox::value(intQuantsEx[lane]->rockCompTransMultiplier()))/2;
+                gatherBatch_(transMult, lane, faceTransMult);
+            }
+        }
+
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!phaseIsActive_(phaseIdx))
+                continue;
+
+            // gather the pressure differences and the upstream quantities of the faces
+            BatchScalar_ nonZeroDifference{};
+            for (unsigned lane = 0; lane < batchFaces; ++lane) {
+                short upIdx;
+                short dnIdx;
+                short interiorDofIdx = 0; // NB
+                short exteriorDofIdx = 1; // NB
+                Evaluation faceDifference;
+                ExtensiveQuantities::calculatePhasePressureDiff_(upIdx,
+                                                                 dnIdx,
+                                                                 faceDifference,
+                                                                 *intQuantsIn[lane],
+                                                                 *intQuantsEx[lane],
+                                                                 phaseIdx,
+                                                                 interiorDofIdx,
+                                                                 exteriorDofIdx,
+                                                                 nbInfo[lane]->Vin,
+                                                                 nbInfo[lane]->Vex,
+                                                                 globalIndexIn[lane],
+                                                                 globalIndexEx[lane],
+                                                                 nbInfo[lane]->dZg,
+                                                                 nbInfo[lane]->thpres);
+                gatherBatch_(pressureDifference, lane, faceDifference);
+                nonZeroDifference[lane] = (faceDifference == 0) ? 0.0 : 1.0;
+
+                const bool interiorUp = (upIdx == interiorDofIdx);
+                upIsInterior[lane] = interiorUp ? 1.0 : 0.0;
+                up[lane] = interiorUp ? intQuantsIn[lane] : intQuantsEx[lane];
+                pvtRegionIdx[lane] = up[lane]->pvtRegionIndex();
+
+                const FaceDir::DirEnum facedir = faceDirFromDirId(nbInfo[lane]->dirId);
+                gatherBatch_(mobility, lane, up[lane]->mobility(phaseIdx, facedir));
+                gatherBatch_(invB, lane,
+                             getInvB_<FluidSystem, FluidState, Evaluation>(up[lane]->fluidState(),
+                                                                            phaseIdx,
+                                                                            pvtRegionIdx[lane]));
+            }
+
+            // only the quantities of the interior cell depend on its primary variables
+            maskDerivativesBatch_(mobility, upIsInterior);
+            maskDerivativesBatch_(invB, upIsInterior);
+
+            // darcyFlux = pressureDifference * mobility * transMult * (-trans / faceArea)
+            if (skipTransMult) {
+                multiplyBatch_(darcyFlux, pressureDifference, mobility);
+            }
+            else {
+                multiplyBatch_(tmp, pressureDifference, mobility);
+                multiplyBatch_(darcyFlux, tmp, transMult);
+            }
+            scaleBatch_(darcyFlux, transFactor);
+            scaleBatch_(darcyFlux, nonZeroDifference);
+
+            unsigned activeCompIdx = Indices::canonicalToActiveComponentIndex(FluidSystem::solventComponentIndex(phaseIdx));
+            for (unsigned lane = 0; lane < batchFaces; ++lane)
+                darcy[lane][conti0EqIdx + activeCompIdx] = darcyFlux[0][lane] * nbInfo[lane]->faceArea;
+
+            multiplyBatch_(surfaceVolumeFlux, invB, darcyFlux);
+            referenceDensityBatch_(density, phaseIdx, pvtRegionIdx, batchFaces);
+            addScaledBatch_(fluxBatch[conti0EqIdx + activeCompIdx], surfaceVolumeFlux, density);
+
+            // the components which are dissolved in the phase
+            const auto addDissolved = [&](unsigned dissolvedPhaseIdx, unsigned dissolvedCompIdx, auto getDissolution)
+            {
+                for (unsigned lane = 0; lane < batchFaces; ++lane)
+                    gatherBatch_(dissolution, lane, getDissolution(up[lane]->fluidState(), pvtRegionIdx[lane]));
+                maskDerivativesBatch_(dissolution, upIsInterior);
+                multiplyBatch_(tmp, dissolution, surfaceVolumeFlux);
+                referenceDensityBatch_(density, dissolvedPhaseIdx, pvtRegionIdx, batchFaces);
+                unsigned activeDissolvedCompIdx = Indices::canonicalToActiveComponentIndex(dissolvedCompIdx);
+                addScaledBatch_(fluxBatch[conti0EqIdx + activeDissolvedCompIdx], tmp, density);
+            };
+
+            if (phaseIdx == oilPhaseIdx && FluidSystem::enableDissolvedGas()) {
+                addDissolved(gasPhaseIdx, gasCompIdx, [](const FluidState& fs, unsigned regionIdx)
+                             { return BlackOil::getRs_<FluidSystem, FluidState, Evaluation>(fs, regionIdx); });
+            }
+            else if (phaseIdx == waterPhaseIdx && FluidSystem::enableDissolvedGasInWater()) {
+                addDissolved(gasPhaseIdx, gasCompIdx, [](const FluidState& fs, unsigned regionIdx)
+                             { return BlackOil::getRsw_<FluidSystem, FluidState, Evaluation>(fs, regionIdx); });
+            }
+            else if (phaseIdx == gasPhaseIdx) {
+                if (FluidSystem::enableVaporizedOil()) {
+                    addDissolved(oilPhaseIdx, oilCompIdx, [](const FluidState& fs, unsigned regionIdx)
+                                 { return BlackOil::getRv_<FluidSystem, FluidState, Evaluation>(fs, regionIdx); });
+                }
+                if (FluidSystem::enableVaporizedWater()) {
+                    addDissolved(waterPhaseIdx, waterCompIdx, [](const FluidState& fs, unsigned regionIdx)
+                                 { return BlackOil::getRvw_<FluidSystem, FluidState, Evaluation>(fs, regionIdx); });
+                }
+            }
+        }
+
+        // scatter the results
+        for (unsigned lane = 0; lane < batchFaces; ++lane) {
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                Evaluation& result = flux[lane][eqIdx];
+                result = 0.0;
+                result.setValue(fluxBatch[eqIdx][0][lane]);
+                for (unsigned varIdx = 0; varIdx < numEq; ++varIdx)
+                    result.setDerivative(varIdx, fluxBatch[eqIdx][varIdx + 1][lane]);
+            }
+        }
+    }
+
+    // the factors which convert the surface volumes of the component of a phase to the
+    // conserved quantities of the model
+    template <class RegionIndices>
+    static void referenceDensityBatch_(BatchScalar_& density,
+                                       unsigned phaseIdx,
+                                       const RegionIndices& pvtRegionIdx,
+                                       unsigned batchFaces)
+    {
+        density.fill(blackoilConserveSurfaceVolume ? 1.0 : 0.0);
+        if (blackoilConserveSurfaceVolume)
+            return;
+        for (unsigned lane = 0; lane < batchFaces; ++lane)
+            density[lane] = FluidSystem::referenceDensity(phaseIdx, pvtRegionIdx[lane]);
+    }
+
+    template <class ResBlock, class MatrixBlock>
+    static void computeStorageBatch_(ResBlock* res,
+                                     MatrixBlock* jac,
+                                     const IntensiveQuantities* const* intQuants,
+                                     unsigned batchCells)
+    {
+        // the unused cells of the last batch are zero, their results are discarded
+        std::array<BatchEval_, numEq> storage{};
+        BatchEval_ porosity{};
+        BatchEval_ saturation{};
+        BatchEval_ invB{};
+        BatchEval_ dissolution{};
+        BatchEval_ surfaceVolume;
+        BatchEval_ tmp;
+
+        for (unsigned lane = 0; lane < batchCells; ++lane)
+            gatherBatch_(porosity, lane, intQuants[lane]->porosity());
+
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!phaseIsActive_(phaseIdx)) {
+                continue;
+            }
+
+            for (unsigned lane = 0; lane < batchCells; ++lane) {
+                const auto& fs = intQuants[lane]->fluidState();
+                gatherBatch_(saturation, lane, fs.saturation(phaseIdx));
+                gatherBatch_(invB, lane, fs.invB(phaseIdx));
+            }
+
+            multiplyBatch_(tmp, saturation, invB);
+            multiplyBatch_(surfaceVolume, tmp, porosity);
+
+            unsigned activeCompIdx = Indices::canonicalToActiveComponentIndex(FluidSystem::solventComponentIndex(phaseIdx));
+            auto& compStorage = storage[conti0EqIdx + activeCompIdx];
+            for (unsigned varIdx = 0; varIdx <= numEq; ++varIdx)
+                for (unsigned lane = 0; lane < batchSize; ++lane)
+                    compStorage[varIdx][lane] += surfaceVolume[varIdx][lane];
+
+            // account for the components which are dissolved in the phase
+            int dissolvedCompIdx = -1;
+            if (phaseIdx == oilPhaseIdx && FluidSystem::enableDissolvedGas()) {
+                dissolvedCompIdx = gasCompIdx;
+                for (unsigned lane = 0; lane < batchCells; ++lane)
+                    gatherBatch_(dissolution, lane, intQuants[lane]->fluidState().Rs());
+            }
+            else if (phaseIdx == waterPhaseIdx && FluidSystem::enableDissolvedGasInWater()) {
+                dissolvedCompIdx = gasCompIdx;
+                for (unsigned lane = 0; lane < batchCells; ++lane)
+                    gatherBatch_(dissolution, lane, intQuants[lane]->fluidState().Rsw());
+            }
+            if (dissolvedCompIdx >= 0) {
+                unsigned activeDissolvedCompIdx = Indices::canonicalToActiveComponentIndex(dissolvedCompIdx);
+                addMultipliedBatch_(storage[conti0EqIdx + activeDissolvedCompIdx], dissolution, surfaceVolume);
+            }
+
+            // account for vaporized oil and water
+            if (phaseIdx == gasPhaseIdx && FluidSystem::enableVaporizedOil()) {
+                for (unsigned lane = 0; lane < batchCells; ++lane)
+                    gatherBatch_(dissolution, lane, intQuants[lane]->fluidState().Rv());
+                unsigned activeOilCompIdx = Indices::canonicalToActiveComponentIndex(oilCompIdx);
+                addMultipliedBatch_(storage[conti0EqIdx + activeOilCompIdx], dissolution, surfaceVolume);
+            }
+            if (phaseIdx == gasPhaseIdx && FluidSystem::enableVaporizedWater()) {
+                for (unsigned lane = 0; lane < batchCells; ++lane)
+                    gatherBatch_(dissolution, lane, intQuants[lane]->fluidState().Rvw());
+                unsigned activeWaterCompIdx = Indices::canonicalToActiveComponentIndex(waterCompIdx);
+                addMultipliedBatch_(storage[conti0EqIdx + activeWaterCompIdx], dissolution, surfaceVolume);
+            }
+        }
+
+        // scatter the results and convert the surface volumes to masses if required
+        for (unsigned lane = 0; lane < batchCells; ++lane) {
+            Dune::FieldVector<Scalar, numEq> factor(1.0);
+            adaptMassConservationQuantities_(factor, intQuants[lane]->pvtRegionIndex());
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                res[lane][eqIdx] = storage[eqIdx][0][lane]*factor[eqIdx];
+                for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                    jac[lane][eqIdx][pvIdx] = storage[eqIdx][pvIdx + 1][lane]*factor[eqIdx];
+            }
+        }
+    }
+
     static FaceDir::DirEnum faceDirFromDirId(const int dirId)
     {
         // NNC does not have a direction
@@ -32,6 +32,8 @@
 
 #include <opm/models/blackoil/blackoilmicpparams.hh>
 #include <opm/models/io/vtkblackoilmicpmodule.hh>
+#include <opm/models/parallel/threadedentityiterator.hh>
+#include <opm/models/utils/parametersystem.hh>
 
 #if HAVE_ECL_INPUT
 #include <opm/input/eclipse/EclipseState/EclipseState.hpp>
@@ -40,10 +42,13 @@
 
 #include <dune/common/fvector.hh>
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstddef>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace Opm {
 /*!
@@ -63,6 +68,7 @@ class BlackOilMICPModule
     using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
     using Model = GetPropType<TypeTag, Properties::Model>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
     using EqVector = GetPropType<TypeTag, Properties::EqVector>;
     using RateVector = GetPropType<TypeTag, Properties::RateVector>;
     using Indices = GetPropType<TypeTag, Properties::Indices>;
@@ -197,6 +203,25 @@ public:
             return;
 
         VtkBlackOilMICPModule<TypeTag>::registerParameters();
+
+        Parameters::registerParam<TypeTag, Properties::MICPReactionSplitting>
+            ("Integrate the MICP reactions separately from the transport at the end of "
+             "each time step instead of including them in the fully implicit residual");
+        Parameters::registerParam<TypeTag, Properties::MICPReactionTolerance>
+            ("The relative tolerance of the adaptive sub-stepping of the MICP reactions "
+             "if they are integrated separately from the transport");
+    }
+
+    /*!
+     * \brief Returns true if the MICP reactions are integrated separately from the
+     *        transport.
+     */
+    static bool reactionSplitting()
+    {
+        if (!enableMICP)
+            return false;
+
+        return Parameters::get<TypeTag, Properties::MICPReactionSplitting>();
     }
 
     /*!
@@ -300,52 +325,102 @@ public:
         if (!enableMICP)
             return;
 
-        // compute dpW (max norm of the pressure gradient in the cell center)
+        // the reactions are integrated after the transport step if operator splitting
+        // is used
+        if (reactionSplitting())
+            return;
+
         const IntensiveQuantities& intQuants = elemCtx.intensiveQuantities(dofIdx, timeIdx);
-        const auto& K = elemCtx.problem().intrinsicPermeability(elemCtx, dofIdx, 0);
-        size_t numInteriorFaces = elemCtx.numInteriorFaces(timeIdx);
-        Evaluation dpW = 0;
-        for (unsigned scvfIdx = 0; scvfIdx < numInteriorFaces; scvfIdx++) {
-          const auto& extQuants = elemCtx.extensiveQuantities(scvfIdx, timeIdx);
-          unsigned upIdx = extQuants.upstreamIndex(waterPhaseIdx);
-          const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
-          const Evaluation& mobWater = up.mobility(waterPhaseIdx);
+        const Evaluation dpW = waterPressureGradient_(elemCtx, dofIdx, timeIdx);
+
+        Evaluation rates[numReactionComponents_];
+        reactionRates_(rates,
+                       intQuants.microbialConcentration(),
+                       intQuants.oxygenConcentration(),
+                       intQuants.ureaConcentration(),
+                       intQuants.biofilmConcentration(),
+                       intQuants.porosity(),
+                       dpW);
+
+        source[Indices::contiMicrobialEqIdx] += rates[0];
+        source[Indices::contiOxygenEqIdx] += rates[1];
+        source[Indices::contiUreaEqIdx] += rates[2];
+        source[Indices::contiBiofilmEqIdx] += rates[3];
+        source[Indices::contiCalciteEqIdx] += rates[4];
+    }
 
-          // compute water velocity from flux
-          Evaluation waterVolumeVelocity = extQuants.volumeFlux(waterPhaseIdx) / (K[0][0] * mobWater);
-          dpW = std::max(dpW, abs(waterVolumeVelocity));
+    /*!
+     * \brief Integrate the MICP reactions of all degrees of freedom over the current
+     *        time step.
+     *
+     * This is the reaction step of a sequential (Lie) operator splitting: The
+     * transport has been solved for the time step without the reaction terms, and
+     * the reactions of each cell are then integrated with an embedded Runge-Kutta
+     * method of order 3(2) (Bogacki-Shampine) using adaptive sub-steps. The pressure,
+     * the part of the porosity which is not due to biofilm and calcite and the
+     * detachment caused by the water flow are kept constant during the reaction step.
+     * This requires an element-centered discretization.
+     *
+     * \return false if the sub-stepping failed for any cell on any process. In this
+     *         case the solution is not modified.
+     */
+    static bool integrateReactions(Model& model, const Simulator& simulator)
+    {
+        if (!reactionSplitting())
+            return true;
+
+        const Scalar dt = simulator.timeStepSize();
+        const Scalar tolerance = Parameters::get<TypeTag, Properties::MICPReactionTolerance>();
+        auto& solution = model.solution(/*timeIdx=*/0);
+        const unsigned numDof = static_cast<unsigned>(solution.size());
+
+        // the quantities which are frozen during the reaction step are determined before
+        // any primary variable is modified because the intensive quantities of the
+        // neighbors are required as well
+        std::vector<Scalar> basePorosity(numDof, 0.0);
+        std::vector<Scalar> dpW(numDof, 0.0);
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(simulator.gridView());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            ElementContext elemCtx(simulator);
+            auto elemIt = threadedElemIt.beginParallel();
+            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                elemCtx.updateStencil(*elemIt);
+                elemCtx.updateIntensiveQuantities(/*timeIdx=*/0);
+                elemCtx.updateExtensiveQuantities(/*timeIdx=*/0);
+
+                const unsigned globalIdx = elemCtx.globalSpaceIndex(/*dofIdx=*/0, /*timeIdx=*/0);
+                const auto& intQuants = elemCtx.intensiveQuantities(/*dofIdx=*/0, /*timeIdx=*/0);
+                basePorosity[globalIdx] =
+                    getValue(intQuants.porosity())
+                    + getValue(intQuants.biofilmConcentration())
+                    + getValue(intQuants.calciteConcentration());
+                dpW[globalIdx] = getValue(waterPressureGradient_(elemCtx, /*dofIdx=*/0, /*timeIdx=*/0));
+            }
         }
 
-        // get the model parameters
-        Scalar k_a = microbialAttachmentRate();
-        Scalar k_d = microbialDeathRate();
-        Scalar rho_b = densityBiofilm();
-        Scalar rho_c = densityCalcite();
-        Scalar k_str = detachmentRate();
-        Scalar k_o = halfVelocityOxygen();
-        Scalar k_u = halfVelocityUrea() / 10.0;//Dividing by scaling factor 10 (see WellInterface_impl.hpp)
-        Scalar mu = maximumGrowthRate();
-        Scalar mu_u = maximumUreaUtilization() / 10.0;//Dividing by scaling factor 10 (see WellInterface_impl.hpp)
-        Scalar Y_sb = yieldGrowthCoefficient();
-        Scalar F = oxygenConsumptionFactor();
-        Scalar Y_uc = 1.67 * 10; //Multiplying by scaling factor 10 (see WellInterface_impl.hpp)
-
-        // compute the processes
-        source[Indices::contiMicrobialEqIdx] += intQuants.microbialConcentration() * intQuants.porosity() *
-                                                      (Y_sb * mu * intQuants.oxygenConcentration() / (k_o + intQuants.oxygenConcentration()) - k_d - k_a)
-                                                + rho_b * intQuants.biofilmConcentration() * k_str * pow(intQuants.porosity() * dpW, 0.58);
-
-        source[Indices::contiOxygenEqIdx] -= (intQuants.microbialConcentration() * intQuants.porosity() + rho_b * intQuants.biofilmConcentration()) *
-                                                    F * mu * intQuants.oxygenConcentration() / (k_o + intQuants.oxygenConcentration());
-
-        source[Indices::contiUreaEqIdx] -= rho_b * intQuants.biofilmConcentration() * mu_u * intQuants.ureaConcentration() / (k_u + intQuants.ureaConcentration());
+        std::vector<PrimaryVariables> newSolution(solution.begin(), solution.end());
+        int success = 1;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(min:success)
+#endif
+        for (int dofIdx = 0; dofIdx < static_cast<int>(numDof); ++dofIdx) {
+            if (!integrateCellReactions_(newSolution[dofIdx], basePorosity[dofIdx],
+                                         dpW[dofIdx], dt, tolerance))
+                success = 0;
+        }
 
-        source[Indices::contiBiofilmEqIdx] += intQuants.biofilmConcentration() * (Y_sb * mu * intQuants.oxygenConcentration() / (k_o + intQuants.oxygenConcentration()) - k_d
-                                                              - k_str * pow(intQuants.porosity() * dpW, 0.58) - Y_uc * (rho_b / rho_c) * intQuants.biofilmConcentration() * mu_u *
-                                                                  (intQuants.ureaConcentration() / (k_u + intQuants.ureaConcentration())) / (intQuants.porosity() + intQuants.biofilmConcentration()))
-                                              + k_a * intQuants.microbialConcentration() * intQuants.porosity() / rho_b;
+        success = simulator.gridView().comm().min(success);
+        if (!success)
+            return false;
 
-        source[Indices::contiCalciteEqIdx] += (rho_b / rho_c) * intQuants.biofilmConcentration() * Y_uc * mu_u * intQuants.ureaConcentration() / (k_u + intQuants.ureaConcentration());
+        for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            solution[dofIdx] = newSolution[dofIdx];
+        model.syncOverlap();
+        model.invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+        return true;
     }
 
     static const Scalar densityBiofilm()
@@ -439,6 +514,174 @@ public:
     }
 
 private:
+    // the MICP components which take part in the reactions: the suspended microbes,
+    // oxygen, urea, biofilm and calcite
+    static constexpr unsigned numReactionComponents_ = 5;
+    using ReactionState_ = std::array<Scalar, numReactionComponents_>;
+
+    // compute dpW (max norm of the pressure gradient in the cell center)
+    static Evaluation waterPressureGradient_(const ElementContext& elemCtx,
+                                             unsigned dofIdx,
+                                             unsigned timeIdx)
+    {
+        const auto& K = elemCtx.problem().intrinsicPermeability(elemCtx, dofIdx, 0);
+        size_t numInteriorFaces = elemCtx.numInteriorFaces(timeIdx);
+        Evaluation dpW = 0;
+        for (unsigned scvfIdx = 0; scvfIdx < numInteriorFaces; scvfIdx++) {
+          const auto& extQuants = elemCtx.extensiveQuantities(scvfIdx, timeIdx);
+          unsigned upIdx = extQuants.upstreamIndex(waterPhaseIdx);
+          const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
+          const Evaluation& mobWater = up.mobility(waterPhaseIdx);
+
+          // compute water velocity from flux
+          Evaluation waterVolumeVelocity = extQuants.volumeFlux(waterPhaseIdx) / (K[0][0] * mobWater);
+          dpW = std::max(dpW, abs(waterVolumeVelocity));
+        }
+        return dpW;
+    }
+
+    // the rates of change of the stored microbes, oxygen, urea, biofilm and calcite
+    // per bulk volume. See https://doi.org/10.1016/j.ijggc.2021.103256 for the
+    // micp processes in the model.
+    template <class Eval>
+    static void reactionRates_(Eval* rates,
+                               const Eval& microbialConcentration,
+                               const Eval& oxygenConcentration,
+                               const Eval& ureaConcentration,
+                               const Eval& biofilmConcentration,
+                               const Eval& porosity,
+                               const Eval& dpW)
+    {
+        // get the model parameters
+        Scalar k_a = microbialAttachmentRate();
+        Scalar k_d = microbialDeathRate();
+        Scalar rho_b = densityBiofilm();
+        Scalar rho_c = densityCalcite();
+        Scalar k_str = detachmentRate();
+        Scalar k_o = halfVelocityOxygen();
+        Scalar k_u = halfVelocityUrea() / 10.0;//Dividing by scaling factor 10 (see WellInterface_impl.hpp)
+        Scalar mu = maximumGrowthRate();
+        Scalar mu_u = maximumUreaUtilization() / 10.0;//Dividing by scaling factor 10 (see WellInterface_impl.hpp)
+        Scalar Y_sb = yieldGrowthCoefficient();
+        Scalar F = oxygenConsumptionFactor();
+        Scalar Y_uc = 1.67 * 10; //Multiplying by scaling factor 10 (see WellInterface_impl.hpp)
+
+        // compute the processes
+        rates[0] = microbialConcentration * porosity *
+                       (Y_sb * mu * oxygenConcentration / (k_o + oxygenConcentration) - k_d - k_a)
+                   + rho_b * biofilmConcentration * k_str * pow(porosity * dpW, 0.58);
+
+        rates[1] = -(microbialConcentration * porosity + rho_b * biofilmConcentration) *
+                   F * mu * oxygenConcentration / (k_o + oxygenConcentration);
+
+        rates[2] = -rho_b * biofilmConcentration * mu_u * ureaConcentration / (k_u + ureaConcentration);
+
+        rates[3] = biofilmConcentration * (Y_sb * mu * oxygenConcentration / (k_o + oxygenConcentration) - k_d
+                                           - k_str * pow(porosity * dpW, 0.58) - Y_uc * (rho_b / rho_c) * biofilmConcentration * mu_u *
+                                               (ureaConcentration / (k_u + ureaConcentration)) / (porosity + biofilmConcentration))
+                   + k_a * microbialConcentration * porosity / rho_b;
+
+        rates[4] = (rho_b / rho_c) * biofilmConcentration * Y_uc * mu_u * ureaConcentration / (k_u + ureaConcentration);
+    }
+
+    // the rates of change of the stored quantities of a cell, i.e., the porosity times
+    // the concentrations of the components in the water and the volume fractions of
+    // biofilm and calcite
+    static ReactionState_ storageRates_(const ReactionState_& storage,
+                                        Scalar basePorosity,
+                                        Scalar dpW)
+    {
+        const Scalar biofilm = std::max(storage[3], Scalar{0.0});
+        const Scalar porosity = basePorosity - biofilm - std::max(storage[4], Scalar{0.0});
+        // avoid singular matrix if no water is present.
+        const Scalar waterVolume = std::max(porosity, Scalar{1e-10});
+
+        ReactionState_ rates;
+        reactionRates_(rates.data(),
+                       std::max(storage[0], Scalar{0.0})/waterVolume,
+                       std::max(storage[1], Scalar{0.0})/waterVolume,
+                       std::max(storage[2], Scalar{0.0})/waterVolume,
+                       biofilm,
+                       porosity,
+                       dpW);
+        return rates;
+    }
+
+    // integrate the reactions of a single cell over a time interval. returns false if
+    // the maximum number of sub-steps is exceeded.
+    static bool integrateCellReactions_(PrimaryVariables& priVars,
+                                        Scalar basePorosity,
+                                        Scalar dpW,
+                                        Scalar dt,
+                                        Scalar tolerance)
+    {
+        constexpr unsigned maxSubsteps = 10000;
+        constexpr unsigned n = numReactionComponents_;
+
+        // the integration is done for the stored quantities of the components because
+        // the porosity changes with biofilm and calcite
+        const Scalar waterVolume0 =
+            std::max(basePorosity - priVars[biofilmConcentrationIdx] - priVars[calciteConcentrationIdx],
+                     Scalar{1e-10});
+        ReactionState_ y = {waterVolume0*priVars[microbialConcentrationIdx],
+                            waterVolume0*priVars[oxygenConcentrationIdx],
+                            waterVolume0*priVars[ureaConcentrationIdx],
+                            priVars[biofilmConcentrationIdx],
+                            priVars[calciteConcentrationIdx]};
+
+        ReactionState_ k1 = storageRates_(y, basePorosity, dpW);
+        ReactionState_ k2, k3, k4, yTmp, yNew;
+        Scalar t = 0.0;
+        Scalar h = dt;
+        unsigned numSubsteps = 0;
+        while (t < dt) {
+            if (++numSubsteps > maxSubsteps)
+                return false;
+
+            h = std::min(h, dt - t);
+            for (unsigned i = 0; i < n; ++i)
+                yTmp[i] = y[i] + 0.5*h*k1[i];
+            k2 = storageRates_(yTmp, basePorosity, dpW);
+            for (unsigned i = 0; i < n; ++i)
+                yTmp[i] = y[i] + 0.75*h*k2[i];
+            k3 = storageRates_(yTmp, basePorosity, dpW);
+            for (unsigned i = 0; i < n; ++i)
+                yNew[i] = y[i] + h*(2.0/9*k1[i] + 1.0/3*k2[i] + 4.0/9*k3[i]);
+            k4 = storageRates_(yNew, basePorosity, dpW);
+
+            // the error estimate is the difference to the embedded second order method
+            Scalar err = 0.0;
+            for (unsigned i = 0; i < n; ++i) {
+                const Scalar y2 = y[i] + h*(7.0/24*k1[i] + 1.0/4*k2[i] + 1.0/3*k3[i] + 1.0/8*k4[i]);
+                const Scalar scale = tolerance*(std::max(std::abs(y[i]), std::abs(yNew[i])) + 1e-10);
+                err = std::max(err, std::abs(yNew[i] - y2)/scale);
+            }
+
+            if (!std::isfinite(err))
+                return false;
+
+            if (err <= 1.0) {
+                t += h;
+                for (unsigned i = 0; i < n; ++i)
+                    y[i] = std::max(yNew[i], Scalar{0.0});
+                // the last stage is evaluated at the new solution (FSAL), but it needs
+                // to be recomputed if the solution was clamped
+                k1 = (y == yNew) ? k4 : storageRates_(y, basePorosity, dpW);
+            }
+
+            const Scalar factor = (err > 0.0) ? 0.9*std::pow(err, -1.0/3) : 5.0;
+            h *= std::clamp(factor, Scalar{0.2}, Scalar{5.0});
+        }
+
+        const Scalar waterVolume = std::max(basePorosity - y[3] - y[4], Scalar{1e-10});
+        priVars[microbialConcentrationIdx] = y[0]/waterVolume;
+        priVars[oxygenConcentrationIdx] = y[1]/waterVolume;
+        priVars[ureaConcentrationIdx] = y[2]/waterVolume;
+        priVars[biofilmConcentrationIdx] = y[3];
+        priVars[calciteConcentrationIdx] = y[4];
+        return true;
+    }
+
     static BlackOilMICPParams<Scalar> params_;
 };
 
@@ -48,6 +48,8 @@
 #include "blackoilextbomodules.hh"
 #include "blackoildarcyfluxmodule.hh"
 #include "blackoilmicpmodules.hh"
+#include "blackoilenergyquantitycache.hh"
+#include "blackoilrockcompactioncache.hh"
 
 #include <opm/models/common/multiphasebasemodel.hh>
 #include <opm/models/io/vtkcompositionmodule.hh>
@@ -58,8 +60,13 @@
 
 #include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
 
+#include <cstddef>
+#include <iostream>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace Opm {
 template <class TypeTag>
@@ -168,6 +175,17 @@ struct EnableSaltPrecipitation<TypeTag, TTag::BlackOilModel> { static constexpr
 template<class TypeTag>
 struct EnableMICP<TypeTag, TTag::BlackOilModel> { static constexpr bool value = false; };
 
+//! by default, the MICP reactions are part of the fully implicit residual
+template<class TypeTag>
+struct MICPReactionSplitting<TypeTag, TTag::BlackOilModel> { static constexpr bool value = false; };
+
+template<class TypeTag>
+struct MICPReactionTolerance<TypeTag, TTag::BlackOilModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1e-6;
+};
+
 //! By default, the blackoil model is isothermal and does not conserve energy
 template<class TypeTag>
 struct EnableTemperature<TypeTag, TTag::BlackOilModel> { static constexpr bool value = false; };
@@ -205,6 +223,35 @@ public:
 template<class TypeTag>
 struct BlackoilConserveSurfaceVolume<TypeTag, TTag::BlackOilModel> { static constexpr bool value = false; };
 
+// by default, the tables of the polymer, solvent and extended black-oil extensions are
+// not resampled
+template<class TypeTag>
+struct TableResamplingTolerance<TypeTag, TTag::BlackOilModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.0;
+};
+
+// by default, the intensive quantities use the full black-oil fluid state
+template<class TypeTag>
+struct EnableCompactFluidState<TypeTag, TTag::BlackOilModel> { static constexpr bool value = false; };
+
+// by default, the energy related quantities are always evaluated completely
+template<class TypeTag>
+struct EnergyQuantityReuseTolerance<TypeTag, TTag::BlackOilModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.0;
+};
+
+// by default, the rock compaction multipliers are always evaluated completely
+template<class TypeTag>
+struct RockCompactionReuseTolerance<TypeTag, TTag::BlackOilModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.0;
+};
+
 } // namespace Opm::Properties
 
 namespace Opm {
@@ -285,6 +332,7 @@ private:
     using ParentType = MultiPhaseBaseModel<TypeTag>;
 
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
     using Discretization = GetPropType<TypeTag, Properties::Discretization>;
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
@@ -294,6 +342,10 @@ private:
     enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
     enum { enableDiffusion = getPropValue<TypeTag, Properties::EnableDiffusion>() };
     enum { enableDispersion = getPropValue<TypeTag, Properties::EnableDispersion>() };
+    enum { enableSolvent = getPropValue<TypeTag, Properties::EnableSolvent>() };
+    enum { enablePolymer = getPropValue<TypeTag, Properties::EnablePolymer>() };
+    enum { enableExtbo = getPropValue<TypeTag, Properties::EnableExtbo>() };
+    enum { enableEnergy = getPropValue<TypeTag, Properties::EnableEnergy>() };
 
     static constexpr bool compositionSwitchEnabled = Indices::compositionSwitchIdx >= 0;
     static constexpr bool waterEnabled = Indices::waterEnabled;
@@ -309,6 +361,8 @@ private:
 public:
 
     using LocalResidual = GetPropType<TypeTag, Properties::LocalResidual>;
+    using EnergyQuantityCache = BlackOilEnergyQuantityCache<Scalar, Evaluation, PrimaryVariables, numPhases>;
+    using RockCompactionCache = BlackOilRockCompactionCache<Scalar, Evaluation, PrimaryVariables>;
 
     BlackOilModel(Simulator& simulator)
         : ParentType(simulator)
@@ -330,12 +384,101 @@ public:
         DiffusionModule::registerParameters();
         MICPModule::registerParameters();
 
+        if constexpr (enableSolvent || enablePolymer || enableExtbo) {
+            Parameters::registerParam<TypeTag, Properties::TableResamplingTolerance>
+                ("The relative tolerance for resampling the tables of the polymer, "
+                 "solvent and extended black-oil extensions on uniform grids, which "
+                 "avoids the search for the table intervals. Zero disables the resampling");
+        }
+
+        Parameters::registerParam<TypeTag, Properties::RockCompactionReuseTolerance>
+            ("The maximum change of the pressure [Pa] of a cell since the last complete "
+             "evaluation of its rock compaction multipliers for which these are "
+             "extrapolated linearly instead. Zero disables the extrapolation");
+
         // register runtime parameters of the VTK output modules
         VtkBlackOilModule<TypeTag>::registerParameters();
         VtkCompositionModule<TypeTag>::registerParameters();
         VtkDiffusionModule<TypeTag>::registerParameters();
     }
 
+    /*!
+     * \copydoc FvBaseDiscretization::finishInit
+     */
+    void finishInit()
+    {
+        if constexpr (enableEnergy) {
+            const Scalar tolerance = Parameters::get<TypeTag, Properties::EnergyQuantityReuseTolerance>();
+            if (tolerance > 0.0) {
+                energyQuantityCache_ = std::make_unique<EnergyQuantityCache>(tolerance);
+                energyQuantityCache_->resize(this->numGridDof());
+            }
+        }
+
+        const Scalar rockCompTolerance = Parameters::get<TypeTag, Properties::RockCompactionReuseTolerance>();
+        if (rockCompTolerance > 0.0) {
+            rockCompactionCache_ = std::make_unique<RockCompactionCache>(rockCompTolerance);
+            rockCompactionCache_->resize(this->numGridDof());
+        }
+
+        ParentType::finishInit();
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::intensiveQuantityUpdateKey
+     *
+     * The degrees of freedom are grouped by their PVT regions first and by their
+     * saturation function regions second.
+     */
+    unsigned intensiveQuantityUpdateKey(unsigned globalIdx) const
+    {
+        const unsigned pvtRegionIdx = this->solution(/*timeIdx=*/0)[globalIdx].pvtRegionIndex();
+        const auto satnumRegionIdx =
+            static_cast<unsigned>(this->simulator_.problem().satnumRegionIndex(globalIdx));
+        return (pvtRegionIdx << 16) | (satnumRegionIdx & 0xffff);
+    }
+
+    /*!
+     * \brief Returns the energy related quantities of the last complete evaluation of
+     *        each degree of freedom.
+     *
+     * This is nullptr unless the energy extension is enabled and a positive tolerance
+     * for reusing these quantities is specified.
+     */
+    EnergyQuantityCache* energyQuantityCache() const
+    { return energyQuantityCache_.get(); }
+
+    /*!
+     * \brief Returns the rock compaction multipliers of the last complete evaluation
+     *        of each degree of freedom.
+     *
+     * This is nullptr unless a positive tolerance for reusing the multipliers is
+     * specified.
+     */
+    RockCompactionCache* rockCompactionCache() const
+    { return rockCompactionCache_.get(); }
+
+    /*!
+     * \copydoc FvBaseDiscretization::update
+     *
+     * If the MICP reactions are integrated separately, this is done after the transport
+     * step has converged. If their integration fails, the time step is treated like
+     * one for which the Newton method did not converge.
+     */
+    bool update()
+    {
+        if (!ParentType::update())
+            return false;
+
+        if (MICPModule::integrateReactions(asImp_(), this->simulator_))
+            return true;
+
+        if (this->gridView().comm().rank() == 0)
+            std::cout << "Integration of the MICP reactions failed\n" << std::flush;
+        asImp_().updateFailed();
+        return false;
+    }
+
     /*!
      * \copydoc FvBaseDiscretization::name
      */
@@ -467,8 +610,8 @@ public:
      *                  be serialized to
      * \param dof The Dune entity which's data should be serialized
      */
-    template <class DofEntity>
-    void serializeEntity(std::ostream& outstream, const DofEntity& dof)
+    template <class OutStream, class DofEntity>
+    void serializeEntity(OutStream& outstream, const DofEntity& dof)
     {
         unsigned dofIdx = static_cast<unsigned>(asImp_().dofMapper().index(dof));
 
@@ -502,8 +645,8 @@ public:
      *                  be deserialized from
      * \param dof The Dune entity which's data should be deserialized
      */
-    template <class DofEntity>
-    void deserializeEntity(std::istream& instream,
+    template <class InStream, class DofEntity>
+    void deserializeEntity(InStream& instream,
                            const DofEntity& dof)
     {
         unsigned dofIdx = static_cast<unsigned>(asImp_().dofMapper().index(dof));
@@ -547,6 +690,79 @@ public:
         priVars.setPvtRegionIndex(pvtRegionIdx);
     }
 
+    /*!
+     * \brief Write the current solution of all degrees of freedom to a binary
+     *        restart file.
+     *
+     * The values of the primary variables of the modules are part of the primary
+     * variables written by the discretization, so only the pseudo primary variables
+     * need to be added here.
+     *
+     * \param outstream The binary stream into which the data should be serialized
+     */
+    template <class OutStream>
+    void serializeEntityBlocks(OutStream& outstream)
+    {
+        // write the primary variables
+        ParentType::serializeEntityBlocks(outstream);
+
+        // write the pseudo primary variables
+        const std::size_t numDof = this->numGridDof();
+        std::vector<int> meaningGas(numDof);
+        std::vector<int> meaningWater(numDof);
+        std::vector<int> meaningPressure(numDof);
+        std::vector<unsigned> pvtRegionIdx(numDof);
+        for (std::size_t dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+            const auto& priVars = this->solution(/*timeIdx=*/0)[dofIdx];
+            meaningGas[dofIdx] = static_cast<int>(priVars.primaryVarsMeaningGas());
+            meaningWater[dofIdx] = static_cast<int>(priVars.primaryVarsMeaningWater());
+            meaningPressure[dofIdx] = static_cast<int>(priVars.primaryVarsMeaningPressure());
+            pvtRegionIdx[dofIdx] = priVars.pvtRegionIndex();
+        }
+
+        outstream.writeBlock(meaningGas.data(), numDof);
+        outstream.writeBlock(meaningWater.data(), numDof);
+        outstream.writeBlock(meaningPressure.data(), numDof);
+        outstream.writeBlock(pvtRegionIdx.data(), numDof);
+    }
+
+    /*!
+     * \brief Reads the current solution of all degrees of freedom from a binary
+     *        restart file.
+     *
+     * \param instream The binary stream from which the data should be deserialized
+     */
+    template <class InStream>
+    void deserializeEntityBlocks(InStream& instream)
+    {
+        // read the primary variables
+        ParentType::deserializeEntityBlocks(instream);
+
+        // read the pseudo primary variables
+        const std::size_t numDof = this->numGridDof();
+        std::vector<int> meaningGas(numDof);
+        std::vector<int> meaningWater(numDof);
+        std::vector<int> meaningPressure(numDof);
+        std::vector<unsigned> pvtRegionIdx(numDof);
+        instream.readBlock(meaningGas.data(), numDof);
+        instream.readBlock(meaningWater.data(), numDof);
+        instream.readBlock(meaningPressure.data(), numDof);
+        instream.readBlock(pvtRegionIdx.data(), numDof);
+        if (!instream.good())
+            throw std::runtime_error("Could not deserialize the pseudo primary variables");
+
+        using PVM_G = typename PrimaryVariables::GasMeaning;
+        using PVM_W = typename PrimaryVariables::WaterMeaning;
+        using PVM_P = typename PrimaryVariables::PressureMeaning;
+        for (std::size_t dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+            auto& priVars = this->solution(/*timeIdx=*/0)[dofIdx];
+            priVars.setPrimaryVarsMeaningGas(static_cast<PVM_G>(meaningGas[dofIdx]));
+            priVars.setPrimaryVarsMeaningWater(static_cast<PVM_W>(meaningWater[dofIdx]));
+            priVars.setPrimaryVarsMeaningPressure(static_cast<PVM_P>(meaningPressure[dofIdx]));
+            priVars.setPvtRegionIndex(pvtRegionIdx[dofIdx]);
+        }
+    }
+
     /*!
      * \brief Deserializes the state of the model.
      *
@@ -611,6 +827,8 @@ protected:
 private:
 
     std::vector<Scalar> eqWeights_;
+    std::unique_ptr<EnergyQuantityCache> energyQuantityCache_;
+    std::unique_ptr<RockCompactionCache> rockCompactionCache_;
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
     const Implementation& asImp_() const
@@ -147,6 +147,7 @@ class BlackOilNewtonMethod : public GetPropType<TypeTag, Properties::DiscNewtonM
     using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using Linearizer = GetPropType<TypeTag, Properties::Linearizer>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
     using MICPModule = BlackOilMICPModule<TypeTag>;
 
     static const unsigned numEq = getPropValue<TypeTag, Properties::NumEq>();
@@ -176,7 +177,8 @@ public:
         ParentType::finishInit();
 
         wasSwitched_.resize(this->model().numTotalDof());
-        std::fill(wasSwitched_.begin(), wasSwitched_.end(), false);
+        std::fill(wasSwitched_.begin(), wasSwitched_.end(), 0);
+        numPriVarsSwitchedByThread_.assign(ThreadManager::maxThreads(), 0);
     }
 
     /*!
@@ -274,6 +276,7 @@ public:
         catch (...) {
             succeeded = 0;
         }
+        collectNumPriVarsSwitched_();
         succeeded = comm.min(succeeded);
 
         if (!succeeded)
@@ -300,9 +303,16 @@ public:
                                     solutionUpdate[dofIdx],
                                     currentResidual[dofIdx]);
         }
+        collectNumPriVarsSwitched_();
     }
 
 protected:
+    /*!
+     * \copydoc NewtonMethod::threadSafeUpdate_
+     */
+    static constexpr bool threadSafeUpdate_()
+    { return true; }
+
     /*!
      * \copydoc FvBaseNewtonMethod::updatePrimaryVariables_
      */
@@ -501,7 +511,7 @@ protected:
             wasSwitched_[globalDofIdx] = nextValue.adaptPrimaryVariables(this->problem(), globalDofIdx, waterSaturationMax_, waterOnlyThreshold_);
 
         if (wasSwitched_[globalDofIdx])
-            ++ numPriVarsSwitched_;
+            ++ numPriVarsSwitchedByThread_[ThreadManager::threadId()];
         if(projectSaturations_){
             nextValue.chopAndNormalizeSaturations();
         }
@@ -510,7 +520,20 @@ protected:
     }
 
 private:
+    // add the switches counted by the threads to the number of switched degrees of
+    // freedom of the iteration
+    void collectNumPriVarsSwitched_()
+    {
+        for (int& numSwitched : numPriVarsSwitchedByThread_) {
+            numPriVarsSwitched_ += numSwitched;
+            numSwitched = 0;
+        }
+    }
+
     int numPriVarsSwitched_;
+    // the primary variables may be updated by several threads, which count their
+    // switches separately
+    std::vector<int> numPriVarsSwitchedByThread_;
 
     Scalar priVarOscilationThreshold_;
     Scalar waterSaturationMax_;
@@ -526,8 +549,9 @@ private:
     Scalar pressMin_;
 
     // keep track of cells where the primary variable meaning has changed
-    // to detect and hinder oscillations
-    std::vector<bool> wasSwitched_;
+    // to detect and hinder oscillations. this is not a std::vector<bool> because the
+    // entries are written concurrently
+    std::vector<unsigned char> wasSwitched_;
 };
 } // namespace Opm
 
@@ -0,0 +1,563 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::BlackOilOffloadFluxKernel
+ */
+#ifndef EWOMS_BLACK_OIL_OFFLOAD_FLUX_KERNEL_HH
+#define EWOMS_BLACK_OIL_OFFLOAD_FLUX_KERNEL_HH
+
+#include "blackoilproperties.hh"
+
+#include <opm/models/utils/memoryusage.hh>
+
+#include <opm/material/fluidstates/BlackOilFluidState.hpp>
+#include <opm/input/eclipse/EclipseState/Grid/FaceDir.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup BlackOilModel
+ *
+ * \brief Computes the two-point fluxes of the black-oil model and their derivatives
+ *        on an accelerator device using OpenMP target offloading.
+ *
+ * The connections of the cells are copied to the device once by setStructure() and
+ * stay there until release() is called. For each linearization, the quantities of the
+ * cells which enter the fluxes (the phase pressures, densities, mobilities and
+ * inverse formation volume factors, the dissolution factors and the transmissibility
+ * multiplier, each with its derivatives) are gathered from the intensive quantities
+ * into arrays which are indexed by the cell, and then transferred to the device. There,
+ * the fluxes of each cell are computed and reduced into its residual, the derivatives
+ * with regard to its own primary variables and the ones of the off-diagonal blocks of
+ * its neighbors. Like for the host code, the flux over each face is thus computed from
+ * both sides. If the compiler does not support offloading or no device is available,
+ * the kernel is executed by the threads of the host.
+ *
+ * The fluxes are the same as the ones of BlackOilLocalResidualTPFA for models which
+ * do not enable any additional module: the phase pressure differences include the
+ * gravity term with the arithmetic mean of the densities and the threshold pressure
+ * of the face, and the mobilities, inverse formation volume factors and dissolution
+ * factors are taken from the upstream cell. Directional mobilities are not supported;
+ * updateCellQuantities() reports them so that the caller can fall back to the host.
+ */
+template <class TypeTag>
+class BlackOilOffloadFluxKernel
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
+    using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using FluidState = typename IntensiveQuantities::FluidState;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+    enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
+    enum { conti0EqIdx = Indices::conti0EqIdx };
+
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+    enum { waterPhaseIdx = FluidSystem::waterPhaseIdx };
+
+    static constexpr bool blackoilConserveSurfaceVolume =
+        getPropValue<TypeTag, Properties::BlackoilConserveSurfaceVolume>();
+
+    // the value and the derivatives of a quantity
+    static constexpr int evalSize = numEq + 1;
+    static constexpr int blockSize = numEq*numEq;
+
+    // the quantities of the cells. The ones which depend on the phase occupy one slot
+    // per phase.
+    enum {
+        pressureQ = 0,
+        densityQ = pressureQ + numPhases,
+        mobilityQ = densityQ + numPhases,
+        invBQ = mobilityQ + numPhases,
+        rsQ = invBQ + numPhases,
+        rswQ,
+        rvQ,
+        rvwQ,
+        transMultQ,
+        numQuantities
+    };
+
+public:
+    //! Specifies whether the kernel supports the current model, i.e., whether none of
+    //! the modules which contribute to the fluxes is enabled
+    static constexpr bool supported =
+        !getPropValue<TypeTag, Properties::EnableSolvent>()
+        && !getPropValue<TypeTag, Properties::EnableExtbo>()
+        && !getPropValue<TypeTag, Properties::EnablePolymer>()
+        && !getPropValue<TypeTag, Properties::EnableEnergy>()
+        && !getPropValue<TypeTag, Properties::EnableFoam>()
+        && !getPropValue<TypeTag, Properties::EnableBrine>()
+        && !getPropValue<TypeTag, Properties::EnableDiffusion>()
+        && !getPropValue<TypeTag, Properties::EnableDispersion>()
+        && !getPropValue<TypeTag, Properties::EnableMICP>();
+
+    BlackOilOffloadFluxKernel() = default;
+
+    BlackOilOffloadFluxKernel(const BlackOilOffloadFluxKernel&) = delete;
+    BlackOilOffloadFluxKernel& operator=(const BlackOilOffloadFluxKernel&) = delete;
+
+    ~BlackOilOffloadFluxKernel()
+    { release(); }
+
+    /*!
+     * \brief Returns true if the connections have been copied to the device.
+     */
+    bool hasStructure() const
+    { return isMapped_; }
+
+    /*!
+     * \brief Copy the connections of the cells to the device.
+     *
+     * This needs to be called again whenever the transmissibilities of the connections
+     * change.
+     *
+     * \param neighborInfo The connections of the cells, see TpfaNeighborTable
+     */
+    template <class NeighborTable>
+    void setStructure(const NeighborTable& neighborInfo)
+    {
+        release();
+
+        numCells_ = neighborInfo.size();
+        numConnections_ = neighborInfo.dataSize();
+
+        rowBegin_.resize(numCells_ + 1);
+        neighbor_.resize(numConnections_);
+        trans_.resize(numConnections_);
+        dZg_.resize(numConnections_);
+        thpres_.resize(numConnections_);
+        skipTransMult_.resize(numConnections_);
+        for (std::size_t cellIdx = 0; cellIdx <= numCells_; ++cellIdx)
+            rowBegin_[cellIdx] = neighborInfo.rowBegin(cellIdx);
+        for (std::size_t nbPos = 0; nbPos < numConnections_; ++nbPos) {
+            const auto& nbInfo = neighborInfo.resNBInfo(nbPos);
+            neighbor_[nbPos] = neighborInfo.neighbor(nbPos);
+            trans_[nbPos] = nbInfo.trans;
+            dZg_[nbPos] = nbInfo.dZg;
+            thpres_[nbPos] = nbInfo.thpres;
+            skipTransMult_[nbPos] = nbInfo.skipTransMult ? 1 : 0;
+        }
+
+        cellData_.resize(numQuantities*evalSize*numCells_);
+        referenceDensity_.resize(numPhases*numCells_);
+        residual_.resize(numEq*numCells_);
+        diagonal_.resize(blockSize*numCells_);
+        offDiagonal_.resize(blockSize*numConnections_);
+
+#ifdef _OPENMP
+        const std::size_t* rowBegin = rowBegin_.data();
+        const std::size_t* neighbor = neighbor_.data();
+        const Scalar* trans = trans_.data();
+        const Scalar* dZg = dZg_.data();
+        const Scalar* thpres = thpres_.data();
+        const unsigned char* skipTransMult = skipTransMult_.data();
+        const Scalar* cellData = cellData_.data();
+        const Scalar* referenceDensity = referenceDensity_.data();
+        const Scalar* residual = residual_.data();
+        const Scalar* diagonal = diagonal_.data();
+        const Scalar* offDiagonal = offDiagonal_.data();
+        const std::size_t numCells = numCells_;
+        const std::size_t numConnections = numConnections_;
+        const std::size_t numCellValues = cellData_.size();
+        const std::size_t numDensities = referenceDensity_.size();
+        const std::size_t numResidualValues = residual_.size();
+        const std::size_t numDiagonalValues = diagonal_.size();
+        const std::size_t numOffDiagonalValues = offDiagonal_.size();
+#pragma omp target enter data map(to: rowBegin[0:numCells+1], neighbor[0:numConnections], \
+    trans[0:numConnections], dZg[0:numConnections], thpres[0:numConnections], \
+    skipTransMult[0:numConnections]) \
+    map(alloc: cellData[0:numCellValues], referenceDensity[0:numDensities], \
+    residual[0:numResidualValues], diagonal[0:numDiagonalValues], \
+    offDiagonal[0:numOffDiagonalValues])
+#endif
+        isMapped_ = true;
+    }
+
+    /*!
+     * \brief Release the device memory.
+     */
+    void release()
+    {
+        if (!isMapped_)
+            return;
+
+#ifdef _OPENMP
+        const std::size_t* rowBegin = rowBegin_.data();
+        const std::size_t* neighbor = neighbor_.data();
+        const Scalar* trans = trans_.data();
+        const Scalar* dZg = dZg_.data();
+        const Scalar* thpres = thpres_.data();
+        const unsigned char* skipTransMult = skipTransMult_.data();
+        const Scalar* cellData = cellData_.data();
+        const Scalar* referenceDensity = referenceDensity_.data();
+        const Scalar* residual = residual_.data();
+        const Scalar* diagonal = diagonal_.data();
+        const Scalar* offDiagonal = offDiagonal_.data();
+        const std::size_t numCells = numCells_;
+        const std::size_t numConnections = numConnections_;
+        const std::size_t numCellValues = cellData_.size();
+        const std::size_t numDensities = referenceDensity_.size();
+        const std::size_t numResidualValues = residual_.size();
+        const std::size_t numDiagonalValues = diagonal_.size();
+        const std::size_t numOffDiagonalValues = offDiagonal_.size();
+#pragma omp target exit data map(delete: rowBegin[0:numCells+1], neighbor[0:numConnections], \
+    trans[0:numConnections], dZg[0:numConnections], thpres[0:numConnections], \
+    skipTransMult[0:numConnections], \
+    cellData[0:numCellValues], referenceDensity[0:numDensities], \
+    residual[0:numResidualValues], diagonal[0:numDiagonalValues], \
+    offDiagonal[0:numOffDiagonalValues])
+#endif
+        isMapped_ = false;
+    }
+
+    /*!
+     * \brief Gather the quantities of the cells which enter the fluxes and copy them
+     *        to the device.
+     *
+     * \param model The model which provides the cached intensive quantities
+     *
+     * \return false if any cell exhibits directional mobilities, in which case the
+     *         fluxes need to be computed by the host
+     */
+    template <class Model>
+    bool updateCellQuantities(const Model& model)
+    {
+        const std::size_t numCells = numCells_;
+        int directionalMobility = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(max: directionalMobility)
+#endif
+        for (std::size_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            const auto& intQuants = model.intensiveQuantities(cellIdx, /*timeIdx=*/0);
+            const auto& fs = intQuants.fluidState();
+            const unsigned pvtRegionIdx = intQuants.pvtRegionIndex();
+
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                referenceDensity_[phaseIdx*numCells + cellIdx] =
+                    blackoilConserveSurfaceVolume
+                    ? 1.0
+                    : FluidSystem::referenceDensity(phaseIdx, pvtRegionIdx);
+
+                if (!FluidSystem::phaseIsActive(phaseIdx)) {
+                    store_(mobilityQ + phaseIdx, cellIdx, Evaluation(0.0));
+                    continue;
+                }
+
+                // the directional mobilities are stored separately from the regular
+                // ones, i.e., they are used if the references differ
+                if (&intQuants.mobility(phaseIdx, FaceDir::DirEnum::XPlus) != &intQuants.mobility(phaseIdx))
+                    directionalMobility = 1;
+
+                store_(pressureQ + phaseIdx, cellIdx, fs.pressure(phaseIdx));
+                store_(densityQ + phaseIdx, cellIdx, fs.density(phaseIdx));
+                store_(mobilityQ + phaseIdx, cellIdx, intQuants.mobility(phaseIdx));
+                store_(invBQ + phaseIdx, cellIdx,
+                       getInvB_<FluidSystem, FluidState, Evaluation>(fs, phaseIdx, pvtRegionIdx));
+            }
+
+            if (FluidSystem::enableDissolvedGas())
+                store_(rsQ, cellIdx, BlackOil::getRs_<FluidSystem, FluidState, Evaluation>(fs, pvtRegionIdx));
+            if (FluidSystem::enableDissolvedGasInWater())
+                store_(rswQ, cellIdx, BlackOil::getRsw_<FluidSystem, FluidState, Evaluation>(fs, pvtRegionIdx));
+            if (FluidSystem::enableVaporizedOil())
+                store_(rvQ, cellIdx, BlackOil::getRv_<FluidSystem, FluidState, Evaluation>(fs, pvtRegionIdx));
+            if (FluidSystem::enableVaporizedWater())
+                store_(rvwQ, cellIdx, BlackOil::getRvw_<FluidSystem, FluidState, Evaluation>(fs, pvtRegionIdx));
+            store_(transMultQ, cellIdx, intQuants.rockCompTransMultiplier());
+        }
+
+        if (directionalMobility)
+            return false;
+
+#ifdef _OPENMP
+        const Scalar* cellData = cellData_.data();
+        const Scalar* referenceDensity = referenceDensity_.data();
+        const std::size_t numCellValues = cellData_.size();
+        const std::size_t numDensities = referenceDensity_.size();
+#pragma omp target update to(cellData[0:numCellValues], referenceDensity[0:numDensities])
+#endif
+        return true;
+    }
+
+    /*!
+     * \brief Compute the fluxes of all cells on the device and copy the results back.
+     *
+     * Afterwards, residual(), diagonal() and offDiagonal() contain the sum of the
+     * fluxes out of each cell, their derivatives with regard to the primary variables
+     * of the cell and, for each connection, the derivatives of the flux with regard to
+     * the primary variables of the cell from whose side it was computed.
+     */
+    void computeFluxes()
+    {
+        const std::size_t* rowBegin = rowBegin_.data();
+        const std::size_t* neighbor = neighbor_.data();
+        const Scalar* trans = trans_.data();
+        const Scalar* dZg = dZg_.data();
+        const Scalar* thpres = thpres_.data();
+        const unsigned char* skipTransMult = skipTransMult_.data();
+        const Scalar* cellData = cellData_.data();
+        const Scalar* referenceDensity = referenceDensity_.data();
+        Scalar* residual = residual_.data();
+        Scalar* diagonal = diagonal_.data();
+        Scalar* offDiagonal = offDiagonal_.data();
+        const std::size_t numCells = numCells_;
+
+        // the configuration of the fluid system is passed by value
+        bool phaseActive[numPhases];
+        int phaseEqIdx[numPhases];
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            phaseActive[phaseIdx] = FluidSystem::phaseIsActive(phaseIdx);
+            phaseEqIdx[phaseIdx] = phaseActive[phaseIdx]
+                ? conti0EqIdx + Indices::canonicalToActiveComponentIndex(FluidSystem::solventComponentIndex(phaseIdx))
+                : 0;
+        }
+        const bool enableRs = FluidSystem::enableDissolvedGas();
+        const bool enableRsw = FluidSystem::enableDissolvedGasInWater();
+        const bool enableRv = FluidSystem::enableVaporizedOil();
+        const bool enableRvw = FluidSystem::enableVaporizedWater();
+
+#ifdef _OPENMP
+        const std::size_t numConnections = numConnections_;
+        const std::size_t numCellValues = cellData_.size();
+        const std::size_t numDensities = referenceDensity_.size();
+        const std::size_t numResidualValues = residual_.size();
+        const std::size_t numDiagonalValues = diagonal_.size();
+        const std::size_t numOffDiagonalValues = offDiagonal_.size();
+#pragma omp target teams distribute parallel for \
+    map(to: rowBegin[0:numCells+1], neighbor[0:numConnections], trans[0:numConnections], \
+    dZg[0:numConnections], thpres[0:numConnections], skipTransMult[0:numConnections], \
+    cellData[0:numCellValues], referenceDensity[0:numDensities], \
+    phaseActive[0:numPhases], phaseEqIdx[0:numPhases]) \
+    map(from: residual[0:numResidualValues], diagonal[0:numDiagonalValues], \
+    offDiagonal[0:numOffDiagonalValues])
+#endif
+        for (std::size_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            Scalar cellResidual[numEq];
+            Scalar cellDiagonal[blockSize];
+            for (int i = 0; i < numEq; ++i)
+                cellResidual[i] = 0.0;
+            for (int i = 0; i < blockSize; ++i)
+                cellDiagonal[i] = 0.0;
+
+            for (std::size_t nbPos = rowBegin[cellIdx]; nbPos < rowBegin[cellIdx + 1]; ++nbPos) {
+                const std::size_t nbIdx = neighbor[nbPos];
+
+                // the value (k = 0) and the derivatives of quantity q of cell c
+                const auto cellValue = [&](int q, int k, std::size_t c)
+                { return cellData[(q*evalSize + k)*numCells + c]; };
+
+                Scalar flux[numEq][evalSize];
+                for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    for (int k = 0; k < evalSize; ++k)
+                        flux[eqIdx][k] = 0.0;
+
+                // arithmetic average of the transmissibility multipliers
+                Scalar transMult[evalSize];
+                transMult[0] = 1.0;
+                for (int k = 1; k < evalSize; ++k)
+                    transMult[k] = 0.0;
+                if (!skipTransMult[nbPos]) {
+                    transMult[0] = (cellValue(transMultQ, 0, cellIdx) + cellValue(transMultQ, 0, nbIdx))/2;
+                    for (int k = 1; k < evalSize; ++k)
+                        transMult[k] = cellValue(transMultQ, k, cellIdx)/2;
+                }
+
+                for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                    if (!phaseActive[phaseIdx])
+                        continue;
+
+                    // no flux if the phase is immobile on both sides
+                    if (cellValue(mobilityQ + phaseIdx, 0, cellIdx) <= 0.0
+                        && cellValue(mobilityQ + phaseIdx, 0, nbIdx) <= 0.0)
+                        continue;
+
+                    // pressure difference including the hydrostatic pressure
+                    Scalar dp[evalSize];
+                    dp[0] = cellValue(pressureQ + phaseIdx, 0, nbIdx)
+                        + dZg[nbPos]*(cellValue(densityQ + phaseIdx, 0, cellIdx)
+                                      + cellValue(densityQ + phaseIdx, 0, nbIdx))/2
+                        - cellValue(pressureQ + phaseIdx, 0, cellIdx);
+                    for (int k = 1; k < evalSize; ++k)
+                        dp[k] = dZg[nbPos]*cellValue(densityQ + phaseIdx, k, cellIdx)/2
+                            - cellValue(pressureQ + phaseIdx, k, cellIdx);
+
+                    // the upstream direction does not change when the threshold
+                    // pressure is subtracted, and there is no flux if the difference
+                    // vanishes
+                    const bool interiorUp = dp[0] < 0.0;
+
+                    if (thpres[nbPos] > 0.0) {
+                        if (std::abs(dp[0]) > thpres[nbPos])
+                            dp[0] += (dp[0] < 0.0) ? thpres[nbPos] : -thpres[nbPos];
+                        else
+                            for (int k = 0; k < evalSize; ++k)
+                                dp[k] = 0.0;
+                    }
+                    if (dp[0] == 0.0)
+                        continue;
+
+                    // only the quantities of the cell itself carry derivatives
+                    const std::size_t upIdx = interiorUp ? cellIdx : nbIdx;
+                    const Scalar upMask = interiorUp ? 1.0 : 0.0;
+
+                    // darcyFlux = -trans*dp*mobility*transMult
+                    const Scalar mob0 = cellValue(mobilityQ + phaseIdx, 0, upIdx);
+                    Scalar tmp[evalSize];
+                    tmp[0] = dp[0]*mob0;
+                    for (int k = 1; k < evalSize; ++k)
+                        tmp[k] = dp[k]*mob0 + dp[0]*upMask*cellValue(mobilityQ + phaseIdx, k, upIdx);
+                    Scalar darcyFlux[evalSize];
+                    darcyFlux[0] = -trans[nbPos]*tmp[0]*transMult[0];
+                    for (int k = 1; k < evalSize; ++k)
+                        darcyFlux[k] = -trans[nbPos]*(tmp[k]*transMult[0] + tmp[0]*transMult[k]);
+
+                    // surface volume flux of the phase
+                    const Scalar invB0 = cellValue(invBQ + phaseIdx, 0, upIdx);
+                    Scalar surfaceFlux[evalSize];
+                    surfaceFlux[0] = invB0*darcyFlux[0];
+                    for (int k = 1; k < evalSize; ++k)
+                        surfaceFlux[k] = invB0*darcyFlux[k]
+                            + upMask*cellValue(invBQ + phaseIdx, k, upIdx)*darcyFlux[0];
+
+                    const Scalar* upDensity = referenceDensity + upIdx;
+                    const int eqIdx = phaseEqIdx[phaseIdx];
+                    for (int k = 0; k < evalSize; ++k)
+                        flux[eqIdx][k] += surfaceFlux[k]*upDensity[phaseIdx*numCells];
+
+                    // the components which are dissolved in the phase
+                    const auto addDissolved = [&](int q, int dissolvedPhaseIdx)
+                    {
+                        const Scalar r0 = cellValue(q, 0, upIdx);
+                        const Scalar density = upDensity[dissolvedPhaseIdx*numCells];
+                        Scalar* dst = flux[phaseEqIdx[dissolvedPhaseIdx]];
+                        dst[0] += r0*surfaceFlux[0]*density;
+                        for (int k = 1; k < evalSize; ++k)
+                            dst[k] += (r0*surfaceFlux[k]
+                                       + upMask*cellValue(q, k, upIdx)*surfaceFlux[0])*density;
+                    };
+
+                    if (phaseIdx == oilPhaseIdx && enableRs)
+                        addDissolved(rsQ, gasPhaseIdx);
+                    else if (phaseIdx == waterPhaseIdx && enableRsw)
+                        addDissolved(rswQ, gasPhaseIdx);
+                    else if (phaseIdx == gasPhaseIdx) {
+                        if (enableRv)
+                            addDissolved(rvQ, oilPhaseIdx);
+                        if (enableRvw)
+                            addDissolved(rvwQ, waterPhaseIdx);
+                    }
+                }
+
+                Scalar* nbBlock = offDiagonal + nbPos*blockSize;
+                for (int eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                    cellResidual[eqIdx] += flux[eqIdx][0];
+                    for (int pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+                        cellDiagonal[eqIdx*numEq + pvIdx] += flux[eqIdx][pvIdx + 1];
+                        nbBlock[eqIdx*numEq + pvIdx] = flux[eqIdx][pvIdx + 1];
+                    }
+                }
+            }
+
+            for (int i = 0; i < numEq; ++i)
+                residual[cellIdx*numEq + i] = cellResidual[i];
+            for (int i = 0; i < blockSize; ++i)
+                diagonal[cellIdx*blockSize + i] = cellDiagonal[i];
+        }
+    }
+
+    /*!
+     * \brief The sum of the fluxes out of a cell for each equation.
+     */
+    const Scalar* residual(std::size_t cellIdx) const
+    { return residual_.data() + cellIdx*numEq; }
+
+    /*!
+     * \brief The derivatives of the fluxes out of a cell with regard to its primary
+     *        variables as a row-major block.
+     */
+    const Scalar* diagonal(std::size_t cellIdx) const
+    { return diagonal_.data() + cellIdx*blockSize; }
+
+    /*!
+     * \brief The derivatives of the flux over a connection with regard to the primary
+     *        variables of the cell from whose side it was computed.
+     *
+     * These need to be subtracted from the block of the neighbor's row and the cell's
+     * column.
+     */
+    const Scalar* offDiagonal(std::size_t nbPos) const
+    { return offDiagonal_.data() + nbPos*blockSize; }
+
+    /*!
+     * \brief Returns the number of bytes allocated by the host copies of the arrays.
+     *
+     * The device holds the same amount of memory.
+     */
+    std::size_t memoryUsage() const
+    {
+        return MemoryUsage::bytesOf(rowBegin_) + MemoryUsage::bytesOf(neighbor_)
+            + MemoryUsage::bytesOf(trans_) + MemoryUsage::bytesOf(dZg_)
+            + MemoryUsage::bytesOf(thpres_) + MemoryUsage::bytesOf(skipTransMult_)
+            + MemoryUsage::bytesOf(cellData_) + MemoryUsage::bytesOf(referenceDensity_)
+            + MemoryUsage::bytesOf(residual_) + MemoryUsage::bytesOf(diagonal_)
+            + MemoryUsage::bytesOf(offDiagonal_);
+    }
+
+private:
+    void store_(int q, std::size_t cellIdx, const Evaluation& eval)
+    {
+        cellData_[(q*evalSize)*numCells_ + cellIdx] = eval.value();
+        for (int k = 1; k < evalSize; ++k)
+            cellData_[(q*evalSize + k)*numCells_ + cellIdx] = eval.derivative(k - 1);
+    }
+
+    std::size_t numCells_ = 0;
+    std::size_t numConnections_ = 0;
+    bool isMapped_ = false;
+
+    std::vector<std::size_t> rowBegin_;
+    std::vector<std::size_t> neighbor_;
+    std::vector<Scalar> trans_;
+    std::vector<Scalar> dZg_;
+    std::vector<Scalar> thpres_;
+    std::vector<unsigned char> skipTransMult_;
+
+    std::vector<Scalar> cellData_;
+    std::vector<Scalar> referenceDensity_;
+    std::vector<Scalar> residual_;
+    std::vector<Scalar> diagonal_;
+    std::vector<Scalar> offDiagonal_;
+};
+
+} // namespace Opm
+
+#endif
@@ -45,6 +45,21 @@ struct BlackOilOnePhaseIndices
     static const bool waterEnabled = (canonicalCompIdx == 1);
     static const bool gasEnabled = (canonicalCompIdx == 2);
 
+    /*!
+     * \brief Returns whether a fluid phase is active.
+     *
+     * In contrast to FluidSystem::phaseIsActive(), this is a compile-time constant for
+     * the one- and two-phase indices, so the code for the disabled phases is optimized
+     * away by the compiler.
+     */
+    template <class FluidSystem>
+    static constexpr bool phaseIsActive(unsigned phaseIdx)
+    {
+        return (oilEnabled && phaseIdx == FluidSystem::oilPhaseIdx)
+            || (waterEnabled && phaseIdx == FluidSystem::waterPhaseIdx)
+            || (gasEnabled && phaseIdx == FluidSystem::gasPhaseIdx);
+    }
+
     //! Are solvents involved?
     static const bool enableSolvent = numSolventsV > 0;
 
@@ -170,12 +185,12 @@ struct BlackOilOnePhaseIndices
     //////////////////////
 
     //! \brief returns the index of "active" component
-    static unsigned canonicalToActiveComponentIndex(unsigned /*compIdx*/)
+    static constexpr unsigned canonicalToActiveComponentIndex(unsigned /*compIdx*/)
     {
         return 0;
     }
 
-    static unsigned activeToCanonicalComponentIndex([[maybe_unused]] unsigned compIdx)
+    static constexpr unsigned activeToCanonicalComponentIndex([[maybe_unused]] unsigned compIdx)
     {
         // assumes canonical oil = 0, water = 1, gas = 2;
         assert(compIdx == 0);
@@ -341,6 +341,10 @@ public:
                 params_.skprpolyTables_[tableNumber] = std::move(tablefunc);
             }
         }
+
+        const Scalar resamplingTolerance = Parameters::get<TypeTag, Properties::TableResamplingTolerance>();
+        if (resamplingTolerance > 0.0)
+            params_.resampleTables(resamplingTolerance);
     }
 #endif
 
@@ -572,8 +576,8 @@ public:
         return static_cast<Scalar>(0.0);
     }
 
-    template <class DofEntity>
-    static void serializeEntity(const Model& model, std::ostream& outstream, const DofEntity& dof)
+    template <class OutStream, class DofEntity>
+    static void serializeEntity(const Model& model, OutStream& outstream, const DofEntity& dof)
     {
         if constexpr (enablePolymer) {
             unsigned dofIdx = model.dofMapper().index(dof);
@@ -583,8 +587,8 @@ public:
         }
     }
 
-    template <class DofEntity>
-    static void deserializeEntity(Model& model, std::istream& instream, const DofEntity& dof)
+    template <class InStream, class DofEntity>
+    static void deserializeEntity(Model& model, InStream& instream, const DofEntity& dof)
     {
         if constexpr (enablePolymer) {
             unsigned dofIdx = model.dofMapper().index(dof);
@@ -701,6 +705,16 @@ public:
         return params_.shrate_[pvtnumRegionIdx];
     }
 
+    /*!
+     * \brief Returns true if a viscosity multiplier of the PLYVISC table has an effect
+     *        on the water phase.
+     *
+     * If this is not the case, neither the shear thinning of the water nor the one of
+     * the polymer need to be considered.
+     */
+    static bool altersWaterViscosity(Scalar viscosityMultiplier)
+    { return std::abs(viscosityMultiplier - 1.0) >= 1e-14; }
+
     /*!
      * \brief Computes the shear factor
      *
@@ -717,9 +731,8 @@ public:
         const auto& viscosityMultiplierTable = params_.plyviscViscosityMultiplierTable_[pvtnumRegionIdx];
         Scalar viscosityMultiplier = viscosityMultiplierTable.eval(scalarValue(polymerConcentration), /*extrapolate=*/true);
 
-        const Scalar eps = 1e-14;
         // return 1.0 if the polymer has no effect on the water.
-        if (std::abs((viscosityMultiplier - 1.0)) < eps)
+        if (!altersWaterViscosity(viscosityMultiplier))
             return ToolboxLocal::createConstant(v0, 1.0);
 
         const std::vector<Scalar>& shearEffectRefLogVelocity = params_.plyshlogShearEffectRefLogVelocity_[pvtnumRegionIdx];
@@ -857,23 +870,26 @@ public:
 
         // compute effective viscosities
         if constexpr (!enablePolymerMolarWeight) {
-          const Scalar cmax = PolymerModule::plymaxMaxConcentration(elemCtx, dofIdx, timeIdx);
-            const auto& fs = asImp_().fluidState_;
-            const Evaluation& muWater = fs.viscosity(waterPhaseIdx);
-            const auto& viscosityMultiplier = PolymerModule::plyviscViscosityMultiplierTable(elemCtx, dofIdx, timeIdx);
-            const Evaluation viscosityMixture = viscosityMultiplier.eval(polymerConcentration_, /*extrapolate=*/true) * muWater;
-
-            // Do the Todd-Longstaff mixing
+            const Scalar cmax = PolymerModule::plymaxMaxConcentration(elemCtx, dofIdx, timeIdx);
+            const auto& viscosityMultiplierTable = PolymerModule::plyviscViscosityMultiplierTable(elemCtx, dofIdx, timeIdx);
+            const Evaluation viscosityMultiplier = viscosityMultiplierTable.eval(polymerConcentration_, /*extrapolate=*/true);
+            altersWaterViscosity_ = PolymerModule::altersWaterViscosity(scalarValue(viscosityMultiplier));
+
+            // Do the Todd-Longstaff mixing. With the viscosity multiplier M(c) and the
+            // mixing parameter w, the effective viscosities of the water and of the
+            // polymer solution are M(c)^w * muWater and M(c)^w * M(cmax)^(1 - w) *
+            // muWater, so the water viscosity cancels out of both corrections and a
+            // single power of the viscosity multiplier is sufficient.
             const Scalar plymixparToddLongstaff = PolymerModule::plymixparToddLongstaff(elemCtx, dofIdx, timeIdx);
-            const Evaluation viscosityPolymer = viscosityMultiplier.eval(cmax, /*extrapolate=*/true) * muWater;
-            const Evaluation viscosityPolymerEffective = pow(viscosityMixture, plymixparToddLongstaff) * pow(viscosityPolymer, 1.0 - plymixparToddLongstaff);
-            const Evaluation viscosityWaterEffective = pow(viscosityMixture, plymixparToddLongstaff) * pow(muWater, 1.0 - plymixparToddLongstaff);
+            const Scalar polymerFactor =
+                std::pow(viscosityMultiplierTable.eval(cmax, /*extrapolate=*/true), 1.0 - plymixparToddLongstaff);
+            const Evaluation mixtureFactor = pow(viscosityMultiplier, plymixparToddLongstaff);
 
             const Evaluation cbar = polymerConcentration_ / cmax;
             // waterViscosity / effectiveWaterViscosity
-            waterViscosityCorrection_ = muWater * ((1.0 - cbar) / viscosityWaterEffective + cbar / viscosityPolymerEffective);
+            waterViscosityCorrection_ = ((1.0 - cbar) + cbar / polymerFactor) / mixtureFactor;
             // effectiveWaterViscosity / effectivePolymerViscosity
-            polymerViscosityCorrection_ =  (muWater / waterViscosityCorrection_) / viscosityPolymerEffective;
+            polymerViscosityCorrection_ = 1.0 / (polymerFactor * (1.0 - cbar) + cbar);
         }
         else { // based on PLYVMH
             const auto& plyvmhCoefficients = PolymerModule::plyvmhCoefficients(elemCtx, dofIdx, timeIdx);
@@ -888,6 +904,7 @@ public:
             const Evaluation x = polymerConcentration_ * intrinsicViscosity;
             waterViscosityCorrection_ = 1.0 / (1.0 + gamma * (x + kappa * x * x));
             polymerViscosityCorrection_ = 1.0;
+            altersWaterViscosity_ = true;
         }
 
         // adjust water mobility
@@ -926,6 +943,16 @@ public:
     const Evaluation& waterViscosityCorrection() const
     { return waterViscosityCorrection_; }
 
+    /*!
+     * \brief Returns true if the polymer within the cell has an effect on the
+     *        viscosity of the water.
+     *
+     * This is not the case if the cell does not contain any polymer and allows to skip
+     * the computation of the shear factors of the faces for which the cell is upstream.
+     */
+    bool altersWaterViscosity() const
+    { return altersWaterViscosity_; }
+
 
 protected:
     Implementation& asImp_()
@@ -939,6 +966,7 @@ protected:
     Evaluation polymerAdsorption_;
     Evaluation polymerViscosityCorrection_;
     Evaluation waterViscosityCorrection_;
+    bool altersWaterViscosity_ = true;
 
 
 };
@@ -1049,6 +1077,11 @@ public:
         unsigned interiorDofIdx = extQuants.interiorIndex();
         unsigned exteriorDofIdx = extQuants.exteriorIndex();
         const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
+
+        // computeShearFactor() yields 1 for both phases in this case
+        if (!up.altersWaterViscosity())
+            return;
+
         const auto& intQuantsIn = elemCtx.intensiveQuantities(interiorDofIdx, timeIdx);
         const auto& intQuantsEx = elemCtx.intensiveQuantities(exteriorDofIdx, timeIdx);
 
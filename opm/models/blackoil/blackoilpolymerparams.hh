@@ -28,9 +28,10 @@
 #ifndef EWOMS_BLACK_OIL_POLYMER_PARAMS_HH
 #define EWOMS_BLACK_OIL_POLYMER_PARAMS_HH
 
-#include <opm/material/common/Tabulated1DFunction.hpp>
 #include <opm/material/common/IntervalTabulated2DFunction.hpp>
 
+#include <opm/models/utils/resampledtabulated1dfunction.hh>
+
 #include <map>
 #include <vector>
 
@@ -39,7 +40,7 @@ namespace Opm {
 //! \brief Struct holding the parameters for the BlackOilPolymerModule class.
 template<class Scalar>
 struct BlackOilPolymerParams {
-    using TabulatedFunction = Tabulated1DFunction<Scalar>;
+    using TabulatedFunction = ResampledTabulated1DFunction<Scalar>;
     using TabulatedTwoDFunction = IntervalTabulated2DFunction<Scalar>;
 
     enum AdsorptionBehaviour { Desorption = 1, NoDesorption = 2 };
@@ -96,6 +97,19 @@ struct BlackOilPolymerParams {
     // a struct containing the constants to calculate polymer viscosity
     // based on Mark-Houwink equation and Huggins equation, the constants are provided
     // by the keyword PLYVMH
+    /*!
+     * \brief Resample the PLYADS and PLYVISC tables on uniform grids.
+     *
+     * Tables which cannot be resampled to the given relative tolerance are kept.
+     */
+    void resampleTables(Scalar tolerance)
+    {
+        for (auto& table : plyadsAdsorbedPolymer_)
+            table.resample(tolerance);
+        for (auto& table : plyviscViscosityMultiplierTable_)
+            table.resample(tolerance);
+    }
+
     struct PlyvmhCoefficients {
         Scalar k_mh;
         Scalar a_mh;
@@ -43,6 +43,8 @@
 #include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
 #include <opm/material/common/Valgrind.hpp>
 
+#include <cstdint>
+
 namespace Opm::Properties {
     template<class TypeTag, class MyTypeTag>
     struct PressureScale {
@@ -135,32 +137,32 @@ class BlackOilPrimaryVariables : public FvBasePrimaryVariables<TypeTag>
     static_assert(numComponents == 3, "The black-oil model assumes three components!");
 
 public:
-    enum class WaterMeaning {
+    enum class WaterMeaning : std::uint8_t {
         Sw,  // water saturation
         Rvw, // vaporized water
         Rsw, // dissolved gas in water
         Disabled, // The primary variable is not used
     };
 
-    enum class PressureMeaning {
+    enum class PressureMeaning : std::uint8_t {
         Po, // oil pressure
         Pg, // gas pressure
         Pw, // water pressure
     };
-    enum class GasMeaning {
+    enum class GasMeaning : std::uint8_t {
         Sg, // gas saturation
         Rs, // dissolved gas in oil
         Rv, // vapporized oil
         Disabled, // The primary variable is not used
     };
 
-    enum class BrineMeaning {
+    enum class BrineMeaning : std::uint8_t {
         Cs, // salt concentration
         Sp, // (precipitated) salt saturation
         Disabled, // The primary variable is not used
     };
 
-    enum class SolventMeaning {
+    enum class SolventMeaning : std::uint8_t {
         Ss, // solvent saturation
         Rsolw, // dissolved solvent in water
         Disabled, // The primary variable is not used
@@ -664,15 +666,13 @@ public:
             return changed;
         }
 
+        Scalar pcFactor = 1.0;
         if (BrineModule::hasPcfactTables() && primaryVarsMeaningBrine() == BrineMeaning::Sp) {
             unsigned satnumRegionIdx = problem.satnumRegionIndex(globalDofIdx);
             Scalar Sp = saltConcentration_();
             Scalar porosityFactor  = min(1.0 - Sp, 1.0); //phi/phi_0
             const auto& pcfactTable = BrineModule::pcfactTable(satnumRegionIdx);
-            pcFactor_ = pcfactTable.eval(porosityFactor, /*extrapolation=*/true);
-        }
-        else {
-            pcFactor_ = 1.0;
+            pcFactor = pcfactTable.eval(porosityFactor, /*extrapolation=*/true);
         }
 
         switch(primaryVarsMeaningWater()) {
@@ -686,7 +686,7 @@ public:
                         const MaterialLawParams& matParams = problem.materialLawParams(globalDofIdx);
                         Scalar so = 1.0 - sg - solventSaturation_();
                         computeCapillaryPressures_(pC, so, sg + solventSaturation_(), /*sw=*/ 0.0, matParams);
-                        p += pcFactor_ * (pC[gasPhaseIdx] - pC[oilPhaseIdx]);
+                        p += pcFactor * (pC[gasPhaseIdx] - pC[oilPhaseIdx]);
                     }
                     Scalar rvwSat = FluidSystem::gasPvt().saturatedWaterVaporizationFactor(pvtRegionIdx_,
                                                                                    T,
@@ -706,7 +706,7 @@ public:
                     const MaterialLawParams& matParams = problem.materialLawParams(globalDofIdx);
                     Scalar so = 1.0 - sw - solventSaturation_();
                     computeCapillaryPressures_(pC, so,  /*sg=*/ 0.0, sw, matParams);
-                    Scalar pw = pg + pcFactor_ * (pC[waterPhaseIdx] - pC[gasPhaseIdx]);
+                    Scalar pw = pg + pcFactor * (pC[waterPhaseIdx] - pC[gasPhaseIdx]);
                     Scalar rswSat = FluidSystem::waterPvt().saturatedGasDissolutionFactor(pvtRegionIdx_,
                                                                                    T,
                                                                                    pw,
@@ -729,7 +729,7 @@ public:
                     const MaterialLawParams& matParams = problem.materialLawParams(globalDofIdx);
                     Scalar so = 1.0 - sg - solventSaturation_();
                     computeCapillaryPressures_(pC, so, sg + solventSaturation_(), /*sw=*/ 0.0, matParams);
-                    p += pcFactor_ * (pC[gasPhaseIdx] - pC[oilPhaseIdx]);
+                    p += pcFactor * (pC[gasPhaseIdx] - pC[oilPhaseIdx]);
                 }
                 Scalar rvwSat = FluidSystem::gasPvt().saturatedWaterVaporizationFactor(pvtRegionIdx_,
                                                                                    T,
@@ -764,7 +764,7 @@ public:
                     std::array<Scalar, numPhases> pC = { 0.0 };
                     const MaterialLawParams& matParams = problem.materialLawParams(globalDofIdx);
                     computeCapillaryPressures_(pC, /*so=*/ 0.0,  /*sg=*/ 0.0, /*sw=*/ 1.0, matParams);
-                    Scalar pg = pw + pcFactor_ * (pC[gasPhaseIdx] - pC[waterPhaseIdx]);
+                    Scalar pg = pw + pcFactor * (pC[gasPhaseIdx] - pC[waterPhaseIdx]);
                     this->setScaledPressure_(pg);
                     changed = true;
                 }
@@ -816,7 +816,7 @@ public:
                     std::array<Scalar, numPhases> pC = { 0.0 };
                     const MaterialLawParams& matParams = problem.materialLawParams(globalDofIdx);
                     computeCapillaryPressures_(pC, /*so=*/0.0, sg + solventSaturation_(), sw, matParams);
-                    Scalar pg = po + pcFactor_ * (pC[gasPhaseIdx] - pC[oilPhaseIdx]);
+                    Scalar pg = po + pcFactor * (pC[gasPhaseIdx] - pC[oilPhaseIdx]);
 
                     // we start at the GasMeaning::Rv value that corresponds to that of oil-saturated
                     // hydrocarbon gas
@@ -896,7 +896,7 @@ public:
                                             /*sg=*/sg2 + solventSaturation_(),
                                             sw,
                                             matParams);
-                    Scalar po = pg + pcFactor_ * (pC[oilPhaseIdx] - pC[gasPhaseIdx]);
+                    Scalar po = pg + pcFactor * (pC[oilPhaseIdx] - pC[gasPhaseIdx]);
 
                     setPrimaryVarsMeaningGas(GasMeaning::Sg);
                     setPrimaryVarsMeaningPressure(PressureMeaning::Po);
@@ -1146,13 +1146,14 @@ private:
         (*this)[Indices::pressureSwitchIdx] = pressure / (this->pressureScale_);
     }
 
+    // one byte per meaning plus the short PVT region index keeps the non-value state of
+    // the primary variables within eight bytes
     WaterMeaning primaryVarsMeaningWater_{WaterMeaning::Disabled};
     PressureMeaning primaryVarsMeaningPressure_{PressureMeaning::Po};
     GasMeaning primaryVarsMeaningGas_{GasMeaning::Disabled};
     BrineMeaning primaryVarsMeaningBrine_{BrineMeaning::Disabled};
     SolventMeaning primaryVarsMeaningSolvent_{SolventMeaning::Disabled};
     unsigned short pvtRegionIdx_;
-    Scalar pcFactor_;
     static inline Scalar pressureScale_ = 1.0;
 };
 
@@ -179,6 +179,16 @@ public:
                                     unsigned) const
     { return 1.0; }
 
+    /*!
+     * \brief Returns false if rockCompTransMultiplier() is one for all elements.
+     *
+     * In this case, the TPFA flux kernels do not multiply the fluxes by the average of
+     * the multipliers of the two cells. This method is conservative by default, i.e.,
+     * problems which do not use water-induced rock compaction may return false.
+     */
+    bool hasRockCompTransMultiplier() const
+    { return true; }
+
 private:
     //! Returns the implementation of the problem (i.e. static polymorphism)
     Implementation& asImp_()
@@ -70,6 +70,12 @@ struct EnableDisgasInWater { using type = UndefinedProperty; };
 //! Enable the ECL-blackoil extension for MICP.
 template<class TypeTag, class MyTypeTag>
 struct EnableMICP { using type = UndefinedProperty; };
+//! Integrate the MICP reactions separately from the transport (operator splitting)
+template<class TypeTag, class MyTypeTag>
+struct MICPReactionSplitting { using type = UndefinedProperty; };
+//! The relative tolerance of the sub-stepping of the MICP reactions
+template<class TypeTag, class MyTypeTag>
+struct MICPReactionTolerance { using type = UndefinedProperty; };
 
 
 //! Allow the spatial and temporal domains to exhibit non-constant temperature
@@ -90,6 +96,28 @@ struct EnableMech { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct BlackOilEnergyScalingFactor { using type = UndefinedProperty; };
 
+//! The relative tolerance for resampling the tables of the polymer, solvent and
+//! extended black-oil extensions on uniform grids. Zero disables the resampling.
+template<class TypeTag, class MyTypeTag>
+struct TableResamplingTolerance { using type = UndefinedProperty; };
+
+//! Store only the quantities needed by the storage and flux terms in the fluid states
+//! of the intensive quantities, see Opm::BlackOilCompactFluidState
+template<class TypeTag, class MyTypeTag>
+struct EnableCompactFluidState { using type = UndefinedProperty; };
+
+//! The maximum change of the temperature of a degree of freedom for which the energy
+//! related quantities of its last complete evaluation are extrapolated linearly. Zero
+//! disables the extrapolation.
+template<class TypeTag, class MyTypeTag>
+struct EnergyQuantityReuseTolerance { using type = UndefinedProperty; };
+
+//! The maximum change of the pressure of a degree of freedom for which the rock
+//! compaction multipliers of its last complete evaluation are extrapolated linearly.
+//! Zero disables the extrapolation.
+template<class TypeTag, class MyTypeTag>
+struct RockCompactionReuseTolerance { using type = UndefinedProperty; };
+
 
 } // namespace Opm::Properties
 
@@ -348,6 +348,10 @@ public:
                     params_.tlPMixTable_[regionIdx] = ones;
             }
         }
+
+        const Scalar resamplingTolerance = Parameters::get<TypeTag, Properties::TableResamplingTolerance>();
+        if (resamplingTolerance > 0.0)
+            params_.resampleTables(resamplingTolerance);
     }
 #endif
 
@@ -577,8 +581,8 @@ public:
         return std::abs(Toolbox::scalarValue(resid[contiSolventEqIdx]));
     }
 
-    template <class DofEntity>
-    static void serializeEntity(const Model& model, std::ostream& outstream, const DofEntity& dof)
+    template <class OutStream, class DofEntity>
+    static void serializeEntity(const Model& model, OutStream& outstream, const DofEntity& dof)
     {
         if constexpr (enableSolvent) {
             unsigned dofIdx = model.dofMapper().index(dof);
@@ -588,8 +592,8 @@ public:
         }
     }
 
-    template <class DofEntity>
-    static void deserializeEntity(Model& model, std::istream& instream, const DofEntity& dof)
+    template <class InStream, class DofEntity>
+    static void deserializeEntity(Model& model, InStream& instream, const DofEntity& dof)
     {
         if constexpr (enableSolvent) {
             unsigned dofIdx = model.dofMapper().index(dof);
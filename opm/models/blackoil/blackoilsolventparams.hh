@@ -34,14 +34,16 @@
 #include <opm/material/fluidsystems/blackoilpvt/BrineCo2Pvt.hpp>
 #include <opm/material/fluidsystems/blackoilpvt/BrineH2Pvt.hpp>
 
-#include <opm/material/common/Tabulated1DFunction.hpp>
+#include <opm/models/utils/resampledtabulated1dfunction.hh>
+
+#include <vector>
 
 namespace Opm {
 
 //! \brief Struct holding the parameters for the BlackOilSolventModule class.
 template<class Scalar>
 struct BlackOilSolventParams {
-    using TabulatedFunction = Tabulated1DFunction<Scalar>;
+    using TabulatedFunction = ResampledTabulated1DFunction<Scalar>;
 
     using SolventPvt = ::Opm::SolventPvt<Scalar>;
     SolventPvt solventPvt_;
@@ -100,6 +102,21 @@ struct BlackOilSolventParams {
         msfnKrsg_[satRegionIdx] = msfnKrsg;
         msfnKro_[satRegionIdx] = msfnKro;
     }
+
+    /*!
+     * \brief Resample the saturation function and miscibility tables on uniform grids.
+     *
+     * Tables which cannot be resampled to the given relative tolerance are kept.
+     */
+    void resampleTables(Scalar tolerance)
+    {
+        for (auto* tables : { &ssfnKrg_, &ssfnKrs_, &sof2Krn_, &misc_, &pmisc_,
+                              &msfnKrsg_, &msfnKro_, &sorwmis_, &sgcwmis_, &tlPMixTable_ })
+        {
+            for (auto& table : *tables)
+                table.resample(tolerance);
+        }
+    }
 };
 
 } // namespace Opm
@@ -45,6 +45,21 @@ struct BlackOilTwoPhaseIndices
     static const bool waterEnabled = (disabledCanonicalCompIdx != 1);
     static const bool gasEnabled = (disabledCanonicalCompIdx != 2);
 
+    /*!
+     * \brief Returns whether a fluid phase is active.
+     *
+     * In contrast to FluidSystem::phaseIsActive(), this is a compile-time constant for
+     * the one- and two-phase indices, so the code for the disabled phases is optimized
+     * away by the compiler.
+     */
+    template <class FluidSystem>
+    static constexpr bool phaseIsActive(unsigned phaseIdx)
+    {
+        return (oilEnabled && phaseIdx == FluidSystem::oilPhaseIdx)
+            || (waterEnabled && phaseIdx == FluidSystem::waterPhaseIdx)
+            || (gasEnabled && phaseIdx == FluidSystem::gasPhaseIdx);
+    }
+
     //! Are solvents involved?
     static const bool enableSolvent = numSolventsV > 0;
 
@@ -170,7 +185,7 @@ struct BlackOilTwoPhaseIndices
     //////////////////////
 
     //! \brief returns the index of "active" component
-    static unsigned canonicalToActiveComponentIndex(unsigned compIdx)
+    static constexpr unsigned canonicalToActiveComponentIndex(unsigned compIdx)
     {
         // assumes canonical oil = 0, water = 1, gas = 2;
         if(!gasEnabled) {
@@ -189,7 +204,7 @@ struct BlackOilTwoPhaseIndices
         return compIdx-1;
     }
 
-    static unsigned activeToCanonicalComponentIndex(unsigned compIdx)
+    static constexpr unsigned activeToCanonicalComponentIndex(unsigned compIdx)
     {
         // assumes canonical oil = 0, water = 1, gas = 2;
         assert(compIdx < 2);
@@ -41,6 +41,7 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <array>
 #include <cmath>
 
 namespace Opm {
@@ -187,7 +188,7 @@ protected:
                              unsigned timeIdx)
     {
         const auto& gradCalc = elemCtx.gradientCalculator();
-        PressureCallback<TypeTag> pressureCallback(elemCtx);
+        PhasePressuresCallback<TypeTag> pressuresCallback(elemCtx);
 
         const auto& scvf = elemCtx.stencil(timeIdx).interiorFace(faceIdx);
         const auto& faceNormal = scvf.normal();
@@ -198,23 +199,22 @@ protected:
         exteriorDofIdx_ = static_cast<short>(j);
         unsigned focusDofIdx = elemCtx.focusDofIndex();
 
-        // calculate the "raw" pressure gradient
+        // calculate the "raw" pressure gradients of all phases in a single pass over
+        // the degrees of freedom of the stencil
+        std::array<EvalDimVector, numPhases> pressureGrads;
+        gradCalc.calculateGradients(pressureGrads, elemCtx, faceIdx, pressuresCallback);
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
             if (!elemCtx.model().phaseIsConsidered(phaseIdx)) {
                 Valgrind::SetUndefined(potentialGrad_[phaseIdx]);
                 continue;
             }
 
-            pressureCallback.setPhaseIndex(phaseIdx);
-            gradCalc.calculateGradient(potentialGrad_[phaseIdx],
-                                       elemCtx,
-                                       faceIdx,
-                                       pressureCallback);
+            potentialGrad_[phaseIdx] = pressureGrads[phaseIdx];
             Valgrind::CheckDefined(potentialGrad_[phaseIdx]);
         }
 
         // correct the pressure gradients by the gravitational acceleration
-        if (Parameters::get<TypeTag, Properties::EnableGravity>()) {
+        if (Parameters::getCached<TypeTag, Properties::EnableGravity>()) {
             // estimate the gravitational acceleration at a given SCV face
             // using the arithmetic mean
             const auto& gIn = elemCtx.problem().gravity(elemCtx, i, timeIdx);
@@ -290,7 +290,7 @@ protected:
         }
 
         Valgrind::SetUndefined(K_);
-        elemCtx.problem().intersectionIntrinsicPermeability(K_, elemCtx, faceIdx, timeIdx);
+        elemCtx.problem().faceIntrinsicPermeability(K_, elemCtx, faceIdx, timeIdx);
         Valgrind::CheckDefined(K_);
 
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
@@ -364,7 +364,7 @@ protected:
         K_ = intQuantsIn.intrinsicPermeability();
 
         // correct the pressure gradients by the gravitational acceleration
-        if (Parameters::get<TypeTag, Properties::EnableGravity>()) {
+        if (Parameters::getCached<TypeTag, Properties::EnableGravity>()) {
             // estimate the gravitational acceleration at a given SCV face
             // using the arithmetic mean
             const auto& gIn = elemCtx.problem().gravity(elemCtx, i, timeIdx);
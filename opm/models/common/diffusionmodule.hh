@@ -35,6 +35,8 @@
 
 #include <dune/common/fvector.hh>
 
+#include <array>
+
 namespace Opm {
 
 /*!
@@ -367,7 +369,7 @@ protected:
     void update_(const ElementContext& elemCtx, unsigned faceIdx, unsigned timeIdx)
     {
         const auto& gradCalc = elemCtx.gradientCalculator();
-        Opm::MoleFractionCallback<TypeTag> moleFractionCallback(elemCtx);
+        Opm::MoleFractionsCallback<TypeTag> moleFractionsCallback(elemCtx);
 
         const auto& face = elemCtx.stencil(timeIdx).interiorFace(faceIdx);
         const auto& normal = face.normal();
@@ -376,19 +378,18 @@ protected:
         const auto& intQuantsInside = elemCtx.intensiveQuantities(extQuants.interiorIndex(), timeIdx);
         const auto& intQuantsOutside = elemCtx.intensiveQuantities(extQuants.exteriorIndex(), timeIdx);
 
+        // calculate the gradients of all mole fractions in a single pass over the
+        // degrees of freedom of the stencil
+        std::array<DimEvalVector, numPhases*numComponents> moleFractionGradients;
+        gradCalc.calculateGradients(moleFractionGradients, elemCtx, faceIdx, moleFractionsCallback);
+
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
             if (!elemCtx.model().phaseIsConsidered(phaseIdx))
                 continue;
 
-            moleFractionCallback.setPhaseIndex(phaseIdx);
             for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
-                moleFractionCallback.setComponentIndex(compIdx);
-
-                DimEvalVector moleFractionGradient(0.0);
-                gradCalc.calculateGradient(moleFractionGradient,
-                                           elemCtx,
-                                           faceIdx,
-                                           moleFractionCallback);
+                const DimEvalVector& moleFractionGradient =
+                    moleFractionGradients[phaseIdx*numComponents + compIdx];
 
                 moleFractionGradientNormal_[phaseIdx][compIdx] = 0.0;
                 for (unsigned i = 0; i < normal.size(); ++i)
@@ -41,7 +41,10 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <atomic>
 #include <cmath>
+#include <mutex>
+#include <vector>
 
 namespace Opm {
 template <class TypeTag>
@@ -79,10 +82,27 @@ struct ForchheimerFluxModule
 template <class TypeTag>
 class ForchheimerBaseProblem
 {
+    using Problem = GetPropType<TypeTag, Properties::Problem>;
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+
+    enum { dimWorld = GridView::dimensionworld };
+    enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
+
+    using DimVector = Dune::FieldVector<Scalar, dimWorld>;
 
 public:
+    /*!
+     * \brief The result of the last Forchheimer iteration at an interior face.
+     */
+    struct ForchheimerFaceState
+    {
+        DimVector filterVelocity[numPhases]{};
+        unsigned numIterations[numPhases]{};
+    };
+
     /*!
      * \brief Returns the Ergun coefficient.
      *
@@ -119,6 +139,63 @@ public:
     {
         return 1.0 / context.intensiveQuantities(spaceIdx, timeIdx).fluidState().viscosity(phaseIdx);
     }
+
+    /*!
+     * \brief Returns the state of the Forchheimer iteration at an interior face of the
+     *        current stencil of an element context.
+     *
+     * The filter velocities which were obtained by the last evaluation of the face
+     * are used as the initial guess of the next one. A face is only evaluated by the
+     * thread which currently processes its element.
+     */
+    ForchheimerFaceState& forchheimerFaceState(const ElementContext& elemCtx,
+                                               unsigned faceIdx) const
+    {
+        const auto& problem = static_cast<const Problem&>(*this);
+        const unsigned generation = problem.faceTableGeneration();
+        if (faceStateGeneration_.load(std::memory_order_acquire) != generation)
+            resizeFaceStates_(generation, problem.numInteriorFaces());
+
+        return faceStates_[problem.interiorFaceIndex(elemCtx, faceIdx)];
+    }
+
+    /*!
+     * \brief Returns the average number of iterations which were needed by the last
+     *        Forchheimer iteration of the interior faces and fluid phases.
+     */
+    Scalar averageForchheimerIterations() const
+    {
+        std::size_t numEvaluations = 0;
+        std::size_t numIterations = 0;
+        for (const auto& faceState : faceStates_) {
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                if (faceState.numIterations[phaseIdx] == 0)
+                    continue;
+
+                ++numEvaluations;
+                numIterations += faceState.numIterations[phaseIdx];
+            }
+        }
+
+        if (numEvaluations == 0)
+            return 0.0;
+        return static_cast<Scalar>(numIterations)/numEvaluations;
+    }
+
+private:
+    void resizeFaceStates_(unsigned generation, std::size_t numFaces) const
+    {
+        std::lock_guard<std::mutex> lock(faceStateMutex_);
+        if (faceStateGeneration_.load(std::memory_order_relaxed) == generation)
+            return; // another thread was faster
+
+        faceStates_.assign(numFaces, ForchheimerFaceState{});
+        faceStateGeneration_.store(generation, std::memory_order_release);
+    }
+
+    mutable std::vector<ForchheimerFaceState> faceStates_;
+    mutable std::atomic<unsigned> faceStateGeneration_{0};
+    mutable std::mutex faceStateMutex_;
 };
 
 /*!
@@ -231,6 +308,7 @@ class ForchheimerExtensiveQuantities
     using DimEvalVector = Dune::FieldVector<Evaluation, dimWorld>;
     using DimMatrix = Dune::FieldMatrix<Scalar, dimWorld, dimWorld>;
     using DimEvalMatrix = Dune::FieldMatrix<Evaluation, dimWorld, dimWorld>;
+    using ForchheimerFaceState = typename ForchheimerBaseProblem<TypeTag>::ForchheimerFaceState;
 
 public:
     /*!
@@ -383,6 +461,8 @@ protected:
                 (getValue(intQuantsI.ergunCoefficient()) +
                  getValue(intQuantsJ.ergunCoefficient())) / 2;
 
+        auto& faceState = elemCtx.problem().forchheimerFaceState(elemCtx, scvfIdx);
+
         ///////////////
         // calculate the weights of the upstream and the downstream control volumes
         ///////////////
@@ -393,7 +473,7 @@ protected:
                 continue;
             }
 
-            calculateForchheimerFlux_(phaseIdx);
+            calculateForchheimerFlux_(phaseIdx, &faceState);
 
             this->volumeFlux_[phaseIdx] = 0.0;
             for (unsigned dimIdx = 0; dimIdx < dimWorld; ++ dimIdx)
@@ -422,7 +502,7 @@ protected:
                 continue;
             }
 
-            calculateForchheimerFlux_(phaseIdx);
+            calculateForchheimerFlux_(phaseIdx, /*faceState=*/nullptr);
 
             this->volumeFlux_[phaseIdx] = 0.0;
             for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
@@ -431,11 +511,17 @@ protected:
         }
     }
 
-    void calculateForchheimerFlux_(unsigned phaseIdx)
+    void calculateForchheimerFlux_(unsigned phaseIdx, ForchheimerFaceState* faceState)
     {
-        // initial guess: filter velocity is zero
+        // initial guess: the filter velocity of the last evaluation of the face if
+        // available, else zero
         DimEvalVector& velocity = this->filterVelocity_[phaseIdx];
-        velocity = 0.0;
+        if (faceState) {
+            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                velocity[dimIdx] = faceState->filterVelocity[phaseIdx][dimIdx];
+        }
+        else
+            velocity = 0.0;
 
         // the change of velocity between two consecutive Newton iterations
         DimEvalVector deltaV(1e5);
@@ -460,6 +546,12 @@ protected:
             gradResid.solve(deltaV, residual);
             velocity -= deltaV;
         }
+
+        if (faceState) {
+            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                faceState->filterVelocity[phaseIdx][dimIdx] = Toolbox::scalarValue(velocity[dimIdx]);
+            faceState->numIterations[phaseIdx] = newtonIter;
+        }
     }
 
     void forchheimerResid_(DimEvalVector& residual, unsigned phaseIdx) const
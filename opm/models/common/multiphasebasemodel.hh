@@ -138,6 +138,10 @@ struct ThermalConductionLawParams<TypeTag, TTag::MultiPhaseBaseModel>
 template<class TypeTag>
 struct EnableGravity<TypeTag, TTag::MultiPhaseBaseModel> { static constexpr bool value = false; };
 
+//! cache the intrinsic permeabilities of the faces by default
+template<class TypeTag>
+struct EnablePermeabilityCache<TypeTag, TTag::MultiPhaseBaseModel> { static constexpr bool value = true; };
+
 
 } // namespace Opm::Properties
 
@@ -193,6 +197,19 @@ public:
     bool phaseIsConsidered(unsigned) const
     { return true; }
 
+    /*!
+     * \copydoc FvBaseDiscretization::prepareIntensiveQuantities
+     *
+     * This lets the problem prefetch the parameters of the material law.
+     */
+    void prepareIntensiveQuantities(std::size_t dofBegin,
+                                    std::size_t dofEnd,
+                                    unsigned timeIdx) const
+    {
+        ParentType::prepareIntensiveQuantities(dofBegin, dofEnd, timeIdx);
+        this->simulator_.problem().prefetchMaterialLawParams(dofBegin, dofEnd);
+    }
+
     /*!
      * \brief Compute the total storage inside one phase of all
      *        conservation quantities.
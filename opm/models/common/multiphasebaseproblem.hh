@@ -43,6 +43,12 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
 namespace Opm {
 /*!
  * \ingroup Discretization
@@ -92,6 +98,18 @@ public:
 
         Parameters::registerParam<TypeTag, Properties::EnableGravity>
             ("Use the gravity correction for the pressure gradients.");
+        Parameters::registerParam<TypeTag, Properties::EnablePermeabilityCache>
+            ("Compute the intrinsic permeabilities of the faces only once per grid "
+             "instead of for each flux evaluation.");
+    }
+
+    /*!
+     * \brief Handle changes of the grid
+     */
+    void gridChanged()
+    {
+        ParentType::gridChanged();
+        faceTableValid_.store(false, std::memory_order_release);
     }
 
     /*!
@@ -121,6 +139,82 @@ public:
                 result[i][j] = harmonicMean(K1[i][j], K2[i][j]);
     }
 
+    /*!
+     * \brief Returns the intrinsic permeability of an interior face of the current
+     *        stencil of an element context.
+     *
+     * Unless the <tt>EnablePermeabilityCache</tt> parameter is false, the result of
+     * intersectionIntrinsicPermeability() is computed once for all faces of the grid
+     * and is afterwards taken from a table. The table is rebuilt after the grid has
+     * been changed; problems with a permeability that varies in time must call
+     * intrinsicPermeabilityChanged() whenever this happens.
+     */
+    void faceIntrinsicPermeability(DimMatrix& result,
+                                   const ElementContext& elemCtx,
+                                   unsigned faceIdx,
+                                   unsigned timeIdx) const
+    {
+        if (!Parameters::getCached<TypeTag, Properties::EnablePermeabilityCache>()) {
+            asImp_().intersectionIntrinsicPermeability(result, elemCtx, faceIdx, timeIdx);
+            return;
+        }
+
+        result = permeabilityCache_[interiorFaceIndex(elemCtx, faceIdx)];
+    }
+
+    /*!
+     * \brief Returns an index of an interior face of the current stencil of an element
+     *        context which is unique for the whole grid.
+     *
+     * The index is smaller than numInteriorFaces(). Since the faces are enumerated from
+     * the point of view of each element, a face which is shared by two stencils gets
+     * two indices. The enumeration stays the same until the grid is changed or the
+     * intrinsic permeability changes; faceTableGeneration() can be used to detect
+     * this.
+     */
+    unsigned interiorFaceIndex(const ElementContext& elemCtx, unsigned faceIdx) const
+    {
+        if (!faceTableValid_.load(std::memory_order_acquire))
+            updateFaceTable_();
+
+        const unsigned elemIdx = this->elementMapper().index(elemCtx.element());
+        assert(faceIdx < elemCtx.stencil(/*timeIdx=*/0).numInteriorFaces());
+        return static_cast<unsigned>(faceOffset_[elemIdx] + faceIdx);
+    }
+
+    /*!
+     * \brief Returns the number of indices returned by interiorFaceIndex().
+     */
+    std::size_t numInteriorFaces() const
+    {
+        if (!faceTableValid_.load(std::memory_order_acquire))
+            updateFaceTable_();
+
+        return numInteriorFaces_;
+    }
+
+    /*!
+     * \brief Returns a number which changes whenever the enumeration of the interior
+     *        faces has been recomputed.
+     */
+    unsigned faceTableGeneration() const
+    {
+        if (!faceTableValid_.load(std::memory_order_acquire))
+            updateFaceTable_();
+
+        return faceTableGeneration_;
+    }
+
+    /*!
+     * \brief Discard the cached intrinsic permeabilities of the faces.
+     *
+     * This needs to be called by problems which change the intrinsic permeability
+     * during a simulation, e.g., at the beginning of a time step. It must not be
+     * called while fluxes are evaluated.
+     */
+    void intrinsicPermeabilityChanged()
+    { faceTableValid_.store(false, std::memory_order_release); }
+
     /*!
      * \name Problem parameters
      */
@@ -250,6 +344,22 @@ public:
         return dummy;
     }
 
+    /*!
+     * \brief Called before the intensive quantities of a contiguous range of degrees
+     *        of freedom are updated.
+     *
+     * Problems which store the parameters of the material law for each degree of
+     * freedom may use this to prefetch the parameters of the range. It is only called
+     * if the intensive quantities are updated in tiles and it may be called by
+     * multiple threads concurrently. The default implementation does nothing.
+     *
+     * \param dofBegin The index of the first degree of freedom of the range.
+     * \param dofEnd The index after the last degree of freedom of the range.
+     */
+    void prefetchMaterialLawParams(std::size_t /*dofBegin*/,
+                                   std::size_t /*dofEnd*/) const
+    {}
+
     template <class FluidState>
     void updateRelperms([[maybe_unused]] std::array<Evaluation,numPhases>& mobility,
                         [[maybe_unused]] DirectionalMobilityPtr& dirMob,
@@ -398,6 +508,54 @@ private:
         if (Parameters::get<TypeTag, Properties::EnableGravity>())
             gravity_[dimWorld-1]  = -9.81;
     }
+
+    // the table is built by the first thread which needs it. this cannot be done in
+    // finishInit() because the permeability is usually set up by the problem after the
+    // base class has been initialized.
+    void updateFaceTable_() const
+    {
+        std::lock_guard<std::mutex> lock(faceTableMutex_);
+        if (faceTableValid_.load(std::memory_order_relaxed))
+            return; // another thread was faster
+
+        const bool cachePermeability =
+            Parameters::get<TypeTag, Properties::EnablePermeabilityCache>();
+        const auto& elemMapper = this->elementMapper();
+        ElementContext elemCtx(this->simulator());
+
+        faceOffset_.resize(elemMapper.size());
+        permeabilityCache_.clear();
+        numInteriorFaces_ = 0;
+        for (const auto& elem : elements(this->gridView())) {
+            elemCtx.updateStencil(elem);
+
+            const unsigned numFaces = elemCtx.stencil(/*timeIdx=*/0).numInteriorFaces();
+            faceOffset_[elemMapper.index(elem)] = numInteriorFaces_;
+            numInteriorFaces_ += numFaces;
+            if (!cachePermeability)
+                continue;
+
+            for (unsigned faceIdx = 0; faceIdx < numFaces; ++faceIdx) {
+                permeabilityCache_.emplace_back();
+                asImp_().intersectionIntrinsicPermeability(permeabilityCache_.back(),
+                                                           elemCtx,
+                                                           faceIdx,
+                                                           /*timeIdx=*/0);
+            }
+        }
+
+        ++faceTableGeneration_;
+        faceTableValid_.store(true, std::memory_order_release);
+    }
+
+    // enumeration of the interior faces of all elements and their intrinsic
+    // permeabilities
+    mutable std::vector<std::size_t> faceOffset_;
+    mutable std::vector<DimMatrix> permeabilityCache_;
+    mutable std::size_t numInteriorFaces_ = 0;
+    mutable unsigned faceTableGeneration_ = 0;
+    mutable std::atomic<bool> faceTableValid_{false};
+    mutable std::mutex faceTableMutex_;
 };
 
 } // namespace Opm
@@ -77,6 +77,9 @@ struct EnableEnergy { using type = UndefinedProperty; };
 //! Returns whether gravity is considered in the problem
 template<class TypeTag, class MyTypeTag>
 struct EnableGravity { using type = UndefinedProperty; };
+//! Compute the intrinsic permeabilities of the faces only once per grid?
+template<class TypeTag, class MyTypeTag>
+struct EnablePermeabilityCache { using type = UndefinedProperty; };
 //! Enable diffusive fluxes?
 template<class TypeTag, class MyTypeTag>
 struct EnableDiffusion { using type = UndefinedProperty; };
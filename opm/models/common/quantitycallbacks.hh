@@ -29,11 +29,13 @@
 #ifndef EWOMS_QUANTITY_CALLBACKS_HH
 #define EWOMS_QUANTITY_CALLBACKS_HH
 
+#include <opm/models/common/multiphasebaseproperties.hh>
 #include <opm/models/discretization/common/fvbaseproperties.hh>
 
 #include <opm/material/common/MathToolbox.hpp>
 #include <opm/material/common/Valgrind.hpp>
 
+#include <array>
 #include <type_traits>
 #include <utility>
 
@@ -123,6 +125,50 @@ private:
     unsigned short phaseIdx_;
 };
 
+/*!
+ * \ingroup Discretization
+ *
+ * \brief Callback class for the pressures of all phases.
+ *
+ * This is used to calculate the gradients of all phase pressures in a single pass
+ * via the calculateGradients() method of the gradient calculators.
+ */
+template <class TypeTag>
+class PhasePressuresCallback
+{
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+
+    using IQFluidState = decltype(std::declval<IntensiveQuantities>().fluidState());
+    using ValueRawType = decltype(std::declval<IQFluidState>().pressure(0));
+    using ValueType = typename std::remove_const<typename std::remove_reference<ValueRawType>::type>::type;
+
+    enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
+
+public:
+    using ResultType = std::array<ValueType, numPhases>;
+
+    PhasePressuresCallback(const ElementContext& elemCtx)
+        : elemCtx_(elemCtx)
+    {}
+
+    /*!
+     * \brief Return the pressures of all phases given the index of a degree of freedom
+     *        within an element context.
+     */
+    ResultType operator()(unsigned dofIdx) const
+    {
+        const auto& fs = elemCtx_.intensiveQuantities(dofIdx, /*timeIdx=*/0).fluidState();
+        ResultType result;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            result[phaseIdx] = fs.pressure(phaseIdx);
+        return result;
+    }
+
+private:
+    const ElementContext& elemCtx_;
+};
+
 /*!
  * \ingroup Discretization
  *
@@ -477,6 +523,54 @@ private:
     unsigned short compIdx_;
 };
 
+/*!
+ * \ingroup Discretization
+ *
+ * \brief Callback class for the mole fractions of all components in all phases.
+ *
+ * The mole fraction of component \c compIdx in phase \c phaseIdx is at the index
+ * <tt>phaseIdx*numComponents + compIdx</tt> of the result. This is used to calculate
+ * the gradients of all mole fractions in a single pass via the calculateGradients()
+ * method of the gradient calculators.
+ */
+template <class TypeTag>
+class MoleFractionsCallback
+{
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+
+    using IQFluidState = decltype(std::declval<IntensiveQuantities>().fluidState());
+    using ValueRawType = decltype(std::declval<IQFluidState>().moleFraction(0, 0));
+    using ValueType = typename std::remove_const<typename std::remove_reference<ValueRawType>::type>::type;
+
+    enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
+    enum { numComponents = getPropValue<TypeTag, Properties::NumComponents>() };
+
+public:
+    using ResultType = std::array<ValueType, numPhases*numComponents>;
+
+    MoleFractionsCallback(const ElementContext& elemCtx)
+        : elemCtx_(elemCtx)
+    {}
+
+    /*!
+     * \brief Return the mole fractions of all components in all phases given the index
+     *        of a degree of freedom within an element context.
+     */
+    ResultType operator()(unsigned dofIdx) const
+    {
+        const auto& fs = elemCtx_.intensiveQuantities(dofIdx, /*timeIdx=*/0).fluidState();
+        ResultType result;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                result[phaseIdx*numComponents + compIdx] = fs.moleFraction(phaseIdx, compIdx);
+        return result;
+    }
+
+private:
+    const ElementContext& elemCtx_;
+};
+
 } // namespace Opm
 
 #endif
@@ -0,0 +1,143 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::RegionalMaterialLawParams
+ */
+#ifndef EWOMS_REGIONAL_MATERIAL_LAW_PARAMS_HH
+#define EWOMS_REGIONAL_MATERIAL_LAW_PARAMS_HH
+
+#include <opm/models/utils/prefetch.hh>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup MultiPhaseBaseModel
+ *
+ * \brief Stores the parameters of the material law for a set of regions together with
+ *        the region of each degree of freedom.
+ *
+ * The parameter objects of all regions are stored contiguously and each degree of
+ * freedom only stores the 16 bit index of its region. Compared to storing a pointer to
+ * the parameter object for each degree of freedom, this needs a quarter of the memory
+ * bandwidth when the intensive quantities are updated, and the few parameter objects
+ * stay in the cache.
+ */
+template <class Params>
+class RegionalMaterialLawParams
+{
+public:
+    using RegionIndex = std::uint16_t;
+
+    /*!
+     * \brief Add the parameters of a region and return the index of the region.
+     *
+     * The parameter objects must not be modified after the degrees of freedom have
+     * been assigned to the regions.
+     */
+    RegionIndex addRegion(const Params& params)
+    {
+        if (regionParams_.size() > std::numeric_limits<RegionIndex>::max())
+            throw std::length_error("Too many regions of material law parameters");
+        regionParams_.push_back(params);
+        return static_cast<RegionIndex>(regionParams_.size() - 1);
+    }
+
+    /*!
+     * \brief Set the number of degrees of freedom.
+     *
+     * All degrees of freedom are initially assigned to the first region.
+     */
+    void resize(std::size_t numDof)
+    { dofRegion_.assign(numDof, 0); }
+
+    /*!
+     * \brief Assign a degree of freedom to a region.
+     */
+    void setRegion(std::size_t dofIdx, RegionIndex regionIdx)
+    {
+        assert(regionIdx < regionParams_.size());
+        dofRegion_[dofIdx] = regionIdx;
+    }
+
+    /*!
+     * \brief Returns the region index of a degree of freedom.
+     */
+    RegionIndex region(std::size_t dofIdx) const
+    { return dofRegion_[dofIdx]; }
+
+    /*!
+     * \brief Returns the number of regions.
+     */
+    std::size_t numRegions() const
+    { return regionParams_.size(); }
+
+    /*!
+     * \brief Returns the parameters of a region.
+     */
+    const Params& regionParams(RegionIndex regionIdx) const
+    { return regionParams_[regionIdx]; }
+
+    Params& regionParams(RegionIndex regionIdx)
+    { return regionParams_[regionIdx]; }
+
+    /*!
+     * \brief Returns the parameters of the material law for a degree of freedom.
+     */
+    const Params& operator[](std::size_t dofIdx) const
+    { return regionParams_[dofRegion_[dofIdx]]; }
+
+    /*!
+     * \brief Prefetch the region indices of a range of degrees of freedom.
+     *
+     * The parameter objects of all regions are prefetched as well if there are only a
+     * few of them.
+     */
+    void prefetch(std::size_t dofBegin, std::size_t dofEnd) const
+    {
+        if (dofBegin >= dofEnd)
+            return;
+
+        Opm::prefetch(dofRegion_[dofBegin], static_cast<unsigned>(dofEnd - dofBegin));
+        if (regionParams_.size() <= maxPrefetchedRegions)
+            Opm::prefetch(regionParams_.front(), static_cast<unsigned>(regionParams_.size()));
+    }
+
+private:
+    static constexpr std::size_t maxPrefetchedRegions = 8;
+
+    std::vector<Params> regionParams_;
+    std::vector<RegionIndex> dofRegion_;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,141 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::DiscreteFractureConnectionTable
+ */
+#ifndef EWOMS_DISCRETE_FRACTURE_CONNECTION_TABLE_HH
+#define EWOMS_DISCRETE_FRACTURE_CONNECTION_TABLE_HH
+
+#include <dune/common/fvector.hh>
+#include <dune/common/fmatrix.hh>
+
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup DiscreteFractureModel
+ *
+ * \brief Stores the geometry of the fracture-matrix connections of all elements.
+ *
+ * For each sub-control volume face of an element, the table records whether a
+ * fracture runs along it and, if this is the case, the averaged fracture
+ * permeability, the fracture width and the factor which converts the normal
+ * component of the fracture filter velocity into the volume flux through the face.
+ * For each sub-control volume, the volume occupied by fractures is stored.
+ *
+ * These quantities only depend on the grid and on the fracture properties specified
+ * by the problem, so they can be computed once instead of each time an element
+ * context is updated. This requires the fracture width and permeability to be
+ * independent of time.
+ */
+template <class Scalar, unsigned dimWorld>
+class DiscreteFractureConnectionTable
+{
+public:
+    using DimVector = Dune::FieldVector<Scalar, dimWorld>;
+    using DimMatrix = Dune::FieldMatrix<Scalar, dimWorld, dimWorld>;
+
+    //! The fracture geometry of a sub-control volume face
+    struct Face
+    {
+        //! The averaged intrinsic permeability of the fracture
+        DimMatrix intrinsicPermeability{};
+        //! The unit vector from the interior to the exterior degree of freedom
+        DimVector direction{};
+        //! The width of the fracture
+        Scalar width = 0.0;
+        //! Half of the fracture width divided by the face area
+        Scalar fluxFactor = 0.0;
+        //! True if a fracture runs along the face
+        bool isFracture = false;
+    };
+
+    /*!
+     * \brief Discard all entries and prepare the table for a given number of elements.
+     */
+    void clear(std::size_t numElements)
+    {
+        faceOffsets_.assign(numElements, 0);
+        dofOffsets_.assign(numElements, 0);
+        faces_.clear();
+        dofFractureVolumes_.clear();
+    }
+
+    /*!
+     * \brief Returns true if the table does not contain any elements.
+     */
+    bool empty() const
+    { return faceOffsets_.empty(); }
+
+    /*!
+     * \brief Start the entries of an element.
+     *
+     * The faces and sub-control volumes of the element must be added subsequently
+     * in the order of their local indices.
+     */
+    void beginElement(std::size_t elemIdx)
+    {
+        faceOffsets_[elemIdx] = faces_.size();
+        dofOffsets_[elemIdx] = dofFractureVolumes_.size();
+    }
+
+    /*!
+     * \brief Add the next sub-control volume face of the current element.
+     */
+    void addFace(const Face& face)
+    { faces_.push_back(face); }
+
+    /*!
+     * \brief Add the fracture volume of the next sub-control volume of the current
+     *        element.
+     */
+    void addDof(Scalar fractureVolume)
+    { dofFractureVolumes_.push_back(fractureVolume); }
+
+    /*!
+     * \brief Returns the fracture geometry of a sub-control volume face of an element.
+     */
+    const Face& face(std::size_t elemIdx, unsigned scvfIdx) const
+    { return faces_[faceOffsets_[elemIdx] + scvfIdx]; }
+
+    /*!
+     * \brief Returns the volume occupied by fractures within a sub-control volume of
+     *        an element.
+     */
+    Scalar fractureVolume(std::size_t elemIdx, unsigned dofIdx) const
+    { return dofFractureVolumes_[dofOffsets_[elemIdx] + dofIdx]; }
+
+private:
+    std::vector<std::size_t> faceOffsets_;
+    std::vector<std::size_t> dofOffsets_;
+    std::vector<Face> faces_;
+    std::vector<Scalar> dofFractureVolumes_;
+};
+
+} // namespace Opm
+
+#endif
@@ -28,11 +28,15 @@
 #ifndef EWOMS_DISCRETE_FRACTURE_EXTENSIVE_QUANTITIES_HH
 #define EWOMS_DISCRETE_FRACTURE_EXTENSIVE_QUANTITIES_HH
 
+#include "discretefractureconnectiontable.hh"
+
 #include <opm/models/immiscible/immiscibleextensivequantities.hh>
 
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <cassert>
+
 namespace Opm {
 
 /*!
@@ -58,6 +62,9 @@ class DiscreteFractureExtensiveQuantities : public ImmiscibleExtensiveQuantities
     using DimVector = Dune::FieldVector<Scalar, dimWorld>;
 
 public:
+    using FractureConnectionTable = DiscreteFractureConnectionTable<Scalar, dimWorld>;
+    using FractureFace = typename FractureConnectionTable::Face;
+
     /*!
      * \copydoc MultiPhaseBaseExtensiveQuantities::update()
      */
@@ -65,7 +72,29 @@ public:
     {
         ParentType::update(elemCtx, scvfIdx, timeIdx);
 
-        const auto& extQuants = elemCtx.extensiveQuantities(scvfIdx, timeIdx);
+        const auto& model = elemCtx.model();
+        const FractureConnectionTable* connectionTable = model.fractureConnectionTable();
+        if (connectionTable) {
+            unsigned elemIdx = model.elementMapper().index(elemCtx.element());
+            updateFracture_(elemCtx, scvfIdx, timeIdx, connectionTable->face(elemIdx, scvfIdx));
+        }
+        else {
+            FractureFace face;
+            computeFractureFace(face, elemCtx, scvfIdx, timeIdx);
+            updateFracture_(elemCtx, scvfIdx, timeIdx, face);
+        }
+    }
+
+    /*!
+     * \brief Compute the fracture geometry of a sub-control volume face.
+     *
+     * If no fracture runs along the face, only its isFracture flag is set.
+     */
+    static void computeFractureFace(FractureFace& face,
+                                    const ElementContext& elemCtx,
+                                    unsigned scvfIdx,
+                                    unsigned timeIdx)
+    {
         const auto& stencil = elemCtx.stencil(timeIdx);
         const auto& scvf = stencil.interiorFace(scvfIdx);
         unsigned insideScvIdx = scvf.interiorIndex();
@@ -73,23 +102,43 @@ public:
 
         unsigned globalI = elemCtx.globalSpaceIndex(insideScvIdx, timeIdx);
         unsigned globalJ = elemCtx.globalSpaceIndex(outsideScvIdx, timeIdx);
-        const auto& fractureMapper = elemCtx.problem().fractureMapper();
-        if (!fractureMapper.isFractureEdge(globalI, globalJ))
-            // do nothing if no fracture goes though the current edge
+        const auto& problem = elemCtx.problem();
+        face.isFracture = problem.fractureMapper().isFractureEdge(globalI, globalJ);
+        if (!face.isFracture)
             return;
 
         // average the intrinsic permeability of the fracture
-        elemCtx.problem().fractureFaceIntrinsicPermeability(fractureIntrinsicPermeability_,
-                                                            elemCtx, scvfIdx, timeIdx);
+        problem.fractureFaceIntrinsicPermeability(face.intrinsicPermeability,
+                                                  elemCtx, scvfIdx, timeIdx);
 
-        auto distDirection = elemCtx.pos(outsideScvIdx, timeIdx);
-        distDirection -= elemCtx.pos(insideScvIdx, timeIdx);
-        distDirection /= distDirection.two_norm();
+        face.direction = elemCtx.pos(outsideScvIdx, timeIdx);
+        face.direction -= elemCtx.pos(insideScvIdx, timeIdx);
+        face.direction /= face.direction.two_norm();
 
-        const auto& problem = elemCtx.problem();
-        fractureWidth_ = problem.fractureWidth(elemCtx, insideScvIdx,
-                                               outsideScvIdx, timeIdx);
-        assert(fractureWidth_ < scvf.area());
+        face.width = problem.fractureWidth(elemCtx, insideScvIdx,
+                                           outsideScvIdx, timeIdx);
+        assert(face.width < scvf.area());
+
+        // divide the volume flux by two. This is required because
+        // a fracture is always shared by two sub-control-volume
+        // faces.
+        face.fluxFactor = (face.width / 2.0) / scvf.area();
+    }
+
+private:
+    void updateFracture_(const ElementContext& elemCtx,
+                         unsigned scvfIdx,
+                         unsigned timeIdx,
+                         const FractureFace& face)
+    {
+        if (!face.isFracture)
+            // do nothing if no fracture goes though the current edge
+            return;
+
+        const auto& extQuants = elemCtx.extensiveQuantities(scvfIdx, timeIdx);
+
+        fractureIntrinsicPermeability_ = face.intrinsicPermeability;
+        fractureWidth_ = face.width;
 
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
             const auto& pGrad = extQuants.potentialGrad(phaseIdx);
@@ -102,14 +151,8 @@ public:
                                               fractureFilterVelocity_[phaseIdx]);
             fractureFilterVelocity_[phaseIdx] *= -up.fractureMobility(phaseIdx);
 
-            // divide the volume flux by two. This is required because
-            // a fracture is always shared by two sub-control-volume
-            // faces.
-            fractureVolumeFlux_[phaseIdx] = 0;
-            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
-                fractureVolumeFlux_[phaseIdx] +=
-                    (fractureFilterVelocity_[phaseIdx][dimIdx] * distDirection[dimIdx])
-                    * (fractureWidth_ / 2.0) / scvf.area();
+            fractureVolumeFlux_[phaseIdx] =
+                (fractureFilterVelocity_[phaseIdx] * face.direction) * face.fluxFactor;
         }
     }
 
@@ -114,34 +114,14 @@ public:
         fractureIntrinsicPermeability_ =
             problem.fractureIntrinsicPermeability(elemCtx, vertexIdx, timeIdx);
 
-        // compute the fracture volume for the current sub-control
-        // volume. note, that we don't take overlaps of fractures into
-        // account for this.
-        fractureVolume_ = 0;
-        const auto& vertexPos = elemCtx.pos(vertexIdx, timeIdx);
-        for (unsigned vertex2Idx = 0; vertex2Idx < elemCtx.numDof(/*timeIdx=*/0); ++ vertex2Idx) {
-            unsigned globalVertex2Idx = elemCtx.globalSpaceIndex(vertex2Idx, timeIdx);
-
-            if (vertexIdx == vertex2Idx ||
-                !fractureMapper.isFractureEdge(globalVertexIdx, globalVertex2Idx))
-                continue;
-
-            Scalar fractureWidth =
-                problem.fractureWidth(elemCtx, vertexIdx, vertex2Idx, timeIdx);
-
-            auto distVec = elemCtx.pos(vertex2Idx, timeIdx);
-            distVec -= vertexPos;
-
-            Scalar edgeLength = distVec.two_norm();
-
-            // the fracture is always adjacent to two sub-control
-            // volumes of the control volume, so when calculating the
-            // volume of the fracture which gets attributed to one
-            // SCV, the fracture width needs to divided by 2. Also,
-            // only half of the edge is located in the current control
-            // volume, so its length also needs to divided by 2.
-            fractureVolume_ += (fractureWidth / 2) * (edgeLength / 2);
+        const auto& model = elemCtx.model();
+        const auto* connectionTable = model.fractureConnectionTable();
+        if (connectionTable) {
+            unsigned elemIdx = model.elementMapper().index(elemCtx.element());
+            fractureVolume_ = connectionTable->fractureVolume(elemIdx, vertexIdx);
         }
+        else
+            fractureVolume_ = computeFractureVolume(elemCtx, vertexIdx, timeIdx);
 
         //////////
         // set the fluid state for the fracture.
@@ -182,6 +162,52 @@ public:
         fractureFluidState_.checkDefined();
     }
 
+    /*!
+     * \brief Compute the volume [m^2] occupied by fractures within a sub-control
+     *        volume.
+     */
+    static Scalar computeFractureVolume(const ElementContext& elemCtx,
+                                        unsigned vertexIdx,
+                                        unsigned timeIdx)
+    {
+        const auto& problem = elemCtx.problem();
+        const auto& fractureMapper = problem.fractureMapper();
+        unsigned globalVertexIdx = elemCtx.globalSpaceIndex(vertexIdx, timeIdx);
+        if (!fractureMapper.isFractureVertex(globalVertexIdx))
+            return 0.0;
+
+        // compute the fracture volume for the current sub-control
+        // volume. note, that we don't take overlaps of fractures into
+        // account for this.
+        Scalar fractureVolume = 0;
+        const auto& vertexPos = elemCtx.pos(vertexIdx, timeIdx);
+        for (unsigned vertex2Idx = 0; vertex2Idx < elemCtx.numDof(/*timeIdx=*/0); ++ vertex2Idx) {
+            unsigned globalVertex2Idx = elemCtx.globalSpaceIndex(vertex2Idx, timeIdx);
+
+            if (vertexIdx == vertex2Idx ||
+                !fractureMapper.isFractureEdge(globalVertexIdx, globalVertex2Idx))
+                continue;
+
+            Scalar fractureWidth =
+                problem.fractureWidth(elemCtx, vertexIdx, vertex2Idx, timeIdx);
+
+            auto distVec = elemCtx.pos(vertex2Idx, timeIdx);
+            distVec -= vertexPos;
+
+            Scalar edgeLength = distVec.two_norm();
+
+            // the fracture is always adjacent to two sub-control
+            // volumes of the control volume, so when calculating the
+            // volume of the fracture which gets attributed to one
+            // SCV, the fracture width needs to divided by 2. Also,
+            // only half of the edge is located in the current control
+            // volume, so its length also needs to divided by 2.
+            fractureVolume += (fractureWidth / 2) * (edgeLength / 2);
+        }
+
+        return fractureVolume;
+    }
+
 public:
     /*!
      * \brief Returns the effective mobility of a given phase within
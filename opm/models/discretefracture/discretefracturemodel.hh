@@ -31,6 +31,7 @@
 #include <opm/material/densead/Math.hpp>
 
 #include "discretefractureproperties.hh"
+#include "discretefractureconnectiontable.hh"
 #include "discretefractureprimaryvariables.hh"
 #include "discretefractureintensivequantities.hh"
 #include "discretefractureextensivequantities.hh"
@@ -93,6 +94,10 @@ struct ExtensiveQuantities<TypeTag, TTag::DiscreteFractureModel>
 template<class TypeTag>
 struct UseTwoPointGradients<TypeTag, TTag::DiscreteFractureModel> { static constexpr bool value = true; };
 
+//! By default, the fracture geometry is computed for each element context
+template<class TypeTag>
+struct EnableFractureConnectionTable<TypeTag, TTag::DiscreteFractureModel> { static constexpr bool value = false; };
+
 // The intensive quantity cache cannot be used by the discrete fracture model, because
 // the intensive quantities of a control degree of freedom are not identical to the
 // intensive quantities of the other intensive quantities of the same of the same degree
@@ -127,8 +132,17 @@ class DiscreteFractureModel : public ImmiscibleModel<TypeTag>
 {
     using ParentType = ImmiscibleModel<TypeTag>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using ExtensiveQuantities = GetPropType<TypeTag, Properties::ExtensiveQuantities>;
+
+    enum { dimWorld = GridView::dimensionworld };
 
 public:
+    using FractureConnectionTable = DiscreteFractureConnectionTable<Scalar, dimWorld>;
+
     DiscreteFractureModel(Simulator& simulator)
         : ParentType(simulator)
     {
@@ -147,8 +161,45 @@ public:
 
         // register runtime parameters of the VTK output modules
         Opm::VtkDiscreteFractureModule<TypeTag>::registerParameters();
+
+        Parameters::registerParam<TypeTag, Properties::EnableFractureConnectionTable>
+            ("Compute the fracture geometry of all elements once instead of each time "
+             "an element context is updated. This requires the fracture width and "
+             "permeability to be independent of time");
     }
 
+    /*!
+     * \copydoc FvBaseDiscretization::finishInit
+     */
+    void finishInit()
+    {
+        // the parent class evaluates the initial solution, so the table must exist first
+        enableConnectionTable_ = Parameters::get<TypeTag, Properties::EnableFractureConnectionTable>();
+        if (enableConnectionTable_)
+            updateFractureConnectionTable_();
+
+        ParentType::finishInit();
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::adaptGrid
+     */
+    void adaptGrid()
+    {
+        ParentType::adaptGrid();
+
+        if (enableConnectionTable_)
+            updateFractureConnectionTable_();
+    }
+
+    /*!
+     * \brief Returns the precomputed fracture geometry of the elements.
+     *
+     * If the connection table is disabled, nullptr is returned.
+     */
+    const FractureConnectionTable* fractureConnectionTable() const
+    { return enableConnectionTable_ ? &connectionTable_ : nullptr; }
+
     /*!
      * \copydoc FvBaseDiscretization::name
      */
@@ -161,6 +212,34 @@ public:
 
         this->addOutputModule(new Opm::VtkDiscreteFractureModule<TypeTag>(this->simulator_));
     }
+
+private:
+    void updateFractureConnectionTable_()
+    {
+        const auto& gridView = this->gridView();
+        connectionTable_.clear(gridView.size(/*codim=*/0));
+
+        ElementContext elemCtx(this->simulator_);
+        typename FractureConnectionTable::Face face;
+        for (const auto& elem : elements(gridView)) {
+            elemCtx.updateStencil(elem);
+            connectionTable_.beginElement(this->elementMapper().index(elem));
+
+            const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+            for (unsigned scvfIdx = 0; scvfIdx < stencil.numInteriorFaces(); ++scvfIdx) {
+                face = {};
+                ExtensiveQuantities::computeFractureFace(face, elemCtx, scvfIdx, /*timeIdx=*/0);
+                connectionTable_.addFace(face);
+            }
+
+            for (unsigned dofIdx = 0; dofIdx < elemCtx.numDof(/*timeIdx=*/0); ++dofIdx)
+                connectionTable_.addDof(IntensiveQuantities::computeFractureVolume(elemCtx, dofIdx,
+                                                                                   /*timeIdx=*/0));
+        }
+    }
+
+    FractureConnectionTable connectionTable_;
+    bool enableConnectionTable_ = false;
 };
 } // namespace Opm
 
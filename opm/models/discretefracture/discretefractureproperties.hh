@@ -39,6 +39,11 @@ namespace Opm::Properties {
 template<class TypeTag, class MyTypeTag>
 struct UseTwoPointGradients { using type = UndefinedProperty; };
 
+//! Compute the fracture geometry of all elements once instead of each time an
+//! element context is updated
+template<class TypeTag, class MyTypeTag>
+struct EnableFractureConnectionTable { using type = UndefinedProperty; };
+
 } // namespace Opm::Properties
 
 #endif
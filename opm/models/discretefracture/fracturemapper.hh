@@ -30,34 +30,26 @@
 #include <opm/models/utils/propertysystem.hh>
 
 #include <algorithm>
-#include <set>
+#include <cstddef>
+#include <utility>
+#include <vector>
 
 namespace Opm {
 
 /*!
  * \ingroup DiscreteFractureModel
  * \brief Stores the topology of fractures.
+ *
+ * The fracture vertices are stored as a flag per vertex and the fracture edges as a
+ * sorted list of neighbors per vertex in compressed row format. Each edge is stored
+ * for the vertex with the smaller index. Since the queries are conducted for every
+ * vertex and edge of the grid by the element loops of the discrete fracture model,
+ * both of them only access contiguous memory. Edges which were added after the last
+ * call to finalize() are still considered, albeit using a linear search.
  */
 template <class TypeTag>
 class FractureMapper
 {
-    struct FractureEdge
-    {
-        FractureEdge(unsigned edgeVertex1Idx, unsigned edgeVertex2Idx)
-            : i_(std::min(edgeVertex1Idx, edgeVertex2Idx)),
-              j_(std::max(edgeVertex1Idx, edgeVertex2Idx))
-        {}
-
-        bool operator<(const FractureEdge& e) const
-        { return i_ < e.i_ || (i_ == e.i_ && j_ < e.j_); }
-
-        bool operator==(const FractureEdge& e) const
-        { return i_ == e.i_ && j_ == e.j_; }
-
-        unsigned i_;
-        unsigned j_;
-    };
-
 public:
     /*!
      * \brief Constructor
@@ -73,9 +65,45 @@ public:
      */
     void addFractureEdge(unsigned vertexIdx1, unsigned vertexIdx2)
     {
-        fractureEdges_.insert(FractureEdge(vertexIdx1, vertexIdx2));
-        fractureVertices_.insert(vertexIdx1);
-        fractureVertices_.insert(vertexIdx2);
+        const unsigned maxIdx = std::max(vertexIdx1, vertexIdx2);
+        if (maxIdx >= isFractureVertex_.size())
+            isFractureVertex_.resize(maxIdx + 1, 0);
+        isFractureVertex_[vertexIdx1] = 1;
+        isFractureVertex_[vertexIdx2] = 1;
+
+        pendingEdges_.emplace_back(std::min(vertexIdx1, vertexIdx2),
+                                   std::max(vertexIdx1, vertexIdx2));
+    }
+
+    /*!
+     * \brief Build the compressed representation of all edges that have been added.
+     *
+     * This should be called once all fracture edges have been added.
+     */
+    void finalize()
+    {
+        if (pendingEdges_.empty())
+            return;
+
+        // merge the existing edges with the new ones
+        std::vector<std::pair<unsigned, unsigned>> edges(std::move(pendingEdges_));
+        pendingEdges_.clear();
+        for (std::size_t vertexIdx = 0; vertexIdx + 1 < edgeOffsets_.size(); ++vertexIdx)
+            for (std::size_t pos = edgeOffsets_[vertexIdx]; pos < edgeOffsets_[vertexIdx + 1]; ++pos)
+                edges.emplace_back(static_cast<unsigned>(vertexIdx), edgeNeighbors_[pos]);
+
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        edgeOffsets_.assign(isFractureVertex_.size() + 1, 0);
+        for (const auto& edge : edges)
+            ++edgeOffsets_[edge.first + 1];
+        for (std::size_t vertexIdx = 0; vertexIdx + 1 < edgeOffsets_.size(); ++vertexIdx)
+            edgeOffsets_[vertexIdx + 1] += edgeOffsets_[vertexIdx];
+
+        edgeNeighbors_.resize(edges.size());
+        for (std::size_t edgeIdx = 0; edgeIdx < edges.size(); ++edgeIdx)
+            edgeNeighbors_[edgeIdx] = edges[edgeIdx].second;
     }
 
     /*!
@@ -84,7 +112,7 @@ public:
      * \param vertexIdx The index of the vertex.
      */
     bool isFractureVertex(unsigned vertexIdx) const
-    { return fractureVertices_.count(vertexIdx) > 0; }
+    { return vertexIdx < isFractureVertex_.size() && isFractureVertex_[vertexIdx]; }
 
     /*!
      * \brief Returns true iff a fracture is associated with a given edge.
@@ -94,13 +122,33 @@ public:
      */
     bool isFractureEdge(unsigned vertex1Idx, unsigned vertex2Idx) const
     {
-        FractureEdge tmp(vertex1Idx, vertex2Idx);
-        return fractureEdges_.count(tmp) > 0;
+        // both vertices of a fracture edge are fracture vertices. this rejects most of
+        // the edges of the grid without looking at the edge lists.
+        if (!isFractureVertex(vertex1Idx) || !isFractureVertex(vertex2Idx))
+            return false;
+
+        const unsigned i = std::min(vertex1Idx, vertex2Idx);
+        const unsigned j = std::max(vertex1Idx, vertex2Idx);
+        if (i + 1 < edgeOffsets_.size()) {
+            const auto begin = edgeNeighbors_.begin() + edgeOffsets_[i];
+            const auto end = edgeNeighbors_.begin() + edgeOffsets_[i + 1];
+            if (std::binary_search(begin, end, j))
+                return true;
+        }
+
+        return !pendingEdges_.empty()
+            && std::find(pendingEdges_.begin(), pendingEdges_.end(), std::make_pair(i, j)) != pendingEdges_.end();
     }
 
 private:
-    std::set<FractureEdge> fractureEdges_;
-    std::set<unsigned> fractureVertices_;
+    std::vector<unsigned char> isFractureVertex_;
+
+    // the neighbors with larger indices of each vertex
+    std::vector<std::size_t> edgeOffsets_;
+    std::vector<unsigned> edgeNeighbors_;
+
+    // the edges which are not yet part of the compressed representation
+    std::vector<std::pair<unsigned, unsigned>> pendingEdges_;
 };
 
 } // namespace Opm
@@ -0,0 +1,162 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::BaseSparseSourceTerm
+ */
+#ifndef EWOMS_BASE_SPARSE_SOURCE_TERM_HH
+#define EWOMS_BASE_SPARSE_SOURCE_TERM_HH
+
+#include <opm/models/utils/propertysystem.hh>
+#include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/simulators/linalg/linalgproperties.hh>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup ModelModules
+ *
+ * \brief Gives a sparse source term access to the rows of the linearized system of
+ *        equations which belong to its cells.
+ *
+ * If only the residual is linearized, the derivatives are written to a scratch block
+ * which is private to the calling thread.
+ */
+template <class TypeTag>
+class SparseSourceRows
+{
+    using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+
+public:
+    using VectorBlock = typename GlobalEqVector::block_type;
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+
+    SparseSourceRows(GlobalEqVector& residual,
+                     MatrixBlock* const* diagonal,
+                     MatrixBlock* const* couplings,
+                     MatrixBlock* scratch)
+        : residual_(residual)
+        , diagonal_(diagonal)
+        , couplings_(couplings)
+        , scratch_(scratch)
+    {}
+
+    /*!
+     * \brief Returns the residual of a cell.
+     */
+    VectorBlock& residual(unsigned cellIdx)
+    { return residual_[cellIdx]; }
+
+    /*!
+     * \brief Returns the block on the diagonal of the Jacobian matrix for a cell.
+     */
+    MatrixBlock& diagonal(unsigned cellIdx)
+    { return scratch_ ? *scratch_ : *diagonal_[cellIdx]; }
+
+    /*!
+     * \brief Returns the block of the Jacobian matrix for a coupling of the source
+     *        term, see BaseSparseSourceTerm::couplings().
+     */
+    MatrixBlock& coupling(std::size_t couplingIdx)
+    { return scratch_ ? *scratch_ : *couplings_[couplingIdx]; }
+
+    /*!
+     * \brief Returns true if only the residual is linearized.
+     */
+    bool residualOnly() const
+    { return scratch_ != nullptr; }
+
+private:
+    GlobalEqVector& residual_;
+    MatrixBlock* const* diagonal_;
+    MatrixBlock* const* couplings_;
+    MatrixBlock* scratch_;
+};
+
+/*!
+ * \ingroup ModelModules
+ *
+ * \brief Base class for source terms which only affect a small number of cells, e.g.,
+ *        wells.
+ *
+ * The source term consists of entries, each of which belongs to a single cell, e.g.,
+ * the perforations of a well. A cell may be the cell of several entries and of entries
+ * of several source terms. The entries may also be coupled to other cells, e.g., the
+ * perforations of a well to each other, which results in additional off-diagonal
+ * blocks of the Jacobian matrix.
+ *
+ * The linearizer queries the cells and couplings once when the source term is
+ * registered and whenever it is told that they changed. It then calls linearize() for
+ * ranges of the entries from several threads concurrently. The ranges are chosen such
+ * that the cells of the entries of concurrent calls are disjoint, i.e., linearize()
+ * must only write to the rows of the cells of the given entries and must not modify
+ * any other state of the object without synchronization.
+ */
+template <class TypeTag>
+class BaseSparseSourceTerm
+{
+public:
+    using Rows = SparseSourceRows<TypeTag>;
+
+    virtual ~BaseSparseSourceTerm()
+    {}
+
+    /*!
+     * \brief Returns the cell of each entry of the source term.
+     */
+    virtual std::vector<unsigned> cells() const = 0;
+
+    /*!
+     * \brief Returns the couplings of the entries to other cells.
+     *
+     * Each coupling is given by the index of the entry and the index of the cell. Its
+     * derivatives are stored in the block of the row of the entry's cell and the
+     * column of the given cell, which is accessed by Rows::coupling() using the
+     * position of the coupling in the returned vector.
+     */
+    virtual std::vector<std::pair<std::size_t, unsigned>> couplings() const
+    { return {}; }
+
+    /*!
+     * \brief Add the contributions of a range of entries to the residual and the
+     *        Jacobian matrix.
+     *
+     * Like for the cells of the grid, the residual is the negative of the source
+     * terms integrated over the volume of the cell.
+     *
+     * \param entryBegin The index of the first entry
+     * \param entryEnd The index after the last entry
+     * \param rows The rows of the system of equations
+     */
+    virtual void linearize(std::size_t entryBegin, std::size_t entryEnd, Rows& rows) = 0;
+};
+
+} // namespace Opm
+
+#endif
@@ -47,12 +47,18 @@
 #include "baseauxiliarymodule.hh"
 
 #include <opm/models/parallel/gridcommhandles.hh>
+#include <opm/models/parallel/threadloadstatistics.hh>
 #include <opm/models/parallel/threadmanager.hh>
 #include <opm/simulators/linalg/nullborderlistmanager.hh>
 #include <opm/models/utils/simulator.hh>
 #include <opm/models/utils/alignedallocator.hh>
+#include <opm/models/utils/autotuner.hh>
+#include <opm/models/utils/hardwarecounters.hh>
+#include <opm/models/utils/memoryusage.hh>
+#include <opm/models/utils/regionprofiler.hh>
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
+#include <opm/models/io/outputplan.hh>
 #include <opm/models/io/vtkprimaryvarsmodule.hh>
 
 #include <opm/material/common/MathToolbox.hpp>
@@ -61,13 +67,21 @@
 #include <dune/common/version.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
+#include <dune/common/iteratorrange.hh>
 #include <dune/istl/bvector.hh>
 
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
 #include <limits>
 #include <list>
+#include <mutex>
+#include <numeric>
 #include <stdexcept>
 #include <sstream>
 #include <string>
@@ -132,6 +146,32 @@ struct MaxTimeStepDivisions<TypeTag, TTag::FvBaseDiscretization> { static conste
 template<class TypeTag>
 struct ContinueOnConvergenceError<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
 
+//! By default, the time step size is only chosen based on the number of Newton
+//! iterations
+template<class TypeTag>
+struct TimeStepControl<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = "iterations"; };
+
+template<class TypeTag>
+struct TimeStepControlTolerance<TypeTag, TTag::FvBaseDiscretization>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.1;
+};
+
+//! By default, all cells are integrated using the same time step size
+template<class TypeTag>
+struct MultirateSubsteps<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 0; };
+
+template<class TypeTag>
+struct MultirateTolerance<TypeTag, TTag::FvBaseDiscretization>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.05;
+};
+
+template<class TypeTag>
+struct MultirateBufferLayers<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 1; };
+
 /*!
  * \brief A vector of quanties, each for one equation.
  */
@@ -215,7 +255,13 @@ struct ThreadManager<TypeTag, TTag::FvBaseDiscretization> { using type = ::Opm::
 template<class TypeTag>
 struct ThreadsPerProcess<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 1; };
 template<class TypeTag>
+struct ThreadAffinity<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = "none"; };
+template<class TypeTag>
+struct EnableThreadLoadStatistics<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+template<class TypeTag>
 struct UseLinearizationLock<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = true; };
+template<class TypeTag>
+struct ColoredElementAssembly<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
 
 /*!
  * \brief Linearizer for the global system of equations.
@@ -257,14 +303,92 @@ struct EnableVtkOutput<TypeTag, TTag::FvBaseDiscretization> { static constexpr b
 template<class TypeTag>
 struct EnableAsyncVtkOutput<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = true; };
 
+//! By default, a single thread writes the asynchronous VTK output
+template<class TypeTag>
+struct VtkOutputThreads<TypeTag, TTag::FvBaseDiscretization> { static constexpr unsigned value = 1; };
+
+//! By default, the output of a time step may be written while the next one is prepared
+template<class TypeTag>
+struct VtkOutputQueueDepth<TypeTag, TTag::FvBaseDiscretization> { static constexpr unsigned value = 2; };
+
+//! By default, the data of the pending VTK output may occupy up to 1 GiB
+template<class TypeTag>
+struct VtkOutputMemoryBudget<TypeTag, TTag::FvBaseDiscretization> { static constexpr unsigned value = 1024; };
+
+//! By default, each process writes its own VTK piece
+template<class TypeTag>
+struct VtkOutputAggregation<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 1; };
+
+//! Disable the HDF5 output by default
+template<class TypeTag>
+struct EnableHdf5Output<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+//! By default, the HDF5 output of each time step is written into a separate file
+template<class TypeTag>
+struct Hdf5OutputSingleFile<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+//! Disable the statistics output by default
+template<class TypeTag>
+struct EnableStatisticsOutput<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+//! By default, statistics are written for all output fields
+template<class TypeTag>
+struct StatisticsOutputFields<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = ""; };
+
+//! By default, the statistics are weighted by the plain volume
+template<class TypeTag>
+struct StatisticsWeightField<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = ""; };
+
+//! By default, the statistics are computed for the whole grid
+template<class TypeTag>
+struct StatisticsRegionField<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = ""; };
+
+//! By default, no histograms are written
+template<class TypeTag>
+struct StatisticsHistogramBins<TypeTag, TTag::FvBaseDiscretization> { static constexpr unsigned value = 0; };
+
+//! Disable streaming the output into shared memory by default
+template<class TypeTag>
+struct EnableSharedMemoryOutput<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+//! By default, the shared memory segment of each process has a size of 256 MiB
+template<class TypeTag>
+struct SharedMemoryOutputCapacity<TypeTag, TTag::FvBaseDiscretization> { static constexpr unsigned value = 256; };
+
+//! By default, all output fields are written for each output step
+template<class TypeTag>
+struct OutputFieldIntervals<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = ""; };
+
+//! By default, the output considers the whole grid
+template<class TypeTag>
+struct OutputRegionOfInterest<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = ""; };
+
 //! Set the format of the VTK output to ASCII by default
 template<class TypeTag>
 struct VtkOutputFormat<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = Dune::VTK::ascii; };
 
+//! Write the Newton convergence as compressed binary VTK files by default, since a
+//! file is written for every iteration
+template<class TypeTag>
+struct VtkConvergenceOutputFormat<TypeTag, TTag::FvBaseDiscretization>
+{ static constexpr int value = vtkCompressedAppendedFormat; };
+
 // disable caching the storage term by default
 template<class TypeTag>
 struct EnableStorageCache<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
 
+// compute the storage terms at the start of each time step in its first iteration by default
+template<class TypeTag>
+struct KeepConvergedStorage<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+// copy the cached intensive quantities into the element contexts by default
+template<class TypeTag>
+struct EnableIntensiveQuantityViews<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+// precompute the geometry of the stencils by default
+template<class TypeTag>
+struct EnableStencilCache<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = true; };
+
 // disable constraints by default
 template<class TypeTag>
 struct EnableConstraints<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
@@ -276,6 +400,37 @@ struct EnableConstraints<TypeTag, TTag::FvBaseDiscretization> { static constexpr
 template<class TypeTag>
 struct EnableIntensiveQuantityCache<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
 
+// leave the placement of large arrays to the operating system by default
+template<class TypeTag>
+struct LargeArrayHugePages<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+template<class TypeTag>
+struct LargeArrayNumaInterleave<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+// always update all intensive quantities by default
+template<class TypeTag>
+struct IntensiveQuantityUpdateTolerance<TypeTag, TTag::FvBaseDiscretization>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.0;
+};
+
+// recompute the intensive quantities after a failed time integration by default
+template<class TypeTag>
+struct KeepStartOfStepIntensiveQuantities<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+// compute the intensive quantities of the overlap degrees of freedom locally by default
+template<class TypeTag>
+struct ExchangeOverlapIntensiveQuantities<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+// update the intensive quantities element by element in the order of the grid
+template<class TypeTag>
+struct IntensiveQuantityUpdateSchedule<TypeTag, TTag::FvBaseDiscretization>
+{ static constexpr auto value = "dynamic"; };
+
+// update the degrees of freedom of a tile in the order of their indices by default
+template<class TypeTag>
+struct SortIntensiveQuantityUpdateByRegion<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
 // do not use thermodynamic hints by default. If you enable this, make sure to also
 // enable the intensive quantity cache above to avoid getting an exception...
 template<class TypeTag>
@@ -387,6 +542,7 @@ class FvBaseDiscretization
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
+    using ElementSeed = typename Element::EntitySeed;
 
     using Toolbox = MathToolbox<Evaluation>;
     using VectorBlock = Dune::FieldVector<Evaluation, numEq>;
@@ -456,7 +612,12 @@ public:
         , enableGridAdaptation_(Parameters::get<TypeTag, Properties::EnableGridAdaptation>() )
         , enableIntensiveQuantityCache_(Parameters::get<TypeTag, Properties::EnableIntensiveQuantityCache>())
         , enableStorageCache_(Parameters::get<TypeTag, Properties::EnableStorageCache>())
+        , keepConvergedStorage_(Parameters::get<TypeTag, Properties::KeepConvergedStorage>())
+        , enableStencilCache_(Parameters::get<TypeTag, Properties::EnableStencilCache>())
         , enableThermodynamicHints_(Parameters::get<TypeTag, Properties::EnableThermodynamicHints>())
+        , intensiveQuantityUpdateTolerance_(Parameters::get<TypeTag, Properties::IntensiveQuantityUpdateTolerance>())
+        , keepStartOfStepIntensiveQuantities_(Parameters::get<TypeTag, Properties::KeepStartOfStepIntensiveQuantities>())
+        , exchangeOverlapIntensiveQuantities_(Parameters::get<TypeTag, Properties::ExchangeOverlapIntensiveQuantities>())
     {
         bool isEcfv = std::is_same<Discretization, EcfvDiscretization<TypeTag> >::value;
         if (enableGridAdaptation_ && !isEcfv)
@@ -464,8 +625,47 @@ public:
                                         "element-centered finite volume discretization (is: "
                                         +Dune::className<Discretization>()+")");
 
+        const std::string schedule = Parameters::get<TypeTag, Properties::IntensiveQuantityUpdateSchedule>();
+        if (schedule == "dynamic")
+            intensiveQuantityUpdateSchedule_ = IntensiveQuantityUpdateSchedule::Dynamic;
+        else if (schedule == "static")
+            intensiveQuantityUpdateSchedule_ = IntensiveQuantityUpdateSchedule::Static;
+        else if (schedule == "guided")
+            intensiveQuantityUpdateSchedule_ = IntensiveQuantityUpdateSchedule::Guided;
+        else
+            throw std::invalid_argument("Unknown schedule for the update of the intensive "
+                                        "quantities: '"+schedule+"'");
+        sortIntensiveQuantityUpdateByRegion_ =
+            Parameters::get<TypeTag, Properties::SortIntensiveQuantityUpdateByRegion>();
+
+        if (intensiveQuantityUpdateSchedule_ != IntensiveQuantityUpdateSchedule::Dynamic && !isEcfv)
+            throw std::invalid_argument("The tiled update of the intensive quantities currently "
+                                        "only works for the element-centered finite volume "
+                                        "discretization (is: "
+                                        +Dune::className<Discretization>()+")");
+
+        if (exchangeOverlapIntensiveQuantities_) {
+            if (!isEcfv || enableGridAdaptation_)
+                throw std::invalid_argument("Exchanging the intensive quantities of overlap "
+                                            "degrees of freedom only works for the "
+                                            "element-centered finite volume discretization "
+                                            "without grid adaptation");
+            if (!storeIntensiveQuantities())
+                throw std::invalid_argument("Exchanging the intensive quantities of overlap "
+                                            "degrees of freedom requires the intensive "
+                                            "quantity cache");
+            if constexpr (!std::is_trivially_copyable_v<IntensiveQuantities>)
+                throw std::invalid_argument("The intensive quantities of the model ("
+                                            +Dune::className<IntensiveQuantities>()+") "
+                                            "cannot be exchanged between processes");
+        }
+
         enableStorageCache_ = Parameters::get<TypeTag, Properties::EnableStorageCache>();
 
+        // this must happen before the caches are allocated
+        LargeAllocationPolicy::useHugePages = Parameters::get<TypeTag, Properties::LargeArrayHugePages>();
+        LargeAllocationPolicy::interleaveNumaNodes = Parameters::get<TypeTag, Properties::LargeArrayNumaInterleave>();
+
         PrimaryVariables::init();
         size_t numDof = asImp_().numGridDof();
         for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
@@ -509,17 +709,75 @@ public:
         PrimaryVariables::registerParameters();
         // register runtime parameters of the output modules
         VtkPrimaryVarsModule<TypeTag>::registerParameters();
+        OutputPlan<TypeTag>::registerParameters();
 
         Parameters::registerParam<TypeTag, Properties::EnableGridAdaptation>
             ("Enable adaptive grid refinement/coarsening");
         Parameters::registerParam<TypeTag, Properties::EnableVtkOutput>
             ("Global switch for turning on writing VTK files");
+        Parameters::registerParam<TypeTag, Properties::EnableHdf5Output>
+            ("Global switch for turning on writing HDF5 files which are described by an XDMF file");
+        Parameters::registerParam<TypeTag, Properties::Hdf5OutputSingleFile>
+            ("Write all time steps of the HDF5 output into a single file");
+        Parameters::registerParam<TypeTag, Properties::EnableStatisticsOutput>
+            ("Global switch for turning on writing statistics of the output fields to a CSV file");
+        Parameters::registerParam<TypeTag, Properties::StatisticsOutputFields>
+            ("A comma separated list of the output fields for which statistics are "
+             "written. If empty, all scalar and vectorial fields are considered");
+        Parameters::registerParam<TypeTag, Properties::StatisticsWeightField>
+            ("The name of the output field by which the volume is weighted for the "
+             "statistics, e.g., 'porosity'");
+        Parameters::registerParam<TypeTag, Properties::StatisticsRegionField>
+            ("The name of the output field which specifies the region index of the "
+             "statistics. If empty, the whole grid is a single region");
+        Parameters::registerParam<TypeTag, Properties::StatisticsHistogramBins>
+            ("The number of bins of the histograms of the output fields. Zero disables "
+             "the histograms");
+        Parameters::registerParam<TypeTag, Properties::EnableSharedMemoryOutput>
+            ("Global switch for turning on streaming the output fields into a shared "
+             "memory segment of each process");
+        Parameters::registerParam<TypeTag, Properties::SharedMemoryOutputCapacity>
+            ("The size of the shared memory segment of each process [MiB]");
         Parameters::registerParam<TypeTag, Properties::EnableThermodynamicHints>
             ("Enable thermodynamic hints");
         Parameters::registerParam<TypeTag, Properties::EnableIntensiveQuantityCache>
             ("Turn on caching of intensive quantities");
+        Parameters::registerParam<TypeTag, Properties::LargeArrayHugePages>
+            ("Ask the operating system to back large arrays like the intensive quantity "
+             "cache by transparent huge pages");
+        Parameters::registerParam<TypeTag, Properties::LargeArrayNumaInterleave>
+            ("Interleave the pages of large arrays like the intensive quantity cache "
+             "between all NUMA nodes instead of placing them on the node which touches "
+             "them first");
+        Parameters::registerParam<TypeTag, Properties::IntensiveQuantityUpdateTolerance>
+            ("The relative change of the primary variables of a degree of freedom below "
+             "which its cached intensive quantities are not updated between Newton "
+             "iterations. Zero means that all intensive quantities are always updated.");
+        Parameters::registerParam<TypeTag, Properties::KeepStartOfStepIntensiveQuantities>
+            ("Keep a copy of the intensive quantities at the start of each time step which "
+             "is restored instead of recomputing them if the time integration fails");
+        Parameters::registerParam<TypeTag, Properties::ExchangeOverlapIntensiveQuantities>
+            ("Receive the intensive quantities of the overlap degrees of freedom from "
+             "their master processes instead of computing them locally (ECFV only)");
+        Parameters::registerParam<TypeTag, Properties::IntensiveQuantityUpdateSchedule>
+            ("The OpenMP schedule used to update the intensive quantities. Possible "
+             "values are 'dynamic' (element by element in the order of the grid), "
+             "'static' and 'guided' (tiles of degrees of freedom, ECFV only)");
+        Parameters::registerParam<TypeTag, Properties::SortIntensiveQuantityUpdateByRegion>
+            ("Group the degrees of freedom of each tile by their regions when the "
+             "intensive quantities are updated in tiles");
         Parameters::registerParam<TypeTag, Properties::EnableStorageCache>
             ("Store previous storage terms and avoid re-calculating them.");
+        Parameters::registerParam<TypeTag, Properties::KeepConvergedStorage>
+            ("Keep the storage terms computed for the converged solution of a time step "
+             "as the storage terms at the start of the next one (requires "
+             "EnableStorageCache)");
+        Parameters::registerParam<TypeTag, Properties::EnableIntensiveQuantityViews>
+            ("Let the element contexts refer to the cached intensive quantities instead "
+             "of copying them.");
+        Parameters::registerParam<TypeTag, Properties::EnableStencilCache>
+            ("Compute the geometry of the stencils of all elements once for each grid "
+             "instead of each time an element context is updated.");
         Parameters::registerParam<TypeTag, Properties::OutputDir>
             ("The directory to which result files are written");
     }
@@ -529,6 +787,9 @@ public:
      */
     void finishInit()
     {
+        // the element contexts below already use the precomputed stencils
+        asImp_().updateStencilCache();
+
         // initialize the volume of the finite volumes to zero
         size_t numDof = asImp_().numGridDof();
         dofTotalVolume_.resize(numDof);
@@ -584,6 +845,7 @@ public:
             localLinearizer_[threadId].init(simulator_);
 
         resizeAndResetIntensiveQuantitiesCache_();
+        updateDofElementSeeds_();
         if (storeIntensiveQuantities()) {
             // invalidate all cached intensive quantities
             for (unsigned timeIdx = 0; timeIdx < historySize; ++ timeIdx)
@@ -602,6 +864,9 @@ public:
     /*!
      * \brief Applies the initial solution for all degrees of freedom to which the model
      *        applies.
+     *
+     * The elements are distributed to the threads, so the initial() method of the
+     * problem must be safe to be called concurrently.
      */
     void applyInitialSolution()
     {
@@ -609,31 +874,81 @@ public:
         SolutionVector& uCur = asImp_().solution(/*timeIdx=*/0);
         uCur = Scalar(0.0);
 
-        ElementContext elemCtx(simulator_);
+        // the degrees of freedom of the element-centered finite volume method belong to
+        // a single element, so only the element itself needs to be considered by the
+        // element context. otherwise, degrees of freedom are shared by several elements
+        // and each one is initialized by the last element which contains it in the
+        // order of the grid, i.e., by the same one as if the grid was traversed
+        // sequentially.
+        constexpr bool isEcfv = std::is_same_v<Discretization, EcfvDiscretization<TypeTag>>;
+        std::vector<unsigned> dofInitElement;
+        if constexpr (!isEcfv) {
+            dofInitElement.resize(asImp_().numGridDof());
+            ElementContext elemCtx(simulator_);
+            for (const auto& elem : elements(gridView_)) {
+                if (elem.partitionType() != Dune::InteriorEntity)
+                    continue;
 
-        // iterate through the grid and evaluate the initial condition
-        for (const auto& elem : elements(gridView_)) {
-            // ignore everything which is not in the interior if the
-            // current process' piece of the grid
-            if (elem.partitionType() != Dune::InteriorEntity)
-                continue;
+                elemCtx.updateStencilTopology(elem);
+                const unsigned elemIdx = elementMapper_.index(elem);
+                for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++dofIdx)
+                    dofInitElement[elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0)] = elemIdx;
+            }
+        }
 
-            // deal with the current element
-            elemCtx.updateStencil(elem);
+        // iterate through the grid and evaluate the initial condition. the problem's
+        // initial() method is thus called concurrently by all threads.
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            // Attention: the variables below are thread specific and thus cannot be
+            // moved in front of the #pragma!
+            ElementContext elemCtx(simulator_);
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                const Element& elem = *elemIt;
 
-            // loop over all element vertices, i.e. sub control volumes
-            for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); dofIdx++)
-            {
-                // map the local degree of freedom index to the global one
-                unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                // ignore everything which is not in the interior if the
+                // current process' piece of the grid
+                if (elem.partitionType() != Dune::InteriorEntity)
+                    continue;
 
-                // let the problem do the dirty work of nailing down
-                // the initial solution.
-                simulator_.problem().initial(uCur[globalIdx], elemCtx, dofIdx, /*timeIdx=*/0);
-                asImp_().supplementInitialSolution_(uCur[globalIdx], elemCtx, dofIdx, /*timeIdx=*/0);
-                uCur[globalIdx].checkDefined();
+                try {
+                    // deal with the current element
+                    if constexpr (isEcfv)
+                        elemCtx.updatePrimaryStencil(elem);
+                    else
+                        elemCtx.updateStencil(elem);
+
+                    const unsigned elemIdx = elementMapper_.index(elem);
+
+                    // loop over all element vertices, i.e. sub control volumes
+                    for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); dofIdx++)
+                    {
+                        // map the local degree of freedom index to the global one
+                        unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                        if (!isEcfv && dofInitElement[globalIdx] != elemIdx)
+                            continue;
+
+                        // let the problem do the dirty work of nailing down
+                        // the initial solution.
+                        simulator_.problem().initial(uCur[globalIdx], elemCtx, dofIdx, /*timeIdx=*/0);
+                        asImp_().supplementInitialSolution_(uCur[globalIdx], elemCtx, dofIdx, /*timeIdx=*/0);
+                        uCur[globalIdx].checkDefined();
+                    }
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> take(exceptionLock);
+                    exceptionPtr = std::current_exception();
+                }
             }
         }
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
 
         // synchronize the ghost DOFs (if necessary)
         asImp_().syncOverlap();
@@ -698,6 +1013,37 @@ public:
         return cachedIntensiveQuantities(globalIdx, timeIdx);
     }
 
+    /*!
+     * \brief Called before the intensive quantities of a contiguous range of degrees
+     *        of freedom are updated.
+     *
+     * Models may overload this method to do work for all degrees of freedom of the
+     * range at once. It is only called if the intensive quantities are updated in
+     * tiles and it may be called by multiple threads concurrently. The default
+     * implementation does nothing.
+     *
+     * \param dofBegin The index of the first degree of freedom of the range.
+     * \param dofEnd The index after the last degree of freedom of the range.
+     * \param timeIdx The index used by the time discretization.
+     */
+    void prepareIntensiveQuantities(std::size_t /*dofBegin*/,
+                                    std::size_t /*dofEnd*/,
+                                    unsigned /*timeIdx*/) const
+    {}
+
+    /*!
+     * \brief Returns the key of the region of a degree of freedom.
+     *
+     * If SortIntensiveQuantityUpdateByRegion is enabled, the degrees of freedom of
+     * each tile are updated in the order of their keys so that consecutive updates use
+     * the same tables. Models may overload this method, the default implementation puts
+     * all degrees of freedom into the same region.
+     *
+     * \param globalIdx The global index of the degree of freedom.
+     */
+    unsigned intensiveQuantityUpdateKey(unsigned /*globalIdx*/) const
+    { return 0; }
+
     /*!
      * \brief Return the cached intensive quantities for a entity on the
      *        grid at given time.
@@ -711,7 +1057,8 @@ public:
      */
     const IntensiveQuantities* cachedIntensiveQuantities(unsigned globalIdx, unsigned timeIdx) const
     {
-        if (!enableIntensiveQuantityCache_ || !intensiveQuantityCacheUpToDate_[timeIdx][globalIdx]) {
+        const unsigned slotIdx = intensiveQuantityCacheSlot_(timeIdx);
+        if (!enableIntensiveQuantityCache_ || !intensiveQuantityCacheUpToDate_[slotIdx][globalIdx]) {
             return nullptr;
         }
 
@@ -720,11 +1067,11 @@ public:
         // cached. However, this may be false for some Problem
         // variants, so we should check if the cache exists for
         // the timeIdx in question.
-        if (timeIdx > 0 && enableStorageCache_ && intensiveQuantityCache_[timeIdx].empty()) {
+        if (timeIdx > 0 && enableStorageCache_ && intensiveQuantityCache_[slotIdx].empty()) {
             return nullptr;
         }
 
-        return &intensiveQuantityCache_[timeIdx][globalIdx];
+        return &intensiveQuantityCache_[slotIdx][globalIdx];
     }
 
     /*!
@@ -742,8 +1089,86 @@ public:
         if (!storeIntensiveQuantities())
             return;
 
-        intensiveQuantityCache_[timeIdx][globalIdx] = intQuants;
-        intensiveQuantityCacheUpToDate_[timeIdx][globalIdx] = 1;
+        const unsigned slotIdx = intensiveQuantityCacheSlot_(timeIdx);
+        // the caches of the previous time steps are released if they are not needed
+        if (timeIdx > 0 && intensiveQuantityCache_[slotIdx].empty())
+            return;
+
+        intensiveQuantityCache_[slotIdx][globalIdx] = intQuants;
+        intensiveQuantityCacheUpToDate_[slotIdx][globalIdx] = 1;
+    }
+
+    /*!
+     * \brief Returns the number of bytes which are allocated by the intensive quantity
+     *        cache for a given time index.
+     *
+     * \param timeIdx The index used by the time discretization.
+     */
+    std::size_t intensiveQuantityCacheMemoryUsage(unsigned timeIdx) const
+    {
+        const unsigned slotIdx = intensiveQuantityCacheSlot_(timeIdx);
+        return intensiveQuantityCache_[slotIdx].capacity()*sizeof(IntensiveQuantities)
+            + intensiveQuantityCacheUpToDate_[slotIdx].capacity()*sizeof(unsigned char);
+    }
+
+    /*!
+     * \brief Add the number of bytes held by the model, its linearizer and its linear
+     *        solver to a memory usage report.
+     */
+    void reportMemoryUsage(MemoryUsage& usage) const
+    {
+        for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
+            const std::string suffix = " (time index " + std::to_string(timeIdx) + ")";
+            usage.add("Intensive quantity cache" + suffix,
+                      intensiveQuantityCacheMemoryUsage(timeIdx));
+            usage.add("Storage cache" + suffix,
+                      MemoryUsage::blockVectorBytes(storageCache_[timeIdx]));
+            usage.add("Solution" + suffix,
+                      MemoryUsage::blockVectorBytes(solution(timeIdx)));
+        }
+        usage.add("Start of step intensive quantities",
+                  MemoryUsage::bytesOf(startOfStepIntensiveQuantities_));
+        usage.add("Intensive quantity update hints",
+                  MemoryUsage::bytesOf(lastUpdatePriVars_)
+                  + MemoryUsage::bytesOf(dofElementSeeds_)
+                  + MemoryUsage::bytesOf(subsetElementSeeds_));
+        usage.add("Degree of freedom volumes", MemoryUsage::bytesOf(dofTotalVolume_));
+
+        usage.addFrom(*linearizer_);
+        usage.addFrom(newtonMethod_.linearSolver());
+    }
+
+    /*!
+     * \brief Register the settings of the model and its linearizer which can be
+     *        changed at run time with an auto-tuner.
+     *
+     * For the element-centered finite volume discretization, this is the schedule of
+     * the update of the intensive quantities.
+     */
+    void registerTuningKnobs(AutoTuner& tuner)
+    {
+        constexpr bool isEcfv = std::is_same_v<Discretization, EcfvDiscretization<TypeTag>>;
+        if (isEcfv && !enableGridAdaptation_) {
+            static const IntensiveQuantityUpdateSchedule schedules[] = {
+                IntensiveQuantityUpdateSchedule::Dynamic,
+                IntensiveQuantityUpdateSchedule::Static,
+                IntensiveQuantityUpdateSchedule::Guided
+            };
+            const auto apply = [this](std::size_t idx)
+            {
+                const bool wasTiled = !dofElementSeeds_.empty();
+                intensiveQuantityUpdateSchedule_ = schedules[idx];
+                if (wasTiled != (intensiveQuantityUpdateSchedule_ != IntensiveQuantityUpdateSchedule::Dynamic))
+                    updateDofElementSeeds_();
+            };
+            const std::size_t currentIdx =
+                std::find(std::begin(schedules), std::end(schedules), intensiveQuantityUpdateSchedule_)
+                - std::begin(schedules);
+            tuner.addKnob("IntensiveQuantityUpdateSchedule", {"dynamic", "static", "guided"},
+                          apply, currentIdx);
+        }
+
+        tuner.addKnobsFrom(*linearizer_);
     }
 
     /*!
@@ -760,7 +1185,36 @@ public:
         if (!storeIntensiveQuantities())
             return;
 
-        intensiveQuantityCacheUpToDate_[timeIdx][globalIdx] = newValue ? 1 : 0;
+        intensiveQuantityCacheUpToDate_[intensiveQuantityCacheSlot_(timeIdx)][globalIdx] = newValue ? 1 : 0;
+    }
+
+    /*!
+     * \brief Keep a copy of the intensive quantities of the current solution at the
+     *        start of a time step.
+     *
+     * The copy is restored by updateFailed() instead of recomputing the intensive
+     * quantities, i.e., it must be made for the solution of the previous time step
+     * after the problem has been prepared for the current one. This is done by the
+     * Newton method before its first linearization. The method does nothing unless the
+     * KeepStartOfStepIntensiveQuantities parameter is set, or if the cached quantities
+     * are not all up to date, or if a copy was already made for the current time step.
+     */
+    void storeStartOfStepIntensiveQuantities()
+    {
+        if (!keepStartOfStepIntensiveQuantities_
+            || !storeIntensiveQuantities()
+            || startOfStepIntensiveQuantitiesValid_)
+        {
+            return;
+        }
+
+        const unsigned slotIdx = intensiveQuantityCacheSlot_(/*timeIdx=*/0);
+        const auto& upToDate = intensiveQuantityCacheUpToDate_[slotIdx];
+        if (std::find(upToDate.begin(), upToDate.end(), 0) != upToDate.end())
+            return;
+
+        startOfStepIntensiveQuantities_ = intensiveQuantityCache_[slotIdx];
+        startOfStepIntensiveQuantitiesValid_ = true;
     }
 
     /*!
@@ -770,36 +1224,98 @@ public:
      */
     void invalidateIntensiveQuantitiesCache(unsigned timeIdx) const
     {
+        invalidateStorageCache_(timeIdx);
         if (storeIntensiveQuantities()) {
-            std::fill(intensiveQuantityCacheUpToDate_[timeIdx].begin(),
-                      intensiveQuantityCacheUpToDate_[timeIdx].end(),
+            const unsigned slotIdx = intensiveQuantityCacheSlot_(timeIdx);
+            std::fill(intensiveQuantityCacheUpToDate_[slotIdx].begin(),
+                      intensiveQuantityCacheUpToDate_[slotIdx].end(),
                       /*value=*/0);
         }
     }
 
     void invalidateAndUpdateIntensiveQuantities(unsigned timeIdx) const
     {
-        invalidateIntensiveQuantitiesCache(timeIdx);
+        EWOMS_PROFILE_REGION("update intensive quantities");
+        HardwareCounters::Phase counterPhase("update intensive quantities");
+
+        invalidateStorageCache_(timeIdx);
+
+        // if enabled, only update the intensive quantities of the degrees of freedom
+        // whose primary variables changed noticeably since the last update. The first
+        // Newton iteration of a time step always updates everything, because the
+        // problem's parameters may have changed when advancing in time.
+        const bool updateChangedOnly =
+            timeIdx == 0
+            && intensiveQuantityUpdateTolerance_ > 0.0
+            && enableIntensiveQuantityCache_
+            && newtonMethod_.numIterations() > 0
+            && lastUpdatePriVars_.size() == asImp_().numGridDof();
+        if (updateChangedOnly) {
+            updateChangedIntensiveQuantities_();
+            return;
+        }
 
-        // loop over all elements...
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
+        // the intensive quantities of the overlap are received from the processes
+        // which own the respective degrees of freedom
+        const bool exchangeOverlap =
+            timeIdx == 0
+            && exchangeOverlapIntensiveQuantities_
+            && gridView_.comm().size() > 1;
+
+        // otherwise, the primary variables of the overlap are needed. if they are still
+        // being received, the interior is updated while the messages are in flight
+        if (timeIdx == 0 && !exchangeOverlap && asImp_().overlapSyncPending()) {
+            updateIntensiveQuantitiesInteriorFirst_();
+            return;
+        }
+
+        invalidateIntensiveQuantitiesCache(timeIdx);
+        if (exchangeOverlap)
+            markOverlapIntensiveQuantitiesValid_();
+
+        if (!dofElementSeeds_.empty())
+            updateIntensiveQuantitiesTiled_(timeIdx, /*onlyInvalid=*/exchangeOverlap);
+        else {
+            // loop over all elements...
+            static auto& loadStats = ThreadLoadStatistics::get("update intensive quantities");
+            loadStats.beginLoop();
+            ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
-        {
-            ElementContext elemCtx(simulator_);
-            ElementIterator elemIt = threadedElemIt.beginParallel();
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const Element& elem = *elemIt;
-                elemCtx.updatePrimaryStencil(elem);
-                elemCtx.updatePrimaryIntensiveQuantities(timeIdx);
+            {
+                auto threadScope = loadStats.threadScope();
+                ElementContext elemCtx(simulator_);
+                ElementIterator elemIt = threadedElemIt.beginParallel();
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    const Element& elem = *elemIt;
+                    if (exchangeOverlap && elem.partitionType() != Dune::InteriorEntity)
+                        continue;
+
+                    elemCtx.updatePrimaryStencil(elem);
+                    elemCtx.updatePrimaryIntensiveQuantities(timeIdx);
+                    threadScope.addWorkItem();
+                }
             }
+            loadStats.endLoop();
+        }
+
+        if (exchangeOverlap)
+            asImp_().syncOverlapIntensiveQuantities(timeIdx);
+
+        if (timeIdx == 0 && intensiveQuantityUpdateTolerance_ > 0.0) {
+            const auto& sol = solution(/*timeIdx=*/0);
+            lastUpdatePriVars_.resize(asImp_().numGridDof());
+            for (unsigned dofIdx = 0; dofIdx < lastUpdatePriVars_.size(); ++dofIdx)
+                lastUpdatePriVars_[dofIdx] = sol[dofIdx];
         }
     }
 
     template <class GridViewType>
     void invalidateAndUpdateIntensiveQuantities(unsigned timeIdx, const GridViewType& gridView) const
     {
+        invalidateStorageCache_(timeIdx);
+
         // loop over all elements...
         ThreadedEntityIterator<GridViewType, /*codim=*/0> threadedElemIt(gridView);
 #ifdef _OPENMP
@@ -827,6 +1343,57 @@ public:
         }
     }
 
+    /*!
+     * \brief Invalidate and update the intensive quantities of a subset of the
+     *        degrees of freedom.
+     *
+     * This is used by solvers which only modify the solution of parts of the grid,
+     * e.g., by the local solves of the domain decomposition. Like the variant for a
+     * grid view, the cache entries are updated regardless of the tolerance for
+     * unchanged primary variables. Only element-centered discretizations are
+     * supported since the degrees of freedom are mapped to their elements.
+     *
+     * \param dofIndices The global indices of the degrees of freedom to be updated
+     * \param timeIdx The index of the time for which the quantities are updated
+     */
+    template <class DofRange>
+    void updateIntensiveQuantitiesOfDofs(const DofRange& dofIndices, unsigned timeIdx) const
+    {
+        if (asImp_().numGridDof() != elementMapper_.size())
+            throw std::logic_error("Updating the intensive quantities of a subset of the "
+                                   "degrees of freedom requires an element-centered "
+                                   "discretization");
+
+        invalidateStorageCache_(timeIdx);
+
+        if (subsetElementSeeds_.empty()) {
+            subsetElementSeeds_.resize(elementMapper_.size());
+            for (const auto& elem : elements(gridView_))
+                subsetElementSeeds_[elementMapper_.index(elem)] = elem.seed();
+        }
+
+        const auto& grid = gridView_.grid();
+        const std::ptrdiff_t numDof = std::distance(std::begin(dofIndices), std::end(dofIndices));
+        const auto dofBegin = std::begin(dofIndices);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            ElementContext elemCtx(simulator_);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+            for (std::ptrdiff_t i = 0; i < numDof; ++i) {
+                const auto dofIdx = static_cast<unsigned>(*(dofBegin + i));
+                setIntensiveQuantitiesCacheEntryValidity(dofIdx, timeIdx, false);
+
+                const auto elem = grid.entity(subsetElementSeeds_[dofIdx]);
+                elemCtx.updatePrimaryStencil(elem);
+                elemCtx.updatePrimaryIntensiveQuantities(timeIdx);
+            }
+        }
+    }
+
     /*!
      * \brief Move the intensive quantities for a given time index to the back.
      *
@@ -847,14 +1414,45 @@ public:
             // However, if the storage term at the start of the timestep cannot be deduced
             // from the primary variables, we must calculate it from the old intensive
             // quantities, and need to shift them.
+            //
+            // Since the cached intensive quantities of the previous time steps are thus
+            // never accessed, we release their memory.
+            for (unsigned timeIdx = 1; timeIdx < historySize; ++timeIdx) {
+                const unsigned slotIdx = intensiveQuantityCacheSlot_(timeIdx);
+                IntensiveQuantitiesVector().swap(intensiveQuantityCache_[slotIdx]);
+                std::fill(intensiveQuantityCacheUpToDate_[slotIdx].begin(),
+                          intensiveQuantityCacheUpToDate_[slotIdx].end(),
+                          /*value=*/0);
+            }
             return;
         }
 
         assert(numSlots > 0);
+        if (numSlots >= historySize)
+            return;
 
-        for (unsigned timeIdx = 0; timeIdx < historySize - numSlots; ++ timeIdx) {
-            intensiveQuantityCache_[timeIdx + numSlots] = intensiveQuantityCache_[timeIdx];
-            intensiveQuantityCacheUpToDate_[timeIdx + numSlots] = intensiveQuantityCacheUpToDate_[timeIdx];
+        if (2*numSlots > historySize) {
+            // the buffers of the discarded time indices do not suffice to keep the
+            // most recent ones, so we need to copy the whole history
+            for (unsigned timeIdx = historySize - numSlots; timeIdx-- > 0;) {
+                const unsigned srcSlotIdx = intensiveQuantityCacheSlot_(timeIdx);
+                const unsigned dstSlotIdx = intensiveQuantityCacheSlot_(timeIdx + numSlots);
+                intensiveQuantityCache_[dstSlotIdx] = intensiveQuantityCache_[srcSlotIdx];
+                intensiveQuantityCacheUpToDate_[dstSlotIdx] = intensiveQuantityCacheUpToDate_[srcSlotIdx];
+            }
+            return;
+        }
+
+        // Instead of moving all objects, rotate the mapping from time indices to the
+        // buffers. Only the most recent time indices need to be copied because they
+        // keep their contents.
+        const unsigned oldOffset = intensiveQuantityCacheOffset_;
+        intensiveQuantityCacheOffset_ = (oldOffset + historySize - numSlots) % historySize;
+        for (unsigned timeIdx = 0; timeIdx < numSlots; ++ timeIdx) {
+            const unsigned srcSlotIdx = (timeIdx + oldOffset) % historySize;
+            const unsigned dstSlotIdx = intensiveQuantityCacheSlot_(timeIdx);
+            intensiveQuantityCache_[dstSlotIdx] = intensiveQuantityCache_[srcSlotIdx];
+            intensiveQuantityCacheUpToDate_[dstSlotIdx] = intensiveQuantityCacheUpToDate_[srcSlotIdx];
         }
 
         // the cache for the most recent time indices do not need to be invalidated
@@ -880,6 +1478,30 @@ public:
     void setEnableStorageCache(bool enableStorageCache)
     { enableStorageCache_= enableStorageCache; }
 
+    /*!
+     * \brief Returns true if the geometry of the stencils is precomputed for each grid.
+     */
+    bool enableStencilCache() const
+    { return enableStencilCache_; }
+
+    /*!
+     * \brief Precompute the geometry of the stencils of all elements.
+     *
+     * This is called by finishInit(), i.e., for each grid. Discretizations whose
+     * stencils support caching their geometry overload this method.
+     */
+    void updateStencilCache()
+    { }
+
+    /*!
+     * \brief Prepare the stencil of a newly created element context.
+     *
+     * Discretizations which precompute the geometry of their stencils attach the
+     * stencil to the precomputed data here.
+     */
+    void prepareStencil(Stencil&) const
+    { }
+
     /*!
      * \brief Retrieve an entry of the cache for the storage term.
      *
@@ -913,6 +1535,26 @@ public:
         storageCache_[timeIdx][globalIdx] = value;
     }
 
+    /*!
+     * \brief Tell the model that the cached storage terms for time index 0 have been
+     *        computed for all degrees of freedom using the current intensive quantities.
+     *
+     * This is called by the linearizer after each linearization of the whole grid. The
+     * mark is removed as soon as the intensive quantities for time index 0 change.
+     */
+    void markStorageCacheCurrent() const
+    { storageCacheCurrent_ = enableStorageCache_; }
+
+    /*!
+     * \brief Returns true if the cached storage terms for time index 1 have been taken
+     *        over from the converged solution of the previous time step.
+     *
+     * In this case, the linearizer does not need to compute them in the first Newton
+     * iteration of the time step. This requires the KeepConvergedStorage parameter.
+     */
+    bool startOfStepStorageValid() const
+    { return startOfStepStorageValid_; }
+
     /*!
      * \brief Compute the global residual for an arbitrary solution
      *        vector.
@@ -1192,20 +1834,67 @@ public:
      * \param timeIdx The index of the solution used by the time discretization.
      */
     const SolutionVector& solution(unsigned timeIdx) const
-    { return solution_[timeIdx]->blockVector(); }
+    {
+        if (timeIdx == 0)
+            materializeSolution_();
+        return solution_[timeIdx]->blockVector();
+    }
 
     /*!
      * \copydoc solution(int) const
      */
     SolutionVector& solution(unsigned timeIdx)
-    { return solution_[timeIdx]->blockVector(); }
+    {
+        // the previous solution may be modified as well, so the current one must be
+        // made distinct from it in any case
+        materializeSolution_();
+        return solution_[timeIdx]->blockVector();
+    }
 
   protected:
     /*!
      * \copydoc solution(int) const
      */
     SolutionVector& mutableSolution(unsigned timeIdx) const
-    { return solution_[timeIdx]->blockVector(); }
+    {
+        materializeSolution_();
+        return solution_[timeIdx]->blockVector();
+    }
+
+    /*!
+     * \brief Make the solution of the previous time step the one of the next time step.
+     *
+     * The current solution becomes the solution of the previous time step, and the
+     * current solution is marked to be equal to it. Discretizations whose solution
+     * vectors are not referenced elsewhere overload this method to exchange the vectors
+     * instead of copying them, see FvBaseDiscretizationNoAdapt.
+     */
+    void rotateSolutionHistory_()
+    { solution(/*timeIdx=*/1) = solution(/*timeIdx=*/0); }
+
+    // copy the solution of the previous time step to the current one if the latter is
+    // only marked to be equal to it. this is done when the current solution is
+    // accessed for the first time, possibly by several threads at once.
+    void materializeSolution_() const
+    {
+        if (!solutionIsStale_.load(std::memory_order_acquire))
+            return;
+
+        std::lock_guard<std::mutex> lock(staleSolutionMutex_);
+        if (!solutionIsStale_.load(std::memory_order_relaxed))
+            return;
+
+        auto& dest = solution_[/*timeIdx=*/0]->blockVector();
+        const auto& src = solution_[/*timeIdx=*/1]->blockVector();
+        const std::ptrdiff_t numDof = src.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::ptrdiff_t dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            dest[dofIdx] = src[dofIdx];
+
+        solutionIsStale_.store(false, std::memory_order_release);
+    }
 
   public:
     /*!
@@ -1387,6 +2076,44 @@ public:
     void syncOverlap()
     { }
 
+    /*!
+     * \brief Start to synchronize the values of the primary variables on the degrees
+     *        of freedom that overlap with the neighboring processes.
+     *
+     * The primary variables of the overlap must not be accessed before
+     * finishSyncOverlap() has been called, but the interior degrees of freedom can be
+     * processed in the meantime. By default, the synchronization is completed
+     * immediately.
+     */
+    void beginSyncOverlap()
+    { asImp_().syncOverlap(); }
+
+    /*!
+     * \brief Complete the synchronization of the overlap started by
+     *        beginSyncOverlap().
+     *
+     * If no synchronization is in flight, this method does nothing.
+     */
+    void finishSyncOverlap() const
+    { }
+
+    /*!
+     * \brief Returns whether the primary variables of the overlap are still being
+     *        received from their master processes.
+     */
+    bool overlapSyncPending() const
+    { return false; }
+
+    /*!
+     * \brief Receive the cached intensive quantities of the degrees of freedom that
+     *        overlap with the neighboring processes from their master processes.
+     *
+     * This is only called if the ExchangeOverlapIntensiveQuantities parameter is set.
+     * By default, this method does nothing...
+     */
+    void syncOverlapIntensiveQuantities(unsigned) const
+    { }
+
     /*!
      * \brief Called by the update() method before it tries to
      *        apply the newton method. This is primary a hook
@@ -1420,9 +2147,23 @@ public:
     {
         // Reset the current solution to the one of the
         // previous time step so that we can start the next
-        // update at a physically meaningful solution.
-        solution(/*timeIdx=*/0) = solution(/*timeIdx=*/1);
-        invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+        // update at a physically meaningful solution. It is
+        // only copied when it is accessed again.
+        solutionIsStale_.store(true, std::memory_order_release);
+        storageCacheCurrent_ = false;
+        if (startOfStepIntensiveQuantitiesValid_) {
+            const unsigned slotIdx = intensiveQuantityCacheSlot_(/*timeIdx=*/0);
+            intensiveQuantityCache_[slotIdx] = startOfStepIntensiveQuantities_;
+            std::fill(intensiveQuantityCacheUpToDate_[slotIdx].begin(),
+                      intensiveQuantityCacheUpToDate_[slotIdx].end(),
+                      /*value=*/1);
+
+            const auto& sol = solution(/*timeIdx=*/0);
+            for (unsigned dofIdx = 0; dofIdx < lastUpdatePriVars_.size(); ++dofIdx)
+                lastUpdatePriVars_[dofIdx] = sol[dofIdx];
+        }
+        else
+            invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
 
 #ifndef NDEBUG
         for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
@@ -1449,8 +2190,20 @@ public:
             asImp_().adaptGrid();
         }
 
-        // make the current solution the previous one.
-        solution(/*timeIdx=*/1) = solution(/*timeIdx=*/0);
+        // make the current solution the previous one. the current solution then
+        // equals the previous one, which is only copied once the current solution is
+        // accessed again.
+        asImp_().rotateSolutionHistory_();
+        startOfStepIntensiveQuantitiesValid_ = false;
+
+        // the storage terms of the converged solution become the ones at the start of
+        // the next time step if they have been computed by its last linearization
+        startOfStepStorageValid_ = keepConvergedStorage_ && storageCacheCurrent_;
+        if (startOfStepStorageValid_) {
+            for (unsigned timeIdx = historySize - 1; timeIdx > 0; --timeIdx)
+                storageCache_[timeIdx].swap(storageCache_[timeIdx - 1]);
+        }
+        storageCacheCurrent_ = false;
 
         // shift the intensive quantities cache by one position in the
         // history
@@ -1493,8 +2246,8 @@ public:
      *                  be serialized to
      * \param dof The Dune entity which's data should be serialized
      */
-    template <class DofEntity>
-    void serializeEntity(std::ostream& outstream,
+    template <class OutStream, class DofEntity>
+    void serializeEntity(OutStream& outstream,
                          const DofEntity& dof)
     {
         unsigned dofIdx = static_cast<unsigned>(asImp_().dofMapper().index(dof));
@@ -1518,8 +2271,8 @@ public:
      *                  be deserialized from
      * \param dof The Dune entity which's data should be deserialized
      */
-    template <class DofEntity>
-    void deserializeEntity(std::istream& instream,
+    template <class InStream, class DofEntity>
+    void deserializeEntity(InStream& instream,
                            const DofEntity& dof)
     {
         unsigned dofIdx = static_cast<unsigned>(asImp_().dofMapper().index(dof));
@@ -1532,6 +2285,69 @@ public:
         }
     }
 
+    /*!
+     * \brief Returns true if the state of all degrees of freedom can be written to
+     *        binary restart files as a whole using serializeEntityBlocks().
+     *
+     * Models which store more than the primary variables in serializeEntity() must
+     * also override serializeEntityBlocks() and deserializeEntityBlocks(), or return
+     * false here.
+     */
+    bool entityBlocksSupported() const
+    { return true; }
+
+    /*!
+     * \brief Write the current solution of all degrees of freedom of the grid to a
+     *        binary restart file.
+     *
+     * \param outstream The binary stream into which the data should be serialized
+     */
+    template <class OutStream>
+    void serializeEntityBlocks(OutStream& outstream)
+    {
+        const std::size_t numDof = asImp_().numGridDof();
+        const auto& sol = solution(/*timeIdx=*/0);
+
+        std::vector<Scalar> values(numDof*numEq);
+        for (std::size_t dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                values[dofIdx*numEq + eqIdx] = sol[dofIdx][eqIdx];
+
+        outstream << static_cast<std::uint64_t>(numDof);
+        outstream.writeBlock(values.data(), values.size());
+        if (!outstream.good())
+            throw std::runtime_error("Could not serialize the degrees of freedom");
+    }
+
+    /*!
+     * \brief Reads the current solution of all degrees of freedom of the grid from a
+     *        binary restart file.
+     *
+     * \param instream The binary stream from which the data should be deserialized
+     */
+    template <class InStream>
+    void deserializeEntityBlocks(InStream& instream)
+    {
+        const std::size_t numDof = asImp_().numGridDof();
+
+        std::uint64_t storedNumDof = 0;
+        instream >> storedNumDof;
+        if (!instream.good() || storedNumDof != numDof)
+            throw std::runtime_error("The number of degrees of freedom in the restart file ("
+                                     +std::to_string(storedNumDof)+") does not match the "
+                                     "one of the grid ("+std::to_string(numDof)+")");
+
+        std::vector<Scalar> values(numDof*numEq);
+        instream.readBlock(values.data(), values.size());
+        if (!instream.good())
+            throw std::runtime_error("Could not deserialize the degrees of freedom");
+
+        auto& sol = solution(/*timeIdx=*/0);
+        for (std::size_t dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                sol[dofIdx][eqIdx] = values[dofIdx*numEq + eqIdx];
+    }
+
     /*!
      * \brief Returns the number of degrees of freedom (DOFs) for the computational grid
      */
@@ -1668,9 +2484,28 @@ public:
             def[pvIdx] = writer.allocateManagedScalarBuffer(numGridDof);
         }
 
+        // if the output is restricted to a region of interest, the fields of the
+        // degrees of freedom outside of it are left at zero
+        std::vector<bool> dofIsWritten;
+        if (outputPlan_.hasRegion()) {
+            dofIsWritten.resize(numGridDof, false);
+            ElementContext elemCtx(simulator_);
+            for (const auto& elem : elements(gridView_)) {
+                if (!outputPlan_.contains(elem))
+                    continue;
+
+                elemCtx.updatePrimaryStencil(elem);
+                for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++dofIdx)
+                    dofIsWritten[elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0)] = true;
+            }
+        }
+
         Scalar minRelErr = 1e30;
         Scalar maxRelErr = -1e30;
         for (unsigned globalIdx = 0; globalIdx < numGridDof; ++ globalIdx) {
+            if (!dofIsWritten.empty() && !dofIsWritten[globalIdx])
+                continue;
+
             for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
                 (*priVars[pvIdx])[globalIdx] = u[globalIdx][pvIdx];
                 (*priVarWeight[pvIdx])[globalIdx] = asImp_().primaryVarWeight(globalIdx, pvIdx);
@@ -1732,13 +2567,27 @@ public:
      */
     void prepareOutputFields() const
     {
+        // the modules which are considered by the output plan for the current step
+        dueOutputModules_.clear();
+        for (auto* mod : outputModules_)
+            if (outputPlan_.moduleIsDue(mod))
+                dueOutputModules_.push_back(mod);
+
+        // the modules which accumulate quantities must not process elements
+        // concurrently
+        std::vector<BaseOutputModule<TypeTag>*> concurrentModules;
+        std::vector<BaseOutputModule<TypeTag>*> serialModules;
         bool needFullContextUpdate = false;
-        auto modIt = outputModules_.begin();
-        const auto& modEndIt = outputModules_.end();
-        for (; modIt != modEndIt; ++modIt) {
-            (*modIt)->allocBuffers();
-            needFullContextUpdate = needFullContextUpdate || (*modIt)->needExtensiveQuantities();
+        for (auto* mod : dueOutputModules_) {
+            mod->allocBuffers();
+            needFullContextUpdate = needFullContextUpdate || mod->needExtensiveQuantities();
+            if (mod->processElementIsThreadSafe())
+                concurrentModules.push_back(mod);
+            else
+                serialModules.push_back(mod);
         }
+        if (dueOutputModules_.empty())
+            return;
 
         // iterate over grid
         ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView());
@@ -1753,6 +2602,8 @@ public:
                 if (elem.partitionType() != Dune::InteriorEntity)
                     // ignore non-interior entities
                     continue;
+                if (!outputPlan_.contains(elem))
+                    continue;
 
                 if (needFullContextUpdate)
                     elemCtx.updateAll(elem);
@@ -1761,12 +2612,16 @@ public:
                     elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
                 }
 
-                // we cannot reuse the "modIt" variable here because the code here might
-                // be threaded and "modIt" is is the same for all threads, i.e., if a
-                // given thread modifies it, the changes affect all threads.
-                auto modIt2 = outputModules_.begin();
-                for (; modIt2 != modEndIt; ++modIt2)
-                    (*modIt2)->processElement(elemCtx);
+                for (auto* mod : concurrentModules)
+                    mod->processElement(elemCtx);
+
+                if (!serialModules.empty()) {
+#ifdef _OPENMP
+#pragma omp critical (FvBaseDiscretization_prepareOutputFields)
+#endif
+                    for (auto* mod : serialModules)
+                        mod->processElement(elemCtx);
+                }
             }
         }
     }
@@ -1777,12 +2632,20 @@ public:
      */
     void appendOutputFields(BaseOutputWriter& writer) const
     {
-        auto modIt = outputModules_.begin();
-        const auto& modEndIt = outputModules_.end();
-        for (; modIt != modEndIt; ++modIt)
-            (*modIt)->commitBuffers(writer);
+        auto modIt = dueOutputModules_.begin();
+        const auto& modEndIt = dueOutputModules_.end();
+        for (; modIt != modEndIt; ++modIt) {
+            typename OutputPlan<TypeTag>::Writer planWriter(outputPlan_, *modIt, writer);
+            (*modIt)->commitBuffers(planWriter);
+        }
     }
 
+    /*!
+     * \brief Returns the plan which decides which output fields are written.
+     */
+    OutputPlan<TypeTag>& outputPlan() const
+    { return outputPlan_; }
+
     /*!
      * \brief Reference to the grid view of the spatial domain.
      */
@@ -1805,6 +2668,10 @@ public:
         auxMod->setDofOffset(numTotalDof());
         auxEqModules_.push_back(auxMod);
 
+        // the auxiliary equations change the sparsity pattern of the linear system
+        linearizer_->eraseMatrix();
+        newtonMethod_.eraseMatrix();
+
         // resize the solutions
         if (enableGridAdaptation_
             && !std::is_same<DiscreteFunction, BlockVectorWrapper>::value)
@@ -1873,11 +2740,14 @@ public:
     {
         using BaseDiscretization = GetPropType<TypeTag, Properties::BaseDiscretizationType>;
         using Helper = typename BaseDiscretization::template SerializeHelper<Serializer>;
+        materializeSolution_();
         Helper::serializeOp(serializer, solution_);
     }
 
     bool operator==(const FvBaseDiscretization& rhs) const
     {
+        materializeSolution_();
+        rhs.materializeSolution_();
         return std::equal(this->solution_.begin(), this->solution_.end(),
                           rhs.solution_.begin(), rhs.solution_.end(),
                           [](const auto& x, const auto& y)
@@ -1887,8 +2757,254 @@ public:
     }
 
 protected:
+    // Update the intensive quantities of the most recent solution, but only for the
+    // degrees of freedom for which at least one primary variable changed by more than
+    // the update tolerance relative to its magnitude (or to one, if its magnitude is
+    // smaller than that) since the last update. The intensive quantities of a degree of
+    // freedom only depend on its own primary variables, so its neighbors do not need to
+    // be updated.
+    void updateChangedIntensiveQuantities_() const
+    {
+        const bool exchangeOverlap =
+            exchangeOverlapIntensiveQuantities_ && gridView_.comm().size() > 1;
+
+        // the primary variables of the overlap are only compared if their intensive
+        // quantities are not received from their master processes
+        if (!exchangeOverlap)
+            asImp_().finishSyncOverlap();
+
+        const auto& sol = solution(/*timeIdx=*/0);
+        const unsigned numDof = asImp_().numGridDof();
+        const Scalar tol = intensiveQuantityUpdateTolerance_;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+            const auto& priVars = sol[dofIdx];
+            auto& lastPriVars = lastUpdatePriVars_[dofIdx];
+            bool changed = false;
+            for (unsigned pvIdx = 0; pvIdx < numEq && !changed; ++pvIdx) {
+                using std::abs;
+                using std::max;
+                const Scalar scale = max<Scalar>(abs(lastPriVars[pvIdx]), 1.0);
+                changed = abs(priVars[pvIdx] - lastPriVars[pvIdx]) > tol*scale;
+            }
+
+            if (changed) {
+                setIntensiveQuantitiesCacheEntryValidity(dofIdx, /*timeIdx=*/0, false);
+                lastPriVars = priVars;
+            }
+        }
+
+        if (exchangeOverlap)
+            markOverlapIntensiveQuantitiesValid_();
+
+        if (!dofElementSeeds_.empty())
+            updateIntensiveQuantitiesTiled_(/*timeIdx=*/0, /*onlyInvalid=*/true);
+        else
+            updateInvalidIntensiveQuantities_();
+
+        if (exchangeOverlap)
+            asImp_().syncOverlapIntensiveQuantities(/*timeIdx=*/0);
+    }
+
+    // update the intensive quantities of all elements which have a primary degree of
+    // freedom whose cached intensive quantities are not up to date
+    void updateInvalidIntensiveQuantities_() const
+    {
+
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            ElementContext elemCtx(simulator_);
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                const Element& elem = *elemIt;
+                elemCtx.updatePrimaryStencil(elem);
+
+                // skip the element if all of its primary degrees of freedom are
+                // still up to date
+                bool needsUpdate = false;
+                const std::size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+                for (unsigned dofIdx = 0; dofIdx < numPrimaryDof && !needsUpdate; ++dofIdx) {
+                    const unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                    needsUpdate = !cachedIntensiveQuantities(globalIdx, /*timeIdx=*/0);
+                }
+
+                if (needsUpdate)
+                    elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+            }
+        }
+    }
+
+    // update the intensive quantities of the interior elements while the primary
+    // variables of the overlap are still received from their master processes, and
+    // the ones of the overlap and ghost elements once the exchange is completed. This
+    // is only used by the element-centered discretization, whose degrees of freedom
+    // are the elements of the interior-first order of the vanguard.
+    void updateIntensiveQuantitiesInteriorFirst_() const
+    {
+        using ElementRange = Dune::IteratorRange<std::vector<unsigned>::const_iterator>;
+
+        const auto& vanguard = simulator_.vanguard();
+        const auto& order = vanguard.interiorFirstElementOrder();
+        const auto interiorEnd = order.begin() + vanguard.numInteriorElements();
+
+        invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
+        updateIntensiveQuantitiesOfDofs(ElementRange(order.begin(), interiorEnd), /*timeIdx=*/0);
+        asImp_().finishSyncOverlap();
+        updateIntensiveQuantitiesOfDofs(ElementRange(interiorEnd, order.end()), /*timeIdx=*/0);
+
+        if (intensiveQuantityUpdateTolerance_ > 0.0) {
+            const auto& sol = solution(/*timeIdx=*/0);
+            lastUpdatePriVars_.resize(asImp_().numGridDof());
+            for (unsigned dofIdx = 0; dofIdx < lastUpdatePriVars_.size(); ++dofIdx)
+                lastUpdatePriVars_[dofIdx] = sol[dofIdx];
+        }
+    }
+
+    // the overlap degrees of freedom are skipped by the update of the invalid
+    // intensive quantities if their cached values are received from their master
+    // processes afterwards
+    void markOverlapIntensiveQuantitiesValid_() const
+    {
+        const unsigned numDof = asImp_().numGridDof();
+        for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            if (!isLocalDof_[dofIdx])
+                setIntensiveQuantitiesCacheEntryValidity(dofIdx, /*timeIdx=*/0, true);
+    }
+
+    // for the tiled update of the intensive quantities: collect the seed of the element
+    // of each degree of freedom, i.e., of each element for ECFV. the degrees of freedom
+    // are then processed in the order of their indices instead of the order of the
+    // grid, which is the order in which the solution and the cache are stored.
+    void updateDofElementSeeds_()
+    {
+        dofElementSeeds_.clear();
+        dofUpdateOrder_.clear();
+        if (intensiveQuantityUpdateSchedule_ == IntensiveQuantityUpdateSchedule::Dynamic)
+            return;
+
+        dofElementSeeds_.resize(elementMapper_.size());
+        for (const auto& elem : elements(gridView_))
+            dofElementSeeds_[elementMapper_.index(elem)] = elem.seed();
+    }
+
+    // update the intensive quantities of all degrees of freedom by splitting their
+    // index range into tiles which are small enough for the primary variables and the
+    // intensive quantities of a tile to stay in the cache. The tiles are distributed to
+    // the threads using the configured OpenMP schedule. Since the discretization is
+    // element-centered, each element only has a single primary degree of freedom and
+    // the element context only needs to be set up for this one.
+    void updateIntensiveQuantitiesTiled_(unsigned timeIdx, bool onlyInvalid) const
+    {
+        const auto& grid = gridView_.grid();
+        const std::size_t numDof = dofElementSeeds_.size();
+        const std::size_t numTiles = (numDof + intensiveQuantityTileSize - 1)/intensiveQuantityTileSize;
+
+        if (sortIntensiveQuantityUpdateByRegion_ && dofUpdateOrder_.empty())
+            updateDofUpdateOrder_();
+
+        const auto updateTile = [&](ElementContext& elemCtx, std::size_t tileIdx)
+        {
+            const std::size_t dofBegin = tileIdx*intensiveQuantityTileSize;
+            const std::size_t dofEnd = std::min(dofBegin + intensiveQuantityTileSize, numDof);
+            asImp_().prepareIntensiveQuantities(dofBegin, dofEnd, timeIdx);
+            for (std::size_t i = dofBegin; i < dofEnd; ++i) {
+                const std::size_t dofIdx = dofUpdateOrder_.empty() ? i : dofUpdateOrder_[i];
+                if (onlyInvalid && cachedIntensiveQuantities(static_cast<unsigned>(dofIdx), timeIdx))
+                    continue;
+
+                const auto elem = grid.entity(dofElementSeeds_[dofIdx]);
+                elemCtx.updatePrimaryStencil(elem);
+                elemCtx.updatePrimaryIntensiveQuantities(timeIdx);
+            }
+        };
+
+        if (intensiveQuantityUpdateSchedule_ == IntensiveQuantityUpdateSchedule::Guided) {
+            static auto& loadStats = ThreadLoadStatistics::get("update intensive quantities (guided)");
+            loadStats.beginLoop();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            {
+                auto threadScope = loadStats.threadScope();
+                ElementContext elemCtx(simulator_);
+#ifdef _OPENMP
+#pragma omp for schedule(guided) nowait
+#endif
+                for (std::size_t tileIdx = 0; tileIdx < numTiles; ++tileIdx) {
+                    updateTile(elemCtx, tileIdx);
+                    threadScope.addWorkItem();
+                }
+            }
+            loadStats.endLoop();
+        }
+        else {
+            static auto& loadStats = ThreadLoadStatistics::get("update intensive quantities (static)");
+            loadStats.beginLoop();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            {
+                auto threadScope = loadStats.threadScope();
+                ElementContext elemCtx(simulator_);
+#ifdef _OPENMP
+#pragma omp for schedule(static) nowait
+#endif
+                for (std::size_t tileIdx = 0; tileIdx < numTiles; ++tileIdx) {
+                    updateTile(elemCtx, tileIdx);
+                    threadScope.addWorkItem();
+                }
+            }
+            loadStats.endLoop();
+        }
+    }
+
+    // sort the degrees of freedom of each tile by their region keys. the permutation
+    // stays within the tiles, so prepareIntensiveQuantities() still gets contiguous
+    // ranges. it is set up on first use because the keys may depend on the initial
+    // solution, e.g., the PVT regions of the black-oil model.
+    void updateDofUpdateOrder_() const
+    {
+        const std::size_t numDof = dofElementSeeds_.size();
+        std::vector<unsigned> keys(numDof);
+        for (std::size_t dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            keys[dofIdx] = asImp_().intensiveQuantityUpdateKey(static_cast<unsigned>(dofIdx));
+
+        dofUpdateOrder_.resize(numDof);
+        std::iota(dofUpdateOrder_.begin(), dofUpdateOrder_.end(), 0u);
+        for (std::size_t dofBegin = 0; dofBegin < numDof; dofBegin += intensiveQuantityTileSize) {
+            const std::size_t dofEnd = std::min(dofBegin + intensiveQuantityTileSize, numDof);
+            std::stable_sort(dofUpdateOrder_.begin() + dofBegin,
+                             dofUpdateOrder_.begin() + dofEnd,
+                             [&keys](unsigned a, unsigned b)
+                             { return keys[a] < keys[b]; });
+        }
+    }
+
+    // the cached storage terms are computed from the intensive quantities, i.e., they
+    // become stale if the intensive quantities for the same time index change
+    void invalidateStorageCache_(unsigned timeIdx) const
+    {
+        if (timeIdx == 0)
+            storageCacheCurrent_ = false;
+        else
+            startOfStepStorageValid_ = false;
+    }
+
+    // returns the index of the buffer of the intensive quantity cache which is used for
+    // a given time index
+    unsigned intensiveQuantityCacheSlot_(unsigned timeIdx) const
+    { return (timeIdx + intensiveQuantityCacheOffset_) % historySize; }
+
     void resizeAndResetIntensiveQuantitiesCache_()
     {
+        storageCacheCurrent_ = false;
+        startOfStepStorageValid_ = false;
+
         // allocate the storage cache
         if (enableStorageCache()) {
             size_t numDof = asImp_().numGridDof();
@@ -1977,10 +3093,19 @@ protected:
     mutable IntensiveQuantitiesVector intensiveQuantityCache_[historySize];
     // while these are logically bools, concurrent writes to vector<bool> are not thread safe.
     mutable std::vector<unsigned char> intensiveQuantityCacheUpToDate_[historySize];
+    // the buffer used for time index 0 of the caches above. the buffers are used in
+    // a round robin fashion to avoid copying them when the history is shifted.
+    unsigned intensiveQuantityCacheOffset_ = 0;
 
     mutable std::array< std::unique_ptr< DiscreteFunction >, historySize > solution_;
+    // true if the current solution is equal to the one of the previous time step but
+    // has not yet been copied, see materializeSolution_()
+    mutable std::atomic<bool> solutionIsStale_{false};
+    mutable std::mutex staleSolutionMutex_;
 
     std::list<BaseOutputModule<TypeTag>*> outputModules_;
+    mutable std::vector<BaseOutputModule<TypeTag>*> dueOutputModules_;
+    mutable OutputPlan<TypeTag> outputPlan_;
 
     Scalar gridTotalVolume_;
     std::vector<Scalar> dofTotalVolume_;
@@ -1991,7 +3116,40 @@ protected:
     bool enableGridAdaptation_;
     bool enableIntensiveQuantityCache_;
     bool enableStorageCache_;
+    // the storage terms of the last linearization of the full grid are kept for the
+    // next time step if they are still up to date when the time level is advanced
+    bool keepConvergedStorage_;
+    mutable bool storageCacheCurrent_ = false;
+    mutable bool startOfStepStorageValid_ = false;
+    bool enableStencilCache_;
     bool enableThermodynamicHints_;
+    Scalar intensiveQuantityUpdateTolerance_;
+
+    // the copy of the intensive quantities at the start of the time step which is
+    // restored if the time integration fails
+    bool keepStartOfStepIntensiveQuantities_;
+    bool startOfStepIntensiveQuantitiesValid_ = false;
+    IntensiveQuantitiesVector startOfStepIntensiveQuantities_;
+    bool exchangeOverlapIntensiveQuantities_;
+    // the primary variables of each degree of freedom used for the last update of its
+    // intensive quantities. only used if intensiveQuantityUpdateTolerance_ is positive.
+    mutable std::vector<PrimaryVariables> lastUpdatePriVars_;
+
+    enum class IntensiveQuantityUpdateSchedule { Dynamic, Static, Guided };
+    IntensiveQuantityUpdateSchedule intensiveQuantityUpdateSchedule_ = IntensiveQuantityUpdateSchedule::Dynamic;
+    // the number of degrees of freedom which are updated by a thread in one go if the
+    // tiled update of the intensive quantities is used
+    static constexpr std::size_t intensiveQuantityTileSize = 128;
+    // the seed of the element of each degree of freedom. only non-empty if the tiled
+    // update of the intensive quantities is used.
+    std::vector<ElementSeed> dofElementSeeds_;
+    // the order in which the degrees of freedom of the tiles are updated. only
+    // non-empty if the update is grouped by regions.
+    bool sortIntensiveQuantityUpdateByRegion_ = false;
+    mutable std::vector<unsigned> dofUpdateOrder_;
+    // the seed of the element of each degree of freedom for the updates of subsets of
+    // the intensive quantities. collected on first use.
+    mutable std::vector<ElementSeed> subsetElementSeeds_;
 };
 
 /*!
@@ -2035,6 +3193,18 @@ public:
             this->solution_[timeIdx] = std::make_unique<DiscreteFunction>("solution", numDof);
         }
     }
+
+protected:
+    friend ParentType;
+
+    // the solution vectors are only accessed via the discretization, so the
+    // current one can be handed over to the previous time step without copying it.
+    void rotateSolutionHistory_()
+    {
+        this->materializeSolution_();
+        std::swap(this->solution_[/*timeIdx=*/0], this->solution_[/*timeIdx=*/1]);
+        this->solutionIsStale_.store(true, std::memory_order_release);
+    }
 };
 
 } // namespace Opm
@@ -122,14 +122,23 @@ public:
         if (this->enableGridAdaptation_) {
             // check if problem allows for adaptation and cells were marked
             if (this->simulator_.problem().markForGridAdaptation()) {
-                // adapt the grid and load balance if necessary
+                // adapt the grid and load balance if necessary. the solution is
+                // transferred by the restriction and prolongation operators.
+                const int oldSequence = space_.sequence();
                 adaptationManager().adapt();
 
-                // if the grid has potentially changed, we need to re-create the
-                // supporting data structures.
+                // the DOF manager only increments the sequence number if the grid was
+                // actually modified. if no element could be refined or coarsened, all
+                // data structures are still valid.
+                if (space_.sequence() == oldSequence)
+                    return;
+
+                // the grid has changed, so we need to re-create the supporting data
+                // structures. since the degrees of freedom are renumbered, this
+                // includes the sparsity pattern of the Jacobian matrix, which is
+                // dropped when finishInit() re-initializes the linearizer.
                 this->elementMapper_.update(this->gridView_);
                 this->vertexMapper_.update(this->gridView_);
-                this->resetLinearizer();
                 // this is a bit hacky because it supposes that Problem::finishInit()
                 // works fine multiple times in a row.
                 //
@@ -60,6 +60,9 @@ class FvBaseElementContext
 
     struct DofStore_ {
         IntensiveQuantities intensiveQuantities[timeDiscHistorySize];
+        // the intensive quantities which are used by the context. this either points
+        // to the object above or to an entry of the intensive quantity cache.
+        const IntensiveQuantities *intensiveQuantitiesPtr[timeDiscHistorySize];
         const PrimaryVariables* priVars[timeDiscHistorySize];
         const IntensiveQuantities *thermodynamicHint[timeDiscHistorySize];
     };
@@ -96,8 +99,11 @@ public:
         // remember the simulator object
         simulatorPtr_ = &simulator;
         enableStorageCache_ = Parameters::get<TypeTag, Properties::EnableStorageCache>();
+        enableIntensiveQuantityViews_ = Parameters::get<TypeTag, Properties::EnableIntensiveQuantityViews>();
         stashedDofIdx_ = -1;
         focusDofIdx_ = -1;
+
+        simulator.model().prepareStencil(stencil_);
     }
 
     static void *operator new(size_t size)
@@ -135,6 +141,7 @@ public:
         // most models don't need them, so that we only do this if the model explicitly
         // enables them
         stencil_.update(elem);
+        gradientCalculatorPrepared_ = false;
 
         // resize the arrays containing the flux and the volume variables
         dofVars_.resize(stencil_.numDof());
@@ -154,6 +161,7 @@ public:
 
         // update the finite element geometry
         stencil_.updatePrimaryTopology(elem);
+        gradientCalculatorPrepared_ = false;
 
         dofVars_.resize(stencil_.numPrimaryDof());
     }
@@ -171,6 +179,7 @@ public:
 
         // update the finite element geometry
         stencil_.updateTopology(elem);
+        gradientCalculatorPrepared_ = false;
     }
 
     /*!
@@ -223,6 +232,20 @@ public:
     void updateIntensiveQuantities(const PrimaryVariables& priVars, unsigned dofIdx, unsigned timeIdx)
     { asImp_().updateSingleIntQuants_(priVars, dofIdx, timeIdx); }
 
+    /*!
+     * \brief Compute the intensive quantities of a single sub-control volume of the
+     *        current element from the current solution for a single time index.
+     *
+     * Like updateIntensiveQuantities(), this considers the intensive quantities cache
+     * and the thermodynamic hints of the model.
+     *
+     * \param dofIdx The local index in the current element of the sub-control volume
+     *               which should be updated.
+     * \param timeIdx The index of the solution vector used by the time discretization.
+     */
+    void updateSingleIntensiveQuantities(unsigned dofIdx, unsigned timeIdx)
+    { updateDofIntensiveQuantities_(model().solution(timeIdx), dofIdx, timeIdx); }
+
     /*!
      * \brief Compute the extensive quantities of all sub-control volume
      *        faces of the current element for all time indices.
@@ -239,7 +262,13 @@ public:
      */
     void updateExtensiveQuantities(unsigned timeIdx)
     {
-        gradientCalculator_.prepare(/*context=*/asImp_(), timeIdx);
+        // the gradient calculator only depends on the geometry of the stencil, so it
+        // does not need to be prepared again if only the intensive quantities changed,
+        // e.g., for each focus degree of freedom of the linearization
+        if (!gradientCalculatorPrepared_) {
+            gradientCalculator_.prepare(/*context=*/asImp_(), timeIdx);
+            gradientCalculatorPrepared_ = true;
+        }
 
         for (unsigned fluxIdx = 0; fluxIdx < numInteriorFaces(timeIdx); fluxIdx++) {
             extensiveQuantities_[fluxIdx].update(/*context=*/asImp_(),
@@ -414,7 +443,7 @@ public:
                                    "for the most-recent substep (i.e. time index 0) are available!");
 #endif
 
-        return dofVars_[dofIdx].intensiveQuantities[timeIdx];
+        return *dofVars_[dofIdx].intensiveQuantitiesPtr[timeIdx];
     }
 
     /*!
@@ -432,11 +461,19 @@ public:
     }
     /*!
      * \copydoc intensiveQuantities()
+     *
+     * If the context refers to the cached intensive quantities of the degree of
+     * freedom, they are copied into the context first.
      */
     IntensiveQuantities& intensiveQuantities(unsigned dofIdx, unsigned timeIdx)
     {
         assert(dofIdx < numDof(timeIdx));
-        return dofVars_[dofIdx].intensiveQuantities[timeIdx];
+        auto& dofVars = dofVars_[dofIdx];
+        if (dofVars.intensiveQuantitiesPtr[timeIdx] != &dofVars.intensiveQuantities[timeIdx]) {
+            dofVars.intensiveQuantities[timeIdx] = *dofVars.intensiveQuantitiesPtr[timeIdx];
+            dofVars.intensiveQuantitiesPtr[timeIdx] = &dofVars.intensiveQuantities[timeIdx];
+        }
+        return dofVars.intensiveQuantities[timeIdx];
     }
 
     /*!
@@ -480,8 +517,15 @@ public:
     {
         assert(dofIdx < numDof(/*timeIdx=*/0));
 
-        intensiveQuantitiesStashed_ = dofVars_[dofIdx].intensiveQuantities[/*timeIdx=*/0];
-        priVarsStashed_ = *dofVars_[dofIdx].priVars[/*timeIdx=*/0];
+        // quantities which are referred to in the cache are not modified by the
+        // context, so it suffices to remember where they are
+        auto& dofVars = dofVars_[dofIdx];
+        stashedIntensiveQuantitiesPtr_ = dofVars.intensiveQuantitiesPtr[/*timeIdx=*/0];
+        if (stashedIntensiveQuantitiesPtr_ == &dofVars.intensiveQuantities[/*timeIdx=*/0]) {
+            intensiveQuantitiesStashed_ = dofVars.intensiveQuantities[/*timeIdx=*/0];
+            stashedIntensiveQuantitiesPtr_ = &intensiveQuantitiesStashed_;
+        }
+        priVarsStashed_ = *dofVars.priVars[/*timeIdx=*/0];
         stashedDofIdx_ = static_cast<int>(dofIdx);
     }
 
@@ -492,8 +536,14 @@ public:
      */
     void restoreIntensiveQuantities(unsigned dofIdx)
     {
-        dofVars_[dofIdx].priVars[/*timeIdx=*/0] = &priVarsStashed_;
-        dofVars_[dofIdx].intensiveQuantities[/*timeIdx=*/0] = intensiveQuantitiesStashed_;
+        auto& dofVars = dofVars_[dofIdx];
+        dofVars.priVars[/*timeIdx=*/0] = &priVarsStashed_;
+        if (stashedIntensiveQuantitiesPtr_ == &intensiveQuantitiesStashed_) {
+            dofVars.intensiveQuantities[/*timeIdx=*/0] = intensiveQuantitiesStashed_;
+            dofVars.intensiveQuantitiesPtr[/*timeIdx=*/0] = &dofVars.intensiveQuantities[/*timeIdx=*/0];
+        }
+        else
+            dofVars.intensiveQuantitiesPtr[/*timeIdx=*/0] = stashedIntensiveQuantitiesPtr_;
         stashedDofIdx_ = -1;
     }
 
@@ -530,6 +580,20 @@ public:
     void setEnableStorageCache(bool yesno)
     { enableStorageCache_ = yesno; }
 
+    /*!
+     * \brief Returns true iff the context refers to the cached intensive quantities
+     *        instead of copying them.
+     */
+    bool enableIntensiveQuantityViews() const
+    { return enableIntensiveQuantityViews_; }
+
+    /*!
+     * \brief Specifies if the context ought to refer to the cached intensive quantities
+     *        instead of copying them.
+     */
+    void setEnableIntensiveQuantityViews(bool yesno)
+    { enableIntensiveQuantityViews_ = yesno; }
+
 private:
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
@@ -549,24 +613,36 @@ protected:
         const SolutionVector& globalSol = model().solution(timeIdx);
 
         // update the non-gradient quantities
-        for (unsigned dofIdx = 0; dofIdx < numDof; dofIdx++) {
-            unsigned globalIdx = globalSpaceIndex(dofIdx, timeIdx);
-            const PrimaryVariables& dofSol = globalSol[globalIdx];
-            dofVars_[dofIdx].priVars[timeIdx] = &dofSol;
-
-            dofVars_[dofIdx].thermodynamicHint[timeIdx] =
-                model().thermodynamicHint(globalIdx, timeIdx);
-
-            const auto *cachedIntQuants = model().cachedIntensiveQuantities(globalIdx, timeIdx);
-            if (cachedIntQuants) {
-                dofVars_[dofIdx].intensiveQuantities[timeIdx] = *cachedIntQuants;
-            }
-            else {
-                updateSingleIntQuants_(dofSol, dofIdx, timeIdx);
-                model().updateCachedIntensiveQuantities(dofVars_[dofIdx].intensiveQuantities[timeIdx],
-                                                        globalIdx,
-                                                        timeIdx);
-            }
+        for (unsigned dofIdx = 0; dofIdx < numDof; dofIdx++)
+            updateDofIntensiveQuantities_(globalSol, dofIdx, timeIdx);
+    }
+
+    /*!
+     * \brief Update the intensive quantities of a single degree of freedom from the
+     *        global solution, considering the intensive quantities cache.
+     */
+    void updateDofIntensiveQuantities_(const SolutionVector& globalSol, unsigned dofIdx, unsigned timeIdx)
+    {
+        unsigned globalIdx = globalSpaceIndex(dofIdx, timeIdx);
+        const PrimaryVariables& dofSol = globalSol[globalIdx];
+        dofVars_[dofIdx].priVars[timeIdx] = &dofSol;
+
+        dofVars_[dofIdx].thermodynamicHint[timeIdx] =
+            model().thermodynamicHint(globalIdx, timeIdx);
+
+        const auto *cachedIntQuants = model().cachedIntensiveQuantities(globalIdx, timeIdx);
+        if (cachedIntQuants && enableIntensiveQuantityViews_) {
+            dofVars_[dofIdx].intensiveQuantitiesPtr[timeIdx] = cachedIntQuants;
+        }
+        else if (cachedIntQuants) {
+            dofVars_[dofIdx].intensiveQuantities[timeIdx] = *cachedIntQuants;
+            dofVars_[dofIdx].intensiveQuantitiesPtr[timeIdx] = &dofVars_[dofIdx].intensiveQuantities[timeIdx];
+        }
+        else {
+            updateSingleIntQuants_(dofSol, dofIdx, timeIdx);
+            model().updateCachedIntensiveQuantities(dofVars_[dofIdx].intensiveQuantities[timeIdx],
+                                                    globalIdx,
+                                                    timeIdx);
         }
     }
 
@@ -579,10 +655,12 @@ protected:
 #endif
 
         dofVars_[dofIdx].priVars[timeIdx] = &priVars;
+        dofVars_[dofIdx].intensiveQuantitiesPtr[timeIdx] = &dofVars_[dofIdx].intensiveQuantities[timeIdx];
         dofVars_[dofIdx].intensiveQuantities[timeIdx].update(/*context=*/asImp_(), dofIdx, timeIdx);
     }
 
     IntensiveQuantities intensiveQuantitiesStashed_;
+    const IntensiveQuantities *stashedIntensiveQuantitiesPtr_ = nullptr;
     PrimaryVariables priVarsStashed_;
 
     GradientCalculator gradientCalculator_;
@@ -597,7 +675,9 @@ protected:
 
     int stashedDofIdx_;
     int focusDofIdx_;
+    bool gradientCalculatorPrepared_ = false;
     bool enableStorageCache_;
+    bool enableIntensiveQuantityViews_;
 };
 
 } // namespace Opm
@@ -147,6 +147,11 @@ private:
 
     enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
 
+    // if the storage term of a degree of freedom only depends on its own primary
+    // variables, the storage and source terms of the other degrees of freedom are not
+    // affected by a deflection and can be reused from the unperturbed residual
+    static constexpr bool reuseVolumeTerms = !getPropValue<TypeTag, Properties::ExtensiveStorageTerm>();
+
     // extract local matrices from jacobian matrix for consistency
     using ScalarMatrixBlock = typename GetPropType<TypeTag, Properties::SparseMatrixAdapter>::MatrixBlock;
     using ScalarVectorBlock = Dune::FieldVector<Scalar, numEq>;
@@ -243,7 +248,18 @@ public:
         reset_(elemCtx);
 
         // calculate the local residual
-        localResidual_.eval(residual_, elemCtx);
+        if constexpr (reuseVolumeTerms) {
+            // keep the storage and source terms separately, so that they need not be
+            // recomputed for the degrees of freedom which are not deflected
+            localResidual_.evalSurfaceTerms(residual_, elemCtx);
+            size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+            for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; dofIdx++) {
+                localResidual_.evalVolumeTerms(volumeResidual_, elemCtx, dofIdx);
+                residual_[dofIdx] += volumeResidual_[dofIdx];
+            }
+        }
+        else
+            localResidual_.eval(residual_, elemCtx);
 
         // calculate the local jacobian matrix
         size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
@@ -350,6 +366,11 @@ protected:
         jacobian_.setSize(numDof, numPrimaryDof);
 
         derivResidual_.resize(numDof);
+        deflectedResidual_.resize(numDof);
+        if constexpr (reuseVolumeTerms) {
+            volumeResidual_.resize(numDof);
+            deflectedVolumeResidual_.resize(numDof);
+        }
     }
 
     /*!
@@ -432,7 +453,7 @@ protected:
             // calculate the deflected residual
             elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
             elemCtx.updateAllExtensiveQuantities();
-            localResidual_.eval(derivResidual_, elemCtx);
+            evalDeflectedResidual_(derivResidual_, elemCtx, dofIdx);
         }
         else {
             // we are using backward differences, i.e. we don't need
@@ -449,13 +470,13 @@ protected:
             priVars[pvIdx] -= delta + eps;
             delta += eps;
 
-            // calculate the deflected residual again, this time we use the local
-            // residual's internal storage.
+            // calculate the deflected residual again, this time into a separate
+            // buffer
             elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
             elemCtx.updateAllExtensiveQuantities();
-            localResidual_.eval(elemCtx);
+            evalDeflectedResidual_(deflectedResidual_, elemCtx, dofIdx);
 
-            derivResidual_ -= localResidual_.residual();
+            derivResidual_ -= deflectedResidual_;
         }
         else {
             // we are using forward differences, i.e. we don't need to
@@ -480,6 +501,34 @@ protected:
 #endif
     }
 
+    /*!
+     * \brief Evaluate the local residual for deflected primary variables of a single
+     *        degree of freedom.
+     *
+     * If possible, only the flux and boundary terms and the volume terms of the
+     * deflected degree of freedom are recomputed, while the volume terms of all other
+     * degrees of freedom are taken from the evaluation of the undeflected residual.
+     */
+    void evalDeflectedResidual_(LocalEvalBlockVector& residual,
+                                ElementContext& elemCtx,
+                                unsigned focusDofIdx)
+    {
+        if constexpr (reuseVolumeTerms) {
+            localResidual_.evalSurfaceTerms(residual, elemCtx);
+            localResidual_.evalVolumeTerms(deflectedVolumeResidual_, elemCtx, focusDofIdx);
+
+            size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+            for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; dofIdx++) {
+                if (dofIdx == focusDofIdx)
+                    residual[dofIdx] += deflectedVolumeResidual_[dofIdx];
+                else
+                    residual[dofIdx] += volumeResidual_[dofIdx];
+            }
+        }
+        else
+            localResidual_.eval(residual, elemCtx);
+    }
+
     /*!
      * \brief Updates the current local Jacobian matrix with the partial derivatives of
      *        all equations for primary variable 'pvIdx' at the degree of freedom
@@ -509,6 +558,11 @@ protected:
 
     LocalEvalBlockVector residual_;
     LocalEvalBlockVector derivResidual_;
+    LocalEvalBlockVector deflectedResidual_;
+    // the storage and source terms of the undeflected and the deflected primary
+    // degrees of freedom. only used if the volume terms can be reused.
+    LocalEvalBlockVector volumeResidual_;
+    LocalEvalBlockVector deflectedVolumeResidual_;
     ScalarLocalBlockMatrix jacobian_;
 
     LocalResidual localResidual_;
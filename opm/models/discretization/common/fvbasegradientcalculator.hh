@@ -32,6 +32,10 @@
 
 #include <dune/common/fvector.hh>
 
+#include <cassert>
+#include <cmath>
+#include <vector>
+
 namespace Opm {
 template<class TypeTag>
 class EcfvDiscretization;
@@ -73,12 +77,57 @@ public:
      * \brief Precomputes the common values to calculate gradients and values of
      *        quantities at every interior flux approximation point.
      *
+     * These are the weights of the two degrees of freedom adjacent to each face, which
+     * only depend on the geometry of the stencil. Thus, each value or gradient is
+     * afterwards calculated using a few multiplications.
+     *
      * \param elemCtx The current execution context
      * \param timeIdx The index used by the time discretization.
      */
     template <bool prepareValues = true, bool prepareGradients = true>
-    void prepare(const ElementContext&, unsigned)
-    { /* noting to do */ }
+    void prepare(const ElementContext& elemCtx, unsigned timeIdx)
+    {
+        const auto& stencil = elemCtx.stencil(timeIdx);
+        const size_t numFaces = stencil.numInteriorFaces();
+
+        if constexpr (prepareValues) {
+            interiorWeight_.resize(numFaces);
+            exteriorWeight_.resize(numFaces);
+            for (unsigned fapIdx = 0; fapIdx < numFaces; ++fapIdx) {
+                Scalar interiorDistance;
+                Scalar exteriorDistance;
+                computeDistances_(interiorDistance, exteriorDistance, stencil, fapIdx);
+
+                // use the average weighted by distance...
+                const Scalar totDistance = interiorDistance + exteriorDistance;
+                interiorWeight_[fapIdx] = interiorDistance/totDistance;
+                exteriorWeight_[fapIdx] = exteriorDistance/totDistance;
+            }
+        }
+
+        if constexpr (prepareGradients) {
+            gradientWeight_.resize(numFaces);
+            for (unsigned fapIdx = 0; fapIdx < numFaces; ++fapIdx) {
+                const auto& face = stencil.interiorFace(fapIdx);
+                const auto& interiorPos = stencil.subControlVolume(face.interiorIndex()).globalPos();
+                const auto& exteriorPos = stencil.subControlVolume(face.exteriorIndex()).globalPos();
+
+                Scalar distSquared = 0.0;
+                for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
+                    Scalar tmp = exteriorPos[dimIdx] - interiorPos[dimIdx];
+                    distSquared += tmp*tmp;
+                }
+
+                // the gradient is the normalized directional vector between the two
+                // centers times the ratio of the difference of the values and their
+                // distance, i.e., d/abs(d) * delta y / abs(d) = d*delta y / abs(d)^2.
+                for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
+                    Scalar tmp = exteriorPos[dimIdx] - interiorPos[dimIdx];
+                    gradientWeight_[fapIdx][dimIdx] = tmp/distSquared;
+                }
+            }
+        }
+    }
 
     /*!
      * \brief Calculates the value of an arbitrary scalar quantity at any interior flux
@@ -100,9 +149,9 @@ public:
         using RawReturnType = decltype(quantityCallback.operator()(0));
         using ReturnType = typename std::remove_const<typename std::remove_reference<RawReturnType>::type>::type;
 
-        Scalar interiorDistance;
-        Scalar exteriorDistance;
-        computeDistances_(interiorDistance, exteriorDistance, elemCtx, fapIdx);
+        assert(fapIdx < interiorWeight_.size());
+        const Scalar interiorWeight = interiorWeight_[fapIdx];
+        const Scalar exteriorWeight = exteriorWeight_[fapIdx];
 
         const auto& face = elemCtx.stencil(/*timeIdx=*/0).interiorFace(fapIdx);
         auto i = face.interiorIndex();
@@ -112,16 +161,14 @@ public:
         // use the average weighted by distance...
         ReturnType value;
         if (i == focusDofIdx)
-            value = quantityCallback(i)*interiorDistance;
+            value = quantityCallback(i)*interiorWeight;
         else
-            value = getValue(quantityCallback(i))*interiorDistance;
+            value = getValue(quantityCallback(i))*interiorWeight;
 
         if (j == focusDofIdx)
-            value += quantityCallback(j)*exteriorDistance;
+            value += quantityCallback(j)*exteriorWeight;
         else
-            value += getValue(quantityCallback(j))*exteriorDistance;
-
-        value /= interiorDistance + exteriorDistance;
+            value += getValue(quantityCallback(j))*exteriorWeight;
 
         return value;
     }
@@ -146,9 +193,9 @@ public:
         using RawReturnType = decltype(quantityCallback.operator()(0));
         using ReturnType = typename std::remove_const<typename std::remove_reference<RawReturnType>::type>::type;
 
-        Scalar interiorDistance;
-        Scalar exteriorDistance;
-        computeDistances_(interiorDistance, exteriorDistance, elemCtx, fapIdx);
+        assert(fapIdx < interiorWeight_.size());
+        const Scalar interiorWeight = interiorWeight_[fapIdx];
+        const Scalar exteriorWeight = exteriorWeight_[fapIdx];
 
         const auto& face = elemCtx.stencil(/*timeIdx=*/0).interiorFace(fapIdx);
         auto i = face.interiorIndex();
@@ -160,29 +207,25 @@ public:
         if (i == focusDofIdx) {
             value = quantityCallback(i);
             for (int k = 0; k < value.size(); ++k)
-                value[k] *= interiorDistance;
+                value[k] *= interiorWeight;
         }
         else {
             const auto& dofVal = getValue(quantityCallback(i));
             for (int k = 0; k < dofVal.size(); ++k)
-                value[k] = getValue(dofVal[k])*interiorDistance;
+                value[k] = getValue(dofVal[k])*interiorWeight;
         }
 
         if (j == focusDofIdx) {
             const auto& dofVal = quantityCallback(j);
             for (int k = 0; k < dofVal.size(); ++k)
-                value[k] += dofVal[k]*exteriorDistance;
+                value[k] += dofVal[k]*exteriorWeight;
         }
         else {
             const auto& dofVal = quantityCallback(j);
             for (int k = 0; k < dofVal.size(); ++k)
-                value[k] += getValue(dofVal[k])*exteriorDistance;
+                value[k] += getValue(dofVal[k])*exteriorWeight;
         }
 
-        Scalar totDistance = interiorDistance + exteriorDistance;
-        for (int k = 0; k < value.size(); ++k)
-            value[k] /= totDistance;
-
         return value;
     }
 
@@ -210,9 +253,6 @@ public:
         auto j = face.exteriorIndex();
         auto focusIdx = elemCtx.focusDofIndex();
 
-        const auto& interiorPos = stencil.subControlVolume(i).globalPos();
-        const auto& exteriorPos = stencil.subControlVolume(j).globalPos();
-
         Evaluation deltay;
         if (i == focusIdx) {
             deltay =
@@ -229,19 +269,59 @@ public:
                 getValue(quantityCallback(j))
                 - getValue(quantityCallback(i));
 
-        Scalar distSquared = 0.0;
-        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
-            Scalar tmp = exteriorPos[dimIdx] - interiorPos[dimIdx];
-            distSquared += tmp*tmp;
-        }
+        // the weights already contain the division by the squared distance between the
+        // centers of the sub-control volumes
+        assert(fapIdx < gradientWeight_.size());
+        const auto& gradientWeight = gradientWeight_[fapIdx];
+        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+            quantityGrad[dimIdx] = deltay*gradientWeight[dimIdx];
+    }
 
-        // divide the gradient by the squared distance between the centers of the
-        // sub-control volumes: the gradient is the normalized directional vector between
-        // the two centers times the ratio of the difference of the values and their
-        // distance, i.e., d/abs(d) * delta y / abs(d) = d*delta y / abs(d)^2.
-        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
-            Scalar tmp = exteriorPos[dimIdx] - interiorPos[dimIdx];
-            quantityGrad[dimIdx] = deltay*(tmp/distSquared);
+    /*!
+     * \brief Calculates the gradients of several quantities at any flux approximation
+     *        point in a single pass over the degrees of freedom.
+     *
+     * In contrast to calculateGradient(), the callback returns the values of all
+     * quantities of a degree of freedom at once as a random access container, so the
+     * intensive quantities of each degree of freedom are only looked up once.
+     *
+     * \param quantityGrads The container of the resulting gradients. It must exhibit
+     *               the same size as the result of the callback.
+     * \param elemCtx The current execution context
+     * \param fapIdx The local index of the flux approximation point
+     *               in the current element's stencil.
+     * \param quantityCallback A callable object returning the values of all
+     *               quantities given the index of a degree of freedom
+     */
+    template <class QuantityCallback, class EvalDimVectorArray>
+    void calculateGradients(EvalDimVectorArray& quantityGrads,
+                            const ElementContext& elemCtx,
+                            unsigned fapIdx,
+                            const QuantityCallback& quantityCallback) const
+    {
+        const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+        const auto& face = stencil.interiorFace(fapIdx);
+
+        auto i = face.interiorIndex();
+        auto j = face.exteriorIndex();
+        auto focusIdx = elemCtx.focusDofIndex();
+
+        const auto& valuesIn = quantityCallback(i);
+        const auto& valuesEx = quantityCallback(j);
+
+        assert(fapIdx < gradientWeight_.size());
+        const auto& gradientWeight = gradientWeight_[fapIdx];
+        for (unsigned quantityIdx = 0; quantityIdx < quantityGrads.size(); ++quantityIdx) {
+            Evaluation deltay;
+            if (i == focusIdx)
+                deltay = getValue(valuesEx[quantityIdx]) - valuesIn[quantityIdx];
+            else if (j == focusIdx)
+                deltay = valuesEx[quantityIdx] - getValue(valuesIn[quantityIdx]);
+            else
+                deltay = getValue(valuesEx[quantityIdx]) - getValue(valuesIn[quantityIdx]);
+
+            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                quantityGrads[quantityIdx][dimIdx] = deltay*gradientWeight[dimIdx];
         }
     }
 
@@ -318,12 +398,12 @@ public:
     }
 
 private:
-    void computeDistances_(Scalar& interiorDistance,
-                           Scalar& exteriorDistance,
-                           const ElementContext& elemCtx,
-                           unsigned fapIdx) const
+    template <class Stencil>
+    static void computeDistances_(Scalar& interiorDistance,
+                                  Scalar& exteriorDistance,
+                                  const Stencil& stencil,
+                                  unsigned fapIdx)
     {
-        const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
         const auto& face = stencil.interiorFace(fapIdx);
 
         // calculate the distances of the position of the interior and of the exterior
@@ -350,6 +430,13 @@ private:
         interiorDistance = std::sqrt(std::abs(interiorDistance));
         exteriorDistance = std::sqrt(std::abs(exteriorDistance));
     }
+
+    // the weights of the interior and of the exterior degree of freedom of each
+    // interior face for the values, and the factors of the difference of their values
+    // for the gradients
+    std::vector<Scalar> interiorWeight_;
+    std::vector<Scalar> exteriorWeight_;
+    std::vector<DimVector> gradientWeight_;
 };
 } // namespace Opm
 
@@ -38,17 +38,21 @@
 #include <opm/models/parallel/gridcommhandles.hh>
 #include <opm/models/parallel/threadmanager.hh>
 #include <opm/models/parallel/threadedentityiterator.hh>
+#include <opm/models/utils/memoryusage.hh>
+#include <opm/models/utils/regionprofiler.hh>
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
 
 #include <dune/common/version.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <cstddef>
 #include <type_traits>
 #include <iostream>
 #include <vector>
 #include <thread>
 #include <set>
+#include <utility>
 #include <exception>   // current_exception, rethrow_exception
 #include <mutex>
 
@@ -95,6 +99,7 @@ class FvBaseLinearizer
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
+    using ElementSeed = typename Element::EntitySeed;
 
     using Vector = GlobalEqVector;
 
@@ -117,6 +122,7 @@ public:
         : jacobian_()
     {
         simulatorPtr_ = 0;
+        coloredElementAssembly_ = Parameters::get<TypeTag, Properties::ColoredElementAssembly>();
     }
 
     ~FvBaseLinearizer()
@@ -131,7 +137,11 @@ public:
      * \brief Register all run-time parameters for the Jacobian linearizer.
      */
     static void registerParameters()
-    { }
+    {
+        Parameters::registerParam<TypeTag, Properties::ColoredElementAssembly>
+            ("Linearize the elements in groups which do not share any degree of freedom "
+             "instead of locking the global system of equations.");
+    }
 
     /*!
      * \brief Initialize the linearizer.
@@ -165,8 +175,20 @@ public:
     void eraseMatrix()
     {
         jacobian_.reset();
+        invalidateConstraints();
     }
 
+    /*!
+     * \brief Causes the constraint degrees of freedom to be queried from the problem
+     *        before the next time step.
+     *
+     * The constraints are assumed to only change at episode boundaries and if the grid
+     * is modified. Problems whose constraints change at other times must call this
+     * method whenever this happens.
+     */
+    void invalidateConstraints()
+    { constraintsMapValid_ = false; }
+
     /*!
      * \brief Linearize the full system of non-linear equations.
      *
@@ -201,6 +223,7 @@ public:
     void linearizeDomain(const SubDomainType& domain)
     {
         OPM_TIMEBLOCK(linearizeDomain);
+        EWOMS_PROFILE_REGION("linearize domain");
         // we defer the initialization of the Jacobian matrix until here because the
         // auxiliary modules usually assume the problem, model and grid to be fully
         // initialized...
@@ -250,6 +273,7 @@ public:
     void linearizeAuxiliaryEquations()
     {
         OPM_TIMEBLOCK(linearizeAuxiliaryEquations);
+        EWOMS_PROFILE_REGION("linearize auxiliary equations");
         // flush possible local caches into matrix structure
         jacobian_->commit();
 
@@ -293,6 +317,30 @@ public:
     GlobalEqVector& residual()
     { return residual_; }
 
+    /*!
+     * \brief Add the number of bytes held by the linearizer to a memory usage report.
+     */
+    void reportMemoryUsage(MemoryUsage& usage) const
+    {
+        if (jacobian_)
+            usage.add("Jacobian matrix", MemoryUsage::bcrsMatrixBytes(jacobian_->istlMatrix()));
+        usage.add("Residual", MemoryUsage::blockVectorBytes(residual_));
+
+        // the sets of the sparsity pattern are red-black trees with one node per entry
+        std::size_t numPatternEntries = 0;
+        for (const auto& neighbors : sparsityPattern_)
+            numPatternEntries += neighbors.size();
+        usage.add("Sparsity pattern",
+                  MemoryUsage::bytesOf(sparsityPattern_)
+                  + numPatternEntries*(sizeof(unsigned int) + 4*sizeof(void*)));
+
+        usage.add("Flows and flores tables",
+                  static_cast<std::size_t>(flowsInfo_.dataSize() + floresInfo_.dataSize())*sizeof(FlowInfo)
+                  + static_cast<std::size_t>(flowsInfo_.size() + floresInfo_.size() + 2)*sizeof(int));
+        usage.add("Element coloring",
+                  MemoryUsage::bytesOf(coloredElementSeeds_) + MemoryUsage::bytesOf(elementColorOffsets_));
+    }
+
     void setLinearizationType(LinearizationType linearizationType){
         linearizationType_ = linearizationType;
     };
@@ -408,10 +456,24 @@ private:
         residual_.resize(model_().numTotalDof());
         resetSystem_();
 
-        // create the per-thread context objects
-        elementCtx_.resize(ThreadManager::maxThreads());
-        for (unsigned threadId = 0; threadId != ThreadManager::maxThreads(); ++ threadId)
-            elementCtx_[threadId] = new ElementContext(simulator_());
+        // create the per-thread context objects. each context is allocated by the
+        // thread which uses it, so that its memory is local to that thread on NUMA
+        // systems with a first-touch page placement policy.
+        elementCtx_.assign(ThreadManager::maxThreads(), nullptr);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            const unsigned threadId = ThreadManager::threadId();
+            if (threadId < elementCtx_.size() && !elementCtx_[threadId])
+                elementCtx_[threadId] = new ElementContext(simulator_());
+        }
+
+        // create the contexts of the threads which did not take part above
+        for (auto& elemCtx : elementCtx_) {
+            if (!elemCtx)
+                elemCtx = new ElementContext(simulator_());
+        }
     }
 
     // Construct the BCRS matrix for the Jacobian of the residual function
@@ -449,6 +511,62 @@ private:
 
         // create matrix structure based on sparsity pattern
         jacobian_->reserve(sparsityPattern_);
+
+        if (coloredElementAssembly_)
+            createElementColoring_();
+    }
+
+    // Group the elements by colors such that no two elements of the same color share a
+    // primary degree of freedom. Since the local linearization of an element is only
+    // added to the rows of the residual and to the columns of the Jacobian which
+    // belong to its primary degrees of freedom, the elements of a color can then be
+    // added to the global system concurrently.
+    void createElementColoring_()
+    {
+        OPM_TIMEBLOCK(createElementColoring);
+        Stencil stencil(gridView_(), model_().dofMapper());
+
+        std::vector<ElementSeed> seeds;
+        std::vector<int> elementColor;
+        std::vector<std::vector<int>> dofColors(model_().numTotalDof());
+        std::vector<std::size_t> colorStamp;
+        int numColors = 0;
+        for (const auto& elem : elements(gridView_())) {
+            if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                continue;
+
+            stencil.update(elem);
+            const std::size_t stamp = seeds.size() + 1;
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
+                for (int otherColor : dofColors[stencil.globalSpaceIndex(primaryDofIdx)])
+                    colorStamp[otherColor] = stamp;
+            }
+
+            int color = 0;
+            while (color < numColors && colorStamp[color] == stamp)
+                ++color;
+            if (color == numColors) {
+                ++numColors;
+                colorStamp.push_back(0);
+            }
+
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx)
+                dofColors[stencil.globalSpaceIndex(primaryDofIdx)].push_back(color);
+            seeds.push_back(elem.seed());
+            elementColor.push_back(color);
+        }
+
+        // sort the elements by color
+        elementColorOffsets_.assign(numColors + 1, 0);
+        for (int color : elementColor)
+            ++elementColorOffsets_[color + 1];
+        for (int color = 0; color < numColors; ++color)
+            elementColorOffsets_[color + 1] += elementColorOffsets_[color];
+
+        std::vector<std::size_t> nextPos(elementColorOffsets_.begin(), elementColorOffsets_.end() - 1);
+        coloredElementSeeds_.resize(seeds.size());
+        for (std::size_t elemIdx = 0; elemIdx < seeds.size(); ++elemIdx)
+            coloredElementSeeds_[nextPos[elementColor[elemIdx]]++] = seeds[elemIdx];
     }
 
     // reset the global linear system of equations.
@@ -460,15 +578,25 @@ private:
     }
 
     // query the problem for all constraint degrees of freedom. note that this method is
-    // quite involved and is thus relatively slow.
+    // quite involved and is thus relatively slow, so the result is kept until the
+    // episode changes or the constraints are invalidated explicitly.
     void updateConstraintsMap_()
     {
         if (!enableConstraints_())
             // constraints are not explictly enabled, so we don't need to consider them!
             return;
 
+        const int episodeIdx = simulator_().episodeIndex();
+        if (constraintsMapValid_ && episodeIdx == constraintsEpisodeIdx_)
+            return;
+
         constraintsMap_.clear();
 
+        // each thread collects the constraints of its elements, the lists are merged
+        // afterwards
+        std::vector<std::vector<std::pair<unsigned, Constraints>>>
+            threadConstraints(ThreadManager::maxThreads());
+
         // loop over all elements...
         ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
 #ifdef _OPENMP
@@ -497,12 +625,18 @@ private:
                                                   /*timeIdx=*/0);
                     if (constraints.isActive()) {
                         unsigned globI = elemCtx.globalSpaceIndex(primaryDofIdx, /*timeIdx=*/0);
-                        constraintsMap_[globI] = constraints;
-                        continue;
+                        threadConstraints[threadId].emplace_back(globI, constraints);
                     }
                 }
             }
         }
+
+        for (const auto& constraintsList : threadConstraints)
+            for (const auto& [globI, constraints] : constraintsList)
+                constraintsMap_[globI] = constraints;
+
+        constraintsMapValid_ = true;
+        constraintsEpisodeIdx_ = episodeIdx;
     }
 
     // linearize the whole or part of the system
@@ -516,8 +650,8 @@ private:
         // Instead, that must be called before starting the linearization.
 
         // before the first iteration of each time step, we need to update the
-        // constraints. (i.e., we assume that constraints can be time dependent, but they
-        // can't depend on the solution.)
+        // constraints if they have changed. (i.e., we assume that constraints can change
+        // between episodes, but they can't depend on the solution.)
         if (model_().newtonMethod().numIterations() == 0)
             updateConstraintsMap_();
 
@@ -532,7 +666,19 @@ private:
         // parallel block below. initialized to null to indicate no exception
         std::exception_ptr exceptionPtr = nullptr;
 
-        // relinearize the elements...
+        // relinearize the elements. on the full domain, this can be done color by color
+        // if the elements have been colored.
+        if constexpr (std::is_same_v<SubDomainType, FullDomain>) {
+            if (!elementColorOffsets_.empty()) {
+                linearizeColoredElements_(exceptionLock, exceptionPtr);
+                if (exceptionPtr)
+                    std::rethrow_exception(exceptionPtr);
+
+                applyConstraintsToLinearization_();
+                return;
+            }
+        }
+
         using GridViewType = decltype(domain.view);
         ThreadedEntityIterator<GridViewType, /*codim=*/0> threadedElemIt(domain.view);
 #ifdef _OPENMP
@@ -590,9 +736,35 @@ private:
     }
 
 
+    // linearize all elements of the process' grid partition color by color. the
+    // elements of one color can be added to the global system without locking.
+    void linearizeColoredElements_(std::mutex& exceptionLock, std::exception_ptr& exceptionPtr)
+    {
+        const auto& grid = gridView_().grid();
+        const std::size_t numColors = elementColorOffsets_.size() - 1;
+        for (std::size_t colorIdx = 0; colorIdx < numColors && !exceptionPtr; ++colorIdx) {
+            const std::size_t elemBegin = elementColorOffsets_[colorIdx];
+            const std::size_t elemEnd = elementColorOffsets_[colorIdx + 1];
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (std::size_t elemIdx = elemBegin; elemIdx < elemEnd; ++elemIdx) {
+                // see linearize_() for the rationale of the exception handling
+                try {
+                    const auto elem = grid.entity(coloredElementSeeds_[elemIdx]);
+                    linearizeElement_(elem, /*lockMatrix=*/false);
+                }
+                catch(...) {
+                    std::lock_guard<std::mutex> take(exceptionLock);
+                    exceptionPtr = std::current_exception();
+                }
+            }
+        }
+    }
+
     // linearize an element in the interior of the process' grid partition
     template <class ElementType>
-    void linearizeElement_(const ElementType& elem)
+    void linearizeElement_(const ElementType& elem, bool lockMatrix = true)
     {
         unsigned threadId = ThreadManager::threadId();
 
@@ -603,7 +775,8 @@ private:
         localLinearizer.linearize(*elementCtx, elem);
 
         // update the right hand side and the Jacobian matrix
-        if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+        const bool useLock = lockMatrix && getPropValue<TypeTag, Properties::UseLinearizationLock>();
+        if (useLock)
             globalMatrixMutex_.lock();
 
         size_t numPrimaryDof = elementCtx->numPrimaryDof(/*timeIdx=*/0);
@@ -621,7 +794,7 @@ private:
             }
         }
 
-        if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+        if (useLock)
             globalMatrixMutex_.unlock();
     }
 
@@ -674,6 +847,8 @@ private:
     // The constraint equations (only non-empty if the
     // EnableConstraints property is true)
     std::map<unsigned, Constraints> constraintsMap_;
+    bool constraintsMapValid_ = false;
+    int constraintsEpisodeIdx_ = -1;
 
 
     struct FlowInfo
@@ -697,6 +872,12 @@ private:
 
     std::vector<std::set<unsigned int>> sparsityPattern_;
 
+    // the elements sorted by color for the colored assembly and the start of the
+    // range of each color in coloredElementSeeds_
+    bool coloredElementAssembly_ = false;
+    std::vector<ElementSeed> coloredElementSeeds_;
+    std::vector<std::size_t> elementColorOffsets_;
+
     struct FullDomain
     {
         explicit FullDomain(const GridView& v) : view (v) {}
@@ -28,26 +28,16 @@
 #ifndef EWOMS_FV_BASE_NEWTON_CONVERGENCE_WRITER_HH
 #define EWOMS_FV_BASE_NEWTON_CONVERGENCE_WRITER_HH
 
+#include <opm/models/discretization/common/fvbaseproperties.hh>
 #include <opm/models/io/vtkmultiwriter.hh>
+#include <opm/models/nonlinear/newtonmethodproperties.hh>
+#include <opm/models/utils/parametersystem.hh>
 #include <opm/models/utils/propertysystem.hh>
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
-
-//! \cond SKIP_THIS
-namespace Opm::Properties {
-
-// forward declaration of the required property tags
-template<class TypeTag, class MyTypeTag>
-struct SolutionVector;
-template<class TypeTag, class MyTypeTag>
-struct GlobalEqVector;
-template<class TypeTag, class MyTypeTag>
-struct NewtonMethod;
-template<class TypeTag, class MyTypeTag>
-struct VtkOutputFormat;
-
-} // namespace Opm::Properties
-//! \endcond
+#include <memory>
 
 namespace Opm {
 /*!
@@ -55,6 +45,12 @@ namespace Opm {
  *
  * \brief Writes the intermediate solutions during the Newton scheme
  *        for models using a finite volume discretization
+ *
+ * The files are written in the format specified by the VtkConvergenceOutputFormat
+ * property. If asynchronous VTK output is enabled, the files are written by the VTK
+ * output threads while the Newton method continues. The iterations which are written
+ * can be limited by the NewtonWriteConvergenceAfter parameter and the part of the
+ * grid by the OutputRegionOfInterest parameter.
  */
 template <class TypeTag>
 class FvBaseNewtonConvergenceWriter
@@ -65,7 +61,7 @@ class FvBaseNewtonConvergenceWriter
     using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
     using NewtonMethod = GetPropType<TypeTag, Properties::NewtonMethod>;
 
-    static const int vtkFormat = getPropValue<TypeTag, Properties::VtkOutputFormat>();
+    static const int vtkFormat = getPropValue<TypeTag, Properties::VtkConvergenceOutputFormat>();
     using VtkMultiWriter = ::Opm::VtkMultiWriter<GridView, vtkFormat>;
 
 public:
@@ -74,11 +70,18 @@ public:
     {
         timeStepIdx_ = 0;
         iteration_ = 0;
-        vtkMultiWriter_ = 0;
+        writing_ = false;
     }
 
-    ~FvBaseNewtonConvergenceWriter()
-    { delete vtkMultiWriter_; }
+    /*!
+     * \brief Register all run-time parameters of the convergence writer.
+     */
+    static void registerParameters()
+    {
+        Parameters::registerParam<TypeTag, Properties::NewtonWriteConvergenceAfter>
+            ("The number of Newton iterations of each time step for which the "
+             "convergence behaviour is not written");
+    }
 
     /*!
      * \brief Called by the Newton method before the actual algorithm
@@ -97,12 +100,13 @@ public:
     void beginIteration()
     {
         ++ iteration_;
+        writing_ = static_cast<unsigned>(iteration_) >
+            Parameters::get<TypeTag, Properties::NewtonWriteConvergenceAfter>();
+        if (!writing_)
+            return;
+
         if (!vtkMultiWriter_)
-            vtkMultiWriter_ =
-                new VtkMultiWriter(/*async=*/false,
-                                   newtonMethod_.problem().gridView(),
-                                   newtonMethod_.problem().outputDir(),
-                                   "convergence");
+            createWriter_();
         vtkMultiWriter_->beginWrite(timeStepIdx_ + iteration_ / 100.0);
     }
 
@@ -118,6 +122,9 @@ public:
     void writeFields(const SolutionVector& uLastIter,
                      const GlobalEqVector& deltaU)
     {
+        if (!writing_)
+            return;
+
         try {
             newtonMethod_.problem().model().addConvergenceVtkFields(*vtkMultiWriter_,
                                                                     uLastIter,
@@ -135,7 +142,11 @@ public:
      *        Newton algorithm has been completed.
      */
     void endIteration()
-    { vtkMultiWriter_->endWrite(); }
+    {
+        if (writing_)
+            vtkMultiWriter_->endWrite();
+        writing_ = false;
+    }
 
     /*!
      * \brief Called by the Newton method after Newton algorithm
@@ -148,9 +159,40 @@ public:
     { iteration_ = 0; }
 
 private:
+    void createWriter_()
+    {
+        const auto& problem = newtonMethod_.problem();
+
+        // the same restrictions as for the regular VTK output apply: the asynchronous
+        // writer assumes that the grid does not change and it is only used for
+        // sequential runs.
+        const bool asyncOutput =
+            problem.gridView().comm().size() == 1 &&
+            Parameters::get<TypeTag, Properties::EnableAsyncVtkOutput>() &&
+            !Parameters::get<TypeTag, Properties::EnableGridAdaptation>();
+
+        unsigned numWriterThreads = 0;
+        if (asyncOutput)
+            numWriterThreads = std::max(Parameters::get<TypeTag, Properties::VtkOutputThreads>(), 1u);
+
+        vtkMultiWriter_ = std::make_unique<VtkMultiWriter>(numWriterThreads,
+                                                           problem.gridView(),
+                                                           problem.outputDir(),
+                                                           "convergence");
+        if (asyncOutput) {
+            // let the Newton method compute the next iteration while the current one
+            // is written
+            const std::size_t memoryBudget =
+                std::size_t(Parameters::get<TypeTag, Properties::VtkOutputMemoryBudget>()) << 20;
+            vtkMultiWriter_->setMaxPendingWrites(Parameters::get<TypeTag, Properties::VtkOutputQueueDepth>(),
+                                                 memoryBudget);
+        }
+    }
+
     int timeStepIdx_;
     int iteration_;
-    VtkMultiWriter *vtkMultiWriter_;
+    bool writing_;
+    std::unique_ptr<VtkMultiWriter> vtkMultiWriter_;
     NewtonMethod& newtonMethod_;
 };
 
@@ -130,7 +130,11 @@ protected:
         // make sure that the intensive quantities get recalculated at the next
         // linearization
         if (model_().storeIntensiveQuantities()) {
-            for (unsigned dofIdx = 0; dofIdx < model_().numGridDof(); ++dofIdx)
+            const unsigned numGridDof = static_cast<unsigned>(model_().numGridDof());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx)
                 model_().setIntensiveQuantitiesCacheEntryValidity(dofIdx,
                                                                   /*timeIdx=*/0,
                                                                   /*valid=*/false);
@@ -145,6 +149,26 @@ protected:
         model_().syncOverlap();
 
         ParentType::beginIteration_();
+
+        // the intensive quantities are now those of the start of the time step, which
+        // can be reused if the time step needs to be repeated
+        if (this->numIterations() == 0)
+            model_().storeStartOfStepIntensiveQuantities();
+    }
+
+    /*!
+     * \brief Make the model consistent with the solution of a trial step.
+     */
+    void prepareTrialEvaluation_()
+    {
+        // the intensive quantities of the interior are updated while the primary
+        // variables of the overlap are still being received
+        model_().beginSyncOverlap();
+
+        if (model_().storeIntensiveQuantities())
+            model_().invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+
+        model_().finishSyncOverlap();
     }
 
     /*!
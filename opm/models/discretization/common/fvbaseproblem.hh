@@ -29,16 +29,31 @@
 #define EWOMS_FV_BASE_PROBLEM_HH
 
 #include "fvbaseproperties.hh"
+#include "multiratetimestepper.hh"
 
 #include <opm/models/io/vtkmultiwriter.hh>
+#include <opm/models/io/hdf5multiwriter.hh>
+#include <opm/models/io/sharedmemorywriter.hh>
+#include <opm/models/io/statisticswriter.hh>
 #include <opm/models/io/restart.hh>
 #include <opm/models/discretization/common/restrictprolong.hh>
+#include <opm/models/utils/pidtimestepcontroller.hh>
 
 #include <dune/common/fvector.hh>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <sys/stat.h>
 
@@ -88,6 +103,7 @@ private:
         dim = GridView::dimension,
         dimWorld = GridView::dimensionworld
     };
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
 
     using Element = typename GridView::template Codim<0>::Entity;
     using Vertex = typename GridView::template Codim<dim>::Entity;
@@ -132,6 +148,16 @@ public:
             }
         }
 
+        const std::string timeStepControl = Parameters::get<TypeTag, Properties::TimeStepControl>();
+        if (timeStepControl == "pid")
+            pidTimeStepController_ = std::make_unique<PidTimeStepController<Scalar>>
+                (Parameters::get<TypeTag, Properties::TimeStepControlTolerance>());
+        else if (timeStepControl != "iterations")
+            throw std::invalid_argument("Unknown time step control: '"+timeStepControl+"'");
+
+        if (Parameters::get<TypeTag, Properties::MultirateSubsteps>() > 1)
+            multirateTimeStepper_ = std::make_unique<MultirateTimeStepper<TypeTag>>(simulator);
+
         // communicate to get the bounding box of the whole domain
         for (unsigned i = 0; i < dim; ++i) {
             boundingBoxMin_[i] = gridView_.comm().min(boundingBoxMin_[i]);
@@ -153,8 +179,57 @@ public:
 
             std::string outputDir = asImp_().outputDir();
 
+            unsigned numWriterThreads = 0;
+            if (asyncVtkOutput)
+                numWriterThreads = std::max(Parameters::get<TypeTag, Properties::VtkOutputThreads>(), 1u);
+
             defaultVtkWriter_ =
-                new VtkMultiWriter(asyncVtkOutput, gridView_, outputDir, asImp_().name());
+                new VtkMultiWriter(numWriterThreads, gridView_, outputDir, asImp_().name());
+            if (asyncVtkOutput) {
+                const std::size_t memoryBudget =
+                    std::size_t(Parameters::get<TypeTag, Properties::VtkOutputMemoryBudget>()) << 20;
+                defaultVtkWriter_->setMaxPendingWrites(Parameters::get<TypeTag, Properties::VtkOutputQueueDepth>(),
+                                                       memoryBudget);
+            }
+            defaultVtkWriter_->setAggregation(Parameters::get<TypeTag, Properties::VtkOutputAggregation>());
+        }
+
+        if (Parameters::get<TypeTag, Properties::EnableHdf5Output>()) {
+#if HAVE_HDF5
+            hdf5Writer_ = std::make_unique<Hdf5Writer>(gridView_,
+                                                       asImp_().outputDir(),
+                                                       asImp_().name(),
+                                                       Parameters::get<TypeTag, Properties::Hdf5OutputSingleFile>());
+#else
+            throw std::runtime_error("HDF5 output has been requested, but the module has "
+                                     "been compiled without HDF5 support");
+#endif
+        }
+
+        if (Parameters::get<TypeTag, Properties::EnableStatisticsOutput>()) {
+            std::vector<std::string> fieldNames;
+            std::istringstream iss(Parameters::get<TypeTag, Properties::StatisticsOutputFields>());
+            std::string fieldName;
+            while (std::getline(iss, fieldName, ',')) {
+                const auto first = fieldName.find_first_not_of(" \t");
+                if (first != std::string::npos)
+                    fieldNames.push_back(fieldName.substr(first, fieldName.find_last_not_of(" \t") - first + 1));
+            }
+
+            statisticsWriter_ =
+                std::make_unique<StatisticsWriter>(gridView_,
+                                                   asImp_().outputDir(),
+                                                   asImp_().name(),
+                                                   fieldNames,
+                                                   Parameters::get<TypeTag, Properties::StatisticsWeightField>(),
+                                                   Parameters::get<TypeTag, Properties::StatisticsRegionField>(),
+                                                   Parameters::get<TypeTag, Properties::StatisticsHistogramBins>());
+        }
+
+        if (Parameters::get<TypeTag, Properties::EnableSharedMemoryOutput>()) {
+            const std::size_t capacity =
+                std::size_t(Parameters::get<TypeTag, Properties::SharedMemoryOutputCapacity>()) << 20;
+            sharedMemoryWriter_ = std::make_unique<SharedMemoryWriter>(gridView_, asImp_().name(), capacity);
         }
     }
 
@@ -177,10 +252,29 @@ public:
              "before the simulation bails out");
         Parameters::registerParam<TypeTag, Properties::EnableAsyncVtkOutput>
             ("Dispatch a separate thread to write the VTK output");
+        Parameters::registerParam<TypeTag, Properties::VtkOutputThreads>
+            ("The number of threads which write the asynchronous VTK output");
+        Parameters::registerParam<TypeTag, Properties::VtkOutputQueueDepth>
+            ("The maximum number of time steps for which the asynchronous VTK output "
+             "is written at the same time");
+        Parameters::registerParam<TypeTag, Properties::VtkOutputMemoryBudget>
+            ("The maximum amount of memory occupied by the data of the pending "
+             "asynchronous VTK output [MiB]");
+        Parameters::registerParam<TypeTag, Properties::VtkOutputAggregation>
+            ("The number of processes whose VTK pieces are combined into a single file "
+             "by the first of them. 0 combines the pieces of the processes of each node. "
+             "Only used by the compressed binary VTK format");
         Parameters::registerParam<TypeTag, Properties::ContinueOnConvergenceError>
             ("Continue with a non-converged solution instead of giving up "
              "if we encounter a time step size smaller than the minimum time "
              "step size.");
+        Parameters::registerParam<TypeTag, Properties::TimeStepControl>
+            ("The strategy used to choose the size of the next time step. Possible "
+             "values: 'iterations' and 'pid' (control the relative change of the solution)");
+        Parameters::registerParam<TypeTag, Properties::TimeStepControlTolerance>
+            ("The relative change of the solution per time step which is targeted "
+             "by the PID time step control");
+        MultirateTimeStepper<TypeTag>::registerParameters();
     }
 
     /*!
@@ -199,7 +293,9 @@ public:
      * The actual problem may chose to transform the value of the OutputDir parameter and
      * it can e.g. choose to create the directory on demand if it does not exist. The
      * default behaviour is to just return the OutputDir parameter and to throw an
-     * exception if no directory with this name exists.
+     * exception if no directory with this name exists. If the simulation is a member of
+     * an ensemble, its output is written to the subdirectory "member-<index>", which is
+     * created if it does not exist.
      */
     std::string outputDir() const
     {
@@ -219,6 +315,13 @@ public:
         if (access(outputDir.c_str(), W_OK) != 0)
             throw std::runtime_error("Output directory '"+outputDir+"' exists but is not writeable");
 
+        if (simulator_.ensembleSize() > 1) {
+            outputDir += "/member-" + std::to_string(simulator_.ensembleMemberIdx());
+            if (::mkdir(outputDir.c_str(), 0755) != 0 && errno != EEXIST)
+                throw std::runtime_error("Could not create output directory '"+outputDir+"':"
+                                         +strerror(errno));
+        }
+
         return outputDir;
     }
 
@@ -310,6 +413,14 @@ public:
 
         if (enableVtkOutput_())
             defaultVtkWriter_->gridChanged();
+#if HAVE_HDF5
+        if (hdf5Writer_)
+            hdf5Writer_->gridChanged();
+#endif
+        if (statisticsWriter_)
+            statisticsWriter_->gridChanged();
+        if (sharedMemoryWriter_)
+            sharedMemoryWriter_->gridChanged();
     }
 
     /*!
@@ -481,8 +592,12 @@ public:
                       << "\n"
                       << "------------------------ Timing ------------------------\n"
                       << "Setup time: " << setupTime << " seconds" << Simulator::humanReadableTime(setupTime)
-                      << ", " << setupTime/(executionTime + setupTime)*100 << "%\n"
-                      << "Simulation time: " << executionTime << " seconds" << Simulator::humanReadableTime(executionTime)
+                      << ", " << setupTime/(executionTime + setupTime)*100 << "%\n";
+            for (const auto& [phaseName, phaseTime] : simulator().setupPhaseTimes())
+                std::cout << "    " << phaseName << " time: " << phaseTime << " seconds"
+                          << Simulator::humanReadableTime(phaseTime)
+                          << ", " << phaseTime/setupTime*100 << "%\n";
+            std::cout << "Simulation time: " << executionTime << " seconds" << Simulator::humanReadableTime(executionTime)
                       << ", " << executionTime/(executionTime + setupTime)*100 << "%\n"
                       << "    Linearization time: " << linearizeTime << " seconds" << Simulator::humanReadableTime(linearizeTime)
                       << ", " << linearizeTime/executionTime*100 << "%\n"
@@ -502,6 +617,9 @@ public:
                       << "----------------------------------------------------------------\n"
                       << std::endl;
         }
+
+        if constexpr (HasSolverReport_<LinearSolverBackend>::value)
+            printLinearSolverReport_(model().newtonMethod().linearSolver().report());
     }
 
     /*!
@@ -516,8 +634,16 @@ public:
         std::string errorMessage;
         for (unsigned i = 0; i < maxFails; ++i) {
             bool converged = model().update();
-            if (converged)
+            if (converged) {
+                if (multirateTimeStepper_)
+                    multirateTimeStepper_->refine();
+
+                if (pidTimeStepController_)
+                    pidTimeStepSize_ =
+                        pidTimeStepController_->suggestTimeStepSize(simulator().timeStepSize(),
+                                                                    relativeSolutionChange_());
                 return;
+            }
 
             Scalar dt = simulator().timeStepSize();
             Scalar nextDt = dt / 2.0;
@@ -594,6 +720,8 @@ public:
 
         Scalar dtNext = std::min(Parameters::get<TypeTag, Properties::MaxTimeStepSize>(),
                                  newtonMethod().suggestTimeStepSize(simulator().timeStepSize()));
+        if (pidTimeStepController_ && pidTimeStepSize_ > 0.0)
+            dtNext = std::min(dtNext, pidTimeStepSize_);
 
         if (dtNext < simulator().maxTimeStepSize()
             && simulator().maxTimeStepSize() < dtNext*2)
@@ -755,6 +883,12 @@ public:
     {
         if (enableVtkOutput_())
             defaultVtkWriter_->serialize(res);
+#if HAVE_HDF5
+        if (hdf5Writer_)
+            hdf5Writer_->serialize(res);
+#endif
+        if (statisticsWriter_)
+            statisticsWriter_->serialize(res);
     }
 
     /*!
@@ -772,17 +906,32 @@ public:
     {
         if (enableVtkOutput_())
             defaultVtkWriter_->deserialize(res);
+#if HAVE_HDF5
+        if (hdf5Writer_)
+            hdf5Writer_->deserialize(res);
+#endif
+        if (statisticsWriter_)
+            statisticsWriter_->deserialize(res);
     }
 
     /*!
      * \brief Write the relevant secondary variables of the current
      *        solution into an VTK output file.
      *
+     * If the HDF5 output is enabled, the same fields are also written to HDF5. If the
+     * statistics output is enabled, the statistics of the fields are written as well,
+     * and if the shared memory output is enabled, the fields are streamed into shared
+     * memory.
+     *
      * \param verbose Specify if a message should be printed whenever a file is written
      */
     void writeOutput(bool verbose = true)
     {
-        if (!enableVtkOutput_())
+        bool enableHdf5Output = false;
+#if HAVE_HDF5
+        enableHdf5Output = static_cast<bool>(hdf5Writer_);
+#endif
+        if (!enableVtkOutput_() && !enableHdf5Output && !statisticsWriter_ && !sharedMemoryWriter_)
             return;
 
         if (verbose && gridView().comm().rank() == 0)
@@ -792,11 +941,38 @@ public:
         // calculate the time _after_ the time was updated
         Scalar t = simulator().time() + simulator().timeStepSize();
 
-        defaultVtkWriter_->beginWrite(t);
+        if (enableVtkOutput_())
+            defaultVtkWriter_->beginWrite(t);
+#if HAVE_HDF5
+        if (hdf5Writer_)
+            hdf5Writer_->beginWrite(t);
+#endif
+        if (statisticsWriter_)
+            statisticsWriter_->beginWrite(t);
+        if (sharedMemoryWriter_)
+            sharedMemoryWriter_->beginWrite(t);
+
+        model().outputPlan().beginStep();
         model().prepareOutputFields();
-        model().appendOutputFields(*defaultVtkWriter_);
-        defaultVtkWriter_->endWrite();
 
+        if (enableVtkOutput_()) {
+            model().appendOutputFields(*defaultVtkWriter_);
+            defaultVtkWriter_->endWrite();
+        }
+#if HAVE_HDF5
+        if (hdf5Writer_) {
+            model().appendOutputFields(*hdf5Writer_);
+            hdf5Writer_->endWrite();
+        }
+#endif
+        if (statisticsWriter_) {
+            model().appendOutputFields(*statisticsWriter_);
+            statisticsWriter_->endWrite();
+        }
+        if (sharedMemoryWriter_) {
+            model().appendOutputFields(*sharedMemoryWriter_);
+            sharedMemoryWriter_->endWrite();
+        }
     }
 
     /*!
@@ -810,9 +986,91 @@ protected:
     Scalar nextTimeStepSize_;
 
 private:
+    using LinearSolverBackend = GetPropType<TypeTag, Properties::LinearSolverBackend>;
+
+    template <class Backend, class = void>
+    struct HasSolverReport_ : std::false_type {};
+
+    template <class Backend>
+    struct HasSolverReport_<Backend, std::void_t<decltype(std::declval<const Backend&>().report())>>
+        : std::true_type {};
+
+    // print the breakdown of the time spent by the linear solver. the times are the
+    // maximum and the average over all processes, so a large difference between them
+    // indicates a load imbalance. this must be called by all processes.
+    template <class SolverReport>
+    void printLinearSolverReport_(const SolverReport& report) const
+    {
+        const auto& comm = gridView().comm();
+        if (comm.max(report.numSolves()) == 0)
+            return;
+
+        constexpr std::size_t numTimes = 5;
+        const std::array<std::pair<const char*, double>, numTimes> times = {{
+            {"Total", report.timer().realTimeElapsed()},
+            {"Preconditioner setup", report.preconditionerSetupTimer().realTimeElapsed()},
+            {"Preconditioner apply", report.preconditionerApplyTimer().realTimeElapsed()},
+            {"Matrix-vector products", report.spmvTimer().realTimeElapsed()},
+            {"Scalar products", report.dotTimer().realTimeElapsed()},
+        }};
+
+        std::array<double, numTimes> maxTimes;
+        std::array<double, numTimes> sumTimes;
+        for (std::size_t i = 0; i < numTimes; ++i)
+            maxTimes[i] = sumTimes[i] = times[i].second;
+        comm.max(maxTimes.data(), maxTimes.size());
+        comm.sum(sumTimes.data(), sumTimes.size());
+
+        if (comm.rank() != 0)
+            return;
+
+        const double numSolves = report.numSolves();
+        std::cout << std::setprecision(3)
+                  << "------------------------ Linear solver -------------------------\n"
+                  << "Solves: " << report.numSolves()
+                  << ", iterations: " << report.iterations()
+                  << " (" << report.iterations()/std::max(numSolves, 1.0) << " per solve)\n";
+        for (std::size_t i = 0; i < numTimes; ++i)
+            std::cout << "    " << times[i].first << " time: " << maxTimes[i]
+                      << " seconds (max), " << sumTimes[i]/comm.size() << " seconds (avg)\n";
+        std::cout << "----------------------------------------------------------------\n"
+                  << std::endl;
+    }
+
     bool enableVtkOutput_() const
     { return Parameters::get<TypeTag, Properties::EnableVtkOutput>(); }
 
+    // the maximum change of the primary variables during the last time step. The
+    // change of each primary variable is relative to the largest magnitude of that
+    // variable in the grid, so that pressures and saturations can be compared.
+    Scalar relativeSolutionChange_() const
+    {
+        const auto& solution = model().solution(/*timeIdx=*/0);
+        const auto& oldSolution = model().solution(/*timeIdx=*/1);
+
+        std::array<Scalar, 2*numEq> extrema{};
+        for (std::size_t dofIdx = 0; dofIdx < model().numGridDof(); ++dofIdx) {
+            // the cells which were integrated using sub-steps only need to change
+            // slowly during each sub-step
+            const Scalar numSubsteps = multirateTimeStepper_
+                ? multirateTimeStepper_->numSubsteps(static_cast<unsigned>(dofIdx))
+                : 1;
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+                const Scalar oldValue = oldSolution[dofIdx][pvIdx];
+                extrema[pvIdx] = std::max(extrema[pvIdx],
+                                          std::abs(solution[dofIdx][pvIdx] - oldValue)/numSubsteps);
+                extrema[numEq + pvIdx] = std::max(extrema[numEq + pvIdx], std::abs(oldValue));
+            }
+        }
+        gridView().comm().max(extrema.data(), extrema.size());
+
+        Scalar result = 0.0;
+        for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+            if (extrema[numEq + pvIdx] > 0.0)
+                result = std::max(result, extrema[pvIdx]/extrema[numEq + pvIdx]);
+        return result;
+    }
+
     //! Returns the implementation of the problem (i.e. static polymorphism)
     Implementation& asImp_()
     { return *static_cast<Implementation *>(this); }
@@ -831,6 +1089,19 @@ private:
     // Attributes required for the actual simulation
     Simulator& simulator_;
     mutable VtkMultiWriter *defaultVtkWriter_;
+#if HAVE_HDF5
+    using Hdf5Writer = Hdf5MultiWriter<GridView>;
+    std::unique_ptr<Hdf5Writer> hdf5Writer_;
+#endif
+    using StatisticsWriter = Opm::StatisticsWriter<GridView>;
+    std::unique_ptr<StatisticsWriter> statisticsWriter_;
+    using SharedMemoryWriter = Opm::SharedMemoryWriter<GridView>;
+    std::unique_ptr<SharedMemoryWriter> sharedMemoryWriter_;
+
+    // the PID time step control. only allocated if it is enabled
+    std::unique_ptr<PidTimeStepController<Scalar>> pidTimeStepController_;
+    std::unique_ptr<MultirateTimeStepper<TypeTag>> multirateTimeStepper_;
+    Scalar pidTimeStepSize_ = 0.0;
 };
 
 } // namespace Opm
@@ -191,6 +191,14 @@ template<class TypeTag, class MyTypeTag>
 struct ThreadManager { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct ThreadsPerProcess { using type = UndefinedProperty; };
+//! how the threads of a process are pinned to the CPU cores: 'none', 'compact',
+//! 'scatter' or an explicit comma separated list of core indices
+template<class TypeTag, class MyTypeTag>
+struct ThreadAffinity { using type = UndefinedProperty; };
+//! measure the busy times and the work items of the threads in the main parallel
+//! loops and print the load imbalance at the end of the simulation
+template<class TypeTag, class MyTypeTag>
+struct EnableThreadLoadStatistics { using type = UndefinedProperty; };
 
 //! use locking to prevent race conditions when linearizing the global system of
 //! equations in multi-threaded mode. (setting this property to true is always save, but
@@ -199,6 +207,12 @@ struct ThreadsPerProcess { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct UseLinearizationLock { using type = UndefinedProperty; };
 
+//! linearize the elements in groups ("colors") of elements which do not share any
+//! primary degree of freedom. this allows to add the local linearizations of the
+//! elements of a color to the global system in parallel without locking.
+template<class TypeTag, class MyTypeTag>
+struct ColoredElementAssembly { using type = UndefinedProperty; };
+
 // high-level simulation control
 
 /*!
@@ -237,6 +251,110 @@ struct EnableVtkOutput { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct EnableAsyncVtkOutput { using type = UndefinedProperty; };
 
+/*!
+ * \brief The number of threads which write the VTK output if it is written
+ *        asynchronously
+ */
+template<class TypeTag, class MyTypeTag>
+struct VtkOutputThreads { using type = UndefinedProperty; };
+
+/*!
+ * \brief The maximum number of time steps for which the VTK output is written
+ *        asynchronously at the same time
+ *
+ * If this is larger than 1, the simulation does not need to wait for the output of
+ * the previous time step to be finished before it can continue.
+ */
+template<class TypeTag, class MyTypeTag>
+struct VtkOutputQueueDepth { using type = UndefinedProperty; };
+
+/*!
+ * \brief The maximum amount of memory in MiB occupied by the data of the time steps
+ *        for which the VTK output is written asynchronously
+ */
+template<class TypeTag, class MyTypeTag>
+struct VtkOutputMemoryBudget { using type = UndefinedProperty; };
+
+/*!
+ * \brief The number of processes whose VTK pieces are combined into a single file
+ *
+ * A value of 1 lets each process write its own piece, 0 combines the pieces of the
+ * processes which share a node. The aggregation only applies to the compressed
+ * binary VTK format.
+ */
+template<class TypeTag, class MyTypeTag>
+struct VtkOutputAggregation { using type = UndefinedProperty; };
+
+/*!
+ * \brief Global switch to enable or disable the output to HDF5 files
+ *
+ * The HDF5 output contains the same fields as the VTK output. It is only available if
+ * the module has been compiled with HDF5 support.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableHdf5Output { using type = UndefinedProperty; };
+
+/*!
+ * \brief Write all time steps of the HDF5 output into a single file
+ *
+ * Otherwise, a separate file is written for each time step.
+ */
+template<class TypeTag, class MyTypeTag>
+struct Hdf5OutputSingleFile { using type = UndefinedProperty; };
+
+/*!
+ * \brief Global switch to enable or disable writing statistics of the output fields
+ *
+ * See Opm::StatisticsWriter for details.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableStatisticsOutput { using type = UndefinedProperty; };
+
+//! A comma separated list of the output fields for which statistics are written
+template<class TypeTag, class MyTypeTag>
+struct StatisticsOutputFields { using type = UndefinedProperty; };
+
+//! The name of the output field by which the volume is weighted for the statistics
+template<class TypeTag, class MyTypeTag>
+struct StatisticsWeightField { using type = UndefinedProperty; };
+
+//! The name of the output field which defines the regions of the statistics
+template<class TypeTag, class MyTypeTag>
+struct StatisticsRegionField { using type = UndefinedProperty; };
+
+//! The number of bins of the histograms of the statistics output
+template<class TypeTag, class MyTypeTag>
+struct StatisticsHistogramBins { using type = UndefinedProperty; };
+
+/*!
+ * \brief Global switch to enable or disable streaming the output fields into shared
+ *        memory
+ *
+ * See Opm::SharedMemoryWriter for details.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableSharedMemoryOutput { using type = UndefinedProperty; };
+
+//! The size of the shared memory segment of each process in MiB
+template<class TypeTag, class MyTypeTag>
+struct SharedMemoryOutputCapacity { using type = UndefinedProperty; };
+
+/*!
+ * \brief The intervals at which the output fields are written
+ *
+ * See Opm::OutputPlan for the format.
+ */
+template<class TypeTag, class MyTypeTag>
+struct OutputFieldIntervals { using type = UndefinedProperty; };
+
+/*!
+ * \brief The box of the spatial domain which is considered by the output
+ *
+ * See Opm::OutputPlan for the format.
+ */
+template<class TypeTag, class MyTypeTag>
+struct OutputRegionOfInterest { using type = UndefinedProperty; };
+
 /*!
  * \brief Specify the format the VTK output is written to disk
  *
@@ -245,10 +363,20 @@ struct EnableAsyncVtkOutput { using type = UndefinedProperty; };
  *   - Dune::VTK::base64
  *   - Dune::VTK::appendedraw
  *   - Dune::VTK::appendedbase64
+ *   - Opm::vtkCompressedAppendedFormat (compressed binary data, the grid is only
+ *     encoded once for all time steps)
  */
 template<class TypeTag, class MyTypeTag>
 struct VtkOutputFormat { using type = UndefinedProperty; };
 
+/*!
+ * \brief Specify the format of the VTK files written for the Newton convergence.
+ *
+ * The possible values are the same as for VtkOutputFormat.
+ */
+template<class TypeTag, class MyTypeTag>
+struct VtkConvergenceOutputFormat { using type = UndefinedProperty; };
+
 //! Specify whether the some degrees of fredom can be constraint
 template<class TypeTag, class MyTypeTag>
 struct EnableConstraints { using type = UndefinedProperty; };
@@ -284,6 +412,35 @@ struct MaxTimeStepDivisions { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct ContinueOnConvergenceError { using type = UndefinedProperty; };
 
+/*!
+ * \brief The strategy used to choose the size of the next time step.
+ *
+ * Possible values are 'iterations' (control the number of Newton iterations) and
+ * 'pid' (additionally control the relative change of the solution per time step by a
+ * PID controller).
+ */
+template<class TypeTag, class MyTypeTag>
+struct TimeStepControl { using type = UndefinedProperty; };
+
+//! The relative change of the solution per time step which is targeted by the PID
+//! time step control.
+template<class TypeTag, class MyTypeTag>
+struct TimeStepControlTolerance { using type = UndefinedProperty; };
+
+//! The number of sub-steps used for the cells with fast dynamics by the multirate time
+//! integration, see Opm::MultirateTimeStepper. Values smaller than 2 disable it.
+template<class TypeTag, class MyTypeTag>
+struct MultirateSubsteps { using type = UndefinedProperty; };
+
+//! The relative change of a primary variable of a cell within a time step above which
+//! the cell is integrated using sub-steps.
+template<class TypeTag, class MyTypeTag>
+struct MultirateTolerance { using type = UndefinedProperty; };
+
+//! The number of layers of neighbors which are added to the cells with fast dynamics.
+template<class TypeTag, class MyTypeTag>
+struct MultirateBufferLayers { using type = UndefinedProperty; };
+
 /*!
  * \brief Specify whether all intensive quantities for the grid should be
  *        cached in the discretization.
@@ -296,6 +453,79 @@ struct ContinueOnConvergenceError { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct EnableIntensiveQuantityCache { using type = UndefinedProperty; };
 
+/*!
+ * \brief Ask the operating system to back large arrays like the intensive quantity
+ *        cache by transparent huge pages.
+ *
+ * This reduces the number of TLB misses when these arrays are traversed.
+ */
+template<class TypeTag, class MyTypeTag>
+struct LargeArrayHugePages { using type = UndefinedProperty; };
+
+/*!
+ * \brief Interleave the pages of large arrays like the intensive quantity cache
+ *        between all NUMA nodes.
+ *
+ * If this is disabled, the pages are placed on the NUMA node of the thread which
+ * touches them first.
+ */
+template<class TypeTag, class MyTypeTag>
+struct LargeArrayNumaInterleave { using type = UndefinedProperty; };
+
+/*!
+ * \brief The relative change of the primary variables of a degree of freedom below
+ *        which its cached intensive quantities are not updated between Newton
+ *        iterations.
+ *
+ * A value of zero or less means that all intensive quantities are always updated.
+ */
+template<class TypeTag, class MyTypeTag>
+struct IntensiveQuantityUpdateTolerance { using type = UndefinedProperty; };
+
+/*!
+ * \brief Keep a copy of the intensive quantities at the start of each time step.
+ *
+ * If a time integration fails, the copy is restored instead of recomputing the
+ * intensive quantities for the solution of the previous time step. This requires the
+ * intensive quantity cache to be enabled.
+ */
+template<class TypeTag, class MyTypeTag>
+struct KeepStartOfStepIntensiveQuantities { using type = UndefinedProperty; };
+
+/*!
+ * \brief Receive the intensive quantities of the overlap and ghost degrees of freedom
+ *        from their master processes instead of computing them locally.
+ *
+ * This requires the intensive quantity cache to be enabled and intensive quantities
+ * which can be copied bytewise. It is only available for the element-centered finite
+ * volume discretization on grids which are not adapted.
+ */
+template<class TypeTag, class MyTypeTag>
+struct ExchangeOverlapIntensiveQuantities { using type = UndefinedProperty; };
+
+/*!
+ * \brief The OpenMP schedule used to update the intensive quantities of all degrees
+ *        of freedom.
+ *
+ * "dynamic" hands out the elements to the threads in the order of the grid.
+ * "static" and "guided" instead split the range of degrees of freedom into tiles
+ * which are distributed using the respective OpenMP schedule. The latter two are only
+ * available for the element-centered finite volume discretization.
+ */
+template<class TypeTag, class MyTypeTag>
+struct IntensiveQuantityUpdateSchedule { using type = UndefinedProperty; };
+
+/*!
+ * \brief Specify whether the degrees of freedom of each tile are grouped by their
+ *        regions when the intensive quantities are updated in tiles.
+ *
+ * The regions are defined by the model, e.g., by the PVT and saturation function
+ * regions for the black-oil model. Grouping them lets consecutive updates use the same
+ * tables.
+ */
+template<class TypeTag, class MyTypeTag>
+struct SortIntensiveQuantityUpdateByRegion { using type = UndefinedProperty; };
+
 /*!
  * \brief Specify whether the storage terms for previous solutions should be cached.
  *
@@ -305,6 +535,39 @@ struct EnableIntensiveQuantityCache { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct EnableStorageCache { using type = UndefinedProperty; };
 
+/*!
+ * \brief Specify whether the storage terms of the converged solution of a time step
+ *        are kept as the storage terms at the start of the next one.
+ *
+ * The storage terms of the converged solution are computed by its last linearization.
+ * If they are kept, the first Newton iteration of the next time step does not need to
+ * compute the storage terms of the previous solution. This requires the storage cache
+ * to be enabled.
+ */
+template<class TypeTag, class MyTypeTag>
+struct KeepConvergedStorage { using type = UndefinedProperty; };
+
+/*!
+ * \brief Specify whether element contexts refer to the cached intensive quantities
+ *        instead of copying them.
+ *
+ * The intensive quantities of a degree of freedom are only copied into the context
+ * once they are modified, e.g., when they are deflected by the finite difference
+ * linearizer. This only has an effect if the intensive quantity cache is enabled.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableIntensiveQuantityViews { using type = UndefinedProperty; };
+
+/*!
+ * \brief Specify whether the geometry of the stencils of all elements is computed once
+ *        for each grid instead of each time an element context is updated.
+ *
+ * This reduces the CPU time of the linearization at the cost of memory. It only has an
+ * effect for discretizations whose stencils support this.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableStencilCache { using type = UndefinedProperty; };
+
 /*!
  * \brief Specify whether to use the already calculated solutions as
  *        starting values of the intensive quantities.
@@ -0,0 +1,355 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::MultirateTimeStepper
+ */
+#ifndef EWOMS_MULTIRATE_TIME_STEPPER_HH
+#define EWOMS_MULTIRATE_TIME_STEPPER_HH
+
+#include "fvbaseproperties.hh"
+
+#include <opm/models/nonlinear/nonlineardomainsolver.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Integrates the regions of the grid with fast dynamics using smaller time
+ *        steps than the rest of the domain.
+ *
+ * After the time step has been solved for the whole grid, the cells in which a
+ * primary variable changed by more than a tolerance relative to the largest magnitude
+ * of this variable are selected, together with a few layers of their neighbors. These
+ * cells are then integrated once more, starting from the solution of the previous
+ * time step, using a fixed number of equally sized sub-steps. Each sub-step is solved
+ * by local Newton iterations on the selected cells (see
+ * NonlinearDomainSolver::solveDomain()) while all other cells keep the solution of
+ * the large step. If one of the sub-steps does not converge, the solution of the
+ * large step is kept.
+ *
+ * The intention is that the size of the time steps is controlled by the slow part of
+ * the domain: the PID time step control of FvBaseProblem divides the change of the
+ * solution of the refined cells by the number of sub-steps. Note that the exchange of
+ * mass across the boundary of the refined region is only balanced up to the
+ * difference of the solutions of the large step and the sub-steps, which is why a
+ * buffer of cells with slow dynamics is included in the refined region.
+ *
+ * This requires a linearizer which accepts sub-domains given by their cells, i.e.,
+ * the TpfaLinearizer, and the intensive quantity cache. It is only available for
+ * sequential runs.
+ */
+template <class TypeTag>
+class MultirateTimeStepper
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using Linearizer = GetPropType<TypeTag, Properties::Linearizer>;
+    using LocalResidual = GetPropType<TypeTag, Properties::LocalResidual>;
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
+    using EqVector = GetPropType<TypeTag, Properties::EqVector>;
+
+    using DomainSolver = NonlinearDomainSolver<TypeTag>;
+    using Domain = typename DomainSolver::Domain;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+
+public:
+    explicit MultirateTimeStepper(Simulator& simulator)
+        : simulator_(simulator)
+        , domainSolver_(simulator)
+    {
+        numSubsteps_ = Parameters::get<TypeTag, Properties::MultirateSubsteps>();
+        tolerance_ = Parameters::get<TypeTag, Properties::MultirateTolerance>();
+        numBufferLayers_ = Parameters::get<TypeTag, Properties::MultirateBufferLayers>();
+        maxIterations_ = Parameters::get<TypeTag, Properties::NewtonMaxIterations>();
+
+        if (numSubsteps_ > 1) {
+            if (!hasCellDomainLinearization_())
+                throw std::invalid_argument("Multirate time integration requires a linearizer "
+                                            "which accepts sub-domains, i.e., the TpfaLinearizer");
+            if (!(tolerance_ > 0.0))
+                throw std::invalid_argument("The tolerance of the multirate time integration "
+                                            "must be positive");
+            if (simulator.gridView().comm().size() > 1 && simulator.gridView().comm().rank() == 0)
+                std::cout << "Multirate time integration is only available for sequential "
+                          << "runs and is disabled\n" << std::flush;
+        }
+    }
+
+    /*!
+     * \brief Register all run-time parameters of the multirate time integration.
+     */
+    static void registerParameters()
+    {
+        Parameters::registerParam<TypeTag, Properties::MultirateSubsteps>
+            ("The number of sub-steps which are used for the cells with fast dynamics. "
+             "Values smaller than 2 disable the multirate time integration");
+        Parameters::registerParam<TypeTag, Properties::MultirateTolerance>
+            ("The change of a primary variable of a cell within a time step, relative "
+             "to the largest magnitude of the variable, above which the cell is "
+             "integrated using sub-steps");
+        Parameters::registerParam<TypeTag, Properties::MultirateBufferLayers>
+            ("The number of layers of neighboring cells which are added to the cells "
+             "integrated using sub-steps");
+    }
+
+    /*!
+     * \brief Returns true if the multirate time integration is used.
+     */
+    bool enabled() const
+    { return numSubsteps_ > 1 && simulator_.gridView().comm().size() == 1; }
+
+    /*!
+     * \brief Returns the number of sub-steps used for a degree of freedom in the last
+     *        time step.
+     */
+    int numSubsteps(unsigned dofIdx) const
+    { return (dofIdx < refined_.size() && refined_[dofIdx]) ? numSubsteps_ : 1; }
+
+    /*!
+     * \brief Returns the number of degrees of freedom which were integrated using
+     *        sub-steps in the last time step.
+     */
+    std::size_t numRefinedDofs() const
+    { return domain_.cells.size(); }
+
+    /*!
+     * \brief Integrate the cells with fast dynamics once more using sub-steps.
+     *
+     * This must be called after the current time step has been solved for the whole
+     * grid and before the model advances to the next time level. Returns true if the
+     * solution of some cells was replaced by the one of the sub-steps.
+     */
+    bool refine()
+    {
+        domain_.cells.clear();
+        domain_.interior.clear();
+        refined_.clear();
+
+        if (!enabled())
+            return false;
+
+        if constexpr (hasCellDomainLinearization_()) {
+            selectCells_();
+            if (domain_.cells.empty())
+                return false;
+
+            if (integrateSubsteps_())
+                return true;
+
+            if (simulator_.gridView().comm().rank() == 0)
+                std::cout << "Sub-steps of " << domain_.cells.size() << " cells did not "
+                          << "converge. Keeping the solution of the time step\n" << std::flush;
+            domain_.cells.clear();
+            domain_.interior.clear();
+            refined_.clear();
+        }
+
+        return false;
+    }
+
+private:
+    // select the cells whose solution changed by more than the tolerance and add the
+    // requested number of layers of neighbors
+    void selectCells_()
+    {
+        const auto& model = simulator_.model();
+        const auto& solution = model.solution(/*timeIdx=*/0);
+        const auto& oldSolution = model.solution(/*timeIdx=*/1);
+        const std::size_t numDof = model.numGridDof();
+
+        std::array<Scalar, numEq> scale{};
+        for (std::size_t dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                scale[pvIdx] = std::max<Scalar>(scale[pvIdx], std::abs(oldSolution[dofIdx][pvIdx]));
+
+        refined_.assign(numDof, 0);
+        for (std::size_t dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+                const Scalar change = std::abs(solution[dofIdx][pvIdx] - oldSolution[dofIdx][pvIdx]);
+                if (scale[pvIdx] > 0.0 && change > tolerance_*scale[pvIdx]) {
+                    refined_[dofIdx] = 1;
+                    break;
+                }
+            }
+        }
+
+        // the auxiliary degrees of freedom, e.g., the ones of wells, are never refined
+        const auto& jacobian = model.linearizer().jacobian().istlMatrix();
+        std::vector<unsigned> layer;
+        for (int layerIdx = 0; layerIdx < numBufferLayers_; ++layerIdx) {
+            layer.clear();
+            for (std::size_t dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+                if (!refined_[dofIdx])
+                    continue;
+
+                const auto& row = jacobian[dofIdx];
+                for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                    if (colIt.index() < numDof && !refined_[colIt.index()])
+                        layer.push_back(static_cast<unsigned>(colIt.index()));
+            }
+            for (unsigned dofIdx : layer)
+                refined_[dofIdx] = 1;
+        }
+
+        for (std::size_t dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            if (refined_[dofIdx])
+                domain_.cells.push_back(static_cast<int>(dofIdx));
+        domain_.interior.assign(domain_.cells.size(), true);
+    }
+
+    // integrate the selected cells from the previous time step using sub-steps. The
+    // solution of the previous time step is temporarily replaced by the one at the
+    // beginning of each sub-step.
+    bool integrateSubsteps_()
+    {
+        auto& model = simulator_.model();
+        auto& solution = model.solution(/*timeIdx=*/0);
+        auto& oldSolution = model.solution(/*timeIdx=*/1);
+        const auto& cells = domain_.cells;
+        const std::size_t numCells = cells.size();
+        const bool storageCache = model.enableStorageCache();
+
+        std::vector<PrimaryVariables> coarseSolution(numCells);
+        std::vector<PrimaryVariables> startSolution(numCells);
+        std::vector<IntensiveQuantities> startIntQuants;
+        std::vector<EqVector> startStorage;
+        if (storageCache)
+            startStorage.resize(numCells);
+        const bool oldIntQuantsCached = model.cachedIntensiveQuantities(cells[0], /*timeIdx=*/1);
+        if (oldIntQuantsCached)
+            startIntQuants.reserve(numCells);
+
+        for (std::size_t i = 0; i < numCells; ++i) {
+            const unsigned globI = static_cast<unsigned>(cells[i]);
+            coarseSolution[i] = solution[globI];
+            startSolution[i] = oldSolution[globI];
+            if (storageCache)
+                startStorage[i] = model.cachedStorage(globI, /*timeIdx=*/1);
+            if (oldIntQuantsCached)
+                startIntQuants.push_back(*model.cachedIntensiveQuantities(globI, /*timeIdx=*/1));
+
+            solution[globI] = oldSolution[globI];
+        }
+        model.updateIntensiveQuantitiesOfDofs(cells, /*timeIdx=*/0);
+
+        localMatrix_ = domainSolver_.createLocalMatrix(domain_);
+
+        const Scalar dt = simulator_.timeStepSize();
+        simulator_.setTimeStepSize(dt/numSubsteps_);
+
+        bool converged = true;
+        auto& newtonMethod = model.newtonMethod();
+        for (int substepIdx = 0; substepIdx < numSubsteps_ && converged; ++substepIdx) {
+            // the current solution of the selected cells becomes the one at the
+            // beginning of the sub-step
+            for (int globI : cells) {
+                const IntensiveQuantities* intQuants =
+                    model.cachedIntensiveQuantities(static_cast<unsigned>(globI), /*timeIdx=*/0);
+                if (!intQuants)
+                    throw std::logic_error("Multirate time integration requires the "
+                                           "intensive quantity cache");
+
+                oldSolution[globI] = solution[globI];
+                if (oldIntQuantsCached)
+                    model.updateCachedIntensiveQuantities(*intQuants, globI, /*timeIdx=*/1);
+                if (storageCache) {
+                    EqVector storage;
+                    LocalResidual::computeStorage(storage, *intQuants);
+                    model.updateCachedStorage(globI, /*timeIdx=*/1, storage);
+                }
+            }
+
+            converged = domainSolver_.solveDomain(domain_,
+                                                  *localMatrix_,
+                                                  newtonMethod.tolerance(),
+                                                  maxIterations_,
+                                                  newtonMethod.primaryVariablesUpdater());
+        }
+
+        // restore the previous time step
+        simulator_.setTimeStepSize(dt);
+        for (std::size_t i = 0; i < numCells; ++i) {
+            const unsigned globI = static_cast<unsigned>(cells[i]);
+            oldSolution[globI] = startSolution[i];
+            if (storageCache)
+                model.updateCachedStorage(globI, /*timeIdx=*/1, startStorage[i]);
+            if (oldIntQuantsCached)
+                model.updateCachedIntensiveQuantities(startIntQuants[i], globI, /*timeIdx=*/1);
+
+            if (!converged)
+                solution[globI] = coarseSolution[i];
+        }
+
+        if (!converged)
+            model.updateIntensiveQuantitiesOfDofs(cells, /*timeIdx=*/0);
+
+        return converged;
+    }
+
+    // the sub-steps require a linearizer which accepts sub-domains that are given by
+    // their cells
+    template <class LinearizerType>
+    static auto detectCellDomainLinearization_(int)
+        -> decltype(std::declval<typename LinearizerType::CellDomain&>().cells, std::true_type{});
+
+    template <class LinearizerType>
+    static std::false_type detectCellDomainLinearization_(long);
+
+    static constexpr bool hasCellDomainLinearization_()
+    { return decltype(detectCellDomainLinearization_<Linearizer>(0))::value; }
+
+    Simulator& simulator_;
+    DomainSolver domainSolver_;
+
+    int numSubsteps_;
+    Scalar tolerance_;
+    int numBufferLayers_;
+    int maxIterations_;
+
+    Domain domain_;
+    std::unique_ptr<typename DomainSolver::LocalMatrix> localMatrix_;
+    // 1 for the degrees of freedom which were integrated using sub-steps
+    std::vector<unsigned char> refined_;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,393 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::TpfaFlowTable
+ */
+#ifndef TPFA_FLOW_TABLE_HH
+#define TPFA_FLOW_TABLE_HH
+
+#include <dune/common/fvector.hh>
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief The flows and flores over the faces of the TPFA linearizer which are
+ *        requested for output.
+ *
+ * The values of an interior face are stored only once, oriented from the cell with
+ * the lower index to the one with the higher index, and they are negated when they
+ * are read from the side of the other cell. Only the faces of requested cells and
+ * the NNCs of the output get a storage slot, and the values can optionally be held
+ * in single precision. For reading, the table presents each quantity as a sparse
+ * table of FlowInfo records with one row per cell.
+ *
+ * The layout is created by calling beginRow(), addInteriorFace() and
+ * addBoundaryFace() for each cell in the order of the cell indices, followed by
+ * endRow(). Afterwards, the values of the faces can be set concurrently by the cells
+ * which own their slots.
+ */
+template <class Scalar, int numEq>
+class TpfaFlowTable
+{
+public:
+    using VectorBlock = Dune::FieldVector<Scalar, numEq>;
+
+    //! The indices of the quantities which can be stored
+    enum { flowsIdx = 0, floresIdx = 1, numQuantities = 2 };
+
+    //! The face id which marks the NNCs of the output
+    static constexpr int nncFaceId = -2;
+
+    //! The slot of the faces which are not stored
+    static constexpr unsigned noSlot = std::numeric_limits<unsigned>::max();
+
+    //! The flow over a face out of a cell as it is presented to the output
+    struct FlowInfo
+    {
+        int faceId;
+        VectorBlock flow;
+        unsigned int nncId;
+    };
+
+private:
+    static constexpr unsigned reversedBit = 1u << 31;
+
+    struct Entry_
+    {
+        int faceId;
+        unsigned int nncId;
+        unsigned slot; // the highest bit is set if the values must be negated
+    };
+
+public:
+    /*!
+     * \brief The rows of one quantity of the table.
+     */
+    class Row
+    {
+    public:
+        class iterator
+        {
+        public:
+            iterator(const Row& row, std::size_t pos)
+                : row_(&row), pos_(pos)
+            {}
+
+            FlowInfo operator*() const
+            { return row_->info_(pos_); }
+
+            iterator& operator++()
+            { ++pos_; return *this; }
+
+            bool operator==(const iterator& other) const
+            { return pos_ == other.pos_; }
+
+            bool operator!=(const iterator& other) const
+            { return pos_ != other.pos_; }
+
+        private:
+            const Row* row_;
+            std::size_t pos_;
+        };
+
+        Row(const TpfaFlowTable& table, unsigned quantityIdx, std::size_t begin, std::size_t end)
+            : table_(table), quantityIdx_(quantityIdx), begin_(begin), end_(end)
+        {}
+
+        std::size_t size() const
+        { return end_ - begin_; }
+
+        bool empty() const
+        { return begin_ == end_; }
+
+        FlowInfo operator[](std::size_t idx) const
+        {
+            assert(idx < size());
+            return info_(begin_ + idx);
+        }
+
+        iterator begin() const
+        { return iterator(*this, begin_); }
+
+        iterator end() const
+        { return iterator(*this, end_); }
+
+    private:
+        FlowInfo info_(std::size_t pos) const
+        {
+            const Entry_& entry = table_.entries_[pos];
+            FlowInfo result{entry.faceId, VectorBlock(0.0), entry.nncId};
+            table_.get_(quantityIdx_, entry.slot & ~reversedBit, result.flow);
+            if (entry.slot & reversedBit)
+                result.flow *= -1.0;
+            return result;
+        }
+
+        const TpfaFlowTable& table_;
+        unsigned quantityIdx_;
+        std::size_t begin_;
+        std::size_t end_;
+    };
+
+    /*!
+     * \brief A quantity of the table, accessed like a sparse table of FlowInfo records.
+     *
+     * The view is empty if the quantity has not been allocated.
+     */
+    class View
+    {
+    public:
+        View(const TpfaFlowTable& table, unsigned quantityIdx)
+            : table_(table), quantityIdx_(quantityIdx)
+        {}
+
+        bool empty() const
+        { return !table_.hasQuantity(quantityIdx_); }
+
+        std::size_t size() const
+        { return empty() ? 0 : table_.numRows(); }
+
+        Row operator[](std::size_t row) const
+        { return Row(table_, quantityIdx_, table_.rowStart_[row], table_.rowStart_[row + 1]); }
+
+    private:
+        const TpfaFlowTable& table_;
+        unsigned quantityIdx_;
+    };
+
+    TpfaFlowTable()
+        : rowStart_(1, 0)
+        , boundaryStart_(1, 0)
+    {}
+
+    /*!
+     * \brief Remove the layout and the values of all quantities.
+     */
+    void clear()
+    {
+        rowStart_.assign(1, 0);
+        boundaryStart_.assign(1, 0);
+        entries_.clear();
+        connectionSlot_.clear();
+        boundarySlot_.clear();
+        numSlots_ = 0;
+        for (unsigned q = 0; q < numQuantities; ++q) {
+            values_[q].clear();
+            floatValues_[q].clear();
+            allocated_[q] = false;
+        }
+    }
+
+    /*!
+     * \brief Start a new layout for a neighbor table with a given number of connections.
+     */
+    void beginLayout(std::size_t numConnections, bool singlePrecision)
+    {
+        clear();
+        singlePrecision_ = singlePrecision;
+        connectionSlot_.assign(numConnections, noSlot);
+    }
+
+    /*!
+     * \brief Start the row of the next cell.
+     *
+     * If the cell is not requested, only its NNCs are stored.
+     */
+    void beginRow(bool requested)
+    { rowRequested_ = requested; }
+
+    /*!
+     * \brief Add an interior face to the current row.
+     *
+     * 'pos' and 'oppositePos' are the positions of the connection in both directions
+     * in the neighbor table and 'isLowerCell' states whether the cell of the row has
+     * a lower index than its neighbor.
+     */
+    void addInteriorFace(std::size_t pos, std::size_t oppositePos, bool isLowerCell,
+                         int faceId, unsigned int nncId)
+    {
+        if (!rowRequested_ && faceId != nncFaceId)
+            return;
+
+        const std::size_t ownerPos = isLowerCell ? pos : oppositePos;
+        if (connectionSlot_[ownerPos] == noSlot)
+            connectionSlot_[ownerPos] = numSlots_++;
+        entries_.push_back(Entry_{faceId, nncId,
+                                  connectionSlot_[ownerPos] | (isLowerCell ? 0u : reversedBit)});
+    }
+
+    /*!
+     * \brief Add the next boundary face to the current row.
+     */
+    void addBoundaryFace(int faceId)
+    {
+        if (!rowRequested_) {
+            boundarySlot_.push_back(noSlot);
+            return;
+        }
+        boundarySlot_.push_back(numSlots_++);
+        entries_.push_back(Entry_{faceId, 0, boundarySlot_.back()});
+    }
+
+    /*!
+     * \brief Finish the row of the current cell.
+     */
+    void endRow()
+    {
+        rowStart_.push_back(entries_.size());
+        boundaryStart_.push_back(boundarySlot_.size());
+    }
+
+    /*!
+     * \brief Returns true if no layout has been created.
+     */
+    bool empty() const
+    { return rowStart_.size() == 1; }
+
+    /*!
+     * \brief Returns the number of rows, i.e., cells of the table.
+     */
+    std::size_t numRows() const
+    { return rowStart_.size() - 1; }
+
+    /*!
+     * \brief Allocate the values of a quantity if this has not been done yet.
+     */
+    void allocate(unsigned quantityIdx)
+    {
+        if (hasQuantity(quantityIdx))
+            return;
+        if (singlePrecision_)
+            floatValues_[quantityIdx].assign(static_cast<std::size_t>(numSlots_)*numEq, 0.0f);
+        else
+            values_[quantityIdx].assign(static_cast<std::size_t>(numSlots_)*numEq, 0.0);
+        allocated_[quantityIdx] = true;
+    }
+
+    /*!
+     * \brief Returns true if the values of a quantity have been allocated.
+     */
+    bool hasQuantity(unsigned quantityIdx) const
+    { return allocated_[quantityIdx]; }
+
+    /*!
+     * \brief Returns the slot of the interior face at a position of the neighbor table.
+     *
+     * Only the position which belongs to the cell with the lower index has a slot,
+     * noSlot is returned for the opposite direction and for faces which are not stored.
+     */
+    unsigned connectionSlot(std::size_t pos) const
+    { return connectionSlot_.empty() ? noSlot : connectionSlot_[pos]; }
+
+    /*!
+     * \brief Returns the slot of a boundary face of a cell.
+     */
+    unsigned boundarySlot(unsigned cell, unsigned bfIdx) const
+    {
+        if (empty())
+            return noSlot;
+        const std::size_t pos = boundaryStart_[cell] + bfIdx;
+        return pos < boundaryStart_[cell + 1] ? boundarySlot_[pos] : noSlot;
+    }
+
+    /*!
+     * \brief Set the values of a quantity for a slot.
+     *
+     * The values must be oriented away from the cell which owns the slot.
+     */
+    template <class Values>
+    void set(unsigned quantityIdx, unsigned slot, const Values& values)
+    {
+        assert(slot < numSlots_);
+        const std::size_t offset = static_cast<std::size_t>(slot)*numEq;
+        if (singlePrecision_) {
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                floatValues_[quantityIdx][offset + eqIdx] = static_cast<float>(values[eqIdx]);
+        }
+        else {
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                values_[quantityIdx][offset + eqIdx] = values[eqIdx];
+        }
+    }
+
+    /*!
+     * \brief Returns a quantity of the table as a sparse table of FlowInfo records.
+     */
+    View view(unsigned quantityIdx) const
+    { return View(*this, quantityIdx); }
+
+    /*!
+     * \brief Returns the number of bytes which are allocated by the table.
+     */
+    std::size_t memoryUsage() const
+    {
+        std::size_t result = rowStart_.capacity()*sizeof(std::size_t)
+            + boundaryStart_.capacity()*sizeof(std::size_t)
+            + entries_.capacity()*sizeof(Entry_)
+            + connectionSlot_.capacity()*sizeof(unsigned)
+            + boundarySlot_.capacity()*sizeof(unsigned);
+        for (unsigned q = 0; q < numQuantities; ++q)
+            result += values_[q].capacity()*sizeof(Scalar) + floatValues_[q].capacity()*sizeof(float);
+        return result;
+    }
+
+private:
+    void get_(unsigned quantityIdx, unsigned slot, VectorBlock& values) const
+    {
+        const std::size_t offset = static_cast<std::size_t>(slot)*numEq;
+        if (singlePrecision_) {
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                values[eqIdx] = floatValues_[quantityIdx][offset + eqIdx];
+        }
+        else {
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                values[eqIdx] = values_[quantityIdx][offset + eqIdx];
+        }
+    }
+
+    std::vector<std::size_t> rowStart_;
+    std::vector<std::size_t> boundaryStart_;
+    std::vector<Entry_> entries_;
+    std::vector<unsigned> connectionSlot_;
+    std::vector<unsigned> boundarySlot_;
+    unsigned numSlots_ = 0;
+    bool rowRequested_ = true;
+    bool singlePrecision_ = false;
+    std::array<std::vector<Scalar>, numQuantities> values_;
+    std::array<std::vector<float>, numQuantities> floatValues_;
+    std::array<bool, numQuantities> allocated_{};
+};
+
+} // namespace Opm
+
+#endif // TPFA_FLOW_TABLE_HH
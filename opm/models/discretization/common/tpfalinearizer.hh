@@ -30,29 +30,47 @@
 
 #include "fvbaseproperties.hh"
 #include "linearizationtype.hh"
+#include "tpfaflowtable.hh"
+#include "tpfaneighbortable.hh"
 
 #include <opm/common/Exceptions.hpp>
 #include <opm/common/TimingMacros.hpp>
 
-#include <opm/grid/utility/SparseTable.hpp>
-
 #include <opm/input/eclipse/EclipseState/Grid/FaceDir.hpp>
 #include <opm/input/eclipse/Schedule/BCProp.hpp>
 
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
+#include <opm/models/discretization/common/basesparsesourceterm.hh>
+#include <opm/models/parallel/threadedentityiterator.hh>
+#include <opm/models/parallel/threadloadstatistics.hh>
+#include <opm/models/utils/autotuner.hh>
+#include <opm/models/utils/cellordering.hh>
+#include <opm/models/utils/memoryusage.hh>
+#include <opm/models/utils/prefetch.hh>
+#include <opm/models/utils/regionprofiler.hh>
 
 #include <dune/common/version.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
 #include <type_traits>
 #include <iostream>
 #include <vector>
 #include <thread>
 #include <set>
 #include <exception>   // current_exception, rethrow_exception
+#include <limits>
+#include <memory>
 #include <mutex>
 #include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
 
 namespace Opm::Properties {
     template<class TypeTag, class MyTypeTag>
@@ -60,6 +78,42 @@ namespace Opm::Properties {
         using type = bool;
         static constexpr type value = false;
     };
+
+    template<class TypeTag, class MyTypeTag>
+    struct FaceBasedFluxAssembly {
+        using type = bool;
+        static constexpr type value = false;
+    };
+
+    template<class TypeTag, class MyTypeTag>
+    struct OffloadFluxAssembly {
+        using type = bool;
+        static constexpr type value = false;
+    };
+
+    template<class TypeTag, class MyTypeTag>
+    struct ReorderCells {
+        using type = bool;
+        static constexpr type value = false;
+    };
+
+    template<class TypeTag, class MyTypeTag>
+    struct IntensiveQuantitiesPrefetchDistance {
+        using type = unsigned;
+        static constexpr type value = 1;
+    };
+
+    template<class TypeTag, class MyTypeTag>
+    struct AdaptiveImplicitCflThreshold {
+        using type = GetPropType<TypeTag, Scalar>;
+        static constexpr type value = 0.0;
+    };
+
+    template<class TypeTag, class MyTypeTag>
+    struct FlowsInSinglePrecision {
+        using type = bool;
+        static constexpr type value = false;
+    };
 }
 
 namespace Opm {
@@ -96,6 +150,7 @@ class TpfaLinearizer
     using Stencil = GetPropType<TypeTag, Properties::Stencil>;
     using LocalResidual = GetPropType<TypeTag, Properties::LocalResidual>;
     using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
@@ -118,11 +173,24 @@ class TpfaLinearizer
 //! \endcond
 
 public:
+    //! A sub-domain which is given by the indices of its cells, see linearizeDomain()
+    struct CellDomain
+    {
+        std::vector<int> cells;
+        std::vector<bool> interior;
+    };
+
     TpfaLinearizer()
         : jacobian_()
     {
         simulatorPtr_ = 0;
         separateSparseSourceTerms_ = Parameters::get<TypeTag, Properties::SeparateSparseSourceTerms>();
+        faceBasedFluxAssembly_ = Parameters::get<TypeTag, Properties::FaceBasedFluxAssembly>();
+        offloadFluxAssembly_ = Parameters::get<TypeTag, Properties::OffloadFluxAssembly>();
+        reorderCells_ = Parameters::get<TypeTag, Properties::ReorderCells>();
+        prefetchDistance_ = Parameters::get<TypeTag, Properties::IntensiveQuantitiesPrefetchDistance>();
+        aimCflThreshold_ = Parameters::get<TypeTag, Properties::AdaptiveImplicitCflThreshold>();
+        flowsInSinglePrecision_ = Parameters::get<TypeTag, Properties::FlowsInSinglePrecision>();
     }
 
     ~TpfaLinearizer()
@@ -136,6 +204,21 @@ public:
     {
         Parameters::registerParam<TypeTag, Properties::SeparateSparseSourceTerms>
             ("Treat well source terms all in one go, instead of on a cell by cell basis.");
+        Parameters::registerParam<TypeTag, Properties::FaceBasedFluxAssembly>
+            ("Assemble the flux terms by looping over colored faces instead of over the cells.");
+        Parameters::registerParam<TypeTag, Properties::OffloadFluxAssembly>
+            ("Compute the flux terms on an accelerator device using OpenMP target offloading "
+             "if the local residual supports it.");
+        Parameters::registerParam<TypeTag, Properties::ReorderCells>
+            ("Linearize the cells in reverse Cuthill-McKee order instead of in the order of the grid.");
+        Parameters::registerParam<TypeTag, Properties::IntensiveQuantitiesPrefetchDistance>
+            ("The number of cells (or faces) ahead of the current one for which the cached "
+             "intensive quantities of the neighbors are prefetched by the flux loop. 0 disables prefetching.");
+        Parameters::registerParam<TypeTag, Properties::AdaptiveImplicitCflThreshold>
+            ("Linearize the fluxes of the cells whose CFL number is below this threshold only "
+             "with regard to pressure (adaptive implicit method). 0 treats all cells fully implicitly.");
+        Parameters::registerParam<TypeTag, Properties::FlowsInSinglePrecision>
+            ("Store the flows and flores of the faces requested for output in single precision.");
     }
 
     /*!
@@ -165,6 +248,34 @@ public:
         jacobian_.reset();
     }
 
+    /*!
+     * \brief Register a source term which only affects a small number of cells, e.g.,
+     *        a well.
+     *
+     * The registered source terms are linearized after the cells of the grid by all
+     * threads, see BaseSparseSourceTerm. The linearizer does not take ownership of the
+     * object. The couplings of the source term between cells are only added to the
+     * sparsity pattern of the Jacobian matrix if it is registered before the first
+     * linearization.
+     */
+    void addSparseSourceTerm(BaseSparseSourceTerm<TypeTag>* source)
+    {
+        sparseSources_.push_back(source);
+        updateSparseSourceTerms();
+    }
+
+    /*!
+     * \brief Query the cells and couplings of the registered sparse source terms again.
+     *
+     * This must be called whenever they changed, e.g., if a perforation of a well was
+     * opened or shut.
+     */
+    void updateSparseSourceTerms()
+    {
+        if (jacobian_)
+            setupSparseSources_();
+    }
+
     /*!
      * \brief Linearize the full system of non-linear equations.
      *
@@ -231,6 +342,7 @@ public:
     void linearizeDomain(const SubDomainType& domain)
     {
         OPM_TIMEBLOCK(linearizeDomain);
+        EWOMS_PROFILE_REGION("linearize domain");
         // we defer the initialization of the Jacobian matrix until here because the
         // auxiliary modules usually assume the problem, model and grid to be fully
         // initialized...
@@ -245,7 +357,81 @@ public:
             resetSystem_(domain);
         }
 
-        linearize_(domain);
+        linearize_</*residualOnly=*/false>(domain);
+    }
+
+    /*!
+     * \brief Evaluate the residual of the spatial domain without linearizing it.
+     *
+     * This is intended for callers which only need the residual for the current
+     * solution, e.g., line searches or convergence checks after an update. The Jacobian
+     * matrix is not touched, i.e., it keeps the values of the last linearization.
+     */
+    void linearizeResidual()
+    {
+        int succeeded;
+        try {
+            linearizeResidual(fullDomain_);
+            succeeded = 1;
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while evaluating the residual:" << e.what()
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        catch (...)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while evaluating the residual"
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        succeeded = simulator_().gridView().comm().min(succeeded);
+
+        if (!succeeded)
+            throw NumericalProblem("A process did not succeed in evaluating the residual");
+    }
+
+    /*!
+     * \brief Evaluate the residual on a part of the spatial domain without
+     *        linearizing it.
+     *
+     * \copydetails linearizeResidual()
+     */
+    template <class SubDomainType>
+    void linearizeResidual(const SubDomainType& domain)
+    {
+        OPM_TIMEBLOCK(linearizeResidual);
+        EWOMS_PROFILE_REGION("linearize residual");
+        if (!jacobian_)
+            initFirstIteration_();
+
+        resetRows_</*residualOnly=*/true>(domain);
+
+        linearize_</*residualOnly=*/true>(domain);
+    }
+
+    /*!
+     * \brief Evaluate the residual of the full spatial domain for intensive quantities
+     *        which do not correspond to an iterate of the Newton method.
+     *
+     * In contrast to linearizeResidual(), the storage terms of the previous time step
+     * which are cached at the first iteration of a time step are not modified. This is
+     * used to compute directional derivatives of the residual, e.g. by
+     * MatrixFreeLinearOperator.
+     */
+    void linearizePerturbedResidual()
+    {
+        struct Guard
+        {
+            explicit Guard(bool& flag) : flag_(flag) { flag_ = true; }
+            ~Guard() { flag_ = false; }
+            bool& flag_;
+        } guard(perturbedResidual_);
+
+        linearizeResidual(fullDomain_);
     }
 
     void finalize()
@@ -258,6 +444,7 @@ public:
     void linearizeAuxiliaryEquations()
     {
         OPM_TIMEBLOCK(linearizeAuxilaryEquations);
+        EWOMS_PROFILE_REGION("linearize auxiliary equations");
         // flush possible local caches into matrix structure
         jacobian_->commit();
 
@@ -301,6 +488,79 @@ public:
     GlobalEqVector& residual()
     { return residual_; }
 
+    /*!
+     * \brief Add the number of bytes held by the linearizer to a memory usage report.
+     */
+    void reportMemoryUsage(MemoryUsage& usage) const
+    {
+        if (jacobian_)
+            usage.add("Jacobian matrix", MemoryUsage::bcrsMatrixBytes(jacobian_->istlMatrix()));
+        usage.add("Residual", MemoryUsage::blockVectorBytes(residual_));
+        usage.add("Neighbor table",
+                  neighborInfo_.memoryUsage()
+                  + MemoryUsage::bytesOf(diagMatAddress_)
+                  + MemoryUsage::bytesOf(oppositeConnection_));
+        usage.add("Flows and flores tables", flowTable_.memoryUsage());
+        usage.add("Velocity table", MemoryUsage::bytesOf(cellNormVelocity_));
+        usage.add("Boundary table",
+                  MemoryUsage::bytesOf(boundaryInfo_) + MemoryUsage::bytesOf(boundaryCellOffsets_)
+                  + MemoryUsage::bytesOf(boundaryCellLookup_) + MemoryUsage::bytesOf(activeBoundaryFaces_)
+                  + MemoryUsage::bytesOf(activeBoundaryCellOffsets_));
+        usage.add("Face coloring",
+                  MemoryUsage::bytesOf(faceInfo_) + MemoryUsage::bytesOf(faceColorOffsets_));
+        if constexpr (offloadFluxSupported_()) {
+            if (offloadFluxKernel_)
+                usage.add("Offloaded flux kernel", offloadFluxKernel_->memoryUsage());
+        }
+        usage.add("Adaptive implicit method",
+                  MemoryUsage::bytesOf(aimFluxDerivatives_)
+                  + MemoryUsage::bytesOf(aimStorageDerivatives_)
+                  + MemoryUsage::bytesOf(aimExplicitCell_));
+        usage.add("Sparse source terms",
+                  MemoryUsage::bytesOf(sparseSourceBatches_)
+                  + MemoryUsage::bytesOf(sparseSourceChunkOffsets_)
+                  + MemoryUsage::bytesOf(sparseSourceDomainMask_));
+    }
+
+    /*!
+     * \brief Register the settings of the linearizer which can be changed at run time
+     *        with an auto-tuner.
+     *
+     * These are the prefetch distance of the intensive quantities, the face based
+     * assembly of the fluxes and, if the local residual supports it, the offloading of
+     * the fluxes.
+     */
+    void registerTuningKnobs(AutoTuner& tuner)
+    {
+        std::vector<unsigned> distances = {0, 1, 4, 16};
+        if (std::find(distances.begin(), distances.end(), prefetchDistance_) == distances.end())
+            distances.push_back(prefetchDistance_);
+        std::vector<std::string> distanceLabels;
+        for (const unsigned distance : distances)
+            distanceLabels.push_back(std::to_string(distance));
+        const std::size_t distanceIdx =
+            std::find(distances.begin(), distances.end(), prefetchDistance_) - distances.begin();
+        tuner.addKnob("IntensiveQuantitiesPrefetchDistance", std::move(distanceLabels),
+                      [this, distances](std::size_t idx) { prefetchDistance_ = distances[idx]; },
+                      distanceIdx);
+
+        // the face coloring is created when the face based assembly is tried first
+        tuner.addKnob("FaceBasedFluxAssembly", {"false", "true"},
+                      [this](std::size_t idx)
+                      {
+                          faceBasedFluxAssembly_ = (idx == 1);
+                          if (faceBasedFluxAssembly_ && faceColorOffsets_.empty() && !neighborInfo_.empty())
+                              createFaceColoring_();
+                      },
+                      faceBasedFluxAssembly_ ? 1 : 0);
+
+        if constexpr (offloadFluxSupported_()) {
+            tuner.addKnob("OffloadFluxAssembly", {"false", "true"},
+                          [this](std::size_t idx) { offloadFluxAssembly_ = (idx == 1); },
+                          offloadFluxAssembly_ ? 1 : 0);
+        }
+    }
+
     void setLinearizationType(LinearizationType linearizationType){
         linearizationType_ = linearizationType;
     };
@@ -310,56 +570,133 @@ public:
     };
 
     /*!
-     * \brief Return constant reference to the flowsInfo.
+     * \brief Return the flows over the faces of each cell.
      *
-     * (This object is only non-empty if the FLOWS keyword is true.)
+     * The returned view is accessed like a sparse table of FlowInfo records with one
+     * row per cell. It is only non-empty if the FLOWS keyword is true, and the rows
+     * of the cells which are not requested by setFlowsOutputCells() only contain
+     * their NNCs.
      */
-    const auto& getFlowsInfo() const{
-
-        return flowsInfo_;
-    }
+    auto getFlowsInfo() const
+    { return flowTable_.view(FlowTable::flowsIdx); }
 
     /*!
-     * \brief Return constant reference to the floresInfo.
+     * \brief Return the flores over the faces of each cell.
      *
      * (This object is only non-empty if the FLORES keyword is true.)
      */
-    const auto& getFloresInfo() const{
+    auto getFloresInfo() const
+    { return flowTable_.view(FlowTable::floresIdx); }
 
-        return floresInfo_;
+    /*!
+     * \brief Restrict the flows and flores which are stored to the faces of some cells.
+     *
+     * The faces of the cells whose entry of the mask is nonzero are stored, as well as
+     * the NNCs of the output. An empty mask requests all cells. The tables are created
+     * again when the flows are needed the next time.
+     */
+    void setFlowsOutputCells(std::vector<unsigned char> mask)
+    {
+        flowsOutputCells_ = std::move(mask);
+        flowTable_.clear();
+        recordFlows_ = recordFlores_ = false;
     }
 
     /*!
-     * \brief Return constant reference to the velocityInfo.
+     * \brief Return constant reference to the maximum absolute velocity of the faces
+     *        of each cell.
      *
-     * (This object is only non-empty if the DISPERC keyword is true.)
+     * The entries are indexed by the conservation equation and were obtained during
+     * the last linearization. (This object is only non-empty if the DISPERC keyword is
+     * true.)
      */
-    const auto& getVelocityInfo() const{
+    const auto& getCellNormVelocity() const{
 
-        return velocityInfo_;
+        return cellNormVelocity_;
     }
 
+    /*!
+     * \brief Returns true if the fluxes of a cell are currently only linearized with
+     *        regard to pressure by the adaptive implicit method.
+     *
+     * The classification is based on the CFL numbers of the last linearization, see
+     * the AdaptiveImplicitCflThreshold parameter.
+     */
+    bool isExplicitCell(unsigned globI) const
+    { return !aimExplicitCell_.empty() && aimExplicitCell_[globI]; }
+
+    /*!
+     * \brief Returns the number of cells which are currently treated explicitly by the
+     *        adaptive implicit method.
+     */
+    std::size_t numExplicitCells() const
+    { return std::count(aimExplicitCell_.begin(), aimExplicitCell_.end(), 1); }
+
+    /*!
+     * \brief Update the data of the faces which is stored by the linearizer.
+     *
+     * If the problem provides a method
+     *
+     * \code
+     * bool changedTransmissibilityFaces(std::vector<std::pair<unsigned, unsigned>>& faces) const;
+     * \endcode
+     *
+     * which returns true and the pairs of cells of all faces whose transmissibility
+     * changed since its last call, only these faces are refreshed. Otherwise, the
+     * transmissibilities of all faces are updated.
+     */
     void updateDiscretizationParameters()
     {
+        if constexpr (hasChangedTransmissibilityFaces_()) {
+            changedFaces_.clear();
+            if (!neighborInfo_.empty() && problem_().changedTransmissibilityFaces(changedFaces_)) {
+                updateStoredTransmissibilities(changedFaces_);
+                return;
+            }
+        }
+
         updateStoredTransmissibilities();
     }
 
-    void updateBoundaryConditionData() {
-        for (auto& bdyInfo : boundaryInfo_) {
-            const auto [type, massrateAD] = problem_().boundaryCondition(bdyInfo.cell, bdyInfo.dir);
+    /*!
+     * \brief Query the boundary conditions of all boundary faces from the problem.
+     */
+    void updateBoundaryConditionData()
+    {
+        bool activityChanged = false;
+        for (std::size_t bIdx = 0; bIdx < boundaryInfo_.size(); ++bIdx)
+            activityChanged = updateBoundaryFace_(bIdx) || activityChanged;
 
-            // Strip the unnecessary (and zero anyway) derivatives off massrate.
-            VectorBlock massrate(0.0);
-            for (size_t ii = 0; ii < massrate.size(); ++ii) {
-                massrate[ii] = massrateAD[ii].value();
-            }
-            if (type != BCType::NONE) {
-                const auto& exFluidState = problem_().boundaryFluidState(bdyInfo.cell, bdyInfo.dir);
-                bdyInfo.bcdata.type = type;
-                bdyInfo.bcdata.massRate = massrate;
-                bdyInfo.bcdata.exFluidState = exFluidState;
-            }
+        if (activityChanged)
+            updateActiveBoundaryFaces_();
+    }
+
+    /*!
+     * \brief Query the boundary conditions of the boundary faces of some cells from the
+     *        problem.
+     *
+     * This is intended for problems which know the cells whose boundary conditions
+     * changed. The boundary conditions of all other faces are kept.
+     *
+     * \param cells The indices of the cells whose boundary conditions changed
+     */
+    template <class CellRange>
+    void updateBoundaryConditionData(const CellRange& cells)
+    {
+        bool activityChanged = false;
+        for (const auto cellIdx : cells) {
+            const auto it = std::lower_bound(boundaryCellLookup_.begin(), boundaryCellLookup_.end(),
+                                             std::make_pair(static_cast<unsigned>(cellIdx), 0u));
+            if (it == boundaryCellLookup_.end() || it->first != static_cast<unsigned>(cellIdx))
+                continue;
+
+            const unsigned bCellIdx = it->second;
+            for (std::size_t bIdx = boundaryCellOffsets_[bCellIdx]; bIdx < boundaryCellOffsets_[bCellIdx + 1]; ++bIdx)
+                activityChanged = updateBoundaryFace_(bIdx) || activityChanged;
         }
+
+        if (activityChanged)
+            updateActiveBoundaryFaces_();
     }
 
     /*!
@@ -376,10 +713,7 @@ public:
         if (!jacobian_) {
             initFirstIteration_();
         }
-        for (int globI : domain.cells) {
-            residual_[globI] = 0.0;
-            jacobian_->clearRow(globI, 0.0);
-        }
+        resetRows_</*residualOnly=*/false>(domain);
     }
 
 private:
@@ -406,11 +740,14 @@ private:
         // initialize the BCRS matrix for the Jacobian of the residual function
         createMatrix_();
 
-        // initialize the Jacobian matrix and the vector for the residual function
+        // initialize the Jacobian matrix and the vector for the residual function. this
+        // is the first write to the values of the matrix, so their pages are placed
+        // close to the threads which assemble the corresponding rows
         residual_.resize(model_().numTotalDof());
         resetSystem_();
 
-        // initialize the sparse tables for Flows and Flores
+        // initialize the cell velocities. the sparse tables for Flows and Flores are
+        // created by updateFlowsInfo() when they are first needed
         createFlows_();
     }
 
@@ -418,64 +755,85 @@ private:
     void createMatrix_()
     {
         OPM_TIMEBLOCK(createMatrix);
+        EWOMS_PROFILE_REGION("create matrix");
         if (!neighborInfo_.empty()) {
             // It is ok to call this function multiple times, but it
             // should not do anything if already called.
             return;
         }
         const auto& model = model_();
-        Stencil stencil(gridView_(), model_().dofMapper());
-
-        // for the main model, find out the global indices of the neighboring degrees of
-        // freedom of each primary degree of freedom
-        using NeighborSet = std::set< unsigned >;
-        std::vector<NeighborSet> sparsityPattern(model.numTotalDof());
         const Scalar gravity = problem_().gravity()[dimWorld - 1];
+        const bool skipTransMult = !problem_().hasRockCompTransMultiplier();
+        const bool enableDispersion =
+            simulator_().vanguard().eclState().getSimulationConfig().rock_config().dispersion();
         unsigned numCells = model.numTotalDof();
-        neighborInfo_.reserve(numCells, 6 * numCells);
-        std::vector<NeighborInfo> loc_nbinfo;
-        for (const auto& elem : elements(gridView_())) {
-            stencil.update(elem);
-
-            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
-                unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
-                loc_nbinfo.resize(stencil.numDof() - 1); // Do not include the primary dof in neighborInfo_
-
-                for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
-                    unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    sparsityPattern[myIdx].insert(neighborIdx);
-                    if (dofIdx > 0) {
-                        const Scalar trans = problem_().transmissibility(myIdx, neighborIdx);
-                        const auto scvfIdx = dofIdx - 1;
-                        const auto& scvf = stencil.interiorFace(scvfIdx);
-                        const Scalar area = scvf.area();
-                        const Scalar Vin = problem_().model().dofTotalVolume(myIdx);
-                        const Scalar Vex = problem_().model().dofTotalVolume(neighborIdx);
-                        const Scalar zIn = problem_().dofCenterDepth(myIdx);
-                        const Scalar zEx = problem_().dofCenterDepth(neighborIdx);
-                        const Scalar dZg = (zIn - zEx)*gravity;
-                        const Scalar thpres = problem_().thresholdPressure(myIdx, neighborIdx);
-                        Scalar inAlpha {0.};
-                        Scalar outAlpha {0.};
-                        Scalar diffusivity {0.};
-                        Scalar dispersivity {0.};
-                        if constexpr(enableEnergy){
-                            inAlpha = problem_().thermalHalfTransmissibility(myIdx, neighborIdx);
-                            outAlpha = problem_().thermalHalfTransmissibility(neighborIdx, myIdx);
-                        }
-                        if constexpr(enableDiffusion){
-                            diffusivity = problem_().diffusivity(myIdx, neighborIdx);
-                        }
-                        if (simulator_().vanguard().eclState().getSimulationConfig().rock_config().dispersion()) {
-                            dispersivity = problem_().dispersivity(myIdx, neighborIdx);
-                        }
-                        auto dirId = scvf.dirId();
-                        loc_nbinfo[dofIdx - 1] = NeighborInfo{neighborIdx, {trans, area, thpres, dZg, dirId, Vin, Vex, inAlpha, outAlpha, diffusivity, dispersivity}, nullptr};
 
-                    }
+        // the neighbor table is built in two threaded passes over the elements: the
+        // first one counts the neighbors of each cell, which determines the offsets of
+        // all rows, so that the second one can fill the rows concurrently.
+        std::vector<std::size_t> rowSizes(numCells, 0);
+        forEachCellStencil_([&rowSizes](const Stencil& stencil, unsigned myIdx)
+                            { rowSizes[myIdx] = stencil.numDof() - 1; });
+        neighborInfo_.resizeRows(rowSizes);
+
+        // for the main model, find out the global indices of the neighboring degrees of
+        // freedom of each primary degree of freedom. Each row is the cell itself and its
+        // neighbors in ascending order.
+        std::vector<std::vector<unsigned>> sparsityPattern(numCells);
+        forEachCellStencil_([&](const Stencil& stencil, unsigned myIdx) {
+            auto& pattern = sparsityPattern[myIdx];
+            pattern.reserve(stencil.numDof());
+            pattern.push_back(myIdx);
+
+            std::size_t nbPos = neighborInfo_.rowBegin(myIdx);
+            for (unsigned dofIdx = 1; dofIdx < stencil.numDof(); ++dofIdx, ++nbPos) {
+                unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
+                pattern.push_back(neighborIdx);
+
+                const Scalar trans = problem_().transmissibility(myIdx, neighborIdx);
+                const auto scvfIdx = dofIdx - 1;
+                const auto& scvf = stencil.interiorFace(scvfIdx);
+                const Scalar area = scvf.area();
+                const Scalar Vin = problem_().model().dofTotalVolume(myIdx);
+                const Scalar Vex = problem_().model().dofTotalVolume(neighborIdx);
+                const Scalar zIn = problem_().dofCenterDepth(myIdx);
+                const Scalar zEx = problem_().dofCenterDepth(neighborIdx);
+                const Scalar dZg = (zIn - zEx)*gravity;
+                const Scalar thpres = problem_().thresholdPressure(myIdx, neighborIdx);
+                Scalar inAlpha {0.};
+                Scalar outAlpha {0.};
+                Scalar diffusivity {0.};
+                Scalar dispersivity {0.};
+                if constexpr(enableEnergy){
+                    inAlpha = problem_().thermalHalfTransmissibility(myIdx, neighborIdx);
+                    outAlpha = problem_().thermalHalfTransmissibility(neighborIdx, myIdx);
+                }
+                if constexpr(enableDiffusion){
+                    diffusivity = problem_().diffusivity(myIdx, neighborIdx);
                 }
-                neighborInfo_.appendRow(loc_nbinfo.begin(), loc_nbinfo.end());
-                if (problem_().nonTrivialBoundaryConditions()) {
+                if (enableDispersion) {
+                    dispersivity = problem_().dispersivity(myIdx, neighborIdx);
+                }
+                auto dirId = scvf.dirId();
+                neighborInfo_.neighbor(nbPos) = neighborIdx;
+                neighborInfo_.resNBInfo(nbPos) =
+                    ResidualNBInfo{trans, area, thpres, dZg, dirId, skipTransMult, Vin, Vex, inAlpha, outAlpha, diffusivity, dispersivity};
+                neighborInfo_.matBlockAddress(nbPos) = nullptr;
+            }
+
+            std::sort(pattern.begin(), pattern.end());
+            pattern.erase(std::unique(pattern.begin(), pattern.end()), pattern.end());
+        });
+
+        // the boundary conditions are queried from the problem, which is not
+        // necessarily thread safe, so they are collected by a sequential sweep
+        if (problem_().nonTrivialBoundaryConditions()) {
+            Stencil stencil(gridView_(), model.dofMapper());
+            model.prepareStencil(stencil);
+            for (const auto& elem : elements(gridView_())) {
+                stencil.update(elem);
+                for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
+                    unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
                     for (unsigned bfIndex = 0; bfIndex < stencil.numBoundaryFaces(); ++bfIndex) {
                         const auto& bf = stencil.boundaryFace(bfIndex);
                         const int dir_id = bf.dirId();
@@ -502,126 +860,454 @@ private:
             }
         }
 
-        // add the additional neighbors and degrees of freedom caused by the auxiliary
-        // equations
-        size_t numAuxMod = model.numAuxiliaryModules();
-        for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
-            model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern);
+        // the boundary faces are appended cell by cell, so the faces of each cell form
+        // a contiguous range of boundaryInfo_
+        boundaryCellOffsets_.assign(1, 0);
+        for (std::size_t bIdx = 0; bIdx < boundaryInfo_.size(); ++bIdx) {
+            if (bIdx + 1 == boundaryInfo_.size() || boundaryInfo_[bIdx + 1].cell != boundaryInfo_[bIdx].cell)
+                boundaryCellOffsets_.push_back(bIdx + 1);
+        }
+
+        boundaryCellLookup_.resize(boundaryCellOffsets_.size() - 1);
+        for (std::size_t bCellIdx = 0; bCellIdx < boundaryCellLookup_.size(); ++bCellIdx)
+            boundaryCellLookup_[bCellIdx] = {boundaryInfo_[boundaryCellOffsets_[bCellIdx]].cell,
+                                             static_cast<unsigned>(bCellIdx)};
+        std::sort(boundaryCellLookup_.begin(), boundaryCellLookup_.end());
+
+        updateActiveBoundaryFaces_();
+
+        // the couplings of the sparse source terms between the cells
+        for (const auto* source : sparseSources_) {
+            const auto cells = source->cells();
+            for (const auto& [entryIdx, cellIdx] : source->couplings()) {
+                auto& pattern = sparsityPattern[cells[entryIdx]];
+                const auto pos = std::lower_bound(pattern.begin(), pattern.end(), cellIdx);
+                if (pos == pattern.end() || *pos != cellIdx)
+                    pattern.insert(pos, cellIdx);
+            }
+        }
 
         // allocate raw matrix
         jacobian_.reset(new SparseMatrixAdapter(simulator_()));
         diagMatAddress_.resize(numCells);
-        // create matrix structure based on sparsity pattern
-        jacobian_->reserve(sparsityPattern);
+
+        // add the additional neighbors and degrees of freedom caused by the auxiliary
+        // equations. their interface is based on sets, which are only used if necessary
+        size_t numAuxMod = model.numAuxiliaryModules();
+        if (numAuxMod > 0) {
+            using NeighborSet = std::set<unsigned>;
+            std::vector<NeighborSet> neighborSets(numCells);
+            for (unsigned globI = 0; globI < numCells; ++globI)
+                neighborSets[globI].insert(sparsityPattern[globI].begin(), sparsityPattern[globI].end());
+            for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
+                model.auxiliaryModule(auxModIdx)->addNeighbors(neighborSets);
+
+            // create matrix structure based on sparsity pattern
+            jacobian_->reserve(neighborSets);
+        }
+        else
+            jacobian_->reserve(sparsityPattern);
+        sparsityPattern.clear();
         for (unsigned globI = 0; globI < numCells; globI++) {
-            const auto& nbInfos = neighborInfo_[globI];
             diagMatAddress_[globI] = jacobian_->blockAddress(globI, globI);
-            for (auto& nbInfo : nbInfos) {
-                nbInfo.matBlockAddress = jacobian_->blockAddress(nbInfo.neighbor, globI);
+            const std::size_t nbEnd = neighborInfo_.rowBegin(globI + 1);
+            for (std::size_t nbPos = neighborInfo_.rowBegin(globI); nbPos < nbEnd; ++nbPos) {
+                neighborInfo_.matBlockAddress(nbPos) =
+                    jacobian_->blockAddress(neighborInfo_.neighbor(nbPos), globI);
             }
         }
 
-        // Create dummy full domain.
+        // Create dummy full domain. If requested, its cells are ordered such that
+        // cells which are linearized shortly after each other are also close in the
+        // connectivity graph, i.e., they share most of their neighbors.
         fullDomain_.cells.resize(numCells);
-        std::iota(fullDomain_.cells.begin(), fullDomain_.cells.end(), 0);
+        if (reorderCells_) {
+            std::vector<std::size_t> rowOffsets(numCells + 1);
+            std::vector<unsigned> neighbors(neighborInfo_.dataSize());
+            for (unsigned globI = 0; globI <= numCells; ++globI)
+                rowOffsets[globI] = neighborInfo_.rowBegin(globI);
+            for (std::size_t nbPos = 0; nbPos < neighbors.size(); ++nbPos)
+                neighbors[nbPos] = neighborInfo_.neighbor(nbPos);
+
+            const auto order = reverseCuthillMcKeeOrdering(rowOffsets, neighbors);
+            std::copy(order.begin(), order.end(), fullDomain_.cells.begin());
+        }
+        else
+            std::iota(fullDomain_.cells.begin(), fullDomain_.cells.end(), 0);
+
+        createOppositeConnections_();
+        if (faceBasedFluxAssembly_)
+            createFaceColoring_();
+
+        // the slots of the flow table refer to the positions of the neighbor table
+        flowTable_.clear();
+        recordFlows_ = recordFlores_ = false;
+
+        setupSparseSources_();
+    }
+
+    // Update the boundary condition of a boundary face. Returns true if the face was
+    // activated or deactivated, i.e., if its type changed from or to BCType::NONE.
+    bool updateBoundaryFace_(std::size_t bIdx)
+    {
+        auto& bdyInfo = boundaryInfo_[bIdx];
+        const auto [type, massrateAD] = problem_().boundaryCondition(bdyInfo.cell, bdyInfo.dir);
+        auto& bcdata = bdyInfo.bcdata;
+        const bool wasActive = bcdata.type != BCType::NONE;
+
+        // Strip the unnecessary (and zero anyway) derivatives off massrate.
+        bcdata.type = type;
+        for (std::size_t ii = 0; ii < bcdata.massRate.size(); ++ii)
+            bcdata.massRate[ii] = massrateAD[ii].value();
+
+        // the fluid state outside of the domain is only needed by active faces
+        if (type != BCType::NONE) {
+            const auto& exFluidState = problem_().boundaryFluidState(bdyInfo.cell, bdyInfo.dir);
+            bcdata.exFluidState = exFluidState;
+            bcdata.pvtRegionIdx = exFluidState.pvtRegionIndex();
+        }
+
+        return wasActive != (type != BCType::NONE);
+    }
+
+    // Collect the boundary faces whose type is not BCType::NONE. They stay grouped by
+    // their cells, so the boundary loops can distribute the cells over the threads.
+    void updateActiveBoundaryFaces_()
+    {
+        activeBoundaryFaces_.clear();
+        activeBoundaryCellOffsets_.assign(1, 0);
+        for (std::size_t bCellIdx = 0; bCellIdx + 1 < boundaryCellOffsets_.size(); ++bCellIdx) {
+            for (std::size_t bIdx = boundaryCellOffsets_[bCellIdx]; bIdx < boundaryCellOffsets_[bCellIdx + 1]; ++bIdx)
+                if (boundaryInfo_[bIdx].bcdata.type != BCType::NONE)
+                    activeBoundaryFaces_.push_back(bIdx);
+
+            if (activeBoundaryFaces_.size() != activeBoundaryCellOffsets_.back())
+                activeBoundaryCellOffsets_.push_back(activeBoundaryFaces_.size());
+        }
+    }
+
+    // Collect the entries of all sparse source terms, sort them by their cells and
+    // split them into chunks which can be linearized concurrently. Consecutive entries
+    // of the same source term are merged into batches, so the source terms are called
+    // for ranges of entries.
+    void setupSparseSources_()
+    {
+        sparseSourceCells_.resize(sparseSources_.size());
+        sparseSourceCouplings_.resize(sparseSources_.size());
+        sparseSourceBatches_.clear();
+        sparseSourceChunkOffsets_.assign(1, 0);
+
+        const auto& matrix = jacobian_->istlMatrix();
+        std::vector<SparseSourceBatch> entries;
+        for (unsigned sourceIdx = 0; sourceIdx < sparseSources_.size(); ++sourceIdx) {
+            const auto* source = sparseSources_[sourceIdx];
+            auto& cells = sparseSourceCells_[sourceIdx];
+            cells = source->cells();
+            for (std::size_t entryIdx = 0; entryIdx < cells.size(); ++entryIdx)
+                entries.push_back({cells[entryIdx], cells[entryIdx], sourceIdx, entryIdx, entryIdx + 1});
+
+            auto& couplings = sparseSourceCouplings_[sourceIdx];
+            couplings.clear();
+            for (const auto& [entryIdx, cellIdx] : source->couplings()) {
+                const unsigned rowIdx = cells[entryIdx];
+                if (matrix[rowIdx].find(cellIdx) == matrix[rowIdx].end())
+                    throw std::logic_error("The coupling of a sparse source term between cells "
+                                           + std::to_string(rowIdx) + " and " + std::to_string(cellIdx)
+                                           + " is not part of the sparsity pattern. Sparse source "
+                                           "terms must be registered before the first linearization");
+                couplings.push_back(jacobian_->blockAddress(rowIdx, cellIdx));
+            }
+        }
+
+        std::sort(entries.begin(), entries.end(),
+                  [](const auto& a, const auto& b)
+                  { return std::tie(a.firstCell, a.sourceIdx, a.begin) < std::tie(b.firstCell, b.sourceIdx, b.begin); });
+
+        std::size_t chunkSize = 0;
+        for (const auto& entry : entries) {
+            if (!sparseSourceBatches_.empty()) {
+                auto& last = sparseSourceBatches_.back();
+                if (last.sourceIdx == entry.sourceIdx && last.end == entry.begin) {
+                    last.lastCell = entry.lastCell;
+                    last.end = entry.end;
+                    ++chunkSize;
+                    continue;
+                }
+
+                // chunks must not split the entries of a cell
+                if (chunkSize >= sparseSourceChunkSize && last.lastCell != entry.firstCell) {
+                    sparseSourceChunkOffsets_.push_back(sparseSourceBatches_.size());
+                    chunkSize = 0;
+                }
+            }
+            sparseSourceBatches_.push_back(entry);
+            ++chunkSize;
+        }
+        if (sparseSourceChunkOffsets_.back() != sparseSourceBatches_.size())
+            sparseSourceChunkOffsets_.push_back(sparseSourceBatches_.size());
+    }
+
+    // Find the connection in the opposite direction for each connection of the
+    // neighbor table. This avoids searching the rows of the table whenever both
+    // directions of a face have to be accessed.
+    void createOppositeConnections_()
+    {
+        const unsigned numCells = neighborInfo_.size();
+        oppositeConnection_.resize(neighborInfo_.dataSize());
+        std::atomic<bool> consistent = true;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (unsigned globI = 0; globI < numCells; ++globI) {
+            const std::size_t rowBeginI = neighborInfo_.rowBegin(globI);
+            const std::size_t rowEndI = neighborInfo_.rowBegin(globI + 1);
+            for (std::size_t posI = rowBeginI; posI < rowEndI; ++posI) {
+                const unsigned globJ = neighborInfo_.neighbor(posI);
+
+                // there may be several connections between the same pair of cells. the
+                // k-th connection from I to J is paired with the k-th one from J to I.
+                unsigned occurrence = 0;
+                for (std::size_t pos = rowBeginI; pos < posI; ++pos)
+                    occurrence += (neighborInfo_.neighbor(pos) == globJ);
+
+                const std::size_t rowEndJ = neighborInfo_.rowBegin(globJ + 1);
+                std::size_t posJ = neighborInfo_.rowBegin(globJ);
+                for (; posJ < rowEndJ; ++posJ) {
+                    if (neighborInfo_.neighbor(posJ) == globI && occurrence-- == 0)
+                        break;
+                }
+                if (posJ == rowEndJ)
+                    consistent = false;
+                oppositeConnection_[posI] = posJ;
+            }
+        }
+
+        if (!consistent)
+            throw std::logic_error("Found a connection in the TPFA neighbor table which "
+                                   "is not present in the opposite direction");
+    }
+
+    // Call a function for the stencil of each primary degree of freedom of the grid
+    // view. The elements are distributed over the threads, so the function must only
+    // write data which belongs to the given degree of freedom.
+    template <class Function>
+    void forEachCellStencil_(Function func) const
+    {
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr;
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Stencil stencil(gridView_(), model_().dofMapper());
+            model_().prepareStencil(stencil);
+            auto elemIt = threadedElemIt.beginParallel();
+            try {
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    stencil.update(*elemIt);
+                    for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx)
+                        func(stencil, static_cast<unsigned>(stencil.globalSpaceIndex(primaryDofIdx)));
+                }
+            }
+            // see FvBaseLinearizer::linearize_() for the rationale of the exception
+            // handling
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+                threadedElemIt.setFinished();
+            }
+        }
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+    }
+
+    // Create the list of faces for the face based flux assembly. Each face is stored
+    // exactly once and the faces are grouped by colors such that no two faces of the
+    // same color touch the same cell. This allows to linearize all faces of a color
+    // concurrently without any synchronization.
+    void createFaceColoring_()
+    {
+        OPM_TIMEBLOCK(createFaceColoring);
+        const unsigned numCells = neighborInfo_.size();
+
+        // offsets of the rows of the neighbor table, used to attach a face index to
+        // each (cell, local neighbor index) pair
+        std::vector<std::size_t> rowOffset(numCells + 1, 0);
+        for (unsigned globI = 0; globI <= numCells; ++globI)
+            rowOffset[globI] = neighborInfo_.rowBegin(globI);
+
+        std::vector<FaceInfo> faces;
+        faces.reserve(rowOffset[numCells] / 2);
+        std::vector<std::size_t> faceOfConnection(rowOffset[numCells],
+                                                  std::numeric_limits<std::size_t>::max());
+        // the faces are enumerated in the order in which the cells are linearized, so
+        // that consecutive faces of a color stay local if the cells were reordered
+        for (const unsigned globI : fullDomain_.cells) {
+            const unsigned numNbI = rowOffset[globI + 1] - rowOffset[globI];
+            for (unsigned locI = 0; locI < numNbI; ++locI) {
+                const unsigned globJ = neighborInfo_.neighbor(rowOffset[globI] + locI);
+                if (globJ < globI)
+                    continue;
+
+                const unsigned locJ = oppositeConnection_[rowOffset[globI] + locI] - rowOffset[globJ];
+                faceOfConnection[rowOffset[globI] + locI] = faces.size();
+                faceOfConnection[rowOffset[globJ] + locJ] = faces.size();
+                faces.push_back(FaceInfo{globI, globJ, locI, locJ});
+            }
+        }
+
+        // greedy coloring of the faces
+        const std::size_t numFaces = faces.size();
+        const int uncolored = -1;
+        std::vector<int> faceColor(numFaces, uncolored);
+        std::vector<std::size_t> colorStamp;
+        int numColors = 0;
+        for (std::size_t faceIdx = 0; faceIdx < numFaces; ++faceIdx) {
+            for (unsigned cellIdx : {faces[faceIdx].cellI, faces[faceIdx].cellJ}) {
+                for (std::size_t connIdx = rowOffset[cellIdx]; connIdx < rowOffset[cellIdx + 1]; ++connIdx) {
+                    const int otherColor = faceColor[faceOfConnection[connIdx]];
+                    if (otherColor != uncolored)
+                        colorStamp[otherColor] = faceIdx + 1;
+                }
+            }
+
+            int color = 0;
+            while (color < numColors && colorStamp[color] == faceIdx + 1)
+                ++color;
+            if (color == numColors) {
+                ++numColors;
+                colorStamp.push_back(0);
+            }
+            faceColor[faceIdx] = color;
+        }
+
+        // sort the faces by color
+        faceColorOffsets_.assign(numColors + 1, 0);
+        for (std::size_t faceIdx = 0; faceIdx < numFaces; ++faceIdx)
+            ++faceColorOffsets_[faceColor[faceIdx] + 1];
+        std::partial_sum(faceColorOffsets_.begin(), faceColorOffsets_.end(), faceColorOffsets_.begin());
+
+        std::vector<std::size_t> nextPos(faceColorOffsets_.begin(), faceColorOffsets_.end() - 1);
+        faceInfo_.resize(numFaces);
+        for (std::size_t faceIdx = 0; faceIdx < numFaces; ++faceIdx)
+            faceInfo_[nextPos[faceColor[faceIdx]]++] = faces[faceIdx];
     }
 
     // reset the global linear system of equations.
     void resetSystem_()
+    { resetRows_</*residualOnly=*/false>(fullDomain_); }
+
+    // Set the rows of the residual and, unless only the residual is assembled, of the
+    // Jacobian matrix which belong to the cells of a domain to zero. The cells are
+    // distributed over the threads in the same way as by linearizeCellsAndFaces_(),
+    // i.e., each thread resets the rows which it assembles afterwards.
+    template <bool residualOnly, class SubDomainType>
+    void resetRows_(const SubDomainType& domain)
     {
-        residual_ = 0.0;
-        // zero all matrix entries
-        jacobian_->clear();
+        const unsigned numCells = domain.cells.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (unsigned ii = 0; ii < numCells; ++ii) {
+            const unsigned globI = domain.cells[ii];
+            residual_[globI] = 0.0;
+            if constexpr (!residualOnly)
+                jacobian_->clearRow(globI, 0.0);
+        }
     }
 
-    // Initialize the flows, flores, and velocity sparse tables
+    // Initialize the cell velocities and the derivatives of the adaptive implicit method
     void createFlows_()
     {
         OPM_TIMEBLOCK(createFlows);
-        // If FLOWS/FLORES is set in any RPTRST in the schedule, then we initializate the sparse tables
-        // For now, do the same also if any block flows are requested (TODO: only save requested cells...)
-        // If DISPERC is in the deck, we initialize the sparse table here as well.
-        const bool anyFlows = simulator_().problem().eclWriter()->outputModule().anyFlows();
-        const bool anyFlores = simulator_().problem().eclWriter()->outputModule().anyFlores();
+        // If DISPERC is in the deck, the maximum face velocity of each cell is
+        // reduced during the linearization. Only the reduced values are stored.
         const bool enableDispersion = simulator_().vanguard().eclState().getSimulationConfig().rock_config().dispersion();
-        if (((!anyFlows || !flowsInfo_.empty()) && (!anyFlores || !floresInfo_.empty())) && !enableDispersion) {
-            return;
+        if (enableDispersion) {
+            cellNormVelocity_.resize(model_().numTotalDof(), VectorBlock(0.0));
         }
-        const auto& model = model_();
-        const auto& nncOutput = simulator_().problem().eclWriter()->getOutputNnc();
-        Stencil stencil(gridView_(), model_().dofMapper());
-        unsigned numCells = model.numTotalDof();
-        std::unordered_multimap<int, std::pair<int, int>> nncIndices;
-        std::vector<FlowInfo> loc_flinfo;
-        std::vector<VelocityInfo> loc_vlinfo;
-        unsigned int nncId = 0;
-        VectorBlock flow(0.0);
 
-        // Create a nnc structure to use fast lookup
-        for (unsigned int nncIdx = 0; nncIdx < nncOutput.size(); ++nncIdx) {
-            const int ci1 = nncOutput[nncIdx].cell1;
-            const int ci2 = nncOutput[nncIdx].cell2;
-            nncIndices.emplace(ci1, std::make_pair(ci2, nncIdx));
+        // the accumulated derivatives from which the CFL numbers of the adaptive
+        // implicit method are obtained. All cells are implicit until the first
+        // linearization has been classified.
+        if (aimCflThreshold_ > 0.0 && aimExplicitCell_.empty()) {
+            aimFluxDerivatives_.resize(model_().numTotalDof(), VectorBlock(0.0));
+            aimStorageDerivatives_.resize(model_().numTotalDof(), VectorBlock(0.0));
+            aimExplicitCell_.resize(model_().numTotalDof(), 0);
         }
+    }
 
-        if (anyFlows) {
-            flowsInfo_.reserve(numCells, 6 * numCells);
-        }
-        if (anyFlores) {
-            floresInfo_.reserve(numCells, 6 * numCells);
+    // Initialize the table of the flows and flores. This is deferred until the flows
+    // are output for the first time, so that neither the startup nor runs which only
+    // request them late in the schedule pay for the table before it is needed. Each
+    // interior face is stored once and only the faces of the requested cells and the
+    // NNCs of the output get a slot. For now, the flows are also used for block flows.
+    void createFlowsInfo_(bool needFlows, bool needFlores)
+    {
+        OPM_TIMEBLOCK(createFlowsInfo);
+        EWOMS_PROFILE_REGION("create flows tables");
+        const bool anyFlows = needFlows && !flowTable_.hasQuantity(FlowTable::flowsIdx);
+        const bool anyFlores = needFlores && !flowTable_.hasQuantity(FlowTable::floresIdx);
+        if (!anyFlows && !anyFlores) {
+            return;
         }
-        if (enableDispersion) {
-            velocityInfo_.reserve(numCells, 6 * numCells);
-        }
-
-        for (const auto& elem : elements(gridView_())) {
-            stencil.update(elem);
-            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
-                unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
-                int numFaces = stencil.numBoundaryFaces() + stencil.numInteriorFaces();
-                loc_flinfo.resize(numFaces);
-                loc_vlinfo.resize(stencil.numDof() - 1);
-
-                for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
-                    unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    if (dofIdx > 0) {
-                        const auto scvfIdx = dofIdx - 1;
-                        const auto& scvf = stencil.interiorFace(scvfIdx);
+
+        if (flowTable_.empty()) {
+            const auto& nncOutput = simulator_().problem().eclWriter()->getOutputNnc();
+            Stencil stencil(gridView_(), model_().dofMapper());
+            std::unordered_multimap<int, std::pair<int, int>> nncIndices;
+
+            // Create a nnc structure to use fast lookup
+            for (unsigned int nncIdx = 0; nncIdx < nncOutput.size(); ++nncIdx) {
+                const int ci1 = nncOutput[nncIdx].cell1;
+                const int ci2 = nncOutput[nncIdx].cell2;
+                nncIndices.emplace(ci1, std::make_pair(ci2, nncIdx));
+            }
+
+            flowTable_.beginLayout(neighborInfo_.dataSize(), flowsInSinglePrecision_);
+            for (const auto& elem : elements(gridView_())) {
+                stencil.update(elem);
+                for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
+                    unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
+                    flowTable_.beginRow(flowsOutputCells_.empty() || flowsOutputCells_[myIdx]);
+                    const std::size_t rowBegin = neighborInfo_.rowBegin(myIdx);
+
+                    for (unsigned dofIdx = 1; dofIdx < stencil.numDof(); ++dofIdx) {
+                        unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
+                        const auto& scvf = stencil.interiorFace(dofIdx - 1);
                         int faceId = scvf.dirId();
+                        unsigned int nncId = 0;
                         const int cartMyIdx = simulator_().vanguard().cartesianIndex(myIdx);
                         const int cartNeighborIdx = simulator_().vanguard().cartesianIndex(neighborIdx);
                         const auto& range = nncIndices.equal_range(cartMyIdx);
                         for (auto it = range.first; it != range.second; ++it) {
                             if (it->second.first == cartNeighborIdx){
                                 // -1 gives problem since is used for the nncInput from the deck
-                                faceId = -2;
+                                faceId = FlowTable::nncFaceId;
                                 // the index is stored to be used for writting the outputs
                                 nncId = it->second.second;
                             }
                         }
-                        loc_flinfo[dofIdx - 1] = FlowInfo{faceId, flow, nncId};
-                        loc_vlinfo[dofIdx - 1] = VelocityInfo{flow};
+                        const std::size_t nbPos = rowBegin + dofIdx - 1;
+                        flowTable_.addInteriorFace(nbPos, oppositeConnection_[nbPos],
+                                                   myIdx < neighborIdx, faceId, nncId);
                     }
-                } 
 
-                for (unsigned bdfIdx = 0; bdfIdx < stencil.numBoundaryFaces(); ++bdfIdx) {
-                    const auto& scvf = stencil.boundaryFace(bdfIdx);
-                    int faceId = scvf.dirId();
-                    loc_flinfo[stencil.numInteriorFaces() + bdfIdx] = FlowInfo{faceId, flow, nncId};
-                }
-
-
-                if (anyFlows) {
-                    flowsInfo_.appendRow(loc_flinfo.begin(), loc_flinfo.end());
-                }
-                if (anyFlores) {
-                    floresInfo_.appendRow(loc_flinfo.begin(), loc_flinfo.end());
-                }
-                if (enableDispersion) {
-                    velocityInfo_.appendRow(loc_vlinfo.begin(), loc_vlinfo.end());
+                    for (unsigned bdfIdx = 0; bdfIdx < stencil.numBoundaryFaces(); ++bdfIdx)
+                        flowTable_.addBoundaryFace(stencil.boundaryFace(bdfIdx).dirId());
+                    flowTable_.endRow();
                 }
             }
         }
+
+        if (anyFlows) {
+            flowTable_.allocate(FlowTable::flowsIdx);
+        }
+        if (anyFlores) {
+            flowTable_.allocate(FlowTable::floresIdx);
+        }
     }
 
 public:
@@ -643,74 +1329,122 @@ public:
 
     void updateFlowsInfo() {
         OPM_TIMEBLOCK(updateFlows);
+        EWOMS_PROFILE_REGION("update flows");
         const bool& enableFlows = simulator_().problem().eclWriter()->outputModule().hasFlows() ||
                                     simulator_().problem().eclWriter()->outputModule().hasBlockFlows();
         const bool& enableFlores = simulator_().problem().eclWriter()->outputModule().hasFlores();
         if (!enableFlows && !enableFlores) {
             return;
         }
+        // the values recorded by the last linearization are used if they cover all
+        // requested quantities
+        if ((!enableFlows || recordFlows_) && (!enableFlores || recordFlores_)) {
+            return;
+        }
+        createFlowsInfo_(enableFlows, enableFlores);
         const unsigned int numCells = model_().numTotalDof();
 
+        static auto& loadStats = ThreadLoadStatistics::get("TPFA flows");
+        loadStats.beginLoop();
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel
+#endif
+        {
+        auto threadScope = loadStats.threadScope();
+#ifdef _OPENMP
+#pragma omp for nowait
 #endif
         for (unsigned globI = 0; globI < numCells; ++globI) {
             OPM_TIMEBLOCK_LOCAL(linearizationForEachCell);
-            const auto& nbInfos = neighborInfo_[globI];
-            ADVectorBlock adres(0.0);
+            threadScope.addWorkItem();
+            // only the values of the fluxes are required, so they are computed
+            // without derivatives
+            VectorBlock res(0.0);
             ADVectorBlock darcyFlux(0.0);
             const IntensiveQuantities& intQuantsIn = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
             // Flux term.
             {
             OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachCell);
-            short loc = 0;
-            for (const auto& nbInfo : nbInfos) {
+            // the values of each stored face are computed by the cell which owns its
+            // slot, i.e., the one with the lower index
+            const std::size_t rowEnd = neighborInfo_.rowBegin(globI + 1);
+            for (std::size_t nbPos = neighborInfo_.rowBegin(globI); nbPos < rowEnd; ++nbPos) {
+                const unsigned slot = flowTable_.connectionSlot(nbPos);
+                if (slot == FlowTable::noSlot)
+                    continue;
                 OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachFace);
-                unsigned globJ = nbInfo.neighbor;
+                unsigned globJ = neighborInfo_.neighbor(nbPos);
                 assert(globJ != globI);
-                adres = 0.0;
-                darcyFlux = 0.0;
+                const ResidualNBInfo& res_nbinfo = neighborInfo_.resNBInfo(nbPos);
                 const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(globJ, /*timeIdx*/ 0);
-                LocalResidual::computeFlux(adres,darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo.res_nbinfo);
-                adres *= nbInfo.res_nbinfo.faceArea;
-                if (enableFlows) {
-                    for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx) {
-                        flowsInfo_[globI][loc].flow[eqIdx] = adres[eqIdx].value();
-                    }
-                }
-                if (enableFlores) {
-                    for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx) {
-                        floresInfo_[globI][loc].flow[eqIdx] = darcyFlux[eqIdx].value();
-                    }
-                }
-                ++loc;
+                LocalResidual::computeFluxValues(res, darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, res_nbinfo);
+                res *= res_nbinfo.faceArea;
+                if (enableFlows)
+                    flowTable_.set(FlowTable::flowsIdx, slot, res);
+                if (enableFlores)
+                    recordFlow_(FlowTable::floresIdx, slot, darcyFlux);
             }
             }
         }
+        }
+        loadStats.endLoop();
 
-        // Boundary terms. Only looping over cells with nontrivial bcs.
-        for (const auto& bdyInfo : boundaryInfo_) {
-            if (bdyInfo.bcdata.type == BCType::NONE)
-                continue;
-
-            ADVectorBlock adres(0.0);
-            const unsigned globI = bdyInfo.cell;
-            const auto& nbInfos = neighborInfo_[globI];
-            const IntensiveQuantities& insideIntQuants = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
-            LocalResidual::computeBoundaryFlux(adres, problem_(), bdyInfo.bcdata, insideIntQuants, globI);
-            adres *= bdyInfo.bcdata.faceArea;
-            const unsigned bfIndex = bdyInfo.bfIndex;
-            if (enableFlows) {
-                for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx) {
-                    flowsInfo_[globI][nbInfos.size() + bfIndex].flow[eqIdx] = adres[eqIdx].value();
-                }
+        // Boundary terms. Only looping over the faces with nontrivial bcs.
+        const std::size_t numBoundaryCells = activeBoundaryCellOffsets_.size() - 1;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::size_t bCellIdx = 0; bCellIdx < numBoundaryCells; ++bCellIdx) {
+            for (std::size_t pos = activeBoundaryCellOffsets_[bCellIdx]; pos < activeBoundaryCellOffsets_[bCellIdx + 1]; ++pos) {
+                const auto& bdyInfo = boundaryInfo_[activeBoundaryFaces_[pos]];
+                ADVectorBlock adres(0.0);
+                const unsigned globI = bdyInfo.cell;
+                const unsigned slot = flowTable_.boundarySlot(globI, bdyInfo.bfIndex);
+                if (!enableFlows || slot == FlowTable::noSlot)
+                    continue;
+                const IntensiveQuantities& insideIntQuants = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
+                LocalResidual::computeBoundaryFlux(adres, problem_(), bdyInfo.bcdata, insideIntQuants, globI);
+                adres *= bdyInfo.bcdata.faceArea;
+                recordFlow_(FlowTable::flowsIdx, slot, adres);
+                // TODO also store Flores?
             }
-            // TODO also store Flores?
         }
     }
 
 private:
-    template <class SubDomainType>
+    // Issue prefetch instructions for the cached intensive quantities of a cell. They are
+    // large and accessed in a fairly random order by the flux loop, so fetching them
+    // ahead of their use hides a good part of the memory latency.
+    void prefetchIntensiveQuantities_(unsigned globI) const
+    {
+        const IntensiveQuantities* intQuants = model_().cachedIntensiveQuantities(globI, /*timeIdx=*/0);
+        if (intQuants)
+            ::Opm::prefetch</*temporalLocality=*/1>(*intQuants);
+    }
+
+    // Prefetch the intensive quantities of a cell and of all its neighbors.
+    void prefetchNeighborIntensiveQuantities_(unsigned globI) const
+    {
+        prefetchIntensiveQuantities_(globI);
+        const std::size_t nbEnd = neighborInfo_.rowBegin(globI + 1);
+        for (std::size_t nbPos = neighborInfo_.rowBegin(globI); nbPos < nbEnd; ++nbPos)
+            prefetchIntensiveQuantities_(neighborInfo_.neighbor(nbPos));
+    }
+
+    // Evaluate the storage term of the previous time step. Only its value is required,
+    // so the intensive quantities are accessed by reference and the storage is
+    // computed for scalars instead of evaluations.
+    VectorBlock oldStorage_(unsigned globI) const
+    {
+        VectorBlock storage;
+        const IntensiveQuantities& intQuantOld = model_().intensiveQuantities(globI, /*timeIdx=*/1);
+        LocalResidual::computeStorage(storage, intQuantOld);
+        return storage;
+    }
+
+    // Linearize the domain. If 'residualOnly' is true, only the residual is evaluated and
+    // the Jacobian matrix is left untouched.
+    template <bool residualOnly, class SubDomainType>
     void linearize_(const SubDomainType& domain)
     {
         // This check should be removed once this is addressed by
@@ -731,69 +1465,253 @@ private:
         const unsigned int numCells = domain.cells.size();
         const bool on_full_domain = (numCells == model_().numTotalDof());
 
+        // The face based assembly is only available on the full domain: for sub-domains
+        // the faces of the domain boundary would need to be treated separately.
+        const bool faceBased = faceBasedFluxAssembly_ && on_full_domain && !faceColorOffsets_.empty();
+
+        // If flows are output for the current step, they are recorded by each
+        // linearization of the full domain. The last of these linearizations is done
+        // for the converged solution, which makes the separate sweep of
+        // updateFlowsInfo() unnecessary. The perturbed residuals of the matrix-free
+        // operator and the linearizations of sub-domains are not recorded, and the
+        // latter make recorded values stale.
+        if (on_full_domain && !perturbedResidual_) {
+            const auto& outputModule = simulator_().problem().eclWriter()->outputModule();
+            recordFlows_ = outputModule.hasFlows() || outputModule.hasBlockFlows();
+            recordFlores_ = outputModule.hasFlores();
+            createFlowsInfo_(recordFlows_, recordFlores_);
+        }
+        else if (!on_full_domain)
+            recordFlows_ = recordFlores_ = false;
+        const bool recordFlows = recordFlows_ && on_full_domain && !perturbedResidual_;
+        const bool withExtras = enableDispersion || aimCflThreshold_ > 0.0 || recordFlows_ || recordFlores_;
+
+        // The fluxes of the full domain can be computed by an accelerator while the
+        // host linearizes the storage and source terms. The kernel does not support
+        // any of the optional features.
+        const bool fluxesOffloaded = on_full_domain && !withExtras && offloadFluxes_();
+
+        // The cells and the faces are linearized by a kernel which is specialized for
+        // the common case without any of the optional features, i.e., without
+        // dispersion, the adaptive implicit method and the recording of the flows.
+        if (withExtras)
+            linearizeCellsAndFaces_<residualOnly, /*withExtras=*/true>(domain, faceBased, enableDispersion,
+                                                                     /*fluxesOffloaded=*/false);
+        else
+            linearizeCellsAndFaces_<residualOnly, /*withExtras=*/false>(domain, faceBased && !fluxesOffloaded,
+                                                                      /*enableDispersion=*/false, fluxesOffloaded);
+
+        if (fluxesOffloaded)
+            addOffloadedFluxes_<residualOnly>();
+
+        // The storage terms of all cells are now cached for the current solution. If
+        // this turns out to be the converged one, they are kept for the next time step.
+        if (on_full_domain && !perturbedResidual_)
+            model_().markStorageCacheCurrent();
+
+        // Add sparse source terms. For now only wells.
+        if (separateSparseSourceTerms_) {
+            if constexpr (residualOnly) {
+                // the well model always adds its derivatives, so let it write them
+                // to a scratch block instead of the Jacobian.
+                if (scratchDiagMatAddress_.empty())
+                    scratchDiagMatAddress_.assign(diagMatAddress_.size(), &scratchMatBlock_);
+                problem_().wellModel().addReservoirSourceTerms(residual_, scratchDiagMatAddress_);
+            }
+            else
+                problem_().wellModel().addReservoirSourceTerms(residual_, diagMatAddress_);
+        }
+
+        if (!sparseSourceBatches_.empty())
+            linearizeSparseSources_<residualOnly>(domain, on_full_domain);
+
+        // Boundary terms. Only looping over the faces with nontrivial bcs. The boundary
+        // faces are grouped by their cell, so each thread writes to distinct cells.
+        const std::size_t numBoundaryCells = activeBoundaryCellOffsets_.size() - 1;
 #ifdef _OPENMP
 #pragma omp parallel for
+#endif
+        for (std::size_t bCellIdx = 0; bCellIdx < numBoundaryCells; ++bCellIdx) {
+            for (std::size_t pos = activeBoundaryCellOffsets_[bCellIdx]; pos < activeBoundaryCellOffsets_[bCellIdx + 1]; ++pos) {
+                const auto& bdyInfo = boundaryInfo_[activeBoundaryFaces_[pos]];
+                ADVectorBlock adres(0.0);
+                const unsigned globI = bdyInfo.cell;
+                const IntensiveQuantities& insideIntQuants = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
+                LocalResidual::computeBoundaryFlux(adres, problem_(), bdyInfo.bcdata, insideIntQuants, globI);
+                adres *= bdyInfo.bcdata.faceArea;
+                if (recordFlows) {
+                    const unsigned slot = flowTable_.boundarySlot(globI, bdyInfo.bfIndex);
+                    if (slot != FlowTable::noSlot)
+                        recordFlow_(FlowTable::flowsIdx, slot, adres);
+                }
+                addResidualAndJacobian_<residualOnly>(globI, adres);
+            }
+        }
+
+        if constexpr (!residualOnly) {
+            if (aimCflThreshold_ > 0.0)
+                classifyCells_(domain);
+        }
+    }
+
+    // Linearize the registered sparse source terms. The chunks of their entries are
+    // distributed over the threads: since the entries of a cell are never split
+    // between chunks, each thread writes to distinct rows. For sub-domains, only the
+    // entries of the cells of the sub-domain are linearized.
+    template <bool residualOnly, class SubDomainType>
+    void linearizeSparseSources_(const SubDomainType& domain, bool onFullDomain)
+    {
+        if (!onFullDomain) {
+            sparseSourceDomainMask_.resize(model_().numTotalDof(), 0);
+            for (const auto globI : domain.cells)
+                sparseSourceDomainMask_[globI] = 1;
+        }
+
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr;
+        const std::size_t numChunks = sparseSourceChunkOffsets_.size() - 1;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            MatrixBlock scratchBlock(0.0);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for (std::size_t chunkIdx = 0; chunkIdx < numChunks; ++chunkIdx) {
+                try {
+                    for (std::size_t batchIdx = sparseSourceChunkOffsets_[chunkIdx];
+                         batchIdx < sparseSourceChunkOffsets_[chunkIdx + 1]; ++batchIdx)
+                    {
+                        const auto& batch = sparseSourceBatches_[batchIdx];
+                        auto* source = sparseSources_[batch.sourceIdx];
+                        typename BaseSparseSourceTerm<TypeTag>::Rows
+                            rows(residual_,
+                                 diagMatAddress_.data(),
+                                 sparseSourceCouplings_[batch.sourceIdx].data(),
+                                 residualOnly ? &scratchBlock : nullptr);
+                        if (onFullDomain) {
+                            source->linearize(batch.begin, batch.end, rows);
+                            continue;
+                        }
+
+                        const auto& cells = sparseSourceCells_[batch.sourceIdx];
+                        std::size_t runBegin = batch.begin;
+                        for (std::size_t entryIdx = batch.begin; entryIdx <= batch.end; ++entryIdx) {
+                            if (entryIdx == batch.end || !sparseSourceDomainMask_[cells[entryIdx]]) {
+                                if (runBegin < entryIdx)
+                                    source->linearize(runBegin, entryIdx, rows);
+                                runBegin = entryIdx + 1;
+                            }
+                        }
+                    }
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> take(exceptionLock);
+                    exceptionPtr = std::current_exception();
+                }
+            }
+        }
+
+        if (!onFullDomain)
+            for (const auto globI : domain.cells)
+                sparseSourceDomainMask_[globI] = 0;
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+    }
+
+    // Linearize the cells of a domain and the faces between them. If 'withExtras' is
+    // false, dispersion, the adaptive implicit method and the recording of the flows
+    // are disabled, and the corresponding code is removed at compile time. The
+    // remaining conditions do not change during the linearization and are evaluated
+    // before the loops.
+    template <bool residualOnly, bool withExtras, class SubDomainType>
+    void linearizeCellsAndFaces_(const SubDomainType& domain, bool faceBased, bool enableDispersion,
+                                 bool fluxesOffloaded)
+    {
+        const unsigned int numCells = domain.cells.size();
+        const bool on_full_domain = (numCells == model_().numTotalDof());
+        const bool enableStorageCache = model_().enableStorageCache();
+        // the storage terms at the start of the time step may have been taken over from
+        // the last linearization of the previous one
+        const bool updateStorageCache =
+            enableStorageCache
+            && model_().newtonMethod().numIterations() == 0
+            && !perturbedResidual_
+            && !model_().startOfStepStorageValid();
+        const bool recycleFirstIterationStorage = problem_().recycleFirstIterationStorage();
+        const bool separateSparseSourceTerms = separateSparseSourceTerms_;
+        const double dt = simulator_().timeStepSize();
+
+        static auto& loadStats =
+            ThreadLoadStatistics::get(residualOnly ? "TPFA residual" : "TPFA linearization");
+        loadStats.beginLoop();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+        auto threadScope = loadStats.threadScope();
+        // the static schedule matches the one of resetRows_()
+#ifdef _OPENMP
+#pragma omp for schedule(static) nowait
 #endif
         for (unsigned ii = 0; ii < numCells; ++ii) {
             OPM_TIMEBLOCK_LOCAL(linearizationForEachCell);
+            threadScope.addWorkItem();
             const unsigned globI = domain.cells[ii];
-            const auto& nbInfos = neighborInfo_[globI];
+            if (!faceBased && !fluxesOffloaded && prefetchDistance_ > 0 && ii + prefetchDistance_ < numCells)
+                prefetchNeighborIntensiveQuantities_(domain.cells[ii + prefetchDistance_]);
             VectorBlock res(0.0);
             MatrixBlock bMat(0.0);
             ADVectorBlock adres(0.0);
-            ADVectorBlock darcyFlux(0.0);
             const IntensiveQuantities& intQuantsIn = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
 
-            // Flux term.
-            {
-            OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachCell);
-            short loc = 0;
-            for (const auto& nbInfo : nbInfos) {
-                OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachFace);
-                unsigned globJ = nbInfo.neighbor;
-                assert(globJ != globI);
-                res = 0.0;
-                bMat = 0.0;
-                adres = 0.0;
-                darcyFlux = 0.0;
-                const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(globJ, /*timeIdx*/ 0);
-                LocalResidual::computeFlux(adres,darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo.res_nbinfo);
-                adres *= nbInfo.res_nbinfo.faceArea;
+            // the face velocities of the cell are reduced while the fluxes are added,
+            // which also happens after this loop for the face based assembly
+            if constexpr (withExtras) {
                 if (enableDispersion) {
-                    for (unsigned phaseIdx = 0; phaseIdx < numEq; ++ phaseIdx) {
-                        velocityInfo_[globI][loc].velocity[phaseIdx] = darcyFlux[phaseIdx].value() / nbInfo.res_nbinfo.faceArea;
-                    }
+                    cellNormVelocity_[globI] = 0.0;
+                }
+                if (!residualOnly && aimCflThreshold_ > 0.0) {
+                    aimFluxDerivatives_[globI] = 0.0;
                 }
-                setResAndJacobi(res, bMat, adres);
-                residual_[globI] += res;
-                //SparseAdapter syntax:  jacobian_->addToBlock(globI, globI, bMat);
-                *diagMatAddress_[globI] += bMat;
-                bMat *= -1.0;
-                //SparseAdapter syntax: jacobian_->addToBlock(globJ, globI, bMat);
-                *nbInfo.matBlockAddress += bMat;
-                ++loc;
+            }
+
+            // Flux term.
+            if (!faceBased && !fluxesOffloaded) {
+            OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachCell);
+            const std::size_t nbBegin = neighborInfo_.rowBegin(globI);
+            const std::size_t nbEnd = neighborInfo_.rowBegin(globI + 1);
+            for (std::size_t nbPos = nbBegin; nbPos < nbEnd; ++nbPos) {
+                addFlux_<residualOnly, withExtras>(globI, nbPos, intQuantsIn, enableDispersion);
             }
             }
 
             // Accumulation term.
-            double dt = simulator_().timeStepSize();
             double volume = model_().dofTotalVolume(globI);
             Scalar storefac = volume / dt;
-            adres = 0.0;
-            {
+            if constexpr (residualOnly) {
                 OPM_TIMEBLOCK_LOCAL(computeStorage);
-                LocalResidual::computeStorage(adres, intQuantsIn);
+                LocalResidual::computeStorage(res, intQuantsIn);
+            }
+            else {
+                adres = 0.0;
+                {
+                    OPM_TIMEBLOCK_LOCAL(computeStorage);
+                    LocalResidual::computeStorage(adres, intQuantsIn);
+                }
+                setResAndJacobi(res, bMat, adres);
             }
-            setResAndJacobi(res, bMat, adres);
             // Either use cached storage term, or compute it on the fly.
-            if (model_().enableStorageCache()) {
+            if (enableStorageCache) {
                 // The cached storage for timeIdx 0 (current time) is not
                 // used, but after storage cache is shifted at the end of the
                 // timestep, it will become cached storage for timeIdx 1.
                 model_().updateCachedStorage(globI, /*timeIdx=*/0, res);
-                if (model_().newtonMethod().numIterations() == 0) {
+                if (updateStorageCache) {
                     // Need to update the storage cache.
-                    if (problem_().recycleFirstIterationStorage()) {
+                    if (recycleFirstIterationStorage) {
                         // Assumes nothing have changed in the system which
                         // affects masses calculated from primary variables.
                         if (on_full_domain) {
@@ -806,66 +1724,253 @@ private:
                             model_().updateCachedStorage(globI, /*timeIdx=*/1, res);
                         }
                     } else {
-                        Dune::FieldVector<Scalar, numEq> tmp;
-                        IntensiveQuantities intQuantOld = model_().intensiveQuantities(globI, 1);
-                        LocalResidual::computeStorage(tmp, intQuantOld);
-                        model_().updateCachedStorage(globI, /*timeIdx=*/1, tmp);
+                        model_().updateCachedStorage(globI, /*timeIdx=*/1, oldStorage_(globI));
                     }
                 }
                 res -= model_().cachedStorage(globI, 1);
             } else {
                 OPM_TIMEBLOCK_LOCAL(computeStorage0);
-                Dune::FieldVector<Scalar, numEq> tmp;
-                IntensiveQuantities intQuantOld = model_().intensiveQuantities(globI, 1);
-                LocalResidual::computeStorage(tmp, intQuantOld);
                 // assume volume do not change
-                res -= tmp;
+                res -= oldStorage_(globI);
             }
             res *= storefac;
-            bMat *= storefac;
             residual_[globI] += res;
-            //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
-            *diagMatAddress_[globI] += bMat;
+            if constexpr (!residualOnly) {
+                bMat *= storefac;
+                //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
+                *diagMatAddress_[globI] += bMat;
+                if constexpr (withExtras) {
+                    if (aimCflThreshold_ > 0.0) {
+                        auto& storageDerivatives = aimStorageDerivatives_[globI];
+                        storageDerivatives = 0.0;
+                        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                                storageDerivatives[pvIdx] += std::abs(bMat[eqIdx][pvIdx]);
+                    }
+                }
+            }
 
             // Cell-wise source terms.
             // This will include well sources if SeparateSparseSourceTerms is false.
-            res = 0.0;
-            bMat = 0.0;
             adres = 0.0;
-            if (separateSparseSourceTerms_) {
+            if (separateSparseSourceTerms) {
                 LocalResidual::computeSourceDense(adres, problem_(), globI, 0);
             } else {
                 LocalResidual::computeSource(adres, problem_(), globI, 0);
             }
             adres *= -volume;
-            setResAndJacobi(res, bMat, adres);
-            residual_[globI] += res;
-            //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
-            *diagMatAddress_[globI] += bMat;
+            addResidualAndJacobian_<residualOnly>(globI, adres);
         } // end of loop for cell globI.
+        }
+        loadStats.endLoop();
+
+        // Flux term, face based variant. The faces of a given color do not share any
+        // cell, so the contributions of both sides of the faces can be written
+        // concurrently.
+        if (faceBased) {
+            OPM_TIMEBLOCK(fluxCalculationForEachFace);
+            const std::size_t numColors = faceColorOffsets_.size() - 1;
+            for (std::size_t colorIdx = 0; colorIdx < numColors; ++colorIdx) {
+                const std::size_t faceBegin = faceColorOffsets_[colorIdx];
+                const std::size_t faceEnd = faceColorOffsets_[colorIdx + 1];
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+                for (std::size_t faceIdx = faceBegin; faceIdx < faceEnd; ++faceIdx) {
+                    if (prefetchDistance_ > 0 && faceIdx + prefetchDistance_ < faceEnd) {
+                        const auto& aheadFace = faceInfo_[faceIdx + prefetchDistance_];
+                        prefetchIntensiveQuantities_(aheadFace.cellI);
+                        prefetchIntensiveQuantities_(aheadFace.cellJ);
+                    }
+                    const auto& face = faceInfo_[faceIdx];
+                    const IntensiveQuantities& intQuantsI = model_().intensiveQuantities(face.cellI, /*timeIdx*/ 0);
+                    const IntensiveQuantities& intQuantsJ = model_().intensiveQuantities(face.cellJ, /*timeIdx*/ 0);
+                    addFlux_<residualOnly, withExtras>(face.cellI,
+                                                       neighborInfo_.rowBegin(face.cellI) + face.locI,
+                                                       intQuantsI, enableDispersion);
+                    addFlux_<residualOnly, withExtras>(face.cellJ,
+                                                       neighborInfo_.rowBegin(face.cellJ) + face.locJ,
+                                                       intQuantsJ, enableDispersion);
+                }
+            }
+        }
 
-        // Add sparse source terms. For now only wells.
-        if (separateSparseSourceTerms_) {
-            problem_().wellModel().addReservoirSourceTerms(residual_, diagMatAddress_);
+    }
+
+    // Classify the cells of a domain for the next linearization of the adaptive
+    // implicit method. The CFL number of a cell with regard to a primary variable is
+    // estimated by the ratio of the derivatives of the fluxes out of the cell and of
+    // the derivatives of its storage term, which already contains the factor 1/dt. A
+    // cell is treated explicitly if this ratio is below the threshold for all primary
+    // variables except pressure.
+    template <class SubDomainType>
+    void classifyCells_(const SubDomainType& domain)
+    {
+        const unsigned numCells = domain.cells.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (unsigned ii = 0; ii < numCells; ++ii) {
+            const unsigned globI = domain.cells[ii];
+            const auto& fluxDerivatives = aimFluxDerivatives_[globI];
+            const auto& storageDerivatives = aimStorageDerivatives_[globI];
+
+            bool isExplicit = true;
+            for (unsigned pvIdx = 0; pvIdx < numEq && isExplicit; ++pvIdx) {
+                if (pvIdx == Indices::pressureSwitchIdx)
+                    continue;
+                isExplicit = fluxDerivatives[pvIdx] < aimCflThreshold_*storageDerivatives[pvIdx];
+            }
+            aimExplicitCell_[globI] = isExplicit;
         }
+    }
 
-        // Boundary terms. Only looping over cells with nontrivial bcs.
-        for (const auto& bdyInfo : boundaryInfo_) {
-            if (bdyInfo.bcdata.type == BCType::NONE)
-                continue;
+    // Add a cell local term to the residual of a cell and, unless only the residual is
+    // requested, its derivatives to the diagonal block of the Jacobian.
+    template <bool residualOnly>
+    void addResidualAndJacobian_(unsigned globI, const ADVectorBlock& adres)
+    {
+        if constexpr (residualOnly) {
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                residual_[globI][eqIdx] += adres[eqIdx].value();
+        }
+        else {
+            //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
+            addResAndJacobi_(residual_[globI], *diagMatAddress_[globI], adres);
+        }
+    }
 
-            VectorBlock res(0.0);
-            MatrixBlock bMat(0.0);
-            ADVectorBlock adres(0.0);
-            const unsigned globI = bdyInfo.cell;
-            const IntensiveQuantities& insideIntQuants = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
-            LocalResidual::computeBoundaryFlux(adres, problem_(), bdyInfo.bcdata, insideIntQuants, globI);
-            adres *= bdyInfo.bcdata.faceArea;
-            setResAndJacobi(res, bMat, adres);
-            residual_[globI] += res;
-            ////SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
-            *diagMatAddress_[globI] += bMat;
+    // Add the values of an AD vector to a residual block and its derivatives to a
+    // Jacobian block. In contrast to setResAndJacobi(), this does not require a
+    // temporary dense block which would be written and then read again.
+    static void addResAndJacobi_(VectorBlock& res, MatrixBlock& bMat, const ADVectorBlock& resid)
+    {
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            res[eqIdx] += resid[eqIdx].value();
+            auto& row = bMat[eqIdx];
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                row[pvIdx] += resid[eqIdx].derivative(pvIdx);
+        }
+    }
+
+    // Add the values of the flux over a face to the residual block of the interior
+    // cell, its derivatives to the diagonal block of the interior cell and the negative
+    // derivatives to the block of the exterior cell, all within a single pass over the
+    // derivatives.
+    static void addFluxResAndJacobi_(VectorBlock& res,
+                                     MatrixBlock& diagMat,
+                                     MatrixBlock& nbMat,
+                                     const ADVectorBlock& resid)
+    {
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            res[eqIdx] += resid[eqIdx].value();
+            auto& diagRow = diagMat[eqIdx];
+            auto& nbRow = nbMat[eqIdx];
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+                const Scalar d = resid[eqIdx].derivative(pvIdx);
+                diagRow[pvIdx] += d;
+                nbRow[pvIdx] -= d;
+            }
+        }
+    }
+
+    // Like addFluxResAndJacobi_(), but only the derivatives with regard to the pressure
+    // are added. This is used for the explicit cells of the adaptive implicit method,
+    // whose remaining flux derivatives are dropped from the Jacobian.
+    static void addFluxResAndPressureJacobi_(VectorBlock& res,
+                                             MatrixBlock& diagMat,
+                                             MatrixBlock& nbMat,
+                                             const ADVectorBlock& resid)
+    {
+        constexpr unsigned pvIdx = Indices::pressureSwitchIdx;
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            res[eqIdx] += resid[eqIdx].value();
+            const Scalar d = resid[eqIdx].derivative(pvIdx);
+            diagMat[eqIdx][pvIdx] += d;
+            nbMat[eqIdx][pvIdx] -= d;
+        }
+    }
+
+    // Store the values of a flux for output in a slot of the flow table.
+    void recordFlow_(unsigned quantityIdx, unsigned slot, const ADVectorBlock& flux)
+    {
+        VectorBlock values;
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            values[eqIdx] = flux[eqIdx].value();
+        flowTable_.set(quantityIdx, slot, values);
+    }
+
+    // Add the flux over a face to the residual of the cell globI and its derivatives
+    // with regard to the primary variables of globI to the Jacobian. Since the
+    // intensive quantities only carry derivatives for the variables of their own cell,
+    // the derivatives with regard to the neighbor's variables are added when the face is
+    // linearized from the neighbor's side. 'nbPos' is the position of the connection in
+    // the field arrays of neighborInfo_. If dispersion is enabled, the maximum of the
+    // absolute face velocities of globI is accumulated as well; its entry must have been
+    // reset before the first face of the cell.
+    template <bool residualOnly, bool withExtras>
+    void addFlux_(unsigned globI,
+                  std::size_t nbPos,
+                  const IntensiveQuantities& intQuantsIn,
+                  bool enableDispersion)
+    {
+        OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachFace);
+        unsigned globJ = neighborInfo_.neighbor(nbPos);
+        const ResidualNBInfo& res_nbinfo = neighborInfo_.resNBInfo(nbPos);
+        assert(globJ != globI);
+        ADVectorBlock adres(0.0);
+        ADVectorBlock darcyFlux(0.0);
+        const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(globJ, /*timeIdx*/ 0);
+        LocalResidual::computeFlux(adres,darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, res_nbinfo);
+        adres *= res_nbinfo.faceArea;
+        if constexpr (withExtras) {
+            if (enableDispersion) {
+                auto& normVelocity = cellNormVelocity_[globI];
+                for (unsigned phaseIdx = 0; phaseIdx < numEq; ++ phaseIdx) {
+                    normVelocity[phaseIdx] = std::max(normVelocity[phaseIdx],
+                                                      std::abs(darcyFlux[phaseIdx].value() / res_nbinfo.faceArea));
+                }
+            }
+            if ((recordFlows_ || recordFlores_) && !perturbedResidual_) {
+                // only the cell which owns the slot of the face records it
+                const unsigned slot = flowTable_.connectionSlot(nbPos);
+                if (slot != FlowTable::noSlot) {
+                    if (recordFlows_)
+                        recordFlow_(FlowTable::flowsIdx, slot, adres);
+                    if (recordFlores_)
+                        recordFlow_(FlowTable::floresIdx, slot, darcyFlux);
+                }
+            }
+        }
+        if constexpr (residualOnly) {
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                residual_[globI][eqIdx] += adres[eqIdx].value();
+            return;
+        }
+
+        if constexpr (withExtras) {
+            if (aimCflThreshold_ > 0.0) {
+                auto& fluxDerivatives = aimFluxDerivatives_[globI];
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                        fluxDerivatives[pvIdx] += std::abs(adres[eqIdx].derivative(pvIdx));
+
+                if (aimExplicitCell_[globI]) {
+                    addFluxResAndPressureJacobi_(residual_[globI],
+                                                 *diagMatAddress_[globI],
+                                                 *neighborInfo_.matBlockAddress(nbPos),
+                                                 adres);
+                    return;
+                }
+            }
         }
+
+        //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
+        //                      jacobian_->addToBlock(globJ, globI, -bMat);
+        addFluxResAndJacobi_(residual_[globI],
+                             *diagMatAddress_[globI],
+                             *neighborInfo_.matBlockAddress(nbPos),
+                             adres);
     }
 
     void updateStoredTransmissibilities()
@@ -876,19 +1981,155 @@ private:
             // that will also initialize the residual consistently.
             initFirstIteration_();
         }
+        invalidateOffloadedStructure_();
         unsigned numCells = model_().numTotalDof();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
         for (unsigned globI = 0; globI < numCells; globI++) {
-            auto nbInfos = neighborInfo_[globI]; // nbInfos will be a SparseTable<...>::mutable_iterator_range.
-            for (auto& nbInfo : nbInfos) {
-                unsigned globJ = nbInfo.neighbor;
-                nbInfo.res_nbinfo.trans = problem_().transmissibility(globI, globJ);
+            const std::size_t nbEnd = neighborInfo_.rowBegin(globI + 1);
+            for (std::size_t nbPos = neighborInfo_.rowBegin(globI); nbPos < nbEnd; ++nbPos) {
+                unsigned globJ = neighborInfo_.neighbor(nbPos);
+                neighborInfo_.resNBInfo(nbPos).trans = problem_().transmissibility(globI, globJ);
+            }
+        }
+    }
+
+    /*!
+     * \brief Update the transmissibilities of some faces only.
+     *
+     * Each face is given by the pair of cells which it connects, in any order. Both
+     * directions of all connections between the two cells are refreshed.
+     */
+    void updateStoredTransmissibilities(const std::vector<std::pair<unsigned, unsigned>>& faces)
+    {
+        if (neighborInfo_.empty()) {
+            // see above. Since all transmissibilities are set by the construction of
+            // the neighbor table, there is nothing left to do afterwards.
+            initFirstIteration_();
+            return;
+        }
+
+        invalidateOffloadedStructure_();
+
+        // the faces are usually few and may share cells, so they are processed
+        // sequentially
+        for (const auto& [globI, globJ] : faces) {
+            const std::size_t nbEnd = neighborInfo_.rowBegin(globI + 1);
+            for (std::size_t nbPos = neighborInfo_.rowBegin(globI); nbPos < nbEnd; ++nbPos) {
+                if (neighborInfo_.neighbor(nbPos) != globJ)
+                    continue;
+
+                const std::size_t oppositePos = oppositeConnection_[nbPos];
+                neighborInfo_.resNBInfo(nbPos).trans = problem_().transmissibility(globI, globJ);
+                neighborInfo_.resNBInfo(oppositePos).trans = problem_().transmissibility(globJ, globI);
             }
         }
     }
 
+    template <class ProblemType>
+    static auto detectChangedTransmissibilityFaces_(int)
+        -> decltype(std::declval<const ProblemType&>()
+                        .changedTransmissibilityFaces(std::declval<std::vector<std::pair<unsigned, unsigned>>&>()),
+                    std::true_type{});
+
+    template <class ProblemType>
+    static std::false_type detectChangedTransmissibilityFaces_(long);
+
+    static constexpr bool hasChangedTransmissibilityFaces_()
+    { return decltype(detectChangedTransmissibilityFaces_<Problem>(0))::value; }
+
+    // the local residual may provide a kernel which computes the fluxes of all cells
+    // on an accelerator, see BlackOilOffloadFluxKernel
+    struct NoOffloadFluxKernel_
+    {
+        static constexpr bool supported = false;
+    };
+
+    template <class LocalResidualType>
+    static typename LocalResidualType::OffloadFluxKernel detectOffloadFluxKernel_(int);
+
+    template <class LocalResidualType>
+    static NoOffloadFluxKernel_ detectOffloadFluxKernel_(long);
+
+    using OffloadFluxKernel = decltype(detectOffloadFluxKernel_<LocalResidual>(0));
+
+    static constexpr bool offloadFluxSupported_()
+    { return OffloadFluxKernel::supported; }
+
+    // Compute the fluxes of all cells by the offloaded kernel. Returns false if the
+    // kernel is not available or cannot handle the current state, in which case the
+    // fluxes need to be linearized by the host.
+    bool offloadFluxes_()
+    {
+        if constexpr (offloadFluxSupported_()) {
+            if (!offloadFluxAssembly_)
+                return false;
+
+            OPM_TIMEBLOCK(offloadedFluxes);
+            if (!offloadFluxKernel_)
+                offloadFluxKernel_ = std::make_unique<OffloadFluxKernel>();
+            if (!offloadFluxKernel_->hasStructure())
+                offloadFluxKernel_->setStructure(neighborInfo_);
+            if (!offloadFluxKernel_->updateCellQuantities(model_()))
+                return false;
+
+            offloadFluxKernel_->computeFluxes();
+            return true;
+        }
+        else
+            return false;
+    }
+
+    // Add the fluxes computed by the offloaded kernel to the residual and the
+    // Jacobian. The derivatives of the flux over a connection with regard to the
+    // cell from whose side it was computed enter the diagonal block of the cell and,
+    // with the opposite sign, the block of the neighbor's row, which is not touched
+    // by any other connection.
+    template <bool residualOnly>
+    void addOffloadedFluxes_()
+    {
+        if constexpr (offloadFluxSupported_()) {
+            const auto& kernel = *offloadFluxKernel_;
+            const unsigned numCells = model_().numTotalDof();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (unsigned globI = 0; globI < numCells; ++globI) {
+                const Scalar* res = kernel.residual(globI);
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    residual_[globI][eqIdx] += res[eqIdx];
+
+                if constexpr (!residualOnly) {
+                    const Scalar* diag = kernel.diagonal(globI);
+                    auto& diagMat = *diagMatAddress_[globI];
+                    for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                        for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                            diagMat[eqIdx][pvIdx] += diag[eqIdx*numEq + pvIdx];
+
+                    const std::size_t nbEnd = neighborInfo_.rowBegin(globI + 1);
+                    for (std::size_t nbPos = neighborInfo_.rowBegin(globI); nbPos < nbEnd; ++nbPos) {
+                        const Scalar* offDiag = kernel.offDiagonal(nbPos);
+                        auto& nbMat = *neighborInfo_.matBlockAddress(nbPos);
+                        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                                nbMat[eqIdx][pvIdx] -= offDiag[eqIdx*numEq + pvIdx];
+                    }
+                }
+            }
+        }
+    }
+
+    // the copy of the connections held by the offloaded kernel needs to be refreshed
+    // if the transmissibilities change
+    void invalidateOffloadedStructure_()
+    {
+        if constexpr (offloadFluxSupported_()) {
+            if (offloadFluxKernel_)
+                offloadFluxKernel_->release();
+        }
+    }
+
 
     Simulator *simulatorPtr_;
 
@@ -901,29 +2142,53 @@ private:
     LinearizationType linearizationType_;
 
     using ResidualNBInfo = typename LocalResidual::ResidualNBInfo;
-    struct NeighborInfo
-    {
-        unsigned int neighbor;
-        ResidualNBInfo res_nbinfo;
-        MatrixBlock* matBlockAddress;
-    };
-    SparseTable<NeighborInfo> neighborInfo_;
+    // the connections of the cells. The fields of the connections are stored in
+    // separate arrays, so the loops only need to stream the data which they use.
+    using NeighborTable = TpfaNeighborTable<ResidualNBInfo, MatrixBlock>;
+    using NeighborInfo = typename NeighborTable::Entry;
+    NeighborTable neighborInfo_;
     std::vector<MatrixBlock*> diagMatAddress_;
-
-    struct FlowInfo
-    {
-        int faceId;
-        VectorBlock flow;
-        unsigned int nncId;
-    };
-    SparseTable<FlowInfo> flowsInfo_;
-    SparseTable<FlowInfo> floresInfo_;
-
-    struct VelocityInfo
+    bool perturbedResidual_ = false;
+    // sink for the derivatives of the sparse source terms in residual-only mode
+    std::vector<MatrixBlock*> scratchDiagMatAddress_;
+    MatrixBlock scratchMatBlock_;
+
+    // the registered sparse source terms, see addSparseSourceTerm(). Their entries are
+    // merged into batches of consecutive entries of the same source term, which are
+    // sorted by their cells and grouped into chunks that do not share any cell.
+    struct SparseSourceBatch
     {
-        VectorBlock velocity;
+        unsigned firstCell;
+        unsigned lastCell;
+        unsigned sourceIdx;
+        std::size_t begin;
+        std::size_t end;
     };
-    SparseTable<VelocityInfo> velocityInfo_;
+    static constexpr std::size_t sparseSourceChunkSize = 16;
+    std::vector<BaseSparseSourceTerm<TypeTag>*> sparseSources_;
+    std::vector<std::vector<unsigned>> sparseSourceCells_;
+    std::vector<std::vector<MatrixBlock*>> sparseSourceCouplings_;
+    std::vector<SparseSourceBatch> sparseSourceBatches_;
+    std::vector<std::size_t> sparseSourceChunkOffsets_ = std::vector<std::size_t>(1, 0);
+    std::vector<unsigned char> sparseSourceDomainMask_;
+
+    // the flows and flores of the faces requested for output and the cells whose
+    // faces are requested (all cells if empty)
+    using FlowTable = TpfaFlowTable<Scalar, numEq>;
+    FlowTable flowTable_;
+    std::vector<unsigned char> flowsOutputCells_;
+    bool flowsInSinglePrecision_ = false;
+
+    std::vector<VectorBlock> cellNormVelocity_;
+
+    // the adaptive implicit method: the threshold of the CFL number below which the
+    // fluxes of a cell are only linearized with regard to pressure, the sums of the
+    // absolute flux and storage derivatives of each cell with regard to each primary
+    // variable and the classification of the cells
+    Scalar aimCflThreshold_ = 0.0;
+    std::vector<VectorBlock> aimFluxDerivatives_;
+    std::vector<VectorBlock> aimStorageDerivatives_;
+    std::vector<unsigned char> aimExplicitCell_;
 
     using ScalarFluidState = typename IntensiveQuantities::ScalarFluidState;
     struct BoundaryConditionData
@@ -944,12 +2209,45 @@ private:
         BoundaryConditionData bcdata;
     };
     std::vector<BoundaryInfo> boundaryInfo_;
-    bool separateSparseSourceTerms_ = false;
-    struct FullDomain
+    // start of the range of boundaryInfo_ for each cell which has boundary faces
+    std::vector<std::size_t> boundaryCellOffsets_ = std::vector<std::size_t>(1, 0);
+    // the cells which have boundary faces and the index of their range of boundaryInfo_,
+    // sorted by the cells
+    std::vector<std::pair<unsigned, unsigned>> boundaryCellLookup_;
+    // the indices of the boundary faces whose type is not BCType::NONE, grouped by
+    // their cells, and the start of the range of each of these cells
+    std::vector<std::size_t> activeBoundaryFaces_;
+    std::vector<std::size_t> activeBoundaryCellOffsets_ = std::vector<std::size_t>(1, 0);
+
+    // the faces used by the face based flux assembly, sorted by color
+    struct FaceInfo
     {
-        std::vector<int> cells;
-        std::vector<bool> interior;
+        unsigned int cellI;
+        unsigned int cellJ;
+        unsigned int locI; // index of the face in neighborInfo_[cellI]
+        unsigned int locJ; // index of the face in neighborInfo_[cellJ]
     };
+    std::vector<FaceInfo> faceInfo_;
+    std::vector<std::size_t> faceColorOffsets_;
+
+    // the position of the connection in the opposite direction for each connection of
+    // neighborInfo_
+    std::vector<std::size_t> oppositeConnection_;
+    // the faces with changed transmissibilities reported by the problem
+    std::vector<std::pair<unsigned, unsigned>> changedFaces_;
+
+    // whether the flows and flores were recorded by the last linearization of the full
+    // domain, see linearize_()
+    bool recordFlows_ = false;
+    bool recordFlores_ = false;
+
+    bool separateSparseSourceTerms_ = false;
+    bool faceBasedFluxAssembly_ = false;
+    bool offloadFluxAssembly_ = false;
+    std::unique_ptr<OffloadFluxKernel> offloadFluxKernel_;
+    bool reorderCells_ = false;
+    unsigned prefetchDistance_ = 1;
+    using FullDomain = CellDomain;
     FullDomain fullDomain_;
 };
 
@@ -0,0 +1,274 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::TpfaNeighborTable
+ */
+#ifndef TPFA_NEIGHBOR_TABLE_HH
+#define TPFA_NEIGHBOR_TABLE_HH
+
+#include <cassert>
+#include <cstddef>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief The connections of each cell used by the TPFA linearizer, stored as a
+ *        structure of arrays.
+ *
+ * Conceptually this is a sparse table of (neighbor, residual info, matrix block
+ * address) records with one row per cell, i.e., it supports the same row-wise
+ * access as a SparseTable of such records. Internally, each field is stored in
+ * its own contiguous array so that loops which only need some of the fields,
+ * e.g. the neighbor indices, do not have to stream the remaining ones through the
+ * memory hierarchy.
+ */
+template <class ResidualNBInfo, class MatrixBlock>
+class TpfaNeighborTable
+{
+public:
+    //! The record which is used to append rows and which represents a single entry.
+    struct Entry
+    {
+        unsigned int neighbor;
+        ResidualNBInfo res_nbinfo;
+        MatrixBlock* matBlockAddress;
+    };
+
+private:
+    template <bool isConst>
+    struct EntryRef
+    {
+        using NBInfoRef = std::conditional_t<isConst, const ResidualNBInfo&, ResidualNBInfo&>;
+        using BlockPtrRef = std::conditional_t<isConst, MatrixBlock* const&, MatrixBlock*&>;
+
+        unsigned int neighbor;
+        NBInfoRef res_nbinfo;
+        BlockPtrRef matBlockAddress;
+    };
+
+    template <bool isConst>
+    class Row
+    {
+        using Table = std::conditional_t<isConst, const TpfaNeighborTable, TpfaNeighborTable>;
+
+    public:
+        class iterator
+        {
+        public:
+            iterator(Table& table, std::size_t pos)
+                : table_(&table), pos_(pos)
+            {}
+
+            EntryRef<isConst> operator*() const
+            { return table_->entry_(pos_); }
+
+            iterator& operator++()
+            { ++pos_; return *this; }
+
+            bool operator==(const iterator& other) const
+            { return pos_ == other.pos_; }
+
+            bool operator!=(const iterator& other) const
+            { return pos_ != other.pos_; }
+
+        private:
+            Table* table_;
+            std::size_t pos_;
+        };
+
+        Row(Table& table, std::size_t begin, std::size_t end)
+            : table_(table), begin_(begin), end_(end)
+        {}
+
+        std::size_t size() const
+        { return end_ - begin_; }
+
+        bool empty() const
+        { return begin_ == end_; }
+
+        EntryRef<isConst> operator[](std::size_t idx) const
+        {
+            assert(idx < size());
+            return table_.entry_(begin_ + idx);
+        }
+
+        iterator begin() const
+        { return iterator(table_, begin_); }
+
+        iterator end() const
+        { return iterator(table_, end_); }
+
+    private:
+        Table& table_;
+        std::size_t begin_;
+        std::size_t end_;
+    };
+
+public:
+    using row_type = Row</*isConst=*/true>;
+    using mutable_row_type = Row</*isConst=*/false>;
+
+    TpfaNeighborTable()
+        : rowStart_(1, 0)
+    {}
+
+    /*!
+     * \brief Reserve memory for a given number of rows and entries.
+     */
+    void reserve(std::size_t numRows, std::size_t numEntries)
+    {
+        rowStart_.reserve(numRows + 1);
+        neighbor_.reserve(numEntries);
+        resNBInfo_.reserve(numEntries);
+        matBlockAddress_.reserve(numEntries);
+    }
+
+    /*!
+     * \brief Append a row given by a range of Entry objects.
+     */
+    template <class EntryIterator>
+    void appendRow(EntryIterator begin, EntryIterator end)
+    {
+        for (; begin != end; ++begin) {
+            neighbor_.push_back(begin->neighbor);
+            resNBInfo_.push_back(begin->res_nbinfo);
+            matBlockAddress_.push_back(begin->matBlockAddress);
+        }
+        rowStart_.push_back(neighbor_.size());
+    }
+
+    /*!
+     * \brief Replace the content of the table by rows of given sizes.
+     *
+     * The entries are value initialized. Since the positions of all rows are known
+     * afterwards, the rows can be filled concurrently using the field-wise accessors.
+     */
+    void resizeRows(const std::vector<std::size_t>& rowSizes)
+    {
+        rowStart_.resize(rowSizes.size() + 1);
+        rowStart_[0] = 0;
+        std::partial_sum(rowSizes.begin(), rowSizes.end(), rowStart_.begin() + 1);
+
+        const std::size_t numEntries = rowStart_.back();
+        neighbor_.assign(numEntries, 0);
+        resNBInfo_.assign(numEntries, ResidualNBInfo{});
+        matBlockAddress_.assign(numEntries, nullptr);
+    }
+
+    /*!
+     * \brief Returns true if the table does not contain any rows.
+     */
+    bool empty() const
+    { return rowStart_.size() == 1; }
+
+    /*!
+     * \brief Returns the number of rows of the table.
+     */
+    std::size_t size() const
+    { return rowStart_.size() - 1; }
+
+    /*!
+     * \brief Returns the total number of entries of the table.
+     */
+    std::size_t dataSize() const
+    { return neighbor_.size(); }
+
+    /*!
+     * \brief Returns the number of bytes which are allocated by the table.
+     */
+    std::size_t memoryUsage() const
+    {
+        return rowStart_.capacity()*sizeof(std::size_t)
+            + neighbor_.capacity()*sizeof(unsigned int)
+            + resNBInfo_.capacity()*sizeof(ResidualNBInfo)
+            + matBlockAddress_.capacity()*sizeof(MatrixBlock*);
+    }
+
+    /*!
+     * \brief Returns the number of entries of a row.
+     */
+    std::size_t rowSize(std::size_t row) const
+    { return rowStart_[row + 1] - rowStart_[row]; }
+
+    /*!
+     * \brief Returns the index of the first entry of a row in the field arrays.
+     */
+    std::size_t rowBegin(std::size_t row) const
+    { return rowStart_[row]; }
+
+    row_type operator[](std::size_t row) const
+    { return row_type(*this, rowStart_[row], rowStart_[row + 1]); }
+
+    mutable_row_type operator[](std::size_t row)
+    { return mutable_row_type(*this, rowStart_[row], rowStart_[row + 1]); }
+
+    /*!
+     * \brief Field-wise access to the neighbor index of the entry at a given position.
+     */
+    unsigned int neighbor(std::size_t pos) const
+    { return neighbor_[pos]; }
+
+    unsigned int& neighbor(std::size_t pos)
+    { return neighbor_[pos]; }
+
+    /*!
+     * \brief Field-wise access to the residual info of the entry at a given position.
+     */
+    const ResidualNBInfo& resNBInfo(std::size_t pos) const
+    { return resNBInfo_[pos]; }
+
+    ResidualNBInfo& resNBInfo(std::size_t pos)
+    { return resNBInfo_[pos]; }
+
+    /*!
+     * \brief Field-wise access to the off-diagonal matrix block of the entry at a given position.
+     */
+    MatrixBlock* matBlockAddress(std::size_t pos) const
+    { return matBlockAddress_[pos]; }
+
+    MatrixBlock*& matBlockAddress(std::size_t pos)
+    { return matBlockAddress_[pos]; }
+
+private:
+    EntryRef<true> entry_(std::size_t pos) const
+    { return EntryRef<true>{neighbor_[pos], resNBInfo_[pos], matBlockAddress_[pos]}; }
+
+    EntryRef<false> entry_(std::size_t pos)
+    { return EntryRef<false>{neighbor_[pos], resNBInfo_[pos], matBlockAddress_[pos]}; }
+
+    std::vector<std::size_t> rowStart_;
+    std::vector<unsigned int> neighbor_;
+    std::vector<ResidualNBInfo> resNBInfo_;
+    std::vector<MatrixBlock*> matBlockAddress_;
+};
+
+} // namespace Opm
+
+#endif // TPFA_NEIGHBOR_TABLE_HH
@@ -37,6 +37,7 @@
 
 #include <opm/simulators/linalg/elementborderlistfromgrid.hh>
 #include <opm/models/discretization/common/fvbasediscretization.hh>
+#include <opm/models/parallel/gridghostexchange.hh>
 
 #if HAVE_DUNE_FEM
 #include <opm/models/discretization/common/fvbasediscretizationfemadapt.hh>
@@ -44,6 +45,9 @@
 #include <dune/fem/space/finitevolume.hh>
 #endif
 
+#include <memory>
+#include <type_traits>
+
 namespace Opm {
 template <class TypeTag>
 class EcfvDiscretization;
@@ -152,6 +156,9 @@ class EcfvDiscretization : public GetPropType<TypeTag, Properties::BaseDiscretiz
     using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
     using GridView = GetPropType<TypeTag, Properties::GridView>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using Stencil = GetPropType<TypeTag, Properties::Stencil>;
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using GhostExchange = GridGhostExchange<GridView, DofMapper, /*commCodim=*/0>;
 
 public:
     EcfvDiscretization(Simulator& simulator)
@@ -177,6 +184,24 @@ public:
     const DofMapper& dofMapper() const
     { return this->elementMapper(); }
 
+    /*!
+     * \brief Precompute the topology and the faces of the stencils of all elements.
+     */
+    void updateStencilCache()
+    {
+        if (this->enableStencilCache())
+            stencilCache_.update(this->gridView_, this->elementMapper());
+    }
+
+    /*!
+     * \brief Attach the stencil of an element context to the precomputed stencils.
+     */
+    void prepareStencil(Stencil& stencil) const
+    {
+        if (this->enableStencilCache())
+            stencil.setGeometryCache(&stencilCache_);
+    }
+
     /*!
      * \brief Syncronize the values of the primary variables on the
      *        degrees of freedom that overlap with the neighboring
@@ -185,9 +210,20 @@ public:
      * For the Element Centered Finite Volume discretization, this
      * method retrieves the primary variables corresponding to
      * overlap/ghost elements from their respective master process.
+     * Unless the grid may be adapted, the indices to be exchanged are
+     * determined once and the values are sent in contiguous buffers.
      */
     void syncOverlap()
     {
+        if (this->gridView().comm().size() < 2)
+            return;
+
+        if (!this->enableGridAdaptation()) {
+            finishSyncOverlap();
+            ghostExchange_().ghostSync(this->solution(/*timeIdx=*/0));
+            return;
+        }
+
         // syncronize the solution on the ghost and overlap elements
         using GhostSyncHandle = GridCommHandleGhostSync<PrimaryVariables,
                                                         SolutionVector,
@@ -201,6 +237,56 @@ public:
                                      Dune::ForwardCommunication);
     }
 
+    /*!
+     * \brief Start to retrieve the primary variables of the overlap and ghost elements
+     *        from their respective master processes.
+     *
+     * Unless the grid may be adapted, the values are sent without waiting for the
+     * ones to be received, which only happens in finishSyncOverlap().
+     */
+    void beginSyncOverlap()
+    {
+        if (this->gridView().comm().size() > 1 && !this->enableGridAdaptation())
+            ghostExchange_().beginGhostSync(this->solution(/*timeIdx=*/0));
+        else
+            syncOverlap();
+    }
+
+    /*!
+     * \brief Receive the primary variables of the overlap and ghost elements if an
+     *        exchange has been started by beginSyncOverlap().
+     */
+    void finishSyncOverlap() const
+    {
+        if (overlapSyncPending())
+            ghostExchange_().finishGhostSync(this->mutableSolution(/*timeIdx=*/0));
+    }
+
+    /*!
+     * \brief Returns whether the primary variables of the overlap are still being
+     *        received from their master processes.
+     */
+    bool overlapSyncPending() const
+    { return ghostExchangePtr_ && ghostExchangePtr_->exchangePending(); }
+
+    /*!
+     * \brief Receive the cached intensive quantities of the overlap and ghost
+     *        elements from their respective master processes.
+     *
+     * The intensive quantities are copied bytewise, i.e., this only works if the
+     * intensive quantities of the model are trivially copyable.
+     */
+    void syncOverlapIntensiveQuantities(unsigned timeIdx) const
+    {
+        // the primary variables and the intensive quantities share the message buffers
+        finishSyncOverlap();
+
+        if constexpr (std::is_trivially_copyable_v<IntensiveQuantities>) {
+            const unsigned slotIdx = this->intensiveQuantityCacheSlot_(timeIdx);
+            ghostExchange_().ghostSync(this->intensiveQuantityCache_[slotIdx]);
+        }
+    }
+
     /*!
      * \brief Serializes the current state of the model.
      *
@@ -227,10 +313,21 @@ public:
     }
 
 private:
+    GhostExchange& ghostExchange_() const
+    {
+        if (!ghostExchangePtr_)
+            ghostExchangePtr_ = std::make_unique<GhostExchange>(this->gridView(),
+                                                                asImp_().dofMapper());
+        return *ghostExchangePtr_;
+    }
+
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
     const Implementation& asImp_() const
     { return *static_cast<const Implementation*>(this); }
+
+    typename Stencil::GeometryCache stencilCache_;
+    mutable std::unique_ptr<GhostExchange> ghostExchangePtr_;
 };
 } // namespace Opm
 
@@ -34,6 +34,7 @@
 
 #include <dune/grid/common/mcmgmapper.hh>
 #include <dune/grid/common/intersectioniterator.hh>
+#include <dune/grid/common/rangegenerators.hh>
 #include <dune/geometry/type.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
@@ -253,6 +254,107 @@ public:
     using SubControlVolumeFace = EcfvSubControlVolumeFace<needFaceIntegrationPos, needFaceNormal>;
     using BoundaryFace = EcfvSubControlVolumeFace</*needFaceIntegrationPos=*/true, needFaceNormal>;
 
+    /*!
+     * \brief The precomputed topology and face geometry of the stencils of all elements
+     *        of a grid view.
+     *
+     * Iterating over the intersections of an element is expensive for many grids
+     * compared to reading the faces from an array. If a cache is attached to a stencil,
+     * updateTopology() takes the neighbors and the faces of the element from the cache.
+     * The cache must be updated whenever the grid changes.
+     */
+    class GeometryCache
+    {
+        using ElementSeed = typename Element::EntitySeed;
+
+        struct Entry
+        {
+            unsigned interiorFaceBegin;
+            unsigned numInteriorFaces;
+            unsigned boundaryFaceBegin;
+            unsigned numBoundaryFaces;
+        };
+
+    public:
+        /*!
+         * \brief Compute the stencils of all elements.
+         *
+         * \param elementMapper The mapper which is used to look up the elements. It
+         *                      must outlive the cache.
+         */
+        void update(const GridView& gridView, const Mapper& elementMapper)
+        {
+            entries_.clear();
+            entries_.resize(static_cast<std::size_t>(elementMapper.size()));
+            neighborSeeds_.clear();
+            interiorFaces_.clear();
+            boundaryFaces_.clear();
+            elementMapper_ = &elementMapper;
+
+            EcfvStencil stencil(gridView, elementMapper);
+            for (const auto& elem : elements(gridView)) {
+                stencil.updateTopology(elem);
+
+                Entry& entry = entries_[static_cast<std::size_t>(elementMapper.index(elem))];
+                entry.interiorFaceBegin = static_cast<unsigned>(interiorFaces_.size());
+                entry.numInteriorFaces = static_cast<unsigned>(stencil.interiorFaces_.size());
+                entry.boundaryFaceBegin = static_cast<unsigned>(boundaryFaces_.size());
+                entry.numBoundaryFaces = static_cast<unsigned>(stencil.boundaryFaces_.size());
+
+                // the neighbors are the degrees of freedom 1 to n of the stencil
+                for (std::size_t dofIdx = 1; dofIdx < stencil.elements_.size(); ++dofIdx)
+                    neighborSeeds_.push_back(stencil.elements_[dofIdx].seed());
+                interiorFaces_.insert(interiorFaces_.end(),
+                                      stencil.interiorFaces_.begin(),
+                                      stencil.interiorFaces_.end());
+                boundaryFaces_.insert(boundaryFaces_.end(),
+                                      stencil.boundaryFaces_.begin(),
+                                      stencil.boundaryFaces_.end());
+            }
+        }
+
+        /*!
+         * \brief Returns true if the cache does not contain any elements.
+         */
+        bool empty() const
+        { return entries_.empty(); }
+
+    private:
+        friend class EcfvStencil;
+
+        // set up the topology of a stencil for an element
+        bool load_(EcfvStencil& stencil, const Element& element) const
+        {
+            if (entries_.empty())
+                return false;
+
+            const Entry& entry = entries_[static_cast<std::size_t>(elementMapper_->index(element))];
+            const auto& grid = stencil.gridView_.grid();
+
+            stencil.subControlVolumes_.clear();
+            stencil.subControlVolumes_.emplace_back(element);
+            stencil.elements_.clear();
+            stencil.elements_.emplace_back(element);
+            for (unsigned i = 0; i < entry.numInteriorFaces; ++i) {
+                stencil.elements_.emplace_back(grid.entity(neighborSeeds_[entry.interiorFaceBegin + i]));
+                stencil.subControlVolumes_.emplace_back(stencil.elements_.back());
+            }
+
+            const auto interiorBegin = interiorFaces_.begin() + entry.interiorFaceBegin;
+            stencil.interiorFaces_.assign(interiorBegin, interiorBegin + entry.numInteriorFaces);
+            const auto boundaryBegin = boundaryFaces_.begin() + entry.boundaryFaceBegin;
+            stencil.boundaryFaces_.assign(boundaryBegin, boundaryBegin + entry.numBoundaryFaces);
+            return true;
+        }
+
+        std::vector<Entry> entries_;
+        // the neighbors of the elements, stored like their interior faces
+        std::vector<ElementSeed> neighborSeeds_;
+        std::vector<SubControlVolumeFace> interiorFaces_;
+        std::vector<BoundaryFace> boundaryFaces_;
+        const Mapper* elementMapper_ = nullptr;
+    };
+
     EcfvStencil(const GridView& gridView, const Mapper& mapper)
         : gridView_(gridView)
         , elementMapper_(mapper)
@@ -261,8 +363,19 @@ public:
         assert(int(gridView.size(/*codim=*/0)) == int(elementMapper_.size()));
     }
 
+    /*!
+     * \brief Attach the stencil to a cache of precomputed stencils.
+     *
+     * A null pointer detaches the stencil from its cache.
+     */
+    void setGeometryCache(const GeometryCache* cache)
+    { geometryCache_ = cache; }
+
     void updateTopology(const Element& element)
     {
+        if (geometryCache_ && geometryCache_->load_(*this, element))
+            return;
+
         auto isIt = gridView_.ibegin(element);
         const auto& endIsIt = gridView_.iend(element);
 
@@ -418,6 +531,7 @@ public:
 protected:
     const GridView&       gridView_;
     const ElementMapper&  elementMapper_;
+    const GeometryCache*  geometryCache_ = nullptr;
 
     std::vector<Element> elements_;
     std::vector<SubControlVolume>      subControlVolumes_;
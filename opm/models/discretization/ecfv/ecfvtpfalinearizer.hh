@@ -0,0 +1,963 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::EcfvTpfaLinearizer
+ */
+#ifndef EWOMS_ECFV_TPFA_LINEARIZER_HH
+#define EWOMS_ECFV_TPFA_LINEARIZER_HH
+
+#include "ecfvproperties.hh"
+
+#include <opm/common/Exceptions.hpp>
+#include <opm/common/TimingMacros.hpp>
+
+#include <opm/material/densead/Math.hpp>
+
+#include <opm/models/discretization/common/baseauxiliarymodule.hh>
+#include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/discretization/common/linearizationtype.hh>
+#include <opm/models/parallel/threadmanager.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/regionprofiler.hh>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>   // current_exception, rethrow_exception
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup EcfvDiscretization
+ *
+ * \brief A linearizer for multi-phase models which uses a two-point flux
+ *        approximation on element-centered finite volume grids.
+ *
+ * This is the generalization of RichardsTpfaLinearizer to models with several
+ * equations and phases, e.g., the immiscible, the flash and the PVS models. The
+ * generic linearizer spends most of its time in the element contexts, i.e., in
+ * updating the stencils, copying the intensive quantities of the neighbors and
+ * evaluating the extensive quantities. This linearizer avoids this overhead:
+ *
+ * - The geometric part of the fluxes (transmissibilities and hydrostatic distances)
+ *   is computed once when the matrix is created.
+ * - In each linearization, the intensive quantities of all cells are computed once
+ *   and kept in a flat array. The volume fluxes of the phases over the interior faces
+ *   are computed directly from them, and the model's local residual converts them to
+ *   the fluxes of the conservation quantities by its static addTpfaAdvectiveFlux()
+ *   method. The results are written to precomputed entries of the Jacobian matrix.
+ *
+ * The discretization is the same as the one of the Darcy flux module for the
+ * element-centered finite volume method, i.e., both linearizers produce the same
+ * system of equations. Cells with faces on the domain boundary are linearized by the
+ * local linearizer of the model, so boundary conditions are handled by the problem
+ * as usual. The intrinsic permeabilities and the gravity are assumed not to change
+ * until the matrix is recreated.
+ *
+ * If the neighbors of all cells are at fixed offsets of the cell index, e.g., for
+ * serial structured grids whose cells are numbered lexicographically, the neighbors
+ * are not stored explicitly. Instead, the geometric data of each face is stored only
+ * once in one array per direction, and the neighbors of a cell are computed from the
+ * index offsets.
+ *
+ * The linearizer is selected by setting the Linearizer property of the problem's
+ * type tag to \c EcfvTpfaLinearizer<TypeTag>. It requires element-centered finite
+ * volumes, automatic differentiation and a local residual which provides the
+ * context-free computeStorage() and addTpfaAdvectiveFlux() methods. Models which
+ * exhibit fluxes that are not covered by the latter, i.e., models with molecular
+ * diffusion or thermal conduction, are rejected at compile time.
+ */
+template<class TypeTag>
+class EcfvTpfaLinearizer
+{
+//! \cond SKIP_THIS
+    using Model = GetPropType<TypeTag, Properties::Model>;
+    using Problem = GetPropType<TypeTag, Properties::Problem>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using ElementMapper = GetPropType<TypeTag, Properties::ElementMapper>;
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using LocalResidual = GetPropType<TypeTag, Properties::LocalResidual>;
+
+    using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+    using EqVector = GetPropType<TypeTag, Properties::EqVector>;
+    using RateVector = GetPropType<TypeTag, Properties::RateVector>;
+    using Constraints = GetPropType<TypeTag, Properties::Constraints>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
+
+    using Element = typename GridView::template Codim<0>::Entity;
+    using ElementSeed = typename Element::EntitySeed;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+    enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
+    enum { dimWorld = GridView::dimensionworld };
+
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+    using EvalEqVector = Dune::FieldVector<Evaluation, numEq>;
+    using DimVector = Dune::FieldVector<Scalar, dimWorld>;
+    using DimMatrix = Dune::FieldMatrix<Scalar, dimWorld, dimWorld>;
+    using Toolbox = MathToolbox<Evaluation>;
+
+    static constexpr bool linearizeNonLocalElements =
+        getPropValue<TypeTag, Properties::LinearizeNonLocalElements>();
+    static constexpr bool useVolumetricResidual =
+        getPropValue<TypeTag, Properties::UseVolumetricResidual>();
+
+    static_assert(!std::is_same<Evaluation, Scalar>::value,
+                  "The TPFA linearizer requires automatic differentiation");
+    static_assert(LocalResidual::tpfaFluxSupported,
+                  "The TPFA linearizer does not support molecular diffusion and thermal "
+                  "conduction");
+
+    // how a cell is linearized
+    enum class CellType_ : unsigned char {
+        Skipped, // not linearized by this process
+        Fast, // linearized by the two-point flux kernel
+        Generic // linearized by the local linearizer of the model
+    };
+
+    // the volume fluxes of all phases over a face in the form which is expected by
+    // the addTpfaAdvectiveFlux() methods of the local residuals
+    class PhaseFluxes_
+    {
+    public:
+        const Evaluation& volumeFlux(unsigned phaseIdx) const
+        { return volumeFlux_[phaseIdx]; }
+
+        bool interiorIsUpstream(unsigned phaseIdx) const
+        { return interiorIsUpstream_[phaseIdx]; }
+
+        std::array<Evaluation, numPhases> volumeFlux_;
+        std::array<bool, numPhases> interiorIsUpstream_;
+    };
+
+    // copying the linearizer is not a good idea
+    EcfvTpfaLinearizer(const EcfvTpfaLinearizer&) = delete;
+//! \endcond
+
+public:
+    EcfvTpfaLinearizer() = default;
+
+    /*!
+     * \brief Register all run-time parameters for the linearizer.
+     */
+    static void registerParameters()
+    { }
+
+    /*!
+     * \brief Initialize the linearizer.
+     *
+     * At this point we can assume that all objects in the simulator
+     * have been allocated. We cannot assume that they are fully
+     * initialized, though.
+     *
+     * \copydetails Doxygen::simulatorParam
+     */
+    void init(Simulator& simulator)
+    {
+        simulatorPtr_ = &simulator;
+        eraseMatrix();
+        elementCtx_.clear();
+    }
+
+    /*!
+     * \brief Causes the Jacobian matrix and the geometric data of the faces to be
+     *        recreated from scratch before the next iteration.
+     */
+    void eraseMatrix()
+    { jacobian_.reset(); }
+
+    /*!
+     * \brief Linearize the full system of non-linear equations.
+     *
+     * This linearizes the spatial domain and all auxiliary equations.
+     */
+    void linearize()
+    {
+        linearizeDomain();
+        linearizeAuxiliaryEquations();
+    }
+
+    /*!
+     * \brief Linearize the part of the non-linear system of equations that is associated
+     *        with the spatial domain.
+     */
+    void linearizeDomain()
+    {
+        OPM_TIMEBLOCK(linearizeDomain);
+        EWOMS_PROFILE_REGION("linearize domain");
+        // the initialization of the Jacobian matrix is deferred until here because the
+        // problem is not fully initialized when init() is called
+        if (!jacobian_)
+            initFirstIteration_();
+
+        resetSystem_();
+
+        int succeeded;
+        try {
+            linearize_();
+            succeeded = 1;
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while linearizing:" << e.what()
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        catch (...)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while linearizing"
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        succeeded = simulator_().gridView().comm().min(succeeded);
+
+        if (!succeeded)
+            throw NumericalProblem("A process did not succeed in linearizing the system");
+    }
+
+    void finalize()
+    { jacobian_->finalize(); }
+
+    /*!
+     * \brief Linearize the part of the non-linear system of equations that is associated
+     *        with the auxiliary equations.
+     */
+    void linearizeAuxiliaryEquations()
+    {
+        OPM_TIMEBLOCK(linearizeAuxiliaryEquations);
+        EWOMS_PROFILE_REGION("linearize auxiliary equations");
+        // flush possible local caches into matrix structure
+        jacobian_->commit();
+
+        auto& model = model_();
+        const auto& comm = simulator_().gridView().comm();
+        for (unsigned auxModIdx = 0; auxModIdx < model.numAuxiliaryModules(); ++auxModIdx) {
+            bool succeeded = true;
+            try {
+                model.auxiliaryModule(auxModIdx)->linearize(*jacobian_, residual_);
+            }
+            catch (const std::exception& e) {
+                succeeded = false;
+
+                std::cout << "rank " << simulator_().gridView().comm().rank()
+                          << " caught an exception while linearizing:" << e.what()
+                          << "\n"  << std::flush;
+            }
+
+            succeeded = comm.min(succeeded);
+
+            if (!succeeded)
+                throw NumericalProblem("linearization of an auxiliary equation failed");
+        }
+    }
+
+    /*!
+     * \brief Return constant reference to global Jacobian matrix backend.
+     */
+    const SparseMatrixAdapter& jacobian() const
+    { return *jacobian_; }
+
+    SparseMatrixAdapter& jacobian()
+    { return *jacobian_; }
+
+    /*!
+     * \brief Return constant reference to global residual vector.
+     */
+    const GlobalEqVector& residual() const
+    { return residual_; }
+
+    GlobalEqVector& residual()
+    { return residual_; }
+
+    void setLinearizationType(LinearizationType linearizationType)
+    { linearizationType_ = linearizationType; }
+
+    const LinearizationType& getLinearizationType() const
+    { return linearizationType_; }
+
+    void updateDiscretizationParameters()
+    {
+        // the geometric data of the faces is only updated if the matrix is recreated
+    }
+
+    void updateBoundaryConditionData()
+    {
+        // boundary conditions are handled by the local linearizer of the model
+    }
+
+    void updateFlowsInfo()
+    {
+        // This linearizer stores no such data.
+    }
+
+    /*!
+     * \brief Returns the map of constraint degrees of freedom.
+     *
+     * (This object is only non-empty if the EnableConstraints property is true.)
+     */
+    const std::map<unsigned, Constraints>& constraintsMap() const
+    { return constraintsMap_; }
+
+    /*!
+     * \brief Returns true if the neighbors of the cells are computed from fixed index
+     *        offsets instead of being stored explicitly.
+     */
+    bool implicitNeighbors() const
+    { return !structuredFaces_.empty(); }
+
+    /*!
+     * \brief Returns the number of cells which are linearized by the two-point flux
+     *        kernel, i.e., which are neither on the boundary nor skipped.
+     */
+    std::size_t numFastCells() const
+    {
+        std::size_t n = 0;
+        for (const auto type : cellType_)
+            n += (type == CellType_::Fast);
+        return n;
+    }
+
+private:
+    Simulator& simulator_()
+    { return *simulatorPtr_; }
+    const Simulator& simulator_() const
+    { return *simulatorPtr_; }
+
+    Problem& problem_()
+    { return simulator_().problem(); }
+    const Problem& problem_() const
+    { return simulator_().problem(); }
+
+    Model& model_()
+    { return simulator_().model(); }
+    const Model& model_() const
+    { return simulator_().model(); }
+
+    const GridView& gridView_() const
+    { return problem_().gridView(); }
+
+    const ElementMapper& elementMapper_() const
+    { return model_().elementMapper(); }
+
+    void initFirstIteration_()
+    {
+        elementCtx_.clear();
+        for (unsigned threadIdx = 0; threadIdx < ThreadManager::maxThreads(); ++threadIdx)
+            elementCtx_.push_back(std::make_unique<ElementContext>(simulator_()));
+
+        createMatrix_();
+
+        residual_.resize(model_().numTotalDof());
+        resetSystem_();
+    }
+
+    // Construct the BCRS matrix for the Jacobian of the residual function and compute
+    // the geometric part of the fluxes over the interior faces of all cells
+    void createMatrix_()
+    {
+        OPM_TIMEBLOCK(createMatrix);
+        const auto& model = model_();
+        const std::size_t numCells = model.numGridDof();
+        ElementContext& elemCtx = *elementCtx_[0];
+        const bool enableGravity = Parameters::get<TypeTag, Properties::EnableGravity>();
+
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            phaseIsConsidered_[phaseIdx] = model.phaseIsConsidered(phaseIdx);
+
+        cellSeeds_.resize(numCells);
+        for (const auto& elem : elements(gridView_()))
+            cellSeeds_[elementMapper_().index(elem)] = elem.seed();
+
+        std::vector<std::set<unsigned>> sparsityPattern(model.numTotalDof());
+        cellType_.resize(numCells);
+        rowScale_.resize(numCells);
+        faceOffsets_.assign(1, 0);
+        faceNeighbor_.clear();
+        faceTrans_.clear();
+        faceGravityIn_.clear();
+        faceGravityEx_.clear();
+        faceDirection_.clear();
+
+        const auto& grid = gridView_().grid();
+        for (std::size_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            const auto elem = grid.entity(cellSeeds_[cellIdx]);
+            elemCtx.updateStencil(elem);
+            const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+
+            for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx)
+                sparsityPattern[cellIdx].insert(stencil.globalSpaceIndex(dofIdx));
+
+            if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                cellType_[cellIdx] = CellType_::Skipped;
+            else if (elemCtx.onBoundary())
+                cellType_[cellIdx] = CellType_::Generic;
+            else
+                cellType_[cellIdx] = CellType_::Fast;
+
+            // the residual of the generic linearizer is volume specific
+            const Scalar dofVolume = model.dofTotalVolume(static_cast<unsigned>(cellIdx));
+            rowScale_[cellIdx] = (useVolumetricResidual && dofVolume > 0.0) ? 1.0/dofVolume : 1.0;
+
+            for (unsigned faceIdx = 0; faceIdx < stencil.numInteriorFaces(); ++faceIdx) {
+                const auto& face = stencil.interiorFace(faceIdx);
+                const unsigned i = face.interiorIndex();
+                const unsigned j = face.exteriorIndex();
+
+                DimVector distVec = elemCtx.pos(j, /*timeIdx=*/0);
+                distVec -= elemCtx.pos(i, /*timeIdx=*/0);
+
+                // see RichardsTpfaLinearizer::createMatrix_()
+                DimMatrix K;
+                problem_().intersectionIntrinsicPermeability(K, elemCtx, faceIdx, /*timeIdx=*/0);
+                DimVector Kd;
+                K.mv(distVec, Kd);
+
+                Scalar gravityIn = 0.0;
+                Scalar gravityEx = 0.0;
+                if (enableGravity) {
+                    DimVector distVecIn = elemCtx.pos(i, /*timeIdx=*/0);
+                    DimVector distVecEx = elemCtx.pos(j, /*timeIdx=*/0);
+                    distVecIn -= face.integrationPos();
+                    distVecEx -= face.integrationPos();
+                    gravityIn = problem_().gravity(elemCtx, i, /*timeIdx=*/0)*distVecIn;
+                    gravityEx = problem_().gravity(elemCtx, j, /*timeIdx=*/0)*distVecEx;
+                }
+
+                faceNeighbor_.push_back(stencil.globalSpaceIndex(j));
+                faceTrans_.push_back(face.area()*(Kd*face.normal())/distVec.two_norm2());
+                faceGravityIn_.push_back(gravityIn);
+                faceGravityEx_.push_back(gravityEx);
+                faceDirection_.push_back(distVec*face.normal());
+            }
+            faceOffsets_.push_back(faceNeighbor_.size());
+        }
+
+        // add the additional neighbors and degrees of freedom caused by the auxiliary
+        // equations
+        const std::size_t numAuxMod = model.numAuxiliaryModules();
+        for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
+            model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern);
+
+        jacobian_ = std::make_unique<SparseMatrixAdapter>(simulator_());
+        jacobian_->reserve(sparsityPattern);
+
+        // the addresses of the matrix entries which are written by the flux kernel. the
+        // flux over a face yields the derivative of the interior cell's residual as
+        // well as the one of the neighbor's residual with regard to the interior cell.
+        diagAddress_.resize(numCells);
+        offDiagAddress_.resize(faceNeighbor_.size());
+        for (std::size_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            diagAddress_[cellIdx] = jacobian_->blockAddress(cellIdx, cellIdx);
+            for (std::size_t faceIdx = faceOffsets_[cellIdx]; faceIdx < faceOffsets_[cellIdx + 1]; ++faceIdx)
+                offDiagAddress_[faceIdx] = jacobian_->blockAddress(faceNeighbor_[faceIdx], cellIdx);
+        }
+
+        intQuants_.resize(numCells);
+        extrusion_.resize(numCells);
+
+        createStructuredFaces_();
+    }
+
+    // if the neighbors of all cells are at fixed index offsets, replace the explicit
+    // face data by one array per offset. each face is stored by the cell with the
+    // lower index, i.e., the transmissibility is assumed to be symmetric.
+    void createStructuredFaces_()
+    {
+        structuredFaces_.clear();
+        const std::size_t numCells = cellSeeds_.size();
+
+        std::vector<unsigned> strides;
+        for (std::size_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            std::vector<int> cellStrides;
+            for (std::size_t faceIdx = faceOffsets_[cellIdx]; faceIdx < faceOffsets_[cellIdx + 1]; ++faceIdx) {
+                const int stride = static_cast<int>(faceNeighbor_[faceIdx]) - static_cast<int>(cellIdx);
+                if (std::find(cellStrides.begin(), cellStrides.end(), stride) != cellStrides.end())
+                    return; // two faces to the same neighbor
+
+                cellStrides.push_back(stride);
+                const unsigned absStride = static_cast<unsigned>(std::abs(stride));
+                if (std::find(strides.begin(), strides.end(), absStride) == strides.end())
+                    strides.push_back(absStride);
+            }
+
+            if (strides.size() > dimWorld)
+                return;
+        }
+
+        structuredFaces_.resize(strides.size());
+        for (std::size_t k = 0; k < strides.size(); ++k) {
+            auto& faces = structuredFaces_[k];
+            faces.stride = strides[k];
+            faces.trans.assign(numCells, 0.0);
+            faces.gravityLow.assign(numCells, 0.0);
+            faces.gravityHigh.assign(numCells, 0.0);
+            faces.direction.assign(numCells, 0.0);
+            faces.upAddress.assign(numCells, nullptr);
+            faces.downAddress.assign(numCells, nullptr);
+        }
+
+        for (std::size_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            for (std::size_t faceIdx = faceOffsets_[cellIdx]; faceIdx < faceOffsets_[cellIdx + 1]; ++faceIdx) {
+                const unsigned globJ = faceNeighbor_[faceIdx];
+                const unsigned absStride =
+                    static_cast<unsigned>((globJ > cellIdx) ? globJ - cellIdx : cellIdx - globJ);
+                const std::size_t k = std::find(strides.begin(), strides.end(), absStride) - strides.begin();
+                auto& faces = structuredFaces_[k];
+                if (globJ > cellIdx) {
+                    faces.trans[cellIdx] = faceTrans_[faceIdx];
+                    faces.gravityLow[cellIdx] = faceGravityIn_[faceIdx];
+                    faces.gravityHigh[cellIdx] = faceGravityEx_[faceIdx];
+                    faces.direction[cellIdx] = faceDirection_[faceIdx];
+                    faces.upAddress[cellIdx] = offDiagAddress_[faceIdx];
+                }
+                else
+                    faces.downAddress[cellIdx] = offDiagAddress_[faceIdx];
+            }
+        }
+
+        // the explicit face data is not needed anymore
+        faceOffsets_ = {};
+        faceNeighbor_ = {};
+        faceTrans_ = {};
+        faceGravityIn_ = {};
+        faceGravityEx_ = {};
+        faceDirection_ = {};
+        offDiagAddress_ = {};
+    }
+
+    // reset the global linear system of equations.
+    void resetSystem_()
+    {
+        residual_ = 0.0;
+        // zero all matrix entries
+        jacobian_->clear();
+    }
+
+    void linearize_()
+    {
+        OPM_TIMEBLOCK(linearize_);
+
+        // the constraints may be time dependent, but they do not depend on the solution
+        if (model_().newtonMethod().numIterations() == 0)
+            updateConstraintsMap_();
+
+        applyConstraintsToSolution_();
+
+        // to avoid a race condition if two threads handle an exception at the same time,
+        // we use an explicit lock to control access to the exception storage object
+        // amongst thread-local handlers
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+
+        // each cell only writes its own residual and its own column of the Jacobian
+        // matrix, so the cells can be linearized concurrently. the intensive quantities
+        // are computed first because the flux kernel needs the ones of the neighbors.
+        const std::size_t numCells = cellSeeds_.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::size_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            // see FvBaseLinearizer::linearize_() for the rationale of the exception
+            // handling
+            try {
+                updateCell_(static_cast<unsigned>(cellIdx));
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+            }
+        }
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::size_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            if (cellType_[cellIdx] != CellType_::Fast)
+                continue;
+
+            try {
+                addFluxes_(static_cast<unsigned>(cellIdx));
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+            }
+        }
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::size_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            if (cellType_[cellIdx] != CellType_::Generic)
+                continue;
+
+            try {
+                linearizeGenericCell_(static_cast<unsigned>(cellIdx));
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+            }
+        }
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
+        applyConstraintsToLinearization_();
+    }
+
+    // compute the intensive quantities of a cell which are required by the flux kernel
+    // and add the storage and source terms of the cells which are linearized by the
+    // kernel
+    void updateCell_(unsigned globI)
+    {
+        ElementContext& elemCtx = *elementCtx_[ThreadManager::threadId()];
+        const auto elem = gridView_().grid().entity(cellSeeds_[globI]);
+        elemCtx.updatePrimaryStencil(elem);
+        elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+
+        const IntensiveQuantities& intQuants = std::as_const(elemCtx).intensiveQuantities(/*dofIdx=*/0, /*timeIdx=*/0);
+        intQuants_[globI] = intQuants;
+        extrusion_[globI] = intQuants.extrusionFactor();
+
+        if (cellType_[globI] != CellType_::Fast)
+            return;
+
+        // storage term using the implicit Euler time discretization
+        EvalEqVector storage;
+        LocalResidual::computeStorage(storage, intQuants);
+        const EqVector oldStorage = oldStorage_(elemCtx, globI, storage);
+
+        const Scalar scvVolume =
+            elemCtx.stencil(/*timeIdx=*/0).subControlVolume(/*dofIdx=*/0).volume()
+            * intQuants.extrusionFactor();
+        const Scalar dt = simulator_().timeStepSize();
+
+        // source term
+        RateVector source;
+        model_().localResidual(ThreadManager::threadId()).computeSource(source, elemCtx,
+                                                                        /*dofIdx=*/0,
+                                                                        /*timeIdx=*/0);
+
+        EvalEqVector res;
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            res[eqIdx] = (storage[eqIdx] - oldStorage[eqIdx])*(scvVolume/dt)
+                - source[eqIdx]*scvVolume;
+
+        addToRow_(globI, *diagAddress_[globI], res, rowScale_[globI]);
+    }
+
+    // the storage term of the previous time step, which is taken from the storage cache
+    // of the model if it is enabled
+    EqVector oldStorage_(ElementContext& elemCtx, unsigned globI, const EvalEqVector& storage) const
+    {
+        EqVector oldStorage;
+        const auto& model = model_();
+        if (elemCtx.enableStorageCache()) {
+            if (model.newtonMethod().numIterations() == 0) {
+                if (problem_().recycleFirstIterationStorage()) {
+                    for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                        oldStorage[eqIdx] = Toolbox::value(storage[eqIdx]);
+                }
+                else {
+                    elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/1);
+                    LocalResidual::computeStorage(oldStorage,
+                                                  std::as_const(elemCtx).intensiveQuantities(/*dofIdx=*/0, /*timeIdx=*/1));
+                }
+                model.updateCachedStorage(globI, /*timeIdx=*/1, oldStorage);
+                return oldStorage;
+            }
+
+            return model.cachedStorage(globI, /*timeIdx=*/1);
+        }
+
+        elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/1);
+        LocalResidual::computeStorage(oldStorage, std::as_const(elemCtx).intensiveQuantities(/*dofIdx=*/0, /*timeIdx=*/1));
+        return oldStorage;
+    }
+
+    // add the fluxes over all faces of a cell to its residual and their derivatives
+    // with regard to the cell's primary variables to the cell's column of the Jacobian.
+    void addFluxes_(unsigned globI)
+    {
+        PhaseFluxes_ phaseFluxes;
+        EvalEqVector res(0.0);
+        RateVector flux;
+
+        if (structuredFaces_.empty()) {
+            const std::size_t faceEnd = faceOffsets_[globI + 1];
+            for (std::size_t faceIdx = faceOffsets_[globI]; faceIdx < faceEnd; ++faceIdx)
+                addFaceFlux_(res, flux, phaseFluxes, globI, faceNeighbor_[faceIdx],
+                             faceTrans_[faceIdx], faceGravityIn_[faceIdx],
+                             faceGravityEx_[faceIdx], faceDirection_[faceIdx],
+                             *offDiagAddress_[faceIdx]);
+        }
+        else {
+            for (const auto& faces : structuredFaces_) {
+                if (faces.upAddress[globI])
+                    addFaceFlux_(res, flux, phaseFluxes, globI, globI + faces.stride,
+                                 faces.trans[globI], faces.gravityLow[globI],
+                                 faces.gravityHigh[globI], faces.direction[globI],
+                                 *faces.upAddress[globI]);
+
+                if (faces.downAddress[globI]) {
+                    // the face is stored by the neighbor
+                    const unsigned globJ = globI - faces.stride;
+                    addFaceFlux_(res, flux, phaseFluxes, globI, globJ,
+                                 faces.trans[globJ], faces.gravityHigh[globJ],
+                                 faces.gravityLow[globJ], faces.direction[globJ],
+                                 *faces.downAddress[globI]);
+                }
+            }
+        }
+
+        addToRow_(globI, *diagAddress_[globI], res, rowScale_[globI]);
+    }
+
+    // add the flux over a face to the residual of the interior cell and the
+    // derivatives of the flux into the neighbor to the given block of the Jacobian.
+    //
+    // The volume fluxes are the ones of the Darcy flux module: With the potential
+    // difference dPhi = p_j - p_i - rho_j*(g*(x_j - x_f)) + rho_i*(g*(x_i - x_f)) of a
+    // phase, its volume flux out of cell i is -T*lambda_up*dPhi, where the upstream
+    // cell is j if the potential decreases towards i. Only the quantities of cell i
+    // carry derivatives.
+    void addFaceFlux_(EvalEqVector& res,
+                      RateVector& flux,
+                      PhaseFluxes_& phaseFluxes,
+                      unsigned globI,
+                      unsigned globJ,
+                      Scalar faceTrans,
+                      Scalar hIn,
+                      Scalar hEx,
+                      Scalar direction,
+                      MatrixBlock& offDiag)
+    {
+        const IntensiveQuantities& intQuantsIn = intQuants_[globI];
+        const IntensiveQuantities& intQuantsEx = intQuants_[globJ];
+        const auto& fsIn = intQuantsIn.fluidState();
+        const auto& fsEx = intQuantsEx.fluidState();
+        const Scalar trans = faceTrans*(extrusion_[globI] + extrusion_[globJ])/2;
+
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!phaseIsConsidered_[phaseIdx]) {
+                phaseFluxes.volumeFlux_[phaseIdx] = 0.0;
+                phaseFluxes.interiorIsUpstream_[phaseIdx] = true;
+                continue;
+            }
+
+            const Evaluation dPhi =
+                Toolbox::value(fsEx.pressure(phaseIdx)) - fsIn.pressure(phaseIdx)
+                - Toolbox::value(fsEx.density(phaseIdx))*hEx + fsIn.density(phaseIdx)*hIn;
+
+            const bool interiorIsUpstream = !(Toolbox::value(dPhi)*direction > 0.0);
+            phaseFluxes.interiorIsUpstream_[phaseIdx] = interiorIsUpstream;
+            if (interiorIsUpstream)
+                phaseFluxes.volumeFlux_[phaseIdx] = -trans*intQuantsIn.mobility(phaseIdx)*dPhi;
+            else
+                phaseFluxes.volumeFlux_[phaseIdx] =
+                    -trans*Toolbox::value(intQuantsEx.mobility(phaseIdx))*dPhi;
+        }
+
+        flux = 0.0;
+        LocalResidual::addTpfaAdvectiveFlux(flux, intQuantsIn, intQuantsEx, phaseFluxes);
+
+        // the flux enters the neighbor
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            res[eqIdx] += flux[eqIdx];
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                offDiag[eqIdx][pvIdx] -= flux[eqIdx].derivative(pvIdx)*rowScale_[globJ];
+        }
+    }
+
+    // add the values of a vector of evaluations to the residual of a cell and their
+    // derivatives to a block of the Jacobian matrix
+    void addToRow_(unsigned globI, MatrixBlock& block, const EvalEqVector& res, Scalar scale)
+    {
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            residual_[globI][eqIdx] += res[eqIdx].value()*scale;
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                block[eqIdx][pvIdx] += res[eqIdx].derivative(pvIdx)*scale;
+        }
+    }
+
+    // linearize a cell using the local linearizer of the model
+    void linearizeGenericCell_(unsigned globI)
+    {
+        const unsigned threadId = ThreadManager::threadId();
+        ElementContext& elemCtx = *elementCtx_[threadId];
+        auto& localLinearizer = model_().localLinearizer(threadId);
+
+        const auto elem = gridView_().grid().entity(cellSeeds_[globI]);
+        localLinearizer.linearize(elemCtx, elem);
+
+        residual_[globI] += localLinearizer.residual(/*dofIdx=*/0);
+        for (unsigned dofIdx = 0; dofIdx < elemCtx.numDof(/*timeIdx=*/0); ++dofIdx) {
+            const unsigned globJ = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+            jacobian_->addToBlock(globJ, globI, localLinearizer.jacobian(dofIdx, /*primaryDofIdx=*/0));
+        }
+    }
+
+    // query the problem for all constraint degrees of freedom
+    void updateConstraintsMap_()
+    {
+        if (!enableConstraints_())
+            // constraints are not explictly enabled, so we don't need to consider them!
+            return;
+
+        constraintsMap_.clear();
+
+        ElementContext& elemCtx = *elementCtx_[0];
+        const auto& grid = gridView_().grid();
+        for (std::size_t cellIdx = 0; cellIdx < cellSeeds_.size(); ++cellIdx) {
+            if (cellType_[cellIdx] == CellType_::Skipped)
+                continue;
+
+            const auto elem = grid.entity(cellSeeds_[cellIdx]);
+            elemCtx.updateStencil(elem);
+
+            Constraints constraints;
+            elemCtx.problem().constraints(constraints, elemCtx, /*dofIdx=*/0, /*timeIdx=*/0);
+            if (constraints.isActive())
+                constraintsMap_[static_cast<unsigned>(cellIdx)] = constraints;
+        }
+    }
+
+    // apply the constraints to the solution. (i.e., the solution of constraint degrees
+    // of freedom is set to the value of the constraint.)
+    void applyConstraintsToSolution_()
+    {
+        if (!enableConstraints_())
+            return;
+
+        auto& sol = model_().solution(/*timeIdx=*/0);
+        auto& oldSol = model_().solution(/*timeIdx=*/1);
+        for (const auto& [dofIdx, constraints] : constraintsMap_) {
+            sol[dofIdx] = constraints;
+            oldSol[dofIdx] = constraints;
+        }
+    }
+
+    // apply the constraints to the linearization. (i.e., for constrain degrees of
+    // freedom the Jacobian matrix maps to identity and the residual is zero)
+    void applyConstraintsToLinearization_()
+    {
+        if (!enableConstraints_())
+            return;
+
+        for (const auto& constraint : constraintsMap_) {
+            jacobian_->clearRow(constraint.first, Scalar(1.0));
+            residual_[constraint.first] = 0.0;
+        }
+    }
+
+    static bool enableConstraints_()
+    { return getPropValue<TypeTag, Properties::EnableConstraints>(); }
+
+    Simulator* simulatorPtr_ = nullptr;
+    std::vector<std::unique_ptr<ElementContext>> elementCtx_;
+
+    // The constraint equations (only non-empty if the
+    // EnableConstraints property is true)
+    std::map<unsigned, Constraints> constraintsMap_;
+
+    // the jacobian matrix and the right-hand side
+    std::unique_ptr<SparseMatrixAdapter> jacobian_;
+    GlobalEqVector residual_;
+
+    LinearizationType linearizationType_;
+
+    // the phases for which fluxes are computed
+    std::array<bool, numPhases> phaseIsConsidered_{};
+
+    // the grid elements and the linearization scheme of the cells and the factor which
+    // converts the residual of a cell to the volume specific one
+    std::vector<ElementSeed> cellSeeds_;
+    std::vector<CellType_> cellType_;
+    std::vector<Scalar> rowScale_;
+
+    // the faces of the cells to the cells whose index is larger by a fixed offset.
+    // the geometric data is stored by the cell with the lower index.
+    struct StructuredFaces_
+    {
+        unsigned stride;
+        std::vector<Scalar> trans;
+        std::vector<Scalar> gravityLow;
+        std::vector<Scalar> gravityHigh;
+        std::vector<Scalar> direction;
+        // the blocks which describe the derivatives of the residuals of the cells with
+        // the higher and the lower index w.r.t. the cell. nullptr if there is no face.
+        std::vector<MatrixBlock*> upAddress;
+        std::vector<MatrixBlock*> downAddress;
+    };
+
+    // only non-empty if the neighbors are at fixed index offsets. in this case, the
+    // explicit face data below is empty.
+    std::vector<StructuredFaces_> structuredFaces_;
+
+    // the interior faces of all cells in compressed row format
+    std::vector<std::size_t> faceOffsets_;
+    std::vector<unsigned> faceNeighbor_;
+    std::vector<Scalar> faceTrans_;
+    std::vector<Scalar> faceGravityIn_;
+    std::vector<Scalar> faceGravityEx_;
+    std::vector<Scalar> faceDirection_;
+
+    // the addresses of the diagonal entries of the Jacobian and of the entries which
+    // describe the derivative of the neighbor's residual w.r.t. the interior cell
+    std::vector<MatrixBlock*> diagAddress_;
+    std::vector<MatrixBlock*> offDiagAddress_;
+
+    // the intensive quantities and extrusion factors of all cells for the current
+    // solution
+    std::vector<IntensiveQuantities> intQuants_;
+    std::vector<Scalar> extrusion_;
+};
+
+} // namespace Opm
+
+#endif
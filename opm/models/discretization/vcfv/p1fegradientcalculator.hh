@@ -115,7 +115,7 @@ public:
 
                 if (prepareGradients) {
                     // first, get the shape function's gradient in local coordinates
-                    std::vector<ShapeJacobian> localGradient;
+                    auto& localGradient = localGradient_;
                     localFE.localBasis().evaluateJacobian(localFacePos, localGradient);
 
                     // convert to a gradient in global space by
@@ -290,6 +290,50 @@ public:
             ParentType::calculateGradient(quantityGrad, elemCtx, fapIdx, quantityCallback);
     }
 
+    /*!
+     * \brief Calculates the gradients of several quantities at any flux approximation
+     *        point in a single pass over the vertices of the element.
+     *
+     * \copydetails FvBaseGradientCalculator::calculateGradients
+     */
+    template <class QuantityCallback, class EvalDimVectorArray>
+    void calculateGradients([[maybe_unused]] EvalDimVectorArray& quantityGrads,
+                            [[maybe_unused]] const ElementContext& elemCtx,
+                            [[maybe_unused]] unsigned fapIdx,
+                            [[maybe_unused]] const QuantityCallback& quantityCallback) const
+    {
+        if (getPropValue<TypeTag, Properties::UseP1FiniteElementGradients>()) {
+#if !HAVE_DUNE_LOCALFUNCTIONS
+            // The dune-localfunctions module is required for P1 finite element gradients
+            throw std::logic_error("The dune-localfunctions module is required in oder to use"
+                                   " finite element gradients");
+#else
+            for (auto& quantityGrad : quantityGrads)
+                quantityGrad = 0.0;
+
+            for (unsigned vertIdx = 0; vertIdx < elemCtx.numDof(/*timeIdx=*/0); ++vertIdx) {
+                const auto& dofVals = quantityCallback(vertIdx);
+                const auto& tmp = p1Gradient_[fapIdx][vertIdx];
+                const bool isFocus = elemCtx.focusDofIndex() == vertIdx;
+                for (unsigned quantityIdx = 0; quantityIdx < quantityGrads.size(); ++quantityIdx) {
+                    auto& quantityGrad = quantityGrads[quantityIdx];
+                    if (isFocus) {
+                        for (int dimIdx = 0; dimIdx < dim; ++ dimIdx)
+                            quantityGrad[dimIdx] += dofVals[quantityIdx]*tmp[dimIdx];
+                    }
+                    else {
+                        const auto dofVal = scalarValue(dofVals[quantityIdx]);
+                        for (int dimIdx = 0; dimIdx < dim; ++ dimIdx)
+                            quantityGrad[dimIdx] += dofVal*tmp[dimIdx];
+                    }
+                }
+            }
+#endif
+        }
+        else
+            ParentType::calculateGradients(quantityGrads, elemCtx, fapIdx, quantityCallback);
+    }
+
     /*!
      * \brief Calculates the value of an arbitrary quantity at any
      *        flux approximation point on the grid boundary.
@@ -344,6 +388,8 @@ private:
     const LocalFiniteElement* localFiniteElement_;
     std::vector<Dune::FieldVector<Scalar, 1>> p1Value_[maxFap];
     DimVector p1Gradient_[maxFap][maxDof];
+    // scratch space for the gradients of the shape functions in local coordinates
+    std::vector<ShapeJacobian> localGradient_;
 #endif // HAVE_DUNE_LOCALFUNCTIONS
 };
 
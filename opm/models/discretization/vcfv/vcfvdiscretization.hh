@@ -158,6 +158,7 @@ class VcfvDiscretization : public GetPropType<TypeTag, Properties::BaseDiscretiz
     using DofMapper = GetPropType<TypeTag, Properties::DofMapper>;
     using GridView = GetPropType<TypeTag, Properties::GridView>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using Stencil = GetPropType<TypeTag, Properties::Stencil>;
 
     enum { dim = GridView::dimension };
 
@@ -185,6 +186,24 @@ public:
     const DofMapper& dofMapper() const
     { return this->vertexMapper(); }
 
+    /*!
+     * \brief Precompute the geometry of the stencils of all elements.
+     */
+    void updateStencilCache()
+    {
+        if (this->enableStencilCache())
+            stencilCache_.update(this->gridView_, this->elementMapper(), this->vertexMapper());
+    }
+
+    /*!
+     * \brief Attach the stencil of an element context to the precomputed geometries.
+     */
+    void prepareStencil(Stencil& stencil) const
+    {
+        if (this->enableStencilCache())
+            stencil.setGeometryCache(&stencilCache_);
+    }
+
     /*!
      * \brief Serializes the current state of the model.
      *
@@ -215,6 +234,8 @@ private:
     { return *static_cast<Implementation*>(this); }
     const Implementation& asImp_() const
     { return *static_cast<const Implementation*>(this); }
+
+    typename Stencil::GeometryCache stencilCache_;
 };
 } // namespace Opm
 
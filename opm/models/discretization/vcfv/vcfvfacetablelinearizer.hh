@@ -0,0 +1,1079 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::VcfvFaceTableLinearizer
+ */
+#ifndef EWOMS_VCFV_FACE_TABLE_LINEARIZER_HH
+#define EWOMS_VCFV_FACE_TABLE_LINEARIZER_HH
+
+#include "vcfvproperties.hh"
+
+#include <opm/common/Exceptions.hpp>
+#include <opm/common/TimingMacros.hpp>
+
+#include <opm/material/densead/Math.hpp>
+
+#include <opm/models/discretization/common/baseauxiliarymodule.hh>
+#include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/discretization/common/linearizationtype.hh>
+#include <opm/models/parallel/threadmanager.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/regionprofiler.hh>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+
+#include <array>
+#include <cstddef>
+#include <exception>   // current_exception, rethrow_exception
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup VcfvDiscretization
+ *
+ * \brief A linearizer for multi-phase models on vertex-centered finite volume grids
+ *        which loops over a precomputed table of sub-control volume faces.
+ *
+ * This is the counterpart of EcfvTpfaLinearizer for the vertex-centered finite volume
+ * method. Unlike for the two-point flux approximation, the pressure gradient at a
+ * sub-control volume face generally depends on all vertices of the element if P1
+ * finite element gradients are used, so the table stores the gradient weights of all
+ * vertices for each face:
+ *
+ * - When the matrix is created, the faces of all elements are collected into a flat
+ *   table which stores the two adjacent vertices, the weights of the vertices for the
+ *   pressure gradient projected onto the face normal and onto the permeability
+ *   weighted face normal, and the geometric part of the gravity correction. The
+ *   addresses of all matrix entries which are written by a face are stored as well.
+ * - In each linearization, the intensive quantities of all vertices are computed once
+ *   and kept in a flat array. Then each vertex loops over its incident faces and
+ *   computes the fluxes over them directly from the stored quantities, i.e., without
+ *   element contexts and extensive quantities. Since every vertex only writes its own
+ *   row of the Jacobian matrix, the vertices can be processed concurrently without
+ *   locks.
+ *
+ * The discretization is the same as the one of the Darcy flux module, i.e., both
+ * linearizers produce the same system of equations. Elements on the domain boundary
+ * are linearized by the local linearizer of the model, so boundary conditions are
+ * handled by the problem as usual. The intrinsic permeabilities and the gravity are
+ * assumed not to change until the matrix is recreated, and the source term of a vertex
+ * is assumed to be the same for all elements which contain it.
+ *
+ * The linearizer is selected by setting the Linearizer property of the problem's
+ * type tag to \c VcfvFaceTableLinearizer<TypeTag>. It requires vertex-centered finite
+ * volumes, automatic differentiation and a local residual which provides the
+ * context-free computeStorage() and addTpfaAdvectiveFlux() methods.
+ */
+template<class TypeTag>
+class VcfvFaceTableLinearizer
+{
+//! \cond SKIP_THIS
+    using Model = GetPropType<TypeTag, Properties::Model>;
+    using Problem = GetPropType<TypeTag, Properties::Problem>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using ElementMapper = GetPropType<TypeTag, Properties::ElementMapper>;
+    using GradientCalculator = GetPropType<TypeTag, Properties::GradientCalculator>;
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using LocalResidual = GetPropType<TypeTag, Properties::LocalResidual>;
+
+    using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+    using EqVector = GetPropType<TypeTag, Properties::EqVector>;
+    using RateVector = GetPropType<TypeTag, Properties::RateVector>;
+    using Constraints = GetPropType<TypeTag, Properties::Constraints>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
+
+    using Element = typename GridView::template Codim<0>::Entity;
+    using ElementSeed = typename Element::EntitySeed;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+    enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
+    enum { dimWorld = GridView::dimensionworld };
+
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+    using EvalEqVector = Dune::FieldVector<Evaluation, numEq>;
+    using DimVector = Dune::FieldVector<Scalar, dimWorld>;
+    using EvalDimVector = Dune::FieldVector<Evaluation, dimWorld>;
+    using DimMatrix = Dune::FieldMatrix<Scalar, dimWorld, dimWorld>;
+    using Toolbox = MathToolbox<Evaluation>;
+
+    static constexpr bool linearizeNonLocalElements =
+        getPropValue<TypeTag, Properties::LinearizeNonLocalElements>();
+    static constexpr bool useVolumetricResidual =
+        getPropValue<TypeTag, Properties::UseVolumetricResidual>();
+
+    static_assert(!std::is_same<Evaluation, Scalar>::value,
+                  "The face table linearizer requires automatic differentiation");
+    static_assert(LocalResidual::tpfaFluxSupported,
+                  "The face table linearizer does not support molecular diffusion and "
+                  "thermal conduction");
+
+    // how an element is linearized
+    enum class ElementType_ : unsigned char {
+        Skipped, // not linearized by this process
+        Fast, // linearized using the face table
+        Generic // linearized by the local linearizer of the model
+    };
+
+    // the volume fluxes of all phases over a face in the form which is expected by
+    // the addTpfaAdvectiveFlux() methods of the local residuals
+    class PhaseFluxes_
+    {
+    public:
+        const Evaluation& volumeFlux(unsigned phaseIdx) const
+        { return volumeFlux_[phaseIdx]; }
+
+        bool interiorIsUpstream(unsigned phaseIdx) const
+        { return interiorIsUpstream_[phaseIdx]; }
+
+        std::array<Evaluation, numPhases> volumeFlux_;
+        std::array<bool, numPhases> interiorIsUpstream_;
+    };
+
+    // a quantity callback which is one for a given degree of freedom and zero for all
+    // others. it is used to extract the weights of the vertices from the gradient
+    // calculator.
+    class UnitDofCallback_
+    {
+    public:
+        using ResultType = Scalar;
+
+        explicit UnitDofCallback_(unsigned dofIdx)
+            : dofIdx_(dofIdx)
+        { }
+
+        Scalar operator()(unsigned dofIdx) const
+        { return (dofIdx == dofIdx_) ? 1.0 : 0.0; }
+
+    private:
+        unsigned dofIdx_;
+    };
+
+    // copying the linearizer is not a good idea
+    VcfvFaceTableLinearizer(const VcfvFaceTableLinearizer&) = delete;
+//! \endcond
+
+public:
+    VcfvFaceTableLinearizer() = default;
+
+    /*!
+     * \brief Register all run-time parameters for the linearizer.
+     */
+    static void registerParameters()
+    { }
+
+    /*!
+     * \brief Initialize the linearizer.
+     *
+     * At this point we can assume that all objects in the simulator
+     * have been allocated. We cannot assume that they are fully
+     * initialized, though.
+     *
+     * \copydetails Doxygen::simulatorParam
+     */
+    void init(Simulator& simulator)
+    {
+        simulatorPtr_ = &simulator;
+        eraseMatrix();
+        elementCtx_.clear();
+    }
+
+    /*!
+     * \brief Causes the Jacobian matrix and the face table to be recreated from
+     *        scratch before the next iteration.
+     */
+    void eraseMatrix()
+    { jacobian_.reset(); }
+
+    /*!
+     * \brief Linearize the full system of non-linear equations.
+     *
+     * This linearizes the spatial domain and all auxiliary equations.
+     */
+    void linearize()
+    {
+        linearizeDomain();
+        linearizeAuxiliaryEquations();
+    }
+
+    /*!
+     * \brief Linearize the part of the non-linear system of equations that is associated
+     *        with the spatial domain.
+     */
+    void linearizeDomain()
+    {
+        OPM_TIMEBLOCK(linearizeDomain);
+        EWOMS_PROFILE_REGION("linearize domain");
+        // the initialization of the Jacobian matrix is deferred until here because the
+        // problem is not fully initialized when init() is called
+        if (!jacobian_)
+            initFirstIteration_();
+
+        resetSystem_();
+
+        int succeeded;
+        try {
+            linearize_();
+            succeeded = 1;
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while linearizing:" << e.what()
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        catch (...)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while linearizing"
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        succeeded = simulator_().gridView().comm().min(succeeded);
+
+        if (!succeeded)
+            throw NumericalProblem("A process did not succeed in linearizing the system");
+    }
+
+    void finalize()
+    { jacobian_->finalize(); }
+
+    /*!
+     * \brief Linearize the part of the non-linear system of equations that is associated
+     *        with the auxiliary equations.
+     */
+    void linearizeAuxiliaryEquations()
+    {
+        OPM_TIMEBLOCK(linearizeAuxiliaryEquations);
+        EWOMS_PROFILE_REGION("linearize auxiliary equations");
+        // flush possible local caches into matrix structure
+        jacobian_->commit();
+
+        auto& model = model_();
+        const auto& comm = simulator_().gridView().comm();
+        for (unsigned auxModIdx = 0; auxModIdx < model.numAuxiliaryModules(); ++auxModIdx) {
+            bool succeeded = true;
+            try {
+                model.auxiliaryModule(auxModIdx)->linearize(*jacobian_, residual_);
+            }
+            catch (const std::exception& e) {
+                succeeded = false;
+
+                std::cout << "rank " << simulator_().gridView().comm().rank()
+                          << " caught an exception while linearizing:" << e.what()
+                          << "\n"  << std::flush;
+            }
+
+            succeeded = comm.min(succeeded);
+
+            if (!succeeded)
+                throw NumericalProblem("linearization of an auxiliary equation failed");
+        }
+    }
+
+    /*!
+     * \brief Return constant reference to global Jacobian matrix backend.
+     */
+    const SparseMatrixAdapter& jacobian() const
+    { return *jacobian_; }
+
+    SparseMatrixAdapter& jacobian()
+    { return *jacobian_; }
+
+    /*!
+     * \brief Return constant reference to global residual vector.
+     */
+    const GlobalEqVector& residual() const
+    { return residual_; }
+
+    GlobalEqVector& residual()
+    { return residual_; }
+
+    void setLinearizationType(LinearizationType linearizationType)
+    { linearizationType_ = linearizationType; }
+
+    const LinearizationType& getLinearizationType() const
+    { return linearizationType_; }
+
+    void updateDiscretizationParameters()
+    {
+        // the face table is only updated if the matrix is recreated
+    }
+
+    void updateBoundaryConditionData()
+    {
+        // boundary conditions are handled by the local linearizer of the model
+    }
+
+    void updateFlowsInfo()
+    {
+        // This linearizer stores no such data.
+    }
+
+    /*!
+     * \brief Returns the map of constraint degrees of freedom.
+     *
+     * (This object is only non-empty if the EnableConstraints property is true.)
+     */
+    const std::map<unsigned, Constraints>& constraintsMap() const
+    { return constraintsMap_; }
+
+    /*!
+     * \brief Returns the number of sub-control volume faces in the face table, i.e.,
+     *        the number of interior faces of the elements which are neither on the
+     *        boundary nor skipped.
+     */
+    std::size_t numTableFaces() const
+    { return faces_.size(); }
+
+private:
+    Simulator& simulator_()
+    { return *simulatorPtr_; }
+    const Simulator& simulator_() const
+    { return *simulatorPtr_; }
+
+    Problem& problem_()
+    { return simulator_().problem(); }
+    const Problem& problem_() const
+    { return simulator_().problem(); }
+
+    Model& model_()
+    { return simulator_().model(); }
+    const Model& model_() const
+    { return simulator_().model(); }
+
+    const GridView& gridView_() const
+    { return problem_().gridView(); }
+
+    const ElementMapper& elementMapper_() const
+    { return model_().elementMapper(); }
+
+    void initFirstIteration_()
+    {
+        elementCtx_.clear();
+        for (unsigned threadIdx = 0; threadIdx < ThreadManager::maxThreads(); ++threadIdx)
+            elementCtx_.push_back(std::make_unique<ElementContext>(simulator_()));
+
+        createMatrix_();
+
+        residual_.resize(model_().numTotalDof());
+        resetSystem_();
+    }
+
+    // Construct the BCRS matrix for the Jacobian of the residual function and the
+    // table of the sub-control volume faces of all elements
+    void createMatrix_()
+    {
+        OPM_TIMEBLOCK(createMatrix);
+        const auto& model = model_();
+        const std::size_t numVertices = model.numGridDof();
+        const std::size_t numElements = elementMapper_().size();
+        ElementContext& elemCtx = *elementCtx_[0];
+        GradientCalculator gradCalc;
+        const bool enableGravity = Parameters::get<TypeTag, Properties::EnableGravity>();
+
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            phaseIsConsidered_[phaseIdx] = model.phaseIsConsidered(phaseIdx);
+
+        elementSeeds_.resize(numElements);
+        for (const auto& elem : elements(gridView_()))
+            elementSeeds_[elementMapper_().index(elem)] = elem.seed();
+
+        constexpr unsigned noOwner = std::numeric_limits<unsigned>::max();
+        std::vector<std::set<unsigned>> sparsityPattern(model.numTotalDof());
+        elementType_.resize(numElements);
+        ownerElement_.assign(numVertices, noOwner);
+        ownerLocalIdx_.assign(numVertices, 0);
+        fastVolume_.assign(numVertices, 0.0);
+        rowScale_.resize(numVertices);
+        faces_.clear();
+        faceWeights_.clear();
+
+        const auto& grid = gridView_().grid();
+        for (std::size_t elemIdx = 0; elemIdx < numElements; ++elemIdx) {
+            const auto elem = grid.entity(elementSeeds_[elemIdx]);
+            elemCtx.updateStencil(elem);
+            const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+
+            for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
+                const unsigned globI = stencil.globalSpaceIndex(dofIdx);
+                for (unsigned dof2Idx = 0; dof2Idx < stencil.numDof(); ++dof2Idx)
+                    sparsityPattern[globI].insert(stencil.globalSpaceIndex(dof2Idx));
+            }
+
+            if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity) {
+                elementType_[elemIdx] = ElementType_::Skipped;
+                continue;
+            }
+            else if (elemCtx.onBoundary()) {
+                elementType_[elemIdx] = ElementType_::Generic;
+                continue;
+            }
+            elementType_[elemIdx] = ElementType_::Fast;
+
+            // the intensive quantities of a vertex are computed using the stencil of
+            // the first element which contains it
+            for (unsigned dofIdx = 0; dofIdx < stencil.numPrimaryDof(); ++dofIdx) {
+                const unsigned globI = stencil.globalSpaceIndex(dofIdx);
+                if (ownerElement_[globI] == noOwner) {
+                    ownerElement_[globI] = static_cast<unsigned>(elemIdx);
+                    ownerLocalIdx_[globI] = dofIdx;
+                }
+                fastVolume_[globI] += stencil.subControlVolume(dofIdx).volume();
+            }
+
+            gradCalc.template prepare</*prepareValues=*/false, /*prepareGradients=*/true>(elemCtx, /*timeIdx=*/0);
+            for (unsigned faceIdx = 0; faceIdx < stencil.numInteriorFaces(); ++faceIdx)
+                addTableFace_(elemCtx, gradCalc, faceIdx, enableGravity);
+        }
+
+        for (std::size_t globI = 0; globI < numVertices; ++globI) {
+            // the residual of the generic linearizer is volume specific
+            const Scalar dofVolume = model.dofTotalVolume(static_cast<unsigned>(globI));
+            rowScale_[globI] = (useVolumetricResidual && dofVolume > 0.0) ? 1.0/dofVolume : 1.0;
+        }
+
+        // add the additional neighbors and degrees of freedom caused by the auxiliary
+        // equations
+        const std::size_t numAuxMod = model.numAuxiliaryModules();
+        for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
+            model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern);
+
+        jacobian_ = std::make_unique<SparseMatrixAdapter>(simulator_());
+        jacobian_->reserve(sparsityPattern);
+
+        // the incident faces of all vertices in compressed row format. each face is
+        // incident to its two adjacent vertices.
+        vertexFaceOffsets_.assign(numVertices + 1, 0);
+        for (const auto& face : faces_) {
+            ++vertexFaceOffsets_[face.i + 1];
+            ++vertexFaceOffsets_[face.j + 1];
+        }
+        for (std::size_t globI = 0; globI < numVertices; ++globI)
+            vertexFaceOffsets_[globI + 1] += vertexFaceOffsets_[globI];
+
+        vertexFaces_.resize(vertexFaceOffsets_[numVertices]);
+        std::vector<std::size_t> fillIdx(vertexFaceOffsets_.begin(), vertexFaceOffsets_.end() - 1);
+        for (std::size_t faceIdx = 0; faceIdx < faces_.size(); ++faceIdx) {
+            vertexFaces_[fillIdx[faces_[faceIdx].i]++] = static_cast<unsigned>(faceIdx);
+            vertexFaces_[fillIdx[faces_[faceIdx].j]++] = static_cast<unsigned>(faceIdx);
+        }
+
+        // the addresses of the matrix entries which are written by the incident faces
+        // of a vertex: the derivatives of the vertex' residual w.r.t. all vertices
+        // which have a weight for the face, in the order of the weights
+        incidentAddressOffsets_.resize(vertexFaces_.size() + 1);
+        incidentAddress_.clear();
+        for (std::size_t globI = 0; globI < numVertices; ++globI) {
+            for (std::size_t incIdx = vertexFaceOffsets_[globI]; incIdx < vertexFaceOffsets_[globI + 1]; ++incIdx) {
+                incidentAddressOffsets_[incIdx] = incidentAddress_.size();
+                const auto& face = faces_[vertexFaces_[incIdx]];
+                for (std::size_t wIdx = face.weightBegin; wIdx < face.weightEnd; ++wIdx)
+                    incidentAddress_.push_back(jacobian_->blockAddress(globI, faceWeights_[wIdx].vertex));
+            }
+        }
+        incidentAddressOffsets_[vertexFaces_.size()] = incidentAddress_.size();
+
+        diagAddress_.resize(numVertices);
+        for (std::size_t globI = 0; globI < numVertices; ++globI)
+            diagAddress_[globI] = jacobian_->blockAddress(globI, globI);
+
+        intQuants_.resize(numVertices);
+        extrusion_.resize(numVertices);
+    }
+
+    // add an interior face of the current stencil to the face table
+    //
+    // the volume flux of a phase over the face is -lambda_up*(gradPhi*(K^T*n))*A, where
+    // the potential gradient is the sum of the pressures of the vertices times their
+    // gradient weights plus the hydrostatic correction of the Darcy flux module, i.e.,
+    // d*(rho_i*g_i*(x_i - x_f) - rho_j*g_j*(x_j - x_f))/|d|^2 with d = x_j - x_i.
+    void addTableFace_(const ElementContext& elemCtx,
+                       const GradientCalculator& gradCalc,
+                       unsigned faceIdx,
+                       bool enableGravity)
+    {
+        const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+        const auto& scvf = stencil.interiorFace(faceIdx);
+        const unsigned i = scvf.interiorIndex();
+        const unsigned j = scvf.exteriorIndex();
+        const DimVector& normal = scvf.normal();
+
+        DimMatrix K;
+        problem_().faceIntrinsicPermeability(K, elemCtx, faceIdx, /*timeIdx=*/0);
+        DimVector KTn;
+        K.mtv(normal, KTn);
+
+        DimVector distVec = elemCtx.pos(j, /*timeIdx=*/0);
+        distVec -= elemCtx.pos(i, /*timeIdx=*/0);
+        const Scalar distSquared = distVec.two_norm2();
+
+        Face_ face;
+        face.i = stencil.globalSpaceIndex(i);
+        face.j = stencil.globalSpaceIndex(j);
+        face.gravityPerm = scvf.area()*(distVec*KTn)/distSquared;
+        face.gravityDir = (distVec*normal)/distSquared;
+        face.hIn = 0.0;
+        face.hEx = 0.0;
+        if (enableGravity) {
+            DimVector distVecIn = elemCtx.pos(i, /*timeIdx=*/0);
+            DimVector distVecEx = elemCtx.pos(j, /*timeIdx=*/0);
+            distVecIn -= scvf.integrationPos();
+            distVecEx -= scvf.integrationPos();
+            face.hIn = problem_().gravity(elemCtx, i, /*timeIdx=*/0)*distVecIn;
+            face.hEx = problem_().gravity(elemCtx, j, /*timeIdx=*/0)*distVecEx;
+        }
+
+        // the weights of the two adjacent vertices come first, followed by the ones
+        // of all other vertices of the element which influence the gradient
+        face.weightBegin = faceWeights_.size();
+        const auto addWeight = [&](unsigned dofIdx, bool always) {
+            EvalDimVector grad;
+            gradCalc.calculateGradient(grad, elemCtx, faceIdx, UnitDofCallback_(dofIdx));
+
+            DimVector gradWeight;
+            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                gradWeight[dimIdx] = Toolbox::value(grad[dimIdx]);
+
+            if (!always && gradWeight.two_norm2() == 0.0)
+                return;
+
+            FaceWeight_ weight;
+            weight.vertex = stencil.globalSpaceIndex(dofIdx);
+            weight.perm = scvf.area()*(gradWeight*KTn);
+            weight.dir = gradWeight*normal;
+            faceWeights_.push_back(weight);
+        };
+        addWeight(i, /*always=*/true);
+        addWeight(j, /*always=*/true);
+        for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx)
+            if (dofIdx != i && dofIdx != j)
+                addWeight(dofIdx, /*always=*/false);
+        face.weightEnd = faceWeights_.size();
+
+        faces_.push_back(face);
+    }
+
+    // reset the global linear system of equations.
+    void resetSystem_()
+    {
+        residual_ = 0.0;
+        // zero all matrix entries
+        jacobian_->clear();
+    }
+
+    void linearize_()
+    {
+        OPM_TIMEBLOCK(linearize_);
+
+        // the constraints may be time dependent, but they do not depend on the solution
+        if (model_().newtonMethod().numIterations() == 0)
+            updateConstraintsMap_();
+
+        applyConstraintsToSolution_();
+
+        // to avoid a race condition if two threads handle an exception at the same time,
+        // we use an explicit lock to control access to the exception storage object
+        // amongst thread-local handlers
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+
+        // each vertex only writes its own row of the residual and of the Jacobian
+        // matrix, so the vertices can be linearized concurrently. the intensive
+        // quantities are computed first because the fluxes need the ones of all
+        // vertices of the elements.
+        const std::size_t numVertices = ownerElement_.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::size_t globI = 0; globI < numVertices; ++globI) {
+            if (fastVolume_[globI] <= 0.0)
+                continue;
+
+            // see FvBaseLinearizer::linearize_() for the rationale of the exception
+            // handling
+            try {
+                updateVertex_(static_cast<unsigned>(globI));
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+            }
+        }
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::size_t globI = 0; globI < numVertices; ++globI) {
+            if (vertexFaceOffsets_[globI] == vertexFaceOffsets_[globI + 1])
+                continue;
+
+            try {
+                addFluxes_(static_cast<unsigned>(globI));
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+            }
+        }
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
+        // the elements on the boundary share vertices, so their contributions are
+        // added under a lock
+        std::mutex matrixLock;
+        const std::size_t numElements = elementSeeds_.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::size_t elemIdx = 0; elemIdx < numElements; ++elemIdx) {
+            if (elementType_[elemIdx] != ElementType_::Generic)
+                continue;
+
+            try {
+                linearizeGenericElement_(static_cast<unsigned>(elemIdx), matrixLock);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+            }
+        }
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
+        applyConstraintsToLinearization_();
+    }
+
+    // compute the intensive quantities of a vertex which are required by the face
+    // table and add the storage and source terms of the parts of its sub-control
+    // volume which belong to the elements of the face table
+    void updateVertex_(unsigned globI)
+    {
+        ElementContext& elemCtx = *elementCtx_[ThreadManager::threadId()];
+        const auto elem = gridView_().grid().entity(elementSeeds_[ownerElement_[globI]]);
+        const unsigned localIdx = ownerLocalIdx_[globI];
+        elemCtx.updatePrimaryStencil(elem);
+        elemCtx.updateSingleIntensiveQuantities(localIdx, /*timeIdx=*/0);
+
+        const IntensiveQuantities& intQuants = std::as_const(elemCtx).intensiveQuantities(localIdx, /*timeIdx=*/0);
+        intQuants_[globI] = intQuants;
+        extrusion_[globI] = intQuants.extrusionFactor();
+
+        // storage term using the implicit Euler time discretization
+        EvalEqVector storage;
+        LocalResidual::computeStorage(storage, intQuants);
+        const EqVector oldStorage = oldStorage_(elemCtx, globI, localIdx, storage);
+
+        const Scalar volume = fastVolume_[globI]*intQuants.extrusionFactor();
+        const Scalar dt = simulator_().timeStepSize();
+
+        // source term
+        RateVector source;
+        model_().localResidual(ThreadManager::threadId()).computeSource(source, elemCtx,
+                                                                        localIdx,
+                                                                        /*timeIdx=*/0);
+
+        EvalEqVector res;
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            res[eqIdx] = (storage[eqIdx] - oldStorage[eqIdx])*(volume/dt)
+                - source[eqIdx]*volume;
+
+        addToRow_(globI, *diagAddress_[globI], res, rowScale_[globI]);
+    }
+
+    // the storage term of the previous time step, which is taken from the storage cache
+    // of the model if it is enabled
+    EqVector oldStorage_(ElementContext& elemCtx,
+                         unsigned globI,
+                         unsigned localIdx,
+                         const EvalEqVector& storage) const
+    {
+        EqVector oldStorage;
+        const auto& model = model_();
+        if (elemCtx.enableStorageCache()) {
+            if (model.newtonMethod().numIterations() == 0) {
+                if (problem_().recycleFirstIterationStorage()) {
+                    for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                        oldStorage[eqIdx] = Toolbox::value(storage[eqIdx]);
+                }
+                else {
+                    elemCtx.updateSingleIntensiveQuantities(localIdx, /*timeIdx=*/1);
+                    LocalResidual::computeStorage(oldStorage,
+                                                  std::as_const(elemCtx).intensiveQuantities(localIdx, /*timeIdx=*/1));
+                }
+                model.updateCachedStorage(globI, /*timeIdx=*/1, oldStorage);
+                return oldStorage;
+            }
+
+            return model.cachedStorage(globI, /*timeIdx=*/1);
+        }
+
+        elemCtx.updateSingleIntensiveQuantities(localIdx, /*timeIdx=*/1);
+        LocalResidual::computeStorage(oldStorage, std::as_const(elemCtx).intensiveQuantities(localIdx, /*timeIdx=*/1));
+        return oldStorage;
+    }
+
+    // add the fluxes over all incident faces of a vertex to its residual and their
+    // derivatives to the vertex' row of the Jacobian matrix.
+    //
+    // The derivatives w.r.t. the two vertices adjacent to a face are obtained by
+    // evaluating the flux twice, once with the derivatives of each vertex. All other
+    // vertices only influence the flux via their pressures, so their derivatives are
+    // the chain rule of the pressure derivatives and the weights of the vertices.
+    void addFluxes_(unsigned globI)
+    {
+        PhaseFluxes_ phaseFluxes;
+        PhaseFluxes_ phaseFluxesEx;
+        std::array<Scalar, numPhases> potential;
+        std::array<Scalar, numPhases> upMobility;
+        std::array<EqVector, numPhases> fluxPerVolume;
+        RateVector flux;
+
+        const Scalar rowScale = rowScale_[globI];
+        const std::size_t incEnd = vertexFaceOffsets_[globI + 1];
+        for (std::size_t incIdx = vertexFaceOffsets_[globI]; incIdx < incEnd; ++incIdx) {
+            const Face_& face = faces_[vertexFaces_[incIdx]];
+            MatrixBlock* const* address = &incidentAddress_[incidentAddressOffsets_[incIdx]];
+
+            // the flux leaves the interior vertex and enters the exterior one
+            const Scalar scale = ((face.i == globI) ? 1.0 : -1.0)*rowScale;
+
+            const IntensiveQuantities& intQuantsIn = intQuants_[face.i];
+            const IntensiveQuantities& intQuantsEx = intQuants_[face.j];
+            const auto& fsIn = intQuantsIn.fluidState();
+            const auto& fsEx = intQuantsEx.fluidState();
+            const Scalar extrusion = (extrusion_[face.i] + extrusion_[face.j])/2;
+            const FaceWeight_& weightIn = faceWeights_[face.weightBegin];
+            const FaceWeight_& weightEx = faceWeights_[face.weightBegin + 1];
+
+            // the values of the potential gradients and the upstream directions
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                if (!phaseIsConsidered_[phaseIdx]) {
+                    potential[phaseIdx] = 0.0;
+                    upMobility[phaseIdx] = 0.0;
+                    phaseFluxes.interiorIsUpstream_[phaseIdx] = true;
+                    continue;
+                }
+
+                const Scalar hydrostatic =
+                    Toolbox::value(fsIn.density(phaseIdx))*face.hIn
+                    - Toolbox::value(fsEx.density(phaseIdx))*face.hEx;
+                Scalar normalGrad = face.gravityDir*hydrostatic;
+                potential[phaseIdx] = face.gravityPerm*hydrostatic;
+                for (std::size_t wIdx = face.weightBegin; wIdx < face.weightEnd; ++wIdx) {
+                    const FaceWeight_& weight = faceWeights_[wIdx];
+                    const Scalar p = Toolbox::value(intQuants_[weight.vertex].fluidState().pressure(phaseIdx));
+                    normalGrad += weight.dir*p;
+                    potential[phaseIdx] += weight.perm*p;
+                }
+
+                const bool interiorIsUpstream = !(normalGrad > 0.0);
+                phaseFluxes.interiorIsUpstream_[phaseIdx] = interiorIsUpstream;
+                upMobility[phaseIdx] = Toolbox::value(interiorIsUpstream
+                                                      ? intQuantsIn.mobility(phaseIdx)
+                                                      : intQuantsEx.mobility(phaseIdx));
+            }
+
+            // the flux with the derivatives w.r.t. the interior vertex
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                if (!phaseIsConsidered_[phaseIdx]) {
+                    phaseFluxes.volumeFlux_[phaseIdx] = 0.0;
+                    continue;
+                }
+
+                const Evaluation& pIn = fsIn.pressure(phaseIdx);
+                const Evaluation& rhoIn = fsIn.density(phaseIdx);
+                const Evaluation pot =
+                    potential[phaseIdx]
+                    + weightIn.perm*(pIn - Toolbox::value(pIn))
+                    + face.gravityPerm*face.hIn*(rhoIn - Toolbox::value(rhoIn));
+                if (phaseFluxes.interiorIsUpstream_[phaseIdx])
+                    phaseFluxes.volumeFlux_[phaseIdx] = -extrusion*intQuantsIn.mobility(phaseIdx)*pot;
+                else
+                    phaseFluxes.volumeFlux_[phaseIdx] = -extrusion*upMobility[phaseIdx]*pot;
+            }
+
+            flux = 0.0;
+            LocalResidual::addTpfaAdvectiveFlux(flux, intQuantsIn, intQuantsEx, phaseFluxes);
+            addBlock_(*address[0], flux, scale);
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                residual_[globI][eqIdx] += Toolbox::value(flux[eqIdx])*scale;
+
+            // the flux with the derivatives w.r.t. the exterior vertex. the roles of the
+            // two vertices are swapped for the local residual because only the
+            // quantities of its interior side carry derivatives.
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                phaseFluxesEx.interiorIsUpstream_[phaseIdx] = !phaseFluxes.interiorIsUpstream_[phaseIdx];
+                if (!phaseIsConsidered_[phaseIdx]) {
+                    phaseFluxesEx.volumeFlux_[phaseIdx] = 0.0;
+                    continue;
+                }
+
+                const Evaluation& pEx = fsEx.pressure(phaseIdx);
+                const Evaluation& rhoEx = fsEx.density(phaseIdx);
+                const Evaluation pot =
+                    potential[phaseIdx]
+                    + weightEx.perm*(pEx - Toolbox::value(pEx))
+                    - face.gravityPerm*face.hEx*(rhoEx - Toolbox::value(rhoEx));
+                if (phaseFluxesEx.interiorIsUpstream_[phaseIdx])
+                    phaseFluxesEx.volumeFlux_[phaseIdx] = -extrusion*intQuantsEx.mobility(phaseIdx)*pot;
+                else
+                    phaseFluxesEx.volumeFlux_[phaseIdx] = -extrusion*upMobility[phaseIdx]*pot;
+            }
+
+            flux = 0.0;
+            LocalResidual::addTpfaAdvectiveFlux(flux, intQuantsEx, intQuantsIn, phaseFluxesEx);
+            addBlock_(*address[1], flux, scale);
+
+            if (face.weightEnd - face.weightBegin <= 2)
+                continue;
+
+            // the fluxes of the conservation quantities per unit volume flux of each
+            // phase, which are constant w.r.t. the other vertices of the element
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                for (unsigned phase2Idx = 0; phase2Idx < numPhases; ++phase2Idx)
+                    phaseFluxes.volumeFlux_[phase2Idx] = (phase2Idx == phaseIdx) ? 1.0 : 0.0;
+
+                flux = 0.0;
+                if (phaseIsConsidered_[phaseIdx])
+                    LocalResidual::addTpfaAdvectiveFlux(flux, intQuantsIn, intQuantsEx, phaseFluxes);
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    fluxPerVolume[phaseIdx][eqIdx] = Toolbox::value(flux[eqIdx]);
+            }
+
+            for (std::size_t wIdx = face.weightBegin + 2; wIdx < face.weightEnd; ++wIdx) {
+                const FaceWeight_& weight = faceWeights_[wIdx];
+                const auto& fs = intQuants_[weight.vertex].fluidState();
+                MatrixBlock& block = *address[wIdx - face.weightBegin];
+                for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                    if (!phaseIsConsidered_[phaseIdx])
+                        continue;
+
+                    const Scalar dFluxDp = -extrusion*upMobility[phaseIdx]*weight.perm*scale;
+                    const Evaluation& p = fs.pressure(phaseIdx);
+                    for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                        for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                            block[eqIdx][pvIdx] +=
+                                fluxPerVolume[phaseIdx][eqIdx]*dFluxDp*p.derivative(pvIdx);
+                }
+            }
+        }
+    }
+
+    // add the derivatives of a vector of evaluations to a block of the Jacobian matrix
+    static void addBlock_(MatrixBlock& block, const RateVector& flux, Scalar scale)
+    {
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                block[eqIdx][pvIdx] += flux[eqIdx].derivative(pvIdx)*scale;
+    }
+
+    // add the values of a vector of evaluations to the residual of a vertex and their
+    // derivatives to a block of the Jacobian matrix
+    void addToRow_(unsigned globI, MatrixBlock& block, const EvalEqVector& res, Scalar scale)
+    {
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            residual_[globI][eqIdx] += res[eqIdx].value()*scale;
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                block[eqIdx][pvIdx] += res[eqIdx].derivative(pvIdx)*scale;
+        }
+    }
+
+    // linearize an element using the local linearizer of the model
+    void linearizeGenericElement_(unsigned elemIdx, std::mutex& matrixLock)
+    {
+        const unsigned threadId = ThreadManager::threadId();
+        ElementContext& elemCtx = *elementCtx_[threadId];
+        auto& localLinearizer = model_().localLinearizer(threadId);
+
+        const auto elem = gridView_().grid().entity(elementSeeds_[elemIdx]);
+        localLinearizer.linearize(elemCtx, elem);
+
+        std::lock_guard<std::mutex> lock(matrixLock);
+        const std::size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+        for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++primaryDofIdx) {
+            const unsigned globI = elemCtx.globalSpaceIndex(primaryDofIdx, /*timeIdx=*/0);
+            residual_[globI] += localLinearizer.residual(primaryDofIdx);
+            for (unsigned dofIdx = 0; dofIdx < elemCtx.numDof(/*timeIdx=*/0); ++dofIdx) {
+                const unsigned globJ = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                jacobian_->addToBlock(globJ, globI, localLinearizer.jacobian(dofIdx, primaryDofIdx));
+            }
+        }
+    }
+
+    // query the problem for all constraint degrees of freedom
+    void updateConstraintsMap_()
+    {
+        if (!enableConstraints_())
+            // constraints are not explictly enabled, so we don't need to consider them!
+            return;
+
+        constraintsMap_.clear();
+
+        ElementContext& elemCtx = *elementCtx_[0];
+        const auto& grid = gridView_().grid();
+        for (std::size_t elemIdx = 0; elemIdx < elementSeeds_.size(); ++elemIdx) {
+            if (elementType_[elemIdx] == ElementType_::Skipped)
+                continue;
+
+            const auto elem = grid.entity(elementSeeds_[elemIdx]);
+            elemCtx.updateStencil(elem);
+
+            for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++dofIdx) {
+                Constraints constraints;
+                elemCtx.problem().constraints(constraints, elemCtx, dofIdx, /*timeIdx=*/0);
+                if (constraints.isActive()) {
+                    const unsigned globI = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                    constraintsMap_[globI] = constraints;
+                }
+            }
+        }
+    }
+
+    // apply the constraints to the solution. (i.e., the solution of constraint degrees
+    // of freedom is set to the value of the constraint.)
+    void applyConstraintsToSolution_()
+    {
+        if (!enableConstraints_())
+            return;
+
+        auto& sol = model_().solution(/*timeIdx=*/0);
+        auto& oldSol = model_().solution(/*timeIdx=*/1);
+        for (const auto& [dofIdx, constraints] : constraintsMap_) {
+            sol[dofIdx] = constraints;
+            oldSol[dofIdx] = constraints;
+        }
+    }
+
+    // apply the constraints to the linearization. (i.e., for constrain degrees of
+    // freedom the Jacobian matrix maps to identity and the residual is zero)
+    void applyConstraintsToLinearization_()
+    {
+        if (!enableConstraints_())
+            return;
+
+        for (const auto& constraint : constraintsMap_) {
+            jacobian_->clearRow(constraint.first, Scalar(1.0));
+            residual_[constraint.first] = 0.0;
+        }
+    }
+
+    static bool enableConstraints_()
+    { return getPropValue<TypeTag, Properties::EnableConstraints>(); }
+
+    // a sub-control volume face of the face table
+    struct Face_
+    {
+        // the global indices of the interior and exterior vertices
+        unsigned i;
+        unsigned j;
+        // the geometric factors of the hydrostatic correction for the permeability
+        // weighted normal and the unit normal
+        Scalar gravityPerm;
+        Scalar gravityDir;
+        // g*(x - x_f) of the interior and the exterior vertex
+        Scalar hIn;
+        Scalar hEx;
+        // the range of the gradient weights of the face
+        std::size_t weightBegin;
+        std::size_t weightEnd;
+    };
+
+    // the weight of a vertex for the pressure gradient at a face projected onto the
+    // permeability weighted normal (times the face area) and onto the unit normal
+    struct FaceWeight_
+    {
+        unsigned vertex;
+        Scalar perm;
+        Scalar dir;
+    };
+
+    Simulator* simulatorPtr_ = nullptr;
+    std::vector<std::unique_ptr<ElementContext>> elementCtx_;
+
+    // The constraint equations (only non-empty if the
+    // EnableConstraints property is true)
+    std::map<unsigned, Constraints> constraintsMap_;
+
+    // the jacobian matrix and the right-hand side
+    std::unique_ptr<SparseMatrixAdapter> jacobian_;
+    GlobalEqVector residual_;
+
+    LinearizationType linearizationType_;
+
+    // the phases for which fluxes are computed
+    std::array<bool, numPhases> phaseIsConsidered_{};
+
+    // the grid elements and their linearization scheme
+    std::vector<ElementSeed> elementSeeds_;
+    std::vector<ElementType_> elementType_;
+
+    // the element and the local index which are used to compute the intensive
+    // quantities of each vertex, the volume of the parts of its sub-control volume in
+    // the elements of the face table and the factor which converts the residual of the
+    // vertex to the volume specific one
+    std::vector<unsigned> ownerElement_;
+    std::vector<unsigned> ownerLocalIdx_;
+    std::vector<Scalar> fastVolume_;
+    std::vector<Scalar> rowScale_;
+
+    // the face table and the gradient weights of the faces
+    std::vector<Face_> faces_;
+    std::vector<FaceWeight_> faceWeights_;
+
+    // the incident faces of all vertices in compressed row format and the addresses of
+    // the matrix entries which are written by each of them
+    std::vector<std::size_t> vertexFaceOffsets_;
+    std::vector<unsigned> vertexFaces_;
+    std::vector<std::size_t> incidentAddressOffsets_;
+    std::vector<MatrixBlock*> incidentAddress_;
+    std::vector<MatrixBlock*> diagAddress_;
+
+    // the intensive quantities and extrusion factors of all vertices for the current
+    // solution
+    std::vector<IntensiveQuantities> intQuants_;
+    std::vector<Scalar> extrusion_;
+};
+
+} // namespace Opm
+
+#endif
@@ -32,6 +32,7 @@
 
 #include <dune/grid/common/intersectioniterator.hh>
 #include <dune/grid/common/mcmgmapper.hh>
+#include <dune/grid/common/rangegenerators.hh>
 #include <dune/geometry/referenceelements.hh>
 
 #if HAVE_DUNE_LOCALFUNCTIONS
@@ -40,6 +41,7 @@
 
 #include <dune/common/version.hh>
 
+#include <algorithm>
 #include <stdexcept>
 #include <vector>
 
@@ -808,6 +810,96 @@ public:
     //! compatibility alias
     using BoundaryFace = SubControlVolumeFace;
 
+    /*!
+     * \brief The precomputed geometry of the stencils of all elements of a grid view.
+     *
+     * Computing the sub-control volumes and their faces is expensive compared to
+     * copying them. If a cache is attached to a stencil, update() copies the geometric
+     * data of the element from the cache and only determines the topology itself. The
+     * cache must be updated whenever the grid changes.
+     */
+    class GeometryCache
+    {
+        struct Entry
+        {
+            LocalPosition elementLocal;
+            GlobalPosition elementGlobal;
+            Scalar elementVolume;
+            Scalar scvVolume[maxNC];
+            SubControlVolumeFace faces[maxNE];
+            unsigned boundaryFaceBegin;
+            unsigned numBoundaryFaces;
+        };
+
+    public:
+        /*!
+         * \brief Compute the geometry of the stencils of all elements.
+         *
+         * \param elementMapper The mapper which is used to look up the elements. It
+         *                      must outlive the cache.
+         */
+        void update(const GridView& gridView,
+                    const Mapper& elementMapper,
+                    const Mapper& vertexMapper)
+        {
+            entries_.clear();
+            entries_.resize(static_cast<std::size_t>(elementMapper.size()));
+            boundaryFaces_.clear();
+            elementMapper_ = &elementMapper;
+
+            VcfvStencil stencil(gridView, vertexMapper);
+            for (const auto& elem : elements(gridView)) {
+                stencil.update(elem);
+
+                Entry& entry = entries_[static_cast<std::size_t>(elementMapper.index(elem))];
+                entry.elementLocal = stencil.elementLocal;
+                entry.elementGlobal = stencil.elementGlobal;
+                entry.elementVolume = stencil.elementVolume;
+                for (unsigned scvIdx = 0; scvIdx < stencil.numVertices; ++scvIdx)
+                    entry.scvVolume[scvIdx] = stencil.subContVol[scvIdx].volume_;
+                std::copy(stencil.subContVolFace, stencil.subContVolFace + stencil.numEdges, entry.faces);
+                entry.boundaryFaceBegin = static_cast<unsigned>(boundaryFaces_.size());
+                entry.numBoundaryFaces = stencil.numBoundarySegments_;
+                boundaryFaces_.insert(boundaryFaces_.end(),
+                                      stencil.boundaryFace_,
+                                      stencil.boundaryFace_ + stencil.numBoundarySegments_);
+            }
+        }
+
+        /*!
+         * \brief Returns true if the cache does not contain any elements.
+         */
+        bool empty() const
+        { return entries_.empty(); }
+
+    private:
+        friend class VcfvStencil;
+
+        // copy the geometry of an element into a stencil whose topology is up to date
+        bool load_(VcfvStencil& stencil, const Element& elem) const
+        {
+            if (entries_.empty())
+                return false;
+
+            const Entry& entry = entries_[static_cast<std::size_t>(elementMapper_->index(elem))];
+            stencil.elementLocal = entry.elementLocal;
+            stencil.elementGlobal = entry.elementGlobal;
+            stencil.elementVolume = entry.elementVolume;
+            for (unsigned scvIdx = 0; scvIdx < stencil.numVertices; ++scvIdx)
+                stencil.subContVol[scvIdx].volume_ = entry.scvVolume[scvIdx];
+            std::copy(entry.faces, entry.faces + stencil.numEdges, stencil.subContVolFace);
+            stencil.numBoundarySegments_ = entry.numBoundaryFaces;
+            std::copy(boundaryFaces_.begin() + entry.boundaryFaceBegin,
+                      boundaryFaces_.begin() + entry.boundaryFaceBegin + entry.numBoundaryFaces,
+                      stencil.boundaryFace_);
+            return true;
+        }
+
+        std::vector<Entry> entries_;
+        std::vector<BoundaryFace> boundaryFaces_;
+        const Mapper* elementMapper_ = nullptr;
+    };
+
     VcfvStencil(const GridView& gridView, const Mapper& mapper)
         : gridView_(gridView)
         , vertexMapper_(mapper )
@@ -861,10 +953,23 @@ public:
         updateTopology(element);
     }
 
+    /*!
+     * \brief Attach the stencil to a cache of precomputed geometries.
+     *
+     * A null pointer detaches the stencil from its cache.
+     */
+    void setGeometryCache(const GeometryCache* cache)
+    { geometryCache_ = cache; }
+
     void update(const Element& e)
     {
         updateTopology(e);
 
+        if (geometryCache_ && geometryCache_->load_(*this, e)) {
+            updateScvGeometry(e);
+            return;
+        }
+
         const Geometry& geometry = e.geometry();
         geometryType_ = geometry.type();
 
@@ -1345,6 +1450,7 @@ private:
 
     const GridView&     gridView_;
     const Mapper& vertexMapper_;
+    const GeometryCache* geometryCache_ = nullptr;
 
     Element element_;
 
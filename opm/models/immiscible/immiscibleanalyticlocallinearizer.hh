@@ -0,0 +1,278 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::ImmiscibleAnalyticLocalLinearizer
+ */
+#ifndef EWOMS_IMMISCIBLE_ANALYTIC_LOCAL_LINEARIZER_HH
+#define EWOMS_IMMISCIBLE_ANALYTIC_LOCAL_LINEARIZER_HH
+
+#include "immiscibleproperties.hh"
+
+#include <opm/common/Exceptions.hpp>
+
+#include <opm/models/common/darcyfluxmodule.hh>
+#include <opm/models/discretization/common/fvbaseadlocallinearizer.hh>
+#include <opm/models/utils/parametersystem.hh>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+namespace Opm {
+// forward declaration
+template<class TypeTag>
+class ImmiscibleAnalyticLocalLinearizer;
+}
+
+namespace Opm::Properties {
+
+namespace TTag {
+struct ImmiscibleAnalyticLocalLinearizer
+{ using InheritsFrom = std::tuple<AutoDiffLocalLinearizer>; };
+} // namespace TTag
+
+// set the properties to be spliced in. the function evaluation is inherited from the
+// automatic differentiation linearizer.
+template<class TypeTag>
+struct LocalLinearizer<TypeTag, TTag::ImmiscibleAnalyticLocalLinearizer>
+{ using type = ImmiscibleAnalyticLocalLinearizer<TypeTag>; };
+
+} // namespace Opm::Properties
+
+namespace Opm {
+
+/*!
+ * \ingroup ImmiscibleModel
+ *
+ * \brief Calculates the local residual and its Jacobian for a single element of the
+ *        grid using hand-derived derivatives of the fluxes of the immiscible model.
+ *
+ * With automatic differentiation, most of the time spent by the local linearizer goes
+ * into the extensive quantities: The potential gradients, the filter velocities and
+ * the volume fluxes are vectors of function evaluations, each of which carries the
+ * derivatives w.r.t. all primary variables. For the two-point flux approximation of
+ * Darcy's law, the derivatives of the mass flux of a phase over a face are simple
+ * expressions of the derivatives of the pressure, the density and the mobility in
+ * the interior cell. This linearizer evaluates these expressions directly using
+ * scalars.
+ *
+ * The derivatives of the intensive quantities themselves are still provided by
+ * automatic differentiation because they depend on the material laws and the fluid
+ * system of the problem. The storage and source terms are evaluated by the local
+ * residual of the model.
+ *
+ * The system of equations is the same as the one of FvBaseAdLocalLinearizer. Elements
+ * which exhibit boundary faces or more than one primary degree of freedom, i.e., all
+ * elements if the vertex-centered finite volume method is used, are linearized by
+ * FvBaseAdLocalLinearizer.
+ *
+ * The linearizer is selected by setting the LocalLinearizerSplice property to
+ * \c TTag::ImmiscibleAnalyticLocalLinearizer. It requires the Darcy flux module and
+ * does not support the energy equation.
+ */
+template<class TypeTag>
+class ImmiscibleAnalyticLocalLinearizer : public FvBaseAdLocalLinearizer<TypeTag>
+{
+    using ParentType = FvBaseAdLocalLinearizer<TypeTag>;
+
+    using LocalResidual = GetPropType<TypeTag, Properties::LocalResidual>;
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using FluxModule = GetPropType<TypeTag, Properties::FluxModule>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
+    using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using Element = typename GridView::template Codim<0>::Entity;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+    enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
+    enum { conti0EqIdx = Indices::conti0EqIdx };
+    enum { dimWorld = GridView::dimensionworld };
+
+    using DimVector = Dune::FieldVector<Scalar, dimWorld>;
+    using DimMatrix = Dune::FieldMatrix<Scalar, dimWorld, dimWorld>;
+    using LocalEvalBlockVector = typename LocalResidual::LocalEvalBlockVector;
+
+    static constexpr bool useVolumetricResidual =
+        getPropValue<TypeTag, Properties::UseVolumetricResidual>();
+
+    static_assert(std::is_same<FluxModule, DarcyFluxModule<TypeTag>>::value,
+                  "The analytic local linearizer requires the Darcy flux module");
+    static_assert(!getPropValue<TypeTag, Properties::EnableEnergy>(),
+                  "The analytic local linearizer does not support the energy equation");
+
+public:
+    /*!
+     * \copydoc FvBaseAdLocalLinearizer::linearize(const Element&)
+     */
+    void linearize(const Element& element)
+    { linearize(*this->internalElemContext_, element); }
+
+    /*!
+     * \copydoc FvBaseAdLocalLinearizer::linearize(ElementContext&, const Element&)
+     */
+    void linearize(ElementContext& elemCtx, const Element& elem)
+    {
+        elemCtx.updateStencil(elem);
+        if (elemCtx.numPrimaryDof(/*timeIdx=*/0) != 1 || elemCtx.onBoundary()) {
+            ParentType::linearize(elemCtx, elem);
+            return;
+        }
+
+        elemCtx.updateAllIntensiveQuantities();
+
+        // update the weights of the primary variables for the context
+        this->model_().updatePVWeights(elemCtx);
+
+        this->resize_(elemCtx);
+        this->reset_(elemCtx);
+        elemCtx.setFocusDofIndex(/*dofIdx=*/0);
+
+        // storage and source terms
+        volumeTerms_.resize(elemCtx.numDof(/*timeIdx=*/0));
+        this->localResidual_.evalVolumeTerms(volumeTerms_, elemCtx, /*dofIdx=*/0);
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            this->residual_[0][eqIdx] = volumeTerms_[0][eqIdx].value();
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                this->jacobian_[0][0][eqIdx][pvIdx] = volumeTerms_[0][eqIdx].derivative(pvIdx);
+        }
+
+        addFluxes_(elemCtx);
+    }
+
+private:
+    // add the mass fluxes over all faces of the element to its residual and their
+    // derivatives w.r.t. the primary variables of the element to the local Jacobian.
+    //
+    // With the potential difference dPhi = p_j - p_i - rho_j*(g*(x_j - x_f)) +
+    // rho_i*(g*(x_i - x_f)) of a phase and the transmissibility T = A*(K*d*n)/|d|^2 of
+    // the face, the mass flux out of the element is m = -T*(lambda*rho)_up*dPhi. Its
+    // derivative w.r.t. a primary variable x of the element is thus
+    //
+    //     dm/dx = -T*(d(lambda*rho)_up/dx*dPhi + (lambda*rho)_up*dPhi/dx),
+    //
+    // where the first term vanishes if the neighbor is the upstream cell.
+    void addFluxes_(const ElementContext& elemCtx)
+    {
+        const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+        const auto& problem = elemCtx.problem();
+        const bool enableGravity = Parameters::getCached<TypeTag, Properties::EnableGravity>();
+
+        const IntensiveQuantities& intQuantsIn = elemCtx.intensiveQuantities(/*dofIdx=*/0, /*timeIdx=*/0);
+        const auto& fsIn = intQuantsIn.fluidState();
+        const Scalar scaleIn = residualScale_(elemCtx, /*dofIdx=*/0);
+
+        const std::size_t numInteriorFaces = elemCtx.numInteriorFaces(/*timeIdx=*/0);
+        for (unsigned faceIdx = 0; faceIdx < numInteriorFaces; ++faceIdx) {
+            const auto& face = stencil.interiorFace(faceIdx);
+            const unsigned i = face.interiorIndex();
+            const unsigned j = face.exteriorIndex();
+            const IntensiveQuantities& intQuantsEx = elemCtx.intensiveQuantities(j, /*timeIdx=*/0);
+            const auto& fsEx = intQuantsEx.fluidState();
+
+            DimVector distVec = elemCtx.pos(j, /*timeIdx=*/0);
+            distVec -= elemCtx.pos(i, /*timeIdx=*/0);
+
+            DimMatrix K;
+            problem.faceIntrinsicPermeability(K, elemCtx, faceIdx, /*timeIdx=*/0);
+            DimVector Kd;
+            K.mv(distVec, Kd);
+
+            const Scalar extrusion =
+                (intQuantsIn.extrusionFactor() + intQuantsEx.extrusionFactor())/2;
+            const Scalar trans =
+                face.area()*extrusion*(Kd*face.normal())/distVec.two_norm2();
+            const Scalar direction = distVec*face.normal();
+
+            Scalar hIn = 0.0;
+            Scalar hEx = 0.0;
+            if (enableGravity) {
+                DimVector distVecIn = elemCtx.pos(i, /*timeIdx=*/0);
+                DimVector distVecEx = elemCtx.pos(j, /*timeIdx=*/0);
+                distVecIn -= face.integrationPos();
+                distVecEx -= face.integrationPos();
+                hIn = problem.gravity(elemCtx, i, /*timeIdx=*/0)*distVecIn;
+                hEx = problem.gravity(elemCtx, j, /*timeIdx=*/0)*distVecEx;
+            }
+
+            const Scalar scaleEx = residualScale_(elemCtx, j);
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                const auto& pIn = fsIn.pressure(phaseIdx);
+                const auto& rhoIn = fsIn.density(phaseIdx);
+                const auto& mobIn = intQuantsIn.mobility(phaseIdx);
+
+                const Scalar dPhi =
+                    fsEx.pressure(phaseIdx).value() - pIn.value()
+                    - fsEx.density(phaseIdx).value()*hEx + rhoIn.value()*hIn;
+                if (!std::isfinite(dPhi))
+                    throw NumericalProblem("Non-finite potential difference for phase '"
+                                           + std::string(FluidSystem::phaseName(phaseIdx))+"'");
+
+                const bool interiorIsUpstream = !(dPhi*direction > 0.0);
+                const Scalar mobRho = interiorIsUpstream
+                    ? mobIn.value()*rhoIn.value()
+                    : intQuantsEx.mobility(phaseIdx).value()*fsEx.density(phaseIdx).value();
+
+                const unsigned eqIdx = conti0EqIdx + phaseIdx;
+                this->residual_[0][eqIdx] += -trans*mobRho*dPhi*scaleIn;
+
+                for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+                    const Scalar dPhiDeriv = -pIn.derivative(pvIdx) + rhoIn.derivative(pvIdx)*hIn;
+                    const Scalar mobRhoDeriv = interiorIsUpstream
+                        ? mobIn.derivative(pvIdx)*rhoIn.value() + mobIn.value()*rhoIn.derivative(pvIdx)
+                        : 0.0;
+                    const Scalar massFluxDeriv = -trans*(mobRhoDeriv*dPhi + mobRho*dPhiDeriv);
+
+                    // the flux leaves the element and enters the neighbor
+                    this->jacobian_[0][0][eqIdx][pvIdx] += massFluxDeriv*scaleIn;
+                    this->jacobian_[j][0][eqIdx][pvIdx] -= massFluxDeriv*scaleEx;
+                }
+            }
+        }
+    }
+
+    // the factor which makes the residual of a degree of freedom volume specific, see
+    // FvBaseLocalResidual::makeVolumeSpecific_()
+    static Scalar residualScale_(const ElementContext& elemCtx, unsigned dofIdx)
+    {
+        if (!useVolumetricResidual)
+            return 1.0;
+
+        const Scalar dofVolume = elemCtx.dofTotalVolume(dofIdx, /*timeIdx=*/0);
+        return (dofVolume > 0.0) ? 1.0/dofVolume : 1.0;
+    }
+
+    LocalEvalBlockVector volumeTerms_;
+};
+
+} // namespace Opm
+
+#endif
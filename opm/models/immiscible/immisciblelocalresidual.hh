@@ -64,6 +64,10 @@ class ImmiscibleLocalResidual : public GetPropType<TypeTag, Properties::DiscLoca
     using Toolbox = Opm::MathToolbox<Evaluation>;
 
 public:
+    //! Specifies whether addTpfaAdvectiveFlux() describes all fluxes of the model,
+    //! i.e., whether EcfvTpfaLinearizer can be used. Thermal conduction is not covered.
+    static constexpr bool tpfaFluxSupported = !enableEnergy;
+
     /*!
      * \brief Adds the amount all conservation quantities (e.g. phase
      *        mass) within a single fluid phase
@@ -81,7 +85,21 @@ public:
     {
         // retrieve the intensive quantities for the SCV at the specified
         // point in time
-        const IntensiveQuantities& intQuants = elemCtx.intensiveQuantities(dofIdx, timeIdx);
+        addPhaseStorage(storage, elemCtx.intensiveQuantities(dofIdx, timeIdx), phaseIdx);
+    }
+
+    /*!
+     * \brief Adds the amount all conservation quantities within a single fluid phase
+     *        for given intensive quantities.
+     *
+     * This variant does not need an element context and is used by
+     * EcfvTpfaLinearizer.
+     */
+    template <class LhsEval>
+    static void addPhaseStorage(Dune::FieldVector<LhsEval, numEq>& storage,
+                                const IntensiveQuantities& intQuants,
+                                unsigned phaseIdx)
+    {
         const auto& fs = intQuants.fluidState();
 
         storage[conti0EqIdx + phaseIdx] =
@@ -108,6 +126,24 @@ public:
         EnergyModule::addSolidEnergyStorage(storage, elemCtx.intensiveQuantities(dofIdx, timeIdx));
     }
 
+    /*!
+     * \brief Evaluate the amount of all conservation quantities per unit volume for
+     *        given intensive quantities.
+     *
+     * This variant does not need an element context and is used by
+     * EcfvTpfaLinearizer.
+     */
+    template <class LhsEval>
+    static void computeStorage(Dune::FieldVector<LhsEval, numEq>& storage,
+                               const IntensiveQuantities& intQuants)
+    {
+        storage = 0.0;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            addPhaseStorage(storage, intQuants, phaseIdx);
+
+        EnergyModule::addSolidEnergyStorage(storage, intQuants);
+    }
+
     /*!
      * \copydoc FvBaseLocalResidual::computeFlux
      */
@@ -154,6 +190,37 @@ public:
         EnergyModule::addAdvectiveFlux(flux, elemCtx, scvfIdx, timeIdx);
     }
 
+    /*!
+     * \brief Add the advective mass fluxes over a face of the two-point flux
+     *        approximation for given volume fluxes of the phases.
+     *
+     * This variant does not need an element context and is used by
+     * EcfvTpfaLinearizer. Only the quantities of the interior cell carry
+     * derivatives.
+     *
+     * \param flux The vector to which the mass fluxes are added
+     * \param intQuantsIn The intensive quantities of the interior cell
+     * \param intQuantsEx The intensive quantities of the exterior cell
+     * \param phaseFluxes Provides the volume fluxes of the phases over the face via
+     *                    volumeFlux(phaseIdx) and their upstream direction via
+     *                    interiorIsUpstream(phaseIdx)
+     */
+    template <class PhaseFluxes>
+    static void addTpfaAdvectiveFlux(RateVector& flux,
+                                     const IntensiveQuantities& intQuantsIn,
+                                     const IntensiveQuantities& intQuantsEx,
+                                     const PhaseFluxes& phaseFluxes)
+    {
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            const Evaluation& volumeFlux = phaseFluxes.volumeFlux(phaseIdx);
+            if (phaseFluxes.interiorIsUpstream(phaseIdx))
+                flux[conti0EqIdx + phaseIdx] += volumeFlux*intQuantsIn.fluidState().density(phaseIdx);
+            else
+                flux[conti0EqIdx + phaseIdx] +=
+                    volumeFlux*Toolbox::value(intQuantsEx.fluidState().density(phaseIdx));
+        }
+    }
+
     /*!
      * \brief Adds the diffusive flux at a given flux integration point.
      *
@@ -144,6 +144,19 @@ public:
     virtual bool needExtensiveQuantities() const
     { return false; }
 
+    /*!
+     * \brief Returns true iff processElement() may be called concurrently for
+     *        different elements.
+     *
+     * This is the case if the module only assigns the entries of its buffers which
+     * belong to the primary degrees of freedom of the element. Modules which
+     * accumulate quantities, e.g., over the faces of the elements, must return false.
+     * The elements are then still processed by multiple threads, but the calls of
+     * processElement() of the module are serialized.
+     */
+    virtual bool processElementIsThreadSafe() const
+    { return true; }
+
 protected:
     enum BufferType {
         //! Buffer contains data associated with the degrees of freedom
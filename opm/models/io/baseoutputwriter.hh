@@ -37,8 +37,8 @@ namespace Opm {
 /*!
  * \brief The base class for all output writers.
  *
- * The sole purpose of this class is to enable RTTI
- * (i.e. dynamic_cast) on writer objects.
+ * The output modules attach their fields to the writers via this interface, i.e.,
+ * they do not need to know the file format which is written.
  */
 class BaseOutputWriter
 {
@@ -31,13 +31,21 @@
 #include <opm/models/utils/parametersystem.hh>
 
 #include <dune/common/version.hh>
+#include <dune/grid/common/gridenums.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/grid/common/rangegenerators.hh>
 
 #if HAVE_DUNE_FEM
 #include <dune/fem/space/common/dofmanager.hh>
 #endif
 
-#include <type_traits>
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <set>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace Opm {
 
@@ -100,13 +108,72 @@ public:
     }
 
 
+    /*!
+     * \brief Returns the relative computational cost of each element of the grid.
+     *
+     * The weights are indexed by the index of the elements in the leaf grid view of
+     * the process which owns them before the grid is distributed, and they are passed
+     * to the partitioner by loadBalance(). A weight of 1 corresponds to a regular
+     * element. Vanguards can override this method, e.g., to assign larger weights to
+     * the cells of wells or to use the costs measured in a previous run. An empty
+     * vector, which is the default, means that all elements are equally expensive.
+     */
+    std::vector<double> cellWeights() const
+    { return {}; }
+
+    /*!
+     * \brief Returns the indices of all elements of the grid view with the interior
+     *        elements first.
+     *
+     * The first numInteriorElements() entries are the elements of the interior
+     * partition, which are owned by the local process, and the remaining ones are the
+     * overlap and ghost elements, whose values are received from other processes. This
+     * allows to process the interior elements while the exchange with the other
+     * processes is still in flight. Within both groups, the elements are sorted by
+     * their indices, which are the ones of an element mapper of the grid view. The
+     * order is determined once for each grid.
+     */
+    const std::vector<unsigned>& interiorFirstElementOrder() const
+    {
+        if (interiorFirstElementOrder_.empty())
+            updateInteriorFirstElementOrder_();
+        return interiorFirstElementOrder_;
+    }
+
+    /*!
+     * \brief Returns the number of elements of the interior partition.
+     *
+     * \copydetails interiorFirstElementOrder()
+     */
+    unsigned numInteriorElements() const
+    {
+        if (interiorFirstElementOrder_.empty())
+            updateInteriorFirstElementOrder_();
+        return numInteriorElements_;
+    }
+
     /*!
      * \brief Distribute the grid (and attached data) over all
      *        processes.
+     *
+     * If the vanguard provides cell weights (see cellWeights()) and the grid supports
+     * a weighted repartitioning, the weights are passed to the partitioner of the
+     * grid. Otherwise, the default load balancing of the grid is used.
      */
     void loadBalance()
     {
-        asImp_().grid().loadBalance();
+        auto& grid = asImp_().grid();
+        if constexpr (supportsWeightedRepartition_()) {
+            const std::vector<double> weights = asImp_().cellWeights();
+            if (grid.comm().max(static_cast<int>(!weights.empty()))) {
+                WeightedLoadBalanceHandle_ handle(grid, weights);
+                grid.repartition(handle);
+                updateGridView_();
+                return;
+            }
+        }
+
+        grid.loadBalance();
         updateGridView_();
     }
 
@@ -131,9 +198,88 @@ protected:
         {
             gridView_ = std::make_unique<GridView>(asImp_().grid().leafGridView());
         }
+
+        interiorFirstElementOrder_.clear();
+        numInteriorElements_ = 0;
     }
 
 private:
+    // passes the cell weights to the partitioner of the grid. This implements the
+    // interface of the load balancing handles of ALUGrid. The partitioner expects
+    // integral weights, so the relative weights are scaled.
+    class WeightedLoadBalanceHandle_
+    {
+        using Element = typename Grid::template Codim<0>::Entity;
+        static constexpr double weightScale = 100.0;
+
+    public:
+        WeightedLoadBalanceHandle_(const Grid& grid, const std::vector<double>& weights)
+            : indexSet_(grid.leafGridView().indexSet())
+            , weights_(weights)
+        {}
+
+        bool userDefinedPartitioning() const
+        { return false; }
+
+        bool userDefinedLoadWeights() const
+        { return true; }
+
+        bool repartition() const
+        { return true; }
+
+        int loadWeight(const Element& elem) const
+        {
+            const auto elemIdx = indexSet_.index(elem);
+            if (elemIdx >= weights_.size())
+                return static_cast<int>(weightScale);
+            return std::max(1, static_cast<int>(std::lround(weights_[elemIdx]*weightScale)));
+        }
+
+        int destination(const Element&) const
+        { return -1; }
+
+        bool importRanks(std::set<int>&) const
+        { return false; }
+
+    private:
+        const typename Grid::LeafGridView::IndexSet& indexSet_;
+        const std::vector<double>& weights_;
+    };
+
+    template <class GridType>
+    static auto detectWeightedRepartition_(int)
+        -> decltype(std::declval<GridType&>().repartition(std::declval<WeightedLoadBalanceHandle_&>()),
+                    std::true_type{});
+
+    template <class GridType>
+    static std::false_type detectWeightedRepartition_(long);
+
+    static constexpr bool supportsWeightedRepartition_()
+    { return decltype(detectWeightedRepartition_<Grid>(0))::value; }
+
+    void updateInteriorFirstElementOrder_() const
+    {
+        using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+        const ElementMapper elementMapper(gridView(), Dune::mcmgElementLayout());
+
+        std::vector<unsigned> nonInterior;
+        interiorFirstElementOrder_.clear();
+        interiorFirstElementOrder_.reserve(elementMapper.size());
+        for (const auto& elem : elements(gridView())) {
+            const auto elemIdx = static_cast<unsigned>(elementMapper.index(elem));
+            if (elem.partitionType() == Dune::InteriorEntity)
+                interiorFirstElementOrder_.push_back(elemIdx);
+            else
+                nonInterior.push_back(elemIdx);
+        }
+
+        std::sort(interiorFirstElementOrder_.begin(), interiorFirstElementOrder_.end());
+        std::sort(nonInterior.begin(), nonInterior.end());
+        numInteriorElements_ = static_cast<unsigned>(interiorFirstElementOrder_.size());
+        interiorFirstElementOrder_.insert(interiorFirstElementOrder_.end(),
+                                          nonInterior.begin(), nonInterior.end());
+    }
+
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
 
@@ -145,6 +291,8 @@ private:
     std::unique_ptr<GridPart> gridPart_;
 #endif
     std::unique_ptr<GridView> gridView_;
+    mutable std::vector<unsigned> interiorFirstElementOrder_;
+    mutable unsigned numInteriorElements_ = 0;
 };
 
 } // namespace Opm
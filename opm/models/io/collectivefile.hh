@@ -0,0 +1,337 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::CollectiveFile
+ */
+#ifndef EWOMS_COLLECTIVE_FILE_HH
+#define EWOMS_COLLECTIVE_FILE_HH
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief A file which is shared by all processes of a communicator.
+ *
+ * If the module is compiled with MPI support, the file is accessed using MPI-IO,
+ * otherwise it is a plain file of the only process. The methods which are marked as
+ * collective must be called by all processes with consistent arguments, the others
+ * may be called by individual processes.
+ */
+class CollectiveFile
+{
+    // the maximum number of bytes which are transferred by a single MPI call
+    static constexpr std::size_t maxChunkSize_ = std::size_t(1) << 30;
+
+public:
+#if HAVE_MPI
+    using Communicator = MPI_Comm;
+#else
+    using Communicator = int;
+#endif
+
+    CollectiveFile() = default;
+    CollectiveFile(const CollectiveFile&) = delete;
+    CollectiveFile& operator=(const CollectiveFile&) = delete;
+
+    ~CollectiveFile()
+    {
+        try {
+            close();
+        }
+        catch (...) {
+        }
+    }
+
+    /*!
+     * \brief Open the file for reading or writing (collective).
+     *
+     * If the file is opened for writing, it is truncated.
+     */
+    void open(const std::string& fileName, bool write, Communicator comm)
+    {
+        close();
+        fileName_ = fileName;
+        write_ = write;
+#if HAVE_MPI
+        comm_ = comm;
+        MPI_Comm_rank(comm_, &rank_);
+        MPI_Comm_size(comm_, &size_);
+
+        if (write) {
+            // make sure that no stale data remains at the end of the file
+            if (rank_ == 0)
+                MPI_File_delete(fileName.c_str(), MPI_INFO_NULL);
+            MPI_Barrier(comm_);
+        }
+
+        const int mode = write ? (MPI_MODE_CREATE | MPI_MODE_WRONLY) : MPI_MODE_RDONLY;
+        int ret = MPI_File_open(comm_, fileName.c_str(), mode, MPI_INFO_NULL, &file_);
+        int failed = (ret != MPI_SUCCESS) ? 1 : 0;
+        MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MAX, comm_);
+        if (failed) {
+            if (ret == MPI_SUCCESS)
+                MPI_File_close(&file_);
+            throw std::runtime_error("File '" + fileName + "' could not be opened properly");
+        }
+        isOpen_ = true;
+#else
+        static_cast<void>(comm);
+        if (write)
+            stream_.open(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        else
+            stream_.open(fileName.c_str(), std::ios::in | std::ios::binary);
+        if (!stream_.good())
+            throw std::runtime_error("File '" + fileName + "' could not be opened properly");
+        isOpen_ = true;
+#endif
+    }
+
+    /*!
+     * \brief Close the file (collective).
+     */
+    void close()
+    {
+        if (!isOpen_)
+            return;
+
+        isOpen_ = false;
+#if HAVE_MPI
+        MPI_File_close(&file_);
+#else
+        const bool good = stream_.good();
+        stream_.close();
+        if (write_ && !good)
+            throw std::runtime_error("Could not write file '" + fileName_ + "'");
+#endif
+    }
+
+    int rank() const
+    { return rank_; }
+
+    int size() const
+    { return size_; }
+
+    /*!
+     * \brief Returns the size of the file in bytes.
+     */
+    std::uint64_t fileSize()
+    {
+#if HAVE_MPI
+        MPI_Offset size;
+        MPI_File_get_size(file_, &size);
+        return static_cast<std::uint64_t>(size);
+#else
+        stream_.seekg(0, std::ios::end);
+        return static_cast<std::uint64_t>(stream_.tellg());
+#endif
+    }
+
+    /*!
+     * \brief Write a contiguous range of bytes at a given position.
+     */
+    void writeAt(std::uint64_t offset, const void* data, std::size_t numBytes)
+    {
+        const char* bytes = static_cast<const char*>(data);
+        for (std::size_t pos = 0; pos < numBytes; pos += maxChunkSize_) {
+            const std::size_t n = std::min(maxChunkSize_, numBytes - pos);
+#if HAVE_MPI
+            check_(MPI_File_write_at(file_, static_cast<MPI_Offset>(offset + pos), bytes + pos,
+                                     static_cast<int>(n), MPI_BYTE, MPI_STATUS_IGNORE),
+                   "write");
+#else
+            stream_.seekp(static_cast<std::streamoff>(offset + pos));
+            stream_.write(bytes + pos, static_cast<std::streamsize>(n));
+#endif
+        }
+    }
+
+    /*!
+     * \brief Read a contiguous range of bytes from a given position.
+     */
+    void readAt(std::uint64_t offset, void* data, std::size_t numBytes)
+    {
+        char* bytes = static_cast<char*>(data);
+        for (std::size_t pos = 0; pos < numBytes; pos += maxChunkSize_) {
+            const std::size_t n = std::min(maxChunkSize_, numBytes - pos);
+#if HAVE_MPI
+            check_(MPI_File_read_at(file_, static_cast<MPI_Offset>(offset + pos), bytes + pos,
+                                    static_cast<int>(n), MPI_BYTE, MPI_STATUS_IGNORE),
+                   "read");
+#else
+            stream_.seekg(static_cast<std::streamoff>(offset + pos));
+            stream_.read(bytes + pos, static_cast<std::streamsize>(n));
+            if (stream_.gcount() != static_cast<std::streamsize>(n))
+                throw std::runtime_error("Could not read file '" + fileName_ + "'");
+#endif
+        }
+    }
+
+    /*!
+     * \brief Write a contiguous range of fixed-size records (collective).
+     *
+     * \param offset The position of the first record of the calling process in the file
+     */
+    void writeRecordsAll(std::uint64_t offset, const void* data,
+                         std::size_t numRecords, std::size_t recordSize)
+    {
+#if HAVE_MPI
+        MPI_Datatype recordType = recordType_(recordSize);
+        check_(MPI_File_write_at_all(file_, static_cast<MPI_Offset>(offset), data,
+                                     static_cast<int>(numRecords), recordType, MPI_STATUS_IGNORE),
+               "write");
+        MPI_Type_free(&recordType);
+#else
+        writeAt(offset, data, numRecords*recordSize);
+#endif
+    }
+
+    /*!
+     * \brief Read a set of fixed-size records (collective).
+     *
+     * \param offset The position of the first record in the file
+     * \param recordIndices The indices of the records which are read by the calling
+     *                      process in ascending order
+     * \param data The buffer for the records in the order of the indices
+     */
+    void readRecordsAll(std::uint64_t offset, const std::vector<int>& recordIndices,
+                        std::size_t recordSize, void* data)
+    {
+#if HAVE_MPI
+        MPI_Datatype recordType = recordType_(recordSize);
+        MPI_Datatype fileType;
+        const int numRecords = static_cast<int>(recordIndices.size());
+        MPI_Type_create_indexed_block(numRecords, 1, numRecords > 0 ? recordIndices.data() : nullptr,
+                                      recordType, &fileType);
+        MPI_Type_commit(&fileType);
+
+        check_(MPI_File_set_view(file_, static_cast<MPI_Offset>(offset), recordType, fileType,
+                                 "native", MPI_INFO_NULL),
+               "read");
+        check_(MPI_File_read_all(file_, data, numRecords, recordType, MPI_STATUS_IGNORE), "read");
+        check_(MPI_File_set_view(file_, 0, MPI_BYTE, MPI_BYTE, "native", MPI_INFO_NULL), "read");
+
+        MPI_Type_free(&fileType);
+        MPI_Type_free(&recordType);
+#else
+        char* bytes = static_cast<char*>(data);
+        for (std::size_t i = 0; i < recordIndices.size(); ++i)
+            readAt(offset + static_cast<std::uint64_t>(recordIndices[i])*recordSize,
+                   bytes + i*recordSize, recordSize);
+#endif
+    }
+
+    /*!
+     * \brief Send a range of bytes from one process to all others (collective).
+     */
+    void broadcast(void* data, std::size_t numBytes, int root = 0) const
+    {
+#if HAVE_MPI
+        char* bytes = static_cast<char*>(data);
+        for (std::size_t pos = 0; pos < numBytes; pos += maxChunkSize_) {
+            const std::size_t n = std::min(maxChunkSize_, numBytes - pos);
+            MPI_Bcast(bytes + pos, static_cast<int>(n), MPI_BYTE, root, comm_);
+        }
+#else
+        static_cast<void>(data);
+        static_cast<void>(numBytes);
+        static_cast<void>(root);
+#endif
+    }
+
+    /*!
+     * \brief Returns the sum of a value over all processes with a smaller rank
+     *        (collective).
+     *
+     * \param total Set to the sum over all processes
+     */
+    std::uint64_t exclusiveSum(std::uint64_t value, std::uint64_t& total) const
+    {
+        std::vector<std::uint64_t> values(static_cast<std::size_t>(size_), value);
+#if HAVE_MPI
+        MPI_Allgather(&value, 1, MPI_UINT64_T, values.data(), 1, MPI_UINT64_T, comm_);
+#endif
+        std::uint64_t result = 0;
+        total = 0;
+        for (int r = 0; r < size_; ++r) {
+            if (r < rank_)
+                result += values[static_cast<std::size_t>(r)];
+            total += values[static_cast<std::size_t>(r)];
+        }
+        return result;
+    }
+
+    /*!
+     * \brief Returns the maximum of a value over all processes (collective).
+     */
+    std::uint64_t max(std::uint64_t value) const
+    {
+#if HAVE_MPI
+        MPI_Allreduce(MPI_IN_PLACE, &value, 1, MPI_UINT64_T, MPI_MAX, comm_);
+#endif
+        return value;
+    }
+
+private:
+#if HAVE_MPI
+    static MPI_Datatype recordType_(std::size_t recordSize)
+    {
+        MPI_Datatype type;
+        MPI_Type_contiguous(static_cast<int>(recordSize), MPI_BYTE, &type);
+        MPI_Type_commit(&type);
+        return type;
+    }
+
+    void check_(int ret, const char* what) const
+    {
+        if (ret != MPI_SUCCESS)
+            throw std::runtime_error(std::string("Could not ") + what + " file '" + fileName_ + "'");
+    }
+
+    MPI_Comm comm_ = MPI_COMM_SELF;
+    MPI_File file_;
+#else
+    std::fstream stream_;
+#endif
+
+    std::string fileName_;
+    bool write_ = false;
+    bool isOpen_ = false;
+    int rank_ = 0;
+    int size_ = 1;
+};
+
+} // namespace Opm
+
+#endif
@@ -34,6 +34,11 @@
 
 #include <dune/grid/utility/structuredgridfactory.hh>
 
+#if HAVE_DUNE_ALUGRID
+// the structured grid factory of ALUGrid creates each process' partition directly
+#include <dune/alugrid/common/structuredgridfactory.hh>
+#endif
+
 #include <dune/common/fvector.hh>
 
 #include <memory>
@@ -0,0 +1,742 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::Hdf5MultiWriter
+ */
+#ifndef EWOMS_HDF5_MULTI_WRITER_HH
+#define EWOMS_HDF5_MULTI_WRITER_HH
+
+#if HAVE_HDF5
+
+#include <opm/models/io/baseoutputwriter.hh>
+#include <opm/models/utils/regionprofiler.hh>
+
+#include <dune/common/version.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/grid/common/rangegenerators.hh>
+#include <dune/grid/io/file/vtk/common.hh>
+
+#include <hdf5.h>
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Writes the output of a simulation to HDF5 files which are described by an
+ *        XDMF file.
+ *
+ * In contrast to the VTK output, all processes write into the same file: The points,
+ * the cells and the fields of each process are stored as contiguous slices of global
+ * datasets, i.e., the number of files does not depend on the number of processes. If
+ * the HDF5 library has been compiled with support for MPI, the slices are written
+ * using collective MPI-IO, otherwise the processes write their slices one after the
+ * other.
+ *
+ * Either a separate file is written for each time step ("$SIMNAME-$STEP.h5"), or all
+ * time steps are appended to a single file ("$SIMNAME.h5"). In both cases, the file
+ * "$SIMNAME.xmf" describes the whole time series and can be loaded by e.g. ParaView or
+ * VisIt. Like for VtkMultiWriter, this file is kept in a valid state after each time
+ * step, so that the results can be inspected while the simulation is running.
+ *
+ * The points are not shared between processes, i.e., the vertices at the borders of
+ * the subdomains appear once for each process which writes an adjacent cell. Vectors
+ * with less than three components are padded with zeros, and so are tensors with less
+ * than three rows or columns.
+ */
+template <class GridView>
+class Hdf5MultiWriter : public BaseOutputWriter
+{
+    enum { dim = GridView::dimension };
+    enum { dimWorld = GridView::dimensionworld };
+
+    using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using Comm = std::decay_t<decltype(std::declval<const GridView&>().comm())>;
+
+#if HAVE_MPI && defined(H5_HAVE_PARALLEL)
+    static constexpr bool parallelHdf5 = std::is_convertible_v<Comm, MPI_Comm>;
+#else
+    static constexpr bool parallelHdf5 = false;
+#endif
+
+public:
+    using Scalar = BaseOutputWriter::Scalar;
+    using Vector = BaseOutputWriter::Vector;
+    using Tensor = BaseOutputWriter::Tensor;
+    using ScalarBuffer = BaseOutputWriter::ScalarBuffer;
+    using VectorBuffer = BaseOutputWriter::VectorBuffer;
+    using TensorBuffer = BaseOutputWriter::TensorBuffer;
+
+    /*!
+     * \brief Create a writer.
+     *
+     * \param singleFile If true, all time steps are written into the same HDF5 file
+     */
+    Hdf5MultiWriter(const GridView& gridView,
+                    const std::string& outputDir,
+                    const std::string& simName = "",
+                    bool singleFile = false)
+        : gridView_(gridView)
+        , elementMapper_(gridView, Dune::mcmgElementLayout())
+        , vertexMapper_(gridView, Dune::mcmgVertexLayout())
+        , singleFile_(singleFile)
+    {
+        outputDir_ = outputDir.empty() ? "." : outputDir;
+        simName_ = simName.empty() ? "sim" : simName;
+
+        commRank_ = gridView.comm().rank();
+        commSize_ = gridView.comm().size();
+    }
+
+    /*!
+     * \brief Update the internal data structures after the grid was changed.
+     *
+     * If the grid changes between two calls of beginWrite(), this method _must_ be
+     * called before the second beginWrite()!
+     */
+    void gridChanged()
+    {
+        geometryValid_ = false;
+
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2, 8)
+        elementMapper_.update(gridView_);
+        vertexMapper_.update(gridView_);
+#else
+        elementMapper_.update();
+        vertexMapper_.update();
+#endif
+    }
+
+    /*!
+     * \brief Called whenever a new time step must be written.
+     */
+    void beginWrite(double t)
+    {
+        curTime_ = t;
+        fields_.clear();
+        updateGeometry_();
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachScalarVertexData
+     */
+    void attachScalarVertexData(ScalarBuffer& buf, std::string name)
+    {
+        Field& field = addField_(name, "Scalar", "Node", /*numComponents=*/1, numPoints_);
+        for (std::size_t vertexIdx = 0; vertexIdx < pointIndex_.size(); ++vertexIdx)
+            if (pointIndex_[vertexIdx] >= 0)
+                field.values[static_cast<std::size_t>(pointIndex_[vertexIdx])] = buf[vertexIdx];
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachScalarElementData
+     */
+    void attachScalarElementData(ScalarBuffer& buf, std::string name)
+    {
+        Field& field = addField_(name, "Scalar", "Cell", /*numComponents=*/1, numCells_);
+        for (std::size_t cellIdx = 0; cellIdx < cellElementIndex_.size(); ++cellIdx)
+            field.values[cellIdx] = buf[cellElementIndex_[cellIdx]];
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachVectorVertexData
+     */
+    void attachVectorVertexData(VectorBuffer& buf, std::string name)
+    {
+        const std::size_t numComps = numVectorComponents_(buf);
+        Field& field = addField_(name, numComps == 3 ? "Vector" : "Matrix", "Node", numComps, numPoints_);
+        for (std::size_t vertexIdx = 0; vertexIdx < pointIndex_.size(); ++vertexIdx)
+            if (pointIndex_[vertexIdx] >= 0)
+                copyVector_(field, static_cast<std::size_t>(pointIndex_[vertexIdx]), buf[vertexIdx]);
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachVectorElementData
+     */
+    void attachVectorElementData(VectorBuffer& buf, std::string name)
+    {
+        const std::size_t numComps = numVectorComponents_(buf);
+        Field& field = addField_(name, numComps == 3 ? "Vector" : "Matrix", "Cell", numComps, numCells_);
+        for (std::size_t cellIdx = 0; cellIdx < cellElementIndex_.size(); ++cellIdx)
+            copyVector_(field, cellIdx, buf[cellElementIndex_[cellIdx]]);
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachTensorVertexData
+     */
+    void attachTensorVertexData(TensorBuffer& buf, std::string name)
+    {
+        std::size_t numCols;
+        const std::size_t numComps = numTensorComponents_(buf, numCols);
+        Field& field = addField_(name, numComps == 9 ? "Tensor" : "Matrix", "Node", numComps, numPoints_);
+        for (std::size_t vertexIdx = 0; vertexIdx < pointIndex_.size(); ++vertexIdx)
+            if (pointIndex_[vertexIdx] >= 0)
+                copyTensor_(field, static_cast<std::size_t>(pointIndex_[vertexIdx]), numCols, buf[vertexIdx]);
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachTensorElementData
+     */
+    void attachTensorElementData(TensorBuffer& buf, std::string name)
+    {
+        std::size_t numCols;
+        const std::size_t numComps = numTensorComponents_(buf, numCols);
+        Field& field = addField_(name, numComps == 9 ? "Tensor" : "Matrix", "Cell", numComps, numCells_);
+        for (std::size_t cellIdx = 0; cellIdx < cellElementIndex_.size(); ++cellIdx)
+            copyTensor_(field, cellIdx, numCols, buf[cellElementIndex_[cellIdx]]);
+    }
+
+    /*!
+     * \brief Finalizes the current time step.
+     *
+     * This means that the attached fields are written to disk, except if the
+     * onlyDiscard argument is true.
+     */
+    void endWrite(bool onlyDiscard = false)
+    {
+        EWOMS_PROFILE_REGION("HDF5 output");
+
+        if (!onlyDiscard) {
+            std::vector<Dataset> datasets;
+            const std::string gridGroup = gridGroup_();
+            const bool writeGeometry = !singleFile_ || geometryGroup_.empty();
+            if (writeGeometry) {
+                datasets.push_back(makeDataset_(gridGroup + "/points", H5T_NATIVE_DOUBLE,
+                                                points_.data(), numPoints_, 3, pointOffset_, globalNumPoints_));
+                datasets.push_back(makeDataset_(gridGroup + "/topology", H5T_NATIVE_INT64,
+                                                topology_.data(), topology_.size(), 1,
+                                                topologyOffset_, globalTopologySize_));
+            }
+            for (const auto& field : fields_) {
+                const std::size_t numLocal = field.center == "Cell" ? numCells_ : numPoints_;
+                datasets.push_back(makeDataset_(fieldGroup_() + "/" + field.datasetName,
+                                                H5T_NATIVE_DOUBLE, field.values.data(),
+                                                numLocal, field.numComponents,
+                                                field.center == "Cell" ? cellOffset_ : pointOffset_,
+                                                field.center == "Cell" ? globalNumCells_ : globalNumPoints_));
+            }
+
+            std::vector<std::string> groups;
+            if (writeGeometry)
+                groups.push_back(gridGroup);
+            if (fieldGroup_() != gridGroup)
+                groups.push_back(fieldGroup_());
+
+            writeFile_(groups, datasets);
+            if (writeGeometry)
+                geometryGroup_ = gridGroup;
+            fileStarted_ = true;
+
+            entries_.push_back(xdmfEntry_());
+            writeXdmfFile_();
+            ++curWriterNum_;
+        }
+
+        fields_.clear();
+    }
+
+    /*!
+     * \brief Write the multi-writer's state to a restart file.
+     */
+    template <class Restarter>
+    void serialize(Restarter& res)
+    {
+        res.serializeSectionBegin("Hdf5MultiWriter");
+        res.serializeStream() << curWriterNum_ << " " << entries_.size() << "\n";
+        for (const auto& entry : entries_)
+            res.serializeStream() << entry.size() << "\n" << entry;
+        res.serializeSectionEnd();
+    }
+
+    /*!
+     * \brief Read the multi-writer's state from a restart file.
+     */
+    template <class Restarter>
+    void deserialize(Restarter& res)
+    {
+        res.deserializeSectionBegin("Hdf5MultiWriter");
+        std::size_t numEntries;
+        res.deserializeStream() >> curWriterNum_ >> numEntries;
+        entries_.resize(numEntries);
+        for (auto& entry : entries_) {
+            std::size_t size;
+            res.deserializeStream() >> size;
+            res.deserializeStream().ignore(1);
+            entry.resize(size);
+            res.deserializeStream().read(&entry[0], static_cast<std::streamsize>(size));
+        }
+        res.deserializeSectionEnd();
+
+        // the existing single file is continued, but the geometry must be written
+        // again because it might have been written after the restart file
+        fileStarted_ = true;
+        geometryGroup_.clear();
+        writeXdmfFile_();
+    }
+
+private:
+    struct Field
+    {
+        std::string name;
+        std::string datasetName;
+        std::string attributeType;
+        std::string center;
+        std::size_t numComponents;
+        std::vector<double> values;
+    };
+
+    // a slice of a global dataset which is written by the local process
+    struct Dataset
+    {
+        std::string path;
+        hid_t type;
+        const void* data;
+        hsize_t numLocalRows;
+        hsize_t numComponents;
+        hsize_t rowOffset;
+        hsize_t numGlobalRows;
+    };
+
+    static Dataset makeDataset_(const std::string& path, hid_t type, const void* data,
+                                std::size_t numLocalRows, std::size_t numComponents,
+                                std::size_t rowOffset, std::size_t numGlobalRows)
+    {
+        return Dataset{path, type, data,
+                       static_cast<hsize_t>(numLocalRows),
+                       static_cast<hsize_t>(numComponents),
+                       static_cast<hsize_t>(rowOffset),
+                       static_cast<hsize_t>(numGlobalRows)};
+    }
+
+    // the XDMF cell types of the Dune geometry types
+    static int xdmfCellType_(const Dune::GeometryType& type)
+    {
+        if (type.isLine())
+            return 2; // polyline
+        if (type.isTriangle())
+            return 4;
+        if (type.isQuadrilateral())
+            return 5;
+        if (type.isTetrahedron())
+            return 6;
+        if (type.isPyramid())
+            return 7;
+        if (type.isPrism())
+            return 8;
+        if (type.isHexahedron())
+            return 9;
+        throw std::invalid_argument("The HDF5 output does not support the cells of the grid");
+    }
+
+    static std::string escapeXml_(const std::string& s)
+    {
+        std::string result;
+        for (char c : s) {
+            switch (c) {
+            case '&': result += "&amp;"; break;
+            case '<': result += "&lt;"; break;
+            case '>': result += "&gt;"; break;
+            case '"': result += "&quot;"; break;
+            default: result += c;
+            }
+        }
+        return result;
+    }
+
+    static void check_(long long ret, const std::string& what)
+    {
+        if (ret < 0)
+            throw std::runtime_error(std::string("HDF5 output: Could not ") + what);
+    }
+
+    // compute the point and cell arrays of the local process and their position in
+    // the global datasets
+    void updateGeometry_()
+    {
+        if (geometryValid_)
+            return;
+
+        pointIndex_.assign(vertexMapper_.size(), -1);
+        cellElementIndex_.clear();
+        points_.clear();
+        topology_.clear();
+
+        // the positions of the point indices in the topology array
+        std::vector<std::size_t> connectivityPos;
+
+        numPoints_ = 0;
+        for (const auto& elem : elements(gridView_, Dune::Partitions::interior)) {
+            const auto type = elem.type();
+            const auto& geometry = elem.geometry();
+            const int numCorners = geometry.corners();
+
+            cellElementIndex_.push_back(static_cast<std::size_t>(elementMapper_.index(elem)));
+            topology_.push_back(xdmfCellType_(type));
+            if (type.isLine())
+                topology_.push_back(numCorners);
+
+            // XDMF uses the same numbering of the corners as VTK
+            for (int vtkCornerIdx = 0; vtkCornerIdx < numCorners; ++vtkCornerIdx) {
+                const int cornerIdx = Dune::VTK::renumber(type, vtkCornerIdx);
+                const auto vertexIdx = vertexMapper_.subIndex(elem, cornerIdx, /*codim=*/dim);
+                auto& pointIdx = pointIndex_[vertexIdx];
+                if (pointIdx < 0) {
+                    pointIdx = static_cast<std::int64_t>(numPoints_++);
+                    const auto& pos = geometry.corner(cornerIdx);
+                    for (int i = 0; i < 3; ++i)
+                        points_.push_back(i < dimWorld ? static_cast<double>(pos[i]) : 0.0);
+                }
+                connectivityPos.push_back(topology_.size());
+                topology_.push_back(pointIdx);
+            }
+        }
+        numCells_ = cellElementIndex_.size();
+
+        // determine the slices of the local process
+        unsigned long localSizes[3] = { static_cast<unsigned long>(numCells_),
+                                        static_cast<unsigned long>(numPoints_),
+                                        static_cast<unsigned long>(topology_.size()) };
+        std::vector<unsigned long> allSizes(3*static_cast<std::size_t>(commSize_));
+        gridView_.comm().allgather(localSizes, 3, allSizes.data());
+
+        cellOffset_ = pointOffset_ = topologyOffset_ = 0;
+        globalNumCells_ = globalNumPoints_ = globalTopologySize_ = 0;
+        for (int rank = 0; rank < commSize_; ++rank) {
+            if (rank < commRank_) {
+                cellOffset_ += allSizes[3*rank + 0];
+                pointOffset_ += allSizes[3*rank + 1];
+                topologyOffset_ += allSizes[3*rank + 2];
+            }
+            globalNumCells_ += allSizes[3*rank + 0];
+            globalNumPoints_ += allSizes[3*rank + 1];
+            globalTopologySize_ += allSizes[3*rank + 2];
+        }
+
+        // the connectivity refers to the global index of the points
+        for (std::size_t pos : connectivityPos)
+            topology_[pos] += static_cast<std::int64_t>(pointOffset_);
+
+        geometryValid_ = true;
+        geometryGroup_.clear();
+    }
+
+    Field& addField_(const std::string& name, const char* attributeType, const char* center,
+                     std::size_t numComponents, std::size_t numEntities)
+    {
+        fields_.emplace_back();
+        Field& field = fields_.back();
+        field.name = name;
+        field.attributeType = attributeType;
+        field.center = center;
+        field.numComponents = numComponents;
+        field.values.assign(numEntities*numComponents, 0.0);
+
+        // HDF5 uses slashes to separate the names of groups
+        field.datasetName = name;
+        std::replace(field.datasetName.begin(), field.datasetName.end(), '/', '_');
+        return field;
+    }
+
+    // the number of components of the written vectors must be the same on all
+    // processes, also on those which do not contain any cells
+    std::size_t numVectorComponents_(const VectorBuffer& buf) const
+    {
+        std::size_t numComps = buf.empty() ? 0 : buf[0].size();
+        numComps = gridView_.comm().max(numComps);
+        return std::max<std::size_t>(numComps, 3);
+    }
+
+    std::size_t numTensorComponents_(const TensorBuffer& buf, std::size_t& numCols) const
+    {
+        std::size_t numRows = buf.empty() ? 0 : buf[0].N();
+        numCols = buf.empty() ? 0 : buf[0].M();
+        numRows = std::max<std::size_t>(gridView_.comm().max(numRows), 3);
+        numCols = std::max<std::size_t>(gridView_.comm().max(numCols), 3);
+        return numRows*numCols;
+    }
+
+    static void copyVector_(Field& field, std::size_t rowIdx, const Vector& v)
+    {
+        for (std::size_t compIdx = 0; compIdx < v.size(); ++compIdx)
+            field.values[rowIdx*field.numComponents + compIdx] = v[compIdx];
+    }
+
+    static void copyTensor_(Field& field, std::size_t rowIdx, std::size_t numCols, const Tensor& t)
+    {
+        for (std::size_t i = 0; i < t.N(); ++i)
+            for (std::size_t j = 0; j < t.M(); ++j)
+                field.values[rowIdx*field.numComponents + i*numCols + j] = t[i][j];
+    }
+
+    std::string stepName_(const char* prefix) const
+    {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%s%05d", prefix, curWriterNum_);
+        return buf;
+    }
+
+    std::string fileName_() const
+    {
+        if (singleFile_)
+            return simName_ + ".h5";
+        return simName_ + stepName_("-") + ".h5";
+    }
+
+    std::string gridGroup_() const
+    {
+        if (!singleFile_)
+            return "/grid";
+        if (!geometryGroup_.empty())
+            return geometryGroup_;
+        return stepName_("/grid");
+    }
+
+    std::string fieldGroup_() const
+    { return singleFile_ ? stepName_("/step") : "/fields"; }
+
+    void writeFile_(const std::vector<std::string>& groups, const std::vector<Dataset>& datasets)
+    {
+        if constexpr (parallelHdf5) {
+            writeLocalSlices_(groups, datasets, /*create=*/true);
+        }
+        else {
+            // without MPI-IO, the processes write their slices one after the other
+            for (int rank = 0; rank < commSize_; ++rank) {
+                if (rank == commRank_)
+                    writeLocalSlices_(groups, datasets, /*create=*/rank == 0);
+                gridView_.comm().barrier();
+            }
+        }
+    }
+
+    // write the slices of the local process into the file. if 'create' is true, the
+    // groups and datasets are created, otherwise they already exist
+    void writeLocalSlices_(const std::vector<std::string>& groups,
+                           const std::vector<Dataset>& datasets,
+                           bool create)
+    {
+        const std::string fileName = outputDir_ + "/" + fileName_();
+
+        hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+        hid_t dxpl = H5Pcreate(H5P_DATASET_XFER);
+#if HAVE_MPI && defined(H5_HAVE_PARALLEL)
+        if constexpr (parallelHdf5) {
+            check_(H5Pset_fapl_mpio(fapl, static_cast<MPI_Comm>(gridView_.comm()), MPI_INFO_NULL),
+                   "enable MPI-IO");
+            check_(H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_COLLECTIVE), "enable collective MPI-IO");
+        }
+#endif
+
+        hid_t file;
+        if (create && (!singleFile_ || !fileStarted_))
+            file = H5Fcreate(fileName.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+        else
+            file = H5Fopen(fileName.c_str(), H5F_ACC_RDWR, fapl);
+        H5Pclose(fapl);
+        if (file < 0) {
+            H5Pclose(dxpl);
+            throw std::runtime_error("HDF5 output: Could not open file '" + fileName + "'");
+        }
+
+        try {
+            if (create) {
+                for (const auto& group : groups) {
+                    removeLink_(file, group);
+                    hid_t groupId = H5Gcreate2(file, group.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+                    check_(groupId, "create a group");
+                    H5Gclose(groupId);
+                }
+            }
+
+            for (const auto& dataset : datasets)
+                writeSlice_(file, dxpl, dataset, create);
+        }
+        catch (...) {
+            H5Pclose(dxpl);
+            H5Fclose(file);
+            throw;
+        }
+
+        H5Pclose(dxpl);
+        check_(H5Fclose(file), "close the file '" + fileName + "'");
+    }
+
+    static void removeLink_(hid_t file, const std::string& path)
+    {
+        if (H5Lexists(file, path.c_str(), H5P_DEFAULT) > 0)
+            check_(H5Ldelete(file, path.c_str(), H5P_DEFAULT), "replace '" + path + "'");
+    }
+
+    static void writeSlice_(hid_t file, hid_t dxpl, const Dataset& dataset, bool create)
+    {
+        const int rank = dataset.numComponents > 1 ? 2 : 1;
+        const hsize_t fileDims[2] = { dataset.numGlobalRows, dataset.numComponents };
+        const hsize_t memDims[2] = { std::max<hsize_t>(dataset.numLocalRows, 1), dataset.numComponents };
+        const hsize_t offset[2] = { dataset.rowOffset, 0 };
+        const hsize_t count[2] = { dataset.numLocalRows, dataset.numComponents };
+
+        hid_t fileSpace = H5Screate_simple(rank, fileDims, nullptr);
+        hid_t memSpace = H5Screate_simple(rank, memDims, nullptr);
+        hid_t datasetId;
+        if (create)
+            datasetId = H5Dcreate2(file, dataset.path.c_str(), dataset.type, fileSpace,
+                                   H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+        else
+            datasetId = H5Dopen2(file, dataset.path.c_str(), H5P_DEFAULT);
+
+        herr_t ret = datasetId;
+        if (ret >= 0) {
+            if (dataset.numLocalRows > 0)
+                ret = H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, offset, nullptr, count, nullptr);
+            else {
+                H5Sselect_none(fileSpace);
+                H5Sselect_none(memSpace);
+            }
+        }
+        if (ret >= 0)
+            ret = H5Dwrite(datasetId, dataset.type, memSpace, fileSpace, dxpl, dataset.data);
+
+        if (datasetId >= 0)
+            H5Dclose(datasetId);
+        H5Sclose(memSpace);
+        H5Sclose(fileSpace);
+        check_(ret, "write the dataset '" + dataset.path + "'");
+    }
+
+    static std::string dataItem_(const std::string& location, std::size_t numRows,
+                                 std::size_t numComponents, const char* numberType)
+    {
+        std::ostringstream oss;
+        oss << "     <DataItem Dimensions=\"" << numRows;
+        if (numComponents > 1)
+            oss << " " << numComponents;
+        oss << "\" NumberType=\"" << numberType << "\" Precision=\"8\" Format=\"HDF\">"
+            << escapeXml_(location) << "</DataItem>\n";
+        return oss.str();
+    }
+
+    // the description of the current time step in the XDMF file
+    std::string xdmfEntry_() const
+    {
+        const std::string fileName = fileName_();
+        std::ostringstream oss;
+        oss.precision(16);
+        oss << "   <Grid Name=\"" << escapeXml_(simName_) << stepName_("-") << "\" GridType=\"Uniform\">\n"
+            << "    <Time Value=\"" << curTime_ << "\"/>\n"
+            << "    <Topology TopologyType=\"Mixed\" NumberOfElements=\"" << globalNumCells_ << "\">\n"
+            << dataItem_(fileName + ":" + geometryGroup_ + "/topology", globalTopologySize_, 1, "Int")
+            << "    </Topology>\n"
+            << "    <Geometry GeometryType=\"XYZ\">\n"
+            << dataItem_(fileName + ":" + geometryGroup_ + "/points", globalNumPoints_, 3, "Float")
+            << "    </Geometry>\n";
+        for (const auto& field : fields_) {
+            oss << "    <Attribute Name=\"" << escapeXml_(field.name)
+                << "\" AttributeType=\"" << field.attributeType
+                << "\" Center=\"" << field.center << "\">\n"
+                << dataItem_(fileName + ":" + fieldGroup_() + "/" + field.datasetName,
+                             field.center == "Cell" ? globalNumCells_ : globalNumPoints_,
+                             field.numComponents, "Float")
+                << "    </Attribute>\n";
+        }
+        oss << "   </Grid>\n";
+        return oss.str();
+    }
+
+    // rewrite the XDMF file which describes all time steps written so far
+    void writeXdmfFile_() const
+    {
+        if (commRank_ != 0)
+            return;
+
+        std::ofstream xdmfFile(outputDir_ + "/" + simName_ + ".xmf");
+        xdmfFile << "<?xml version=\"1.0\"?>\n"
+                 << "<Xdmf Version=\"3.0\">\n"
+                 << " <Domain>\n"
+                 << "  <Grid Name=\"" << escapeXml_(simName_)
+                 << "\" GridType=\"Collection\" CollectionType=\"Temporal\">\n";
+        for (const auto& entry : entries_)
+            xdmfFile << entry;
+        xdmfFile << "  </Grid>\n"
+                 << " </Domain>\n"
+                 << "</Xdmf>\n";
+    }
+
+    const GridView gridView_;
+    ElementMapper elementMapper_;
+    VertexMapper vertexMapper_;
+
+    std::string outputDir_;
+    std::string simName_;
+    bool singleFile_;
+    int commRank_;
+    int commSize_;
+
+    // the grid of the local process
+    bool geometryValid_ = false;
+    std::vector<std::int64_t> pointIndex_;
+    std::vector<std::size_t> cellElementIndex_;
+    std::vector<double> points_;
+    std::vector<std::int64_t> topology_;
+    std::size_t numCells_ = 0;
+    std::size_t numPoints_ = 0;
+
+    // the slices of the local process in the global datasets
+    std::size_t cellOffset_ = 0;
+    std::size_t pointOffset_ = 0;
+    std::size_t topologyOffset_ = 0;
+    std::size_t globalNumCells_ = 0;
+    std::size_t globalNumPoints_ = 0;
+    std::size_t globalTopologySize_ = 0;
+
+    // the group of the current geometry in the output file, empty if the current
+    // geometry has not been written yet
+    std::string geometryGroup_;
+    bool fileStarted_ = false;
+
+    int curWriterNum_ = 0;
+    double curTime_ = 0.0;
+    std::vector<Field> fields_;
+    std::vector<std::string> entries_;
+};
+
+} // namespace Opm
+
+#endif // HAVE_HDF5
+
+#endif
@@ -0,0 +1,314 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::OutputPlan
+ */
+#ifndef EWOMS_OUTPUT_PLAN_HH
+#define EWOMS_OUTPUT_PLAN_HH
+
+#include "baseoutputwriter.hh"
+
+#include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Decides which output fields are written for a given output step and which
+ *        part of the grid is considered.
+ *
+ * The plan is specified by two parameters:
+ *
+ * - OutputFieldIntervals: A comma separated list of entries of the form
+ *   "PATTERN=N". A field is only written every N-th time the output is written if its
+ *   name matches PATTERN, which may contain the wildcards '*' and '?'. The first
+ *   matching entry applies, fields which do not match any entry are always written.
+ * - OutputRegionOfInterest: The lower left and upper right corners of a box. Only the
+ *   elements whose center lies within this box are processed by the output modules,
+ *   the values of all other elements are zero.
+ *
+ * The plan learns which fields are written by an output module when the module
+ * commits its buffers for the first time. If none of these fields are due for a later
+ * output step, the module is skipped entirely, i.e., it neither allocates its
+ * buffers, nor processes the elements of the grid.
+ */
+template <class TypeTag>
+class OutputPlan
+{
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+
+    enum { dimWorld = GridView::dimensionworld };
+
+    struct Interval
+    {
+        std::string pattern;
+        unsigned interval;
+    };
+
+public:
+    /*!
+     * \brief Forwards the fields of an output module to a writer if the output plan
+     *        says that they are due.
+     */
+    class Writer : public BaseOutputWriter
+    {
+    public:
+        Writer(OutputPlan& plan, const void* module, BaseOutputWriter& writer)
+            : plan_(plan)
+            , module_(module)
+            , writer_(writer)
+        {}
+
+        void beginWrite(double t) override
+        { writer_.beginWrite(t); }
+
+        void attachScalarVertexData(ScalarBuffer& buf, std::string name) override
+        {
+            if (plan_.recordField_(module_, name))
+                writer_.attachScalarVertexData(buf, name);
+        }
+
+        void attachScalarElementData(ScalarBuffer& buf, std::string name) override
+        {
+            if (plan_.recordField_(module_, name))
+                writer_.attachScalarElementData(buf, name);
+        }
+
+        void attachVectorVertexData(VectorBuffer& buf, std::string name) override
+        {
+            if (plan_.recordField_(module_, name))
+                writer_.attachVectorVertexData(buf, name);
+        }
+
+        void attachVectorElementData(VectorBuffer& buf, std::string name) override
+        {
+            if (plan_.recordField_(module_, name))
+                writer_.attachVectorElementData(buf, name);
+        }
+
+        void attachTensorVertexData(TensorBuffer& buf, std::string name) override
+        {
+            if (plan_.recordField_(module_, name))
+                writer_.attachTensorVertexData(buf, name);
+        }
+
+        void attachTensorElementData(TensorBuffer& buf, std::string name) override
+        {
+            if (plan_.recordField_(module_, name))
+                writer_.attachTensorElementData(buf, name);
+        }
+
+        void endWrite(bool onlyDiscard = false) override
+        { writer_.endWrite(onlyDiscard); }
+
+    private:
+        OutputPlan& plan_;
+        const void* module_;
+        BaseOutputWriter& writer_;
+    };
+
+    OutputPlan()
+    {
+        parseIntervals_(Parameters::get<TypeTag, Properties::OutputFieldIntervals>());
+        parseRegion_(Parameters::get<TypeTag, Properties::OutputRegionOfInterest>());
+    }
+
+    /*!
+     * \brief Register all run-time parameters of the output plan.
+     */
+    static void registerParameters()
+    {
+        Parameters::registerParam<TypeTag, Properties::OutputFieldIntervals>
+            ("A comma separated list of PATTERN=N entries. The output fields whose "
+             "names match PATTERN are only written every N-th output step. PATTERN "
+             "may contain the wildcards '*' and '?'");
+        Parameters::registerParam<TypeTag, Properties::OutputRegionOfInterest>
+            ("The lower and the upper corner of a box. If specified, only the elements "
+             "whose center lies within this box are considered by the output");
+    }
+
+    /*!
+     * \brief Start a new output step.
+     */
+    void beginStep()
+    { ++stepIdx_; }
+
+    /*!
+     * \brief Returns true if a field is written for the current output step.
+     */
+    bool fieldIsDue(const std::string& name) const
+    {
+        for (const auto& entry : intervals_)
+            if (matches_(entry.pattern.c_str(), name.c_str()))
+                return stepIdx_ % entry.interval == 0;
+        return true;
+    }
+
+    /*!
+     * \brief Returns true if an output module needs to be considered for the current
+     *        output step.
+     *
+     * This is the case if any of the fields of the module are due or if it is
+     * unknown which fields the module writes.
+     */
+    bool moduleIsDue(const void* module) const
+    {
+        if (intervals_.empty())
+            return true;
+
+        const auto it = moduleFields_.find(module);
+        if (it == moduleFields_.end())
+            return true;
+        return std::any_of(it->second.begin(), it->second.end(),
+                           [this](const std::string& name) { return fieldIsDue(name); });
+    }
+
+    /*!
+     * \brief Returns true if the output is restricted to a part of the grid.
+     */
+    bool hasRegion() const
+    { return hasRegion_; }
+
+    /*!
+     * \brief Returns true if an element is considered by the output.
+     */
+    template <class Element>
+    bool contains(const Element& elem) const
+    {
+        if (!hasRegion_)
+            return true;
+
+        const auto center = elem.geometry().center();
+        for (unsigned i = 0; i < dimWorld; ++i)
+            if (center[i] < regionMin_[i] || center[i] > regionMax_[i])
+                return false;
+        return true;
+    }
+
+private:
+    // remember that a field belongs to a module and return whether it is due
+    bool recordField_(const void* module, const std::string& name)
+    {
+        if (!intervals_.empty()) {
+            auto& fields = moduleFields_[module];
+            if (std::find(fields.begin(), fields.end(), name) == fields.end())
+                fields.push_back(name);
+        }
+        return fieldIsDue(name);
+    }
+
+    // match a string against a pattern with the wildcards '*' and '?'
+    static bool matches_(const char* pattern, const char* str)
+    {
+        if (*pattern == '\0')
+            return *str == '\0';
+        if (*pattern == '*')
+            return matches_(pattern + 1, str) || (*str != '\0' && matches_(pattern, str + 1));
+        if (*str == '\0')
+            return false;
+        return (*pattern == '?' || *pattern == *str) && matches_(pattern + 1, str + 1);
+    }
+
+    void parseIntervals_(const std::string& spec)
+    {
+        std::string entry;
+        std::istringstream iss(spec);
+        while (std::getline(iss, entry, ',')) {
+            // remove leading and trailing whitespace
+            const auto first = entry.find_first_not_of(" \t");
+            if (first == std::string::npos)
+                continue;
+            entry = entry.substr(first, entry.find_last_not_of(" \t") - first + 1);
+
+            const auto eqPos = entry.rfind('=');
+            if (eqPos == std::string::npos || eqPos == 0)
+                throw std::invalid_argument("Invalid output field interval '" + entry + "'. "
+                                            "The entries must be of the form PATTERN=N");
+
+            const std::string intervalString = entry.substr(eqPos + 1);
+            std::size_t numParsed = 0;
+            unsigned long interval = 0;
+            try {
+                interval = std::stoul(intervalString, &numParsed);
+            }
+            catch (const std::exception&) {
+                numParsed = 0;
+            }
+            if (numParsed == 0 || numParsed != intervalString.size() || interval == 0)
+                throw std::invalid_argument("Invalid output field interval '" + entry + "'. "
+                                            "N must be a positive integer");
+
+            std::string pattern = entry.substr(0, eqPos);
+            pattern = pattern.substr(0, pattern.find_last_not_of(" \t") + 1);
+            intervals_.push_back({pattern, static_cast<unsigned>(interval)});
+        }
+    }
+
+    void parseRegion_(const std::string& spec)
+    {
+        std::string coordString = spec;
+        std::replace(coordString.begin(), coordString.end(), ',', ' ');
+        std::istringstream iss(coordString);
+        std::vector<double> coords;
+        double value;
+        while (iss >> value)
+            coords.push_back(value);
+        if (!iss.eof())
+            throw std::invalid_argument("Invalid region of interest '" + spec + "'");
+
+        if (coords.empty())
+            return;
+        if (coords.size() != 2*dimWorld)
+            throw std::invalid_argument("The region of interest must be specified by "
+                                        + std::to_string(2*dimWorld) + " coordinates");
+
+        hasRegion_ = true;
+        for (unsigned i = 0; i < dimWorld; ++i) {
+            regionMin_[i] = std::min(coords[i], coords[dimWorld + i]);
+            regionMax_[i] = std::max(coords[i], coords[dimWorld + i]);
+        }
+    }
+
+    std::vector<Interval> intervals_;
+    std::map<const void*, std::vector<std::string>> moduleFields_;
+    // the index of the current output step. the first step has index 0.
+    unsigned stepIdx_ = static_cast<unsigned>(-1);
+
+    bool hasRegion_ = false;
+    double regionMin_[dimWorld];
+    double regionMax_[dimWorld];
+};
+
+} // namespace Opm
+
+#endif
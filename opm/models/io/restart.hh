@@ -27,18 +27,190 @@
 #ifndef EWOMS_RESTART_HH
 #define EWOMS_RESTART_HH
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define EWOMS_RESTART_HAVE_MMAP 1
+#endif
+
+#include <opm/models/io/collectivefile.hh>
+
+#include <dune/grid/common/gridenums.hh>
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <numeric>
 #include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <type_traits>
+#include <vector>
 
 namespace Opm {
 
+/*!
+ * \brief Writes the data of the entities to a binary restart file.
+ *
+ * The stream provides the subset of the interface of std::ostream which is used by
+ * the serializeEntity() methods of the models: Values are written as raw little
+ * endian data, and string literals (i.e., the separators of the text format) are
+ * ignored.
+ */
+class BinaryRestartOutStream
+{
+public:
+    explicit BinaryRestartOutStream(std::ostream& os)
+        : os_(os)
+    {}
+
+    bool good() const
+    { return os_.good(); }
+
+    template <class T>
+    std::enable_if_t<std::is_trivially_copyable_v<T> && !std::is_pointer_v<T> && !std::is_array_v<T>,
+                     BinaryRestartOutStream&>
+    operator<<(const T& value)
+    {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        toLittleEndian(bytes, sizeof(T));
+        os_.write(bytes, sizeof(T));
+        return *this;
+    }
+
+    BinaryRestartOutStream& operator<<(const char*)
+    { return *this; }
+
+    /*!
+     * \brief Write an array of values as one block.
+     *
+     * This is the same as writing the values one by one, but it avoids the overhead
+     * of the stream for each value.
+     */
+    template <class T>
+    void writeBlock(const T* values, std::size_t numValues)
+    {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "Only trivially copyable values can be written as a block");
+        if (!isLittleEndian()) {
+            for (std::size_t i = 0; i < numValues; ++i)
+                *this << values[i];
+            return;
+        }
+
+        os_.write(reinterpret_cast<const char*>(values),
+                  static_cast<std::streamsize>(numValues*sizeof(T)));
+    }
+
+    //! Returns true iff the byte order of the host is little endian
+    static bool isLittleEndian()
+    {
+        const std::uint16_t one = 1;
+        return *reinterpret_cast<const unsigned char*>(&one) == 1;
+    }
+
+    //! Convert a value between the byte order of the host and little endian
+    static void toLittleEndian(char* bytes, std::size_t size)
+    {
+        if (!isLittleEndian())
+            std::reverse(bytes, bytes + size);
+    }
+
+private:
+    std::ostream& os_;
+};
+
+/*!
+ * \brief Reads the data of the entities from a binary restart file.
+ *
+ * This is the counterpart of BinaryRestartOutStream for the deserializeEntity()
+ * methods of the models.
+ */
+class BinaryRestartInStream
+{
+public:
+    explicit BinaryRestartInStream(std::streambuf& buf)
+        : buf_(buf)
+    {}
+
+    bool good() const
+    { return good_; }
+
+    template <class T>
+    std::enable_if_t<std::is_trivially_copyable_v<T> && !std::is_pointer_v<T> && !std::is_array_v<T>,
+                     BinaryRestartInStream&>
+    operator>>(T& value)
+    {
+        char bytes[sizeof(T)];
+        if (buf_.sgetn(bytes, sizeof(T)) != static_cast<std::streamsize>(sizeof(T))) {
+            good_ = false;
+            return *this;
+        }
+        BinaryRestartOutStream::toLittleEndian(bytes, sizeof(T));
+        std::memcpy(&value, bytes, sizeof(T));
+        return *this;
+    }
+
+    /*!
+     * \brief Read an array of values which was written by
+     *        BinaryRestartOutStream::writeBlock().
+     */
+    template <class T>
+    void readBlock(T* values, std::size_t numValues)
+    {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "Only trivially copyable values can be read as a block");
+        if (!BinaryRestartOutStream::isLittleEndian()) {
+            for (std::size_t i = 0; i < numValues; ++i)
+                *this >> values[i];
+            return;
+        }
+
+        const auto numBytes = static_cast<std::streamsize>(numValues*sizeof(T));
+        if (buf_.sgetn(reinterpret_cast<char*>(values), numBytes) != numBytes)
+            good_ = false;
+    }
+
+private:
+    std::streambuf& buf_;
+    bool good_ = true;
+};
+
 /*!
  * \brief Load or save a state of a problem to/from the harddisk.
+ *
+ * Two formats are available: The text format writes all data as formatted ASCII
+ * (files ending in .ers), the binary format writes the data of the entities as raw
+ * arrays (files ending in .erb). A binary restart file consists of a header, the
+ * sections in the order in which they were written and a table of the sections at
+ * the end of the file. When a binary file is read, it is mapped into memory if this
+ * is supported by the operating system, i.e., the data is not copied before it is
+ * deserialized.
+ *
+ * The collective format writes a single binary file for all processes (ending in
+ * .erc) which does not depend on the partitioning of the grid: The data of each
+ * entity is stored together with its global id, and the sections which do not
+ * contain entity data are those of the first process. Such a file can thus be loaded
+ * by a different number of processes, each of which only reads the records of the
+ * entities which it sees. The other processes may ignore parts of the non-entity
+ * sections.
  */
 class Restart
 {
+    //! The first bytes of binary restart files
+    static constexpr char binaryMagic_[] = "eWoms binary restart\n";
+    static constexpr std::uint32_t binaryVersion_ = 1;
+
     /*!
      * \brief Create a magic cookie for restart files, so that it is
      *        unlikely to load a restart file for an incorrectly.
@@ -66,14 +238,59 @@ class Restart
         return oss.str();
     }
 
+    /*!
+     * \brief Create a magic cookie for collective restart files.
+     *
+     * In contrast to magicRestartCookie_(), this only uses quantities which do not
+     * depend on the partitioning of the grid.
+     */
+    template <class GridView>
+    static const std::string collectiveRestartCookie_(const GridView& gridView)
+    {
+        static const std::string gridName = "blubb"; // gridView.grid().name();
+        static const int dim = GridView::dimension;
+
+        std::size_t numElements = 0;
+        for (const auto& elem : elements(gridView, Dune::Partitions::interior)) {
+            static_cast<void>(elem);
+            ++numElements;
+        }
+        numElements = gridView.comm().sum(numElements);
+
+        std::ostringstream oss;
+        oss << "eWoms collective restart file: "
+            << "gridName='" << gridName << "' "
+            << "dim=" << dim << " "
+            << "numElements=" << numElements;
+        return oss.str();
+    }
+
+    /*!
+     * \brief Return the communicator which is used for collective restart files.
+     */
+    template <class GridView>
+    static CollectiveFile::Communicator communicator_(const GridView& gridView)
+    {
+#if HAVE_MPI
+        using Comm = std::decay_t<decltype(gridView.comm())>;
+        if constexpr (std::is_convertible_v<Comm, MPI_Comm>)
+            return static_cast<MPI_Comm>(gridView.comm());
+        else
+            return MPI_COMM_SELF;
+#else
+        static_cast<void>(gridView);
+        return 0;
+#endif
+    }
+
     /*!
      * \brief Return the restart file name.
      */
     template <class GridView, class Scalar>
-    static const std::string restartFileName_(const GridView& gridView,
-                                              const std::string& outputDir,
-                                              const std::string& simName,
-                                              Scalar t)
+    const std::string restartFileName_(const GridView& gridView,
+                                       const std::string& outputDir,
+                                       const std::string& simName,
+                                       Scalar t) const
     {
         std::string dir = outputDir;
         if (dir == ".")
@@ -81,13 +298,92 @@ class Restart
         else if (!dir.empty() && dir.back() != '/')
             dir += "/";
 
-        int rank = gridView.comm().rank();
         std::ostringstream oss;
-        oss << dir << simName << "_time=" << t << "_rank=" << rank << ".ers";
+        oss << dir << simName << "_time=" << t;
+        if (format_ == Format::Collective)
+            oss << ".erc";
+        else
+            oss << "_rank=" << gridView.comm().rank()
+                << (format_ == Format::Binary ? ".erb" : ".ers");
         return oss.str();
     }
 
+    // a string buffer which provides access to its data without copying it
+    class StagingBuf : public std::stringbuf
+    {
+    public:
+        StagingBuf()
+            : std::stringbuf(std::ios::out | std::ios::binary)
+        {}
+
+        const char* data() const
+        { return pbase(); }
+
+        // the binary format patches sizes backwards, but the put position is always
+        // at the end of the data when the restart file is complete
+        std::size_t size() const
+        { return static_cast<std::size_t>(pptr() - pbase()); }
+    };
+
+    // a stream buffer which reads a region of memory without copying it
+    class MemoryStreamBuf : public std::streambuf
+    {
+    public:
+        void setRegion(const char* begin, const char* end)
+        {
+            char* b = const_cast<char*>(begin);
+            setg(b, b, const_cast<char*>(end));
+        }
+
+        std::size_t remaining() const
+        { return static_cast<std::size_t>(egptr() - gptr()); }
+
+        const char* current() const
+        { return gptr(); }
+    };
+
+    struct SectionEntry
+    {
+        std::string cookie;
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+
 public:
+    enum class Format { Text, Binary, Collective };
+
+    /*!
+     * \brief Convert the value of a parameter to a restart file format.
+     */
+    static Format parseFormat(const std::string& name)
+    {
+        if (name == "text")
+            return Format::Text;
+        if (name == "binary")
+            return Format::Binary;
+        if (name == "collective")
+            return Format::Collective;
+        throw std::invalid_argument("Unknown restart file format '" + name + "'. "
+                                    "Possible values are 'text', 'binary' and 'collective'");
+    }
+
+    /*!
+     * \param format The format of the restart files
+     * \param useMmap Map binary restart files into memory when they are read. This
+     *                does not apply to collective restart files.
+     */
+    explicit Restart(Format format = Format::Text, bool useMmap = true)
+        : format_(format)
+        , useMmap_(useMmap)
+        , sectionStream_(&sectionBuf_)
+    {}
+
+    Restart(const Restart&) = delete;
+    Restart& operator=(const Restart&) = delete;
+
+    ~Restart()
+    { unmap_(); }
+
     /*!
      * \brief Returns the name of the file which is (de-)serialized.
      */
@@ -100,14 +396,46 @@ public:
     template <class Simulator>
     void serializeBegin(Simulator& simulator)
     {
-        const std::string magicCookie = magicRestartCookie_(simulator.gridView());
         fileName_ = restartFileName_(simulator.gridView(),
                                      simulator.problem().outputDir(),
                                      simulator.problem().name(),
                                      simulator.time());
 
+        if (format_ == Format::Collective) {
+            collectiveFile_.open(fileName_, /*write=*/true, communicator_(simulator.gridView()));
+            sections_.clear();
+
+            std::string header(binaryMagic_, sizeof(binaryMagic_) - 1);
+            appendBinary_(header, binaryVersion_);
+            if (collectiveFile_.rank() == 0)
+                collectiveFile_.writeAt(0, header.data(), header.size());
+            filePos_ = header.size();
+            sectionOut_.precision(20);
+
+            serializeSectionBegin(collectiveRestartCookie_(simulator.gridView()));
+            serializeSectionEnd();
+            return;
+        }
+
+        const std::string magicCookie = magicRestartCookie_(simulator.gridView());
+
         // open output file and write magic cookie
-        outStream_.open(fileName_.c_str());
+        if (staged_) {
+            stagingBuf_.str("");
+            outStream_.rdbuf(&stagingBuf_);
+        }
+        else {
+            const auto mode = (format_ == Format::Binary) ? (std::ios::out | std::ios::binary) : std::ios::out;
+            const bool isOpen = fileBuf_.open(fileName_.c_str(), mode) != nullptr;
+            outStream_.rdbuf(&fileBuf_);
+            if (!isOpen)
+                outStream_.setstate(std::ios::failbit);
+        }
+        if (format_ == Format::Binary) {
+            outStream_.write(binaryMagic_, sizeof(binaryMagic_) - 1);
+            writeBinary_(binaryVersion_);
+            sections_.clear();
+        }
         outStream_.precision(20);
 
         serializeSectionBegin(magicCookie);
@@ -118,24 +446,69 @@ public:
      * \brief The output stream to write the serialized data.
      */
     std::ostream& serializeStream()
-    { return outStream_; }
+    {
+        if (format_ == Format::Collective)
+            return sectionOut_;
+        return outStream_;
+    }
 
     /*!
      * \brief Start a new section in the serialized output.
      */
     void serializeSectionBegin(const std::string& cookie)
-    { outStream_ << cookie << "\n"; }
+    {
+        if (format_ == Format::Collective) {
+            sectionCookie_ = cookie;
+            sectionOut_.str("");
+            sectionOut_.clear();
+        }
+        else if (format_ == Format::Binary) {
+            // the size of the section is filled in by serializeSectionEnd()
+            writeBinary_(static_cast<std::uint32_t>(cookie.size()));
+            outStream_.write(cookie.data(), static_cast<std::streamsize>(cookie.size()));
+            sectionSizePos_ = outStream_.tellp();
+            writeBinary_(std::uint64_t{0});
+            sections_.push_back({cookie, static_cast<std::uint64_t>(outStream_.tellp()), 0});
+        }
+        else
+            outStream_ << cookie << "\n";
+    }
 
     /*!
      * \brief End of a section in the serialized output.
      */
     void serializeSectionEnd()
-    { outStream_ << "\n"; }
+    {
+        if (format_ == Format::Collective) {
+            // only the data of the first process is stored
+            std::string payload;
+            if (collectiveFile_.rank() == 0)
+                payload = sectionOut_.str();
+            std::uint64_t size = payload.size();
+            collectiveFile_.broadcast(&size, sizeof(size));
+
+            const std::uint64_t offset = beginCollectiveSection_(sectionCookie_, size);
+            if (collectiveFile_.rank() == 0)
+                collectiveFile_.writeAt(offset, payload.data(), payload.size());
+        }
+        else if (format_ == Format::Binary) {
+            auto& section = sections_.back();
+            const std::streampos endPos = outStream_.tellp();
+            section.size = static_cast<std::uint64_t>(endPos) - section.offset;
+            outStream_.seekp(sectionSizePos_);
+            writeBinary_(section.size);
+            outStream_.seekp(endPos);
+        }
+        else
+            outStream_ << "\n";
+    }
 
     /*!
      * \brief Serialize all leaf entities of a codim in a gridView.
      *
-     * The actual work is done by Serializer::serialize(Entity)
+     * The actual work is done by Serializer::serialize(Entity). For binary restart
+     * files, serializers whose entityBlocksSupported() method returns true instead
+     * write the data of all entities at once using serializeEntityBlocks().
      */
     template <int codim, class Serializer, class GridView>
     void serializeEntities(Serializer& serializer, const GridView& gridView)
@@ -143,6 +516,19 @@ public:
         std::ostringstream oss;
         oss << "Entities: Codim " << codim;
         std::string cookie = oss.str();
+        if (format_ == Format::Collective) {
+            serializeEntitiesCollective_<codim>(serializer, gridView, cookie);
+            return;
+        }
+
+        if (format_ == Format::Binary && serializer.entityBlocksSupported()) {
+            serializeSectionBegin(entityBlocksCookie_(codim));
+            BinaryRestartOutStream binaryStream(outStream_);
+            serializer.serializeEntityBlocks(binaryStream);
+            serializeSectionEnd();
+            return;
+        }
+
         serializeSectionBegin(cookie);
 
         // write element data
@@ -150,9 +536,16 @@ public:
 
         Iterator it = gridView.template begin<codim>();
         const Iterator& endIt = gridView.template end<codim>();
-        for (; it != endIt; ++it) {
-            serializer.serializeEntity(outStream_, *it);
-            outStream_ << "\n";
+        if (format_ == Format::Binary) {
+            BinaryRestartOutStream binaryStream(outStream_);
+            for (; it != endIt; ++it)
+                serializer.serializeEntity(binaryStream, *it);
+        }
+        else {
+            for (; it != endIt; ++it) {
+                serializer.serializeEntity(outStream_, *it);
+                outStream_ << "\n";
+            }
         }
 
         serializeSectionEnd();
@@ -162,7 +555,68 @@ public:
      * \brief Finish the restart file.
      */
     void serializeEnd()
-    { outStream_.close(); }
+    {
+        if (format_ == Format::Collective) {
+            if (collectiveFile_.rank() == 0) {
+                std::string table;
+                appendSectionTable_(table, filePos_);
+                collectiveFile_.writeAt(filePos_, table.data(), table.size());
+            }
+            collectiveFile_.close();
+            return;
+        }
+
+        if (format_ == Format::Binary) {
+            // write the table of sections and its position
+            const auto tablePos = static_cast<std::uint64_t>(outStream_.tellp());
+            std::string table;
+            appendSectionTable_(table, tablePos);
+            outStream_.write(table.data(), static_cast<std::streamsize>(table.size()));
+        }
+
+        if (!outStream_.good())
+            throw std::runtime_error("Could not write restart file '" + fileName_ + "'");
+        if (!staged_)
+            fileBuf_.close();
+    }
+
+    /*!
+     * \brief Specify whether the data is kept in memory by serializeEnd().
+     *
+     * Staged data is written to disk by writeStaged(), which may be called by a
+     * different thread than the one which serialized the simulation. This does not
+     * apply to collective restart files.
+     */
+    void setStaged(bool yesno)
+    {
+        if (yesno && format_ == Format::Collective)
+            throw std::logic_error("Collective restart files cannot be staged in memory");
+        staged_ = yesno;
+    }
+
+    /*!
+     * \brief Write the data which was staged in memory to the restart file.
+     *
+     * The data is first written to a temporary file which then replaces the restart
+     * file, i.e., an incomplete restart file is never visible.
+     */
+    void writeStaged()
+    {
+        const std::string tmpFileName = fileName_ + ".tmp";
+        {
+            std::ofstream file(tmpFileName.c_str(), std::ios::binary);
+            file.write(stagingBuf_.data(), static_cast<std::streamsize>(stagingBuf_.size()));
+            if (!file.good())
+                throw std::runtime_error("Could not write restart file '" + fileName_ + "'");
+        }
+        if (std::rename(tmpFileName.c_str(), fileName_.c_str()) != 0)
+            throw std::runtime_error("Could not rename '" + tmpFileName + "' to '" + fileName_ + "'");
+
+        // release the memory of the staging buffer
+        outStream_.rdbuf(nullptr);
+        StagingBuf empty;
+        stagingBuf_.swap(empty);
+    }
 
     /*!
      * \brief Start reading a restart file at a certain simulated
@@ -173,19 +627,30 @@ public:
     {
         fileName_ = restartFileName_(simulator.gridView(), simulator.problem().outputDir(), simulator.problem().name(), t);
 
-        // open input file and read magic cookie
-        inStream_.open(fileName_.c_str());
-        if (!inStream_.good()) {
-            throw std::runtime_error("Restart file '"+fileName_+"' could not be opened properly");
+        if (format_ == Format::Collective) {
+            openCollective_(communicator_(simulator.gridView()));
+            deserializeSectionBegin(collectiveRestartCookie_(simulator.gridView()));
+            deserializeSectionEnd();
+            return;
         }
 
-        // make sure that we don't open an empty file
-        inStream_.seekg(0, std::ios::end);
-        auto pos = inStream_.tellg();
-        if (pos == 0) {
-            throw std::runtime_error("Restart file '"+fileName_+"' is empty");
+        if (format_ == Format::Binary)
+            openBinary_();
+        else {
+            // open input file and read magic cookie
+            inStream_.open(fileName_.c_str());
+            if (!inStream_.good()) {
+                throw std::runtime_error("Restart file '"+fileName_+"' could not be opened properly");
+            }
+
+            // make sure that we don't open an empty file
+            inStream_.seekg(0, std::ios::end);
+            auto pos = inStream_.tellg();
+            if (pos == 0) {
+                throw std::runtime_error("Restart file '"+fileName_+"' is empty");
+            }
+            inStream_.seekg(0, std::ios::beg);
         }
-        inStream_.seekg(0, std::ios::beg);
 
         const std::string magicCookie = magicRestartCookie_(simulator.gridView());
 
@@ -198,13 +663,37 @@ public:
      *        deserialized.
      */
     std::istream& deserializeStream()
-    { return inStream_; }
+    {
+        if (format_ == Format::Text)
+            return inStream_;
+        return sectionStream_;
+    }
 
     /*!
      * \brief Start reading a new section of the restart file.
      */
     void deserializeSectionBegin(const std::string& cookie)
     {
+        if (format_ == Format::Collective) {
+            // the first process reads the section and distributes it to the others
+            const auto& section = nextSection_(cookie);
+            sectionData_.resize(section.size);
+            if (collectiveFile_.rank() == 0)
+                collectiveFile_.readAt(section.offset, sectionData_.data(), sectionData_.size());
+            collectiveFile_.broadcast(sectionData_.data(), sectionData_.size());
+
+            sectionBuf_.setRegion(sectionData_.data(), sectionData_.data() + sectionData_.size());
+            sectionStream_.clear();
+            return;
+        }
+
+        if (format_ == Format::Binary) {
+            const auto& section = nextSection_(cookie);
+            sectionBuf_.setRegion(fileData_ + section.offset, fileData_ + section.offset + section.size);
+            sectionStream_.clear();
+            return;
+        }
+
         if (!inStream_.good())
             throw std::runtime_error("Encountered unexpected EOF in restart file.");
         std::string buf;
@@ -218,6 +707,19 @@ public:
      */
     void deserializeSectionEnd()
     {
+        // the non-entity sections of collective restart files were written by the
+        // first process, i.e., the others are not required to read all of their data
+        if (format_ == Format::Collective && collectiveFile_.rank() != 0)
+            return;
+
+        if (format_ != Format::Text) {
+            const char* pos = sectionBuf_.current();
+            if (!std::all_of(pos, pos + sectionBuf_.remaining(),
+                             [](char c) { return std::isspace(static_cast<unsigned char>(c)); }))
+                throw std::logic_error("Encountered unread values while deserializing");
+            return;
+        }
+
         std::string dummy;
         std::getline(inStream_, dummy);
         for (unsigned i = 0; i < dummy.length(); ++i) {
@@ -238,6 +740,30 @@ public:
         std::ostringstream oss;
         oss << "Entities: Codim " << codim;
         std::string cookie = oss.str();
+        if (format_ == Format::Collective) {
+            deserializeEntitiesCollective_<codim>(deserializer, gridView, cookie);
+            return;
+        }
+
+        // the file determines whether the entities were written as blocks
+        const std::string blocksCookie = entityBlocksCookie_(codim);
+        if (format_ == Format::Binary
+            && nextSectionIdx_ < sections_.size()
+            && sections_[nextSectionIdx_].cookie == blocksCookie)
+        {
+            if (!deserializer.entityBlocksSupported())
+                throw std::runtime_error("The restart file '"+fileName_+"' stores the entities "
+                                         "as blocks, but the model cannot read them");
+
+            deserializeSectionBegin(blocksCookie);
+            BinaryRestartInStream binaryStream(sectionBuf_);
+            deserializer.deserializeEntityBlocks(binaryStream);
+            if (!binaryStream.good())
+                throw std::runtime_error("Restart file is corrupted");
+            deserializeSectionEnd();
+            return;
+        }
+
         deserializeSectionBegin(cookie);
 
         std::string curLine;
@@ -246,14 +772,24 @@ public:
         using Iterator = typename GridView::template Codim<codim>::Iterator;
         Iterator it = gridView.template begin<codim>();
         const Iterator& endIt = gridView.template end<codim>();
-        for (; it != endIt; ++it) {
-            if (!inStream_.good()) {
-                throw std::runtime_error("Restart file is corrupted");
+        if (format_ == Format::Binary) {
+            BinaryRestartInStream binaryStream(sectionBuf_);
+            for (; it != endIt; ++it) {
+                deserializer.deserializeEntity(binaryStream, *it);
+                if (!binaryStream.good())
+                    throw std::runtime_error("Restart file is corrupted");
             }
+        }
+        else {
+            for (; it != endIt; ++it) {
+                if (!inStream_.good()) {
+                    throw std::runtime_error("Restart file is corrupted");
+                }
 
-            std::getline(inStream_, curLine);
-            std::istringstream curLineStream(curLine);
-            deserializer.deserializeEntity(curLineStream, *it);
+                std::getline(inStream_, curLine);
+                std::istringstream curLineStream(curLine);
+                deserializer.deserializeEntity(curLineStream, *it);
+            }
         }
 
         deserializeSectionEnd();
@@ -263,12 +799,423 @@ public:
      * \brief Stop reading the restart file.
      */
     void deserializeEnd()
-    { inStream_.close(); }
+    {
+        if (format_ == Format::Collective) {
+            collectiveFile_.close();
+            sectionData_.clear();
+            sectionBuf_.setRegion(nullptr, nullptr);
+        }
+        else if (format_ == Format::Binary)
+            unmap_();
+        else
+            inStream_.close();
+    }
 
 private:
+    // the size of the header of the entity sections in collective restart files:
+    // the number of records, the size of the ids and the size of the data records
+    static constexpr std::size_t entityHeaderSize_ = 3*sizeof(std::uint64_t);
+
+    static std::string entityBlocksCookie_(int codim)
+    { return "Entity blocks: Codim " + std::to_string(codim); }
+
+    template <class T>
+    void writeBinary_(T value)
+    { BinaryRestartOutStream(outStream_) << value; }
+
+    template <class T>
+    static void appendBinary_(std::string& buf, T value)
+    {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        BinaryRestartOutStream::toLittleEndian(bytes, sizeof(T));
+        buf.append(bytes, sizeof(T));
+    }
+
+    template <class T>
+    static T decodeBinary_(const char* data)
+    {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, data, sizeof(T));
+        BinaryRestartOutStream::toLittleEndian(bytes, sizeof(T));
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+        return value;
+    }
+
+    // append the table of sections and its position to a buffer
+    void appendSectionTable_(std::string& buf, std::uint64_t tablePos) const
+    {
+        appendBinary_(buf, static_cast<std::uint64_t>(sections_.size()));
+        for (const auto& section : sections_) {
+            appendBinary_(buf, static_cast<std::uint32_t>(section.cookie.size()));
+            buf.append(section.cookie);
+            appendBinary_(buf, section.offset);
+            appendBinary_(buf, section.size);
+        }
+        appendBinary_(buf, tablePos);
+    }
+
+    // parse the table of sections which is stored in a buffer
+    void readSectionTable_(const char* table, std::size_t tableSize, std::uint64_t fileSize)
+    {
+        std::size_t pos = 0;
+        auto require = [&](std::size_t n) {
+            if (pos + n > tableSize)
+                throw std::runtime_error("Restart file '"+fileName_+"' is corrupted");
+        };
+
+        require(sizeof(std::uint64_t));
+        const auto numSections = decodeBinary_<std::uint64_t>(table + pos);
+        pos += sizeof(std::uint64_t);
+
+        sections_.clear();
+        for (std::uint64_t i = 0; i < numSections; ++i) {
+            require(sizeof(std::uint32_t));
+            const auto cookieSize = decodeBinary_<std::uint32_t>(table + pos);
+            pos += sizeof(std::uint32_t);
+
+            require(cookieSize + 2*sizeof(std::uint64_t));
+            SectionEntry section;
+            section.cookie.assign(table + pos, cookieSize);
+            pos += cookieSize;
+            section.offset = decodeBinary_<std::uint64_t>(table + pos);
+            section.size = decodeBinary_<std::uint64_t>(table + pos + sizeof(std::uint64_t));
+            pos += 2*sizeof(std::uint64_t);
+            if (section.offset + section.size > fileSize)
+                throw std::runtime_error("Restart file '"+fileName_+"' is corrupted");
+
+            sections_.push_back(std::move(section));
+        }
+        nextSectionIdx_ = 0;
+    }
+
+    // return the next section of a binary restart file
+    const SectionEntry& nextSection_(const std::string& cookie)
+    {
+        // the sections must be read in the same order as they were written
+        if (nextSectionIdx_ >= sections_.size())
+            throw std::runtime_error("Encountered unexpected EOF in restart file.");
+        const auto& section = sections_[nextSectionIdx_++];
+        if (section.cookie != cookie)
+            throw std::runtime_error("Could not start section '"+cookie+"'");
+        return section;
+    }
+
+    // add a section to a collective restart file and return the position of its
+    // data. The header of the section is written by the first process.
+    std::uint64_t beginCollectiveSection_(const std::string& cookie, std::uint64_t size)
+    {
+        std::string header;
+        appendBinary_(header, static_cast<std::uint32_t>(cookie.size()));
+        header.append(cookie);
+        appendBinary_(header, size);
+        if (collectiveFile_.rank() == 0)
+            collectiveFile_.writeAt(filePos_, header.data(), header.size());
+
+        const std::uint64_t offset = filePos_ + header.size();
+        sections_.push_back({cookie, offset, size});
+        filePos_ = offset + size;
+        return offset;
+    }
+
+    // open a collective restart file and read its table of sections
+    void openCollective_(CollectiveFile::Communicator comm)
+    {
+        collectiveFile_.open(fileName_, /*write=*/false, comm);
+
+        // the first process checks the header and reads the table of sections
+        const std::size_t headerSize = sizeof(binaryMagic_) - 1 + sizeof(std::uint32_t);
+        std::string table;
+        std::uint64_t status[2] = {0, 0}; // error code, size of the table
+        std::uint64_t fileSize = 0;
+        if (collectiveFile_.rank() == 0) {
+            fileSize = collectiveFile_.fileSize();
+            std::vector<char> header(headerSize);
+            if (fileSize < headerSize + sizeof(std::uint64_t))
+                status[0] = 1;
+            else {
+                collectiveFile_.readAt(0, header.data(), header.size());
+                if (std::memcmp(header.data(), binaryMagic_, sizeof(binaryMagic_) - 1) != 0)
+                    status[0] = 1;
+                else if (decodeBinary_<std::uint32_t>(header.data() + sizeof(binaryMagic_) - 1) != binaryVersion_)
+                    status[0] = 2;
+            }
+
+            if (status[0] == 0) {
+                char trailer[sizeof(std::uint64_t)];
+                collectiveFile_.readAt(fileSize - sizeof(trailer), trailer, sizeof(trailer));
+                const auto tablePos = decodeBinary_<std::uint64_t>(trailer);
+                if (tablePos < headerSize || tablePos > fileSize - sizeof(trailer))
+                    status[0] = 3;
+                else {
+                    table.resize(fileSize - sizeof(trailer) - tablePos);
+                    collectiveFile_.readAt(tablePos, table.data(), table.size());
+                    status[1] = table.size();
+                }
+            }
+        }
+        collectiveFile_.broadcast(status, sizeof(status));
+        collectiveFile_.broadcast(&fileSize, sizeof(fileSize));
+
+        if (status[0] == 1)
+            throw std::runtime_error("Restart file '"+fileName_+"' is not a collective restart file");
+        if (status[0] == 2)
+            throw std::runtime_error("Restart file '"+fileName_+"' has an unsupported version");
+        if (status[0] == 3)
+            throw std::runtime_error("Restart file '"+fileName_+"' is corrupted");
+
+        table.resize(status[1]);
+        collectiveFile_.broadcast(table.data(), table.size());
+        readSectionTable_(table.data(), table.size(), fileSize);
+    }
+
+    // write the entities which are owned by the local process to a collective
+    // restart file
+    template <int codim, class Serializer, class GridView>
+    void serializeEntitiesCollective_(Serializer& serializer,
+                                      const GridView& gridView,
+                                      const std::string& cookie)
+    {
+        using IdType = typename GridView::Grid::GlobalIdSet::IdType;
+        static_assert(std::is_trivially_copyable_v<IdType>,
+                      "Collective restart files require trivially copyable global ids");
+        const auto& idSet = gridView.grid().globalIdSet();
+
+        // serialize the interior and border entities. The border entities are thus
+        // stored multiple times, but this avoids any communication.
+        std::vector<IdType> ids;
+        std::ostringstream data(std::ios::out | std::ios::binary);
+        BinaryRestartOutStream binaryStream(data);
+        std::uint64_t recordSize = 0;
+        std::uint64_t irregular = 0;
+        std::streamoff lastPos = 0;
+        for (const auto& entity : entities(gridView, Dune::Codim<codim>{})) {
+            if (entity.partitionType() != Dune::InteriorEntity
+                && entity.partitionType() != Dune::BorderEntity)
+                continue;
+
+            ids.push_back(idSet.id(entity));
+            serializer.serializeEntity(binaryStream, entity);
+
+            const std::streamoff pos = data.tellp();
+            const auto size = static_cast<std::uint64_t>(pos - lastPos);
+            if (ids.size() == 1)
+                recordSize = size;
+            else if (size != recordSize)
+                irregular = 1;
+            lastPos = pos;
+        }
+
+        // the records must have the same size on all processes
+        const std::uint64_t globalRecordSize = collectiveFile_.max(recordSize);
+        if (!ids.empty() && recordSize != globalRecordSize)
+            irregular = 1;
+        if (collectiveFile_.max(irregular))
+            throw std::logic_error("The data of the entities of codim "+std::to_string(codim)+
+                                   " does not have a fixed size. It cannot be written to a "
+                                   "collective restart file");
+        recordSize = globalRecordSize;
+
+        std::uint64_t numRecords;
+        const std::uint64_t firstRecord = collectiveFile_.exclusiveSum(ids.size(), numRecords);
+        const std::uint64_t idSize = sizeof(IdType);
+
+        const std::uint64_t offset =
+            beginCollectiveSection_(cookie, entityHeaderSize_ + numRecords*(idSize + recordSize));
+        if (collectiveFile_.rank() == 0) {
+            std::string header;
+            appendBinary_(header, numRecords);
+            appendBinary_(header, idSize);
+            appendBinary_(header, recordSize);
+            collectiveFile_.writeAt(offset, header.data(), header.size());
+        }
+
+        const std::uint64_t idsPos = offset + entityHeaderSize_;
+        const std::uint64_t recordsPos = idsPos + numRecords*idSize;
+        const std::string records = data.str();
+        collectiveFile_.writeRecordsAll(idsPos + firstRecord*idSize, ids.data(), ids.size(), idSize);
+        collectiveFile_.writeRecordsAll(recordsPos + firstRecord*recordSize,
+                                        records.data(), ids.size(), recordSize);
+    }
+
+    // read the entities which are seen by the local process from a collective
+    // restart file
+    template <int codim, class Deserializer, class GridView>
+    void deserializeEntitiesCollective_(Deserializer& deserializer,
+                                        const GridView& gridView,
+                                        const std::string& cookie)
+    {
+        using IdType = typename GridView::Grid::GlobalIdSet::IdType;
+        const auto& idSet = gridView.grid().globalIdSet();
+        const auto& section = nextSection_(cookie);
+
+        // read the header of the section and the global ids of all records
+        char header[entityHeaderSize_] = {};
+        if (collectiveFile_.rank() == 0 && section.size >= entityHeaderSize_)
+            collectiveFile_.readAt(section.offset, header, sizeof(header));
+        collectiveFile_.broadcast(header, sizeof(header));
+        const auto numRecords = decodeBinary_<std::uint64_t>(header);
+        const auto idSize = decodeBinary_<std::uint64_t>(header + sizeof(std::uint64_t));
+        const auto recordSize = decodeBinary_<std::uint64_t>(header + 2*sizeof(std::uint64_t));
+        if (idSize != sizeof(IdType)
+            || numRecords > static_cast<std::uint64_t>(std::numeric_limits<int>::max())
+            || section.size != entityHeaderSize_ + numRecords*(idSize + recordSize))
+            throw std::runtime_error("Restart file '"+fileName_+"' is corrupted");
+
+        const std::uint64_t idsPos = section.offset + entityHeaderSize_;
+        const std::uint64_t recordsPos = idsPos + numRecords*idSize;
+        std::vector<IdType> fileIds(numRecords);
+        if (collectiveFile_.rank() == 0)
+            collectiveFile_.readAt(idsPos, fileIds.data(), numRecords*idSize);
+        collectiveFile_.broadcast(fileIds.data(), numRecords*idSize);
+
+        std::vector<int> order(numRecords);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(),
+                  [&fileIds](int a, int b) { return fileIds[a] < fileIds[b]; });
+
+        // find the records of the local entities
+        std::vector<int> entityRecords;
+        std::uint64_t missing = 0;
+        for (const auto& entity : entities(gridView, Dune::Codim<codim>{})) {
+            const IdType id = idSet.id(entity);
+            auto it = std::lower_bound(order.begin(), order.end(), id,
+                                       [&fileIds](int a, const IdType& b) { return fileIds[a] < b; });
+            if (it == order.end() || !(fileIds[*it] == id)) {
+                missing = 1;
+                entityRecords.push_back(0);
+            }
+            else
+                entityRecords.push_back(*it);
+        }
+        if (collectiveFile_.max(missing))
+            throw std::runtime_error("Restart file '"+fileName_+"' does not contain the data of "
+                                     "all entities of codim "+std::to_string(codim));
+
+        std::vector<int> recordIndices(entityRecords);
+        std::sort(recordIndices.begin(), recordIndices.end());
+        recordIndices.erase(std::unique(recordIndices.begin(), recordIndices.end()), recordIndices.end());
+        std::vector<char> records(recordIndices.size()*recordSize);
+        collectiveFile_.readRecordsAll(recordsPos, recordIndices, recordSize, records.data());
+
+        std::size_t entityIdx = 0;
+        for (const auto& entity : entities(gridView, Dune::Codim<codim>{})) {
+            const auto recordIt = std::lower_bound(recordIndices.begin(), recordIndices.end(),
+                                                   entityRecords[entityIdx++]);
+            const char* record = records.data() + (recordIt - recordIndices.begin())*recordSize;
+            sectionBuf_.setRegion(record, record + recordSize);
+
+            BinaryRestartInStream binaryStream(sectionBuf_);
+            deserializer.deserializeEntity(binaryStream, entity);
+            if (!binaryStream.good())
+                throw std::runtime_error("Restart file is corrupted");
+            if (sectionBuf_.remaining() != 0)
+                throw std::logic_error("Encountered unread values while deserializing");
+        }
+        sectionBuf_.setRegion(nullptr, nullptr);
+    }
+
+    template <class T>
+    T readBinary_(std::uint64_t offset) const
+    {
+        if (offset + sizeof(T) > fileSize_)
+            throw std::runtime_error("Restart file '"+fileName_+"' is corrupted");
+
+        return decodeBinary_<T>(fileData_ + offset);
+    }
+
+    // load a binary restart file and read its table of sections
+    void openBinary_()
+    {
+        unmap_();
+
+#ifdef EWOMS_RESTART_HAVE_MMAP
+        if (useMmap_) {
+            const int fd = ::open(fileName_.c_str(), O_RDONLY);
+            if (fd < 0)
+                throw std::runtime_error("Restart file '"+fileName_+"' could not be opened properly");
+
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                void* addr = ::mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                                    PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr != MAP_FAILED) {
+                    fileData_ = static_cast<const char*>(addr);
+                    fileSize_ = static_cast<std::size_t>(st.st_size);
+                    mapped_ = true;
+                }
+            }
+            ::close(fd);
+        }
+#endif
+
+        if (!mapped_) {
+            std::ifstream file(fileName_.c_str(), std::ios::binary);
+            if (!file.good())
+                throw std::runtime_error("Restart file '"+fileName_+"' could not be opened properly");
+            fileBuffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            fileData_ = fileBuffer_.data();
+            fileSize_ = fileBuffer_.size();
+        }
+
+        if (fileSize_ == 0)
+            throw std::runtime_error("Restart file '"+fileName_+"' is empty");
+
+        const std::size_t magicSize = sizeof(binaryMagic_) - 1;
+        if (fileSize_ < magicSize + sizeof(std::uint32_t) + sizeof(std::uint64_t)
+            || std::memcmp(fileData_, binaryMagic_, magicSize) != 0)
+            throw std::runtime_error("Restart file '"+fileName_+"' is not a binary restart file");
+        if (readBinary_<std::uint32_t>(magicSize) != binaryVersion_)
+            throw std::runtime_error("Restart file '"+fileName_+"' has an unsupported version");
+
+        const std::uint64_t tableEnd = fileSize_ - sizeof(std::uint64_t);
+        const std::uint64_t tablePos = readBinary_<std::uint64_t>(tableEnd);
+        if (tablePos > tableEnd)
+            throw std::runtime_error("Restart file '"+fileName_+"' is corrupted");
+        readSectionTable_(fileData_ + tablePos, tableEnd - tablePos, fileSize_);
+    }
+
+    void unmap_()
+    {
+#ifdef EWOMS_RESTART_HAVE_MMAP
+        if (mapped_)
+            ::munmap(const_cast<char*>(fileData_), fileSize_);
+#endif
+        mapped_ = false;
+        fileBuffer_.clear();
+        fileData_ = nullptr;
+        fileSize_ = 0;
+        sectionBuf_.setRegion(nullptr, nullptr);
+    }
+
+    Format format_;
+    bool useMmap_;
+
     std::string fileName_;
     std::ifstream inStream_;
-    std::ofstream outStream_;
+    std::filebuf fileBuf_;
+    StagingBuf stagingBuf_;
+    std::ostream outStream_{nullptr};
+    bool staged_ = false;
+
+    // the state of the binary format
+    std::vector<SectionEntry> sections_;
+    std::streampos sectionSizePos_;
+    std::size_t nextSectionIdx_ = 0;
+    const char* fileData_ = nullptr;
+    std::size_t fileSize_ = 0;
+    bool mapped_ = false;
+    std::vector<char> fileBuffer_;
+    MemoryStreamBuf sectionBuf_;
+    std::istream sectionStream_;
+
+    // the state of the collective format
+    CollectiveFile collectiveFile_;
+    std::uint64_t filePos_ = 0;
+    std::string sectionCookie_;
+    std::ostringstream sectionOut_;
+    std::vector<char> sectionData_;
 };
 } // namespace Opm
 
@@ -0,0 +1,711 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::SharedMemoryWriter
+ */
+#ifndef EWOMS_SHARED_MEMORY_WRITER_HH
+#define EWOMS_SHARED_MEMORY_WRITER_HH
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define EWOMS_HAVE_SHARED_MEMORY_OUTPUT 1
+#endif
+
+#include "baseoutputwriter.hh"
+
+#include <opm/models/utils/regionprofiler.hh>
+
+#include <dune/common/version.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/grid/common/partitionset.hh>
+#include <dune/grid/common/rangegenerators.hh>
+#include <dune/grid/io/file/vtk/common.hh>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief The layout of the shared memory segments which are written by
+ *        Opm::SharedMemoryWriter.
+ *
+ * A segment starts with a Header which is followed by a ring buffer of frames. The
+ * positions of the frames are logical byte offsets which grow monotonically, the
+ * physical position of a frame within the ring buffer is its logical position modulo
+ * the capacity. Each frame starts with a FrameHeader, is contiguous and its size is a
+ * multiple of frameAlignment. If the space left at the end of the ring buffer does not
+ * suffice for a frame, a padding frame is written and the frame starts at the
+ * beginning of the ring buffer.
+ *
+ * Before the writer modifies any data, it advances 'reserved' to the end of the new
+ * frame, after the frame is complete it advances 'committed'. Thus a frame which has
+ * been copied by a reader is valid if 'reserved' minus the frame's position does not
+ * exceed the capacity after the copy, otherwise the writer has overwritten it in the
+ * meantime and the reader must continue with a newer frame.
+ */
+namespace SharedMemoryOutput {
+
+static constexpr char magic[8] = { 'O', 'P', 'M', 'S', 'H', 'M', '0', '1' };
+static constexpr std::size_t frameAlignment = 16;
+
+enum FrameType : std::uint32_t {
+    //! The remainder of the ring buffer is unused
+    PaddingFrame = 0,
+
+    /*!
+     * \brief The interior cells of the process
+     *
+     * uint32 dimWorld, uint32 unused, uint64 numPoints, uint64 numCells,
+     * double points[numPoints*dimWorld], uint8 vtkCellTypes[numCells] padded to 8
+     * bytes, uint64 cellOffsets[numCells + 1], uint64 connectivity[cellOffsets[numCells]]
+     *
+     * The corners of the cells are numbered like by VTK.
+     */
+    GridFrame = 1,
+
+    /*!
+     * \brief The output fields of a time step
+     *
+     * double time, uint64 gridIndex, uint64 numFields, followed by the fields. Each
+     * field consists of uint32 cellCentered, uint32 numComponents, uint64 nameLength,
+     * the name padded to 8 bytes and double values[numComponents*numEntities], where
+     * numEntities is the number of points or cells of the grid. Tensors are stored
+     * row by row.
+     */
+    FieldsFrame = 2
+};
+
+struct Header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint64_t capacity;
+    std::atomic<std::uint64_t> reserved;
+    std::atomic<std::uint64_t> committed;
+    //! The number of grid frames written so far
+    std::atomic<std::uint64_t> numGrids;
+    //! The position of the most recent grid frame
+    std::atomic<std::uint64_t> gridFramePos;
+    //! Set to 1 when the simulation will not write any further frames
+    std::atomic<std::uint32_t> finished;
+};
+
+struct FrameHeader
+{
+    //! The size of the frame including this header
+    std::uint64_t size;
+    std::uint32_t type;
+    std::uint32_t unused;
+};
+
+static constexpr std::size_t headerSize =
+    (sizeof(Header) + frameAlignment - 1)/frameAlignment*frameAlignment;
+
+inline std::size_t align(std::size_t size, std::size_t alignment = frameAlignment)
+{ return (size + alignment - 1)/alignment*alignment; }
+
+} // namespace SharedMemoryOutput
+
+/*!
+ * \brief Streams the output of a simulation into shared memory so that it can be
+ *        visualized or analyzed by another process while the simulation is running.
+ *
+ * Each process writes into its own POSIX shared memory segment named
+ * "/$SIMNAME-$RANK". The segment is a ring buffer of frames whose layout is described
+ * in Opm::SharedMemoryOutput: When the output of the first time step is written and
+ * after each change of the grid, a frame with the interior cells of the process is
+ * written. It is followed by a frame with the fields of each time step. The writer
+ * never waits for its readers, i.e., readers which are too slow miss frames. The
+ * segment is removed when the writer is destroyed.
+ *
+ * Opm::SharedMemoryReader can be used to read the frames of a segment.
+ */
+template <class GridView>
+class SharedMemoryWriter : public BaseOutputWriter
+{
+    enum { dim = GridView::dimension };
+    enum { dimWorld = GridView::dimensionworld };
+
+    using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+
+    struct Field
+    {
+        std::string name;
+        bool cellCentered;
+        const ScalarBuffer* scalars;
+        const VectorBuffer* vectors;
+        const TensorBuffer* tensors;
+    };
+
+public:
+    using Scalar = BaseOutputWriter::Scalar;
+    using Vector = BaseOutputWriter::Vector;
+    using Tensor = BaseOutputWriter::Tensor;
+    using ScalarBuffer = BaseOutputWriter::ScalarBuffer;
+    using VectorBuffer = BaseOutputWriter::VectorBuffer;
+    using TensorBuffer = BaseOutputWriter::TensorBuffer;
+
+    /*!
+     * \brief Create a writer.
+     *
+     * \param capacity The size of the ring buffer in bytes. The frames of a time step
+     *                 must not exceed it.
+     */
+    SharedMemoryWriter(const GridView& gridView,
+                       const std::string& simName,
+                       std::size_t capacity)
+        : gridView_(gridView)
+        , elementMapper_(gridView, Dune::mcmgElementLayout())
+        , vertexMapper_(gridView, Dune::mcmgVertexLayout())
+    {
+        segmentName_ = "/" + (simName.empty() ? std::string("sim") : simName)
+            + "-" + std::to_string(gridView.comm().rank());
+        capacity_ = SharedMemoryOutput::align(capacity);
+        mapSegment_();
+    }
+
+    SharedMemoryWriter(const SharedMemoryWriter&) = delete;
+    SharedMemoryWriter& operator=(const SharedMemoryWriter&) = delete;
+
+    ~SharedMemoryWriter()
+    {
+#if EWOMS_HAVE_SHARED_MEMORY_OUTPUT
+        header_()->finished.store(1, std::memory_order_release);
+        munmap(segment_, SharedMemoryOutput::headerSize + capacity_);
+        shm_unlink(segmentName_.c_str());
+#endif
+    }
+
+    /*!
+     * \brief The name of the shared memory segment of the local process.
+     */
+    const std::string& segmentName() const
+    { return segmentName_; }
+
+    /*!
+     * \brief Update the internal data structures after the grid was changed.
+     *
+     * If the grid changes between two calls of beginWrite(), this method _must_ be
+     * called before the second beginWrite()!
+     */
+    void gridChanged()
+    {
+        geometryValid_ = false;
+
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2, 8)
+        elementMapper_.update(gridView_);
+        vertexMapper_.update(gridView_);
+#else
+        elementMapper_.update();
+        vertexMapper_.update();
+#endif
+    }
+
+    /*!
+     * \brief Called whenever a new time step must be written.
+     */
+    void beginWrite(double t) override
+    {
+        curTime_ = t;
+        fields_.clear();
+        if (!geometryValid_) {
+            updateGeometry_();
+            writeGridFrame_();
+        }
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachScalarVertexData
+     */
+    void attachScalarVertexData(ScalarBuffer& buf, std::string name) override
+    { fields_.push_back({name, /*cellCentered=*/false, &buf, nullptr, nullptr}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachScalarElementData
+     */
+    void attachScalarElementData(ScalarBuffer& buf, std::string name) override
+    { fields_.push_back({name, /*cellCentered=*/true, &buf, nullptr, nullptr}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachVectorVertexData
+     */
+    void attachVectorVertexData(VectorBuffer& buf, std::string name) override
+    { fields_.push_back({name, /*cellCentered=*/false, nullptr, &buf, nullptr}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachVectorElementData
+     */
+    void attachVectorElementData(VectorBuffer& buf, std::string name) override
+    { fields_.push_back({name, /*cellCentered=*/true, nullptr, &buf, nullptr}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachTensorVertexData
+     */
+    void attachTensorVertexData(TensorBuffer& buf, std::string name) override
+    { fields_.push_back({name, /*cellCentered=*/false, nullptr, nullptr, &buf}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachTensorElementData
+     */
+    void attachTensorElementData(TensorBuffer& buf, std::string name) override
+    { fields_.push_back({name, /*cellCentered=*/true, nullptr, nullptr, &buf}); }
+
+    /*!
+     * \brief Finalizes the current time step.
+     *
+     * The attached fields are copied into the shared memory segment, except if the
+     * onlyDiscard argument is true. The buffers of the fields must stay valid until
+     * this method is called.
+     */
+    void endWrite(bool onlyDiscard = false) override
+    {
+        EWOMS_PROFILE_REGION("shared memory output");
+
+        if (!onlyDiscard)
+            writeFieldsFrame_();
+        fields_.clear();
+    }
+
+private:
+    void mapSegment_()
+    {
+#if EWOMS_HAVE_SHARED_MEMORY_OUTPUT
+        const std::size_t segmentSize = SharedMemoryOutput::headerSize + capacity_;
+        shm_unlink(segmentName_.c_str());
+        const int fd = shm_open(segmentName_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0)
+            throw std::runtime_error("Could not create the shared memory segment '" + segmentName_ + "'");
+        if (ftruncate(fd, static_cast<off_t>(segmentSize)) != 0) {
+            close(fd);
+            shm_unlink(segmentName_.c_str());
+            throw std::runtime_error("Could not allocate " + std::to_string(segmentSize)
+                                     + " bytes for the shared memory segment '" + segmentName_ + "'");
+        }
+        void* addr = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED) {
+            shm_unlink(segmentName_.c_str());
+            throw std::runtime_error("Could not map the shared memory segment '" + segmentName_ + "'");
+        }
+        segment_ = static_cast<char*>(addr);
+
+        auto* header = new (segment_) SharedMemoryOutput::Header;
+        header->version = 1;
+        header->headerSize = static_cast<std::uint32_t>(SharedMemoryOutput::headerSize);
+        header->capacity = capacity_;
+        header->reserved.store(0, std::memory_order_relaxed);
+        header->committed.store(0, std::memory_order_relaxed);
+        header->numGrids.store(0, std::memory_order_relaxed);
+        header->gridFramePos.store(0, std::memory_order_relaxed);
+        header->finished.store(0, std::memory_order_relaxed);
+        // the magic is written last so that readers never see a partial header
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header->magic, SharedMemoryOutput::magic, sizeof(header->magic));
+#else
+        throw std::runtime_error("Shared memory output is not supported on this platform");
+#endif
+    }
+
+    SharedMemoryOutput::Header* header_() const
+    { return reinterpret_cast<SharedMemoryOutput::Header*>(segment_); }
+
+    void updateGeometry_()
+    {
+        pointIndex_.assign(vertexMapper_.size(), -1);
+        pointVertexIndex_.clear();
+        cellElementIndex_.clear();
+        points_.clear();
+        cellTypes_.clear();
+        cellOffsets_.assign(1, 0);
+        connectivity_.clear();
+
+        std::uint64_t numPoints = 0;
+        for (const auto& elem : elements(gridView_, Dune::Partitions::interior)) {
+            const auto type = elem.type();
+            const auto& geometry = elem.geometry();
+            const int numCorners = geometry.corners();
+
+            cellElementIndex_.push_back(static_cast<std::size_t>(elementMapper_.index(elem)));
+            cellTypes_.push_back(static_cast<std::uint8_t>(Dune::VTK::geometryType(type)));
+            for (int vtkCornerIdx = 0; vtkCornerIdx < numCorners; ++vtkCornerIdx) {
+                const int cornerIdx = Dune::VTK::renumber(type, vtkCornerIdx);
+                const auto vertexIdx = vertexMapper_.subIndex(elem, cornerIdx, /*codim=*/dim);
+                auto& pointIdx = pointIndex_[vertexIdx];
+                if (pointIdx < 0) {
+                    pointIdx = static_cast<std::int64_t>(numPoints++);
+                    pointVertexIndex_.push_back(static_cast<std::size_t>(vertexIdx));
+                    const auto& pos = geometry.corner(cornerIdx);
+                    for (int i = 0; i < dimWorld; ++i)
+                        points_.push_back(static_cast<double>(pos[i]));
+                }
+                connectivity_.push_back(static_cast<std::uint64_t>(pointIdx));
+            }
+            cellOffsets_.push_back(connectivity_.size());
+        }
+
+        geometryValid_ = true;
+    }
+
+    std::size_t numPoints_() const
+    { return pointVertexIndex_.size(); }
+
+    std::size_t numCells_() const
+    { return cellElementIndex_.size(); }
+
+    // reserve space for a frame in the ring buffer and return a pointer to its payload
+    char* beginFrame_(SharedMemoryOutput::FrameType type, std::size_t payloadSize)
+    {
+        const std::size_t frameSize =
+            SharedMemoryOutput::align(sizeof(SharedMemoryOutput::FrameHeader) + payloadSize);
+        if (frameSize > capacity_)
+            throw std::runtime_error("A frame of the shared memory output needs "
+                                     + std::to_string(frameSize) + " bytes, but the segment '"
+                                     + segmentName_ + "' only has a capacity of "
+                                     + std::to_string(capacity_) + " bytes");
+
+        auto* header = header_();
+        std::uint64_t pos = header->committed.load(std::memory_order_relaxed);
+        const std::size_t remaining = capacity_ - pos % capacity_;
+        if (remaining < frameSize) {
+            // skip the remainder of the ring buffer
+            header->reserved.store(pos + remaining, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            auto* padding = reinterpret_cast<SharedMemoryOutput::FrameHeader*>(data_(pos));
+            padding->size = remaining;
+            padding->type = SharedMemoryOutput::PaddingFrame;
+            padding->unused = 0;
+            pos += remaining;
+            header->committed.store(pos, std::memory_order_release);
+        }
+
+        header->reserved.store(pos + frameSize, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        auto* frameHeader = reinterpret_cast<SharedMemoryOutput::FrameHeader*>(data_(pos));
+        frameHeader->size = frameSize;
+        frameHeader->type = type;
+        frameHeader->unused = 0;
+        framePos_ = pos;
+        return reinterpret_cast<char*>(frameHeader + 1);
+    }
+
+    void endFrame_()
+    {
+        const auto* frameHeader = reinterpret_cast<SharedMemoryOutput::FrameHeader*>(data_(framePos_));
+        header_()->committed.store(framePos_ + frameHeader->size, std::memory_order_release);
+    }
+
+    char* data_(std::uint64_t pos) const
+    { return segment_ + SharedMemoryOutput::headerSize + pos % capacity_; }
+
+    template <class T>
+    static char* put_(char* dest, const T& value)
+    {
+        std::memcpy(dest, &value, sizeof(T));
+        return dest + sizeof(T);
+    }
+
+    template <class T>
+    static char* putArray_(char* dest, const std::vector<T>& values)
+    {
+        if (!values.empty())
+            std::memcpy(dest, values.data(), values.size()*sizeof(T));
+        return dest + values.size()*sizeof(T);
+    }
+
+    void writeGridFrame_()
+    {
+        const std::size_t payloadSize =
+            2*sizeof(std::uint32_t)
+            + 2*sizeof(std::uint64_t)
+            + points_.size()*sizeof(double)
+            + SharedMemoryOutput::align(cellTypes_.size(), sizeof(std::uint64_t))
+            + cellOffsets_.size()*sizeof(std::uint64_t)
+            + connectivity_.size()*sizeof(std::uint64_t);
+
+        char* dest = beginFrame_(SharedMemoryOutput::GridFrame, payloadSize);
+        dest = put_(dest, static_cast<std::uint32_t>(dimWorld));
+        dest = put_(dest, std::uint32_t(0));
+        dest = put_(dest, static_cast<std::uint64_t>(numPoints_()));
+        dest = put_(dest, static_cast<std::uint64_t>(numCells_()));
+        dest = putArray_(dest, points_);
+        std::memset(putArray_(dest, cellTypes_), 0,
+                    SharedMemoryOutput::align(cellTypes_.size(), sizeof(std::uint64_t)) - cellTypes_.size());
+        dest += SharedMemoryOutput::align(cellTypes_.size(), sizeof(std::uint64_t));
+        dest = putArray_(dest, cellOffsets_);
+        putArray_(dest, connectivity_);
+        endFrame_();
+
+        header_()->gridFramePos.store(framePos_, std::memory_order_relaxed);
+        header_()->numGrids.fetch_add(1, std::memory_order_release);
+        ++gridIndex_;
+    }
+
+    std::size_t numComponents_(const Field& field) const
+    {
+        if (field.scalars)
+            return 1;
+
+        const std::size_t entityIdx = field.cellCentered
+            ? (numCells_() > 0 ? cellElementIndex_[0] : 0)
+            : (numPoints_() > 0 ? pointVertexIndex_[0] : 0);
+        if (field.vectors)
+            return field.vectors->empty() ? 0 : (*field.vectors)[entityIdx].size();
+        if (field.tensors->empty())
+            return 0;
+        const auto& tensor = (*field.tensors)[entityIdx];
+        return tensor.N()*tensor.M();
+    }
+
+    void writeFieldsFrame_()
+    {
+        std::vector<std::size_t> numComponents(fields_.size());
+        std::size_t payloadSize = sizeof(double) + 2*sizeof(std::uint64_t);
+        for (std::size_t fieldIdx = 0; fieldIdx < fields_.size(); ++fieldIdx) {
+            const auto& field = fields_[fieldIdx];
+            numComponents[fieldIdx] = numComponents_(field);
+            const std::size_t numEntities = field.cellCentered ? numCells_() : numPoints_();
+            payloadSize +=
+                2*sizeof(std::uint32_t) + sizeof(std::uint64_t)
+                + SharedMemoryOutput::align(field.name.size(), sizeof(std::uint64_t))
+                + numComponents[fieldIdx]*numEntities*sizeof(double);
+        }
+
+        char* dest = beginFrame_(SharedMemoryOutput::FieldsFrame, payloadSize);
+        dest = put_(dest, curTime_);
+        dest = put_(dest, static_cast<std::uint64_t>(gridIndex_ - 1));
+        dest = put_(dest, static_cast<std::uint64_t>(fields_.size()));
+        for (std::size_t fieldIdx = 0; fieldIdx < fields_.size(); ++fieldIdx) {
+            const auto& field = fields_[fieldIdx];
+            const std::size_t numComps = numComponents[fieldIdx];
+            dest = put_(dest, static_cast<std::uint32_t>(field.cellCentered));
+            dest = put_(dest, static_cast<std::uint32_t>(numComps));
+            dest = put_(dest, static_cast<std::uint64_t>(field.name.size()));
+            const std::size_t paddedNameSize = SharedMemoryOutput::align(field.name.size(), sizeof(std::uint64_t));
+            std::memset(dest, 0, paddedNameSize);
+            std::memcpy(dest, field.name.data(), field.name.size());
+            dest += paddedNameSize;
+
+            const auto& entityIndex = field.cellCentered ? cellElementIndex_ : pointVertexIndex_;
+            double* values = reinterpret_cast<double*>(dest);
+            for (std::size_t i = 0; i < entityIndex.size(); ++i) {
+                const std::size_t idx = entityIndex[i];
+                if (field.scalars)
+                    *values++ = (*field.scalars)[idx];
+                else if (field.vectors) {
+                    const auto& vec = (*field.vectors)[idx];
+                    for (std::size_t compIdx = 0; compIdx < numComps; ++compIdx)
+                        *values++ = compIdx < vec.size() ? vec[compIdx] : 0.0;
+                }
+                else {
+                    const auto& tensor = (*field.tensors)[idx];
+                    for (std::size_t rowIdx = 0; rowIdx < tensor.N(); ++rowIdx)
+                        for (std::size_t colIdx = 0; colIdx < tensor.M(); ++colIdx)
+                            *values++ = tensor[rowIdx][colIdx];
+                }
+            }
+            dest += numComps*entityIndex.size()*sizeof(double);
+        }
+        endFrame_();
+    }
+
+    const GridView gridView_;
+    ElementMapper elementMapper_;
+    VertexMapper vertexMapper_;
+
+    std::string segmentName_;
+    std::size_t capacity_;
+    char* segment_ = nullptr;
+    std::uint64_t framePos_ = 0;
+    std::uint64_t gridIndex_ = 0;
+
+    // the interior cells of the local process
+    bool geometryValid_ = false;
+    std::vector<std::int64_t> pointIndex_;
+    std::vector<std::size_t> pointVertexIndex_;
+    std::vector<std::size_t> cellElementIndex_;
+    std::vector<double> points_;
+    std::vector<std::uint8_t> cellTypes_;
+    std::vector<std::uint64_t> cellOffsets_;
+    std::vector<std::uint64_t> connectivity_;
+
+    double curTime_ = 0.0;
+    std::vector<Field> fields_;
+};
+
+/*!
+ * \brief Reads the frames of a shared memory segment written by
+ *        Opm::SharedMemoryWriter.
+ *
+ * This class does not depend on the grid and is intended to be used by the processes
+ * which visualize or analyze the output of a running simulation.
+ */
+class SharedMemoryReader
+{
+public:
+    /*!
+     * \brief Attach to the segment of a process of a simulation.
+     *
+     * The first frame which is read is the most recent grid frame if it has not been
+     * overwritten yet, otherwise only the frames which are written after the reader
+     * has been attached are read.
+     */
+    explicit SharedMemoryReader(const std::string& segmentName)
+        : segmentName_(segmentName)
+    {
+#if EWOMS_HAVE_SHARED_MEMORY_OUTPUT
+        const int fd = shm_open(segmentName.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            throw std::runtime_error("Could not open the shared memory segment '" + segmentName + "'");
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < SharedMemoryOutput::headerSize) {
+            close(fd);
+            throw std::runtime_error("The shared memory segment '" + segmentName + "' is invalid");
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        void* addr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED)
+            throw std::runtime_error("Could not map the shared memory segment '" + segmentName + "'");
+        segment_ = static_cast<const char*>(addr);
+
+        if (std::memcmp(header_()->magic, SharedMemoryOutput::magic, sizeof(SharedMemoryOutput::magic)) != 0
+            || header_()->version != 1
+            || SharedMemoryOutput::headerSize + header_()->capacity > size_)
+        {
+            munmap(const_cast<char*>(segment_), size_);
+            throw std::runtime_error("The shared memory segment '" + segmentName + "' is invalid");
+        }
+        capacity_ = header_()->capacity;
+        pos_ = header_()->committed.load(std::memory_order_acquire);
+        if (header_()->numGrids.load(std::memory_order_acquire) > 0) {
+            const std::uint64_t gridFramePos = header_()->gridFramePos.load(std::memory_order_relaxed);
+            if (gridFramePos <= pos_ && pos_ - gridFramePos <= capacity_)
+                pos_ = gridFramePos;
+        }
+#else
+        throw std::runtime_error("Shared memory output is not supported on this platform");
+#endif
+    }
+
+    SharedMemoryReader(const SharedMemoryReader&) = delete;
+    SharedMemoryReader& operator=(const SharedMemoryReader&) = delete;
+
+    ~SharedMemoryReader()
+    {
+#if EWOMS_HAVE_SHARED_MEMORY_OUTPUT
+        munmap(const_cast<char*>(segment_), size_);
+#endif
+    }
+
+    /*!
+     * \brief Returns true if the simulation does not write any further frames.
+     */
+    bool finished() const
+    { return header_()->finished.load(std::memory_order_acquire) != 0; }
+
+    /*!
+     * \brief Returns the number of frames which have been missed because the reader
+     *        was too slow.
+     */
+    std::uint64_t numMissedFrames() const
+    { return numMissedFrames_; }
+
+    /*!
+     * \brief Copy the next frame if one is available.
+     *
+     * \param type Set to the type of the frame
+     * \param payload Set to the content of the frame without its header
+     *
+     * \return false if no new frame has been written yet
+     */
+    bool nextFrame(SharedMemoryOutput::FrameType& type, std::vector<char>& payload)
+    {
+        while (true) {
+            const std::uint64_t committed = header_()->committed.load(std::memory_order_acquire);
+            if (pos_ >= committed)
+                return false;
+            if (committed - pos_ > capacity_) {
+                // the writer has overtaken the reader
+                ++numMissedFrames_;
+                pos_ = committed;
+                return false;
+            }
+
+            SharedMemoryOutput::FrameHeader frameHeader;
+            std::memcpy(&frameHeader, data_(pos_), sizeof(frameHeader));
+            const bool plausible = frameHeader.size >= sizeof(frameHeader)
+                && frameHeader.size <= capacity_ - pos_ % capacity_;
+            if (plausible && frameHeader.type != SharedMemoryOutput::PaddingFrame) {
+                payload.resize(frameHeader.size - sizeof(frameHeader));
+                std::memcpy(payload.data(), data_(pos_) + sizeof(frameHeader), payload.size());
+            }
+
+            // make sure that the frame has not been overwritten while it was copied
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const std::uint64_t reserved = header_()->reserved.load(std::memory_order_relaxed);
+            if (!plausible || reserved - pos_ > capacity_) {
+                ++numMissedFrames_;
+                pos_ = header_()->committed.load(std::memory_order_acquire);
+                return false;
+            }
+
+            pos_ += frameHeader.size;
+            if (frameHeader.type != SharedMemoryOutput::PaddingFrame) {
+                type = static_cast<SharedMemoryOutput::FrameType>(frameHeader.type);
+                return true;
+            }
+        }
+    }
+
+private:
+    const SharedMemoryOutput::Header* header_() const
+    { return reinterpret_cast<const SharedMemoryOutput::Header*>(segment_); }
+
+    const char* data_(std::uint64_t pos) const
+    { return segment_ + SharedMemoryOutput::headerSize + pos % capacity_; }
+
+    std::string segmentName_;
+    const char* segment_ = nullptr;
+    std::size_t size_ = 0;
+    std::uint64_t capacity_ = 0;
+    std::uint64_t pos_ = 0;
+    std::uint64_t numMissedFrames_ = 0;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,484 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::StatisticsWriter
+ */
+#ifndef EWOMS_STATISTICS_WRITER_HH
+#define EWOMS_STATISTICS_WRITER_HH
+
+#include "baseoutputwriter.hh"
+
+#include <opm/models/utils/regionprofiler.hh>
+
+#include <dune/common/version.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/grid/common/partitionset.hh>
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Writes statistics of the output fields instead of the fields themselves.
+ *
+ * For each field and region, the total volume, the minimum, the maximum, the
+ * volume-weighted mean and the volume integral of the field are computed over the
+ * interior elements of all processes. Optionally, a histogram of each field is
+ * computed as well. The values of the histogram are the fractions of the volume of
+ * the region for which the field is within a bin, the bins divide the interval
+ * between the minimum and the maximum of the field into equal parts.
+ *
+ * The volume of the elements can be weighted by an additional field, e.g., by the
+ * porosity to get pore volume averages. Similarly, the regions are defined by an
+ * output field whose values are rounded to the nearest integer. Samples with a
+ * negative region index are ignored. Vertex centered fields are evaluated at the
+ * corners of the elements, each of which represents the same fraction of the volume
+ * of the element. For vectorial fields, the statistics of their magnitude are
+ * computed, tensorial fields are ignored.
+ *
+ * The results are written by the first process into the file
+ * "$SIMNAME-statistics.csv" which contains one row for each time step, field and
+ * region.
+ */
+template <class GridView>
+class StatisticsWriter : public BaseOutputWriter
+{
+    using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+
+    struct Field
+    {
+        std::string name;
+        bool vertexCentered;
+        const ScalarBuffer* scalars;
+        const VectorBuffer* vectors;
+
+        double value(std::size_t idx) const
+        { return scalars ? (*scalars)[idx] : (*vectors)[idx].two_norm(); }
+    };
+
+public:
+    using Scalar = BaseOutputWriter::Scalar;
+    using Vector = BaseOutputWriter::Vector;
+    using Tensor = BaseOutputWriter::Tensor;
+    using ScalarBuffer = BaseOutputWriter::ScalarBuffer;
+    using VectorBuffer = BaseOutputWriter::VectorBuffer;
+    using TensorBuffer = BaseOutputWriter::TensorBuffer;
+
+    /*!
+     * \brief Create a writer.
+     *
+     * \param fieldNames The names of the fields for which statistics are computed. If
+     *                   empty, all scalar and vectorial fields are considered.
+     * \param weightField The name of the field by which the volume is weighted. If
+     *                    empty, the plain volume of the elements is used.
+     * \param regionField The name of the field which specifies the region index. If
+     *                    empty, the whole grid is a single region.
+     * \param numHistogramBins The number of bins of the histograms. Zero disables them.
+     */
+    StatisticsWriter(const GridView& gridView,
+                     const std::string& outputDir,
+                     const std::string& simName,
+                     const std::vector<std::string>& fieldNames,
+                     const std::string& weightField = "",
+                     const std::string& regionField = "",
+                     unsigned numHistogramBins = 0)
+        : gridView_(gridView)
+        , elementMapper_(gridView, Dune::mcmgElementLayout())
+        , vertexMapper_(gridView, Dune::mcmgVertexLayout())
+        , fieldNames_(fieldNames)
+        , weightFieldName_(weightField)
+        , regionFieldName_(regionField)
+        , numBins_(numHistogramBins)
+    {
+        fileName_ = (outputDir.empty() ? std::string(".") : outputDir) + "/"
+            + (simName.empty() ? std::string("sim") : simName) + "-statistics.csv";
+    }
+
+    /*!
+     * \brief Update the internal data structures after the grid was changed.
+     */
+    void gridChanged()
+    {
+        geometryValid_ = false;
+
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2, 8)
+        elementMapper_.update(gridView_);
+        vertexMapper_.update(gridView_);
+#else
+        elementMapper_.update();
+        vertexMapper_.update();
+#endif
+    }
+
+    /*!
+     * \brief Called whenever a new time step must be written.
+     */
+    void beginWrite(double t) override
+    {
+        curTime_ = t;
+        fields_.clear();
+        weightField_.reset();
+        regionField_.reset();
+        updateGeometry_();
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachScalarVertexData
+     */
+    void attachScalarVertexData(ScalarBuffer& buf, std::string name) override
+    { attach_({name, /*vertexCentered=*/true, &buf, nullptr}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachScalarElementData
+     */
+    void attachScalarElementData(ScalarBuffer& buf, std::string name) override
+    { attach_({name, /*vertexCentered=*/false, &buf, nullptr}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachVectorVertexData
+     */
+    void attachVectorVertexData(VectorBuffer& buf, std::string name) override
+    { attach_({name, /*vertexCentered=*/true, nullptr, &buf}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachVectorElementData
+     */
+    void attachVectorElementData(VectorBuffer& buf, std::string name) override
+    { attach_({name, /*vertexCentered=*/false, nullptr, &buf}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachTensorVertexData
+     */
+    void attachTensorVertexData(TensorBuffer&, std::string) override
+    {}
+
+    /*!
+     * \copydoc BaseOutputWriter::attachTensorElementData
+     */
+    void attachTensorElementData(TensorBuffer&, std::string) override
+    {}
+
+    /*!
+     * \brief Compute the statistics of the attached fields and append them to the
+     *        output file.
+     *
+     * The buffers of the attached fields must stay valid until this method is called.
+     * It must be called by all processes.
+     */
+    void endWrite(bool onlyDiscard = false) override
+    {
+        EWOMS_PROFILE_REGION("statistics output");
+
+        if (!onlyDiscard) {
+            if (!weightFieldName_.empty() && !weightField_)
+                throw std::runtime_error("The field '" + weightFieldName_ + "' by which the "
+                                         "statistics are weighted is not written");
+            if (!regionFieldName_.empty() && !regionField_)
+                throw std::runtime_error("The field '" + regionFieldName_ + "' which defines "
+                                         "the regions of the statistics is not written");
+
+            computeStatistics_();
+            if (gridView_.comm().rank() == 0)
+                writeStatistics_();
+        }
+
+        fields_.clear();
+        weightField_.reset();
+        regionField_.reset();
+    }
+
+    /*!
+     * \brief Write the writer's state to a restart file.
+     */
+    template <class Restarter>
+    void serialize(Restarter& res)
+    {
+        res.serializeSectionBegin("StatisticsWriter");
+        res.serializeStream() << fileStarted_ << "\n";
+        res.serializeSectionEnd();
+    }
+
+    /*!
+     * \brief Read the writer's state from a restart file.
+     *
+     * If the statistics have already been written before the restart, the existing
+     * file is continued.
+     */
+    template <class Restarter>
+    void deserialize(Restarter& res)
+    {
+        res.deserializeSectionBegin("StatisticsWriter");
+        res.deserializeStream() >> fileStarted_;
+        res.deserializeSectionEnd();
+    }
+
+private:
+    void attach_(const Field& field)
+    {
+        // the weight and region fields do not necessarily belong to the fields for
+        // which statistics are computed
+        if (field.name == weightFieldName_)
+            weightField_ = field;
+        if (field.name == regionFieldName_)
+            regionField_ = field;
+
+        if (!fieldNames_.empty()
+            && std::find(fieldNames_.begin(), fieldNames_.end(), field.name) == fieldNames_.end())
+            return;
+        fields_.push_back(field);
+    }
+
+    void updateGeometry_()
+    {
+        if (geometryValid_)
+            return;
+
+        elements_.clear();
+        volumes_.clear();
+        cornerOffsets_.assign(1, 0);
+        cornerVertices_.clear();
+        for (const auto& elem : elements(gridView_, Dune::Partitions::interior)) {
+            elements_.push_back(static_cast<std::size_t>(elementMapper_.index(elem)));
+            volumes_.push_back(elem.geometry().volume());
+
+            const unsigned numCorners = elem.subEntities(GridView::dimension);
+            for (unsigned cornerIdx = 0; cornerIdx < numCorners; ++cornerIdx)
+                cornerVertices_.push_back(static_cast<std::size_t>(
+                    vertexMapper_.subIndex(elem, static_cast<int>(cornerIdx), GridView::dimension)));
+            cornerOffsets_.push_back(cornerVertices_.size());
+        }
+
+        geometryValid_ = true;
+    }
+
+    // the value of a field for the i-th interior element. if the i-th element is
+    // represented by one of its corners, cornerIdx is the index of this corner in
+    // cornerVertices_, otherwise it is -1.
+    double sampleValue_(const Field& field, std::size_t i, std::ptrdiff_t cornerIdx) const
+    {
+        if (!field.vertexCentered)
+            return field.value(elements_[i]);
+        if (cornerIdx >= 0)
+            return field.value(cornerVertices_[static_cast<std::size_t>(cornerIdx)]);
+
+        double sum = 0.0;
+        for (std::size_t j = cornerOffsets_[i]; j < cornerOffsets_[i + 1]; ++j)
+            sum += field.value(cornerVertices_[j]);
+        return sum/static_cast<double>(cornerOffsets_[i + 1] - cornerOffsets_[i]);
+    }
+
+    // call a function for all samples of a field with the sample's value, weight and
+    // region index
+    template <class Functor>
+    void forEachSample_(const Field& field, Functor&& functor) const
+    {
+        for (std::size_t i = 0; i < elements_.size(); ++i) {
+            const std::size_t cornerBegin = cornerOffsets_[i];
+            const std::size_t cornerEnd = cornerOffsets_[i + 1];
+            const std::size_t numSamples = field.vertexCentered ? cornerEnd - cornerBegin : 1;
+            for (std::size_t sampleIdx = 0; sampleIdx < numSamples; ++sampleIdx) {
+                const std::ptrdiff_t cornerIdx =
+                    field.vertexCentered ? static_cast<std::ptrdiff_t>(cornerBegin + sampleIdx) : -1;
+
+                int regionIdx = 0;
+                if (regionField_)
+                    regionIdx = static_cast<int>(std::lround(sampleValue_(*regionField_, i, cornerIdx)));
+                if (regionIdx < 0)
+                    continue;
+
+                double weight = volumes_[i]/static_cast<double>(numSamples);
+                if (weightField_)
+                    weight *= sampleValue_(*weightField_, i, cornerIdx);
+
+                functor(sampleValue_(field, i, cornerIdx), weight, static_cast<std::size_t>(regionIdx));
+            }
+        }
+    }
+
+    void computeStatistics_()
+    {
+        const auto& comm = gridView_.comm();
+
+        // determine the number of regions
+        int maxRegionIdx = 0;
+        if (regionField_) {
+            for (std::size_t i = 0; i < elements_.size(); ++i) {
+                const std::size_t numSamples =
+                    regionField_->vertexCentered ? cornerOffsets_[i + 1] - cornerOffsets_[i] : 1;
+                for (std::size_t sampleIdx = 0; sampleIdx < numSamples; ++sampleIdx) {
+                    const std::ptrdiff_t cornerIdx = regionField_->vertexCentered
+                        ? static_cast<std::ptrdiff_t>(cornerOffsets_[i] + sampleIdx) : -1;
+                    const double regionValue = sampleValue_(*regionField_, i, cornerIdx);
+                    maxRegionIdx = std::max(maxRegionIdx, static_cast<int>(std::lround(regionValue)));
+                }
+            }
+            maxRegionIdx = comm.max(maxRegionIdx);
+        }
+        numRegions_ = static_cast<std::size_t>(maxRegionIdx) + 1;
+
+        const std::size_t n = fields_.size()*numRegions_;
+        volume_.assign(n, 0.0);
+        integral_.assign(n, 0.0);
+        min_.assign(n, std::numeric_limits<double>::max());
+        max_.assign(n, std::numeric_limits<double>::lowest());
+
+        // the fields are processed concurrently, each thread only touches the
+        // entries of its own fields
+        const int numFields = static_cast<int>(fields_.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int fieldIdx = 0; fieldIdx < numFields; ++fieldIdx) {
+            const std::size_t offset = static_cast<std::size_t>(fieldIdx)*numRegions_;
+            forEachSample_(fields_[static_cast<std::size_t>(fieldIdx)],
+                           [&](double value, double weight, std::size_t regionIdx)
+                           {
+                               const std::size_t idx = offset + regionIdx;
+                               volume_[idx] += weight;
+                               integral_[idx] += weight*value;
+                               min_[idx] = std::min(min_[idx], value);
+                               max_[idx] = std::max(max_[idx], value);
+                           });
+        }
+
+        if (n > 0) {
+            comm.sum(volume_.data(), static_cast<int>(n));
+            comm.sum(integral_.data(), static_cast<int>(n));
+            comm.min(min_.data(), static_cast<int>(n));
+            comm.max(max_.data(), static_cast<int>(n));
+        }
+
+        histogram_.assign(n*numBins_, 0.0);
+        if (numBins_ == 0 || n == 0)
+            return;
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int fieldIdx = 0; fieldIdx < numFields; ++fieldIdx) {
+            const std::size_t offset = static_cast<std::size_t>(fieldIdx)*numRegions_;
+            forEachSample_(fields_[static_cast<std::size_t>(fieldIdx)],
+                           [&](double value, double weight, std::size_t regionIdx)
+                           {
+                               const std::size_t idx = offset + regionIdx;
+                               const double range = max_[idx] - min_[idx];
+                               std::size_t binIdx = 0;
+                               if (range > 0.0)
+                                   binIdx = std::min(static_cast<std::size_t>((value - min_[idx])/range*numBins_),
+                                                     std::size_t(numBins_ - 1));
+                               histogram_[idx*numBins_ + binIdx] += weight;
+                           });
+        }
+
+        comm.sum(histogram_.data(), static_cast<int>(histogram_.size()));
+    }
+
+    void writeStatistics_()
+    {
+        std::ofstream file;
+        if (fileStarted_)
+            file.open(fileName_, std::ios::out | std::ios::app);
+        else {
+            file.open(fileName_, std::ios::out | std::ios::trunc);
+            file << "time,field,region,volume,min,max,mean,integral";
+            for (unsigned binIdx = 0; binIdx < numBins_; ++binIdx)
+                file << ",bin" << binIdx;
+            file << "\n";
+        }
+        if (!file.good())
+            throw std::runtime_error("Could not write file '" + fileName_ + "'");
+
+        file << std::setprecision(std::numeric_limits<double>::digits10 + 1);
+        for (std::size_t fieldIdx = 0; fieldIdx < fields_.size(); ++fieldIdx) {
+            for (std::size_t regionIdx = 0; regionIdx < numRegions_; ++regionIdx) {
+                const std::size_t idx = fieldIdx*numRegions_ + regionIdx;
+                // regions which are not covered by any sample are not written
+                if (min_[idx] > max_[idx])
+                    continue;
+
+                const double mean = volume_[idx] != 0.0 ? integral_[idx]/volume_[idx] : 0.0;
+                file << curTime_ << "," << fields_[fieldIdx].name << "," << regionIdx << ","
+                     << volume_[idx] << "," << min_[idx] << "," << max_[idx] << ","
+                     << mean << "," << integral_[idx];
+                for (unsigned binIdx = 0; binIdx < numBins_; ++binIdx) {
+                    const double binVolume = histogram_[idx*numBins_ + binIdx];
+                    file << "," << (volume_[idx] != 0.0 ? binVolume/volume_[idx] : 0.0);
+                }
+                file << "\n";
+            }
+        }
+
+        file.close();
+        if (file.fail())
+            throw std::runtime_error("Could not write file '" + fileName_ + "'");
+        fileStarted_ = true;
+    }
+
+    const GridView gridView_;
+    ElementMapper elementMapper_;
+    VertexMapper vertexMapper_;
+
+    std::string fileName_;
+    std::vector<std::string> fieldNames_;
+    std::string weightFieldName_;
+    std::string regionFieldName_;
+    unsigned numBins_;
+    bool fileStarted_ = false;
+
+    // the interior elements of the local process
+    bool geometryValid_ = false;
+    std::vector<std::size_t> elements_;
+    std::vector<double> volumes_;
+    std::vector<std::size_t> cornerOffsets_;
+    std::vector<std::size_t> cornerVertices_;
+
+    double curTime_ = 0.0;
+    std::vector<Field> fields_;
+    std::optional<Field> weightField_;
+    std::optional<Field> regionField_;
+
+    // the statistics of each field and region
+    std::size_t numRegions_ = 1;
+    std::vector<double> volume_;
+    std::vector<double> integral_;
+    std::vector<double> min_;
+    std::vector<double> max_;
+    std::vector<double> histogram_;
+};
+
+} // namespace Opm
+
+#endif
@@ -32,16 +32,17 @@
 #include <opm/models/utils/parametersystem.hh>
 
 #include <dune/grid/yaspgrid.hh>
-#include <dune/grid/io/file/dgfparser/dgfyasp.hh>
+#include <dune/grid/utility/structuredgridfactory.hh>
 
 #if HAVE_DUNE_ALUGRID
 #include <dune/alugrid/grid.hh>
-#include <dune/alugrid/dgf.hh>
+#include <dune/alugrid/common/structuredgridfactory.hh>
 #endif
 
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <array>
 #include <vector>
 #include <memory>
 
@@ -129,13 +130,18 @@ public:
 
     /*!
      * \brief Create the grid for the lens problem
+     *
+     * The grid is created by the structured grid factory of the grid implementation.
+     * For YaspGrid and ALUGrid, this lets each process create its own partition of the
+     * grid (plus the overlap) directly, i.e., the grid is neither created on a single
+     * process first nor parsed from a DGF description.
      */
     StructuredGridVanguard(Simulator& simulator)
         : ParentType(simulator)
     {
-        Dune::FieldVector<int, dim> cellRes;
+        std::array<unsigned int, dim> cellRes;
 
-        using GridScalar = double;
+        using GridScalar = typename Grid::ctype;
         Dune::FieldVector<GridScalar, dim> upperRight;
         Dune::FieldVector<GridScalar, dim> lowerLeft( 0 );
 
@@ -149,21 +155,8 @@ public:
             cellRes[2] = Parameters::get<TypeTag, Properties::CellsZ>();
         }
 
-        std::stringstream dgffile;
-        dgffile << "DGF" << std::endl;
-        dgffile << "INTERVAL" << std::endl;
-        dgffile << lowerLeft  << std::endl;
-        dgffile << upperRight << std::endl;
-        dgffile << cellRes    << std::endl;
-        dgffile << "#" << std::endl;
-        dgffile << "GridParameter" << std::endl;
-        dgffile << "overlap 1" << std::endl;
-        dgffile << "#" << std::endl;
-        dgffile << "Simplex" << std::endl;
-        dgffile << "#" << std::endl;
-
-        // use DGF parser to create a grid from interval block
-        gridPtr_.reset( Dune::GridPtr< Grid >( dgffile ).release() );
+        // YaspGrid uses an overlap of one cell by default
+        gridPtr_ = Dune::StructuredGridFactory<Grid>::createCubeGrid(lowerLeft, upperRight, cellRes);
 
         unsigned numRefinements = Parameters::get<TypeTag, Properties::GridGlobalRefinements>();
         gridPtr_->globalRefine(static_cast<int>(numRefinements));
@@ -0,0 +1,732 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::VtkAppendedWriter
+ */
+#ifndef EWOMS_VTK_APPENDED_WRITER_HH
+#define EWOMS_VTK_APPENDED_WRITER_HH
+
+#include <opm/models/io/vtkarrayfunction.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/geometry/referenceelements.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/grid/common/rangegenerators.hh>
+#include <dune/grid/io/file/vtk/common.hh>
+#include <dune/grid/io/file/vtk/function.hh>
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief The value of the VtkOutputFormat property which selects the binary output
+ *        of VtkAppendedWriter.
+ */
+constexpr int vtkCompressedAppendedFormat = 16;
+
+/*!
+ * \brief A group of processes whose VTK pieces are written into a single file by
+ *        the first process of the group.
+ *
+ * The groups either consist of a fixed number of consecutive ranks or of the
+ * processes which share a node. Without MPI, the aggregation is never enabled.
+ */
+class VtkAggregationGroup
+{
+public:
+#if HAVE_MPI
+    using Communicator = MPI_Comm;
+#else
+    using Communicator = int;
+#endif
+
+    VtkAggregationGroup() = default;
+    VtkAggregationGroup(const VtkAggregationGroup&) = delete;
+    VtkAggregationGroup& operator=(const VtkAggregationGroup&) = delete;
+
+    ~VtkAggregationGroup()
+    { reset_(); }
+
+    /*!
+     * \brief Split the processes of a communicator into groups (collective).
+     *
+     * \param comm The communicator of all processes which write VTK pieces
+     * \param groupSize The number of consecutive ranks per group. 0 forms one group
+     *                  per node, 1 disables the aggregation.
+     */
+    void setup(Communicator comm, int groupSize)
+    {
+        reset_();
+#if HAVE_MPI
+        int commRank;
+        int commSize;
+        MPI_Comm_rank(comm, &commRank);
+        MPI_Comm_size(comm, &commSize);
+        if (groupSize == 1 || commSize == 1)
+            return;
+
+        if (groupSize > 1)
+            MPI_Comm_split(comm, commRank/groupSize, commRank, &comm_);
+        else
+            MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, commRank, MPI_INFO_NULL, &comm_);
+        MPI_Comm_rank(comm_, &rank_);
+        MPI_Comm_size(comm_, &size_);
+
+        // number the writers in the order of their ranks
+        int isWriter = (rank_ == 0) ? 1 : 0;
+        int writerIdx = 0;
+        MPI_Exscan(&isWriter, &writerIdx, 1, MPI_INT, MPI_SUM, comm);
+        if (commRank == 0)
+            writerIdx = 0;
+        MPI_Allreduce(&isWriter, &numGroups_, 1, MPI_INT, MPI_SUM, comm);
+        MPI_Bcast(&writerIdx, 1, MPI_INT, 0, comm_);
+        groupIdx_ = writerIdx;
+        enabled_ = true;
+#else
+        static_cast<void>(comm);
+        static_cast<void>(groupSize);
+#endif
+    }
+
+    //! Returns true if the pieces of several processes are combined
+    bool enabled() const
+    { return enabled_; }
+
+    //! Returns true if the local process writes the pieces of its group
+    bool isWriter() const
+    { return rank_ == 0; }
+
+    //! The rank of the local process within its group
+    int rank() const
+    { return rank_; }
+
+    //! The number of processes of the group of the local process
+    int size() const
+    { return size_; }
+
+    //! The index of the group of the local process
+    int groupIndex() const
+    { return groupIdx_; }
+
+    //! The total number of groups, i.e., of the files of a time step
+    int numGroups() const
+    { return numGroups_; }
+
+#if HAVE_MPI
+    //! The communicator of the processes of the group
+    MPI_Comm comm() const
+    { return comm_; }
+#endif
+
+private:
+    void reset_()
+    {
+#if HAVE_MPI
+        if (comm_ != MPI_COMM_NULL) {
+            int finalized = 0;
+            MPI_Finalized(&finalized);
+            if (!finalized)
+                MPI_Comm_free(&comm_);
+            comm_ = MPI_COMM_NULL;
+        }
+#endif
+        enabled_ = false;
+        rank_ = 0;
+        size_ = 1;
+        groupIdx_ = 0;
+        numGroups_ = 1;
+    }
+
+#if HAVE_MPI
+    MPI_Comm comm_ = MPI_COMM_NULL;
+#endif
+    bool enabled_ = false;
+    int rank_ = 0;
+    int size_ = 1;
+    int groupIdx_ = 0;
+    int numGroups_ = 1;
+};
+
+/*!
+ * \brief Writes unstructured grid VTK files in which all arrays are stored as
+ *        compressed binary appended data.
+ *
+ * The writer has the same interface as Dune::VTKWriter for conforming output, as far
+ * as it is used by VtkMultiWriter. In contrast to Dune::VTKWriter, the points and the
+ * cells of the grid are not recomputed for each file: They are encoded once into a
+ * Geometry object which is owned by the caller and which is reused by all subsequent
+ * writers until it is invalidated, i.e., only the attached fields need to be
+ * evaluated and encoded for each time step.
+ *
+ * Fields which are backed by an array indexed by the writer's vertex or element
+ * mapper (cf. VtkArrayFunction) are copied from their arrays in the order of the
+ * points or cells. Only other fields are evaluated for each entity.
+ *
+ * If the module is compiled with zlib, the arrays are compressed using the
+ * vtkZLibDataCompressor format, otherwise they are written as raw binary data.
+ *
+ * In parallel, the pieces of the processes of an aggregation group can be combined
+ * into a single file, see aggregate(). Each piece remains a separate Piece element
+ * of the file, so the points and the cells do not need to be renumbered.
+ */
+template <class GridView>
+class VtkAppendedWriter
+{
+    enum { dim = GridView::dimension };
+    enum { dimWorld = GridView::dimensionworld };
+
+    using ctype = typename GridView::ctype;
+    using Function = Dune::VTKFunction<GridView>;
+    using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using ArrayFunction = VtkArrayFunction<VertexMapper>;
+
+    // the size of the blocks which are compressed independently
+    static constexpr std::size_t blockSize_ = 32768;
+
+    // the maximum number of bytes which are transferred by a single MPI call
+    static constexpr std::size_t maxChunkSize_ = std::size_t(1) << 30;
+
+public:
+    using FunctionPtr = std::shared_ptr<Function>;
+
+    /*!
+     * \brief The encoded points and cells of a grid.
+     */
+    class Geometry
+    {
+    public:
+        /*!
+         * \brief Must be called if the grid changed.
+         */
+        void invalidate()
+        { valid_ = false; }
+
+        bool valid() const
+        { return valid_; }
+
+    private:
+        friend class VtkAppendedWriter;
+
+        bool valid_ = false;
+        std::size_t numPoints_ = 0;
+        std::size_t numCells_ = 0;
+
+        // the index of the point for each vertex of the grid view, or -1 if the
+        // vertex is not part of the output
+        std::vector<std::int64_t> pointIndex_;
+
+        // the vertex index of each point and the element index of each cell
+        std::vector<std::int64_t> pointVertexIndex_;
+        std::vector<std::int64_t> cellElementIndex_;
+
+        std::string points_;
+        std::string connectivity_;
+        std::string offsets_;
+        std::string types_;
+    };
+
+    VtkAppendedWriter(const GridView& gridView,
+                      const VertexMapper& vertexMapper,
+                      const ElementMapper& elementMapper,
+                      Geometry& geometry)
+        : gridView_(gridView)
+        , vertexMapper_(vertexMapper)
+        , elementMapper_(elementMapper)
+        , geometry_(geometry)
+    {}
+
+    /*!
+     * \brief Add a field which is evaluated at the vertices of the grid.
+     */
+    void addVertexData(const FunctionPtr& fn)
+    { vertexData_.push_back(fn); }
+
+    /*!
+     * \brief Add a field which is evaluated at the centers of the cells of the grid.
+     */
+    void addCellData(const FunctionPtr& fn)
+    { cellData_.push_back(fn); }
+
+    /*!
+     * \brief Write the data of the local process to a file.
+     *
+     * The ".vtu" suffix is appended to the given name. The output type is ignored,
+     * it is only accepted for compatibility with Dune::VTKWriter.
+     *
+     * \return The name of the file which has been written.
+     */
+    std::string write(const std::string& name, Dune::VTK::OutputType = Dune::VTK::appendedraw)
+    {
+        const std::string fileName = name + ".vtu";
+        writePieces_(fileName, {encodePiece_()});
+        return fileName;
+    }
+
+    /*!
+     * \brief Encode the piece of the local process and send it to the writer of its
+     *        aggregation group.
+     *
+     * This is collective for the processes of the group and it must be called by a
+     * thread which may communicate. The subsequent call of pwrite() writes the pieces
+     * of the whole group into a single file on the writer and no file on the other
+     * processes.
+     */
+    void aggregate(const VtkAggregationGroup& group)
+    {
+        aggregation_ = &group;
+        aggregatedPieces_.clear();
+
+        std::string piece = encodePiece_();
+#if HAVE_MPI
+        if (!group.isWriter()) {
+            std::uint64_t size = piece.size();
+            MPI_Send(&size, 1, MPI_UINT64_T, 0, /*tag=*/0, group.comm());
+            for (std::size_t pos = 0; pos < piece.size(); pos += maxChunkSize_) {
+                const std::size_t chunkSize = std::min(maxChunkSize_, piece.size() - pos);
+                MPI_Send(piece.data() + pos, static_cast<int>(chunkSize), MPI_BYTE,
+                         0, /*tag=*/0, group.comm());
+            }
+            return;
+        }
+
+        aggregatedPieces_.resize(static_cast<std::size_t>(group.size()));
+        aggregatedPieces_[0] = std::move(piece);
+        for (int rank = 1; rank < group.size(); ++rank) {
+            std::uint64_t size;
+            MPI_Recv(&size, 1, MPI_UINT64_T, rank, /*tag=*/0, group.comm(), MPI_STATUS_IGNORE);
+            auto& dest = aggregatedPieces_[static_cast<std::size_t>(rank)];
+            dest.resize(size);
+            for (std::size_t pos = 0; pos < dest.size(); pos += maxChunkSize_) {
+                const std::size_t chunkSize = std::min(maxChunkSize_, dest.size() - pos);
+                MPI_Recv(dest.data() + pos, static_cast<int>(chunkSize), MPI_BYTE,
+                         rank, /*tag=*/0, group.comm(), MPI_STATUS_IGNORE);
+            }
+        }
+#else
+        aggregatedPieces_.push_back(std::move(piece));
+#endif
+    }
+
+    /*!
+     * \brief Write the data of all processes to a set of files.
+     *
+     * Each process writes its piece and the first process writes a .pvtu file
+     * which references all pieces. The file names use the same scheme as the ones
+     * of Dune::VTKWriter. If the pieces have been aggregated, only the writers of the
+     * groups write a file, which is named as if the group was a single process.
+     *
+     * \return The name of the .pvtu file.
+     */
+    std::string pwrite(const std::string& name,
+                       const std::string& path,
+                       const std::string& extendPath,
+                       Dune::VTK::OutputType = Dune::VTK::appendedraw)
+    {
+        const int commSize = gridView_.comm().size();
+        const int commRank = gridView_.comm().rank();
+
+        std::string piecePath = path;
+        if (!extendPath.empty())
+            piecePath += "/" + extendPath;
+
+        int numPieceFiles = commSize;
+        if (aggregation_) {
+            numPieceFiles = aggregation_->numGroups();
+            if (aggregation_->isWriter())
+                writePieces_(piecePath + "/" + pieceName_(name, numPieceFiles, aggregation_->groupIndex()),
+                             aggregatedPieces_);
+            aggregatedPieces_.clear();
+        }
+        else
+            writePieces_(piecePath + "/" + pieceName_(name, commSize, commRank), {encodePiece_()});
+
+        char buf[16];
+        std::snprintf(buf, sizeof(buf), "s%04d-", commSize);
+        const std::string pvtuName = path + "/" + buf + name + ".pvtu";
+        if (commRank == 0)
+            writeCollection_(pvtuName, name, extendPath, numPieceFiles);
+
+        return pvtuName;
+    }
+
+private:
+    static std::string pieceName_(const std::string& name, int commSize, int commRank)
+    {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "s%04d-p%04d-", commSize, commRank);
+        return buf + name + ".vtu";
+    }
+
+    // VTK pads vectors with less than three components
+    static int numOutputComponents_(const Function& fn)
+    { return (fn.ncomps() > 1 && fn.ncomps() < 3) ? 3 : fn.ncomps(); }
+
+    static const char* byteOrder_()
+    {
+        const std::uint16_t one = 1;
+        return (*reinterpret_cast<const unsigned char*>(&one) == 1) ? "LittleEndian" : "BigEndian";
+    }
+
+    static const char* compressorAttribute_()
+    {
+#if HAVE_ZLIB
+        return " compressor=\"vtkZLibDataCompressor\"";
+#else
+        return "";
+#endif
+    }
+
+    template <class T>
+    static void appendRaw_(std::string& out, const T& value)
+    { out.append(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+    // encode an array including the header which specifies its size
+    template <class T>
+    static std::string encode_(const std::vector<T>& data)
+    {
+        const char* bytes = reinterpret_cast<const char*>(data.data());
+        const std::size_t numBytes = data.size()*sizeof(T);
+
+        std::string out;
+#if HAVE_ZLIB
+        const std::size_t numBlocks = (numBytes + blockSize_ - 1)/blockSize_;
+        const std::size_t lastBlockSize = numBytes - (numBlocks > 0 ? (numBlocks - 1)*blockSize_ : 0);
+
+        std::vector<std::uint64_t> compressedSizes(numBlocks);
+        std::string compressed;
+        std::vector<Bytef> buffer(compressBound(blockSize_));
+        for (std::size_t blockIdx = 0; blockIdx < numBlocks; ++blockIdx) {
+            const std::size_t size = (blockIdx + 1 < numBlocks) ? blockSize_ : lastBlockSize;
+            uLongf compressedSize = static_cast<uLongf>(buffer.size());
+            const int ret = compress2(buffer.data(), &compressedSize,
+                                      reinterpret_cast<const Bytef*>(bytes + blockIdx*blockSize_),
+                                      static_cast<uLong>(size), Z_DEFAULT_COMPRESSION);
+            if (ret != Z_OK)
+                throw std::runtime_error("Compression of VTK data failed");
+
+            compressedSizes[blockIdx] = compressedSize;
+            compressed.append(reinterpret_cast<const char*>(buffer.data()), compressedSize);
+        }
+
+        appendRaw_(out, static_cast<std::uint64_t>(numBlocks));
+        appendRaw_(out, static_cast<std::uint64_t>(blockSize_));
+        appendRaw_(out, static_cast<std::uint64_t>(lastBlockSize));
+        for (std::uint64_t size : compressedSizes)
+            appendRaw_(out, size);
+        out += compressed;
+#else
+        appendRaw_(out, static_cast<std::uint64_t>(numBytes));
+        out.append(bytes, numBytes);
+#endif
+        return out;
+    }
+
+    void updateGeometry_()
+    {
+        if (geometry_.valid_)
+            return;
+
+        auto& geom = geometry_;
+        geom.pointIndex_.assign(vertexMapper_.size(), -1);
+        geom.pointVertexIndex_.clear();
+        geom.cellElementIndex_.clear();
+
+        std::vector<float> points;
+        std::vector<std::int64_t> connectivity;
+        std::vector<std::int64_t> offsets;
+        std::vector<std::uint8_t> types;
+
+        std::size_t numPoints = 0;
+        for (const auto& elem : elements(gridView_, Dune::Partitions::interior)) {
+            const auto type = elem.type();
+            const auto& geometry = elem.geometry();
+            const int numCorners = geometry.corners();
+            for (int vtkCornerIdx = 0; vtkCornerIdx < numCorners; ++vtkCornerIdx) {
+                const int cornerIdx = Dune::VTK::renumber(type, vtkCornerIdx);
+                const auto vertexIdx = vertexMapper_.subIndex(elem, cornerIdx, /*codim=*/dim);
+                auto& pointIdx = geom.pointIndex_[vertexIdx];
+                if (pointIdx < 0) {
+                    pointIdx = static_cast<std::int64_t>(numPoints++);
+                    geom.pointVertexIndex_.push_back(static_cast<std::int64_t>(vertexIdx));
+                    const auto& pos = geometry.corner(cornerIdx);
+                    for (int i = 0; i < 3; ++i)
+                        points.push_back(i < dimWorld ? static_cast<float>(pos[i]) : 0.0f);
+                }
+                connectivity.push_back(pointIdx);
+            }
+            offsets.push_back(static_cast<std::int64_t>(connectivity.size()));
+            geom.cellElementIndex_.push_back(static_cast<std::int64_t>(elementMapper_.index(elem)));
+            types.push_back(static_cast<std::uint8_t>(Dune::VTK::geometryType(type)));
+        }
+
+        geom.numPoints_ = numPoints;
+        geom.numCells_ = offsets.size();
+        geom.points_ = encode_(points);
+        geom.connectivity_ = encode_(connectivity);
+        geom.offsets_ = encode_(offsets);
+        geom.types_ = encode_(types);
+        geom.valid_ = true;
+    }
+
+    std::string encodeVertexData_(const Function& fn) const
+    {
+        const int numComps = fn.ncomps();
+        const int numOutComps = numOutputComponents_(fn);
+        std::vector<float> values(geometry_.numPoints_*numOutComps, 0.0f);
+
+        const auto* arrayFn = dynamic_cast<const ArrayFunction*>(&fn);
+        if (arrayFn && arrayFn->codim() == dim && &arrayFn->mapper() == &vertexMapper_) {
+            arrayFn->gather(values.data(), static_cast<unsigned>(numOutComps),
+                            geometry_.pointVertexIndex_);
+            return encode_(values);
+        }
+
+        std::vector<bool> visited(geometry_.numPoints_, false);
+        for (const auto& elem : elements(gridView_, Dune::Partitions::interior)) {
+            const auto& refElem = Dune::referenceElement<ctype, dim>(elem.type());
+            const int numCorners = refElem.size(dim);
+            for (int cornerIdx = 0; cornerIdx < numCorners; ++cornerIdx) {
+                const auto vertexIdx = vertexMapper_.subIndex(elem, cornerIdx, /*codim=*/dim);
+                const auto pointIdx = static_cast<std::size_t>(geometry_.pointIndex_[vertexIdx]);
+                if (visited[pointIdx])
+                    continue;
+
+                visited[pointIdx] = true;
+                const auto& pos = refElem.position(cornerIdx, dim);
+                for (int compIdx = 0; compIdx < numComps; ++compIdx)
+                    values[pointIdx*numOutComps + compIdx] =
+                        static_cast<float>(fn.evaluate(compIdx, elem, pos));
+            }
+        }
+        return encode_(values);
+    }
+
+    std::string encodeCellData_(const Function& fn) const
+    {
+        const int numComps = fn.ncomps();
+        const int numOutComps = numOutputComponents_(fn);
+        std::vector<float> values(geometry_.numCells_*numOutComps, 0.0f);
+
+        const auto* arrayFn = dynamic_cast<const ArrayFunction*>(&fn);
+        if (arrayFn && arrayFn->codim() == 0 && &arrayFn->mapper() == &elementMapper_) {
+            arrayFn->gather(values.data(), static_cast<unsigned>(numOutComps),
+                            geometry_.cellElementIndex_);
+            return encode_(values);
+        }
+
+        std::size_t cellIdx = 0;
+        for (const auto& elem : elements(gridView_, Dune::Partitions::interior)) {
+            const auto& center = Dune::referenceElement<ctype, dim>(elem.type()).position(0, 0);
+            for (int compIdx = 0; compIdx < numComps; ++compIdx)
+                values[cellIdx*numOutComps + compIdx] =
+                    static_cast<float>(fn.evaluate(compIdx, elem, center));
+            ++cellIdx;
+        }
+        return encode_(values);
+    }
+
+    // encode the arrays of the local piece into a self-contained buffer: the numbers
+    // of points, cells and arrays, the sizes of the arrays and their data. The
+    // arrays are ordered like the DataArray elements of the piece.
+    std::string encodePiece_()
+    {
+        updateGeometry_();
+
+        std::vector<std::string> arrays;
+        for (const auto& fn : vertexData_)
+            arrays.push_back(encodeVertexData_(*fn));
+        for (const auto& fn : cellData_)
+            arrays.push_back(encodeCellData_(*fn));
+
+        std::string piece;
+        appendRaw_(piece, static_cast<std::uint64_t>(geometry_.numPoints_));
+        appendRaw_(piece, static_cast<std::uint64_t>(geometry_.numCells_));
+        appendRaw_(piece, static_cast<std::uint64_t>(arrays.size() + 4));
+        for (const auto& array : arrays)
+            appendRaw_(piece, static_cast<std::uint64_t>(array.size()));
+        for (const std::string* array : {&geometry_.points_, &geometry_.connectivity_,
+                                         &geometry_.offsets_, &geometry_.types_})
+            appendRaw_(piece, static_cast<std::uint64_t>(array->size()));
+        for (const auto& array : arrays)
+            piece += array;
+        piece += geometry_.points_;
+        piece += geometry_.connectivity_;
+        piece += geometry_.offsets_;
+        piece += geometry_.types_;
+        return piece;
+    }
+
+    template <class T>
+    static T readRaw_(const std::string& in, std::size_t& pos)
+    {
+        T value;
+        std::copy_n(in.data() + pos, sizeof(T), reinterpret_cast<char*>(&value));
+        pos += sizeof(T);
+        return value;
+    }
+
+    // write a file which contains one Piece element for each encoded piece
+    void writePieces_(const std::string& fileName, const std::vector<std::string>& pieces) const
+    {
+        std::ostringstream header;
+        std::vector<std::pair<const char*, std::size_t>> appended;
+        std::size_t appendedSize = 0;
+
+        header << "<?xml version=\"1.0\"?>\n"
+               << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\""
+               << byteOrder_() << "\" header_type=\"UInt64\"" << compressorAttribute_() << ">\n"
+               << " <UnstructuredGrid>\n";
+
+        for (const auto& piece : pieces) {
+            std::size_t pos = 0;
+            const auto numPoints = readRaw_<std::uint64_t>(piece, pos);
+            const auto numCells = readRaw_<std::uint64_t>(piece, pos);
+            const auto numArrays = readRaw_<std::uint64_t>(piece, pos);
+            std::size_t dataPos = pos + numArrays*sizeof(std::uint64_t);
+
+            const auto dataArray = [&](const std::string& attributes)
+            {
+                const auto size = static_cast<std::size_t>(readRaw_<std::uint64_t>(piece, pos));
+                header << "     <DataArray " << attributes << " format=\"appended\" offset=\""
+                       << appendedSize << "\"/>\n";
+                appended.emplace_back(piece.data() + dataPos, size);
+                appendedSize += size;
+                dataPos += size;
+            };
+
+            header << "  <Piece NumberOfPoints=\"" << numPoints
+                   << "\" NumberOfCells=\"" << numCells << "\">\n";
+
+            header << "   <PointData>\n";
+            for (const auto& fn : vertexData_)
+                dataArray("type=\"Float32\" Name=\"" + fn->name() + "\" NumberOfComponents=\""
+                          + std::to_string(numOutputComponents_(*fn)) + "\"");
+            header << "   </PointData>\n";
+
+            header << "   <CellData>\n";
+            for (const auto& fn : cellData_)
+                dataArray("type=\"Float32\" Name=\"" + fn->name() + "\" NumberOfComponents=\""
+                          + std::to_string(numOutputComponents_(*fn)) + "\"");
+            header << "   </CellData>\n";
+
+            header << "   <Points>\n";
+            dataArray("type=\"Float32\" Name=\"Coordinates\" NumberOfComponents=\"3\"");
+            header << "   </Points>\n"
+                   << "   <Cells>\n";
+            dataArray("type=\"Int64\" Name=\"connectivity\" NumberOfComponents=\"1\"");
+            dataArray("type=\"Int64\" Name=\"offsets\" NumberOfComponents=\"1\"");
+            dataArray("type=\"UInt8\" Name=\"types\" NumberOfComponents=\"1\"");
+            header << "   </Cells>\n"
+                   << "  </Piece>\n";
+        }
+        header << " </UnstructuredGrid>\n";
+
+        std::ofstream os(fileName, std::ios::binary);
+        if (!os)
+            throw std::runtime_error("Could not open the VTK file '" + fileName + "'");
+
+        os << header.str()
+           << " <AppendedData encoding=\"raw\">\n"
+           << "_";
+        for (const auto& [data, size] : appended)
+            os.write(data, static_cast<std::streamsize>(size));
+        os << "\n </AppendedData>\n"
+           << "</VTKFile>\n";
+    }
+
+    void writeCollection_(const std::string& fileName,
+                          const std::string& name,
+                          const std::string& extendPath,
+                          int numPieceFiles) const
+    {
+        std::ofstream os(fileName);
+        if (!os)
+            throw std::runtime_error("Could not open the VTK file '" + fileName + "'");
+
+        const auto dataArray = [&os](const Function& fn)
+        {
+            os << "   <PDataArray type=\"Float32\" Name=\"" << fn.name()
+               << "\" NumberOfComponents=\"" << numOutputComponents_(fn) << "\"/>\n";
+        };
+
+        os << "<?xml version=\"1.0\"?>\n"
+           << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\""
+           << byteOrder_() << "\" header_type=\"UInt64\"" << compressorAttribute_() << ">\n"
+           << " <PUnstructuredGrid GhostLevel=\"0\">\n"
+           << "  <PPointData>\n";
+        for (const auto& fn : vertexData_)
+            dataArray(*fn);
+        os << "  </PPointData>\n"
+           << "  <PCellData>\n";
+        for (const auto& fn : cellData_)
+            dataArray(*fn);
+        os << "  </PCellData>\n"
+           << "  <PPoints>\n"
+           << "   <PDataArray type=\"Float32\" Name=\"Coordinates\" NumberOfComponents=\"3\"/>\n"
+           << "  </PPoints>\n";
+
+        const std::string prefix = extendPath.empty() ? "" : extendPath + "/";
+        for (int pieceIdx = 0; pieceIdx < numPieceFiles; ++pieceIdx)
+            os << "  <Piece Source=\"" << prefix << pieceName_(name, numPieceFiles, pieceIdx) << "\"/>\n";
+
+        os << " </PUnstructuredGrid>\n"
+           << "</VTKFile>\n";
+    }
+
+    const GridView& gridView_;
+    const VertexMapper& vertexMapper_;
+    const ElementMapper& elementMapper_;
+    Geometry& geometry_;
+
+    std::vector<FunctionPtr> vertexData_;
+    std::vector<FunctionPtr> cellData_;
+
+    // the aggregation group and, on its writer, the encoded pieces of its processes
+    const VtkAggregationGroup* aggregation_ = nullptr;
+    std::vector<std::string> aggregatedPieces_;
+};
+
+} // namespace Opm
+
+#endif
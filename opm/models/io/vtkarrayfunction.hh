@@ -0,0 +1,72 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::VtkArrayFunction
+ */
+#ifndef VTK_ARRAY_FUNCTION_HH
+#define VTK_ARRAY_FUNCTION_HH
+
+#include <cstdint>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Interface of the VTK functions whose values are stored in an array which is
+ *        indexed by a mapper of the grid entities.
+ *
+ * A writer which knows the mapper indices of the points or cells it writes can copy
+ * the values of such a function in bulk instead of evaluating it for each entity.
+ */
+template <class Mapper>
+class VtkArrayFunction
+{
+public:
+    virtual ~VtkArrayFunction() = default;
+
+    /*!
+     * \brief Returns the mapper which is used to index the values.
+     */
+    virtual const Mapper& mapper() const = 0;
+
+    /*!
+     * \brief Returns the codimension of the entities to which the values belong.
+     */
+    virtual unsigned codim() const = 0;
+
+    /*!
+     * \brief Copy the values of a list of entities into an interleaved array.
+     *
+     * The values of the i-th entity of the list are written to
+     * out[i*numOutComps ... i*numOutComps + ncomps() - 1]. The remaining entries are
+     * left alone.
+     */
+    virtual void gather(float* out,
+                        unsigned numOutComps,
+                        const std::vector<std::int64_t>& entityIndices) const = 0;
+};
+
+} // namespace Opm
+
+#endif
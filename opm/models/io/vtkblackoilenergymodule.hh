@@ -89,9 +89,6 @@ class VtkBlackOilEnergyModule : public BaseOutputModule<TypeTag>
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
     using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
 
-    static const int vtkFormat = getPropValue<TypeTag, Properties::VtkOutputFormat>();
-    using VtkMultiWriter = ::Opm::VtkMultiWriter<GridView, vtkFormat>;
-
     enum { enableEnergy = getPropValue<TypeTag, Properties::EnableEnergy>() };
     enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
 
@@ -130,9 +127,6 @@ public:
      */
     void allocBuffers()
     {
-        if (!Parameters::get<TypeTag, Properties::EnableVtkOutput>())
-            return;
-
         if (!enableEnergy)
             return;
 
@@ -152,9 +146,6 @@ public:
      */
     void processElement(const ElementContext& elemCtx)
     {
-        if (!Parameters::get<TypeTag, Properties::EnableVtkOutput>())
-            return;
-
         if (!enableEnergy)
             return;
 
@@ -189,10 +180,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter)
-            return;
-
         if (!enableEnergy)
             return;
 
@@ -92,9 +92,6 @@ class VtkBlackOilMICPModule : public BaseOutputModule<TypeTag>
     using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
 
-    static const int vtkFormat = getPropValue<TypeTag, Properties::VtkOutputFormat>();
-    using VtkMultiWriter = ::Opm::VtkMultiWriter<GridView, vtkFormat>;
-
     enum { enableMICP = getPropValue<TypeTag, Properties::EnableMICP>() };
 
     using ScalarBuffer = typename ParentType::ScalarBuffer;
@@ -134,9 +131,6 @@ public:
      */
     void allocBuffers()
     {
-        if (!Parameters::get<TypeTag, Properties::EnableVtkOutput>())
-            return;
-
         if (!enableMICP)
             return;
 
@@ -158,9 +152,6 @@ public:
      */
     void processElement(const ElementContext& elemCtx)
     {
-        if (!Parameters::get<TypeTag, Properties::EnableVtkOutput>())
-            return;
-
         if (!enableMICP)
             return;
 
@@ -196,10 +187,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter)
-            return;
-
         if (!enableMICP)
             return;
 
@@ -96,9 +96,6 @@ class VtkBlackOilPolymerModule : public BaseOutputModule<TypeTag>
     using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
 
-    static const int vtkFormat = getPropValue<TypeTag, Properties::VtkOutputFormat>();
-    using VtkMultiWriter = ::Opm::VtkMultiWriter<GridView, vtkFormat>;
-
     enum { enablePolymer = getPropValue<TypeTag, Properties::EnablePolymer>() };
 
     using ScalarBuffer = typename ParentType::ScalarBuffer;
@@ -143,9 +140,6 @@ public:
      */
     void allocBuffers()
     {
-        if (!Parameters::get<TypeTag, Properties::EnableVtkOutput>())
-            return;
-
         if (!enablePolymer)
             return;
 
@@ -169,9 +163,6 @@ public:
      */
     void processElement(const ElementContext& elemCtx)
     {
-        if (!Parameters::get<TypeTag, Properties::EnableVtkOutput>())
-            return;
-
         if (!enablePolymer)
             return;
 
@@ -210,10 +201,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter)
-            return;
-
         if (!enablePolymer)
             return;
 
@@ -92,9 +92,6 @@ class VtkBlackOilSolventModule : public BaseOutputModule<TypeTag>
     using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
 
-    static const int vtkFormat = getPropValue<TypeTag, Properties::VtkOutputFormat>();
-    using VtkMultiWriter = ::Opm::VtkMultiWriter<GridView, vtkFormat>;
-
     enum { enableSolvent = getPropValue<TypeTag, Properties::EnableSolvent>() };
 
     using ScalarBuffer = typename ParentType::ScalarBuffer;
@@ -136,9 +133,6 @@ public:
      */
     void allocBuffers()
     {
-        if (!Parameters::get<TypeTag, Properties::EnableVtkOutput>())
-            return;
-
         if (!enableSolvent)
             return;
 
@@ -160,9 +154,6 @@ public:
      */
     void processElement(const ElementContext& elemCtx)
     {
-        if (!Parameters::get<TypeTag, Properties::EnableVtkOutput>())
-            return;
-
         if (!enableSolvent)
             return;
 
@@ -198,10 +189,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter)
-            return;
-
         if (!enableSolvent)
             return;
 
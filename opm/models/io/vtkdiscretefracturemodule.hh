@@ -112,9 +112,6 @@ class VtkDiscreteFractureModule : public BaseOutputModule<TypeTag>
 
     using DiscBaseOutputModule = GetPropType<TypeTag, Properties::DiscBaseOutputModule>;
 
-    static const int vtkFormat = getPropValue<TypeTag, Properties::VtkOutputFormat>();
-    using VtkMultiWriter = Opm::VtkMultiWriter<GridView, vtkFormat>;
-
     enum { dim = GridView::dimension };
     enum { dimWorld = GridView::dimensionworld };
     enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
@@ -190,9 +187,6 @@ public:
      */
     void processElement(const ElementContext& elemCtx)
     {
-        if (!Parameters::get<TypeTag, Properties::EnableVtkOutput>())
-            return;
-
         const auto& fractureMapper = elemCtx.simulator().vanguard().fractureMapper();
 
         for (unsigned i = 0; i < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++i) {
@@ -274,11 +268,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter) {
-            return;
-        }
-
         if (saturationOutput_())
             this->commitPhaseBuffer_(baseWriter, "fractureSaturation_%s", fractureSaturation_);
         if (mobilityOutput_())
@@ -315,6 +304,15 @@ public:
         }
     }
 
+    /*!
+     * \brief The fracture volume fractions and the fracture velocities are accumulated
+     *        over the elements.
+     */
+    bool processElementIsThreadSafe() const final
+    {
+        return !volumeFractionOutput_() && !velocityOutput_();
+    }
+
 private:
     static bool saturationOutput_()
     {
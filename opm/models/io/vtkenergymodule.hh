@@ -94,11 +94,9 @@ class VtkEnergyModule : public BaseOutputModule<TypeTag>
     using ScalarBuffer = typename ParentType::ScalarBuffer;
     using PhaseBuffer = typename ParentType::PhaseBuffer;
 
-    static const int vtkFormat = getPropValue<TypeTag, Properties::VtkOutputFormat>();
     enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
 
     using Toolbox = typename Opm::MathToolbox<Evaluation>;
-    using VtkMultiWriter = Opm::VtkMultiWriter<GridView, vtkFormat>;
 
 public:
     VtkEnergyModule(const Simulator& simulator)
@@ -148,9 +146,6 @@ public:
      */
     void processElement(const ElementContext& elemCtx)
     {
-        if (!Parameters::get<TypeTag, Properties::EnableVtkOutput>())
-            return;
-
         for (unsigned i = 0; i < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++i) {
             unsigned I = elemCtx.globalSpaceIndex(i, /*timeIdx=*/0);
             const auto& intQuants = elemCtx.intensiveQuantities(i, /*timeIdx=*/0);
@@ -175,11 +170,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter) {
-            return;
-        }
-
         if (solidInternalEnergyOutput_())
             this->commitScalarBuffer_(baseWriter, "internalEnergySolid", solidInternalEnergy_);
         if (thermalConductivityOutput_())
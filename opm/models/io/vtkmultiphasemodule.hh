@@ -137,9 +137,6 @@ class VtkMultiPhaseModule : public BaseOutputModule<TypeTag>
     using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
     using DiscBaseOutputModule = GetPropType<TypeTag, Properties::DiscBaseOutputModule>;
 
-    static const int vtkFormat = getPropValue<TypeTag, Properties::VtkOutputFormat>();
-    using VtkMultiWriter = ::Opm::VtkMultiWriter<GridView, vtkFormat>;
-
     enum { dimWorld = GridView::dimensionworld };
     enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
 
@@ -238,9 +235,6 @@ public:
      */
     void processElement(const ElementContext& elemCtx)
     {
-        if (!Parameters::get<TypeTag, Properties::EnableVtkOutput>())
-            return;
-
         const auto& problem = elemCtx.problem();
         for (unsigned i = 0; i < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++i) {
             unsigned I = elemCtx.globalSpaceIndex(i, /*timeIdx=*/0);
@@ -341,10 +335,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter)
-            return;
-
         if (extrusionFactorOutput_())
             this->commitScalarBuffer_(baseWriter, "extrusionFactor", extrusionFactor_);
         if (pressureOutput_())
@@ -415,6 +405,15 @@ public:
         return velocityOutput_() || potentialGradientOutput_();
     }
 
+    /*!
+     * \brief The velocities and the potential gradients are accumulated over the
+     *        faces of the elements.
+     */
+    bool processElementIsThreadSafe() const final
+    {
+        return !velocityOutput_() && !potentialGradientOutput_();
+    }
+
 private:
     static bool extrusionFactorOutput_()
     {
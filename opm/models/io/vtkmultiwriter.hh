@@ -28,12 +28,14 @@
 #ifndef EWOMS_VTK_MULTI_WRITER_HH
 #define EWOMS_VTK_MULTI_WRITER_HH
 
+#include "vtkappendedwriter.hh"
 #include "vtkscalarfunction.hh"
 #include "vtkvectorfunction.hh"
 #include "vtktensorfunction.hh"
 
 #include <opm/models/io/baseoutputwriter.hh>
 #include <opm/models/parallel/tasklets.hh>
+#include <opm/models/utils/regionprofiler.hh>
 
 #include <opm/material/common/Valgrind.hpp>
 
@@ -46,8 +48,14 @@
 #include <mpi.h>
 #endif
 
+#include <algorithm>
+#include <condition_variable>
 #include <filesystem>
 #include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <type_traits>
 #include <string>
 #include <limits>
 #include <sstream>
@@ -60,42 +68,79 @@ namespace Opm {
  * This class automatically keeps the meta file up to date and
  * simplifies writing datasets consisting of multiple files. (i.e.
  * multiple time steps or grid refinements within a time step.)
+ *
+ * If the output is written asynchronously, each call of beginWrite() starts a new
+ * frame which owns the VTK writer and the buffers of the attached fields. A frame is
+ * handed over to the writer threads by endWrite(), so the simulation can continue
+ * while it is written to disk. The number of frames which are in flight at the same
+ * time is bounded by setMaxPendingWrites(); if more than one frame may be in flight,
+ * the buffers which are not managed by the multi-writer are copied when they are
+ * attached, because the output modules reuse them for the next frame.
+ *
+ * The buffers owned by a frame are not freed after it has been written, but are kept
+ * in a pool from which the managed buffers and the copies of later frames are taken.
+ * Since all frames of a grid use buffers of the same sizes, the output of a time step
+ * usually does not allocate any memory. The pool is emptied by gridChanged().
+ *
+ * For the compressed binary format, the pieces of several processes can be combined
+ * into one file per time step by setAggregation(), which reduces the number of files
+ * created by large parallel runs. The pieces are then sent to the writers of their
+ * groups by endWrite(), i.e., by the thread of the simulation, and only the writers
+ * access the file system.
  */
 template <class GridView, int vtkFormat>
 class VtkMultiWriter : public BaseOutputWriter
 {
+    struct Frame;
+
     class WriteDataTasklet : public TaskletInterface
     {
     public:
-        WriteDataTasklet(VtkMultiWriter& multiWriter)
+        WriteDataTasklet(VtkMultiWriter& multiWriter, std::shared_ptr<Frame> frame)
             : multiWriter_(multiWriter)
+            , frame_(std::move(frame))
         { }
 
         void run() final
         {
+            // the name of the file to write into the multi-file for the current time
+            // step. this stays empty if writing the data fails
+            std::string localFileName;
+
+            // make sure that the frame is released even if writing fails, so that
+            // neither the simulation nor the entries of later frames wait for it
+            // forever
+            struct Release
+            {
+                ~Release()
+                { multiWriter.finishFrame_(frame, localFileName); }
+
+                VtkMultiWriter& multiWriter;
+                std::shared_ptr<Frame>& frame;
+                const std::string& localFileName;
+            } release{multiWriter_, frame_, localFileName};
+
             std::string fileName;
             // write the actual data as vtu or vtp (plus the pieces file in the parallel case)
             if (multiWriter_.commSize_ > 1)
-                fileName = multiWriter_.curWriter_->pwrite(/*name=*/multiWriter_.curOutFileName_,
-                                                           /*path=*/multiWriter_.outputDir_,
-                                                           /*extendPath=*/"",
-                                                           static_cast<Dune::VTK::OutputType>(vtkFormat));
+                fileName = frame_->writer->pwrite(/*name=*/frame_->outFileName,
+                                                  /*path=*/multiWriter_.outputDir_,
+                                                  /*extendPath=*/"",
+                                                  static_cast<Dune::VTK::OutputType>(duneVtkFormat));
             else
-                fileName = multiWriter_.curWriter_->write(/*name=*/multiWriter_.outputDir_ + "/" + multiWriter_.curOutFileName_,
-                                                          static_cast<Dune::VTK::OutputType>(vtkFormat));
+                fileName = frame_->writer->write(/*name=*/multiWriter_.outputDir_ + "/" + frame_->outFileName,
+                                                 static_cast<Dune::VTK::OutputType>(duneVtkFormat));
 
             // determine name to write into the multi-file for the
             // current time step
             // The file names in the pvd file are relative, the path should therefore be stripped.
             const std::filesystem::path fullPath{fileName};
-            const std::string localFileName = fullPath.filename();
-            multiWriter_.multiFile_.precision(16);
-            multiWriter_.multiFile_ << "   <DataSet timestep=\"" << multiWriter_.curTime_ << "\" file=\""
-                                    << localFileName << "\"/>\n";
+            localFileName = fullPath.filename().string();
         }
 
     private:
         VtkMultiWriter& multiWriter_;
+        std::shared_ptr<Frame> frame_;
     };
 
     enum { dim = GridView::dimension };
@@ -103,6 +148,12 @@ class VtkMultiWriter : public BaseOutputWriter
     using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
     using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
 
+    // the compressed binary output is only available for unstructured grids, i.e.,
+    // one-dimensional grids are written as raw binary poly data instead
+    static constexpr bool useAppendedWriter = vtkFormat == vtkCompressedAppendedFormat && dim > 1;
+    static constexpr int duneVtkFormat =
+        (vtkFormat == vtkCompressedAppendedFormat) ? Dune::VTK::appendedraw : vtkFormat;
+
 public:
     using Scalar = BaseOutputWriter::Scalar;
     using Vector = BaseOutputWriter::Vector;
@@ -111,10 +162,21 @@ public:
     using VectorBuffer = BaseOutputWriter::VectorBuffer;
     using TensorBuffer = BaseOutputWriter::TensorBuffer;
 
-    using VtkWriter = Dune::VTKWriter<GridView>;
+    using VtkWriter = std::conditional_t<useAppendedWriter,
+                                         VtkAppendedWriter<GridView>,
+                                         Dune::VTKWriter<GridView>>;
     using FunctionPtr = std::shared_ptr< Dune::VTKFunction< GridView > >;
 
-    VtkMultiWriter(bool asyncWriting,
+    /*!
+     * \brief Create a multi-writer.
+     *
+     * \param numWriterThreads The number of threads which write the data to disk. If
+     *                         this is 0, the data is written synchronously by
+     *                         endWrite(). Several threads only make sense if more
+     *                         than one frame may be in flight, see
+     *                         setMaxPendingWrites().
+     */
+    VtkMultiWriter(unsigned numWriterThreads,
                    const GridView& gridView,
                    const std::string& outputDir,
                    const std::string& simName = "",
@@ -122,9 +184,8 @@ public:
         : gridView_(gridView)
         , elementMapper_(gridView, Dune::mcmgElementLayout())
         , vertexMapper_(gridView, Dune::mcmgVertexLayout())
-        , curWriter_(nullptr)
         , curWriterNum_(0)
-        , taskletRunner_(/*numThreads=*/asyncWriting?1:0)
+        , taskletRunner_(numWriterThreads)
     {
         outputDir_ = outputDir;
         if (outputDir == "")
@@ -142,7 +203,7 @@ public:
     ~VtkMultiWriter()
     {
         taskletRunner_.barrier();
-        releaseBuffers_();
+        curFrame_.reset();
         finishMultiFile_();
 
         if (commRank_ == 0)
@@ -155,6 +216,41 @@ public:
     int curWriterNum() const
     { return curWriterNum_; }
 
+    /*!
+     * \brief Set the limits for the frames which are written asynchronously.
+     *
+     * beginWrite() blocks until less than maxPendingWrites frames are in flight. In
+     * addition, it blocks while the buffers of the frames in flight occupy more than
+     * memoryBudget bytes, unless no frame is in flight. The default is one frame,
+     * i.e., a frame is only started after the previous one has been written.
+     */
+    void setMaxPendingWrites(unsigned maxPendingWrites,
+                             std::size_t memoryBudget = std::numeric_limits<std::size_t>::max())
+    {
+        maxPendingWrites_ = std::max(maxPendingWrites, 1u);
+        memoryBudget_ = memoryBudget;
+    }
+
+    /*!
+     * \brief Combine the pieces of groups of processes into single files (collective).
+     *
+     * \param groupSize The number of consecutive ranks whose pieces are written by
+     *                  the first of them. 0 combines the pieces of the processes
+     *                  which share a node, 1 lets each process write its own piece.
+     *
+     * The aggregation is only available for the compressed binary format. For the
+     * other formats, each process always writes its own piece.
+     */
+    void setAggregation(int groupSize)
+    {
+        if constexpr (useAppendedWriter) {
+            taskletRunner_.barrier();
+            aggregation_.setup(mpiCommunicator_(), groupSize);
+        }
+        else
+            static_cast<void>(groupSize);
+    }
+
     /*!
      * \brief Updates the internal data structures after mesh
      *        refinement.
@@ -164,6 +260,18 @@ public:
      */
     void gridChanged()
     {
+        // the writer of the previous time step may still access the old geometry
+        taskletRunner_.barrier();
+        geometry_.invalidate();
+
+        // the buffers of the old grid are unlikely to fit the new one
+        {
+            std::lock_guard<std::mutex> lock(poolMutex_);
+            scalarPool_.clear();
+            vectorPool_.clear();
+            tensorPool_.clear();
+        }
+
 #if DUNE_VERSION_NEWER(DUNE_GRID, 2, 8)
         elementMapper_.update(gridView_);
         vertexMapper_.update(gridView_);
@@ -182,44 +290,52 @@ public:
             startMultiFile_(multiFileName_);
         }
 
-        // make sure that all previous output has been written and no other thread
+        // make sure that the number of frames in flight and the memory occupied by
+        // them stay within their limits. if only one frame may be in flight, this
+        // means that all previous output has been written and no other thread
         // accesses the memory used as the target for the extracted quantities
-        taskletRunner_.barrier();
-        releaseBuffers_();
+        waitForPendingWrites_();
 
-        curTime_ = t;
-        curOutFileName_ = fileName_();
+        curFrame_ = std::make_shared<Frame>();
+        curFrame_->time = t;
+        curFrame_->outFileName = fileName_();
 
-        curWriter_ = new VtkWriter(gridView_, Dune::VTK::conforming);
+        if constexpr (useAppendedWriter)
+            curFrame_->writer = std::make_unique<VtkWriter>(gridView_, vertexMapper_, elementMapper_, geometry_);
+        else
+            curFrame_->writer = std::make_unique<VtkWriter>(gridView_, Dune::VTK::conforming);
         ++curWriterNum_;
     }
 
     /*!
      * \brief Allocate a managed buffer for a scalar field
      *
-     * The buffer will be deleted automatically after the data has
-     * been written by to disk.
+     * The buffer will be recycled automatically after the data has
+     * been written by to disk. All entries are initialized to zero.
      */
     ScalarBuffer *allocateManagedScalarBuffer(size_t numEntities)
     {
-        ScalarBuffer *buf = new ScalarBuffer(numEntities);
-        managedScalarBuffers_.push_back(buf);
-        return buf;
+        auto buf = takeBuffer_(scalarPool_, numEntities);
+        std::fill(buf->begin(), buf->end(), 0.0);
+        curFrame_->scalarBuffers.push_back(std::move(buf));
+        return curFrame_->scalarBuffers.back().get();
     }
 
     /*!
      * \brief Allocate a managed buffer for a vector field
      *
-     * The buffer will be deleted automatically after the data has
-     * been written by to disk.
+     * The buffer will be recycled automatically after the data has
+     * been written by to disk. All entries are initialized to zero.
      */
     VectorBuffer *allocateManagedVectorBuffer(size_t numOuter, size_t numInner)
     {
-        VectorBuffer *buf = new VectorBuffer(numOuter);
-        for (size_t i = 0; i < numOuter; ++ i)
+        curFrame_->vectorBuffers.push_back(takeBuffer_(vectorPool_, numOuter));
+        VectorBuffer *buf = curFrame_->vectorBuffers.back().get();
+        for (size_t i = 0; i < numOuter; ++ i) {
             (*buf)[i].resize(numInner);
+            (*buf)[i] = 0.0;
+        }
 
-        managedVectorBuffers_.push_back(buf);
         return buf;
     }
 
@@ -239,8 +355,9 @@ public:
      * In both cases, modifying the buffer between the call to this
      * method and endWrite() results in _undefined behavior_.
      */
-    void attachScalarVertexData(ScalarBuffer& buf, std::string name)
+    void attachScalarVertexData(ScalarBuffer& inBuf, std::string name)
     {
+        ScalarBuffer& buf = frameBuffer_(curFrame_->scalarBuffers, inBuf);
         sanitizeScalarBuffer_(buf);
 
         using VtkFn = VtkScalarFunction<GridView, VertexMapper>;
@@ -249,7 +366,7 @@ public:
                                     vertexMapper_,
                                     buf,
                                     /*codim=*/dim));
-        curWriter_->addVertexData(fnPtr);
+        curFrame_->writer->addVertexData(fnPtr);
     }
 
     /*!
@@ -267,8 +384,9 @@ public:
      * In both cases, modifying the buffer between the call to this
      * method and endWrite() results in _undefined behaviour_.
      */
-    void attachScalarElementData(ScalarBuffer& buf, std::string name)
+    void attachScalarElementData(ScalarBuffer& inBuf, std::string name)
     {
+        ScalarBuffer& buf = frameBuffer_(curFrame_->scalarBuffers, inBuf);
         sanitizeScalarBuffer_(buf);
 
         using VtkFn = VtkScalarFunction<GridView, ElementMapper>;
@@ -277,7 +395,7 @@ public:
                                     elementMapper_,
                                     buf,
                                     /*codim=*/0));
-        curWriter_->addCellData(fnPtr);
+        curFrame_->writer->addCellData(fnPtr);
     }
 
     /*!
@@ -296,8 +414,9 @@ public:
      * In both cases, modifying the buffer between the call to this
      * method and endWrite() results in _undefined behavior_.
      */
-    void attachVectorVertexData(VectorBuffer& buf, std::string name)
+    void attachVectorVertexData(VectorBuffer& inBuf, std::string name)
     {
+        VectorBuffer& buf = frameBuffer_(curFrame_->vectorBuffers, inBuf);
         sanitizeVectorBuffer_(buf);
 
         using VtkFn = VtkVectorFunction<GridView, VertexMapper>;
@@ -306,14 +425,15 @@ public:
                                     vertexMapper_,
                                     buf,
                                     /*codim=*/dim));
-        curWriter_->addVertexData(fnPtr);
+        curFrame_->writer->addVertexData(fnPtr);
     }
 
     /*!
      * \brief Add a finished vertex-centered tensor field to the output.
      */
-    void attachTensorVertexData(TensorBuffer& buf, std::string name)
+    void attachTensorVertexData(TensorBuffer& inBuf, std::string name)
     {
+        const TensorBuffer& buf = frameBuffer_(curFrame_->tensorBuffers, inBuf);
         using VtkFn = VtkTensorFunction<GridView, VertexMapper>;
 
         for (unsigned colIdx = 0; colIdx < buf[0].N(); ++colIdx) {
@@ -326,7 +446,7 @@ public:
                                         buf,
                                         /*codim=*/dim,
                                         colIdx));
-            curWriter_->addVertexData(fnPtr);
+            curFrame_->writer->addVertexData(fnPtr);
         }
     }
 
@@ -345,8 +465,9 @@ public:
      * In both cases, modifying the buffer between the call to this
      * method and endWrite() results in _undefined behaviour_.
      */
-    void attachVectorElementData(VectorBuffer& buf, std::string name)
+    void attachVectorElementData(VectorBuffer& inBuf, std::string name)
     {
+        VectorBuffer& buf = frameBuffer_(curFrame_->vectorBuffers, inBuf);
         sanitizeVectorBuffer_(buf);
 
         using VtkFn = VtkVectorFunction<GridView, ElementMapper>;
@@ -355,14 +476,15 @@ public:
                                     elementMapper_,
                                     buf,
                                     /*codim=*/0));
-        curWriter_->addCellData(fnPtr);
+        curFrame_->writer->addCellData(fnPtr);
     }
 
     /*!
      * \brief Add a finished element-centered tensor field to the output.
      */
-    void attachTensorElementData(TensorBuffer& buf, std::string name)
+    void attachTensorElementData(TensorBuffer& inBuf, std::string name)
     {
+        const TensorBuffer& buf = frameBuffer_(curFrame_->tensorBuffers, inBuf);
         using VtkFn = VtkTensorFunction<GridView, ElementMapper>;
 
         for (unsigned colIdx = 0; colIdx < buf[0].N(); ++colIdx) {
@@ -375,7 +497,7 @@ public:
                                         buf,
                                         /*codim=*/0,
                                         colIdx));
-            curWriter_->addCellData(fnPtr);
+            curFrame_->writer->addCellData(fnPtr);
         }
     }
 
@@ -388,17 +510,36 @@ public:
      */
     void endWrite(bool onlyDiscard = false)
     {
+        EWOMS_PROFILE_REGION("VTK output");
+
         if (!onlyDiscard) {
-            auto tasklet = std::make_shared<WriteDataTasklet>(*this);
+            // the pieces are sent to the writers of the groups before the frame is
+            // handed over, since the writer threads must not communicate
+            if constexpr (useAppendedWriter) {
+                if (aggregation_.enabled())
+                    curFrame_->writer->aggregate(aggregation_);
+            }
+
+            curFrame_->entryIdx = numEntries_++;
+            curFrame_->numBytes = frameBytes_(*curFrame_);
+            {
+                std::lock_guard<std::mutex> lock(pendingMutex_);
+                ++numPendingWrites_;
+                pendingBytes_ += curFrame_->numBytes;
+            }
+
+            // the tasklet takes over the frame. it releases it after the data is
+            // written and adds the entry to the multi-file, which is always kept
+            // in a valid state
+            auto tasklet = std::make_shared<WriteDataTasklet>(*this, std::move(curFrame_));
             taskletRunner_.dispatch(tasklet);
         }
-        else
+        else {
             --curWriterNum_;
+            recycleBuffers_(*curFrame_);
+        }
 
-        // temporarily write the closing XML mumbo-jumbo to the mashup
-        // file so that the data set can be loaded even if the
-        // simulation is aborted (or not yet finished)
-        finishMultiFile_();
+        curFrame_.reset();
     }
 
     /*!
@@ -407,6 +548,9 @@ public:
     template <class Restarter>
     void serialize(Restarter& res)
     {
+        // make sure that the multi-file is complete
+        taskletRunner_.barrier();
+
         res.serializeSectionBegin("VTKMultiWriter");
         res.serializeStream() << curWriterNum_ << "\n";
 
@@ -441,6 +585,8 @@ public:
     template <class Restarter>
     void deserialize(Restarter& res)
     {
+        taskletRunner_.barrier();
+
         res.deserializeSectionBegin("VTKMultiWriter");
         res.deserializeStream() >> curWriterNum_;
 
@@ -475,6 +621,172 @@ public:
     }
 
 private:
+    // the VTK writer and the buffers of the data which is written for a time step
+    struct Frame
+    {
+        std::unique_ptr<VtkWriter> writer;
+        double time = 0.0;
+        std::string outFileName;
+        int entryIdx = 0;
+        std::size_t numBytes = 0;
+
+        std::list<std::unique_ptr<ScalarBuffer>> scalarBuffers;
+        std::list<std::unique_ptr<VectorBuffer>> vectorBuffers;
+        std::list<std::unique_ptr<TensorBuffer>> tensorBuffers;
+    };
+
+    // returns the buffer which is written by the current frame. this is the buffer
+    // itself if it is owned by the frame (or if there is no frame which can be
+    // written concurrently), and a copy owned by the frame otherwise
+    template <class Buffer>
+    Buffer& frameBuffer_(std::list<std::unique_ptr<Buffer>>& frameBuffers, Buffer& buf)
+    {
+        if (maxPendingWrites_ <= 1)
+            return buf;
+
+        for (const auto& frameBuf : frameBuffers)
+            if (frameBuf.get() == &buf)
+                return buf;
+
+        auto copy = takeBuffer_(bufferPool_<Buffer>(), buf.size());
+        *copy = buf;
+        frameBuffers.push_back(std::move(copy));
+        return *frameBuffers.back();
+    }
+
+    template <class Buffer>
+    using BufferPool_ = std::multimap<std::size_t, std::unique_ptr<Buffer>>;
+
+    template <class Buffer>
+    BufferPool_<Buffer>& bufferPool_()
+    {
+        if constexpr (std::is_same_v<Buffer, ScalarBuffer>)
+            return scalarPool_;
+        else if constexpr (std::is_same_v<Buffer, VectorBuffer>)
+            return vectorPool_;
+        else
+            return tensorPool_;
+    }
+
+    // returns a buffer with the given number of entries. if the pool does not contain
+    // one, a new buffer is allocated. the entries of a recycled buffer are undefined
+    template <class Buffer>
+    std::unique_ptr<Buffer> takeBuffer_(BufferPool_<Buffer>& pool, std::size_t size)
+    {
+        {
+            std::lock_guard<std::mutex> lock(poolMutex_);
+            auto it = pool.find(size);
+            if (it != pool.end()) {
+                auto buf = std::move(it->second);
+                pool.erase(it);
+                return buf;
+            }
+        }
+
+        return std::make_unique<Buffer>(size);
+    }
+
+    // move the buffers of a frame which is no longer needed into the pool
+    void recycleBuffers_(Frame& frame)
+    {
+        // the VTK functions of the writer refer to the buffers
+        frame.writer.reset();
+
+        std::lock_guard<std::mutex> lock(poolMutex_);
+        for (auto& buf : frame.scalarBuffers)
+            scalarPool_.emplace(buf->size(), std::move(buf));
+        for (auto& buf : frame.vectorBuffers)
+            vectorPool_.emplace(buf->size(), std::move(buf));
+        for (auto& buf : frame.tensorBuffers)
+            tensorPool_.emplace(buf->size(), std::move(buf));
+
+        frame.scalarBuffers.clear();
+        frame.vectorBuffers.clear();
+        frame.tensorBuffers.clear();
+    }
+
+    static std::size_t frameBytes_(const Frame& frame)
+    {
+        std::size_t numBytes = 0;
+        for (const auto& buf : frame.scalarBuffers)
+            numBytes += buf->size()*sizeof(Scalar);
+        for (const auto& buf : frame.vectorBuffers)
+            for (const auto& v : *buf)
+                numBytes += v.size()*sizeof(Scalar);
+        for (const auto& buf : frame.tensorBuffers)
+            for (const auto& t : *buf)
+                numBytes += t.N()*t.M()*sizeof(Scalar);
+        return numBytes;
+    }
+
+    void waitForPendingWrites_()
+    {
+        std::unique_lock<std::mutex> lock(pendingMutex_);
+        pendingCondition_.wait(lock, [this]()
+        {
+            return numPendingWrites_ == 0
+                || (numPendingWrites_ < maxPendingWrites_ && pendingBytes_ <= memoryBudget_);
+        });
+    }
+
+    // called by the writer threads when a frame has been written
+    void finishFrame_(std::shared_ptr<Frame>& frame, const std::string& localFileName)
+    {
+        addMultiFileEntry_(frame->entryIdx, frame->time, localFileName);
+
+        const std::size_t numBytes = frame->numBytes;
+        recycleBuffers_(*frame);
+        frame.reset();
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex_);
+            --numPendingWrites_;
+            pendingBytes_ -= numBytes;
+        }
+        pendingCondition_.notify_all();
+    }
+
+    // the frames may be finished out of order, but the entries of the multi-file are
+    // written in the order of the time steps. entries without a file name are skipped
+    void addMultiFileEntry_(int entryIdx, double time, const std::string& fileName)
+    {
+        std::lock_guard<std::mutex> lock(multiFileMutex_);
+        pendingEntries_[entryIdx] = std::make_pair(time, fileName);
+
+        bool changed = false;
+        for (auto it = pendingEntries_.find(nextEntryIdx_);
+             it != pendingEntries_.end();
+             it = pendingEntries_.find(nextEntryIdx_))
+        {
+            if (commRank_ == 0 && !it->second.second.empty()) {
+                multiFile_.precision(16);
+                multiFile_ << "   <DataSet timestep=\"" << it->second.first << "\" file=\""
+                           << it->second.second << "\"/>\n";
+            }
+            pendingEntries_.erase(it);
+            ++nextEntryIdx_;
+            changed = true;
+        }
+
+        // temporarily write the closing XML mumbo-jumbo to the mashup
+        // file so that the data set can be loaded even if the
+        // simulation is aborted (or not yet finished)
+        if (changed)
+            finishMultiFile_();
+    }
+
+    VtkAggregationGroup::Communicator mpiCommunicator_() const
+    {
+#if HAVE_MPI
+        using Comm = std::decay_t<decltype(gridView_.comm())>;
+        if constexpr (std::is_convertible_v<Comm, MPI_Comm>)
+            return static_cast<MPI_Comm>(gridView_.comm());
+        else
+            return MPI_COMM_SELF;
+#else
+        return 0;
+#endif
+    }
+
     std::string fileName_()
     {
         // use a new file name for each time step
@@ -527,22 +839,6 @@ private:
         // nothing to do: this is done by VtkVectorFunction
     }
 
-    // release the memory occupied by all buffer objects managed by the multi-writer
-    void releaseBuffers_()
-    {
-        // discard managed objects and the current VTK writer
-        delete curWriter_;
-        curWriter_ = nullptr;
-        while (managedScalarBuffers_.begin() != managedScalarBuffers_.end()) {
-            delete managedScalarBuffers_.front();
-            managedScalarBuffers_.pop_front();
-        }
-        while (managedVectorBuffers_.begin() != managedVectorBuffers_.end()) {
-            delete managedVectorBuffers_.front();
-            managedVectorBuffers_.pop_front();
-        }
-    }
-
     const GridView gridView_;
     ElementMapper elementMapper_;
     VertexMapper vertexMapper_;
@@ -555,13 +851,34 @@ private:
     int commSize_; // number of processes in the communicator
     int commRank_; // rank of the current process in the communicator
 
-    VtkWriter *curWriter_;
-    double curTime_;
-    std::string curOutFileName_;
+    // the frame which is currently assembled by the simulation
+    std::shared_ptr<Frame> curFrame_;
+    // the encoded grid which is shared by the writers of all time steps. this is
+    // only used by the compressed binary output
+    typename VtkAppendedWriter<GridView>::Geometry geometry_;
+    // the processes whose pieces are written into the same file
+    VtkAggregationGroup aggregation_;
     int curWriterNum_;
 
-    std::list<ScalarBuffer *> managedScalarBuffers_;
-    std::list<VectorBuffer *> managedVectorBuffers_;
+    // the frames which have been handed over to the writer threads
+    unsigned maxPendingWrites_ = 1;
+    std::size_t memoryBudget_ = std::numeric_limits<std::size_t>::max();
+    unsigned numPendingWrites_ = 0;
+    std::size_t pendingBytes_ = 0;
+    std::mutex pendingMutex_;
+    std::condition_variable pendingCondition_;
+
+    // the entries of the multi-file which wait for the ones of earlier frames
+    int numEntries_ = 0;
+    int nextEntryIdx_ = 0;
+    std::map<int, std::pair<double, std::string>> pendingEntries_;
+    std::mutex multiFileMutex_;
+
+    // the buffers of the frames which have been written
+    BufferPool_<ScalarBuffer> scalarPool_;
+    BufferPool_<VectorBuffer> vectorPool_;
+    BufferPool_<TensorBuffer> tensorPool_;
+    std::mutex poolMutex_;
 
     TaskletRunner taskletRunner_;
 };
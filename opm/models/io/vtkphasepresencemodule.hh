@@ -46,8 +46,13 @@ struct VtkPhasePresence {};
 template<class TypeTag, class MyTypeTag>
 struct VtkWritePhasePresence { using type = UndefinedProperty; };
 
+template<class TypeTag, class MyTypeTag>
+struct VtkWritePhaseSwitches { using type = UndefinedProperty; };
+
 template<class TypeTag>
 struct VtkWritePhasePresence<TypeTag, TTag::VtkPhasePresence> { static constexpr bool value = false; };
+template<class TypeTag>
+struct VtkWritePhaseSwitches<TypeTag, TTag::VtkPhasePresence> { static constexpr bool value = false; };
 
 } // namespace Opm::Properties
 
@@ -67,9 +72,6 @@ class VtkPhasePresenceModule : public BaseOutputModule<TypeTag>
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
     using GridView = GetPropType<TypeTag, Properties::GridView>;
 
-    static const int vtkFormat = getPropValue<TypeTag, Properties::VtkOutputFormat>();
-    using VtkMultiWriter = Opm::VtkMultiWriter<GridView, vtkFormat>;
-
     using ScalarBuffer = typename ParentType::ScalarBuffer;
 
 
@@ -86,6 +88,9 @@ public:
         Parameters::registerParam<TypeTag, Properties::VtkWritePhasePresence>
             ("Include the phase presence pseudo primary "
              "variable in the VTK output files");
+        Parameters::registerParam<TypeTag, Properties::VtkWritePhaseSwitches>
+            ("Include the number of phase switches of each degree of freedom since "
+             "the start of the simulation in the VTK output files");
     }
 
     /*!
@@ -95,6 +100,7 @@ public:
     void allocBuffers()
     {
         if (phasePresenceOutput_()) this->resizeScalarBuffer_(phasePresence_);
+        if (phaseSwitchesOutput_()) this->resizeScalarBuffer_(phaseSwitches_);
     }
 
     /*!
@@ -103,9 +109,6 @@ public:
      */
     void processElement(const ElementContext& elemCtx)
     {
-        if (!Parameters::get<TypeTag, Properties::EnableVtkOutput>())
-            return;
-
         for (unsigned i = 0; i < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++i) {
             // calculate the phase presence
             int phasePresence = elemCtx.primaryVars(i, /*timeIdx=*/0).phasePresence();
@@ -113,6 +116,8 @@ public:
 
             if (phasePresenceOutput_())
                 phasePresence_[I] = phasePresence;
+            if (phaseSwitchesOutput_())
+                phaseSwitches_[I] = elemCtx.model().totalNumPhaseSwitches(I);
         }
     }
 
@@ -121,13 +126,10 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter) {
-            return;
-        }
-
         if (phasePresenceOutput_())
             this->commitScalarBuffer_(baseWriter, "phase presence", phasePresence_);
+        if (phaseSwitchesOutput_())
+            this->commitScalarBuffer_(baseWriter, "phase switches", phaseSwitches_);
     }
 
 private:
@@ -137,7 +139,14 @@ private:
         return val;
     }
 
+    static bool phaseSwitchesOutput_()
+    {
+        static bool val = Parameters::get<TypeTag, Properties::VtkWritePhaseSwitches>();
+        return val;
+    }
+
     ScalarBuffer phasePresence_;
+    ScalarBuffer phaseSwitches_;
 };
 
 } // namespace Opm
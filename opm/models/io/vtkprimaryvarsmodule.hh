@@ -75,9 +75,6 @@ class VtkPrimaryVarsModule : public BaseOutputModule<TypeTag>
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
     using GridView = GetPropType<TypeTag, Properties::GridView>;
 
-    static const int vtkFormat = getPropValue<TypeTag, Properties::VtkOutputFormat>();
-    using VtkMultiWriter = ::Opm::VtkMultiWriter<GridView, vtkFormat>;
-
     using ScalarBuffer = typename ParentType::ScalarBuffer;
     using EqBuffer = typename ParentType::EqBuffer;
 
@@ -122,9 +119,6 @@ public:
      */
     void processElement(const ElementContext& elemCtx)
     {
-        if (!Parameters::get<TypeTag, Properties::EnableVtkOutput>())
-            return;
-
         const auto& elementMapper = elemCtx.model().elementMapper();
         unsigned elemIdx = static_cast<unsigned>(elementMapper.index(elemCtx.element()));
         if (processRankOutput_() && !processRank_.empty())
@@ -149,11 +143,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter) {
-            return;
-        }
-
         if (primaryVarsOutput_())
             this->commitPriVarsBuffer_(baseWriter, "PV_%s", primaryVars_);
         if (processRankOutput_())
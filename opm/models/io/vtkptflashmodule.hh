@@ -83,9 +83,6 @@ class VtkPTFlashModule: public BaseOutputModule<TypeTag>
     enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
     enum { numComponents = getPropValue<TypeTag, Properties::NumComponents>() };
 
-    static const int vtkFormat = getPropValue<TypeTag, Properties::VtkOutputFormat>();
-    using VtkMultiWriter = ::Opm::VtkMultiWriter<GridView, vtkFormat>;
-
     using ComponentBuffer = typename ParentType::ComponentBuffer;
     using ScalarBuffer = typename ParentType::ScalarBuffer;
 
@@ -125,9 +122,6 @@ public:
     {
         using Toolbox = MathToolbox<Evaluation>;
 
-        if (!Parameters::get<TypeTag, Properties::EnableVtkOutput>())
-            return;
-
         for (unsigned i = 0; i < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++i) {
             unsigned I = elemCtx.globalSpaceIndex(i, /*timeIdx=*/0);
             const auto& intQuants = elemCtx.intensiveQuantities(i, /*timeIdx=*/0);
@@ -148,11 +142,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        auto *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter) {
-            return;
-        }
-
         if (equilConstOutput_())
             this->commitComponentBuffer_(baseWriter, "K^%s", K_);
         if (LOutput_())
@@ -28,12 +28,15 @@
 #define VTK_SCALAR_FUNCTION_HH
 
 #include <opm/models/io/baseoutputwriter.hh>
+#include <opm/models/io/vtkarrayfunction.hh>
 
 #include <dune/grid/io/file/vtk/function.hh>
 #include <dune/istl/bvector.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <stdexcept>
 #include <string>
@@ -46,7 +49,9 @@ namespace Opm {
  *        as elements.
  */
 template <class GridView, class Mapper>
-class VtkScalarFunction : public Dune::VTKFunction<GridView>
+class VtkScalarFunction
+    : public Dune::VTKFunction<GridView>
+    , public VtkArrayFunction<Mapper>
 {
     enum { dim = GridView::dimension };
     using ctype = typename GridView::ctype;
@@ -110,6 +115,20 @@ public:
         return static_cast<double>(static_cast<float>(buf_[idx]));
     }
 
+    virtual const Mapper& mapper() const
+    { return mapper_; }
+
+    virtual unsigned codim() const
+    { return codim_; }
+
+    virtual void gather(float* out,
+                        unsigned numOutComps,
+                        const std::vector<std::int64_t>& entityIndices) const
+    {
+        for (std::size_t i = 0; i < entityIndices.size(); ++i)
+            out[i*numOutComps] = static_cast<float>(buf_[static_cast<std::size_t>(entityIndices[i])]);
+    }
+
 private:
     const std::string name_;
     const GridView gridView_;
@@ -28,11 +28,14 @@
 #define VTK_TENSOR_FUNCTION_HH
 
 #include <opm/models/io/baseoutputwriter.hh>
+#include <opm/models/io/vtkarrayfunction.hh>
 
 #include <dune/grid/io/file/vtk/function.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <limits>
 #include <vector>
@@ -43,7 +46,9 @@ namespace Opm {
  * \brief Provides a tensor-valued function using Dune::FieldMatrix objects as elements.
  */
 template <class GridView, class Mapper>
-class VtkTensorFunction : public Dune::VTKFunction<GridView>
+class VtkTensorFunction
+    : public Dune::VTKFunction<GridView>
+    , public VtkArrayFunction<Mapper>
 {
     enum { dim = GridView::dimension };
     using ctype = typename GridView::ctype;
@@ -111,6 +116,24 @@ public:
         return static_cast<double>(static_cast<float>(buf_[idx][i][j]));
     }
 
+    virtual const Mapper& mapper() const
+    { return mapper_; }
+
+    virtual unsigned codim() const
+    { return codim_; }
+
+    virtual void gather(float* out,
+                        unsigned numOutComps,
+                        const std::vector<std::int64_t>& entityIndices) const
+    {
+        const std::size_t numComps = buf_.empty() ? 0 : buf_[0].M();
+        for (std::size_t i = 0; i < entityIndices.size(); ++i) {
+            const auto& value = buf_[static_cast<std::size_t>(entityIndices[i])];
+            for (std::size_t compIdx = 0; compIdx < numComps; ++compIdx)
+                out[i*numOutComps + compIdx] = static_cast<float>(value[compIdx][matrixColumnIdx_]);
+        }
+    }
+
 private:
     const std::string name_;
     const GridView gridView_;
@@ -28,12 +28,15 @@
 #define VTK_VECTOR_FUNCTION_HH
 
 #include <opm/models/io/baseoutputwriter.hh>
+#include <opm/models/io/vtkarrayfunction.hh>
 
 #include <dune/grid/io/file/vtk/function.hh>
 #include <dune/istl/bvector.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <stdexcept>
 #include <string>
@@ -46,7 +49,9 @@ namespace Opm {
  *        as elements.
  */
 template <class GridView, class Mapper>
-class VtkVectorFunction : public Dune::VTKFunction<GridView>
+class VtkVectorFunction
+    : public Dune::VTKFunction<GridView>
+    , public VtkArrayFunction<Mapper>
 {
     enum { dim = GridView::dimension };
     using ctype = typename GridView::ctype;
@@ -110,6 +115,24 @@ public:
         return static_cast<double>(static_cast<float>(buf_[idx][static_cast<unsigned>(mycomp)]));
     }
 
+    virtual const Mapper& mapper() const
+    { return mapper_; }
+
+    virtual unsigned codim() const
+    { return codim_; }
+
+    virtual void gather(float* out,
+                        unsigned numOutComps,
+                        const std::vector<std::int64_t>& entityIndices) const
+    {
+        const std::size_t numComps = buf_.empty() ? 0 : buf_[0].size();
+        for (std::size_t i = 0; i < entityIndices.size(); ++i) {
+            const auto& value = buf_[static_cast<std::size_t>(entityIndices[i])];
+            for (std::size_t compIdx = 0; compIdx < numComps; ++compIdx)
+                out[i*numOutComps + compIdx] = static_cast<float>(value[compIdx]);
+        }
+    }
+
 private:
     const std::string name_;
     const GridView gridView_;
@@ -37,10 +37,13 @@
 #include <opm/material/fluidstates/CompositionalFluidState.hpp>
 #include <opm/material/constraintsolvers/CompositionFromFugacities.hpp>
 #include <opm/material/common/Valgrind.hpp>
+#include <opm/material/densead/Evaluation.hpp>
 
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <array>
+
 namespace Opm {
 /*!
  * \ingroup NcpModel
@@ -85,6 +88,22 @@ class NcpIntensiveQuantities
     using DiffusionIntensiveQuantities = Opm::DiffusionIntensiveQuantities<TypeTag, enableDiffusion>;
     using EnergyIntensiveQuantities = Opm::EnergyIntensiveQuantities<TypeTag, enableEnergy>;
     using FluxIntensiveQuantities = typename FluxModule::FluxIntensiveQuantities;
+    using Toolbox = Opm::MathToolbox<Evaluation>;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+
+    // The composition of a phase only depends on the component fugacities, the
+    // pressure of the phase and the temperature, but not on the saturations. The
+    // phase compositions are thus computed for derivatives with regard to these
+    // quantities and the chain rule is applied afterwards.
+    static constexpr int compPressureVarIdx = numComponents;
+    static constexpr int compTemperatureVarIdx = compPressureVarIdx + 1;
+    static constexpr int numCompVars = compPressureVarIdx + 1 + (enableEnergy ? 1 : 0);
+    static constexpr bool reducedCompositionDerivatives = numCompVars < numEq;
+
+    using CompEvaluation = DenseAd::Evaluation<Scalar, numCompVars>;
+    using CompFluidState = Opm::CompositionalFluidState<CompEvaluation, FluidSystem, /*storeEnthalpy=*/false>;
+    using CompCompositionFromFugacitiesSolver = Opm::CompositionFromFugacities<Scalar, FluidSystem, CompEvaluation>;
 
 public:
     NcpIntensiveQuantities()
@@ -140,6 +159,11 @@ public:
         // calculate phase compositions
         const auto *hint = elemCtx.thermodynamicHint(dofIdx, timeIdx);
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if constexpr (reducedCompositionDerivatives) {
+                updatePhaseComposition_(paramCache, phaseIdx, fug, hint);
+                continue;
+            }
+
             // initial guess
             if (hint) {
                 for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
@@ -233,6 +257,73 @@ public:
     }
 
 private:
+    // Compute the composition of a phase from the component fugacities using
+    // evaluations which only have derivatives with regard to the fugacities, the phase
+    // pressure and the temperature, and expand the results to derivatives with regard
+    // to the primary variables afterwards.
+    template <class ParameterCache, class Hint>
+    void updatePhaseComposition_(ParameterCache& paramCache,
+                                 unsigned phaseIdx,
+                                 const ComponentVector& fug,
+                                 const Hint* hint)
+    {
+        std::array<Evaluation, numCompVars> inputs;
+        const auto seed = [&inputs](const Evaluation& input, int varIdx)
+        {
+            inputs[varIdx] = input;
+            return CompEvaluation::createVariable(Toolbox::value(input), varIdx);
+        };
+
+        CompFluidState compFs;
+        typename CompCompositionFromFugacitiesSolver::ComponentVector compFug;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            compFug[compIdx] = seed(fug[compIdx], compIdx);
+
+        for (unsigned otherPhaseIdx = 0; otherPhaseIdx < numPhases; ++otherPhaseIdx) {
+            compFs.setPressure(otherPhaseIdx, Toolbox::value(fluidState_.pressure(otherPhaseIdx)));
+            compFs.setSaturation(otherPhaseIdx, Toolbox::value(fluidState_.saturation(otherPhaseIdx)));
+        }
+        compFs.setPressure(phaseIdx, seed(fluidState_.pressure(phaseIdx), compPressureVarIdx));
+
+        if constexpr (enableEnergy)
+            compFs.setTemperature(seed(fluidState_.temperature(phaseIdx), compTemperatureVarIdx));
+        else
+            compFs.setTemperature(Toolbox::value(fluidState_.temperature(phaseIdx)));
+
+        // initial guess
+        if (hint) {
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                compFs.setMoleFraction(phaseIdx, compIdx,
+                                       Toolbox::value(hint->fluidState().moleFraction(phaseIdx, compIdx)));
+        }
+        else
+            CompCompositionFromFugacitiesSolver::guessInitial(compFs, phaseIdx, compFug);
+
+        typename FluidSystem::template ParameterCache<CompEvaluation> compParamCache;
+        CompCompositionFromFugacitiesSolver::solve(compFs, compParamCache, phaseIdx, compFug);
+
+        // apply the chain rule
+        std::array<Evaluation, numCompVars> inputDerivatives;
+        for (int varIdx = 0; varIdx < numCompVars; ++varIdx)
+            inputDerivatives[varIdx] = inputs[varIdx] - Toolbox::value(inputs[varIdx]);
+        const auto expand = [&inputDerivatives](const CompEvaluation& compValue)
+        {
+            Evaluation result = compValue.value();
+            for (int varIdx = 0; varIdx < numCompVars; ++varIdx)
+                result += compValue.derivative(varIdx) * inputDerivatives[varIdx];
+            return result;
+        };
+
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+            fluidState_.setMoleFraction(phaseIdx, compIdx, expand(compFs.moleFraction(phaseIdx, compIdx)));
+            fluidState_.setFugacityCoefficient(phaseIdx, compIdx,
+                                               expand(compFs.fugacityCoefficient(phaseIdx, compIdx)));
+        }
+        fluidState_.setDensity(phaseIdx, expand(compFs.density(phaseIdx)));
+
+        paramCache.updatePhase(fluidState_, phaseIdx);
+    }
+
     DimMatrix intrinsicPerm_;
     FluidState fluidState_;
     Evaluation porosity_;
@@ -30,8 +30,6 @@
 
 #include "ncpproperties.hh"
 
-#include <opm/common/Exceptions.hpp>
-
 #include <opm/models/nonlinear/newtonmethod.hh>
 
 #include <algorithm>
@@ -60,7 +58,6 @@ class NcpNewtonMethod : public GetPropType<TypeTag, Properties::DiscNewtonMethod
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using Indices = GetPropType<TypeTag, Properties::Indices>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
-    using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
     using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
 
     enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
@@ -82,15 +79,18 @@ protected:
     friend ParentType;
     friend NewtonMethod<TypeTag>;
 
-    void preSolve_(const SolutionVector&,
-                   const GlobalEqVector& currentResidual)
+    /*!
+     * \copydoc NewtonMethod::localResidualError_
+     *
+     * The complementarity conditions are not considered for the error.
+     */
+    Scalar localResidualError_(const GlobalEqVector& currentResidual) const
     {
         const auto& constraintsMap = this->model().linearizer().constraintsMap();
-        this->lastError_ = this->error_;
 
         // calculate the error as the maximum weighted tolerance of
         // the solution's residual
-        this->error_ = 0;
+        Scalar result = 0;
         for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
             // do not consider auxiliary DOFs for the error
             if (dofIdx >= this->model().numGridDof() || this->model().dofTotalVolume(dofIdx) <= 0.0)
@@ -106,21 +106,12 @@ protected:
             for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx) {
                 if (ncp0EqIdx <= eqIdx && eqIdx < Indices::ncp0EqIdx + numPhases)
                     continue;
-                this->error_ =
-                    std::max(std::abs(r[eqIdx]*this->model().eqWeight(dofIdx, eqIdx)),
-                             this->error_);
+                result = std::max(std::abs(r[eqIdx]*this->model().eqWeight(dofIdx, eqIdx)),
+                                  result);
             }
         }
 
-        // take the other processes into account
-        this->error_ = this->comm_.max(this->error_);
-
-        // make sure that the error never grows beyond the maximum
-        // allowed one
-        if (this->error_ > Parameters::get<TypeTag, Properties::NewtonMaxError>())
-            throw Opm::NumericalProblem("Newton: Error "+std::to_string(double(this->error_))+
-                                        + " is larger than maximum allowed error of "
-                                        + std::to_string(Parameters::get<TypeTag, Properties::NewtonMaxError>()));
+        return result;
     }
 
     /*!
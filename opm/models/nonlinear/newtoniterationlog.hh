@@ -0,0 +1,192 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::NewtonIterationLog
+ */
+#ifndef EWOMS_NEWTON_ITERATION_LOG_HH
+#define EWOMS_NEWTON_ITERATION_LOG_HH
+
+#include <array>
+#include <cstddef>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup Newton
+ *
+ * \brief Records performance data of each iteration of the Newton method.
+ *
+ * Each record contains the error, the number of iterations of the linear solver and
+ * the time spent in the stages of the iteration. The records of the local process can
+ * be written as CSV or as JSON, and a summary of the total times of each stage with
+ * their minimum, maximum and average over all processes can be printed at the end of a
+ * simulation.
+ */
+class NewtonIterationLog
+{
+public:
+    //! The data of a single Newton iteration. All times are wall clock times in seconds.
+    struct Record
+    {
+        int timeStepIdx;
+        int iterationIdx;
+        double error;
+        double linearTolerance;
+        int linearIterations;
+        bool reusedJacobian;
+        double linearizeTime;
+        double matrixSetupTime;
+        double linearSolveTime;
+        double updateTime;
+    };
+
+    /*!
+     * \brief Add the record of a Newton iteration.
+     */
+    void add(const Record& record)
+    { records_.push_back(record); }
+
+    /*!
+     * \brief Returns the records which have been added so far.
+     */
+    const std::vector<Record>& records() const
+    { return records_; }
+
+    /*!
+     * \brief Write the records as comma separated values.
+     */
+    void writeCsv(std::ostream& os) const
+    {
+        os << "timeStepIdx,iterationIdx,error,linearTolerance,linearIterations,reusedJacobian,"
+           << "linearizeTime,matrixSetupTime,linearSolveTime,updateTime\n";
+        for (const auto& r : records_)
+            os << r.timeStepIdx << "," << r.iterationIdx << "," << r.error << ","
+               << r.linearTolerance << "," << r.linearIterations << "," << r.reusedJacobian << ","
+               << r.linearizeTime << "," << r.matrixSetupTime << ","
+               << r.linearSolveTime << "," << r.updateTime << "\n";
+    }
+
+    /*!
+     * \brief Write the records as a JSON array of objects.
+     */
+    void writeJson(std::ostream& os) const
+    {
+        os << "[\n";
+        for (std::size_t i = 0; i < records_.size(); ++i) {
+            const auto& r = records_[i];
+            os << "  {\"timeStepIdx\": " << r.timeStepIdx
+               << ", \"iterationIdx\": " << r.iterationIdx
+               << ", \"error\": " << r.error
+               << ", \"linearTolerance\": " << r.linearTolerance
+               << ", \"linearIterations\": " << r.linearIterations
+               << ", \"reusedJacobian\": " << (r.reusedJacobian ? "true" : "false")
+               << ", \"linearizeTime\": " << r.linearizeTime
+               << ", \"matrixSetupTime\": " << r.matrixSetupTime
+               << ", \"linearSolveTime\": " << r.linearSolveTime
+               << ", \"updateTime\": " << r.updateTime << "}"
+               << (i + 1 < records_.size() ? ",\n" : "\n");
+        }
+        os << "]\n";
+    }
+
+    /*!
+     * \brief Write the records of the local process to a file.
+     *
+     * The records are written as JSON if the file name ends with ".json" and as CSV
+     * otherwise. For parallel runs, the rank of the process is inserted in front of the
+     * extension of the file name.
+     */
+    void write(const std::string& fileName, int rank, int numRanks) const
+    {
+        std::string name = fileName;
+        const auto dotPos = name.rfind('.');
+        const std::string extension = (dotPos == std::string::npos) ? "" : name.substr(dotPos);
+        if (numRanks > 1)
+            name = name.substr(0, name.size() - extension.size())
+                + ".rank" + std::to_string(rank) + extension;
+
+        std::ofstream os(name);
+        if (!os)
+            throw std::runtime_error("Could not open the Newton iteration log '"+name+"'");
+
+        os.precision(10);
+        if (extension == ".json")
+            writeJson(os);
+        else
+            writeCsv(os);
+    }
+
+    /*!
+     * \brief Print the minimum, maximum and average over all processes of the total
+     *        time spent in each stage of the Newton iterations.
+     *
+     * This method is collective, but only the process of rank 0 prints the summary.
+     */
+    template <class Communication>
+    void printSummary(const Communication& comm, std::ostream& os) const
+    {
+        static const char* const stageNames[numStages_] =
+            { "linearize", "matrix setup", "linear solve", "update" };
+
+        std::array<double, numStages_> total{};
+        for (const auto& r : records_) {
+            total[0] += r.linearizeTime;
+            total[1] += r.matrixSetupTime;
+            total[2] += r.linearSolveTime;
+            total[3] += r.updateTime;
+        }
+
+        std::array<double, numStages_> minTime = total;
+        std::array<double, numStages_> maxTime = total;
+        std::array<double, numStages_> sumTime = total;
+        comm.min(minTime.data(), numStages_);
+        comm.max(maxTime.data(), numStages_);
+        comm.sum(sumTime.data(), numStages_);
+
+        if (comm.rank() != 0)
+            return;
+
+        os << "Newton stage times over " << comm.size() << " process(es) (min/max/avg):\n";
+        for (int stageIdx = 0; stageIdx < numStages_; ++stageIdx)
+            os << "  " << stageNames[stageIdx] << ": "
+               << minTime[stageIdx] << "/" << maxTime[stageIdx] << "/"
+               << sumTime[stageIdx]/comm.size() << " seconds\n";
+        os << std::flush;
+    }
+
+private:
+    static constexpr int numStages_ = 4;
+
+    std::vector<Record> records_;
+};
+
+} // namespace Opm
+
+#endif
@@ -29,27 +29,52 @@
 
 #include "nullconvergencewriter.hh"
 
+#include "newtoniterationlog.hh"
 #include "newtonmethodproperties.hh"
+#include "nonlineardomainsolver.hh"
+#include "sequentialimplicitsolver.hh"
 
 #include <opm/common/Exceptions.hpp>
 
 #include <opm/material/densead/Math.hpp>
 
 #include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/utils/autotuner.hh>
+#include <opm/models/utils/hardwarecounters.hh>
+#include <opm/models/utils/regionprofiler.hh>
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
 
 #include <opm/simulators/linalg/linalgproperties.hh>
 
 #include <dune/istl/istlexception.hh>
+#include <dune/common/binaryfunctions.hh>
 #include <dune/common/classname.hh>
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
 #include <dune/common/parallel/mpihelper.hh>
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <exception>
 #include <iostream>
+#include <limits>
+#include <mutex>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <unistd.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace Opm {
 // forward declaration of classes
 template <class TypeTag>
@@ -78,6 +103,8 @@ struct NewtonConvergenceWriter<TypeTag, TTag::NewtonMethod> { using type = NullC
 template<class TypeTag>
 struct NewtonWriteConvergence<TypeTag, TTag::NewtonMethod> { static constexpr bool value = false; };
 template<class TypeTag>
+struct NewtonWriteConvergenceAfter<TypeTag, TTag::NewtonMethod> { static constexpr unsigned value = 0; };
+template<class TypeTag>
 struct NewtonVerbose<TypeTag, TTag::NewtonMethod> { static constexpr bool value = true; };
 template<class TypeTag>
 struct NewtonTolerance<TypeTag, TTag::NewtonMethod>
@@ -97,6 +124,86 @@ template<class TypeTag>
 struct NewtonTargetIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 10; };
 template<class TypeTag>
 struct NewtonMaxIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 20; };
+template<class TypeTag>
+struct NewtonForcingTerm<TypeTag, TTag::NewtonMethod> { static constexpr auto value = "fixed"; };
+template<class TypeTag>
+struct NewtonMaxForcingTerm<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.5;
+};
+template<class TypeTag>
+struct NewtonGlobalization<TypeTag, TTag::NewtonMethod> { static constexpr auto value = "none"; };
+template<class TypeTag>
+struct NewtonMaxStepCuts<TypeTag, TTag::NewtonMethod> { static constexpr int value = 5; };
+template<class TypeTag>
+struct NewtonAndersonDepth<TypeTag, TTag::NewtonMethod> { static constexpr int value = 0; };
+template<class TypeTag>
+struct NewtonMaxJacobianReuses<TypeTag, TTag::NewtonMethod> { static constexpr int value = 0; };
+template<class TypeTag>
+struct NewtonJacobianReuseReduction<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.5;
+};
+template<class TypeTag>
+struct NewtonIterationLogFile<TypeTag, TTag::NewtonMethod> { static constexpr auto value = ""; };
+template<class TypeTag>
+struct NewtonOverlapErrorReduction<TypeTag, TTag::NewtonMethod> { static constexpr bool value = false; };
+template<class TypeTag>
+struct NewtonFailurePredictionIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 0; };
+template<class TypeTag>
+struct NewtonDivergenceFactor<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.0;
+};
+template<class TypeTag>
+struct NewtonStagnationIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 0; };
+template<class TypeTag>
+struct NewtonAutoTuneTrials<TypeTag, TTag::NewtonMethod> { static constexpr unsigned value = 0; };
+template<class TypeTag>
+struct NewtonNlddNumDomains<TypeTag, TTag::NewtonMethod> { static constexpr int value = 0; };
+template<class TypeTag>
+struct NewtonNlddMaxIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 5; };
+template<class TypeTag>
+struct NewtonNlddTolerance<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.0;
+};
+template<class TypeTag>
+struct NewtonNlddSchwarz<TypeTag, TTag::NewtonMethod> { static constexpr auto value = "multiplicative"; };
+template<class TypeTag>
+struct NewtonSequentialMaxIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 0; };
+template<class TypeTag>
+struct NewtonSequentialTransportIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 3; };
+template<class TypeTag>
+struct NewtonSequentialTolerance<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.0;
+};
+template<class TypeTag>
+struct NewtonSequentialPressureIndex<TypeTag, TTag::NewtonMethod> { static constexpr unsigned value = 0; };
+template<class TypeTag>
+struct NewtonSequentialTransportSolver<TypeTag, TTag::NewtonMethod> { static constexpr auto value = "global"; };
+template<class TypeTag>
+struct NewtonLocalizeActiveFraction<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.0;
+};
+template<class TypeTag>
+struct NewtonLocalizeHaloLayers<TypeTag, TTag::NewtonMethod> { static constexpr int value = 1; };
+template<class TypeTag>
+struct NewtonLocalizeMaxIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 3; };
+template<class TypeTag>
+struct NewtonLocalizeUpdateTolerance<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1e-3;
+};
 
 } // namespace Opm::Properties
 
@@ -125,10 +232,14 @@ class NewtonMethod
     using Linearizer = GetPropType<TypeTag, Properties::Linearizer>;
     using LinearSolverBackend = GetPropType<TypeTag, Properties::LinearSolverBackend>;
     using ConvergenceWriter = GetPropType<TypeTag, Properties::NewtonConvergenceWriter>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
 
     using Communicator = typename Dune::MPIHelper::MPICommunicator;
     using CollectiveCommunication = typename Dune::Communication<typename Dune::MPIHelper::MPICommunicator>;
 
+    enum class ForcingTermStrategy { Fixed, EisenstatWalker1, EisenstatWalker2 };
+    enum class Globalization { None, LineSearch, TrustRegion };
+
 public:
     NewtonMethod(Simulator& simulator)
         : simulator_(simulator)
@@ -136,11 +247,45 @@ public:
         , linearSolver_(simulator)
         , comm_(Dune::MPIHelper::getCommunicator())
         , convergenceWriter_(asImp_())
+        , domainSolver_(simulator)
+        , sequentialSolver_(simulator)
     {
         lastError_ = 1e100;
         error_ = 1e100;
         tolerance_ = Parameters::get<TypeTag, Properties::NewtonTolerance>();
 
+        const std::string forcingTerm = Parameters::get<TypeTag, Properties::NewtonForcingTerm>();
+        if (forcingTerm == "fixed")
+            forcingTermStrategy_ = ForcingTermStrategy::Fixed;
+        else if (forcingTerm == "ew1")
+            forcingTermStrategy_ = ForcingTermStrategy::EisenstatWalker1;
+        else if (forcingTerm == "ew2")
+            forcingTermStrategy_ = ForcingTermStrategy::EisenstatWalker2;
+        else
+            throw std::invalid_argument("Unknown forcing term strategy for the Newton method: '"
+                                        +forcingTerm+"'");
+        forcingTerm_ = Parameters::get<TypeTag, Properties::NewtonMaxForcingTerm>();
+        linearResidualError_ = 0.0;
+
+        const std::string globalization = Parameters::get<TypeTag, Properties::NewtonGlobalization>();
+        if (globalization == "none")
+            globalization_ = Globalization::None;
+        else if (globalization == "linesearch")
+            globalization_ = Globalization::LineSearch;
+        else if (globalization == "trustregion")
+            globalization_ = Globalization::TrustRegion;
+        else
+            throw std::invalid_argument("Unknown globalization strategy for the Newton method: '"
+                                        +globalization+"'");
+        trustRegionRadius_ = 1.0;
+        andersonDepth_ = Parameters::get<TypeTag, Properties::NewtonAndersonDepth>();
+        numJacobianReuses_ = 0;
+        iterationLogFile_ = Parameters::get<TypeTag, Properties::NewtonIterationLogFile>();
+        overlapErrorReduction_ = Parameters::get<TypeTag, Properties::NewtonOverlapErrorReduction>();
+        autoTuneTrials_ = Parameters::get<TypeTag, Properties::NewtonAutoTuneTrials>();
+        autoTuner_.setTrialsPerCandidate(autoTuneTrials_);
+        localizeActiveFraction_ = Parameters::get<TypeTag, Properties::NewtonLocalizeActiveFraction>();
+
         numIterations_ = 0;
     }
 
@@ -157,6 +302,7 @@ public:
         Parameters::registerParam<TypeTag, Properties::NewtonWriteConvergence>
             ("Write the convergence behaviour of the Newton "
              "method to a VTK file");
+        ConvergenceWriter::registerParameters();
         Parameters::registerParam<TypeTag, Properties::NewtonTargetIterations>
             ("The 'optimum' number of Newton iterations per time step");
         Parameters::registerParam<TypeTag, Properties::NewtonMaxIterations>
@@ -167,6 +313,64 @@ public:
         Parameters::registerParam<TypeTag, Properties::NewtonMaxError>
             ("The maximum error tolerated by the Newton "
              "method to which does not cause an abort");
+        Parameters::registerParam<TypeTag, Properties::NewtonForcingTerm>
+            ("The strategy to choose the tolerance of the linear solver in each Newton "
+             "iteration. Possible values: 'fixed', 'ew1' and 'ew2' (Eisenstat-Walker)");
+        Parameters::registerParam<TypeTag, Properties::NewtonMaxForcingTerm>
+            ("The loosest tolerance of the linear solver used by the adaptive forcing "
+             "term strategies of the Newton method");
+        Parameters::registerParam<TypeTag, Properties::NewtonGlobalization>
+            ("The globalization strategy of the Newton method. Possible values: "
+             "'none', 'linesearch' and 'trustregion'");
+        Parameters::registerParam<TypeTag, Properties::NewtonMaxStepCuts>
+            ("The maximum number of times the step length of a Newton iteration is "
+             "halved by the globalization strategy");
+        Parameters::registerParam<TypeTag, Properties::NewtonAndersonDepth>
+            ("The number of previous Newton iterations mixed into the update by "
+             "Anderson acceleration. 0 disables Anderson acceleration");
+        Parameters::registerParam<TypeTag, Properties::NewtonMaxJacobianReuses>
+            ("The maximum number of consecutive Newton iterations which only reassemble "
+             "the residual and reuse the Jacobian matrix and the preconditioner");
+        Parameters::registerParam<TypeTag, Properties::NewtonJacobianReuseReduction>
+            ("The reduction of the error by the previous Newton iteration which is "
+             "required to reuse the Jacobian matrix");
+        Parameters::registerParam<TypeTag, Properties::NewtonIterationLogFile>
+            ("The name of the CSV or JSON file to which the performance data of each "
+             "Newton iteration is written. An empty name disables the recording");
+        Parameters::registerParam<TypeTag, Properties::NewtonOverlapErrorReduction>
+            ("Hand the Jacobian matrix to the linear solver while the error of the "
+             "residual is reduced across the processes");
+        Parameters::registerParam<TypeTag, Properties::NewtonFailurePredictionIterations>
+            ("The number of iterations after which the Newton method gives up if the "
+             "convergence rate predicts that it will not converge within the maximum "
+             "number of iterations. 0 disables the prediction");
+        Parameters::registerParam<TypeTag, Properties::NewtonDivergenceFactor>
+            ("The factor by which the error may grow beyond the error of the first "
+             "iteration before the Newton method gives up. 0 disables the check");
+        Parameters::registerParam<TypeTag, Properties::NewtonStagnationIterations>
+            ("The number of consecutive iterations which reduce the error by less than "
+             "1% after which the Newton method gives up. 0 disables the check");
+        Parameters::registerParam<TypeTag, Properties::NewtonAutoTuneTrials>
+            ("The number of Newton iterations which are timed for each candidate value of "
+             "the settings that are tuned at run time, e.g., the number of threads. The "
+             "fastest values are selected one setting after the other. 0 disables the "
+             "auto-tuning");
+
+        Parameters::registerParam<TypeTag, Properties::NewtonLocalizeActiveFraction>
+            ("The fraction of the cells which did not converge in the last Newton iteration "
+             "below which the following iterations are first done only for these cells and "
+             "their neighbors. 0 disables the localization");
+        Parameters::registerParam<TypeTag, Properties::NewtonLocalizeHaloLayers>
+            ("The number of layers of neighbors which are added to the unconverged cells "
+             "by the localized Newton iterations");
+        Parameters::registerParam<TypeTag, Properties::NewtonLocalizeMaxIterations>
+            ("The maximum number of localized Newton iterations before each global one");
+        Parameters::registerParam<TypeTag, Properties::NewtonLocalizeUpdateTolerance>
+            ("The change of a primary variable relative to its magnitude (but at least 1) "
+             "above which a cell is not considered to be converged by the localization");
+
+        NonlinearDomainSolver<TypeTag>::registerParameters();
+        SequentialImplicitSolver<TypeTag>::registerParameters();
     }
 
     /*!
@@ -240,6 +444,29 @@ public:
     void setTolerance(Scalar value)
     { tolerance_ = value; }
 
+    /*!
+     * \brief Returns a function which updates the primary variables of a single
+     *        degree of freedom in the same way as the Newton method.
+     *
+     * This is intended for local solves which are done outside of the global Newton
+     * iterations, e.g., on sub-domains of the grid.
+     */
+    auto primaryVariablesUpdater()
+    {
+        return [this](unsigned dofIdx,
+                      PrimaryVariables& nextValue,
+                      const PrimaryVariables& currentValue,
+                      const EqVector& update,
+                      const EqVector& currentResidual)
+        {
+            asImp_().updatePrimaryVariables_(dofIdx,
+                                             nextValue,
+                                             currentValue,
+                                             update,
+                                             currentResidual);
+        };
+    }
+
     /*!
      * \brief Run the Newton method.
      *
@@ -248,6 +475,8 @@ public:
      */
     bool apply()
     {
+        EWOMS_PROFILE_REGION("Newton method");
+
         // Clear the current line using an ansi escape
         // sequence.  For an explanation see
         // http://en.wikipedia.org/wiki/ANSI_escape_code
@@ -287,12 +516,72 @@ public:
             while (asImp_().proceed_()) {
                 // linearize the problem at the current solution
 
+                const double linearizeTimeBegin = linearizeTimer_.realTimeElapsed();
+                const double solveTimeBegin = solveTimer_.realTimeElapsed();
+                const double updateTimeBegin = updateTimer_.realTimeElapsed();
+                Timer matrixSetupTimer;
+
+                // decide whether the Jacobian of the last iteration is good enough
+                // for this one. this needs the errors of the last iteration
+                const bool reuseJacobian = asImp_().reuseJacobian_();
+                if (reuseJacobian)
+                    ++numJacobianReuses_;
+                else
+                    numJacobianReuses_ = 0;
+
+                // the linearization and the update of this iteration are timed for the
+                // settings which are currently tried by the auto-tuner. the cheaper
+                // iterations which reuse the Jacobian are not representative.
+                if (autoTuneTrials_ > 0 && !autoTunerInitialized_) {
+                    asImp_().registerTuningKnobs_(autoTuner_);
+                    autoTunerInitialized_ = true;
+                }
+                const bool tuningTrial = autoTuner_.active() && !reuseJacobian;
+                if (tuningTrial)
+                    autoTuner_.beginTrial();
+
                 // notify the implementation that we're about to start
                 // a new iteration
                 prePostProcessTimer_.start();
                 asImp_().beginIteration_();
                 prePostProcessTimer_.stop();
 
+                // solve the sub-domains locally. this needs the global system to be
+                // linearized once in the time step, e.g., for the storage cache
+                if constexpr (hasCellDomainLinearization_()) {
+                    if (domainSolver_.enabled() && numIterations_ > 0) {
+                        updateTimer_.start();
+                        domainSolver_.solve(tolerance(), primaryVariablesUpdater());
+                        updateTimer_.stop();
+                    }
+                }
+
+                // alternate between the pressure and the transport systems. if this
+                // converges, the coupled update of this iteration is skipped
+                bool sequentialConverged = false;
+                if constexpr (hasCellDomainLinearization_()) {
+                    if (sequentialSolver_.enabled()) {
+                        updateTimer_.start();
+                        sequentialConverged = sequentialSolver_.solve(tolerance(), primaryVariablesUpdater());
+                        updateTimer_.stop();
+                        endIterMsg() << ", " << sequentialSolver_.numOuterIterations()
+                                     << " sequential iterations";
+                    }
+                }
+
+                // if only a small part of the cells did not converge in the last
+                // iteration, the work is first restricted to them and their neighbors.
+                // the global iteration then mostly verifies the convergence
+                if constexpr (hasCellDomainLinearization_()) {
+                    if (localizeActiveFraction_ > 0.0 && numIterations_ > 0
+                        && activeFraction_ > 0.0 && activeFraction_ <= localizeActiveFraction_)
+                    {
+                        updateTimer_.start();
+                        solveActiveCells_();
+                        updateTimer_.stop();
+                    }
+                }
+
                 // make the current solution to the old one
                 currentSolution = nextSolution;
 
@@ -304,18 +593,47 @@ public:
 
                 // do the actual linearization
                 linearizeTimer_.start();
-                asImp_().linearizeDomain_();
-                asImp_().linearizeAuxiliaryEquations_();
+                {
+                    EWOMS_PROFILE_REGION("linearize");
+                    HardwareCounters::Phase counterPhase("linearize");
+                    if (reuseJacobian)
+                        asImp_().linearizeResidualOnly_();
+                    else {
+                        asImp_().linearizeDomain_();
+                        asImp_().linearizeAuxiliaryEquations_();
+                    }
+                }
                 linearizeTimer_.stop();
 
                 solveTimer_.start();
                 auto& residual = linearizer.residual();
                 const auto& jacobian = linearizer.jacobian();
-                linearSolver_.prepare(jacobian, residual);
+                matrixSetupTimer.start();
+                if (!reuseJacobian)
+                    linearSolver_.prepare(jacobian, residual);
+                matrixSetupTimer.stop();
                 linearSolver_.setResidual(residual);
                 linearSolver_.getResidual(residual);
                 solveTimer_.stop();
 
+                // start the reduction of the error of the residual. if requested, the
+                // Jacobian is handed to the linear solver while the reduction is in
+                // flight. this costs an unneeded copy of the matrix in the last
+                // iteration, but hides the latency of the reduction in all others.
+                updateTimer_.start();
+                asImp_().startResidualError_(residual);
+                updateTimer_.stop();
+
+                bool matrixIsSet = false;
+                if (!reuseJacobian && overlapErrorReduction_) {
+                    solveTimer_.start();
+                    matrixSetupTimer.start();
+                    linearSolver_.setMatrix(jacobian);
+                    matrixSetupTimer.stop();
+                    solveTimer_.stop();
+                    matrixIsSet = true;
+                }
+
                 // The preSolve_() method usually computes the errors, but it can do
                 // something else in addition. TODO: should its costs be counted to
                 // the linearization or to the update?
@@ -323,7 +641,7 @@ public:
                 asImp_().preSolve_(currentSolution, residual);
                 updateTimer_.stop();
 
-                if (!asImp_().proceed_()) {
+                if (!asImp_().proceed_() || (sequentialConverged && asImp_().converged())) {
                     if (asImp_().verbose_() && isatty(fileno(stdout)))
                         std::cout << clearRemainingLine
                                   << std::flush;
@@ -346,9 +664,25 @@ public:
                 solveTimer_.start();
                 // solve A x = b, where b is the residual, A is its Jacobian and x is the
                 // update of the solution
-                linearSolver_.setMatrix(jacobian);
+                if (forcingTermStrategy_ != ForcingTermStrategy::Fixed)
+                    linearSolver_.setLinearSolverTolerance(asImp_().updateForcingTerm_());
+                // the linear solver keeps the matrix and the preconditioner until
+                // setMatrix() is called the next time
+                matrixSetupTimer.start();
+                if (reuseJacobian)
+                    endIterMsg() << ", reused Jacobian";
+                else if (!matrixIsSet)
+                    linearSolver_.setMatrix(jacobian);
+                matrixSetupTimer.stop();
                 solutionUpdate = 0.0;
-                bool converged = linearSolver_.solve(solutionUpdate);
+                bool converged;
+                {
+                    EWOMS_PROFILE_REGION("linear solve");
+                    HardwareCounters::Phase counterPhase("linear solve");
+                    converged = linearSolver_.solve(solutionUpdate);
+                }
+                if (converged && forcingTermStrategy_ == ForcingTermStrategy::EisenstatWalker1)
+                    linearResidualError_ = asImp_().computeLinearResidualError_(jacobian, residual, solutionUpdate);
                 solveTimer_.stop();
 
                 if (!converged) {
@@ -373,10 +707,21 @@ public:
                 // update the current solution (i.e. uOld) with the delta
                 // (i.e. u). The result is stored in u
                 updateTimer_.start();
-                asImp_().postSolve_(currentSolution,
-                                    residual,
-                                    solutionUpdate);
-                asImp_().update_(nextSolution, currentSolution, solutionUpdate, residual);
+                {
+                    EWOMS_PROFILE_REGION("update");
+                    HardwareCounters::Phase counterPhase("update");
+                    asImp_().postSolve_(currentSolution,
+                                        residual,
+                                        solutionUpdate);
+                    if (andersonDepth_ > 0)
+                        asImp_().andersonMix_(currentSolution, solutionUpdate);
+                    if (globalization_ == Globalization::None)
+                        asImp_().update_(nextSolution, currentSolution, solutionUpdate, residual);
+                    else
+                        asImp_().globalizedUpdate_(nextSolution, currentSolution, solutionUpdate, residual);
+                    if (localizeActiveFraction_ > 0.0)
+                        updateActiveCells_(residual, currentSolution, solutionUpdate);
+                }
                 updateTimer_.stop();
 
                 if (asImp_().verbose_() && isatty(fileno(stdout)))
@@ -384,6 +729,35 @@ public:
                     std::cout << clearRemainingLine
                               << std::flush;
 
+                if (!iterationLogFile_.empty()) {
+                    NewtonIterationLog::Record record;
+                    record.timeStepIdx = simulator_.timeStepIndex();
+                    record.iterationIdx = numIterations_;
+                    record.error = error_;
+                    record.linearTolerance =
+                        forcingTermStrategy_ == ForcingTermStrategy::Fixed
+                        ? Parameters::get<TypeTag, Properties::LinearSolverTolerance>()
+                        : forcingTerm_;
+                    record.linearIterations = static_cast<int>(linearSolver_.iterations());
+                    record.reusedJacobian = reuseJacobian;
+                    record.linearizeTime = linearizeTimer_.realTimeElapsed() - linearizeTimeBegin;
+                    record.matrixSetupTime = matrixSetupTimer.realTimeElapsed();
+                    record.linearSolveTime =
+                        solveTimer_.realTimeElapsed() - solveTimeBegin - record.matrixSetupTime;
+                    record.updateTime = updateTimer_.realTimeElapsed() - updateTimeBegin;
+                    iterationLog_.add(record);
+                }
+
+                // the slowest process determines the time of the trial, which makes all
+                // processes select the same settings
+                if (tuningTrial) {
+                    const double trialTime =
+                        comm_.max(linearizeTimer_.realTimeElapsed() - linearizeTimeBegin
+                                  + updateTimer_.realTimeElapsed() - updateTimeBegin);
+                    if (autoTuner_.endTrial(trialTime) && !autoTuner_.active() && verbose_())
+                        autoTuner_.report(std::cout);
+                }
+
                 // tell the implementation that we're done with this iteration
                 prePostProcessTimer_.start();
                 asImp_().endIteration_(nextSolution, currentSolution);
@@ -523,6 +897,33 @@ public:
     const Timer& updateTimer() const
     { return updateTimer_; }
 
+    /*!
+     * \brief Returns the performance data of the Newton iterations recorded so far.
+     *
+     * Iterations are only recorded if the NewtonIterationLogFile parameter is set.
+     */
+    const NewtonIterationLog& iterationLog() const
+    { return iterationLog_; }
+
+    /*!
+     * \brief Write the recorded performance data of the Newton iterations.
+     *
+     * Each process writes its own records to the file given by the
+     * NewtonIterationLogFile parameter. If the Newton method is verbose, the rank 0
+     * also prints the minimum, maximum and average times of the stages of the Newton
+     * iterations over all processes. This method is collective and it does nothing if
+     * the parameter is not set.
+     */
+    void writeIterationLog() const
+    {
+        if (iterationLogFile_.empty())
+            return;
+
+        iterationLog_.write(iterationLogFile_, comm_.rank(), comm_.size());
+        if (Parameters::get<TypeTag, Properties::NewtonVerbose>())
+            iterationLog_.printSummary(comm_, std::cout);
+    }
+
 protected:
     /*!
      * \brief Returns true if the Newton method ought to be chatty.
@@ -541,11 +942,43 @@ protected:
     void begin_(const SolutionVector&)
     {
         numIterations_ = 0;
+        numStagnatedIterations_ = 0;
+        forcingTerm_ = Parameters::get<TypeTag, Properties::NewtonMaxForcingTerm>();
+        trustRegionRadius_ = 1.0;
+        andersonDeltaX_.clear();
+        andersonDeltaF_.clear();
+        andersonLastF_.resize(0);
+        activeFraction_ = 1.0;
 
         if (Parameters::get<TypeTag, Properties::NewtonWriteConvergence>())
             convergenceWriter_.beginTimeStep();
     }
 
+    /*!
+     * \brief Register the settings which are tuned at run time.
+     *
+     * This is called before the first Newton iteration if the auto-tuning is enabled.
+     * By default, the number of threads and the settings of the model and its
+     * linearizer are tuned. The linear solver always uses the number of threads which
+     * is selected for the linearization.
+     */
+    void registerTuningKnobs_(AutoTuner& tuner)
+    {
+#ifdef _OPENMP
+        std::vector<int> numThreads;
+        std::vector<std::string> labels;
+        for (int n = static_cast<int>(ThreadManager::maxThreads()); n >= 1 && numThreads.size() < 3; n /= 2) {
+            numThreads.push_back(n);
+            labels.push_back(std::to_string(n));
+        }
+        tuner.addKnob("ThreadsPerProcess", std::move(labels),
+                      [numThreads](std::size_t idx) { omp_set_num_threads(numThreads[idx]); },
+                      /*initialIdx=*/0);
+#endif
+
+        tuner.addKnobsFrom(model());
+    }
+
     /*!
      * \brief Indicates the beginning of a Newton iteration.
      */
@@ -589,34 +1022,63 @@ protected:
         model().linearizer().finalize();
     }
 
+    /*!
+     * \brief Evaluate the residual of the global non-linear system of equations
+     *        without updating the Jacobian matrix.
+     *
+     * Linearizers which do not provide a residual-only assembly are fully
+     * linearized.
+     */
+    void linearizeResidualOnly_()
+    { assembleResidual_(model().linearizer(), /*preferResidualOnly=*/0); }
+
+    /*!
+     * \brief Returns true if the current iteration should reuse the Jacobian matrix
+     *        and the preconditioner of the last one.
+     *
+     * This requires the residual-only assembly of the linearizer and is only done if
+     * the last iteration reduced the error by at least the NewtonJacobianReuseReduction
+     * factor, i.e., the method falls back to the full linearization as soon as the
+     * convergence rate degrades. Auxiliary equations are linearized together with the
+     * Jacobian, so models which use them always relinearize.
+     */
+    bool reuseJacobian_() const
+    {
+        if (!hasResidualOnlyAssembly_())
+            return false;
+
+        const int maxReuses = Parameters::get<TypeTag, Properties::NewtonMaxJacobianReuses>();
+        if (numJacobianReuses_ >= maxReuses || numIterations_ < 2)
+            return false;
+
+        if (model().numAuxiliaryModules() > 0)
+            return false;
+
+        const Scalar reduction = Parameters::get<TypeTag, Properties::NewtonJacobianReuseReduction>();
+        return error_ <= reduction*lastError_;
+    }
+
     void preSolve_(const SolutionVector&,
                    const GlobalEqVector& currentResidual)
     {
-        const auto& constraintsMap = model().linearizer().constraintsMap();
         lastError_ = error_;
         Scalar newtonMaxError = Parameters::get<TypeTag, Properties::NewtonMaxError>();
 
         // calculate the error as the maximum weighted tolerance of
-        // the solution's residual
-        error_ = 0;
-        for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
-            // do not consider auxiliary DOFs for the error
-            if (dofIdx >= model().numGridDof() || model().dofTotalVolume(dofIdx) <= 0.0)
-                continue;
-
-            // also do not consider DOFs which are constraint
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0)
-                    continue;
-            }
-
-            const auto& r = currentResidual[dofIdx];
-            for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
-                error_ = max(std::abs(r[eqIdx] * model().eqWeight(dofIdx, eqIdx)), error_);
+        // the solution's residual. usually, its reduction has already been started
+        // by startResidualError_()
+        if (errorReductionPending_) {
+            error_ = errorFuture_.get();
+            errorReductionPending_ = false;
         }
-
-        // take the other processes into account
-        error_ = comm_.max(error_);
+        else
+            error_ = residualError_(currentResidual);
+        if (numIterations_ == 0)
+            initialError_ = error_;
+        else if (error_ > 0.99*lastError_)
+            ++numStagnatedIterations_;
+        else
+            numStagnatedIterations_ = 0;
 
         // make sure that the error never grows beyond the maximum
         // allowed one
@@ -626,6 +1088,147 @@ protected:
                                    + std::to_string(double(newtonMaxError)));
     }
 
+    /*!
+     * \brief Compute the error of a residual vector.
+     *
+     * The error is the maximum of the weighted residual over all equations of the
+     * non-auxiliary and unconstrained degrees of freedom of all processes.
+     */
+    Scalar residualError_(const GlobalEqVector& residual) const
+    { return comm_.max(asImp_().localResidualError_(residual)); }
+
+    /*!
+     * \brief Start the non-blocking reduction of the error of a residual vector.
+     *
+     * The result is picked up by the next call to preSolve_(). This must be called on
+     * all processes.
+     */
+    void startResidualError_(const GlobalEqVector& residual)
+    {
+        errorFuture_ = comm_.template iallreduce<Dune::Max<Scalar>>(asImp_().localResidualError_(residual));
+        errorReductionPending_ = true;
+    }
+
+    /*!
+     * \brief Compute the error of a residual vector on the local process.
+     *
+     * Models which define the error differently only need to override this method.
+     */
+    Scalar localResidualError_(const GlobalEqVector& residual) const
+    {
+        const auto& constraintsMap = model().linearizer().constraintsMap();
+        const int numDof = static_cast<int>(residual.size());
+
+        Scalar result = 0.0;
+        bool hasNonFiniteResidual = false;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Scalar threadResult = 0.0;
+            bool threadHasNonFiniteResidual = false;
+#ifdef _OPENMP
+#pragma omp for nowait
+#endif
+            for (int dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+                // do not consider auxiliary DOFs for the error
+                if (static_cast<std::size_t>(dofIdx) >= model().numGridDof()
+                    || model().dofTotalVolume(dofIdx) <= 0.0)
+                    continue;
+
+                // also do not consider DOFs which are constraint
+                if (enableConstraints_()) {
+                    if (constraintsMap.count(dofIdx) > 0)
+                        continue;
+                }
+
+                const auto& r = residual[dofIdx];
+                for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx) {
+                    const Scalar weightedResidual = std::abs(r[eqIdx] * model().eqWeight(dofIdx, eqIdx));
+                    if (!std::isfinite(weightedResidual))
+                        threadHasNonFiniteResidual = true;
+                    threadResult = max(weightedResidual, threadResult);
+                }
+            }
+
+#ifdef _OPENMP
+#pragma omp critical (NewtonMethod_localResidualError)
+#endif
+            {
+                result = max(threadResult, result);
+                hasNonFiniteResidual = hasNonFiniteResidual || threadHasNonFiniteResidual;
+            }
+        }
+
+        // the maximum does not propagate NaNs reliably, so non-finite residuals are
+        // reported as an infinite error. this way, all processes notice them using the
+        // same reduction.
+        if (hasNonFiniteResidual)
+            result = std::numeric_limits<Scalar>::infinity();
+
+        return result;
+    }
+
+    /*!
+     * \brief Compute the forcing term of the current iteration, i.e., the reduction of
+     *        the residual which the linear solver needs to achieve.
+     *
+     * This implements the choices 1 and 2 of Eisenstat and Walker including their
+     * safeguards against too small forcing terms. The result is limited by the
+     * NewtonMaxForcingTerm parameter from above and by the LinearSolverTolerance
+     * parameter from below. The errors of the current and the last iteration are
+     * computed by preSolve_().
+     */
+    Scalar updateForcingTerm_()
+    {
+        const Scalar maxForcingTerm = Parameters::get<TypeTag, Properties::NewtonMaxForcingTerm>();
+        const Scalar minForcingTerm = Parameters::get<TypeTag, Properties::LinearSolverTolerance>();
+
+        const Scalar lastForcingTerm = forcingTerm_;
+        if (numIterations_ == 0 || lastError_ <= 0.0)
+            forcingTerm_ = maxForcingTerm;
+        else if (forcingTermStrategy_ == ForcingTermStrategy::EisenstatWalker1) {
+            // eta_k = | ||F(x_k)|| - ||F(x_k-1) + J(x_k-1) s_k-1|| | / ||F(x_k-1)||
+            forcingTerm_ = std::abs(error_ - linearResidualError_)/lastError_;
+
+            const Scalar safeguard = std::pow(lastForcingTerm, (1.0 + std::sqrt(5.0))/2.0);
+            if (safeguard > 0.1)
+                forcingTerm_ = std::max(forcingTerm_, safeguard);
+        }
+        else {
+            // eta_k = gamma (||F(x_k)|| / ||F(x_k-1)||)^alpha
+            const Scalar gamma = 0.9;
+            const Scalar alpha = 2.0;
+            forcingTerm_ = gamma*std::pow(error_/lastError_, alpha);
+
+            const Scalar safeguard = gamma*std::pow(lastForcingTerm, alpha);
+            if (safeguard > 0.1)
+                forcingTerm_ = std::max(forcingTerm_, safeguard);
+        }
+
+        forcingTerm_ = std::max(minForcingTerm, std::min(maxForcingTerm, forcingTerm_));
+        endIterMsg() << ", linear tolerance: " << forcingTerm_;
+        return forcingTerm_;
+    }
+
+    /*!
+     * \brief Compute the error of the linearized system of equations for a solution
+     *        of the linear solver.
+     *
+     * The error is defined in the same way as by residualError_(), but for the residual of
+     * the linear system of equations, i.e., \f$ r - J \Delta u \f$.
+     */
+    template <class Jacobian>
+    Scalar computeLinearResidualError_(const Jacobian& jacobian,
+                                       const GlobalEqVector& currentResidual,
+                                       const GlobalEqVector& solutionUpdate)
+    {
+        GlobalEqVector linearResidual(currentResidual);
+        jacobian.istlMatrix().mmv(solutionUpdate, linearResidual);
+
+        return residualError_(linearResidual);
+    }
+
     /*!
      * \brief Update the error of the solution given the previous
      *        iteration.
@@ -697,10 +1300,18 @@ protected:
         if (!std::isfinite(solutionUpdate.one_norm()))
             throw NumericalProblem("Non-finite update!");
 
-        size_t numGridDof = model().numGridDof();
+        // the degrees of freedom are only distributed over the threads if the
+        // implementation allows to update them concurrently. exceptions are passed on
+        // after the loop, see FvBaseLinearizer::linearize_() for the rationale.
+        const unsigned numGridDof = static_cast<unsigned>(model().numGridDof());
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr;
+#ifdef _OPENMP
+#pragma omp parallel for if (Implementation::threadSafeUpdate_())
+#endif
         for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0) {
+            try {
+                if (enableConstraints_() && constraintsMap.count(dofIdx) > 0) {
                     const auto& constraints = constraintsMap.at(dofIdx);
                     asImp_().updateConstraintDof_(dofIdx,
                                                   nextSolution[dofIdx],
@@ -713,14 +1324,15 @@ protected:
                                                      solutionUpdate[dofIdx],
                                                      currentResidual[dofIdx]);
             }
-            else
-                asImp_().updatePrimaryVariables_(dofIdx,
-                                                 nextSolution[dofIdx],
-                                                 currentSolution[dofIdx],
-                                                 solutionUpdate[dofIdx],
-                                                 currentResidual[dofIdx]);
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+            }
         }
 
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
         // update the DOFs of the auxiliary equations
         size_t numDof = model().numTotalDof();
         for (size_t dofIdx = numGridDof; dofIdx < numDof; ++dofIdx) {
@@ -729,6 +1341,243 @@ protected:
         }
     }
 
+    /*!
+     * \brief Mix the updates of the previous iterations into the current one using
+     *        Anderson acceleration.
+     *
+     * The Newton iteration is considered as the fixed-point iteration \f$ x^{k+1} =
+     * x^k + f^k \f$ with \f$ f^k = -\Delta u^k \f$. Given the differences \f$\Delta
+     * X\f$ and \f$\Delta F\f$ of the solutions and of the fixed-point residuals of the
+     * last NewtonAndersonDepth iterations, the coefficients \f$\gamma\f$ minimize
+     * \f$\| f^k - \Delta F \gamma \|\f$ in the norm given by the weights of the
+     * primary variables and the update becomes \f$ \Delta u^k + (\Delta X + \Delta F)
+     * \gamma \f$. The history is discarded whenever the error grows, e.g., after the
+     * meaning of the primary variables was switched.
+     *
+     * \param currentSolution The solution vector after the last iteration
+     * \param solutionUpdate The delta vector as calculated by solving the linear system
+     *                       of equations. It is replaced by the mixed update.
+     */
+    void andersonMix_(const SolutionVector& currentSolution,
+                      GlobalEqVector& solutionUpdate)
+    {
+        GlobalEqVector f(solutionUpdate);
+        f *= -1.0;
+
+        if (andersonLastF_.size() == f.size() && error_ <= lastError_) {
+            GlobalEqVector deltaF(f);
+            deltaF -= andersonLastF_;
+            GlobalEqVector deltaX(andersonLastX_);
+            for (unsigned dofIdx = 0; dofIdx < deltaX.size(); ++dofIdx) {
+                deltaX[dofIdx] *= -1.0;
+                deltaX[dofIdx] += currentSolution[dofIdx];
+            }
+
+            andersonDeltaF_.push_back(std::move(deltaF));
+            andersonDeltaX_.push_back(std::move(deltaX));
+            if (static_cast<int>(andersonDeltaF_.size()) > andersonDepth_) {
+                andersonDeltaF_.pop_front();
+                andersonDeltaX_.pop_front();
+            }
+        }
+        else {
+            andersonDeltaF_.clear();
+            andersonDeltaX_.clear();
+        }
+
+        andersonLastF_ = f;
+        andersonLastX_.resize(currentSolution.size());
+        for (unsigned dofIdx = 0; dofIdx < currentSolution.size(); ++dofIdx)
+            andersonLastX_[dofIdx] = currentSolution[dofIdx];
+
+        const std::size_t numVectors = andersonDeltaF_.size();
+        if (numVectors == 0)
+            return;
+
+        // solve the normal equations of the least squares problem. they are slightly
+        // regularized because the differences tend to become linearly dependent
+        Dune::DynamicMatrix<Scalar> normalMatrix(numVectors, numVectors);
+        Dune::DynamicVector<Scalar> rhs(numVectors);
+        Dune::DynamicVector<Scalar> gamma(numVectors);
+        for (std::size_t i = 0; i < numVectors; ++i) {
+            rhs[i] = weightedDot_(andersonDeltaF_[i], f);
+            for (std::size_t j = 0; j <= i; ++j) {
+                normalMatrix[i][j] = weightedDot_(andersonDeltaF_[i], andersonDeltaF_[j]);
+                normalMatrix[j][i] = normalMatrix[i][j];
+            }
+        }
+
+        Scalar maxDiag = 0.0;
+        for (std::size_t i = 0; i < numVectors; ++i)
+            maxDiag = std::max(maxDiag, normalMatrix[i][i]);
+        if (!(maxDiag > 0.0))
+            return;
+        for (std::size_t i = 0; i < numVectors; ++i)
+            normalMatrix[i][i] += 1e-10*maxDiag;
+
+        try {
+            normalMatrix.solve(gamma, rhs);
+        }
+        catch (const Dune::FMatrixError&) {
+            andersonDeltaF_.clear();
+            andersonDeltaX_.clear();
+            return;
+        }
+
+        for (std::size_t i = 0; i < numVectors; ++i) {
+            solutionUpdate.axpy(gamma[i], andersonDeltaX_[i]);
+            solutionUpdate.axpy(gamma[i], andersonDeltaF_[i]);
+        }
+
+        endIterMsg() << ", Anderson depth: " << numVectors;
+    }
+
+    /*!
+     * \brief The scalar product used by Anderson acceleration.
+     *
+     * The primary variables are weighted by primaryVarWeight() and only the
+     * non-auxiliary degrees of freedom of the local process are considered.
+     */
+    Scalar weightedDot_(const GlobalEqVector& a, const GlobalEqVector& b) const
+    {
+        Scalar result = 0.0;
+        for (unsigned dofIdx = 0; dofIdx < model().numGridDof(); ++dofIdx) {
+            if (!model().isLocalDof(dofIdx))
+                continue;
+
+            for (unsigned pvIdx = 0; pvIdx < a[dofIdx].size(); ++pvIdx) {
+                const Scalar weight = model().primaryVarWeight(dofIdx, pvIdx);
+                result += weight*weight*a[dofIdx][pvIdx]*b[dofIdx][pvIdx];
+            }
+        }
+
+        return comm_.sum(result);
+    }
+
+    /*!
+     * \brief Update the current solution with a fraction of the delta vector which is
+     *        chosen by the globalization strategy.
+     *
+     * Trial steps are applied using update_(), i.e., including the model-specific
+     * chopping, and are evaluated by a residual-only assembly if the linearizer
+     * supports it. A trial step with the step length \f$\lambda\f$ is accepted if it
+     * reduces the error by at least a small fraction of the reduction \f$\lambda
+     * \epsilon\f$ predicted by the linearization. Otherwise, the line search halves
+     * the step length, while the trust-region mode shrinks its radius according to the
+     * ratio of the actual and the predicted reductions. The radius of the trust region
+     * is also enlarged after successful steps and it is kept across the iterations of a
+     * time step. If no acceptable step is found within NewtonMaxStepCuts attempts, the
+     * last trial step is used.
+     *
+     * \param nextSolution The solution vector after the current iteration
+     * \param currentSolution The solution vector after the last iteration
+     * \param solutionUpdate The delta vector as calculated by solving the linear system
+     *                       of equations
+     * \param currentResidual The residual vector of the current Newton-Raphson iteraton
+     */
+    void globalizedUpdate_(SolutionVector& nextSolution,
+                           const SolutionVector& currentSolution,
+                           const GlobalEqVector& solutionUpdate,
+                           const GlobalEqVector& currentResidual)
+    {
+        const int maxStepCuts = Parameters::get<TypeTag, Properties::NewtonMaxStepCuts>();
+        const Scalar sufficientDecrease = 1e-4;
+
+        // evaluating the trial steps overwrites the residual of the linearizer
+        const GlobalEqVector residual(currentResidual);
+        GlobalEqVector scaledUpdate(solutionUpdate);
+
+        Scalar stepLength = 1.0;
+        if (globalization_ == Globalization::TrustRegion)
+            stepLength = std::min<Scalar>(1.0, trustRegionRadius_);
+
+        for (int cutIdx = 0;; ++cutIdx) {
+            if (stepLength < 1.0) {
+                scaledUpdate = solutionUpdate;
+                scaledUpdate *= stepLength;
+            }
+            asImp_().update_(nextSolution, currentSolution, scaledUpdate, residual);
+
+            const Scalar predictedReduction = stepLength*error_;
+            const Scalar actualReduction = error_ - asImp_().trialError_();
+            const bool accepted = actualReduction >= sufficientDecrease*predictedReduction;
+
+            if (globalization_ == Globalization::TrustRegion) {
+                const Scalar ratio = actualReduction/predictedReduction;
+                if (!(ratio >= 0.25))
+                    trustRegionRadius_ = stepLength/2;
+                else if (ratio > 0.75)
+                    trustRegionRadius_ = std::min<Scalar>(1.0, 2*stepLength);
+            }
+
+            if (accepted || cutIdx >= maxStepCuts)
+                break;
+
+            stepLength /= 2;
+        }
+
+        if (stepLength < 1.0)
+            endIterMsg() << ", step length: " << stepLength;
+    }
+
+    /*!
+     * \brief Return the error of the residual for the current solution of the model.
+     *
+     * If the residual cannot be evaluated, e.g., because the trial solution is not
+     * physically meaningful, the error is infinite.
+     */
+    Scalar trialError_()
+    {
+        bool succeeded = true;
+        try {
+            asImp_().prepareTrialEvaluation_();
+        }
+        catch (const std::exception& e) {
+            succeeded = false;
+
+            std::cout << "rank " << simulator_.gridView().comm().rank()
+                      << " caught an exception while preparing a trial step:" << e.what()
+                      << "\n"  << std::flush;
+        }
+
+        succeeded = comm_.min(succeeded);
+
+        if (!succeeded)
+            return std::numeric_limits<Scalar>::infinity();
+
+        try {
+            asImp_().linearizeResidualOnly_();
+        }
+        catch (const NumericalProblem&) {
+            return std::numeric_limits<Scalar>::infinity();
+        }
+
+        auto& residual = model().linearizer().residual();
+        linearSolver_.setResidual(residual);
+        linearSolver_.getResidual(residual);
+
+        return residualError_(residual);
+    }
+
+    /*!
+     * \brief Called before the residual for a trial step is evaluated.
+     *
+     * Discretizations can override this to make the model consistent with the trial
+     * solution, e.g., to synchronize the overlap.
+     */
+    void prepareTrialEvaluation_()
+    { }
+
+    /*!
+     * \brief Returns true if updatePrimaryVariables_() may be called concurrently for
+     *        different degrees of freedom.
+     *
+     * This is the case if the method only writes the primary variables of the given
+     * degree of freedom and only reads shared data.
+     */
+    static constexpr bool threadSafeUpdate_()
+    { return false; }
+
     /*!
      * \brief Update the primary variables for a degree of freedom which is constraint.
      */
@@ -821,10 +1670,64 @@ protected:
             // the maximum number of steps
             return error_ * 4.0 < lastError_;
         }
+        else if (asImp_().diverged_()) {
+            // there is no point in continuing this time step
+            return false;
+        }
+        else if (asImp_().predictsFailure_()) {
+            // cut the time step now instead of wasting the remaining iterations
+            return false;
+        }
 
         return true;
     }
 
+    /*!
+     * \brief Returns true if the Newton method is considered to have diverged.
+     *
+     * This is the case if the error grew by more than the NewtonDivergenceFactor
+     * beyond the error of the first iteration, or if the error stagnated for
+     * NewtonStagnationIterations consecutive iterations. Non-finite residuals are
+     * already caught by residualError_(). Since the errors are global quantities, all
+     * processes come to the same conclusion without additional communication.
+     */
+    bool diverged_() const
+    {
+        const Scalar divergenceFactor = Parameters::get<TypeTag, Properties::NewtonDivergenceFactor>();
+        if (divergenceFactor > 0.0 && error_ > divergenceFactor*initialError_)
+            return true;
+
+        const int maxStagnatedIterations = Parameters::get<TypeTag, Properties::NewtonStagnationIterations>();
+        return maxStagnatedIterations > 0 && numStagnatedIterations_ >= maxStagnatedIterations;
+    }
+
+    /*!
+     * \brief Returns true if the Newton method is not expected to converge within the
+     *        maximum number of iterations.
+     *
+     * The prediction extrapolates the reduction of the error by the last iteration,
+     * i.e., it assumes linear convergence. Since this underestimates the speed of a
+     * Newton method close to the solution, the prediction is only made after a number
+     * of iterations given by the NewtonFailurePredictionIterations parameter. The
+     * errors are global quantities, so all processes come to the same conclusion.
+     */
+    bool predictsFailure_() const
+    {
+        const int minIterations = Parameters::get<TypeTag, Properties::NewtonFailurePredictionIterations>();
+        if (minIterations <= 0 || numIterations_ < minIterations)
+            return false;
+
+        if (!std::isfinite(error_))
+            return true;
+
+        const Scalar rate = error_/lastError_;
+        if (!(rate < 1.0))
+            return true;
+
+        const Scalar remainingIterations = std::log(tolerance()/error_)/std::log(rate);
+        return numIterations_ + remainingIterations > asImp_().maxIterations_();
+    }
+
     /*!
      * \brief Indicates that we're done solving the non-linear system
      *        of equations.
@@ -873,6 +1776,36 @@ protected:
     Scalar error_;
     Scalar lastError_;
     Scalar tolerance_;
+    // the error of the first iteration and the number of consecutive iterations which
+    // did not reduce the error noticeably
+    Scalar initialError_ = 0.0;
+    int numStagnatedIterations_ = 0;
+
+    // the strategy to choose the tolerance of the linear solver, the forcing term of
+    // the current iteration and the error of the last linear solution
+    ForcingTermStrategy forcingTermStrategy_;
+    Scalar forcingTerm_;
+    Scalar linearResidualError_;
+
+    // the globalization strategy and the radius of the trust region as a fraction of
+    // the full Newton step
+    Globalization globalization_;
+    Scalar trustRegionRadius_;
+
+    // the history of Anderson acceleration: the differences of the solutions and of
+    // the fixed-point residuals of the last iterations
+    int andersonDepth_;
+    std::deque<GlobalEqVector> andersonDeltaX_;
+    std::deque<GlobalEqVector> andersonDeltaF_;
+    GlobalEqVector andersonLastX_;
+    GlobalEqVector andersonLastF_;
+
+    // the number of consecutive iterations which reused the Jacobian matrix
+    int numJacobianReuses_;
+
+    // the performance data of the Newton iterations and the file it is written to
+    std::string iterationLogFile_;
+    NewtonIterationLog iterationLog_;
 
     // actual number of iterations done so far
     int numIterations_;
@@ -884,11 +1817,152 @@ protected:
     // or MPI)
     CollectiveCommunication comm_;
 
+    // the non-blocking reduction of the error of the current residual
+    using ErrorFuture =
+        decltype(std::declval<const CollectiveCommunication&>()
+                 .template iallreduce<Dune::Max<Scalar>>(std::declval<Scalar>()));
+    ErrorFuture errorFuture_;
+    bool errorReductionPending_ = false;
+    bool overlapErrorReduction_;
+
+    // selects the fastest values of the run-time settings during the first iterations
+    AutoTuner autoTuner_;
+    unsigned autoTuneTrials_;
+    bool autoTunerInitialized_ = false;
+
     // the object which writes the convergence behaviour of the Newton
     // method to disk
     ConvergenceWriter convergenceWriter_;
 
+    // the local solves of the non-linear domain decomposition
+    NonlinearDomainSolver<TypeTag> domainSolver_;
+
+    // the pressure and transport iterations of the sequential implicit scheme
+    SequentialImplicitSolver<TypeTag> sequentialSolver_;
+
+    // the localization of the Newton iterations: the threshold of the fraction of
+    // unconverged cells, the cells which did not converge in the last iteration and
+    // their fraction over all processes
+    Scalar localizeActiveFraction_ = 0.0;
+    std::vector<unsigned char> activeCells_;
+    Scalar activeFraction_ = 1.0;
+
 private:
+    // mark the cells whose weighted residual before the update or whose update is
+    // above the tolerance as not converged
+    void updateActiveCells_(const GlobalEqVector& residual,
+                            const SolutionVector& currentSolution,
+                            const GlobalEqVector& solutionUpdate)
+    {
+        const unsigned numDof = model().numGridDof();
+        const Scalar updateTolerance = Parameters::get<TypeTag, Properties::NewtonLocalizeUpdateTolerance>();
+        activeCells_.resize(numDof);
+
+        std::size_t numActive = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:numActive)
+#endif
+        for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+            const auto& r = residual[dofIdx];
+            const bool hasVolume = model().dofTotalVolume(dofIdx) > 0.0;
+            bool active = false;
+            for (unsigned eqIdx = 0; eqIdx < r.size() && !active; ++eqIdx) {
+                const Scalar scale = std::max<Scalar>(1.0, std::abs(currentSolution[dofIdx][eqIdx]));
+                active = (hasVolume && std::abs(r[eqIdx]*model().eqWeight(dofIdx, eqIdx)) > tolerance_)
+                    || std::abs(solutionUpdate[dofIdx][eqIdx]) > updateTolerance*scale;
+            }
+            activeCells_[dofIdx] = active;
+            numActive += active;
+        }
+
+        const Scalar totalActive = comm_.sum(static_cast<Scalar>(numActive));
+        const Scalar totalDof = comm_.sum(static_cast<Scalar>(numDof));
+        activeFraction_ = totalDof > 0.0 ? totalActive/totalDof : 0.0;
+    }
+
+    // do Newton iterations which are restricted to the cells that did not converge in
+    // the last iteration and a few layers of their neighbors, while the solution of
+    // all other cells is kept fixed. this uses the local solves of the non-linear
+    // domain decomposition. the intensive quantities are only updated for the cells
+    // of the restricted domain.
+    void solveActiveCells_()
+    {
+        const auto& jacobian = model().linearizer().jacobian().istlMatrix();
+        const unsigned numDof = model().numGridDof();
+        const int numHaloLayers = Parameters::get<TypeTag, Properties::NewtonLocalizeHaloLayers>();
+
+        typename NonlinearDomainSolver<TypeTag>::Domain domain;
+        std::vector<unsigned char> inDomain(activeCells_);
+        std::vector<int> front;
+        for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            if (activeCells_[dofIdx])
+                front.push_back(static_cast<int>(dofIdx));
+        domain.cells = front;
+
+        std::vector<int> nextFront;
+        for (int layerIdx = 0; layerIdx < numHaloLayers; ++layerIdx) {
+            nextFront.clear();
+            for (int dofIdx : front) {
+                const auto& row = jacobian[dofIdx];
+                for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                    if (colIt.index() >= numDof || inDomain[colIt.index()])
+                        continue;
+                    inDomain[colIt.index()] = 1;
+                    nextFront.push_back(static_cast<int>(colIt.index()));
+                }
+            }
+            domain.cells.insert(domain.cells.end(), nextFront.begin(), nextFront.end());
+            front.swap(nextFront);
+        }
+
+        if (domain.cells.empty())
+            return;
+
+        std::sort(domain.cells.begin(), domain.cells.end());
+        domain.interior.assign(domain.cells.size(), true);
+
+        auto localMatrix = domainSolver_.createLocalMatrix(domain);
+        const int maxIterations = Parameters::get<TypeTag, Properties::NewtonLocalizeMaxIterations>();
+        domainSolver_.solveDomain(domain, *localMatrix, tolerance(), maxIterations,
+                                  primaryVariablesUpdater());
+        endIterMsg() << ", " << domainSolver_.numLocalIterations() << " localized iterations for "
+                     << domain.cells.size() << " cells";
+    }
+
+    // use the residual-only assembly of the linearizer if it provides one, and a full
+    // linearization otherwise
+    template <class LinearizerType>
+    static auto assembleResidual_(LinearizerType& linearizer, int)
+        -> decltype(linearizer.linearizeResidual())
+    { linearizer.linearizeResidual(); }
+
+    template <class LinearizerType>
+    static void assembleResidual_(LinearizerType& linearizer, long)
+    { linearizer.linearizeDomain(); }
+
+    template <class LinearizerType>
+    static auto detectResidualOnlyAssembly_(int)
+        -> decltype(std::declval<LinearizerType&>().linearizeResidual(), std::true_type{});
+
+    template <class LinearizerType>
+    static std::false_type detectResidualOnlyAssembly_(long);
+
+    static constexpr bool hasResidualOnlyAssembly_()
+    { return decltype(detectResidualOnlyAssembly_<Linearizer>(0))::value; }
+
+    // the non-linear domain decomposition and the sequential implicit iterations
+    // require a linearizer which accepts sub-domains that are given by their cells,
+    // i.e., one which exposes its Jacobian matrix as an ISTL matrix
+    template <class LinearizerType>
+    static auto detectCellDomainLinearization_(int)
+        -> decltype(std::declval<typename LinearizerType::CellDomain&>().cells, std::true_type{});
+
+    template <class LinearizerType>
+    static std::false_type detectCellDomainLinearization_(long);
+
+    static constexpr bool hasCellDomainLinearization_()
+    { return decltype(detectCellDomainLinearization_<Linearizer>(0))::value; }
+
     Implementation& asImp_()
     { return *static_cast<Implementation *>(this); }
     const Implementation& asImp_() const
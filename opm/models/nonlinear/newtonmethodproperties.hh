@@ -48,6 +48,11 @@ struct NewtonConvergenceWriter { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct NewtonWriteConvergence { using type = UndefinedProperty; };
 
+//! The number of Newton iterations of each time step for which the convergence
+//! behaviour is not written
+template<class TypeTag, class MyTypeTag>
+struct NewtonWriteConvergenceAfter { using type = UndefinedProperty; };
+
 //! Specifies whether the convergence rate and the global residual
 //! gets written out to disk for every Newton iteration
 template<class TypeTag, class MyTypeTag>
@@ -82,6 +87,157 @@ struct NewtonTargetIterations { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct NewtonMaxIterations { using type = UndefinedProperty; };
 
+/*!
+ * \brief The strategy used to choose the tolerance of the linear solver in each
+ *        Newton iteration.
+ *
+ * Possible values are 'fixed' (always use the LinearSolverTolerance parameter),
+ * 'ew1' and 'ew2' (the forcing terms of Eisenstat and Walker, choice 1 and 2).
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonForcingTerm { using type = UndefinedProperty; };
+
+//! The largest forcing term, i.e., the loosest tolerance of the linear solver, used by
+//! the adaptive forcing term strategies. This is also used for the first iteration.
+template<class TypeTag, class MyTypeTag>
+struct NewtonMaxForcingTerm { using type = UndefinedProperty; };
+
+/*!
+ * \brief The globalization strategy of the Newton method.
+ *
+ * Possible values are 'none' (always apply the full Newton step), 'linesearch'
+ * (back-tracking line search on the weighted residual error) and 'trustregion' (limit
+ * the step length by a trust region which is adapted using the ratio of the actual and
+ * the predicted reduction of the error).
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonGlobalization { using type = UndefinedProperty; };
+
+//! The maximum number of times the step length of a Newton iteration is halved by the
+//! globalization strategy before the last trial step is accepted.
+template<class TypeTag, class MyTypeTag>
+struct NewtonMaxStepCuts { using type = UndefinedProperty; };
+
+//! The number of previous iterations which are mixed into the update by Anderson
+//! acceleration. A value of 0 disables Anderson acceleration.
+template<class TypeTag, class MyTypeTag>
+struct NewtonAndersonDepth { using type = UndefinedProperty; };
+
+//! The maximum number of consecutive Newton iterations which reuse the Jacobian matrix
+//! and the preconditioner of an earlier iteration. A value of 0 relinearizes the
+//! system of equations in every iteration.
+template<class TypeTag, class MyTypeTag>
+struct NewtonMaxJacobianReuses { using type = UndefinedProperty; };
+
+//! The factor by which the error must be reduced by the previous iteration so that
+//! the next iteration may reuse the Jacobian matrix.
+template<class TypeTag, class MyTypeTag>
+struct NewtonJacobianReuseReduction { using type = UndefinedProperty; };
+
+//! The name of the file to which the performance data of each Newton iteration is
+//! written at the end of the simulation. An empty name disables the recording.
+template<class TypeTag, class MyTypeTag>
+struct NewtonIterationLogFile { using type = UndefinedProperty; };
+
+//! Hand the Jacobian matrix to the linear solver while the error of the residual is
+//! reduced across the processes
+template<class TypeTag, class MyTypeTag>
+struct NewtonOverlapErrorReduction { using type = UndefinedProperty; };
+
+//! The number of iterations after which the Newton method is aborted if the
+//! convergence rate of the last iteration predicts that the tolerance will not be
+//! reached within the maximum number of iterations. A value of 0 disables the
+//! prediction.
+template<class TypeTag, class MyTypeTag>
+struct NewtonFailurePredictionIterations { using type = UndefinedProperty; };
+
+//! The factor by which the error may grow beyond the error of the first iteration
+//! before the Newton method is aborted. A value of 0 disables the check.
+template<class TypeTag, class MyTypeTag>
+struct NewtonDivergenceFactor { using type = UndefinedProperty; };
+
+//! The number of consecutive iterations which reduce the error by less than 1% after
+//! which the Newton method is aborted. A value of 0 disables the check.
+template<class TypeTag, class MyTypeTag>
+struct NewtonStagnationIterations { using type = UndefinedProperty; };
+
+//! The number of Newton iterations which are timed for each candidate value of the
+//! settings that are tuned at run time. A value of 0 disables the auto-tuning.
+template<class TypeTag, class MyTypeTag>
+struct NewtonAutoTuneTrials { using type = UndefinedProperty; };
+
+//! The number of sub-domains which are solved locally before each global Newton
+//! iteration. A value of 0 disables the non-linear domain decomposition.
+template<class TypeTag, class MyTypeTag>
+struct NewtonNlddNumDomains { using type = UndefinedProperty; };
+
+//! The maximum number of local Newton iterations for each sub-domain.
+template<class TypeTag, class MyTypeTag>
+struct NewtonNlddMaxIterations { using type = UndefinedProperty; };
+
+//! The maximum error tolerated by the local solves of the sub-domains. A value of 0
+//! uses the tolerance of the global Newton method.
+template<class TypeTag, class MyTypeTag>
+struct NewtonNlddTolerance { using type = UndefinedProperty; };
+
+/*!
+ * \brief The way in which the local solves of the sub-domains are combined.
+ *
+ * Possible values are 'multiplicative' (the sub-domains are solved one after the
+ * other using the latest solution of their neighbors) and 'additive' (all sub-domains
+ * start from the same solution).
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonNlddSchwarz { using type = UndefinedProperty; };
+
+//! The maximum number of sequential implicit (pressure and transport) iterations before
+//! each global Newton iteration. A value of 0 disables the sequential implicit iterations.
+template<class TypeTag, class MyTypeTag>
+struct NewtonSequentialMaxIterations { using type = UndefinedProperty; };
+
+//! The maximum number of Newton iterations of the transport system in each sequential
+//! implicit iteration.
+template<class TypeTag, class MyTypeTag>
+struct NewtonSequentialTransportIterations { using type = UndefinedProperty; };
+
+//! The maximum error tolerated by the sequential implicit iterations. A value of 0 uses
+//! the tolerance of the global Newton method.
+template<class TypeTag, class MyTypeTag>
+struct NewtonSequentialTolerance { using type = UndefinedProperty; };
+
+//! The index of the primary variable which is updated by the pressure step of the
+//! sequential implicit iterations.
+template<class TypeTag, class MyTypeTag>
+struct NewtonSequentialPressureIndex { using type = UndefinedProperty; };
+
+/*!
+ * \brief The solver of the transport system of the sequential implicit iterations.
+ *
+ * Possible values are 'global' (a linear solve for all cells) and 'ordered' (a
+ * non-linear Gauss-Seidel method which solves the cells in upwind order).
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonSequentialTransportSolver { using type = UndefinedProperty; };
+
+//! The fraction of the cells which did not converge yet below which the Newton
+//! iterations are localized to these cells. A value of 0 disables the localization.
+template<class TypeTag, class MyTypeTag>
+struct NewtonLocalizeActiveFraction { using type = UndefinedProperty; };
+
+//! The number of layers of neighbors which are added to the unconverged cells by the
+//! localized Newton iterations.
+template<class TypeTag, class MyTypeTag>
+struct NewtonLocalizeHaloLayers { using type = UndefinedProperty; };
+
+//! The maximum number of localized Newton iterations before each global iteration.
+template<class TypeTag, class MyTypeTag>
+struct NewtonLocalizeMaxIterations { using type = UndefinedProperty; };
+
+//! The change of a primary variable relative to its magnitude (but at least 1) above
+//! which a cell is not considered to be converged.
+template<class TypeTag, class MyTypeTag>
+struct NewtonLocalizeUpdateTolerance { using type = UndefinedProperty; };
+
 } // end namespace  Opm::Properties
 
 #endif
@@ -0,0 +1,401 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::NonlinearDomainSolver
+ */
+#ifndef EWOMS_NONLINEAR_DOMAIN_SOLVER_HH
+#define EWOMS_NONLINEAR_DOMAIN_SOLVER_HH
+
+#include "newtonmethodproperties.hh"
+
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvers.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup Newton
+ *
+ * \brief Solves the non-linear system of equations approximately on sub-domains of
+ *        the grid before each global Newton iteration.
+ *
+ * The degrees of freedom of the grid are split into contiguous blocks of indices.
+ * For each of these sub-domains, a few Newton iterations are done while the solution
+ * outside of the sub-domain is kept fixed: the sub-domain is linearized by
+ * linearizeDomain() of the linearizer and the resulting local system is solved by a
+ * BiCGSTAB solver with an ILU(0) preconditioner. The sub-domains are either processed
+ * one after the other using the latest solution of their neighbors (multiplicative
+ * Schwarz) or all of them start from the same solution and their results are only
+ * combined at the end (additive Schwarz). The subsequent global Newton iteration then
+ * acts as the coarse correction.
+ *
+ * The sub-domains are processed sequentially since they share the residual, the
+ * Jacobian matrix and the intensive quantities of the model. The threads are used
+ * within the linearization and the update of the intensive quantities of each
+ * sub-domain instead. This requires a linearizer which accepts sub-domains given by
+ * their cells, i.e., the TpfaLinearizer, and an element-centered discretization.
+ */
+template <class TypeTag>
+class NonlinearDomainSolver
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
+    using EqVector = GetPropType<TypeTag, Properties::EqVector>;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+
+    using LocalVector = Dune::BlockVector<Dune::FieldVector<Scalar, numEq>>;
+
+    enum class Schwarz { Multiplicative, Additive };
+
+public:
+    using LocalMatrix = Dune::BCRSMatrix<Dune::FieldMatrix<Scalar, numEq, numEq>>;
+
+    //! A sub-domain in the format which is expected by the linearizer
+    struct Domain
+    {
+        std::vector<int> cells;
+        std::vector<bool> interior;
+    };
+
+    explicit NonlinearDomainSolver(Simulator& simulator)
+        : simulator_(simulator)
+    {
+        numDomains_ = Parameters::get<TypeTag, Properties::NewtonNlddNumDomains>();
+        maxIterations_ = Parameters::get<TypeTag, Properties::NewtonNlddMaxIterations>();
+        tolerance_ = Parameters::get<TypeTag, Properties::NewtonNlddTolerance>();
+
+        const std::string schwarz = Parameters::get<TypeTag, Properties::NewtonNlddSchwarz>();
+        if (schwarz == "multiplicative")
+            schwarz_ = Schwarz::Multiplicative;
+        else if (schwarz == "additive")
+            schwarz_ = Schwarz::Additive;
+        else
+            throw std::invalid_argument("Unknown Schwarz method for the non-linear domain "
+                                        "decomposition: '"+schwarz+"'");
+    }
+
+    /*!
+     * \brief Register all run-time parameters of the non-linear domain decomposition.
+     */
+    static void registerParameters()
+    {
+        Parameters::registerParam<TypeTag, Properties::NewtonNlddNumDomains>
+            ("The number of sub-domains which are solved locally before each global "
+             "Newton iteration. 0 disables the non-linear domain decomposition");
+        Parameters::registerParam<TypeTag, Properties::NewtonNlddMaxIterations>
+            ("The maximum number of Newton iterations for each sub-domain");
+        Parameters::registerParam<TypeTag, Properties::NewtonNlddTolerance>
+            ("The maximum error tolerated by the local solves of the sub-domains. "
+             "A value of 0 uses the tolerance of the Newton method");
+        Parameters::registerParam<TypeTag, Properties::NewtonNlddSchwarz>
+            ("The way in which the local solves of the sub-domains are combined. "
+             "Possible values: 'multiplicative' and 'additive'");
+    }
+
+    /*!
+     * \brief Returns true if the non-linear domain decomposition is used.
+     */
+    bool enabled() const
+    { return numDomains_ > 0; }
+
+    /*!
+     * \brief Returns the number of local Newton iterations done by the last call to
+     *        solve() or solveDomain(), summed over all sub-domains.
+     */
+    int numLocalIterations() const
+    { return numLocalIterations_; }
+
+    /*!
+     * \brief Solve the sub-domains for the current solution of the model.
+     *
+     * The intensive quantities of the model must be up to date for the current
+     * solution and the global system must have been linearized at least once in the
+     * current time step. On return, the solution and the intensive quantities of the
+     * model contain the result of the local solves while the residual and the Jacobian
+     * matrix of the linearizer are in an undefined state.
+     *
+     * \param tolerance The tolerance of the Newton method
+     * \param updatePrimaryVariables The function which applies the update of the
+     *        primary variables of a degree of freedom, i.e., the one of the Newton method
+     */
+    template <class UpdateFn>
+    void solve(Scalar tolerance, UpdateFn&& updatePrimaryVariables)
+    {
+        if (domains_.empty())
+            setupDomains_();
+
+        numLocalIterations_ = 0;
+        const Scalar localTolerance = tolerance_ > 0.0 ? tolerance_ : tolerance;
+
+        auto& solution = simulator_.model().solution(/*timeIdx=*/0);
+        if (schwarz_ == Schwarz::Additive)
+            startSolution_ = solution;
+
+        for (unsigned domainIdx = 0; domainIdx < domains_.size(); ++domainIdx) {
+            solveDomain_(domainIdx, localTolerance, updatePrimaryVariables);
+
+            if (schwarz_ == Schwarz::Additive) {
+                // keep the result of the sub-domain and let the other sub-domains see
+                // the solution at the start of the iteration
+                const auto& cells = domains_[domainIdx].cells;
+                for (int globI : cells) {
+                    additiveSolution_[globI] = solution[globI];
+                    solution[globI] = startSolution_[globI];
+                }
+                simulator_.model().updateIntensiveQuantitiesOfDofs(cells, /*timeIdx=*/0);
+            }
+        }
+
+        if (schwarz_ == Schwarz::Additive) {
+            for (const auto& domain : domains_)
+                for (int globI : domain.cells)
+                    solution[globI] = additiveSolution_[globI];
+            simulator_.model().invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0,
+                                                                      simulator_.gridView());
+        }
+    }
+
+    /*!
+     * \brief Create a matrix for the local system of equations of a sub-domain.
+     *
+     * The sparsity pattern is the one of the global Jacobian matrix restricted to the
+     * cells of the sub-domain, i.e., the global system must have been linearized before.
+     */
+    std::unique_ptr<LocalMatrix> createLocalMatrix(const Domain& domain)
+    {
+        const auto& model = simulator_.model();
+        const auto& cells = domain.cells;
+        localIndex_.resize(model.numTotalDof(), -1);
+        for (std::size_t localI = 0; localI < cells.size(); ++localI)
+            localIndex_[cells[localI]] = static_cast<int>(localI);
+
+        const auto& jacobian = model.linearizer().jacobian().istlMatrix();
+        auto localMatrix = std::make_unique<LocalMatrix>(cells.size(), cells.size(),
+                                                         LocalMatrix::row_wise);
+        for (auto rowIt = localMatrix->createbegin(); rowIt != localMatrix->createend(); ++rowIt) {
+            const auto& row = jacobian[cells[rowIt.index()]];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                if (localIndex_[colIt.index()] >= 0)
+                    rowIt.insert(localIndex_[colIt.index()]);
+        }
+
+        for (int globI : cells)
+            localIndex_[globI] = -1;
+
+        return localMatrix;
+    }
+
+    /*!
+     * \brief Solve the non-linear system of equations of a single sub-domain while the
+     *        solution outside of it is kept fixed.
+     *
+     * In contrast to solve(), this also checks whether the last of the local Newton
+     * iterations converged, which requires an additional linearization of the
+     * sub-domain. Returns true if the error of the sub-domain is below the tolerance.
+     *
+     * \param domain The cells of the sub-domain
+     * \param localMatrix A matrix created by createLocalMatrix() for the sub-domain
+     * \param tolerance The maximum error tolerated for the sub-domain
+     * \param maxIterations The maximum number of local Newton iterations
+     * \param updatePrimaryVariables The function which applies the update of the
+     *        primary variables of a degree of freedom
+     */
+    template <class UpdateFn>
+    bool solveDomain(const Domain& domain,
+                     LocalMatrix& localMatrix,
+                     Scalar tolerance,
+                     int maxIterations,
+                     UpdateFn&& updatePrimaryVariables)
+    {
+        numLocalIterations_ = 0;
+        return solveDomain_(domain, localMatrix, tolerance, maxIterations,
+                            /*verifyLastIteration=*/true, updatePrimaryVariables);
+    }
+
+private:
+    // split the degrees of freedom of the grid into contiguous blocks of indices and
+    // create the local matrices with the sparsity pattern of the global Jacobian
+    void setupDomains_()
+    {
+        const auto& model = simulator_.model();
+        const std::size_t numDof = model.numGridDof();
+        const std::size_t numDomains = std::min<std::size_t>(numDomains_, numDof);
+
+        domains_.resize(numDomains);
+        localMatrices_.resize(numDomains);
+        for (std::size_t domainIdx = 0; domainIdx < numDomains; ++domainIdx) {
+            const std::size_t dofBegin = domainIdx*numDof/numDomains;
+            const std::size_t dofEnd = (domainIdx + 1)*numDof/numDomains;
+            auto& domain = domains_[domainIdx];
+            for (std::size_t dofIdx = dofBegin; dofIdx < dofEnd; ++dofIdx)
+                domain.cells.push_back(static_cast<int>(dofIdx));
+            domain.interior.assign(domain.cells.size(), true);
+
+            localMatrices_[domainIdx] = createLocalMatrix(domain);
+        }
+
+        if (schwarz_ == Schwarz::Additive)
+            additiveSolution_ = model.solution(/*timeIdx=*/0);
+    }
+
+    template <class UpdateFn>
+    void solveDomain_(unsigned domainIdx, Scalar tolerance, UpdateFn& updatePrimaryVariables)
+    {
+        solveDomain_(domains_[domainIdx], *localMatrices_[domainIdx], tolerance,
+                     maxIterations_, /*verifyLastIteration=*/false, updatePrimaryVariables);
+    }
+
+    // do local Newton iterations for a sub-domain. If 'verifyLastIteration' is false,
+    // the solution is not linearized again after the last iteration, i.e., false is
+    // returned if the maximum number of iterations is reached even if the last one
+    // converged.
+    template <class UpdateFn>
+    bool solveDomain_(const Domain& domain,
+                      LocalMatrix& localMatrix,
+                      Scalar tolerance,
+                      int maxIterations,
+                      bool verifyLastIteration,
+                      UpdateFn& updatePrimaryVariables)
+    {
+        auto& model = simulator_.model();
+        auto& linearizer = model.linearizer();
+        auto& solution = model.solution(/*timeIdx=*/0);
+        const std::size_t numCells = domain.cells.size();
+
+        LocalVector localResidual(numCells);
+        LocalVector localUpdate(numCells);
+        for (int iterIdx = 0; ; ++iterIdx) {
+            if (iterIdx == maxIterations && !verifyLastIteration)
+                return false;
+
+            linearizer.linearizeDomain(domain);
+
+            const auto& residual = linearizer.residual();
+            if (domainError_(domain, residual) <= tolerance)
+                return true;
+            if (iterIdx == maxIterations)
+                return false;
+
+            // extract the local system of equations
+            const auto& jacobian = linearizer.jacobian().istlMatrix();
+            for (std::size_t localI = 0; localI < numCells; ++localI) {
+                const int globI = domain.cells[localI];
+                localResidual[localI] = residual[globI];
+
+                const auto& globalRow = jacobian[globI];
+                auto& localRow = localMatrix[localI];
+                for (auto colIt = localRow.begin(); colIt != localRow.end(); ++colIt)
+                    *colIt = globalRow[domain.cells[colIt.index()]];
+            }
+
+            Dune::MatrixAdapter<LocalMatrix, LocalVector, LocalVector> op(localMatrix);
+            Dune::SeqILU<LocalMatrix, LocalVector, LocalVector> preconditioner(localMatrix, 1.0);
+            Dune::BiCGSTABSolver<LocalVector> linearSolver(op, preconditioner,
+                                                           /*reduction=*/1e-3,
+                                                           /*maxIterations=*/100,
+                                                           /*verbose=*/0);
+            Dune::InverseOperatorResult result;
+            localUpdate = 0.0;
+            linearSolver.apply(localUpdate, localResidual, result);
+
+            for (std::size_t localI = 0; localI < numCells; ++localI) {
+                const int globI = domain.cells[localI];
+                EqVector update;
+                EqVector dofResidual;
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                    update[eqIdx] = localUpdate[localI][eqIdx];
+                    dofResidual[eqIdx] = residual[globI][eqIdx];
+                }
+
+                const PrimaryVariables currentValue = solution[globI];
+                updatePrimaryVariables(static_cast<unsigned>(globI),
+                                       solution[globI],
+                                       currentValue,
+                                       update,
+                                       dofResidual);
+            }
+
+            model.updateIntensiveQuantitiesOfDofs(domain.cells, /*timeIdx=*/0);
+            ++numLocalIterations_;
+        }
+    }
+
+    // the weighted maximum norm of the residual of a sub-domain like the one used by
+    // the Newton method
+    template <class GlobalEqVector>
+    Scalar domainError_(const Domain& domain, const GlobalEqVector& residual) const
+    {
+        const auto& model = simulator_.model();
+        Scalar result = 0.0;
+        for (int globI : domain.cells) {
+            if (model.dofTotalVolume(globI) <= 0.0)
+                continue;
+
+            const auto& r = residual[globI];
+            for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
+                result = std::max<Scalar>(std::abs(r[eqIdx]*model.eqWeight(globI, eqIdx)), result);
+        }
+        return result;
+    }
+
+    Simulator& simulator_;
+
+    int numDomains_;
+    int maxIterations_;
+    Scalar tolerance_;
+    Schwarz schwarz_;
+    int numLocalIterations_ = 0;
+
+    std::vector<Domain> domains_;
+    std::vector<std::unique_ptr<LocalMatrix>> localMatrices_;
+    // the index of each degree of freedom within the sub-domain for which the local
+    // matrix is created, -1 for all degrees of freedom outside of it
+    std::vector<int> localIndex_;
+
+    GetPropType<TypeTag, Properties::SolutionVector> startSolution_;
+    GetPropType<TypeTag, Properties::SolutionVector> additiveSolution_;
+};
+
+} // namespace Opm
+
+#endif
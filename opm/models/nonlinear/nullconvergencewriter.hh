@@ -58,6 +58,12 @@ public:
     NullConvergenceWriter(NewtonMethod&)
     {}
 
+    /*!
+     * \brief Register all run-time parameters of the convergence writer.
+     */
+    static void registerParameters()
+    {}
+
     /*!
      * \brief Called by the Newton method before the actual algorithm
      *        is started for any given timestep.
@@ -0,0 +1,734 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::SequentialImplicitSolver
+ */
+#ifndef EWOMS_SEQUENTIAL_IMPLICIT_SOLVER_HH
+#define EWOMS_SEQUENTIAL_IMPLICIT_SOLVER_HH
+
+#include "newtonmethodproperties.hh"
+
+#include <opm/common/Exceptions.hpp>
+
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvers.hh>
+#include <dune/istl/paamg/amg.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup Newton
+ *
+ * \brief Solves the non-linear system of equations by alternating between a pressure
+ *        and a transport system before each global Newton iteration.
+ *
+ * Each outer iteration of this sequential fully implicit scheme consists of
+ *
+ * - a pressure step: the system linearized by the linearizer is reduced to a pressure
+ *   equation per cell using quasi-IMPES weights, i.e., the weights \f$ w_i \f$ of cell
+ *   i solve \f$ J_{ii}^T w_i = e_p \f$. The resulting scalar system is solved by an
+ *   AMG preconditioned BiCGSTAB solver and only the pressure is updated.
+ * - a few transport steps: the system is linearized again and solved for the
+ *   remaining primary variables while the pressure is kept fixed. For this, the
+ *   equation of each cell which dominates its pressure equation is replaced by the
+ *   constraint that the pressure does not change, and the resulting system is solved
+ *   by BiCGSTAB with an ILU(0) preconditioner. Alternatively, the transport system
+ *   is solved by an ordered non-linear Gauss-Seidel method, see below.
+ *
+ * The outer iterations stop once the error of the coupled system is below the
+ * tolerance. The subsequent global Newton iteration then corrects the remaining
+ * coupling between pressure and transport, or is skipped if the outer iterations
+ * converged. Keeping the pressure instead of the total velocity fixed in the transport
+ * step makes the scheme independent of the flux functions of the model.
+ *
+ * The ordered transport solver sorts the cells topologically by the upwind graph of the
+ * transport system: a cell depends on a neighbor if the derivatives of its equations
+ * with regard to the transport variables of the neighbor are significant, which for
+ * the upwinded TPFA fluxes is the case for the upstream neighbors only. The strongly
+ * connected components of this graph, e.g., cells with counter-current flow, are
+ * found by Tarjan's algorithm, which also yields them in upwind order. Each
+ * component is then solved by a few local Newton iterations, for which the
+ * linearizer only linearizes the cells of the component, while the upstream cells
+ * already have their new values. Single cells are solved directly, larger components
+ * by BiCGSTAB with an ILU(0) preconditioner.
+ *
+ * Like the non-linear domain decomposition, this requires a linearizer which exposes
+ * the Jacobian matrix as an ISTL matrix, i.e., the TpfaLinearizer, and the systems are
+ * solved for the local part of the grid of each process.
+ */
+template <class TypeTag>
+class SequentialImplicitSolver
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
+    using EqVector = GetPropType<TypeTag, Properties::EqVector>;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+
+    using Block = Dune::FieldMatrix<Scalar, numEq, numEq>;
+    using VectorBlock = Dune::FieldVector<Scalar, numEq>;
+    using TransportMatrix = Dune::BCRSMatrix<Block>;
+    using TransportVector = Dune::BlockVector<VectorBlock>;
+    using PressureMatrix = Dune::BCRSMatrix<Dune::FieldMatrix<Scalar, 1, 1>>;
+    using PressureVector = Dune::BlockVector<Dune::FieldVector<Scalar, 1>>;
+
+    using PressureOperator = Dune::MatrixAdapter<PressureMatrix, PressureVector, PressureVector>;
+    using PressureSmoother = Dune::SeqSSOR<PressureMatrix, PressureVector, PressureVector>;
+    using PressureAmg = Dune::Amg::AMG<PressureOperator, PressureVector, PressureSmoother>;
+
+    // the linear solvers of the sub-problems only need to be roughly accurate because
+    // the outer iterations and the global Newton method correct their errors
+    static constexpr Scalar linearReduction = 1e-3;
+    static constexpr int maxLinearIterations = 200;
+
+    // the ordered transport solver: the maximum number of Newton iterations for each
+    // component, and the size of the derivatives with regard to a neighbor relative
+    // to the ones with regard to the cell itself below which the neighbor is not
+    // considered to be upstream. the weak couplings, e.g. by capillary pressure, are
+    // handled by repeating the sweeps in the transport iterations.
+    static constexpr int maxComponentIterations = 10;
+    static constexpr Scalar upwindThreshold = 1e-3;
+
+    //! A sub-domain in the format which is expected by the linearizer
+    struct Domain
+    {
+        std::vector<int> cells;
+        std::vector<bool> interior;
+    };
+
+public:
+    explicit SequentialImplicitSolver(Simulator& simulator)
+        : simulator_(simulator)
+    {
+        maxIterations_ = Parameters::get<TypeTag, Properties::NewtonSequentialMaxIterations>();
+        transportIterations_ = Parameters::get<TypeTag, Properties::NewtonSequentialTransportIterations>();
+        tolerance_ = Parameters::get<TypeTag, Properties::NewtonSequentialTolerance>();
+        pressureVarIdx_ = Parameters::get<TypeTag, Properties::NewtonSequentialPressureIndex>();
+
+        const std::string transportSolver = Parameters::get<TypeTag, Properties::NewtonSequentialTransportSolver>();
+        if (transportSolver == "global")
+            orderedTransport_ = false;
+        else if (transportSolver == "ordered")
+            orderedTransport_ = true;
+        else
+            throw std::invalid_argument("Unknown transport solver for the sequential implicit "
+                                        "iterations: '"+transportSolver+"'");
+
+        if (pressureVarIdx_ >= numEq)
+            throw std::invalid_argument("The index of the pressure variable of the sequential "
+                                        "implicit iterations is out of range");
+    }
+
+    /*!
+     * \brief Register all run-time parameters of the sequential implicit iterations.
+     */
+    static void registerParameters()
+    {
+        Parameters::registerParam<TypeTag, Properties::NewtonSequentialMaxIterations>
+            ("The maximum number of sequential implicit (pressure and transport) iterations "
+             "before each global Newton iteration. 0 disables the sequential implicit iterations");
+        Parameters::registerParam<TypeTag, Properties::NewtonSequentialTransportIterations>
+            ("The maximum number of Newton iterations of the transport system in each "
+             "sequential implicit iteration");
+        Parameters::registerParam<TypeTag, Properties::NewtonSequentialTolerance>
+            ("The maximum error tolerated by the sequential implicit iterations. A value of "
+             "0 uses the tolerance of the Newton method");
+        Parameters::registerParam<TypeTag, Properties::NewtonSequentialPressureIndex>
+            ("The index of the primary variable which is updated by the pressure step of "
+             "the sequential implicit iterations");
+        Parameters::registerParam<TypeTag, Properties::NewtonSequentialTransportSolver>
+            ("The solver of the transport system of the sequential implicit iterations. "
+             "Possible values: 'global' (linear solve for all cells) and 'ordered' "
+             "(non-linear Gauss-Seidel in upwind order)");
+    }
+
+    /*!
+     * \brief Returns true if the sequential implicit iterations are used.
+     */
+    bool enabled() const
+    { return maxIterations_ > 0; }
+
+    /*!
+     * \brief Returns the number of outer iterations done by the last call to solve().
+     */
+    int numOuterIterations() const
+    { return numOuterIterations_; }
+
+    /*!
+     * \brief Do sequential implicit iterations for the current solution of the model.
+     *
+     * The intensive quantities of the model must be up to date for the current
+     * solution. On return, the solution and the intensive quantities of the model
+     * contain the result of the iterations while the residual and the Jacobian matrix
+     * of the linearizer are in an undefined state. Returns true if the error of the
+     * coupled system is below the tolerance.
+     *
+     * \param tolerance The tolerance of the Newton method
+     * \param updatePrimaryVariables The function which applies the update of the
+     *        primary variables of a degree of freedom, i.e., the one of the Newton method
+     */
+    template <class UpdateFn>
+    bool solve(Scalar tolerance, UpdateFn&& updatePrimaryVariables)
+    {
+        auto& linearizer = simulator_.model().linearizer();
+        const Scalar outerTolerance = tolerance_ > 0.0 ? tolerance_ : tolerance;
+
+        numOuterIterations_ = 0;
+        for (int iterIdx = 0; ; ++iterIdx) {
+            linearizer.linearizeDomain();
+            if (iterIdx == 0)
+                setupMatrices_();
+
+            computeWeights_();
+            if (error_(/*transportOnly=*/false) <= outerTolerance)
+                return true;
+            if (iterIdx == maxIterations_)
+                return false;
+
+            pressureStep_(updatePrimaryVariables);
+
+            for (int transportIdx = 0; transportIdx < transportIterations_; ++transportIdx) {
+                linearizer.linearizeDomain();
+                computeWeights_();
+                if (transportIdx > 0 && error_(/*transportOnly=*/true) <= outerTolerance)
+                    break;
+
+                if (orderedTransport_)
+                    orderedTransportStep_(outerTolerance, updatePrimaryVariables);
+                else
+                    transportStep_(updatePrimaryVariables);
+            }
+
+            ++numOuterIterations_;
+        }
+    }
+
+private:
+    // create the pressure and the transport matrices with the sparsity pattern of the
+    // Jacobian matrix restricted to the degrees of freedom of the grid. this is done
+    // once per call of solve() since the pattern of the Jacobian may change between
+    // time steps.
+    void setupMatrices_()
+    {
+        const auto& jacobian = simulator_.model().linearizer().jacobian().istlMatrix();
+        const std::size_t numRows = simulator_.model().numGridDof();
+
+        pressureMatrix_ = std::make_unique<PressureMatrix>(numRows, numRows,
+                                                           PressureMatrix::row_wise);
+        transportMatrix_ = std::make_unique<TransportMatrix>(numRows, numRows,
+                                                             TransportMatrix::row_wise);
+        auto transportRowIt = transportMatrix_->createbegin();
+        for (auto rowIt = pressureMatrix_->createbegin(); rowIt != pressureMatrix_->createend(); ++rowIt) {
+            const auto& row = jacobian[rowIt.index()];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                if (colIt.index() < numRows) {
+                    rowIt.insert(colIt.index());
+                    transportRowIt.insert(colIt.index());
+                }
+            }
+            ++transportRowIt;
+        }
+
+        weights_.resize(numRows);
+        constraintEqIdx_.resize(numRows);
+        localIndex_.assign(numRows, -1);
+        pressureResidual_.resize(numRows);
+        pressureUpdate_.resize(numRows);
+        transportResidual_.resize(numRows);
+        transportUpdate_.resize(numRows);
+    }
+
+    // compute the quasi-IMPES weights of the pressure equations and select the
+    // equation of each cell which is replaced by the constraint of the transport system
+    void computeWeights_()
+    {
+        const auto& jacobian = simulator_.model().linearizer().jacobian().istlMatrix();
+        const std::size_t numRows = weights_.size();
+
+        VectorBlock unitPressure(0.0);
+        unitPressure[pressureVarIdx_] = 1.0;
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            const auto& row = jacobian[rowIdx];
+            const auto diagIt = row.find(rowIdx);
+            if (diagIt == row.end())
+                throw NumericalProblem("The sequential implicit iterations require diagonal blocks");
+
+            Block diagTransposed;
+            for (int i = 0; i < numEq; ++i)
+                for (int j = 0; j < numEq; ++j)
+                    diagTransposed[i][j] = (*diagIt)[j][i];
+            diagTransposed.solve(weights_[rowIdx], unitPressure);
+
+            unsigned constraintEqIdx = 0;
+            for (unsigned eqIdx = 1; eqIdx < numEq; ++eqIdx)
+                if (std::abs(weights_[rowIdx][eqIdx]) > std::abs(weights_[rowIdx][constraintEqIdx]))
+                    constraintEqIdx = eqIdx;
+            constraintEqIdx_[rowIdx] = constraintEqIdx;
+        }
+    }
+
+    // solve the pressure system of the current linearization and update the pressure
+    template <class UpdateFn>
+    void pressureStep_(UpdateFn& updatePrimaryVariables)
+    {
+        const auto& linearizer = simulator_.model().linearizer();
+        const auto& jacobian = linearizer.jacobian().istlMatrix();
+        const auto& residual = linearizer.residual();
+        const std::size_t numRows = weights_.size();
+
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            const auto& row = jacobian[rowIdx];
+            const auto& w = weights_[rowIdx];
+            // the pattern of the pressure row is the one of the Jacobian row without
+            // the columns of the auxiliary degrees of freedom
+            auto pressureColIt = (*pressureMatrix_)[rowIdx].begin();
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                if (colIt.index() >= numRows)
+                    continue;
+                Scalar value = 0.0;
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    value += w[eqIdx]*(*colIt)[eqIdx][pressureVarIdx_];
+                *pressureColIt = value;
+                ++pressureColIt;
+            }
+
+            Scalar rhs = 0.0;
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                rhs += w[eqIdx]*residual[rowIdx][eqIdx];
+            pressureResidual_[rowIdx] = rhs;
+        }
+
+        using SmootherArgs = typename Dune::Amg::SmootherTraits<PressureSmoother>::Arguments;
+        SmootherArgs smootherArgs;
+        smootherArgs.iterations = 1;
+        smootherArgs.relaxationFactor = 1.0;
+
+        using CoarsenCriterion = Dune::Amg::
+            CoarsenCriterion<Dune::Amg::SymmetricCriterion<PressureMatrix, Dune::Amg::FirstDiagonal> >;
+        CoarsenCriterion coarsenCriterion(/*maxLevel=*/15, /*coarsenTarget=*/1200);
+        coarsenCriterion.setDefaultValuesIsotropic(/*dim=*/3, /*aggregateSizePerDim=*/2);
+        coarsenCriterion.setDebugLevel(0);
+        coarsenCriterion.setMinCoarsenRate(1.05);
+        coarsenCriterion.setAccumulate(Dune::Amg::atOnceAccu);
+        coarsenCriterion.setSkipIsolated(false);
+
+        PressureOperator op(*pressureMatrix_);
+        PressureAmg amg(op, coarsenCriterion, smootherArgs);
+        Dune::BiCGSTABSolver<PressureVector> linearSolver(op, amg,
+                                                          linearReduction,
+                                                          maxLinearIterations,
+                                                          /*verbose=*/0);
+        Dune::InverseOperatorResult result;
+        pressureUpdate_ = 0.0;
+        linearSolver.apply(pressureUpdate_, pressureResidual_, result);
+
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            EqVector update(0.0);
+            update[pressureVarIdx_] = pressureUpdate_[rowIdx][0];
+            applyUpdate_(static_cast<unsigned>(rowIdx), update, residual[rowIdx],
+                         updatePrimaryVariables);
+        }
+
+        simulator_.model().invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0,
+                                                                  simulator_.gridView());
+    }
+
+    // solve the transport system of the current linearization at fixed pressure and
+    // update the remaining primary variables
+    template <class UpdateFn>
+    void transportStep_(UpdateFn& updatePrimaryVariables)
+    {
+        const auto& linearizer = simulator_.model().linearizer();
+        const auto& jacobian = linearizer.jacobian().istlMatrix();
+        const auto& residual = linearizer.residual();
+        const std::size_t numRows = weights_.size();
+
+        // the pressure columns are dropped and the constraint equation of each cell
+        // is replaced by the condition that the pressure does not change
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            const auto& row = jacobian[rowIdx];
+            auto transportColIt = (*transportMatrix_)[rowIdx].begin();
+            const unsigned constraintEqIdx = constraintEqIdx_[rowIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                if (colIt.index() >= numRows)
+                    continue;
+                *transportColIt = *colIt;
+                constrainBlock_(*transportColIt, constraintEqIdx, colIt.index() == rowIdx);
+                ++transportColIt;
+            }
+
+            transportResidual_[rowIdx] = residual[rowIdx];
+            transportResidual_[rowIdx][constraintEqIdx] = 0.0;
+        }
+
+        Dune::MatrixAdapter<TransportMatrix, TransportVector, TransportVector> op(*transportMatrix_);
+        Dune::SeqILU<TransportMatrix, TransportVector, TransportVector> preconditioner(*transportMatrix_, 1.0);
+        Dune::BiCGSTABSolver<TransportVector> linearSolver(op, preconditioner,
+                                                           linearReduction,
+                                                           maxLinearIterations,
+                                                           /*verbose=*/0);
+        Dune::InverseOperatorResult result;
+        transportUpdate_ = 0.0;
+        linearSolver.apply(transportUpdate_, transportResidual_, result);
+
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            EqVector update;
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                update[eqIdx] = transportUpdate_[rowIdx][eqIdx];
+            update[pressureVarIdx_] = 0.0;
+            applyUpdate_(static_cast<unsigned>(rowIdx), update, residual[rowIdx],
+                         updatePrimaryVariables);
+        }
+
+        simulator_.model().invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0,
+                                                                  simulator_.gridView());
+    }
+
+    // solve the transport system by local Newton iterations for the strongly connected
+    // components of the upwind graph in upwind order
+    template <class UpdateFn>
+    void orderedTransportStep_(Scalar tolerance, UpdateFn& updatePrimaryVariables)
+    {
+        auto& model = simulator_.model();
+        auto& linearizer = model.linearizer();
+
+        computeUpwindOrder_();
+
+        const std::size_t numComponents = componentOffsets_.size() - 1;
+        for (std::size_t compIdx = 0; compIdx < numComponents; ++compIdx) {
+            domain_.cells.assign(componentCells_.begin() + componentOffsets_[compIdx],
+                                 componentCells_.begin() + componentOffsets_[compIdx + 1]);
+            domain_.interior.assign(domain_.cells.size(), true);
+
+            for (int iterIdx = 0; iterIdx < maxComponentIterations; ++iterIdx) {
+                linearizer.linearizeDomain(domain_);
+                if (domainError_(domain_) <= tolerance)
+                    break;
+
+                if (domain_.cells.size() == 1)
+                    solveCell_(domain_.cells[0], updatePrimaryVariables);
+                else
+                    solveComponent_(domain_, updatePrimaryVariables);
+
+                model.updateIntensiveQuantitiesOfDofs(domain_.cells, /*timeIdx=*/0);
+            }
+        }
+    }
+
+    // find the strongly connected components of the upwind graph of the current
+    // linearization using an iterative variant of Tarjan's algorithm. the graph points
+    // from each cell to its upstream neighbors, so a component is completed only after
+    // all components upstream of it, i.e., the components are found in upwind order.
+    void computeUpwindOrder_()
+    {
+        const auto& jacobian = simulator_.model().linearizer().jacobian().istlMatrix();
+        const unsigned numCells = weights_.size();
+
+        upstreamOffsets_.assign(1, 0);
+        upstream_.clear();
+        for (unsigned cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            const auto& row = jacobian[cellIdx];
+            const unsigned constraintEqIdx = constraintEqIdx_[cellIdx];
+            const Scalar diagCoupling = transportCoupling_(row[cellIdx], constraintEqIdx);
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                if (colIt.index() == cellIdx || colIt.index() >= numCells)
+                    continue;
+                if (transportCoupling_(*colIt, constraintEqIdx) > upwindThreshold*diagCoupling)
+                    upstream_.push_back(static_cast<unsigned>(colIt.index()));
+            }
+            upstreamOffsets_.push_back(upstream_.size());
+        }
+
+        std::vector<int> index(numCells, -1);
+        std::vector<int> lowLink(numCells);
+        std::vector<unsigned char> onStack(numCells, 0);
+        std::vector<unsigned> stack;
+        // the cells whose upstream neighbors are being visited and the position of the
+        // next neighbor to visit
+        std::vector<std::pair<unsigned, std::size_t>> visiting;
+        int nextIndex = 0;
+
+        componentCells_.clear();
+        componentOffsets_.assign(1, 0);
+        const auto discover = [&](unsigned cellIdx) {
+            index[cellIdx] = lowLink[cellIdx] = nextIndex++;
+            stack.push_back(cellIdx);
+            onStack[cellIdx] = 1;
+            visiting.emplace_back(cellIdx, upstreamOffsets_[cellIdx]);
+        };
+
+        for (unsigned rootIdx = 0; rootIdx < numCells; ++rootIdx) {
+            if (index[rootIdx] >= 0)
+                continue;
+
+            discover(rootIdx);
+            while (!visiting.empty()) {
+                const unsigned cellIdx = visiting.back().first;
+                const std::size_t pos = visiting.back().second;
+                if (pos < upstreamOffsets_[cellIdx + 1]) {
+                    ++visiting.back().second;
+                    const unsigned nbIdx = upstream_[pos];
+                    if (index[nbIdx] < 0)
+                        discover(nbIdx);
+                    else if (onStack[nbIdx])
+                        lowLink[cellIdx] = std::min(lowLink[cellIdx], index[nbIdx]);
+                    continue;
+                }
+
+                // all upstream neighbors have been visited
+                visiting.pop_back();
+                if (!visiting.empty()) {
+                    const unsigned parentIdx = visiting.back().first;
+                    lowLink[parentIdx] = std::min(lowLink[parentIdx], lowLink[cellIdx]);
+                }
+
+                if (lowLink[cellIdx] == index[cellIdx]) {
+                    unsigned memberIdx;
+                    do {
+                        memberIdx = stack.back();
+                        stack.pop_back();
+                        onStack[memberIdx] = 0;
+                        componentCells_.push_back(static_cast<int>(memberIdx));
+                    } while (memberIdx != cellIdx);
+                    componentOffsets_.push_back(componentCells_.size());
+                }
+            }
+        }
+    }
+
+    // the largest derivative of the transport equations of a block with regard to the
+    // transport variables
+    Scalar transportCoupling_(const Block& block, unsigned constraintEqIdx) const
+    {
+        Scalar result = 0.0;
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            if (eqIdx == constraintEqIdx)
+                continue;
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                if (pvIdx != pressureVarIdx_)
+                    result = std::max<Scalar>(result, std::abs(block[eqIdx][pvIdx]));
+        }
+        return result;
+    }
+
+    // do a Newton update of the transport variables of a single cell
+    template <class UpdateFn>
+    void solveCell_(int cellIdx, UpdateFn& updatePrimaryVariables)
+    {
+        const auto& linearizer = simulator_.model().linearizer();
+        const auto& residual = linearizer.residual()[cellIdx];
+        const unsigned constraintEqIdx = constraintEqIdx_[cellIdx];
+
+        Block block = linearizer.jacobian().istlMatrix()[cellIdx][cellIdx];
+        constrainBlock_(block, constraintEqIdx, /*isDiagonal=*/true);
+        VectorBlock rhs = residual;
+        rhs[constraintEqIdx] = 0.0;
+
+        VectorBlock localUpdate;
+        block.solve(localUpdate, rhs);
+
+        EqVector update;
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            update[eqIdx] = localUpdate[eqIdx];
+        update[pressureVarIdx_] = 0.0;
+        applyUpdate_(static_cast<unsigned>(cellIdx), update, residual, updatePrimaryVariables);
+    }
+
+    // do a Newton update of the transport variables of the cells of a strongly
+    // connected component
+    template <class UpdateFn>
+    void solveComponent_(const Domain& domain, UpdateFn& updatePrimaryVariables)
+    {
+        const auto& linearizer = simulator_.model().linearizer();
+        const auto& jacobian = linearizer.jacobian().istlMatrix();
+        const auto& residual = linearizer.residual();
+        const std::size_t numCells = domain.cells.size();
+
+        for (std::size_t localI = 0; localI < numCells; ++localI)
+            localIndex_[domain.cells[localI]] = static_cast<int>(localI);
+
+        TransportMatrix localMatrix(numCells, numCells, TransportMatrix::row_wise);
+        for (auto rowIt = localMatrix.createbegin(); rowIt != localMatrix.createend(); ++rowIt) {
+            const auto& row = jacobian[domain.cells[rowIt.index()]];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                if (colIt.index() < localIndex_.size() && localIndex_[colIt.index()] >= 0)
+                    rowIt.insert(localIndex_[colIt.index()]);
+        }
+
+        TransportVector localResidual(numCells);
+        TransportVector localUpdate(numCells);
+        for (std::size_t localI = 0; localI < numCells; ++localI) {
+            const int globI = domain.cells[localI];
+            const unsigned constraintEqIdx = constraintEqIdx_[globI];
+            const auto& globalRow = jacobian[globI];
+            auto& localRow = localMatrix[localI];
+            for (auto colIt = localRow.begin(); colIt != localRow.end(); ++colIt) {
+                *colIt = globalRow[domain.cells[colIt.index()]];
+                constrainBlock_(*colIt, constraintEqIdx, colIt.index() == localI);
+            }
+
+            localResidual[localI] = residual[globI];
+            localResidual[localI][constraintEqIdx] = 0.0;
+        }
+
+        for (int globI : domain.cells)
+            localIndex_[globI] = -1;
+
+        Dune::MatrixAdapter<TransportMatrix, TransportVector, TransportVector> op(localMatrix);
+        Dune::SeqILU<TransportMatrix, TransportVector, TransportVector> preconditioner(localMatrix, 1.0);
+        Dune::BiCGSTABSolver<TransportVector> linearSolver(op, preconditioner,
+                                                           linearReduction,
+                                                           maxLinearIterations,
+                                                           /*verbose=*/0);
+        Dune::InverseOperatorResult result;
+        localUpdate = 0.0;
+        linearSolver.apply(localUpdate, localResidual, result);
+
+        for (std::size_t localI = 0; localI < numCells; ++localI) {
+            const int globI = domain.cells[localI];
+            EqVector update;
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                update[eqIdx] = localUpdate[localI][eqIdx];
+            update[pressureVarIdx_] = 0.0;
+            applyUpdate_(static_cast<unsigned>(globI), update, residual[globI],
+                         updatePrimaryVariables);
+        }
+    }
+
+    // drop the pressure column of a block of the Jacobian and replace the constraint
+    // equation of its row by the condition that the pressure does not change
+    void constrainBlock_(Block& block, unsigned constraintEqIdx, bool isDiagonal) const
+    {
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            block[eqIdx][pressureVarIdx_] = 0.0;
+        block[constraintEqIdx] = 0.0;
+        if (isDiagonal)
+            block[constraintEqIdx][pressureVarIdx_] = 1.0;
+    }
+
+    template <class ResidualBlock, class UpdateFn>
+    void applyUpdate_(unsigned dofIdx,
+                      const EqVector& update,
+                      const ResidualBlock& residual,
+                      UpdateFn& updatePrimaryVariables)
+    {
+        auto& solution = simulator_.model().solution(/*timeIdx=*/0);
+        EqVector dofResidual;
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            dofResidual[eqIdx] = residual[eqIdx];
+
+        const PrimaryVariables currentValue = solution[dofIdx];
+        updatePrimaryVariables(dofIdx, solution[dofIdx], currentValue, update, dofResidual);
+    }
+
+    // the weighted maximum norm of the residual like the one used by the Newton method.
+    // if 'transportOnly' is true, the equations which are replaced by the constraint
+    // of the transport system are not considered.
+    Scalar error_(bool transportOnly) const
+    {
+        Scalar result = 0.0;
+        for (unsigned globI = 0; globI < simulator_.model().numGridDof(); ++globI)
+            result = std::max(result, cellError_(globI, transportOnly));
+        return simulator_.gridView().comm().max(result);
+    }
+
+    // the error of the transport equations of the cells of a component
+    Scalar domainError_(const Domain& domain) const
+    {
+        Scalar result = 0.0;
+        for (int globI : domain.cells)
+            result = std::max(result, cellError_(static_cast<unsigned>(globI), /*transportOnly=*/true));
+        return result;
+    }
+
+    Scalar cellError_(unsigned globI, bool transportOnly) const
+    {
+        const auto& model = simulator_.model();
+        if (model.dofTotalVolume(globI) <= 0.0)
+            return 0.0;
+
+        const auto& r = model.linearizer().residual()[globI];
+        Scalar result = 0.0;
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            if (transportOnly && eqIdx == constraintEqIdx_[globI])
+                continue;
+            result = std::max<Scalar>(std::abs(r[eqIdx]*model.eqWeight(globI, eqIdx)), result);
+        }
+        return result;
+    }
+
+    Simulator& simulator_;
+
+    int maxIterations_;
+    int transportIterations_;
+    Scalar tolerance_;
+    unsigned pressureVarIdx_;
+    int numOuterIterations_ = 0;
+
+    std::vector<VectorBlock> weights_;
+    std::vector<unsigned> constraintEqIdx_;
+
+    std::unique_ptr<PressureMatrix> pressureMatrix_;
+    PressureVector pressureResidual_;
+    PressureVector pressureUpdate_;
+
+    std::unique_ptr<TransportMatrix> transportMatrix_;
+    TransportVector transportResidual_;
+    TransportVector transportUpdate_;
+
+    // the ordered transport solver: the upstream neighbors of each cell, the cells of
+    // the strongly connected components in upwind order, the component which is
+    // currently solved and the index of its cells within the component, -1 for all
+    // other cells
+    bool orderedTransport_ = false;
+    std::vector<std::size_t> upstreamOffsets_;
+    std::vector<unsigned> upstream_;
+    std::vector<int> componentCells_;
+    std::vector<std::size_t> componentOffsets_;
+    Domain domain_;
+    std::vector<int> localIndex_;
+};
+
+} // namespace Opm
+
+#endif
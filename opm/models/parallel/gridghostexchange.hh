@@ -0,0 +1,404 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::GridGhostExchange
+ */
+#ifndef EWOMS_GRID_GHOST_EXCHANGE_HH
+#define EWOMS_GRID_GHOST_EXCHANGE_HH
+
+#include "mpibuffer.hh"
+
+#include <dune/grid/common/datahandleif.hh>
+#include <dune/grid/common/gridenums.hh>
+#include <dune/common/version.hh>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Exchanges the values attached to the DOFs on the process boundaries using
+ *        precomputed index lists and contiguous message buffers.
+ *
+ * The data handles of gridcommhandles.hh are called by the grid for every entity on
+ * the process boundary, which is quite slow for large values like primary variables.
+ * This class instead determines the indices to be sent to and received from each
+ * peer process once, using two passes of grid communication. Afterwards, each
+ * exchange packs the values into one buffer per peer, sends them using persistent
+ * non-blocking requests and unpacks the received values in bulk.
+ *
+ * The result of an exchange is the same as the one of the corresponding data handle
+ * when it is communicated over the same interface using forward communication. The
+ * index lists stay valid until the grid is changed. An exchange can be split into
+ * beginExchange() and finishExchange() to overlap the communication with computations
+ * which do not depend on the received values.
+ */
+template <class GridView, class EntityMapper, int commCodim>
+class GridGhostExchange
+{
+    struct IndexPair_
+    {
+        unsigned sourceIdx; // index of the DOF on the sending process
+        unsigned targetIdx; // index of the DOF on the receiving process
+
+        bool operator<(const IndexPair_& other) const
+        {
+            return sourceIdx < other.sourceIdx
+                || (sourceIdx == other.sourceIdx && targetIdx < other.targetIdx);
+        }
+    };
+
+    using PairLists_ = std::map<unsigned, std::vector<IndexPair_>>;
+
+    // collects the pairs of DOF indices which are connected by a grid interface. For
+    // the forward direction, the local process is the receiver, else it is the sender.
+    class SetupHandle_
+        : public Dune::CommDataHandleIF<SetupHandle_, unsigned>
+    {
+    public:
+        SetupHandle_(unsigned rank,
+                     const EntityMapper& mapper,
+                     PairLists_& pairLists,
+                     bool localIsTarget)
+            : rank_(rank)
+            , mapper_(mapper)
+            , pairLists_(pairLists)
+            , localIsTarget_(localIsTarget)
+        {}
+
+        bool contains(int, int codim) const
+        { return codim == commCodim; }
+
+#if DUNE_VERSION_LT(DUNE_GRID, 2, 8)
+        bool fixedsize(int, int) const
+#else
+        bool fixedSize(int, int) const
+#endif
+        { return true; }
+
+        template <class EntityType>
+        size_t size(const EntityType&) const
+        { return 2; }
+
+        template <class MessageBufferImp, class EntityType>
+        void gather(MessageBufferImp& buff, const EntityType& e) const
+        {
+            buff.write(rank_);
+            buff.write(static_cast<unsigned>(mapper_.index(e)));
+        }
+
+        template <class MessageBufferImp, class EntityType>
+        void scatter(MessageBufferImp& buff, const EntityType& e, size_t)
+        {
+            unsigned peerRank;
+            unsigned peerIdx;
+            buff.read(peerRank);
+            buff.read(peerIdx);
+
+            unsigned localIdx = static_cast<unsigned>(mapper_.index(e));
+            if (localIsTarget_)
+                pairLists_[peerRank].push_back(IndexPair_{peerIdx, localIdx});
+            else
+                pairLists_[peerRank].push_back(IndexPair_{localIdx, peerIdx});
+        }
+
+    private:
+        unsigned rank_;
+        const EntityMapper& mapper_;
+        PairLists_& pairLists_;
+        bool localIsTarget_;
+    };
+
+    using Buffer_ = MpiBuffer<unsigned char>;
+
+    struct Peer_
+    {
+        unsigned rank;
+        std::vector<unsigned> sendIndices;
+        std::vector<unsigned> recvIndices;
+        std::unique_ptr<Buffer_> sendBuffer;
+        std::unique_ptr<Buffer_> recvBuffer;
+    };
+
+public:
+    /*!
+     * \brief Functor which overwrites the local values by the received ones.
+     */
+    struct Assign
+    {
+        template <class T>
+        void operator()(T& dest, const T& src) const
+        { dest = src; }
+    };
+
+    /*!
+     * \brief Functor which adds the received values to the local ones.
+     */
+    struct Sum
+    {
+        template <class T>
+        void operator()(T& dest, const T& src) const
+        { dest += src; }
+    };
+
+    /*!
+     * \brief Functor which takes the maximum of the local and the received values.
+     */
+    struct Max
+    {
+        template <class T>
+        void operator()(T& dest, const T& src) const
+        { dest = std::max(dest, src); }
+    };
+
+    /*!
+     * \brief Functor which takes the minimum of the local and the received values.
+     */
+    struct Min
+    {
+        template <class T>
+        void operator()(T& dest, const T& src) const
+        { dest = std::min(dest, src); }
+    };
+
+    GridGhostExchange(const GridView& gridView,
+                      const EntityMapper& mapper,
+                      Dune::InterfaceType iftype = Dune::InteriorBorder_All_Interface)
+    {
+        const unsigned rank = static_cast<unsigned>(gridView.comm().rank());
+
+        // the forward communication tells each process from where it receives the
+        // values of its DOFs. The backward one uses the same pairs of entities and
+        // thus tells each process where it needs to send its values to.
+        PairLists_ recvPairs;
+        SetupHandle_ recvHandle(rank, mapper, recvPairs, /*localIsTarget=*/true);
+        gridView.communicate(recvHandle, iftype, Dune::ForwardCommunication);
+
+        PairLists_ sendPairs;
+        SetupHandle_ sendHandle(rank, mapper, sendPairs, /*localIsTarget=*/false);
+        gridView.communicate(sendHandle, iftype, Dune::BackwardCommunication);
+
+        // both sides order the pairs of a peer the same way, so the values can be
+        // sent without any indices
+        auto getPeer = [this](unsigned peerRank) -> Peer_& {
+            auto it = std::find_if(peers_.begin(), peers_.end(),
+                                   [peerRank](const Peer_& p) { return p.rank == peerRank; });
+            if (it != peers_.end())
+                return *it;
+
+            peers_.emplace_back();
+            peers_.back().rank = peerRank;
+            return peers_.back();
+        };
+
+        for (auto& [peerRank, pairs] : sendPairs) {
+            std::sort(pairs.begin(), pairs.end());
+            auto& peer = getPeer(peerRank);
+            peer.sendIndices.reserve(pairs.size());
+            for (const auto& pair : pairs)
+                peer.sendIndices.push_back(pair.sourceIdx);
+        }
+
+        for (auto& [peerRank, pairs] : recvPairs) {
+            std::sort(pairs.begin(), pairs.end());
+            auto& peer = getPeer(peerRank);
+            peer.recvIndices.reserve(pairs.size());
+            for (const auto& pair : pairs)
+                peer.recvIndices.push_back(pair.targetIdx);
+        }
+    }
+
+    /*!
+     * \brief Returns the number of processes with which values are exchanged.
+     */
+    size_t numPeers() const
+    { return peers_.size(); }
+
+    /*!
+     * \brief Set the values of the receiving DOFs to the ones of their senders.
+     */
+    template <class Container>
+    void ghostSync(Container& container)
+    { exchange(container, Assign{}); }
+
+    /*!
+     * \brief Start setting the values of the receiving DOFs to the ones of their
+     *        senders.
+     *
+     * The values are only written by finishGhostSync().
+     */
+    template <class Container>
+    void beginGhostSync(const Container& container)
+    { beginExchange(container); }
+
+    /*!
+     * \brief Complete an exchange which was started by beginGhostSync().
+     */
+    template <class Container>
+    void finishGhostSync(Container& container)
+    { finishExchange(container, Assign{}); }
+
+    /*!
+     * \brief Exchange the values of a container and combine them with the local ones.
+     *
+     * Like the message buffers of the grid, the values are transferred bytewise, so
+     * they must not refer to any memory outside of their objects. Each call must be
+     * matched by a call on all peer processes.
+     */
+    template <class Container, class CombineOp>
+    void exchange(Container& container, CombineOp combine)
+    {
+        beginExchange(container);
+        finishExchange(container, combine);
+    }
+
+    /*!
+     * \brief Send the values of a container to the peer processes without waiting for
+     *        the values which are received.
+     *
+     * The values of the sending DOFs are copied to the message buffers, so they may be
+     * modified afterwards. The values of the receiving DOFs must not be accessed before
+     * the exchange is completed by finishExchange(). Only a single exchange may be in
+     * flight at any time.
+     */
+    template <class Container>
+    void beginExchange(const Container& container)
+    {
+        using FieldType = std::decay_t<decltype(container[0])>;
+        constexpr size_t valueSize = sizeof(FieldType);
+
+        assert(!exchangePending_);
+        exchangePending_ = true;
+
+        if (valueSize != valueSize_)
+            setupBuffers_(valueSize);
+
+        for (auto& peer : peers_)
+            if (!peer.recvIndices.empty())
+                peer.recvBuffer->start();
+
+        for (auto& peer : peers_) {
+            if (peer.sendIndices.empty())
+                continue;
+
+            unsigned char* buf = &(*peer.sendBuffer)[0];
+            const auto& indices = peer.sendIndices;
+            const int n = static_cast<int>(indices.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (int i = 0; i < n; ++i)
+                std::memcpy(static_cast<void*>(buf + i*valueSize),
+                            static_cast<const void*>(&container[indices[i]]),
+                            valueSize);
+
+            peer.sendBuffer->start();
+        }
+    }
+
+    /*!
+     * \brief Wait for the values of an exchange started by beginExchange() and
+     *        combine them with the local ones.
+     */
+    template <class Container, class CombineOp>
+    void finishExchange(Container& container, CombineOp combine)
+    {
+        using FieldType = std::decay_t<decltype(container[0])>;
+        constexpr size_t valueSize = sizeof(FieldType);
+
+        assert(exchangePending_);
+        assert(valueSize == valueSize_);
+
+        std::vector<Buffer_*> pending;
+        for (auto& peer : peers_)
+            if (!peer.recvIndices.empty())
+                pending.push_back(peer.recvBuffer.get());
+        Buffer_::waitAll(pending.begin(), pending.end());
+
+        // the values of different peers are combined in a fixed order because a DOF
+        // may receive values from several processes
+        for (auto& peer : peers_) {
+            if (peer.recvIndices.empty())
+                continue;
+
+            const unsigned char* buf = &(*peer.recvBuffer)[0];
+            const auto& indices = peer.recvIndices;
+            const int n = static_cast<int>(indices.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (int i = 0; i < n; ++i) {
+                FieldType tmp;
+                std::memcpy(static_cast<void*>(&tmp), buf + i*valueSize, valueSize);
+                combine(container[indices[i]], tmp);
+            }
+        }
+
+        pending.clear();
+        for (auto& peer : peers_)
+            if (!peer.sendIndices.empty())
+                pending.push_back(peer.sendBuffer.get());
+        Buffer_::waitAll(pending.begin(), pending.end());
+
+        exchangePending_ = false;
+    }
+
+    /*!
+     * \brief Returns whether an exchange was started but not yet completed.
+     */
+    bool exchangePending() const
+    { return exchangePending_; }
+
+private:
+    void setupBuffers_(size_t valueSize)
+    {
+        valueSize_ = valueSize;
+        for (auto& peer : peers_) {
+            if (!peer.sendIndices.empty()) {
+                peer.sendBuffer = std::make_unique<Buffer_>(peer.sendIndices.size()*valueSize);
+                peer.sendBuffer->initPersistentSend(peer.rank);
+            }
+            if (!peer.recvIndices.empty()) {
+                peer.recvBuffer = std::make_unique<Buffer_>(peer.recvIndices.size()*valueSize);
+                peer.recvBuffer->initPersistentReceive(peer.rank);
+            }
+        }
+    }
+
+    std::vector<Peer_> peers_;
+    size_t valueSize_ = 0;
+    bool exchangePending_ = false;
+};
+
+} // namespace Opm
+
+#endif
@@ -33,8 +33,10 @@
 
 #include <stddef.h>
 
-#include <type_traits>
 #include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
 
 namespace Opm {
 
@@ -66,37 +68,67 @@ public:
     MpiBuffer(const MpiBuffer&) = default;
 
     ~MpiBuffer()
-    { delete[] data_; }
+    {
+        freePersistentRequest();
+        delete[] data_;
+    }
 
     /*!
      * \brief Set the size of the buffer
+     *
+     * This releases the persistent request of the buffer if there is one.
      */
     void resize(size_t newSize)
     {
+        freePersistentRequest();
         delete[] data_;
         data_ = new DataType[newSize];
         dataSize_ = newSize;
         updateMpiDataSize_();
     }
 
+#if HAVE_MPI
+    /*!
+     * \brief Set the MPI communicator which is used for all subsequent operations.
+     *
+     * By default, MPI_COMM_WORLD is used. This releases the persistent request of the
+     * buffer if there is one.
+     */
+    void setCommunicator(MPI_Comm comm)
+    {
+        freePersistentRequest();
+        mpiComm_ = comm;
+    }
+
+    /*!
+     * \brief Returns the MPI communicator used by the buffer.
+     */
+    MPI_Comm communicator() const
+    { return mpiComm_; }
+#endif // HAVE_MPI
+
     /*!
      * \brief Send the buffer asyncronously to a peer process.
      */
     void send([[maybe_unused]] unsigned peerRank)
     {
 #if HAVE_MPI
+        assert(!hasPersistentRequest_);
         MPI_Isend(data_,
                   static_cast<int>(mpiDataSize_),
                   mpiDataType_,
                   static_cast<int>(peerRank),
                   0, // tag
-                  MPI_COMM_WORLD,
+                  mpiComm_,
                   &mpiRequest_);
 #endif
     }
 
     /*!
-     * \brief Wait until the buffer was send to the peer completely.
+     * \brief Wait until the pending operation of the buffer has completed.
+     *
+     * The pending operation is an asyncronous send, a non-blocking receive or an
+     * operation started using a persistent request.
      */
     void wait()
     {
@@ -111,16 +143,148 @@ public:
     void receive([[maybe_unused]] unsigned peerRank)
     {
 #if HAVE_MPI
+        assert(!hasPersistentRequest_);
         MPI_Recv(data_,
                  static_cast<int>(mpiDataSize_),
                  mpiDataType_,
                  static_cast<int>(peerRank),
                  0, // tag
-                 MPI_COMM_WORLD,
+                 mpiComm_,
                  MPI_STATUS_IGNORE);
 #endif // HAVE_MPI
     }
 
+    /*!
+     * \brief Start to receive the buffer from a peer rank without blocking.
+     *
+     * The buffer must not be accessed until wait() or waitAll() was called.
+     */
+    void receiveBegin([[maybe_unused]] unsigned peerRank)
+    {
+#if HAVE_MPI
+        assert(!hasPersistentRequest_);
+        MPI_Irecv(data_,
+                  static_cast<int>(mpiDataSize_),
+                  mpiDataType_,
+                  static_cast<int>(peerRank),
+                  0, // tag
+                  mpiComm_,
+                  &mpiRequest_);
+#endif // HAVE_MPI
+    }
+
+    /*!
+     * \brief Set up a persistent request to send the buffer to a peer rank.
+     *
+     * The buffer is then sent each time start() is called. This avoids setting up
+     * the MPI request for buffers which are exchanged many times with the same peer.
+     */
+    void initPersistentSend([[maybe_unused]] unsigned peerRank)
+    {
+#if HAVE_MPI
+        freePersistentRequest();
+        MPI_Send_init(data_,
+                      static_cast<int>(mpiDataSize_),
+                      mpiDataType_,
+                      static_cast<int>(peerRank),
+                      0, // tag
+                      mpiComm_,
+                      &mpiRequest_);
+        hasPersistentRequest_ = true;
+#endif // HAVE_MPI
+    }
+
+    /*!
+     * \brief Set up a persistent request to receive the buffer from a peer rank.
+     *
+     * The buffer is then received each time start() is called.
+     */
+    void initPersistentReceive([[maybe_unused]] unsigned peerRank)
+    {
+#if HAVE_MPI
+        freePersistentRequest();
+        MPI_Recv_init(data_,
+                      static_cast<int>(mpiDataSize_),
+                      mpiDataType_,
+                      static_cast<int>(peerRank),
+                      0, // tag
+                      mpiComm_,
+                      &mpiRequest_);
+        hasPersistentRequest_ = true;
+#endif // HAVE_MPI
+    }
+
+    /*!
+     * \brief Start the operation of the persistent request of the buffer.
+     *
+     * It must be completed using wait() or waitAll() before it can be started again.
+     */
+    void start()
+    {
+#if HAVE_MPI
+        assert(hasPersistentRequest_);
+        MPI_Start(&mpiRequest_);
+#endif // HAVE_MPI
+    }
+
+    /*!
+     * \brief Returns true if a persistent request has been set up for the buffer.
+     */
+    bool hasPersistentRequest() const
+    {
+#if HAVE_MPI
+        return hasPersistentRequest_;
+#else
+        return false;
+#endif // HAVE_MPI
+    }
+
+    /*!
+     * \brief Release the persistent request of the buffer.
+     *
+     * The operation of the request must not be pending anymore.
+     */
+    void freePersistentRequest()
+    {
+#if HAVE_MPI
+        if (hasPersistentRequest_) {
+            // the buffer may outlive MPI, in which case the request is gone anyway
+            int finalized;
+            MPI_Finalized(&finalized);
+            if (!finalized)
+                MPI_Request_free(&mpiRequest_);
+            hasPersistentRequest_ = false;
+        }
+#endif // HAVE_MPI
+    }
+
+    /*!
+     * \brief Wait until the pending operations of a range of buffers have completed.
+     *
+     * The iterators must refer to pointers (raw or smart ones) to buffers. Compared to
+     * calling wait() on each buffer, this completes the operations in whatever order
+     * they finish.
+     */
+    template <class BufferPtrIterator>
+    static void waitAll([[maybe_unused]] BufferPtrIterator begin,
+                        [[maybe_unused]] BufferPtrIterator end)
+    {
+#if HAVE_MPI
+        std::vector<MPI_Request> requests;
+        for (auto it = begin; it != end; ++it)
+            requests.push_back((*it)->mpiRequest_);
+
+        std::vector<MPI_Status> statuses(requests.size());
+        MPI_Waitall(static_cast<int>(requests.size()), requests.data(), statuses.data());
+
+        std::size_t i = 0;
+        for (auto it = begin; it != end; ++it, ++i) {
+            (*it)->mpiRequest_ = requests[i];
+            (*it)->mpiStatus_ = statuses[i];
+        }
+#endif // HAVE_MPI
+    }
+
 #if HAVE_MPI
     /*!
      * \brief Returns the current MPI_Request object.
@@ -228,8 +392,10 @@ private:
 #if HAVE_MPI
     size_t mpiDataSize_;
     MPI_Datatype mpiDataType_;
+    MPI_Comm mpiComm_ = MPI_COMM_WORLD;
     MPI_Request mpiRequest_;
     MPI_Status mpiStatus_;
+    bool hasPersistentRequest_ = false;
 #endif // HAVE_MPI
 };
 
@@ -27,27 +27,40 @@
 #ifndef EWOMS_TASKLETS_HH
 #define EWOMS_TASKLETS_HH
 
+#include <atomic>
 #include <stdexcept>
 #include <cassert>
 #include <thread>
-#include <queue>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <iostream>
 #include <condition_variable>
+#include <vector>
 
 namespace Opm {
 
+class TaskletRunner;
+
 /*!
  * \brief The base class for tasklets.
  *
  * Tasklets are a generic mechanism for potentially running work in a separate thread.
+ * Once a tasklet has been dispatched, TaskletRunner::wait() can be used to wait until
+ * all of its invocations have been completed, and tasklets which depend on it can be
+ * dispatched using TaskletRunner::then().
  */
 class TaskletInterface
 {
+    friend class TaskletRunner;
+
 public:
     TaskletInterface(int refCount = 1)
         : referenceCount_(refCount)
     {}
+    TaskletInterface(const TaskletInterface& other)
+        : referenceCount_(other.referenceCount())
+    {}
     virtual ~TaskletInterface() {}
     virtual void run() = 0;
     virtual bool isEndMarker () const { return false; }
@@ -58,8 +71,27 @@ public:
     int referenceCount() const
     { return referenceCount_; }
 
+    /*!
+     * \brief Returns true if all invocations of the tasklet have been completed.
+     */
+    bool isFinished() const
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        return finished_;
+    }
+
 private:
-    int referenceCount_;
+    // the invocations of a tasklet may be run concurrently by different worker threads
+    std::atomic<int> referenceCount_;
+
+    // the state used by the tasklet runner to keep track of the completion of the
+    // tasklet and of the tasklets which depend on it
+    mutable std::mutex stateMutex_;
+    mutable std::condition_variable finishedCondition_;
+    int numUnfinishedInvocations_ = 0;
+    int numUnfinishedDependencies_ = 0;
+    bool finished_ = false;
+    std::vector<std::shared_ptr<TaskletInterface> > successors_;
 };
 
 /*!
@@ -82,8 +114,6 @@ private:
     const Fn& fn_;
 };
 
-class TaskletRunner;
-
 // this class stores the thread local static attributes for the TaskletRunner class. we
 // cannot put them directly into TaskletRunner because defining static members for
 // non-template classes in headers leads the linker to choke in case multiple compile
@@ -106,59 +136,20 @@ thread_local int TaskletRunnerHelper_<Dummy>::workerThreadIndex_ = -1;
  *
  * Depending on the number of worker threads, a tasklet can either be run in a separate
  * worker thread or by the main thread.
+ *
+ * Each worker thread has its own queue of tasklets. Tasklets dispatched by the main
+ * thread are distributed round-robin over these queues, tasklets dispatched by a
+ * worker are put into the worker's own queue. A worker runs the tasklets of its own
+ * queue in the order in which they were dispatched and steals tasklets from the back
+ * of the other queues if its own queue is empty.
  */
 class TaskletRunner
 {
-    /// \brief Implements a barrier. This class can only be used in the asynchronous case.
-    class BarrierTasklet : public TaskletInterface
+    // the queue of a worker thread
+    struct WorkerQueue_
     {
-    public:
-        BarrierTasklet(unsigned numWorkers)
-            : TaskletInterface(/*refCount=*/numWorkers)
-        {
-            numWorkers_ = numWorkers;
-            numWaiting_ = 0;
-        }
-
-        void run()
-        { wait(); }
-
-        void wait()
-        {
-            std::unique_lock<std::mutex> lock(barrierMutex_);
-
-            numWaiting_ += 1;
-            if (numWaiting_ >= numWorkers_ + 1) {
-                lock.unlock();
-                barrierCondition_.notify_all();
-            }
-            else {
-                const auto& areAllWaiting =
-                    [this]() -> bool
-                    { return this->numWaiting_ >= this->numWorkers_ + 1; };
-
-                barrierCondition_.wait(lock, /*predicate=*/areAllWaiting);
-            }
-        }
-
-    private:
-        unsigned numWorkers_;
-        unsigned numWaiting_;
-
-        std::condition_variable barrierCondition_;
-        std::mutex barrierMutex_;
-    };
-
-    /// \brief TerminateThreadTasklet class
-    /// Empty tasklet marking thread termination.
-    class TerminateThreadTasklet : public TaskletInterface
-    {
-    public:
-        void run()
-        { }
-
-        bool isEndMarker() const
-        { return true; }
+        std::mutex mutex;
+        std::deque<std::shared_ptr<TaskletInterface> > tasklets;
     };
 
 public:
@@ -173,6 +164,10 @@ public:
      */
     TaskletRunner(unsigned numWorkers)
     {
+        queues_.resize(numWorkers);
+        for (auto& queue : queues_)
+            queue.reset(new WorkerQueue_);
+
         threads_.resize(numWorkers);
         for (unsigned i = 0; i < numWorkers; ++i)
             // create a worker thread
@@ -189,8 +184,12 @@ public:
     ~TaskletRunner()
     {
         if (threads_.size() > 0) {
-            // dispatch a tasklet which will terminate the worker thread
-            dispatch(std::make_shared<TerminateThreadTasklet>());
+            // tell the worker threads to terminate as soon as all queues are empty
+            {
+                std::lock_guard<std::mutex> lock(idleMutex_);
+                terminate_ = true;
+            }
+            workAvailableCondition_.notify_all();
 
             // wait until all worker threads have terminated
             for (auto& thread : threads_)
@@ -223,6 +222,17 @@ public:
      */
     void dispatch(std::shared_ptr<TaskletInterface> tasklet)
     {
+        const int numInvocations = tasklet->referenceCount();
+        {
+            std::lock_guard<std::mutex> lock(tasklet->stateMutex_);
+            tasklet->finished_ = false;
+            tasklet->numUnfinishedInvocations_ += numInvocations;
+        }
+        if (numInvocations <= 0) {
+            finishInvocation_(*tasklet, /*numInvocations=*/0);
+            return;
+        }
+
         if (threads_.empty()) {
             // run the tasklet immediately in synchronous mode.
             while (tasklet->referenceCount() > 0) {
@@ -236,20 +246,87 @@ public:
                 catch (...) {
                     std::cerr << "ERROR: Uncaught exception (general type) when running tasklet. Trying to continue.\n";
                 }
+                finishInvocation_(*tasklet);
             }
         }
         else {
-            // lock mutex for the tasklet queue to make sure that nobody messes with the
-            // task queue
-            taskletQueueMutex_.lock();
+            // each invocation of the tasklet is queued separately, so that several
+            // workers may run them concurrently
+            numPending_ += numInvocations;
+
+            const int selfIdx = workerThreadIndex();
+            for (int i = 0; i < numInvocations; ++i) {
+                const unsigned queueIdx =
+                    selfIdx >= 0
+                    ? static_cast<unsigned>(selfIdx)
+                    : nextQueueIdx_++ % static_cast<unsigned>(queues_.size());
+                WorkerQueue_& queue = *queues_[queueIdx];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasklets.push_back(tasklet);
+            }
 
-            // add the tasklet to the queue
-            taskletQueue_.push(tasklet);
+            // the number of queued tasklets is modified while holding the idle mutex, so
+            // that no worker can miss the notification
+            {
+                std::lock_guard<std::mutex> lock(idleMutex_);
+                numQueued_ += numInvocations;
+            }
+            workAvailableCondition_.notify_all();
+        }
+    }
 
-            taskletQueueMutex_.unlock();
+    /*!
+     * \brief Dispatch a tasklet as soon as all tasklets it depends on have been
+     *        completed.
+     *
+     * The dependencies must have been or must eventually be dispatched themselves.
+     */
+    void dispatch(std::shared_ptr<TaskletInterface> tasklet,
+                  const std::vector<std::shared_ptr<TaskletInterface> >& dependencies)
+    {
+        // the additional dependency is held while the dependencies are registered, so
+        // that the tasklet cannot be dispatched prematurely
+        {
+            std::lock_guard<std::mutex> lock(tasklet->stateMutex_);
+            tasklet->numUnfinishedDependencies_ = dependencies.size() + 1;
+        }
 
-            workAvailableCondition_.notify_all();
+        for (const auto& dependency : dependencies) {
+            std::unique_lock<std::mutex> lock(dependency->stateMutex_);
+            if (!dependency->finished_) {
+                dependency->successors_.push_back(tasklet);
+                continue;
+            }
+            lock.unlock();
+            releaseDependency_(tasklet);
         }
+
+        releaseDependency_(tasklet);
+    }
+
+    /*!
+     * \brief Dispatch a tasklet after another one has been completed.
+     *
+     * This allows to build pipelines of tasklets without waiting for all queued work
+     * using barrier(). The successor is returned, so calls can be chained.
+     */
+    template <class Tasklet>
+    std::shared_ptr<Tasklet> then(std::shared_ptr<TaskletInterface> predecessor,
+                                  std::shared_ptr<Tasklet> successor)
+    {
+        dispatch(successor, {predecessor});
+        return successor;
+    }
+
+    /*!
+     * \brief Wait until all invocations of a dispatched tasklet have been completed.
+     *
+     * In contrast to barrier(), this does not wait for any other tasklets.
+     */
+    void wait(const TaskletInterface& tasklet) const
+    {
+        std::unique_lock<std::mutex> lock(tasklet.stateMutex_);
+        tasklet.finishedCondition_.wait(lock, [&tasklet]() { return tasklet.finished_; });
     }
 
     /*!
@@ -269,61 +346,101 @@ public:
      */
     void barrier()
     {
-        unsigned numWorkers = threads_.size();
-        if (numWorkers == 0)
+        if (threads_.empty())
             // nothing needs to be done to implement a barrier in synchronous mode
             return;
 
-        // dispatch a barrier tasklet and wait until it has been run by the worker thread
-        auto barrierTasklet = std::make_shared<BarrierTasklet>(numWorkers);
-        dispatch(barrierTasklet);
-
-        barrierTasklet->wait();
+        std::unique_lock<std::mutex> lock(idleMutex_);
+        allDoneCondition_.wait(lock, [this]() { return numPending_ == 0; });
     }
 
 protected:
+    // record that some invocations of a tasklet have been completed. if this was the
+    // last one, the tasklet is marked as finished and its successors are released.
+    void finishInvocation_(TaskletInterface& tasklet, int numInvocations = 1)
+    {
+        std::vector<std::shared_ptr<TaskletInterface> > successors;
+        {
+            std::lock_guard<std::mutex> lock(tasklet.stateMutex_);
+            tasklet.numUnfinishedInvocations_ -= numInvocations;
+            if (tasklet.numUnfinishedInvocations_ > 0)
+                return;
+
+            tasklet.finished_ = true;
+            successors.swap(tasklet.successors_);
+        }
+        tasklet.finishedCondition_.notify_all();
+
+        for (auto& successor : successors)
+            releaseDependency_(successor);
+    }
+
+    // record that one of the dependencies of a tasklet has been completed and
+    // dispatch the tasklet if none are left
+    void releaseDependency_(const std::shared_ptr<TaskletInterface>& tasklet)
+    {
+        bool ready = false;
+        {
+            std::lock_guard<std::mutex> lock(tasklet->stateMutex_);
+            ready = (--tasklet->numUnfinishedDependencies_ == 0);
+        }
+        if (ready)
+            dispatch(tasklet);
+    }
+
     // main function of the worker thread
     static void startWorkerThread_(TaskletRunner* taskletRunner, int workerThreadIndex)
     {
         TaskletRunnerHelper_<void>::taskletRunner_ = taskletRunner;
         TaskletRunnerHelper_<void>::workerThreadIndex_ = workerThreadIndex;
 
-        taskletRunner->run_();
+        taskletRunner->run_(workerThreadIndex);
     }
 
-    //! do the work until the queue received an end tasklet
-    void run_()
+    // take the next tasklet from the worker's own queue or steal one from another
+    // worker. returns a null pointer if all queues are empty.
+    std::shared_ptr<TaskletInterface> popTasklet_(unsigned workerIdx)
+    {
+        const unsigned numQueues = queues_.size();
+        for (unsigned i = 0; i < numQueues; ++i) {
+            const unsigned queueIdx = (workerIdx + i) % numQueues;
+            WorkerQueue_& queue = *queues_[queueIdx];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasklets.empty())
+                continue;
+
+            std::shared_ptr<TaskletInterface> tasklet;
+            if (i == 0) {
+                tasklet = queue.tasklets.front();
+                queue.tasklets.pop_front();
+            }
+            else {
+                tasklet = queue.tasklets.back();
+                queue.tasklets.pop_back();
+            }
+            --numQueued_;
+            return tasklet;
+        }
+
+        return nullptr;
+    }
+
+    //! do the work until the runner is terminated and all queues are empty
+    void run_(unsigned workerIdx)
     {
         while (true) {
-            // wait until tasklets have been pushed to the queue. first we need to lock
-            // mutex for access to taskletQueue_
-            std::unique_lock<std::mutex> lock(taskletQueueMutex_);
-
-            const auto& workIsAvailable =
-                [this]() -> bool
-                { return !taskletQueue_.empty(); };
-
-            if (!workIsAvailable())
-                workAvailableCondition_.wait(lock, /*predicate=*/workIsAvailable);
-
-            // remove tasklet from queue
-            std::shared_ptr<TaskletInterface> tasklet = taskletQueue_.front();
-
-            // if tasklet is an end marker, terminate the thread and DO NOT remove the
-            // tasklet.
-            if (tasklet->isEndMarker()) {
-                if(taskletQueue_.size() > 1)
-                    throw std::logic_error("TaskletRunner: Not all queued tasklets were executed");
-                taskletQueueMutex_.unlock();
-                return;
+            std::shared_ptr<TaskletInterface> tasklet = popTasklet_(workerIdx);
+            if (!tasklet) {
+                // wait until tasklets have been dispatched
+                std::unique_lock<std::mutex> lock(idleMutex_);
+                workAvailableCondition_.wait(lock,
+                                             [this]() { return numQueued_ > 0 || terminate_; });
+                if (numQueued_ == 0 && terminate_)
+                    return;
+                continue;
             }
 
             tasklet->dereference();
-            if (tasklet->referenceCount() == 0)
-                // remove tasklets from the queue as soon as their reference count
-                // reaches zero, i.e. the tasklet has been run often enough.
-                taskletQueue_.pop();
-            lock.unlock();
 
             // execute tasklet
             try {
@@ -335,13 +452,31 @@ protected:
             catch (...) {
                 std::cerr << "ERROR: Uncaught exception when running tasklet. Trying to continue.\n";
             }
+
+            // the successors of the tasklet are dispatched before the invocation stops
+            // being pending, so barrier() also waits for them
+            finishInvocation_(*tasklet);
+
+            if (--numPending_ == 0) {
+                std::lock_guard<std::mutex> lock(idleMutex_);
+                allDoneCondition_.notify_all();
+            }
         }
     }
 
     std::vector<std::unique_ptr<std::thread> > threads_;
-    std::queue<std::shared_ptr<TaskletInterface> > taskletQueue_;
-    std::mutex taskletQueueMutex_;
+    std::vector<std::unique_ptr<WorkerQueue_> > queues_;
+    std::atomic<unsigned> nextQueueIdx_{0};
+
+    // number of tasklet invocations in the queues and number of invocations which
+    // have not been completed yet
+    std::atomic<long> numQueued_{0};
+    std::atomic<long> numPending_{0};
+    bool terminate_ = false;
+
+    std::mutex idleMutex_;
     std::condition_variable workAvailableCondition_;
+    std::condition_variable allDoneCondition_;
 };
 
 } // end namespace Opm
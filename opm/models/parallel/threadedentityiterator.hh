@@ -27,8 +27,14 @@
 #ifndef EWOMS_THREADED_ENTITY_ITERATOR_HH
 #define EWOMS_THREADED_ENTITY_ITERATOR_HH
 
-#include <thread>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <atomic>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 namespace Opm {
 
@@ -36,6 +42,10 @@ namespace Opm {
  * \brief Provides an STL-iterator like interface to iterate over the enties of a
  *        GridView in OpenMP threaded applications
  *
+ * The entities are handed out to the threads in chunks of consecutive entities, so
+ * that the threads only need to synchronize once per chunk instead of once per
+ * entity.
+ *
  * ATTENTION: This class must be instantiated in a sequential context!
  */
 template <class GridView, int codim>
@@ -44,23 +54,24 @@ class ThreadedEntityIterator
     using Entity = typename GridView::template Codim<codim>::Entity;
     using EntityIterator = typename GridView::template Codim<codim>::Iterator;
 public:
-    ThreadedEntityIterator(const GridView& gridView)
+    ThreadedEntityIterator(const GridView& gridView, unsigned chunkSize = 64)
         : sequentialIt_(gridView.template begin<codim>())
         , sequentialEnd_(gridView.template end<codim>())
+        , chunkSize_(chunkSize > 0 ? chunkSize : 1)
+        , finished_(false)
+#ifdef _OPENMP
+        , threadState_(static_cast<unsigned>(omp_get_max_threads()), ThreadState{sequentialEnd_, 0})
+#else
+        , threadState_(1, ThreadState{sequentialEnd_, 0})
+#endif
     { }
 
-    ThreadedEntityIterator(const ThreadedEntityIterator& other) = default;
-
     // begin iterating over the grid in parallel
     EntityIterator beginParallel()
     {
-        mutex_.lock();
-        auto tmp = sequentialIt_;
-        if (sequentialIt_ != sequentialEnd_)
-            ++sequentialIt_; // make the next thread look at the next element
-        mutex_.unlock();
-
-        return tmp;
+        ThreadState& state = threadState_[threadId_()];
+        state.remaining = 0;
+        return nextChunk_(state);
     }
 
     // returns true if the last element was reached
@@ -70,6 +81,7 @@ public:
     // make sure that the loop over the grid is finished
     void setFinished()
     {
+        finished_ = true;
         mutex_.lock();
         sequentialIt_ = sequentialEnd_;
         mutex_.unlock();
@@ -78,19 +90,55 @@ public:
     // prefix increment: goes to the next element which is not yet worked on by any
     // thread
     EntityIterator increment()
+    {
+        ThreadState& state = threadState_[threadId_()];
+        if (state.remaining == 0 || finished_)
+            return nextChunk_(state);
+
+        ++state.it;
+        --state.remaining;
+        return state.it;
+    }
+
+private:
+    // the current position of a thread and the number of entities left in its chunk
+    // after the current one. aligned to avoid false sharing between the threads.
+    struct alignas(64) ThreadState
+    {
+        EntityIterator it;
+        unsigned remaining;
+    };
+
+    static unsigned threadId_()
+    {
+#ifdef _OPENMP
+        return static_cast<unsigned>(omp_get_thread_num());
+#else
+        return 0;
+#endif
+    }
+
+    // assign the next chunk of entities to a thread and return its first entity
+    EntityIterator nextChunk_(ThreadState& state)
     {
         mutex_.lock();
-        auto tmp = sequentialIt_;
-        if (sequentialIt_ != sequentialEnd_)
+        state.it = sequentialIt_;
+        state.remaining = 0;
+        if (sequentialIt_ != sequentialEnd_) {
             ++sequentialIt_;
+            for (; state.remaining + 1 < chunkSize_ && sequentialIt_ != sequentialEnd_; ++state.remaining)
+                ++sequentialIt_;
+        }
         mutex_.unlock();
 
-        return tmp;
+        return state.it;
     }
 
-private:
     EntityIterator sequentialIt_;
     EntityIterator sequentialEnd_;
+    unsigned chunkSize_;
+    std::atomic<bool> finished_;
+    std::vector<ThreadState> threadState_;
 
     std::mutex mutex_;
 };
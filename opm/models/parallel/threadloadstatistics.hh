@@ -0,0 +1,298 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::ThreadLoadStatistics
+ */
+#ifndef EWOMS_THREAD_LOAD_STATISTICS_HH
+#define EWOMS_THREAD_LOAD_STATISTICS_HH
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Measures the load balance of the threads for the executions of a parallel
+ *        loop.
+ *
+ * Each thread measures the time it is busy with its share of the loop and counts the
+ * work items it processes. After each execution of the loop, the idle time of the
+ * threads at the barrier at the end of the loop, i.e., the difference between the
+ * busy time of the slowest thread and the one of each thread, is accumulated. The
+ * imbalance ratio is the ratio of the accumulated busy times of the slowest thread and
+ * of an average thread; a value of 1 means perfect balance.
+ *
+ * A loop is instrumented like this:
+ *
+ * \code
+ * auto& loadStats = ThreadLoadStatistics::get("my loop");
+ * loadStats.beginLoop();
+ * #pragma omp parallel
+ * {
+ *     auto threadScope = loadStats.threadScope();
+ *     #pragma omp for nowait
+ *     for (...) {
+ *         ...
+ *         threadScope.addWorkItem();
+ *     }
+ * }
+ * loadStats.endLoop();
+ * \endcode
+ *
+ * Unless the statistics are enabled via setEnabled(), all of these calls only check a
+ * flag.
+ */
+class ThreadLoadStatistics
+{
+    using Clock = std::chrono::steady_clock;
+
+public:
+    /*!
+     * \brief Measures the busy time and the work items of a thread during one
+     *        execution of the loop.
+     */
+    class ThreadScope
+    {
+    public:
+        explicit ThreadScope(ThreadLoadStatistics* stats)
+            : stats_(stats)
+            , numItems_(0)
+        {
+            if (stats_)
+                startTime_ = Clock::now();
+        }
+
+        ThreadScope(const ThreadScope&) = delete;
+        ThreadScope& operator=(const ThreadScope&) = delete;
+
+        ~ThreadScope()
+        {
+            if (!stats_)
+                return;
+
+            const std::chrono::duration<double> dt = Clock::now() - startTime_;
+            stats_->addSample_(threadId_(), dt.count(), numItems_);
+        }
+
+        /*!
+         * \brief Count a work item which is processed by the current thread.
+         */
+        void addWorkItem()
+        { ++numItems_; }
+
+    private:
+        ThreadLoadStatistics* stats_;
+        Clock::time_point startTime_;
+        std::size_t numItems_;
+    };
+
+    /*!
+     * \brief Returns the statistics of the loop with a given name.
+     *
+     * The object is created when it is requested the first time. References to it
+     * remain valid for the lifetime of the process.
+     */
+    static ThreadLoadStatistics& get(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex_());
+        return registry_()[name];
+    }
+
+    /*!
+     * \brief Enable or disable the collection of the statistics for all loops.
+     */
+    static void setEnabled(bool yesno)
+    { enabled_() = yesno; }
+
+    /*!
+     * \brief Returns true if the statistics of the loops are collected.
+     */
+    static bool enabled()
+    { return enabled_(); }
+
+    /*!
+     * \brief Print the statistics of all loops which have been executed at least once.
+     */
+    static void printAll(std::ostream& os)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex_());
+
+        os << std::left << std::setw(36) << "parallel loop"
+           << std::right << std::setw(10) << "calls"
+           << std::setw(9) << "threads"
+           << std::setw(14) << "wall [s]"
+           << std::setw(14) << "idle [s]"
+           << std::setw(11) << "imbalance"
+           << std::setw(12) << "max items"
+           << std::setw(12) << "min items" << "\n";
+        for (const auto& entry : registry_()) {
+            const auto& stats = entry.second;
+            if (stats.numLoops_ == 0)
+                continue;
+
+            const auto items = std::minmax_element(stats.totalItems_.begin(), stats.totalItems_.end());
+            os << std::left << std::setw(36) << entry.first
+               << std::right << std::setw(10) << stats.numLoops_
+               << std::setw(9) << stats.totalBusy_.size()
+               << std::setw(14) << stats.wallTime_
+               << std::setw(14) << stats.idleTime()
+               << std::setw(11) << stats.imbalanceRatio()
+               << std::setw(12) << *items.second
+               << std::setw(12) << *items.first << "\n";
+        }
+        os << std::flush;
+    }
+
+    /*!
+     * \brief Must be called by the master thread before the loop is executed.
+     */
+    void beginLoop()
+    {
+        if (!enabled())
+            return;
+
+        std::size_t numThreads = 1;
+#ifdef _OPENMP
+        numThreads = static_cast<std::size_t>(omp_get_max_threads());
+#endif
+        if (loopBusy_.size() < numThreads) {
+            loopBusy_.resize(numThreads, 0.0);
+            totalBusy_.resize(numThreads, 0.0);
+            totalItems_.resize(numThreads, 0);
+        }
+        std::fill(loopBusy_.begin(), loopBusy_.end(), 0.0);
+        loopStartTime_ = Clock::now();
+    }
+
+    /*!
+     * \brief Returns the object which measures the work of the calling thread.
+     *
+     * This must be called inside of the parallel region by each thread.
+     */
+    ThreadScope threadScope()
+    { return ThreadScope(enabled() && !loopBusy_.empty() ? this : nullptr); }
+
+    /*!
+     * \brief Must be called by the master thread after the loop was executed.
+     */
+    void endLoop()
+    {
+        if (!enabled() || loopBusy_.empty())
+            return;
+
+        const std::chrono::duration<double> dt = Clock::now() - loopStartTime_;
+        wallTime_ += dt.count();
+        ++numLoops_;
+
+        double maxBusy = 0.0;
+        double sumBusy = 0.0;
+        for (double busy : loopBusy_) {
+            maxBusy = std::max(maxBusy, busy);
+            sumBusy += busy;
+        }
+
+        for (std::size_t threadIdx = 0; threadIdx < loopBusy_.size(); ++threadIdx) {
+            totalBusy_[threadIdx] += loopBusy_[threadIdx];
+            idleTime_ += maxBusy - loopBusy_[threadIdx];
+        }
+        maxBusyTime_ += maxBusy;
+        avgBusyTime_ += sumBusy/loopBusy_.size();
+    }
+
+    /*!
+     * \brief The accumulated time which the threads spent waiting for the slowest
+     *        thread, summed over all threads.
+     */
+    double idleTime() const
+    { return idleTime_; }
+
+    /*!
+     * \brief The ratio of the accumulated busy times of the slowest and of an average
+     *        thread.
+     */
+    double imbalanceRatio() const
+    { return avgBusyTime_ > 0.0 ? maxBusyTime_/avgBusyTime_ : 1.0; }
+
+private:
+    static unsigned threadId_()
+    {
+#ifdef _OPENMP
+        return static_cast<unsigned>(omp_get_thread_num());
+#else
+        return 0;
+#endif
+    }
+
+    void addSample_(unsigned threadIdx, double busyTime, std::size_t numItems)
+    {
+        // each thread only writes its own entries
+        loopBusy_[threadIdx] += busyTime;
+        totalItems_[threadIdx] += numItems;
+    }
+
+    static std::map<std::string, ThreadLoadStatistics>& registry_()
+    {
+        static std::map<std::string, ThreadLoadStatistics> registry;
+        return registry;
+    }
+
+    static std::mutex& registryMutex_()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static bool& enabled_()
+    {
+        static bool enabled = false;
+        return enabled;
+    }
+
+    std::vector<double> loopBusy_;
+    std::vector<double> totalBusy_;
+    std::vector<std::size_t> totalItems_;
+    Clock::time_point loopStartTime_;
+
+    std::size_t numLoops_ = 0;
+    double wallTime_ = 0.0;
+    double idleTime_ = 0.0;
+    double maxBusyTime_ = 0.0;
+    double avgBusyTime_ = 0.0;
+};
+
+} // namespace Opm
+
+#endif
@@ -31,12 +31,23 @@
 #include <omp.h>
 #endif
 
+#ifdef __linux__
+#include <sched.h>
+#endif
+
 #include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/parallel/threadloadstatistics.hh>
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/models/utils/propertysystem.hh>
 
 #include <dune/common/version.hh>
 
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 namespace Opm {
 
 /*!
@@ -63,6 +74,13 @@ public:
         Parameters::registerParam<TypeTag, Properties::ThreadsPerProcess>
             ("The maximum number of threads to be instantiated per process "
              "('-1' means 'automatic')");
+        Parameters::registerParam<TypeTag, Properties::ThreadAffinity>
+            ("How to pin the threads of a process to CPU cores: 'none', 'compact' "
+             "(consecutive cores), 'scatter' (round-robin over the NUMA domains) or "
+             "a comma separated list of core indices");
+        Parameters::registerParam<TypeTag, Properties::EnableThreadLoadStatistics>
+            ("Measure the load balance of the threads in the main parallel loops "
+             "and print it at the end of the simulation");
     }
 
     /*!
@@ -110,6 +128,13 @@ public:
         // get the number of threads which are used in the end.
         numThreads_ = omp_get_max_threads();
 #endif
+
+        if (queryCommandLineParameter) {
+            pinThreads_(Parameters::get<TypeTag, Properties::ThreadAffinity>());
+            ThreadLoadStatistics::setEnabled(Parameters::get<TypeTag, Properties::EnableThreadLoadStatistics>());
+        }
+        else
+            pinThreads_("none");
     }
 
     /*!
@@ -130,12 +155,169 @@ public:
 #endif
     }
 
+    /*!
+     * \brief Return the number of NUMA domains of the machine.
+     *
+     * If the topology cannot be determined, the machine is considered to consist of a
+     * single NUMA domain.
+     */
+    static unsigned numNumaDomains()
+    { return numaDomainCpus_().size(); }
+
+    /*!
+     * \brief Return the NUMA domain of a CPU core or -1 if it is unknown.
+     */
+    static int numaDomainOfCpu(int cpuIdx)
+    {
+        const auto& domainCpus = numaDomainCpus_();
+        if (domainCpus.size() == 1 && domainCpus[0].empty())
+            // unknown topology: there is only a single domain
+            return cpuIdx >= 0 ? 0 : -1;
+
+        for (unsigned domainIdx = 0; domainIdx < domainCpus.size(); ++domainIdx) {
+            for (int cpu : domainCpus[domainIdx])
+                if (cpu == cpuIdx)
+                    return static_cast<int>(domainIdx);
+        }
+        return -1;
+    }
+
+    /*!
+     * \brief Return the "home" NUMA domain of a thread.
+     *
+     * This is the domain of the core the thread was pinned to or, if the threads are
+     * not pinned, of the core it was running on when the thread manager was
+     * initialized. Data which is mainly accessed by a given thread should be
+     * allocated and first touched by it to be placed in this domain.
+     */
+    static int homeNumaDomain(unsigned threadId)
+    {
+        if (threadId >= homeNumaDomain_.size())
+            return -1;
+        return homeNumaDomain_[threadId];
+    }
+
 private:
+    // pin each thread to a core according to the specified affinity policy and record
+    // the NUMA domains of the threads
+    static void pinThreads_(const std::string& policy)
+    {
+        homeNumaDomain_.assign(numThreads_, -1);
+
+#ifdef __linux__
+        cpu_set_t processCpuSet;
+        CPU_ZERO(&processCpuSet);
+        std::vector<int> availableCpus;
+        if (sched_getaffinity(0, sizeof(processCpuSet), &processCpuSet) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                if (CPU_ISSET(cpu, &processCpuSet))
+                    availableCpus.push_back(cpu);
+        }
+
+        std::vector<int> threadCpu(numThreads_, -1);
+        if (policy == "compact") {
+            for (int threadIdx = 0; threadIdx < numThreads_ && !availableCpus.empty(); ++threadIdx)
+                threadCpu[threadIdx] = availableCpus[threadIdx % availableCpus.size()];
+        }
+        else if (policy == "scatter") {
+            // the available cores of each NUMA domain
+            std::vector<std::vector<int> > domainCpus;
+            for (const auto& cpus : numaDomainCpus_()) {
+                domainCpus.emplace_back();
+                for (int cpu : cpus)
+                    if (CPU_ISSET(cpu, &processCpuSet))
+                        domainCpus.back().push_back(cpu);
+                if (domainCpus.back().empty())
+                    domainCpus.pop_back();
+            }
+            if (domainCpus.empty())
+                domainCpus.push_back(availableCpus);
+
+            for (int threadIdx = 0; threadIdx < numThreads_; ++threadIdx) {
+                const auto& cpus = domainCpus[threadIdx % domainCpus.size()];
+                if (!cpus.empty())
+                    threadCpu[threadIdx] = cpus[(threadIdx / domainCpus.size()) % cpus.size()];
+            }
+        }
+        else if (policy != "none") {
+            // explicit list of cores
+            std::istringstream iss(policy);
+            std::string token;
+            std::vector<int> cpus;
+            while (std::getline(iss, token, ','))
+                cpus.push_back(std::stoi(token));
+            if (cpus.empty())
+                throw std::invalid_argument("Invalid thread affinity '"+policy+"'. Valid values are "
+                                            "'none', 'compact', 'scatter' or a list of cores");
+            for (int threadIdx = 0; threadIdx < numThreads_; ++threadIdx)
+                threadCpu[threadIdx] = cpus[threadIdx % cpus.size()];
+        }
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads_)
+#endif
+        {
+            const unsigned threadIdx = threadId();
+            if (threadIdx < threadCpu.size()) {
+                if (threadCpu[threadIdx] >= 0) {
+                    cpu_set_t cpuSet;
+                    CPU_ZERO(&cpuSet);
+                    CPU_SET(threadCpu[threadIdx], &cpuSet);
+                    sched_setaffinity(0, sizeof(cpuSet), &cpuSet);
+                }
+                homeNumaDomain_[threadIdx] = numaDomainOfCpu(sched_getcpu());
+            }
+        }
+#else
+        if (policy != "none")
+            throw std::invalid_argument("Pinning threads to cores is only supported on Linux");
+#endif
+    }
+
+    // the cores of each NUMA domain of the machine
+    static const std::vector<std::vector<int> >& numaDomainCpus_()
+    {
+        static const std::vector<std::vector<int> > domainCpus = readNumaDomainCpus_();
+        return domainCpus;
+    }
+
+    static std::vector<std::vector<int> > readNumaDomainCpus_()
+    {
+        std::vector<std::vector<int> > domainCpus;
+#ifdef __linux__
+        for (unsigned domainIdx = 0; ; ++domainIdx) {
+            std::ifstream cpuList("/sys/devices/system/node/node"+std::to_string(domainIdx)+"/cpulist");
+            if (!cpuList)
+                break;
+
+            // the list is given as a comma separated sequence of ranges, e.g. '0-3,8-11'
+            domainCpus.emplace_back();
+            std::string range;
+            while (std::getline(cpuList, range, ',')) {
+                if (range.empty() || range[0] == '\n')
+                    continue;
+                const auto dashPos = range.find('-');
+                const int first = std::stoi(range.substr(0, dashPos));
+                const int last = dashPos == std::string::npos ? first : std::stoi(range.substr(dashPos + 1));
+                for (int cpu = first; cpu <= last; ++cpu)
+                    domainCpus.back().push_back(cpu);
+            }
+        }
+#endif
+        if (domainCpus.empty())
+            domainCpus.emplace_back();
+        return domainCpus;
+    }
+
     static int numThreads_;
+    static std::vector<int> homeNumaDomain_;
 };
 
 template <class TypeTag>
 int ThreadManager<TypeTag>::numThreads_ = 1;
+
+template <class TypeTag>
+std::vector<int> ThreadManager<TypeTag>::homeNumaDomain_;
 } // namespace Opm
 
 #endif
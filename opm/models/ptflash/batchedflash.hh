@@ -0,0 +1,316 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::BatchedFlash
+ */
+#ifndef OPM_PTFLASH_BATCHED_FLASH_HH
+#define OPM_PTFLASH_BATCHED_FLASH_HH
+
+#include <opm/material/fluidstates/CompositionalFluidState.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Opm {
+
+/*!
+ * \ingroup FlashModel
+ *
+ * \brief Conducts the successive substitution iterations of a two-phase PT flash
+ *        for a batch of cells at once.
+ *
+ * The state of the cells is stored as a structure of arrays, i.e., the cells of the
+ * batch are the innermost dimension. This allows the compiler to vectorize the
+ * Rachford-Rice solves and the updates of the K-values over the cells. Cells which
+ * have converged are masked out of the subsequent iterations.
+ *
+ * The batched solver only considers values, it neither conducts a stability test
+ * nor does it compute derivatives. Its results are thus meant to be the initial
+ * guess of the complete flash of the individual cells, which then converges within
+ * very few iterations.
+ */
+template <class Scalar, class FluidSystem>
+class BatchedFlash
+{
+    enum { numComponents = FluidSystem::numComponents };
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+
+    using FluidState = CompositionalFluidState<Scalar, FluidSystem, /*energy=*/false>;
+    using ParameterCache = typename FluidSystem::template ParameterCache<Scalar>;
+
+    static constexpr unsigned maxRachfordRiceIterations = 50;
+
+public:
+    //! The maximum number of cells which are flashed at once
+    static constexpr unsigned batchSize = 8;
+
+    /*!
+     * \brief Specify the state of a cell of the batch.
+     *
+     * The K-values are the initial guess of the iterations. Only the first \c
+     * numCells() cells of the batch are considered by solve().
+     */
+    template <class ComponentVector>
+    void setCell(unsigned lane,
+                 const ComponentVector& z,
+                 const ComponentVector& K,
+                 Scalar pressure,
+                 Scalar temperature)
+    {
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+            z_[compIdx][lane] = z[compIdx];
+            K_[compIdx][lane] = K[compIdx];
+        }
+        pressure_[lane] = pressure;
+        temperature_[lane] = temperature;
+        numCells_ = std::max(numCells_, lane + 1);
+    }
+
+    /*!
+     * \brief Remove all cells from the batch.
+     */
+    void clear()
+    { numCells_ = 0; }
+
+    /*!
+     * \brief Returns the number of cells of the batch.
+     */
+    unsigned numCells() const
+    { return numCells_; }
+
+    /*!
+     * \brief Run the successive substitution iterations for all cells of the batch.
+     *
+     * \param tolerance The maximum relative change of the K-values for which a cell is
+     *                  considered to be converged.
+     * \param maxIterations The maximum number of successive substitution iterations.
+     */
+    void solve(Scalar tolerance, unsigned maxIterations)
+    {
+        if (numCells_ == 0)
+            return;
+
+        // the unused lanes repeat the first cell, so that the vectorized loops do not
+        // operate on undefined values
+        for (unsigned lane = numCells_; lane < batchSize; ++lane) {
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+                z_[compIdx][lane] = z_[compIdx][0];
+                K_[compIdx][lane] = K_[compIdx][0];
+                phiL_[compIdx][lane] = 1.0;
+                phiV_[compIdx][lane] = 1.0;
+            }
+            pressure_[lane] = pressure_[0];
+            temperature_[lane] = temperature_[0];
+        }
+
+        for (unsigned lane = 0; lane < batchSize; ++lane) {
+            active_[lane] = lane < numCells_ ? 1.0 : 0.0;
+            converged_[lane] = false;
+            vaporFraction_[lane] = 0.5;
+        }
+
+        for (unsigned iterIdx = 0; iterIdx < maxIterations; ++iterIdx) {
+            solveRachfordRice_();
+            updateCompositions_();
+            updateKValues_();
+
+            bool anyActive = false;
+            for (unsigned lane = 0; lane < numCells_; ++lane) {
+                if (active_[lane] == 0.0)
+                    continue;
+
+                if (maxChange_[lane] < tolerance) {
+                    converged_[lane] = true;
+                    active_[lane] = 0.0;
+                }
+                else
+                    anyActive = true;
+            }
+
+            if (!anyActive)
+                break;
+        }
+
+        // the vapor fractions of the converged cells correspond to the final K-values
+        for (unsigned lane = 0; lane < batchSize; ++lane)
+            active_[lane] = lane < numCells_ ? 1.0 : 0.0;
+        solveRachfordRice_();
+    }
+
+    /*!
+     * \brief Returns true if the iterations for a cell of the batch have converged.
+     */
+    bool converged(unsigned lane) const
+    { return converged_[lane]; }
+
+    /*!
+     * \brief Returns the K-value of a component for a cell of the batch.
+     */
+    Scalar K(unsigned lane, unsigned compIdx) const
+    { return K_[compIdx][lane]; }
+
+    /*!
+     * \brief Returns the liquid mole fraction of a cell of the batch.
+     */
+    Scalar L(unsigned lane) const
+    { return 1.0 - vaporFraction_[lane]; }
+
+private:
+    // solve the Rachford-Rice equation for the vapor fraction of all active cells
+    // using safeguarded Newton iterations. If the equation has no root within [0, 1],
+    // the vapor fraction is clamped to the respective bound.
+    void solveRachfordRice_()
+    {
+        Scalar lower[batchSize];
+        Scalar upper[batchSize];
+        Scalar rrActive[batchSize];
+        for (unsigned lane = 0; lane < batchSize; ++lane) {
+            lower[lane] = 0.0;
+            upper[lane] = 1.0;
+            rrActive[lane] = active_[lane];
+        }
+
+        for (unsigned iterIdx = 0; iterIdx < maxRachfordRiceIterations; ++iterIdx) {
+            Scalar g[batchSize];
+            Scalar dg[batchSize];
+            for (unsigned lane = 0; lane < batchSize; ++lane) {
+                g[lane] = 0.0;
+                dg[lane] = 0.0;
+            }
+
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+                for (unsigned lane = 0; lane < batchSize; ++lane) {
+                    const Scalar Km1 = K_[compIdx][lane] - 1.0;
+                    const Scalar denom = 1.0 + vaporFraction_[lane]*Km1;
+                    const Scalar term = z_[compIdx][lane]*Km1/denom;
+                    g[lane] += term;
+                    dg[lane] -= term*Km1/denom;
+                }
+            }
+
+            bool anyActive = false;
+            for (unsigned lane = 0; lane < batchSize; ++lane) {
+                // g is monotonically decreasing in the vapor fraction
+                const Scalar V = vaporFraction_[lane];
+                const bool positive = g[lane] > 0.0;
+                lower[lane] = positive ? V : lower[lane];
+                upper[lane] = positive ? upper[lane] : V;
+
+                Scalar newV = V - g[lane]/dg[lane];
+                // fall back to bisection if the Newton update leaves the bracket
+                if (!(newV > lower[lane] && newV < upper[lane]))
+                    newV = 0.5*(lower[lane] + upper[lane]);
+
+                const bool done = std::abs(newV - V) < 1e-12 || upper[lane] - lower[lane] < 1e-12;
+                vaporFraction_[lane] = rrActive[lane]*newV + (1.0 - rrActive[lane])*V;
+                rrActive[lane] = done ? 0.0 : rrActive[lane];
+                anyActive = anyActive || rrActive[lane] != 0.0;
+            }
+
+            if (!anyActive)
+                break;
+        }
+    }
+
+    // compute the phase compositions of all active cells from the vapor fraction
+    void updateCompositions_()
+    {
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+            for (unsigned lane = 0; lane < batchSize; ++lane) {
+                const Scalar x = z_[compIdx][lane]/(1.0 + vaporFraction_[lane]*(K_[compIdx][lane] - 1.0));
+                x_[compIdx][lane] = x;
+                y_[compIdx][lane] = K_[compIdx][lane]*x;
+            }
+        }
+    }
+
+    // replace the K-values of the active cells by the ratio of the fugacity
+    // coefficients of the phases. the equation of state is evaluated cell by cell.
+    void updateKValues_()
+    {
+        FluidState fluidState;
+        ParameterCache paramCache;
+        for (unsigned lane = 0; lane < numCells_; ++lane) {
+            maxChange_[lane] = 0.0;
+            if (active_[lane] == 0.0)
+                continue;
+
+            fluidState.setTemperature(temperature_[lane]);
+            for (unsigned phaseIdx = 0; phaseIdx < FluidSystem::numPhases; ++phaseIdx)
+                fluidState.setPressure(phaseIdx, pressure_[lane]);
+
+            Scalar sumX = 0.0;
+            Scalar sumY = 0.0;
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+                sumX += x_[compIdx][lane];
+                sumY += y_[compIdx][lane];
+            }
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+                fluidState.setMoleFraction(oilPhaseIdx, compIdx, x_[compIdx][lane]/sumX);
+                fluidState.setMoleFraction(gasPhaseIdx, compIdx, y_[compIdx][lane]/sumY);
+            }
+
+            paramCache.updatePhase(fluidState, oilPhaseIdx);
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                phiL_[compIdx][lane] =
+                    FluidSystem::fugacityCoefficient(fluidState, paramCache, oilPhaseIdx, compIdx);
+
+            paramCache.updatePhase(fluidState, gasPhaseIdx);
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                phiV_[compIdx][lane] =
+                    FluidSystem::fugacityCoefficient(fluidState, paramCache, gasPhaseIdx, compIdx);
+        }
+
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+            for (unsigned lane = 0; lane < batchSize; ++lane) {
+                const Scalar oldK = K_[compIdx][lane];
+                const Scalar newK = phiL_[compIdx][lane]/phiV_[compIdx][lane];
+                const Scalar change = std::abs(newK/oldK - 1.0);
+                const bool isActive = active_[lane] != 0.0;
+                K_[compIdx][lane] = isActive ? newK : oldK;
+                maxChange_[lane] = isActive ? std::max(maxChange_[lane], change) : maxChange_[lane];
+            }
+        }
+    }
+
+    Scalar z_[numComponents][batchSize];
+    Scalar K_[numComponents][batchSize];
+    Scalar x_[numComponents][batchSize];
+    Scalar y_[numComponents][batchSize];
+    Scalar phiL_[numComponents][batchSize];
+    Scalar phiV_[numComponents][batchSize];
+    Scalar pressure_[batchSize];
+    Scalar temperature_[batchSize];
+    Scalar vaporFraction_[batchSize];
+    Scalar maxChange_[batchSize] = {};
+    Scalar active_[batchSize];
+    bool converged_[batchSize];
+    unsigned numCells_ = 0;
+};
+
+} // namespace Opm
+
+#endif
@@ -30,6 +30,8 @@
 
 #include "flashproperties.hh"
 #include "flashindices.hh"
+#include "flashstatecache.hh"
+#include "flashtabulation.hh"
 
 #include <opm/models/common/energymodule.hh>
 #include <opm/models/common/diffusionmodule.hh>
@@ -40,6 +42,8 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <array>
+
 namespace Opm {
 
 /*!
@@ -73,6 +77,7 @@ class FlashIntensiveQuantities
     enum { enableEnergy = getPropValue<TypeTag, Properties::EnableEnergy>() };
     enum { dimWorld = GridView::dimensionworld };
     enum { pressure0Idx = Indices::pressure0Idx };
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
 
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
@@ -80,6 +85,8 @@ class FlashIntensiveQuantities
     using FlashSolver = GetPropType<TypeTag, Properties::FlashSolver>;
 
     using ComponentVector = Dune::FieldVector<Evaluation, numComponents>;
+    using FlashStateCache = Opm::FlashStateCache<Scalar, numComponents>;
+    using FlashTabulation = Opm::FlashTabulation<Scalar, Evaluation, numComponents, numEq>;
     using DimMatrix = Dune::FieldMatrix<Scalar, dimWorld, dimWorld>;
 
     using FluxIntensiveQuantities = typename FluxModule::FluxIntensiveQuantities;
@@ -107,9 +114,11 @@ public:
         const auto& priVars = elemCtx.primaryVars(dofIdx, timeIdx);
         const auto& problem = elemCtx.problem();
 
-        const Scalar flashTolerance = Parameters::get<TypeTag, Properties::FlashTolerance>();
-        const int flashVerbosity = Parameters::get<TypeTag, Properties::FlashVerbosity>();
-        const std::string flashTwoPhaseMethod = Parameters::get<TypeTag, Properties::FlashTwoPhaseMethod>();
+        const Scalar flashTolerance = Parameters::getCached<TypeTag, Properties::FlashTolerance>();
+        const int flashVerbosity = Parameters::getCached<TypeTag, Properties::FlashVerbosity>();
+        const std::string& flashTwoPhaseMethod = Parameters::getCached<TypeTag, Properties::FlashTwoPhaseMethod>();
+        const Scalar flashSkipStabilityTolerance =
+            Parameters::getCached<TypeTag, Properties::FlashSkipStabilityTolerance>();
 
         // extract the total molar densities of the components
         ComponentVector z(0.);
@@ -133,9 +142,29 @@ public:
         for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
             fluidState_.setPressure(phaseIdx, p);
 
+        // the result of the last flash of the cell. the entries describe the latest
+        // iterate, so they are only used for the current solution
+        auto& flashStateCache = elemCtx.model().flashStateCache();
+        const unsigned globalSpaceIdx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
+        typename FlashStateCache::Entry cachedState;
+        const bool haveCachedState =
+            timeIdx == 0 && flashStateCache.lookup(globalSpaceIdx, cachedState);
+
+        std::array<Scalar, numComponents> zValues;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            zValues[compIdx] = Opm::getValue(z[compIdx]);
+        const Scalar pValue = Opm::getValue(p);
+        const Scalar TValue = Opm::getValue(fluidState_.temperature(/*phaseIdx=*/0));
+
+        // an entry which was computed for the current state, e.g., by the batched
+        // flash, is a better initial guess than the thermodynamic hints
+        const bool cachedStateIsCurrent =
+            haveCachedState
+            && FlashStateCache::describesState(cachedState, zValues, pValue, TValue);
+
         // Get initial K and L from storage initially (if enabled)
         const auto *hint = elemCtx.thermodynamicHint(dofIdx, timeIdx);
-        if (hint) {
+        if (hint && !cachedStateIsCurrent) {
              for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
                  const Evaluation& Ktmp = hint->fluidState().K(compIdx);
                  fluidState_.setKvalue(compIdx, Ktmp);
@@ -143,7 +172,7 @@ public:
              const Evaluation& Ltmp = hint->fluidState().L();
              fluidState_.setLvalue(Ltmp);
         }
-        else if (timeIdx == 0 && elemCtx.thermodynamicHint(dofIdx, 1)) {
+        else if (timeIdx == 0 && !cachedStateIsCurrent && elemCtx.thermodynamicHint(dofIdx, 1)) {
              // checking the storage cache
              const auto& hint2 = elemCtx.thermodynamicHint(dofIdx, 1);
              for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
@@ -153,6 +182,12 @@ public:
              const Evaluation& Ltmp = hint2->fluidState().L();
              fluidState_.setLvalue(Ltmp);
         }
+        else if (haveCachedState) {
+             // warm start from the last flash of the cell
+             for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                 fluidState_.setKvalue(compIdx, Evaluation(cachedState.K[compIdx]));
+             fluidState_.setLvalue(Evaluation(cachedState.L));
+        }
         else {
              for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
                  const Evaluation Ktmp = fluidState_.wilsonK_(compIdx);
@@ -169,7 +204,70 @@ public:
             const int spatialIdx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
             std::cout << " updating the intensive quantities for Cell " << spatialIdx << std::endl;
         }
-        FlashSolver::solve(fluidState_, z, flashTwoPhaseMethod, flashTolerance, flashVerbosity);
+        const bool skipFlash =
+            haveCachedState
+            && FlashStateCache::canSkipStabilityTest(cachedState, zValues, pValue, TValue,
+                                                     flashSkipStabilityTolerance);
+        if (skipFlash) {
+            // the cell stays in the single-phase state found by the last flash, i.e.,
+            // both phases exhibit the overall composition
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+                fluidState_.setMoleFraction(FluidSystem::oilPhaseIdx, compIdx, z[compIdx]);
+                fluidState_.setMoleFraction(FluidSystem::gasPhaseIdx, compIdx, z[compIdx]);
+                fluidState_.setKvalue(compIdx, Evaluation(cachedState.K[compIdx]));
+            }
+            fluidState_.setLvalue(Evaluation(cachedState.L));
+        }
+        else {
+            // the tabulated results are only meaningful if the derivatives with regard
+            // to the primary variables are available
+            FlashTabulation* flashTabulation =
+                timeIdx == 0 ? elemCtx.model().flashTabulation() : nullptr;
+            typename FlashTabulation::Key tabulationKey;
+            typename FlashTabulation::Result tabulatedResult;
+            typename FlashTabulation::Candidate tabulationCandidate;
+            bool isTabulated = false;
+            if (flashTabulation) {
+                for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                    tabulationKey[pvIdx] = priVars[pvIdx];
+                isTabulated = flashTabulation->lookup(tabulationKey, TValue,
+                                                      tabulatedResult, tabulationCandidate);
+            }
+
+            if (isTabulated) {
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+                    fluidState_.setMoleFraction(FluidSystem::oilPhaseIdx, compIdx, tabulatedResult.x[compIdx]);
+                    fluidState_.setMoleFraction(FluidSystem::gasPhaseIdx, compIdx, tabulatedResult.y[compIdx]);
+                    fluidState_.setKvalue(compIdx, tabulatedResult.K[compIdx]);
+                }
+                fluidState_.setLvalue(tabulatedResult.L);
+            }
+            else {
+                FlashSolver::solve(fluidState_, z, flashTwoPhaseMethod, flashTolerance, flashVerbosity);
+
+                if (flashTabulation) {
+                    for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+                        tabulatedResult.x[compIdx] = fluidState_.moleFraction(FluidSystem::oilPhaseIdx, compIdx);
+                        tabulatedResult.y[compIdx] = fluidState_.moleFraction(FluidSystem::gasPhaseIdx, compIdx);
+                        tabulatedResult.K[compIdx] = fluidState_.K(compIdx);
+                    }
+                    tabulatedResult.L = fluidState_.L();
+                    flashTabulation->update(tabulationCandidate, tabulationKey, TValue, tabulatedResult);
+                }
+            }
+
+            if (timeIdx == 0 && flashStateCache.size() > 0) {
+                typename FlashStateCache::Entry newState;
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                    newState.K[compIdx] = Opm::getValue(fluidState_.K(compIdx));
+                newState.z = zValues;
+                newState.L = Opm::getValue(fluidState_.L());
+                newState.pressure = pValue;
+                newState.temperature = TValue;
+                newState.flashed = !isTabulated;
+                flashStateCache.store(globalSpaceIdx, newState);
+            }
+        }
 
         if (flashVerbosity >= 5) {
             // printing of flash result after solve
@@ -39,6 +39,9 @@
 #include <opm/models/flash/flashextensivequantities.hh>
 #include "flashindices.hh"
 #include "flashnewtonmethod.hh"
+#include "flashstatecache.hh"
+#include "batchedflash.hh"
+#include "flashtabulation.hh"
 
 #include <opm/models/common/multiphasebasemodel.hh>
 #include <opm/models/common/energymodule.hh>
@@ -50,8 +53,12 @@
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
 #include <opm/material/constraintsolvers/PTFlash.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace Opm {
 template <class TypeTag>
@@ -99,6 +106,43 @@ struct FlashVerbosity<TypeTag, TTag::FlashModel> { static constexpr int value =
 template<class TypeTag>
 struct FlashTwoPhaseMethod<TypeTag, TTag::FlashModel> { static constexpr auto value = "ssi"; };
 
+// Do not keep the results of the flash calculations by default
+template<class TypeTag>
+struct EnableFlashStateCache<TypeTag, TTag::FlashModel> { static constexpr bool value = false; };
+
+// Always conduct the stability test by default
+template<class TypeTag>
+struct FlashSkipStabilityTolerance<TypeTag, TTag::FlashModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.0;
+};
+
+// Flash each cell individually by default
+template<class TypeTag>
+struct EnableBatchedFlash<TypeTag, TTag::FlashModel> { static constexpr bool value = false; };
+
+// Do not tabulate the flash results by default
+template<class TypeTag>
+struct EnableFlashTabulation<TypeTag, TTag::FlashModel> { static constexpr bool value = false; };
+
+template<class TypeTag>
+struct FlashTabulationTolerance<TypeTag, TTag::FlashModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1e-6;
+};
+
+template<class TypeTag>
+struct FlashTabulationRadius<TypeTag, TTag::FlashModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1e-3;
+};
+
+template<class TypeTag>
+struct FlashTabulationMaxEntries<TypeTag, TTag::FlashModel> { static constexpr unsigned value = 100000; };
+
 //! the Model property
 template<class TypeTag>
 struct Model<TypeTag, TTag::FlashModel> { using type = Opm::FlashModel<TypeTag>; };
@@ -201,9 +245,12 @@ class FlashModel
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
 
     using Indices = GetPropType<TypeTag, Properties::Indices>;
 
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
     enum { numComponents = getPropValue<TypeTag, Properties::NumComponents>() };
     enum { enableDiffusion = getPropValue<TypeTag, Properties::EnableDiffusion>() };
     enum { enableEnergy = getPropValue<TypeTag, Properties::EnableEnergy>() };
@@ -212,6 +259,10 @@ class FlashModel
     using EnergyModule = Opm::EnergyModule<TypeTag, enableEnergy>;
 
 public:
+    using FlashStateCache = Opm::FlashStateCache<Scalar, numComponents>;
+    using BatchedFlash = Opm::BatchedFlash<Scalar, FluidSystem>;
+    using FlashTabulation = Opm::FlashTabulation<Scalar, Evaluation, numComponents, numEq>;
+
     explicit FlashModel(Simulator& simulator)
         : ParentType(simulator)
     {}
@@ -241,8 +292,174 @@ public:
         Parameters::registerParam<TypeTag, Properties::FlashTwoPhaseMethod>
             ("Method for solving vapor-liquid composition. Available options include: "
              "ssi, newton, ssi+newton");
+        Parameters::registerParam<TypeTag, Properties::EnableFlashStateCache>
+            ("Keep the result of the last flash calculation of each cell and use it "
+             "as the initial guess if no thermodynamic hint is available");
+        Parameters::registerParam<TypeTag, Properties::FlashSkipStabilityTolerance>
+            ("Skip the flash of cells which were single-phase if their composition, "
+             "relative pressure and relative temperature changed by less than this "
+             "value. This requires the flash state cache, zero disables skipping");
+        Parameters::registerParam<TypeTag, Properties::EnableBatchedFlash>
+            ("Run the successive substitution iterations of the two-phase cells of "
+             "each tile of the intensive quantity update at once. This requires the "
+             "flash state cache and a static or guided IntensiveQuantityUpdateSchedule");
+        Parameters::registerParam<TypeTag, Properties::EnableFlashTabulation>
+            ("Extrapolate the results of the two-phase flash calculations from an "
+             "adaptive table of nearby states if possible");
+        Parameters::registerParam<TypeTag, Properties::FlashTabulationTolerance>
+            ("The maximum error of the phase compositions and of the phase split which "
+             "are extrapolated from the flash table");
+        Parameters::registerParam<TypeTag, Properties::FlashTabulationRadius>
+            ("The maximum distance of a state to a tabulated one. The pressure and the "
+             "temperature are considered relative to the tabulated state");
+        Parameters::registerParam<TypeTag, Properties::FlashTabulationMaxEntries>
+            ("The number of states in the flash table of a thread at which the table "
+             "is cleared");
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::finishInit
+     */
+    void finishInit()
+    {
+        // the parent class flashes the initial solution, so the cache must exist first
+        if (Parameters::get<TypeTag, Properties::EnableFlashStateCache>())
+            flashStateCache_.resize(this->numGridDof());
+        enableBatchedFlash_ = Parameters::get<TypeTag, Properties::EnableBatchedFlash>();
+
+        flashTabulations_.clear();
+        if (Parameters::get<TypeTag, Properties::EnableFlashTabulation>()) {
+            const Scalar tolerance = Parameters::get<TypeTag, Properties::FlashTabulationTolerance>();
+            const Scalar radius = Parameters::get<TypeTag, Properties::FlashTabulationRadius>();
+            const unsigned maxEntries = Parameters::get<TypeTag, Properties::FlashTabulationMaxEntries>();
+            for (unsigned threadId = 0; threadId < ThreadManager::maxThreads(); ++threadId)
+                flashTabulations_.emplace_back(Indices::pressure0Idx, tolerance, radius, maxEntries);
+        }
+
+        ParentType::finishInit();
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::adaptGrid
+     */
+    void adaptGrid()
+    {
+        ParentType::adaptGrid();
+
+        if (flashStateCache_.size() > 0)
+            flashStateCache_.resize(this->numGridDof());
     }
 
+    /*!
+     * \brief Returns the flash table of the current thread.
+     *
+     * If flash tabulation is disabled, nullptr is returned.
+     */
+    FlashTabulation* flashTabulation() const
+    {
+        if (flashTabulations_.empty())
+            return nullptr;
+        return &flashTabulations_[ThreadManager::threadId()];
+    }
+
+    /*!
+     * \brief Pre-solve the flash of the two-phase degrees of freedom of a range.
+     *
+     * The successive substitution iterations for the cells of the range are run in
+     * batches, starting from the cached result of the last flash. The results are
+     * stored in the flash state cache where the update of the intensive quantities
+     * picks them up as the initial guess of the complete flash.
+     */
+    void prepareIntensiveQuantities(std::size_t dofBegin,
+                                    std::size_t dofEnd,
+                                    unsigned timeIdx) const
+    {
+        ParentType::prepareIntensiveQuantities(dofBegin, dofEnd, timeIdx);
+
+        if (timeIdx != 0 || !enableBatchedFlash_ || flashStateCache_.size() == 0)
+            return;
+
+        const Scalar tolerance = Parameters::getCached<TypeTag, Properties::FlashTolerance>();
+        const auto& solution = this->solution(timeIdx);
+
+        BatchedFlash batch;
+        std::array<std::size_t, BatchedFlash::batchSize> batchDofIdx;
+        std::array<typename FlashStateCache::Entry, BatchedFlash::batchSize> batchEntries;
+        const auto solveBatch = [&]()
+        {
+            batch.solve(tolerance, batchedFlashMaxIterations);
+            for (unsigned lane = 0; lane < batch.numCells(); ++lane) {
+                if (!batch.converged(lane))
+                    continue;
+
+                auto& entry = batchEntries[lane];
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                    entry.K[compIdx] = batch.K(lane, compIdx);
+                entry.L = batch.L(lane);
+                entry.flashed = false;
+                flashStateCache_.store(batchDofIdx[lane], entry);
+            }
+            batch.clear();
+        };
+
+        typename FlashStateCache::Entry entry;
+        std::array<Scalar, numComponents> z;
+        for (std::size_t dofIdx = dofBegin; dofIdx < dofEnd; ++dofIdx) {
+            if (this->cachedIntensiveQuantities(static_cast<unsigned>(dofIdx), timeIdx))
+                continue;
+
+            // single-phase cells require a stability test, so only the cells which
+            // were two-phase during their last flash are considered
+            if (!flashStateCache_.lookup(dofIdx, entry) || entry.isSinglePhase())
+                continue;
+
+            // the overall composition is determined like in the intensive quantities
+            const auto& priVars = solution[dofIdx];
+            Scalar lastZ = 1.0;
+            for (unsigned compIdx = 0; compIdx < numComponents - 1; ++compIdx) {
+                z[compIdx] = priVars[Indices::z0Idx + compIdx];
+                lastZ -= z[compIdx];
+            }
+            z[numComponents - 1] = lastZ;
+
+            Scalar sumz = 0.0;
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+                z[compIdx] = std::max(z[compIdx], Scalar{1e-8});
+                sumz += z[compIdx];
+            }
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                z[compIdx] /= sumz;
+
+            // the temperature is not a primary variable, so the one of the last flash
+            // is used
+            const Scalar pressure = priVars[Indices::pressure0Idx];
+            if (FlashStateCache::describesState(entry, z, pressure, entry.temperature))
+                continue;
+
+            const unsigned lane = batch.numCells();
+            entry.z = z;
+            entry.pressure = pressure;
+            batch.setCell(lane, z, entry.K, pressure, entry.temperature);
+            batchDofIdx[lane] = dofIdx;
+            batchEntries[lane] = entry;
+
+            if (batch.numCells() == BatchedFlash::batchSize)
+                solveBatch();
+        }
+
+        if (batch.numCells() > 0)
+            solveBatch();
+    }
+
+    /*!
+     * \brief Returns the results of the last flash calculations of all degrees of
+     *        freedom.
+     *
+     * The cache is empty if it is disabled by the EnableFlashStateCache parameter.
+     */
+    FlashStateCache& flashStateCache() const
+    { return flashStateCache_; }
+
     /*!
      * \copydoc FvBaseDiscretization::primaryVarName
      */
@@ -296,6 +513,13 @@ public:
         if (enableEnergy)
             this->addOutputModule(new Opm::VtkEnergyModule<TypeTag>(this->simulator_));
     }
+
+private:
+    static constexpr unsigned batchedFlashMaxIterations = 100;
+
+    mutable FlashStateCache flashStateCache_;
+    bool enableBatchedFlash_ = false;
+    mutable std::vector<FlashTabulation> flashTabulations_;
 };
 
 } // namespace Opm
@@ -49,6 +49,28 @@ struct FlashVerbosity { using type = UndefinedProperty; };
 //! Two-phase flash method
 template<class TypeTag, class MyTypeTag>
 struct FlashTwoPhaseMethod { using type = UndefinedProperty; };
+//! Keep the result of the last flash of each cell to warm start the next one
+template<class TypeTag, class MyTypeTag>
+struct EnableFlashStateCache { using type = UndefinedProperty; };
+//! The maximum change of the state of a single-phase cell for which the stability
+//! test of the flash is skipped
+template<class TypeTag, class MyTypeTag>
+struct FlashSkipStabilityTolerance { using type = UndefinedProperty; };
+//! Pre-solve the flash of the cells of each tile of the intensive quantity update at once
+template<class TypeTag, class MyTypeTag>
+struct EnableBatchedFlash { using type = UndefinedProperty; };
+//! Use an adaptive table of the results of the two-phase flash calculations
+template<class TypeTag, class MyTypeTag>
+struct EnableFlashTabulation { using type = UndefinedProperty; };
+//! The maximum error of the mole fractions extrapolated from the flash table
+template<class TypeTag, class MyTypeTag>
+struct FlashTabulationTolerance { using type = UndefinedProperty; };
+//! The maximum distance of a state to a state of the flash table
+template<class TypeTag, class MyTypeTag>
+struct FlashTabulationRadius { using type = UndefinedProperty; };
+//! The number of states of the flash table of a thread at which it is cleared
+template<class TypeTag, class MyTypeTag>
+struct FlashTabulationMaxEntries { using type = UndefinedProperty; };
 
 } // namespace Opm::Properties
 
@@ -0,0 +1,191 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::FlashStateCache
+ */
+#ifndef OPM_PTFLASH_STATE_CACHE_HH
+#define OPM_PTFLASH_STATE_CACHE_HH
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+
+namespace Opm {
+
+/*!
+ * \ingroup FlashModel
+ *
+ * \brief Stores the result of the last flash calculation of each degree of freedom.
+ *
+ * In contrast to the thermodynamic hints, which are taken from the cached intensive
+ * quantities, the entries of this cache survive invalidations of the intensive
+ * quantity cache. They are used to warm start the flash solver and to skip the
+ * stability test for cells which were single-phase during the last flash and whose
+ * state did not change significantly since then. Entries may also be the result of
+ * the batched pre-solve of the flash model, which does not conduct a stability test.
+ *
+ * The entries are guarded by a per-entry try-lock: If another thread currently
+ * accesses an entry, lookups fail and stores are dropped, i.e., the cache never
+ * blocks.
+ */
+template <class Scalar, unsigned numComponents>
+class FlashStateCache
+{
+public:
+    struct Entry
+    {
+        std::array<Scalar, numComponents> K{};
+        std::array<Scalar, numComponents> z{};
+        Scalar L = -1.0;
+        Scalar pressure = 0.0;
+        Scalar temperature = 0.0;
+        //! True if the entry is the result of a complete flash including the stability test
+        bool flashed = false;
+
+        /*!
+         * \brief Returns true if the flash determined the fluid to be single-phase.
+         */
+        bool isSinglePhase() const
+        { return L <= 0.0 || L >= 1.0; }
+    };
+
+    FlashStateCache() = default;
+
+    /*!
+     * \brief Discard all entries and allocate storage for a given number of degrees
+     *        of freedom.
+     */
+    void resize(std::size_t numDof)
+    {
+        slots_.reset(numDof > 0 ? new Slot_[numDof] : nullptr);
+        size_ = numDof;
+    }
+
+    /*!
+     * \brief Returns the number of degrees of freedom covered by the cache.
+     */
+    std::size_t size() const
+    { return size_; }
+
+    /*!
+     * \brief Copy the entry of a degree of freedom.
+     *
+     * Returns false if no valid entry is available.
+     */
+    bool lookup(std::size_t dofIdx, Entry& entry) const
+    {
+        if (dofIdx >= size_)
+            return false;
+
+        Slot_& slot = slots_[dofIdx];
+        if (slot.busy.exchange(true, std::memory_order_acquire))
+            return false;
+
+        const bool valid = slot.valid;
+        if (valid)
+            entry = slot.entry;
+        slot.busy.store(false, std::memory_order_release);
+        return valid;
+    }
+
+    /*!
+     * \brief Overwrite the entry of a degree of freedom.
+     */
+    void store(std::size_t dofIdx, const Entry& entry)
+    {
+        if (dofIdx >= size_)
+            return;
+
+        Slot_& slot = slots_[dofIdx];
+        if (slot.busy.exchange(true, std::memory_order_acquire))
+            return;
+
+        slot.entry = entry;
+        slot.valid = true;
+        slot.busy.store(false, std::memory_order_release);
+    }
+
+    /*!
+     * \brief Returns true if the flash for a given state can re-use the single-phase
+     *        verdict of a cached entry.
+     *
+     * This is the case if the entry is single-phase and if neither the overall
+     * composition, nor the relative pressure, nor the relative temperature differ by
+     * more than the given tolerance.
+     */
+    template <class ComponentVector>
+    static bool canSkipStabilityTest(const Entry& entry,
+                                     const ComponentVector& z,
+                                     Scalar pressure,
+                                     Scalar temperature,
+                                     Scalar tolerance)
+    {
+        if (tolerance <= 0.0 || !entry.flashed || !entry.isSinglePhase())
+            return false;
+
+        Scalar delta = 0.0;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            delta = std::max(delta, std::abs(z[compIdx] - entry.z[compIdx]));
+        delta = std::max(delta, std::abs(pressure - entry.pressure)/std::abs(entry.pressure));
+        delta = std::max(delta, std::abs(temperature - entry.temperature)/std::abs(entry.temperature));
+
+        return delta < tolerance;
+    }
+
+    /*!
+     * \brief Returns true if a cached entry was computed for exactly the given state.
+     */
+    template <class ComponentVector>
+    static bool describesState(const Entry& entry,
+                               const ComponentVector& z,
+                               Scalar pressure,
+                               Scalar temperature)
+    {
+        if (pressure != entry.pressure || temperature != entry.temperature)
+            return false;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            if (z[compIdx] != entry.z[compIdx])
+                return false;
+        return true;
+    }
+
+private:
+    struct Slot_
+    {
+        Entry entry;
+        bool valid = false;
+        std::atomic<bool> busy{false};
+    };
+
+    std::unique_ptr<Slot_[]> slots_;
+    std::size_t size_ = 0;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,274 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::FlashTabulation
+ */
+#ifndef OPM_PTFLASH_TABULATION_HH
+#define OPM_PTFLASH_TABULATION_HH
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup FlashModel
+ *
+ * \brief An adaptive table of the results of two-phase flash calculations.
+ *
+ * The table is keyed on the primary variables of a degree of freedom and its
+ * temperature. Each entry stores the phase split of a flash including its derivatives
+ * with regard to the primary variables, which allows to extrapolate the result
+ * linearly to nearby states. In the spirit of in-situ adaptive tabulation, the
+ * region in which an entry is used is grown only after a complete flash has verified
+ * that the linear extrapolation is accurate within the tolerance:
+ *
+ * - A new entry only reproduces its own state.
+ * - If a state is close to an entry but outside of its region, the caller conducts
+ *   the complete flash and passes the result to update(). If the extrapolation of the
+ *   entry matches this result, the region of the entry is grown to contain the state,
+ *   otherwise the result becomes a new entry.
+ *
+ * The distance of two states is the maximum of the differences of the primary
+ * variables, where the pressure and the temperature are taken relative to the values
+ * of the entry. To find the candidate entries quickly, they are hashed on their
+ * quantized pressure and composition. Single-phase results are not tabulated,
+ * since these are cheap to obtain from the stability test anyway.
+ *
+ * The table is not thread-safe, i.e., each thread should use its own one.
+ */
+template <class Scalar, class Evaluation, unsigned numComponents, unsigned numPrimaryVars>
+class FlashTabulation
+{
+public:
+    using Key = std::array<Scalar, numPrimaryVars>;
+
+    //! The tabulated quantities of a flash
+    struct Result
+    {
+        Evaluation L;
+        std::array<Evaluation, numComponents> K;
+        std::array<Evaluation, numComponents> x;
+        std::array<Evaluation, numComponents> y;
+    };
+
+    //! The entry closest to a state for which a lookup failed
+    struct Candidate
+    {
+        std::size_t entryIdx = std::numeric_limits<std::size_t>::max();
+        Scalar distance = 0.0;
+    };
+
+    /*!
+     * \param pressureIdx The index of the pressure in the primary variables.
+     * \param tolerance The maximum accepted error of the extrapolated mole fractions.
+     * \param maxRadius The maximum distance of a state to a tabulated one.
+     * \param maxEntries The number of entries at which the table is cleared.
+     */
+    FlashTabulation(unsigned pressureIdx,
+                    Scalar tolerance,
+                    Scalar maxRadius,
+                    std::size_t maxEntries)
+        : pressureIdx_(pressureIdx)
+        , tolerance_(tolerance)
+        , maxRadius_(maxRadius)
+        , maxEntries_(maxEntries)
+    {}
+
+    /*!
+     * \brief Returns the number of tabulated states.
+     */
+    std::size_t size() const
+    { return entries_.size(); }
+
+    /*!
+     * \brief Discard all entries.
+     */
+    void clear()
+    {
+        entries_.clear();
+        buckets_.clear();
+    }
+
+    /*!
+     * \brief Look up the flash result for a given state.
+     *
+     * Returns true if the state lies within the region of an entry. Otherwise, the
+     * closest entry is recorded in \c candidate, which should be passed to update()
+     * together with the result of the complete flash.
+     */
+    bool lookup(const Key& key, Scalar temperature, Result& result, Candidate& candidate) const
+    {
+        candidate = Candidate{};
+
+        const auto bucketIt = buckets_.find(bucketIndex_(key));
+        if (bucketIt == buckets_.end())
+            return false;
+
+        for (const std::size_t entryIdx : bucketIt->second) {
+            const Entry_& entry = entries_[entryIdx];
+            const Scalar distance = distance_(entry, key, temperature);
+            if (distance > maxRadius_)
+                continue;
+
+            if (distance <= entry.radius) {
+                extrapolate_(entry, key, result);
+                // the phase split must not leave the two-phase region
+                const Scalar L = result.L.value();
+                if (L > 0.0 && L < 1.0)
+                    return true;
+            }
+
+            if (candidate.entryIdx == std::numeric_limits<std::size_t>::max()
+                || distance < candidate.distance)
+            {
+                candidate.entryIdx = entryIdx;
+                candidate.distance = distance;
+            }
+        }
+
+        return false;
+    }
+
+    /*!
+     * \brief Incorporate the result of a complete flash for a state for which the
+     *        lookup failed.
+     */
+    void update(const Candidate& candidate, const Key& key, Scalar temperature, const Result& result)
+    {
+        const Scalar L = result.L.value();
+        if (!(L > 0.0 && L < 1.0))
+            return;
+
+        if (candidate.entryIdx < entries_.size()) {
+            Entry_& entry = entries_[candidate.entryIdx];
+            Result extrapolated;
+            extrapolate_(entry, key, extrapolated);
+            if (error_(extrapolated, result) <= tolerance_) {
+                entry.radius = std::max(entry.radius, candidate.distance);
+                return;
+            }
+        }
+
+        if (entries_.size() >= maxEntries_)
+            clear();
+
+        buckets_[bucketIndex_(key)].push_back(entries_.size());
+        entries_.push_back(Entry_{key, temperature, /*radius=*/0.0, result});
+    }
+
+private:
+    struct Entry_
+    {
+        Key key;
+        Scalar temperature;
+        Scalar radius;
+        Result result;
+    };
+
+    Scalar keyDifference_(const Entry_& entry, const Key& key, unsigned pvIdx) const
+    {
+        const Scalar delta = std::abs(key[pvIdx] - entry.key[pvIdx]);
+        if (pvIdx == pressureIdx_)
+            return delta/std::abs(entry.key[pvIdx]);
+        return delta;
+    }
+
+    Scalar distance_(const Entry_& entry, const Key& key, Scalar temperature) const
+    {
+        Scalar distance = std::abs(temperature - entry.temperature)/std::abs(entry.temperature);
+        for (unsigned pvIdx = 0; pvIdx < numPrimaryVars; ++pvIdx)
+            distance = std::max(distance, keyDifference_(entry, key, pvIdx));
+        return distance;
+    }
+
+    // extrapolate the tabulated result linearly to a given state. the derivatives of
+    // the result are assumed to be constant.
+    static void extrapolateEval_(const Evaluation& tabulated, const Key& delta, Evaluation& result)
+    {
+        result = tabulated;
+        Scalar value = tabulated.value();
+        for (unsigned pvIdx = 0; pvIdx < numPrimaryVars; ++pvIdx)
+            value += tabulated.derivative(pvIdx)*delta[pvIdx];
+        result.setValue(value);
+    }
+
+    static void extrapolate_(const Entry_& entry, const Key& key, Result& result)
+    {
+        Key delta;
+        for (unsigned pvIdx = 0; pvIdx < numPrimaryVars; ++pvIdx)
+            delta[pvIdx] = key[pvIdx] - entry.key[pvIdx];
+
+        extrapolateEval_(entry.result.L, delta, result.L);
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+            extrapolateEval_(entry.result.K[compIdx], delta, result.K[compIdx]);
+            extrapolateEval_(entry.result.x[compIdx], delta, result.x[compIdx]);
+            extrapolateEval_(entry.result.y[compIdx], delta, result.y[compIdx]);
+        }
+    }
+
+    // the maximum difference of the phase split and the phase compositions
+    static Scalar error_(const Result& a, const Result& b)
+    {
+        Scalar error = std::abs(a.L.value() - b.L.value());
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+            error = std::max(error, std::abs(a.x[compIdx].value() - b.x[compIdx].value()));
+            error = std::max(error, std::abs(a.y[compIdx].value() - b.y[compIdx].value()));
+        }
+        return error;
+    }
+
+    // hash the quantized pressure and the quantized remaining primary variables. the
+    // pressure is quantized logarithmically to match the relative distance.
+    std::uint64_t bucketIndex_(const Key& key) const
+    {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (unsigned pvIdx = 0; pvIdx < numPrimaryVars; ++pvIdx) {
+            const Scalar coord =
+                pvIdx == pressureIdx_ ? std::log(std::abs(key[pvIdx])) : key[pvIdx];
+            const auto cellIdx = static_cast<std::int64_t>(std::floor(coord/maxRadius_));
+            hash = (hash ^ static_cast<std::uint64_t>(cellIdx))*1099511628211ULL;
+        }
+        return hash;
+    }
+
+    unsigned pressureIdx_;
+    Scalar tolerance_;
+    Scalar maxRadius_;
+    std::size_t maxEntries_;
+
+    std::vector<Entry_> entries_;
+    std::unordered_map<std::uint64_t, std::vector<std::size_t>> buckets_;
+};
+
+} // namespace Opm
+
+#endif
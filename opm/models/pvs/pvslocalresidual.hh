@@ -67,6 +67,11 @@ class PvsLocalResidual : public GetPropType<TypeTag, Properties::DiscLocalResidu
     using Toolbox = Opm::MathToolbox<Evaluation>;
 
 public:
+    //! Specifies whether addTpfaAdvectiveFlux() describes all fluxes of the model,
+    //! i.e., whether EcfvTpfaLinearizer can be used. Molecular diffusion and thermal
+    //! conduction are not covered.
+    static constexpr bool tpfaFluxSupported = !enableDiffusion && !enableEnergy;
+
     /*!
      * \copydoc ImmiscibleLocalResidual::addPhaseStorage
      */
@@ -77,7 +82,17 @@ public:
                          unsigned timeIdx,
                          unsigned phaseIdx) const
     {
-        const IntensiveQuantities& intQuants = elemCtx.intensiveQuantities(dofIdx, timeIdx);
+        addPhaseStorage(storage, elemCtx.intensiveQuantities(dofIdx, timeIdx), phaseIdx);
+    }
+
+    /*!
+     * \copydoc ImmiscibleLocalResidual::addPhaseStorage(Dune::FieldVector<LhsEval, numEq>&, const IntensiveQuantities&, unsigned)
+     */
+    template <class LhsEval>
+    static void addPhaseStorage(Dune::FieldVector<LhsEval, numEq>& storage,
+                                const IntensiveQuantities& intQuants,
+                                unsigned phaseIdx)
+    {
         const auto& fs = intQuants.fluidState();
 
         // compute storage term of all components within all phases
@@ -89,7 +104,7 @@ public:
                 * Toolbox::template decay<LhsEval>(intQuants.porosity());
         }
 
-        EnergyModule::addPhaseStorage(storage, elemCtx.intensiveQuantities(dofIdx, timeIdx), phaseIdx);
+        EnergyModule::addPhaseStorage(storage, intQuants, phaseIdx);
     }
 
     /*!
@@ -108,6 +123,20 @@ public:
         EnergyModule::addSolidEnergyStorage(storage, elemCtx.intensiveQuantities(dofIdx, timeIdx));
     }
 
+    /*!
+     * \copydoc ImmiscibleLocalResidual::computeStorage(Dune::FieldVector<LhsEval, numEq>&, const IntensiveQuantities&)
+     */
+    template <class LhsEval>
+    static void computeStorage(Dune::FieldVector<LhsEval, numEq>& storage,
+                               const IntensiveQuantities& intQuants)
+    {
+        storage = 0.0;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            addPhaseStorage(storage, intQuants, phaseIdx);
+
+        EnergyModule::addSolidEnergyStorage(storage, intQuants);
+    }
+
     /*!
      * \copydoc ImmiscibleLocalResidual::computeFlux
      */
@@ -169,6 +198,32 @@ public:
         EnergyModule::addAdvectiveFlux(flux, elemCtx, scvfIdx, timeIdx);
     }
 
+    /*!
+     * \copydoc ImmiscibleLocalResidual::addTpfaAdvectiveFlux
+     */
+    template <class PhaseFluxes>
+    static void addTpfaAdvectiveFlux(RateVector& flux,
+                                     const IntensiveQuantities& intQuantsIn,
+                                     const IntensiveQuantities& intQuantsEx,
+                                     const PhaseFluxes& phaseFluxes)
+    {
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (phaseFluxes.interiorIsUpstream(phaseIdx)) {
+                const auto& fs = intQuantsIn.fluidState();
+                Evaluation tmp = fs.molarDensity(phaseIdx)*phaseFluxes.volumeFlux(phaseIdx);
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                    flux[conti0EqIdx + compIdx] += tmp*fs.moleFraction(phaseIdx, compIdx);
+            }
+            else {
+                const auto& fs = intQuantsEx.fluidState();
+                Evaluation tmp =
+                    Toolbox::value(fs.molarDensity(phaseIdx))*phaseFluxes.volumeFlux(phaseIdx);
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                    flux[conti0EqIdx + compIdx] += tmp*Toolbox::value(fs.moleFraction(phaseIdx, compIdx));
+            }
+        }
+    }
+
     /*!
      * \copydoc ImmiscibleLocalResidual::addDiffusiveFlux
      */
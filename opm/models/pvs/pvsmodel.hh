@@ -52,8 +52,12 @@
 #include <opm/material/fluidmatrixinteractions/NullMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -145,6 +149,22 @@ struct PvsMoleFractionsBaseWeight<TypeTag, TTag::PvsModel>
     static constexpr type value = 1.0;
 };
 
+//! Switch the phase state as soon as the phase presence criterion is violated
+template<class TypeTag>
+struct PvsPhaseSwitchHysteresis<TypeTag, TTag::PvsModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.0;
+};
+
+//! Do not limit the number of phase switches by default
+template<class TypeTag>
+struct PvsMaxPhaseSwitches<TypeTag, TTag::PvsModel> { static constexpr unsigned value = 0; };
+
+//! Do not write the phase switch statistics by default
+template<class TypeTag>
+struct PvsPhaseSwitchLogFile<TypeTag, TTag::PvsModel> { static constexpr auto value = ""; };
+
 } // namespace Opm::Properties
 
 namespace Opm {
@@ -276,7 +296,19 @@ public:
         : ParentType(simulator)
     {
         verbosity_ = Parameters::get<TypeTag, Properties::PvsVerbosity>();
+        phaseSwitchHysteresis_ = Parameters::get<TypeTag, Properties::PvsPhaseSwitchHysteresis>();
+        maxPhaseSwitches_ = Parameters::get<TypeTag, Properties::PvsMaxPhaseSwitches>();
         numSwitched_ = 0;
+        numFrozen_ = 0;
+
+        const std::string logFileName = Parameters::get<TypeTag, Properties::PvsPhaseSwitchLogFile>();
+        if (!logFileName.empty() && simulator.gridView().comm().rank() == 0) {
+            phaseSwitchLog_.open(logFileName);
+            if (!phaseSwitchLog_)
+                throw std::runtime_error("Could not open the phase switch log file '"
+                                         + logFileName + "'");
+            phaseSwitchLog_ << "timeStepIdx,iterationIdx,numSwitched,numOscillating,numFrozen\n";
+        }
     }
 
     /*!
@@ -299,6 +331,15 @@ public:
         Parameters::registerParam<TypeTag, Properties::PvsVerbosity>
             ("The verbosity level of the primary variable "
              "switching model");
+        Parameters::registerParam<TypeTag, Properties::PvsPhaseSwitchHysteresis>
+            ("The margin by which the phase presence criterion must be violated "
+             "before the phase state of a degree of freedom is switched");
+        Parameters::registerParam<TypeTag, Properties::PvsMaxPhaseSwitches>
+            ("The maximum number of phase switches of a degree of freedom within a "
+             "time step. Further switches are rejected, 0 means unlimited");
+        Parameters::registerParam<TypeTag, Properties::PvsPhaseSwitchLogFile>
+            ("The name of the CSV file to which the number of phase switches of each "
+             "Newton iteration is written. If empty, no file is written");
     }
 
     /*!
@@ -359,6 +400,7 @@ public:
     {
         ParentType::updateFailed();
         numSwitched_ = 0;
+        std::fill(phaseSwitchCount_.begin(), phaseSwitchCount_.end(), 0);
     }
 
     /*!
@@ -438,6 +480,7 @@ public:
     {
         ParentType::advanceTimeLevel();
         numSwitched_ = 0;
+        std::fill(phaseSwitchCount_.begin(), phaseSwitchCount_.end(), 0);
     }
 
     /*!
@@ -447,11 +490,25 @@ public:
     bool switched() const
     { return numSwitched_ > 0; }
 
+    /*!
+     * \brief Returns the number of phase switches of a degree of freedom within the
+     *        current time step.
+     */
+    unsigned numPhaseSwitches(unsigned globalDofIdx) const
+    { return globalDofIdx < phaseSwitchCount_.size() ? phaseSwitchCount_[globalDofIdx] : 0; }
+
+    /*!
+     * \brief Returns the number of phase switches of a degree of freedom since the
+     *        start of the simulation.
+     */
+    unsigned totalNumPhaseSwitches(unsigned globalDofIdx) const
+    { return globalDofIdx < totalPhaseSwitchCount_.size() ? totalPhaseSwitchCount_[globalDofIdx] : 0; }
+
     /*!
      * \copydoc FvBaseDiscretization::serializeEntity
      */
-    template <class DofEntity>
-    void serializeEntity(std::ostream& outstream, const DofEntity& dofEntity)
+    template <class OutStream, class DofEntity>
+    void serializeEntity(OutStream& outstream, const DofEntity& dofEntity)
     {
         // write primary variables
         ParentType::serializeEntity(outstream, dofEntity);
@@ -466,8 +523,8 @@ public:
     /*!
      * \copydoc FvBaseDiscretization::deserializeEntity
      */
-    template <class DofEntity>
-    void deserializeEntity(std::istream& instream, const DofEntity& dofEntity)
+    template <class InStream, class DofEntity>
+    void deserializeEntity(InStream& instream, const DofEntity& dofEntity)
     {
         // read primary variables
         ParentType::deserializeEntity(instream, dofEntity);
@@ -483,6 +540,45 @@ public:
         this->solution(/*timeIdx=*/1)[dofIdx].setPhasePresence(tmp);
     }
 
+    /*!
+     * \copydoc FvBaseDiscretization::serializeEntityBlocks
+     */
+    template <class OutStream>
+    void serializeEntityBlocks(OutStream& outstream)
+    {
+        // write primary variables
+        ParentType::serializeEntityBlocks(outstream);
+
+        // write phase presence
+        const std::size_t numDof = this->numGridDof();
+        std::vector<short> phasePresence(numDof);
+        for (std::size_t dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            phasePresence[dofIdx] = this->solution(/*timeIdx=*/0)[dofIdx].phasePresence();
+        outstream.writeBlock(phasePresence.data(), phasePresence.size());
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::deserializeEntityBlocks
+     */
+    template <class InStream>
+    void deserializeEntityBlocks(InStream& instream)
+    {
+        // read primary variables
+        ParentType::deserializeEntityBlocks(instream);
+
+        // read phase presence
+        const std::size_t numDof = this->numGridDof();
+        std::vector<short> phasePresence(numDof);
+        instream.readBlock(phasePresence.data(), phasePresence.size());
+        if (!instream.good())
+            throw std::runtime_error("Could not deserialize the phase presence of the DOFs");
+
+        for (std::size_t dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+            this->solution(/*timeIdx=*/0)[dofIdx].setPhasePresence(phasePresence[dofIdx]);
+            this->solution(/*timeIdx=*/1)[dofIdx].setPhasePresence(phasePresence[dofIdx]);
+        }
+    }
+
     /*!
      * \internal
      * \brief Do the primary variable switching after a Newton iteration.
@@ -493,6 +589,13 @@ public:
     void switchPrimaryVars_()
     {
         numSwitched_ = 0;
+        numFrozen_ = 0;
+        unsigned numOscillating = 0;
+
+        if (phaseSwitchCount_.size() != this->numGridDof()) {
+            phaseSwitchCount_.assign(this->numGridDof(), 0);
+            totalPhaseSwitchCount_.assign(this->numGridDof(), 0);
+        }
 
         int succeeded;
         try {
@@ -518,11 +621,23 @@ public:
                     // evaluate primary variable switch
                     short oldPhasePresence = priVars.phasePresence();
 
+                    // degrees of freedom which exceeded the maximum number of phase
+                    // switches keep their phase state for the rest of the time step
+                    const bool frozen =
+                        maxPhaseSwitches_ > 0 && phaseSwitchCount_[globalIdx] >= maxPhaseSwitches_;
+                    const PrimaryVariables oldPriVars = priVars;
+
                     // set the primary variables and the new phase state
                     // from the current fluid state
-                    priVars.assignNaive(intQuants.fluidState());
+                    priVars.assignNaive(intQuants.fluidState(), phaseSwitchHysteresis_);
 
                     if (oldPhasePresence != priVars.phasePresence()) {
+                        if (frozen) {
+                            priVars = oldPriVars;
+                            ++numFrozen_;
+                            continue;
+                        }
+
                         if (verbosity_ > 1)
                             printSwitchedPhases_(elemCtx,
                                                  dofIdx,
@@ -530,6 +645,10 @@ public:
                                                  oldPhasePresence,
                                                  priVars);
                         ++numSwitched_;
+                        if (phaseSwitchCount_[globalIdx] > 0)
+                            ++numOscillating;
+                        ++phaseSwitchCount_[globalIdx];
+                        ++totalPhaseSwitchCount_[globalIdx];
                     }
                 }
             }
@@ -552,10 +671,22 @@ public:
         // other partition we will also set the switch flag
         // for our partition.
         numSwitched_ = this->gridView_.comm().sum(numSwitched_);
+        numFrozen_ = this->gridView_.comm().sum(numFrozen_);
+        numOscillating = this->gridView_.comm().sum(numOscillating);
+
+        if (verbosity_ > 0) {
+            auto& msg = this->simulator_.model().newtonMethod().endIterMsg();
+            msg << ", num switched=" << numSwitched_;
+            if (numFrozen_ > 0)
+                msg << ", num frozen=" << numFrozen_;
+        }
 
-        if (verbosity_ > 0)
-            this->simulator_.model().newtonMethod().endIterMsg()
-                << ", num switched=" << numSwitched_;
+        if (phaseSwitchLog_.is_open())
+            phaseSwitchLog_ << this->simulator_.timeStepIndex() << ","
+                            << this->simulator_.model().newtonMethod().numIterations() << ","
+                            << numSwitched_ << ","
+                            << numOscillating << ","
+                            << numFrozen_ << std::endl;
     }
 
     template <class FluidState>
@@ -614,6 +745,17 @@ public:
     // number of switches of the phase state in the last Newton
     // iteration
     unsigned numSwitched_;
+    // number of rejected switches of the phase state in the last Newton iteration
+    unsigned numFrozen_;
+
+    // number of switches of the phase state of each degree of freedom within the
+    // current time step and since the start of the simulation
+    std::vector<unsigned> phaseSwitchCount_;
+    std::vector<unsigned> totalPhaseSwitchCount_;
+
+    Scalar phaseSwitchHysteresis_;
+    unsigned maxPhaseSwitches_;
+    std::ofstream phaseSwitchLog_;
 
     // verbosity of the model
     int verbosity_;
@@ -276,6 +276,22 @@ public:
      */
     template <class FluidState>
     void assignNaive(const FluidState& fluidState)
+    { assignNaive(fluidState, /*hysteresis=*/0.0); }
+
+    /*!
+     * \brief Directly retrieve the primary variables from an arbitrary fluid state
+     *        without changing the phase presence unless required.
+     *
+     * A phase which is currently present only disappears if its NCP condition is
+     * violated by more than the hysteresis margin, and a phase which is currently not
+     * present only appears if the condition is exceeded by more than this margin. A
+     * margin of zero yields the same result as assignNaive().
+     *
+     * \param fluidState The fluid state which should be represented by the primary variables.
+     * \param hysteresis The margin of the phase presence criterion.
+     */
+    template <class FluidState>
+    void assignNaive(const FluidState& fluidState, Scalar hysteresis)
     {
         using FsToolbox = MathToolbox<typename FluidState::Scalar>;
 
@@ -288,6 +304,7 @@ public:
         Valgrind::CheckDefined((*this)[pressure0Idx]);
 
         // determine the phase presence.
+        const short oldPhasePresence = phasePresence_;
         phasePresence_ = 0;
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
             // use a NCP condition to determine if the phase is
@@ -298,7 +315,8 @@ public:
             }
             Scalar b = FsToolbox::value(fluidState.saturation(phaseIdx));
 
-            if (b > a)
+            const Scalar margin = phaseIsPresent(phaseIdx, oldPhasePresence) ? -hysteresis : hysteresis;
+            if (b - a > margin)
                 phasePresence_ |= (1 << phaseIdx);
         }
 
@@ -52,6 +52,16 @@ struct PvsSaturationsBaseWeight { using type = UndefinedProperty; };
 //! The basis value for the weight of the mole fraction primary variables
 template<class TypeTag, class MyTypeTag>
 struct PvsMoleFractionsBaseWeight { using type = UndefinedProperty; };
+//! The margin by which the phase presence criterion must be violated to switch the
+//! phase state of a degree of freedom
+template<class TypeTag, class MyTypeTag>
+struct PvsPhaseSwitchHysteresis { using type = UndefinedProperty; };
+//! The maximum number of phase switches of a degree of freedom within a time step
+template<class TypeTag, class MyTypeTag>
+struct PvsMaxPhaseSwitches { using type = UndefinedProperty; };
+//! The name of the CSV file to which the phase switch statistics are written
+template<class TypeTag, class MyTypeTag>
+struct PvsPhaseSwitchLogFile { using type = UndefinedProperty; };
 
 } // namespace Opm::Properties
 
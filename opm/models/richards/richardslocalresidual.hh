@@ -54,6 +54,9 @@ class RichardsLocalResidual : public GetPropType<TypeTag, Properties::DiscLocalR
     using Toolbox = Opm::MathToolbox<Evaluation>;
 
 public:
+    //! \copydoc ImmiscibleLocalResidual::tpfaFluxSupported
+    static constexpr bool tpfaFluxSupported = true;
+
     /*!
      * \copydoc ImmiscibleLocalResidual::computeStorage
      */
@@ -63,8 +66,20 @@ public:
                         unsigned dofIdx,
                         unsigned timeIdx) const
     {
-        const IntensiveQuantities& intQuants = elemCtx.intensiveQuantities(dofIdx, timeIdx);
+        computeStorage(storage, elemCtx.intensiveQuantities(dofIdx, timeIdx));
+    }
 
+    /*!
+     * \brief Evaluate the amount of the wetting phase mass per unit volume for given
+     *        intensive quantities.
+     *
+     * This variant does not need an element context and is used by the TPFA
+     * linearizers.
+     */
+    template <class LhsEval>
+    static void computeStorage(Dune::FieldVector<LhsEval, numEq>& storage,
+                               const IntensiveQuantities& intQuants)
+    {
         // partial time derivative of the wetting phase mass
         storage[contiEqIdx] =
             Toolbox::template decay<LhsEval>(intQuants.fluidState().density(liquidPhaseIdx))
@@ -96,6 +111,22 @@ public:
             flux[contiEqIdx] = extQuants.volumeFlux(liquidPhaseIdx)*Toolbox::value(rho);
     }
 
+    /*!
+     * \copydoc ImmiscibleLocalResidual::addTpfaAdvectiveFlux
+     */
+    template <class PhaseFluxes>
+    static void addTpfaAdvectiveFlux(RateVector& flux,
+                                     const IntensiveQuantities& intQuantsIn,
+                                     const IntensiveQuantities& intQuantsEx,
+                                     const PhaseFluxes& phaseFluxes)
+    {
+        const Evaluation& volumeFlux = phaseFluxes.volumeFlux(liquidPhaseIdx);
+        if (phaseFluxes.interiorIsUpstream(liquidPhaseIdx))
+            flux[contiEqIdx] += volumeFlux*intQuantsIn.fluidState().density(liquidPhaseIdx);
+        else
+            flux[contiEqIdx] += volumeFlux*Toolbox::value(intQuantsEx.fluidState().density(liquidPhaseIdx));
+    }
+
     /*!
      * \copydoc ImmiscibleLocalResidual::computeSource
      */
@@ -45,6 +45,14 @@
 #include <memory>
 #include <type_traits>
 #include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace Opm {
 
@@ -89,6 +97,95 @@ struct max_count_of
 using std::addressof;
 }
 
+/*!
+ * \brief Process-wide placement hints for large blocks of memory allocated by
+ *        aligned_alloc().
+ *
+ * Blocks of at least largeAllocationSize bytes can be backed by transparent huge
+ * pages and/or have their pages interleaved between all NUMA nodes. Both are only
+ * hints to the operating system: they are silently ignored if the system does not
+ * support them, and the memory is always released by aligned_free().
+ */
+struct LargeAllocationPolicy
+{
+    //! The minimum size of the blocks to which the policy applies, i.e., the size of
+    //! a huge page on x86-64.
+    static constexpr std::size_t largeAllocationSize = std::size_t(2) << 20;
+
+    //! Ask for transparent huge pages for large blocks
+    static inline bool useHugePages = false;
+
+    //! Interleave the pages of large blocks between all NUMA nodes instead of
+    //! placing them on the node of the thread which touches them first
+    static inline bool interleaveNumaNodes = false;
+
+    static bool isActive(std::size_t size) noexcept
+    { return (useHugePages || interleaveNumaNodes) && size >= largeAllocationSize; }
+
+    static std::size_t alignment() noexcept
+    { return useHugePages ? largeAllocationSize : std::size_t(4096); }
+
+    static void apply([[maybe_unused]] void* ptr, [[maybe_unused]] std::size_t size) noexcept
+    {
+#ifdef __linux__
+#ifdef MADV_HUGEPAGE
+        if (useHugePages)
+            ::madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+#ifdef SYS_mbind
+        if (interleaveNumaNodes) {
+            const auto& mask = numaNodeMask_();
+            if (mask.numNodes > 1) {
+                constexpr int mpolInterleave = 3; // MPOL_INTERLEAVE of <numaif.h>
+                ::syscall(SYS_mbind, ptr, size, mpolInterleave,
+                          &mask.bits, sizeof(mask.bits)*8, 0);
+            }
+        }
+#endif
+#endif
+    }
+
+private:
+    struct NodeMask
+    {
+        unsigned long bits = 0;
+        unsigned numNodes = 0;
+    };
+
+    // the NUMA nodes which are online, e.g. "0-1,3". only the nodes which fit into a
+    // single word are considered.
+    static const NodeMask& numaNodeMask_() noexcept
+    {
+        static const NodeMask mask = []() {
+            NodeMask result;
+            std::FILE* file = std::fopen("/sys/devices/system/node/online", "r");
+            if (!file)
+                return result;
+
+            unsigned first, last;
+            while (std::fscanf(file, "%u", &first) == 1) {
+                last = first;
+                char sep = '\n';
+                if (std::fscanf(file, "%c", &sep) == 1 && sep == '-') {
+                    if (std::fscanf(file, "%u", &last) != 1)
+                        break;
+                    if (std::fscanf(file, "%c", &sep) != 1)
+                        sep = '\n';
+                }
+                for (unsigned node = first; node <= last && node < sizeof(result.bits)*8; ++node) {
+                    result.bits |= 1UL << node;
+                    ++result.numNodes;
+                }
+                if (sep != ',')
+                    break;
+            }
+            std::fclose(file);
+            return result;
+        }();
+        return mask;
+    }
+};
+
 inline void* aligned_alloc(std::size_t alignment,
                            std::size_t size) noexcept
 {
@@ -96,10 +193,18 @@ inline void* aligned_alloc(std::size_t alignment,
     if (alignment < sizeof(void*)) {
         alignment = sizeof(void*);
     }
+    const bool isLarge = LargeAllocationPolicy::isActive(size);
+    if (isLarge && alignment < LargeAllocationPolicy::alignment()) {
+        // the placement hints apply to whole pages
+        alignment = LargeAllocationPolicy::alignment();
+    }
     void* p;
     if (::posix_memalign(&p, alignment, size) != 0) {
         p = 0;
     }
+    else if (isLarge) {
+        LargeAllocationPolicy::apply(p, size);
+    }
     return p;
 }
 
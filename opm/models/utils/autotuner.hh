@@ -0,0 +1,197 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::AutoTuner
+ */
+#ifndef EWOMS_AUTO_TUNER_HH
+#define EWOMS_AUTO_TUNER_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Selects the fastest values of run-time settings by timing trials.
+ *
+ * The settings ("knobs") are registered together with their candidate values and a
+ * function which applies a candidate. They are tuned one after the other: the
+ * candidates of the current knob are applied in turn before the trials, and each one
+ * is timed for a given number of trials. Since consecutive trials usually do not
+ * perform exactly the same work, e.g., the first Newton iteration of a time step may
+ * be more expensive than the later ones, the candidates are cycled through in rounds
+ * and the shortest time of each candidate is compared. When all rounds are done, the
+ * fastest candidate is applied for good and the next knob is tuned.
+ *
+ * A trial which is not finished by endTrial(), e.g., because the timed work was
+ * aborted, is simply repeated by the next call to beginTrial().
+ */
+class AutoTuner
+{
+public:
+    /*!
+     * \brief Specify the number of trials which are timed for each candidate.
+     */
+    void setTrialsPerCandidate(unsigned numTrials)
+    { trialsPerCandidate_ = std::max(numTrials, 1u); }
+
+    /*!
+     * \brief Register a setting which ought to be tuned.
+     *
+     * Knobs which have less than two candidates are ignored.
+     *
+     * \param name The name of the setting used by report()
+     * \param labels The names of the candidate values
+     * \param apply Applies the candidate of a given index
+     * \param initialIdx The index of the candidate which is currently applied
+     */
+    void addKnob(const std::string& name,
+                 std::vector<std::string> labels,
+                 std::function<void(std::size_t)> apply,
+                 std::size_t initialIdx)
+    {
+        if (labels.size() < 2)
+            return;
+
+        Knob knob;
+        knob.name = name;
+        knob.times.assign(labels.size(), std::numeric_limits<double>::infinity());
+        knob.labels = std::move(labels);
+        knob.apply = std::move(apply);
+        knob.initialIdx = initialIdx;
+        knob.bestIdx = initialIdx;
+        knobs_.push_back(std::move(knob));
+    }
+
+    /*!
+     * \brief Register the knobs of an object.
+     *
+     * This calls the registerTuningKnobs() method of the object if it provides one,
+     * which allows to tune components which can be replaced by user supplied classes,
+     * e.g., the linearizer.
+     */
+    template <class T>
+    void addKnobsFrom(T& obj)
+    { addKnobsFrom_(obj, 0); }
+
+    /*!
+     * \brief Returns true if some knobs still need to be tuned.
+     */
+    bool active() const
+    { return knobIdx_ < knobs_.size(); }
+
+    /*!
+     * \brief Apply the candidate which is timed by the next trial.
+     */
+    void beginTrial()
+    {
+        if (!active())
+            return;
+
+        knobs_[knobIdx_].apply(candidateIdx_);
+    }
+
+    /*!
+     * \brief Record the time of the trial which was started by the last call to
+     *        beginTrial().
+     *
+     * \return true if this trial concluded the tuning of a knob
+     */
+    bool endTrial(double seconds)
+    {
+        if (!active())
+            return false;
+
+        Knob& knob = knobs_[knobIdx_];
+        knob.times[candidateIdx_] = std::min(knob.times[candidateIdx_], seconds);
+
+        if (++candidateIdx_ < knob.labels.size())
+            return false;
+
+        candidateIdx_ = 0;
+        if (++roundIdx_ < trialsPerCandidate_)
+            return false;
+
+        knob.bestIdx = static_cast<std::size_t>(std::min_element(knob.times.begin(), knob.times.end())
+                                                - knob.times.begin());
+        knob.apply(knob.bestIdx);
+        roundIdx_ = 0;
+        ++knobIdx_;
+        return true;
+    }
+
+    /*!
+     * \brief Print the times of the candidates of all knobs tuned so far and the
+     *        selected values.
+     */
+    void report(std::ostream& os) const
+    {
+        for (std::size_t knobIdx = 0; knobIdx < std::min(knobIdx_, knobs_.size()); ++knobIdx) {
+            const Knob& knob = knobs_[knobIdx];
+            os << "Auto-tuning of '" << knob.name << "': selected '"
+               << knob.labels[knob.bestIdx] << "' (was '" << knob.labels[knob.initialIdx] << "')\n";
+            for (std::size_t candIdx = 0; candIdx < knob.labels.size(); ++candIdx)
+                os << "    " << std::left << std::setw(16) << knob.labels[candIdx]
+                   << std::right << std::setw(12) << knob.times[candIdx] << " s\n";
+        }
+        os << std::flush;
+    }
+
+private:
+    template <class T>
+    auto addKnobsFrom_(T& obj, int) -> decltype(obj.registerTuningKnobs(std::declval<AutoTuner&>()))
+    { return obj.registerTuningKnobs(*this); }
+
+    template <class T>
+    void addKnobsFrom_(T&, long)
+    { }
+
+    struct Knob
+    {
+        std::string name;
+        std::vector<std::string> labels;
+        std::function<void(std::size_t)> apply;
+        std::vector<double> times;
+        std::size_t initialIdx;
+        std::size_t bestIdx;
+    };
+
+    std::vector<Knob> knobs_;
+    unsigned trialsPerCandidate_ = 1;
+    std::size_t knobIdx_ = 0;
+    std::size_t candidateIdx_ = 0;
+    unsigned roundIdx_ = 0;
+};
+
+} // namespace Opm
+
+#endif
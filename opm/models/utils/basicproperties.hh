@@ -140,10 +140,39 @@ struct InitialTimeStepSize { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct RestartTime { using type = UndefinedProperty; };
 
+//! The format of the restart files, i.e., "text", "binary" or "collective"
+template<class TypeTag, class MyTypeTag>
+struct RestartFormat { using type = UndefinedProperty; };
+
+//! Specify whether binary restart files are mapped into memory when they are read
+template<class TypeTag, class MyTypeTag>
+struct EnableRestartMmap { using type = UndefinedProperty; };
+
+//! Specify whether restart files are written to disk in the background
+template<class TypeTag, class MyTypeTag>
+struct EnableAsyncRestartOutput { using type = UndefinedProperty; };
+
 //! The name of the file with a number of forced time step lengths
 template<class TypeTag, class MyTypeTag>
 struct PredeterminedTimeStepsFile { using type = UndefinedProperty; };
 
+//! Specify whether the hardware performance counters of the phases of the simulation
+//! should be recorded
+template<class TypeTag, class MyTypeTag>
+struct EnableHardwareCounters { using type = UndefinedProperty; };
+
+//! Specify whether the memory held by the data structures of the simulation is printed
+template<class TypeTag, class MyTypeTag>
+struct PrintMemoryUsage { using type = UndefinedProperty; };
+
+//! The number of realisations which are simulated by the process
+template<class TypeTag, class MyTypeTag>
+struct EnsembleSize { using type = UndefinedProperty; };
+
+//! The maximum number of ensemble members which are simulated concurrently
+template<class TypeTag, class MyTypeTag>
+struct EnsembleThreads { using type = UndefinedProperty; };
+
 //! domain size
 template<class TypeTag, class MyTypeTag>
 struct DomainSizeX { using type = UndefinedProperty; };
@@ -254,6 +283,18 @@ struct EndTime<TypeTag, TTag::NumericModel>
     static constexpr type value = -1e35;
 };
 
+//! By default, the restart files are written as text
+template<class TypeTag>
+struct RestartFormat<TypeTag, TTag::NumericModel> { static constexpr auto value = "text"; };
+
+//! By default, binary restart files are mapped into memory
+template<class TypeTag>
+struct EnableRestartMmap<TypeTag, TTag::NumericModel> { static constexpr bool value = true; };
+
+//! By default, restart files are written synchronously
+template<class TypeTag>
+struct EnableAsyncRestartOutput<TypeTag, TTag::NumericModel> { static constexpr bool value = false; };
+
 //! The default value for the simulation's initial time step size
 template<class TypeTag>
 struct InitialTimeStepSize<TypeTag, TTag::NumericModel>
@@ -274,6 +315,22 @@ struct RestartTime<TypeTag, TTag::NumericModel>
 template<class TypeTag>
 struct PredeterminedTimeStepsFile<TypeTag, TTag::NumericModel> { static constexpr auto value = ""; };
 
+//! By default, the hardware performance counters are not recorded
+template<class TypeTag>
+struct EnableHardwareCounters<TypeTag, TTag::NumericModel> { static constexpr bool value = false; };
+
+//! By default, the memory usage is not printed
+template<class TypeTag>
+struct PrintMemoryUsage<TypeTag, TTag::NumericModel> { static constexpr bool value = false; };
+
+//! By default, a single realisation is simulated
+template<class TypeTag>
+struct EnsembleSize<TypeTag, TTag::NumericModel> { static constexpr int value = 1; };
+
+//! By default, the members of an ensemble are simulated one after the other
+template<class TypeTag>
+struct EnsembleThreads<TypeTag, TTag::NumericModel> { static constexpr int value = 1; };
+
 
 } // namespace Opm::Properties
 
@@ -0,0 +1,114 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Locality improving orderings of the cells of a grid.
+ */
+#ifndef EWOMS_CELL_ORDERING_HH
+#define EWOMS_CELL_ORDERING_HH
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Compute the reverse Cuthill-McKee ordering of a graph.
+ *
+ * The graph is given in compressed row format, i.e., the neighbors of node i are
+ * neighbors[rowOffsets[i]] ... neighbors[rowOffsets[i + 1] - 1]. Self connections are
+ * ignored. Each connected component of the graph is started at a node of minimum
+ * degree.
+ *
+ * \return The vector 'order' where order[k] is the index of the node which becomes
+ *         the k-th one in the new ordering.
+ */
+template <class Index>
+std::vector<Index> reverseCuthillMcKeeOrdering(const std::vector<std::size_t>& rowOffsets,
+                                               const std::vector<Index>& neighbors)
+{
+    assert(!rowOffsets.empty());
+    const std::size_t numNodes = rowOffsets.size() - 1;
+
+    const auto degree = [&rowOffsets](std::size_t nodeIdx)
+    { return rowOffsets[nodeIdx + 1] - rowOffsets[nodeIdx]; };
+
+    // the start candidates of the connected components: all nodes sorted by degree
+    std::vector<Index> byDegree(numNodes);
+    for (std::size_t nodeIdx = 0; nodeIdx < numNodes; ++nodeIdx)
+        byDegree[nodeIdx] = static_cast<Index>(nodeIdx);
+    std::stable_sort(byDegree.begin(), byDegree.end(),
+                     [&degree](Index a, Index b) { return degree(a) < degree(b); });
+
+    std::vector<Index> order;
+    order.reserve(numNodes);
+    std::vector<bool> visited(numNodes, false);
+    std::vector<Index> levelNeighbors;
+    for (Index startIdx : byDegree) {
+        if (visited[startIdx])
+            continue;
+
+        // breadth first search from the start node. the neighbors of each node are
+        // enqueued in the order of increasing degree.
+        std::size_t queuePos = order.size();
+        order.push_back(startIdx);
+        visited[startIdx] = true;
+        for (; queuePos < order.size(); ++queuePos) {
+            const Index nodeIdx = order[queuePos];
+            levelNeighbors.clear();
+            for (std::size_t k = rowOffsets[nodeIdx]; k < rowOffsets[nodeIdx + 1]; ++k) {
+                const Index nbIdx = neighbors[k];
+                if (!visited[nbIdx]) {
+                    visited[nbIdx] = true;
+                    levelNeighbors.push_back(nbIdx);
+                }
+            }
+            std::stable_sort(levelNeighbors.begin(), levelNeighbors.end(),
+                             [&degree](Index a, Index b) { return degree(a) < degree(b); });
+            order.insert(order.end(), levelNeighbors.begin(), levelNeighbors.end());
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+/*!
+ * \brief Given an ordering, i.e., a map from new to old indices, compute the inverse
+ *        permutation (i.e. the map from old to new indices).
+ */
+template <class Index>
+std::vector<Index> invertOrdering(const std::vector<Index>& order)
+{
+    std::vector<Index> inverse(order.size());
+    for (std::size_t newIdx = 0; newIdx < order.size(); ++newIdx)
+        inverse[order[newIdx]] = static_cast<Index>(newIdx);
+    return inverse;
+}
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,163 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::EnsembleRunner
+ */
+#ifndef EWOMS_ENSEMBLE_RUNNER_HH
+#define EWOMS_ENSEMBLE_RUNNER_HH
+
+#include <opm/models/utils/basicproperties.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+#include <opm/models/utils/simulator.hh>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Simulates an ensemble of realisations of a problem within a single run.
+ *
+ * Each member of the ensemble is a complete Simulator object which is told its index
+ * within the ensemble, see Simulator::ensembleMemberIdx(). The problem is expected to
+ * use this index to select the properties of the realisation, and writes its output
+ * to a separate subdirectory of the output directory.
+ *
+ * The members are set up one after the other by the calling thread, so that the
+ * static data of the process, most notably the tables of the fluid system, is only
+ * initialized by a single thread at any time and subsequently shared by all members.
+ * Up to EnsembleThreads members are then advanced concurrently, each one in its own
+ * thread. Since the members are distributed over all processes of the communicator,
+ * they are run one after the other if more than one process is used.
+ */
+template <class TypeTag>
+class EnsembleRunner
+{
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using MPIComm = typename Dune::MPIHelper::MPICommunicator;
+    using Communication = Dune::Communication<MPIComm>;
+
+public:
+    /*!
+     * \brief Registers all runtime parameters used by the ensemble runner.
+     */
+    static void registerParameters()
+    {
+        Parameters::registerParam<TypeTag, Properties::EnsembleSize>
+            ("The number of realisations which are simulated");
+        Parameters::registerParam<TypeTag, Properties::EnsembleThreads>
+            ("The maximum number of realisations which are simulated concurrently. "
+             "The number of threads used by each of them is specified by "
+             "ThreadsPerProcess");
+    }
+
+    /*!
+     * \brief Simulate all members of the ensemble.
+     */
+    static void run()
+    {
+        Communication comm;
+
+        const int ensembleSize = Parameters::get<TypeTag, Properties::EnsembleSize>();
+        if (ensembleSize < 1)
+            throw std::invalid_argument("The size of the ensemble must be positive, but it is "
+                                        + std::to_string(ensembleSize));
+
+        int numThreads = Parameters::get<TypeTag, Properties::EnsembleThreads>();
+        if (numThreads < 1)
+            throw std::invalid_argument("The number of ensemble threads must be positive, "
+                                        "but it is " + std::to_string(numThreads));
+
+        // concurrent members would need a thread-safe MPI library and disjoint
+        // communicators for their grids
+        if (comm.size() > 1)
+            numThreads = 1;
+        numThreads = std::min(numThreads, ensembleSize);
+
+        // only talk about the progress of the individual members if they do not
+        // interleave their messages
+        const bool verbose = numThreads == 1;
+
+        for (int batchBegin = 0; batchBegin < ensembleSize; batchBegin += numThreads) {
+            const int batchEnd = std::min(batchBegin + numThreads, ensembleSize);
+
+            std::vector<std::unique_ptr<Simulator>> members;
+            for (int memberIdx = batchBegin; memberIdx < batchEnd; ++memberIdx) {
+                if (comm.rank() == 0)
+                    std::cout << "Setting up ensemble member " << memberIdx
+                              << " of " << ensembleSize << "\n" << std::flush;
+                members.push_back(std::make_unique<Simulator>(comm,
+                                                              verbose,
+                                                              static_cast<unsigned>(memberIdx),
+                                                              static_cast<unsigned>(ensembleSize)));
+            }
+
+            if (members.size() == 1) {
+                members.front()->run();
+                continue;
+            }
+
+            std::vector<std::exception_ptr> errors(members.size());
+            std::vector<std::thread> threads;
+            threads.reserve(members.size());
+            for (std::size_t i = 0; i < members.size(); ++i) {
+                threads.emplace_back([&members, &errors, i]()
+                {
+                    try {
+                        members[i]->run();
+                    }
+                    catch (...) {
+                        errors[i] = std::current_exception();
+                    }
+                });
+            }
+
+            for (auto& thread : threads)
+                thread.join();
+
+            for (const auto& error : errors)
+                if (error)
+                    std::rethrow_exception(error);
+
+            if (comm.rank() == 0)
+                std::cout << "Ensemble members " << batchBegin << " to " << batchEnd - 1
+                          << " finished\n" << std::flush;
+        }
+    }
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,60 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Macros to compile the simulator for a type tag in a single compile unit.
+ *
+ * Since opm-models consists exclusively of templates, every compile unit which starts a
+ * simulation instantiates the complete simulator. If several compile units use the
+ * same type tag, e.g., a library which provides the simulator for a given problem and
+ * an application linking against it, one of them can explicitly instantiate the
+ * simulator using EWOMS_INSTANTIATE_SIMULATOR() while the others declare this
+ * instantiation using EWOMS_EXTERN_SIMULATOR(). The latter then only need to compile
+ * the code which is inlined.
+ *
+ * Both macros must be used at global scope after the type tag and all of its
+ * properties have been defined.
+ */
+#ifndef EWOMS_EXPLICIT_INSTANTIATION_HH
+#define EWOMS_EXPLICIT_INSTANTIATION_HH
+
+#include <opm/models/utils/simulator.hh>
+#include <opm/models/utils/start.hh>
+
+/*!
+ * \brief Declare that the simulator for a type tag is instantiated by another compile
+ *        unit.
+ */
+#define EWOMS_EXTERN_SIMULATOR(TYPE_TAG)                                \
+    extern template class ::Opm::Simulator<TYPE_TAG>;                  \
+    extern template int ::Opm::start<TYPE_TAG>(int, char**, bool)
+
+/*!
+ * \brief Explicitly instantiate the simulator for a type tag.
+ */
+#define EWOMS_INSTANTIATE_SIMULATOR(TYPE_TAG)                           \
+    template class ::Opm::Simulator<TYPE_TAG>;                          \
+    template int ::Opm::start<TYPE_TAG>(int, char**, bool)
+
+#endif
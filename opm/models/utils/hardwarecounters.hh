@@ -0,0 +1,298 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::HardwareCounters
+ */
+#ifndef EWOMS_HARDWARE_COUNTERS_HH
+#define EWOMS_HARDWARE_COUNTERS_HH
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Collects hardware performance counters for the phases of a simulation.
+ *
+ * The counters are read using the perf_event interface of Linux, i.e., no external
+ * library is required. On other systems, or if the kernel does not permit access to
+ * the counters (see /proc/sys/kernel/perf_event_paranoid), init() fails and all other
+ * methods do nothing.
+ *
+ * The counters are attached to each thread of the OpenMP thread pool when init() is
+ * called, and they are summed over these threads whenever they are read. A phase is
+ * measured by the lifetime of a Phase object, which must be created by the master
+ * thread outside of parallel regions. Nested phases are counted inclusively.
+ *
+ * Besides the raw counts, the report contains the instructions per cycle and the
+ * number of instructions per byte transferred from the memory, where the transferred
+ * bytes are estimated by the misses of the last level cache times the size of a
+ * cache line. This serves as a proxy for the arithmetic intensity, since the number
+ * of floating point operations is not available in a portable way.
+ */
+class HardwareCounters
+{
+public:
+    enum Event {
+        Instructions,
+        Cycles,
+        CacheReferences,
+        CacheMisses,
+        numEvents
+    };
+
+    using Counts = std::array<std::uint64_t, numEvents>;
+
+    //! The number of bytes which is assumed to be transferred per cache miss
+    static constexpr std::uint64_t cacheLineSize = 64;
+
+    /*!
+     * \brief Measures the counters for the lifetime of the object.
+     */
+    class Phase
+    {
+    public:
+        explicit Phase(const char* name)
+            : counters_(HardwareCounters::instance())
+            , name_(name)
+            , active_(counters_.active())
+        {
+            if (active_)
+                start_ = counters_.read();
+        }
+
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+
+        ~Phase()
+        {
+            if (!active_)
+                return;
+
+            const Counts stop = counters_.read();
+            Counts delta;
+            for (int eventIdx = 0; eventIdx < numEvents; ++eventIdx)
+                delta[eventIdx] = stop[eventIdx] - start_[eventIdx];
+            counters_.accumulate_(name_, delta);
+        }
+
+    private:
+        HardwareCounters& counters_;
+        const char* name_;
+        bool active_;
+        Counts start_;
+    };
+
+    /*!
+     * \brief Returns the counters of the process.
+     */
+    static HardwareCounters& instance()
+    {
+        static HardwareCounters counters;
+        return counters;
+    }
+
+    ~HardwareCounters()
+    { close_(); }
+
+    /*!
+     * \brief Attach the counters to all threads of the OpenMP thread pool.
+     *
+     * \return true if all counters could be opened.
+     */
+    bool init()
+    {
+        close_();
+
+#ifdef __linux__
+        std::size_t numThreads = 1;
+#ifdef _OPENMP
+        numThreads = static_cast<std::size_t>(omp_get_max_threads());
+#endif
+        fds_.assign(numThreads*numEvents, -1);
+
+        bool succeeded = true;
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads) reduction(&&:succeeded)
+#endif
+        {
+            std::size_t threadIdx = 0;
+#ifdef _OPENMP
+            threadIdx = static_cast<std::size_t>(omp_get_thread_num());
+#endif
+            for (int eventIdx = 0; eventIdx < numEvents; ++eventIdx) {
+                const int fd = open_(eventIdx);
+                fds_[threadIdx*numEvents + eventIdx] = fd;
+                succeeded = succeeded && fd >= 0;
+            }
+        }
+
+        if (!succeeded)
+            close_();
+        active_ = succeeded;
+#endif
+
+        return active_;
+    }
+
+    /*!
+     * \brief Returns true if the counters are measured.
+     */
+    bool active() const
+    { return active_; }
+
+    /*!
+     * \brief Returns the current values of the counters summed over all threads.
+     */
+    Counts read() const
+    {
+        Counts result{};
+#ifdef __linux__
+        for (std::size_t i = 0; i < fds_.size(); ++i) {
+            std::uint64_t value = 0;
+            if (::read(fds_[i], &value, sizeof(value)) == sizeof(value))
+                result[i % numEvents] += value;
+        }
+#endif
+        return result;
+    }
+
+    /*!
+     * \brief Print the counters of all phases.
+     */
+    void print(std::ostream& os) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        os << std::left << std::setw(24) << "phase"
+           << std::right << std::setw(10) << "calls"
+           << std::setw(16) << "instructions"
+           << std::setw(16) << "cycles"
+           << std::setw(8) << "IPC"
+           << std::setw(16) << "LLC refs"
+           << std::setw(16) << "LLC misses"
+           << std::setw(14) << "est. GB"
+           << std::setw(12) << "instr/byte" << "\n";
+        for (const auto& entry : phases_) {
+            const auto& counts = entry.second.counts;
+            const double bytes = static_cast<double>(counts[CacheMisses]*cacheLineSize);
+            const double instructions = static_cast<double>(counts[Instructions]);
+            const double cycles = static_cast<double>(counts[Cycles]);
+            os << std::left << std::setw(24) << entry.first
+               << std::right << std::setw(10) << entry.second.numCalls
+               << std::setw(16) << counts[Instructions]
+               << std::setw(16) << counts[Cycles]
+               << std::setw(8) << std::setprecision(3) << (cycles > 0 ? instructions/cycles : 0.0)
+               << std::setw(16) << counts[CacheReferences]
+               << std::setw(16) << counts[CacheMisses]
+               << std::setw(14) << std::setprecision(4) << bytes*1e-9
+               << std::setw(12) << std::setprecision(4) << (bytes > 0 ? instructions/bytes : 0.0)
+               << "\n";
+        }
+        os << std::flush;
+    }
+
+private:
+    struct PhaseData
+    {
+        std::uint64_t numCalls = 0;
+        Counts counts{};
+    };
+
+    HardwareCounters() = default;
+
+    void accumulate_(const char* name, const Counts& delta)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& phase = phases_[name];
+        ++phase.numCalls;
+        for (int eventIdx = 0; eventIdx < numEvents; ++eventIdx)
+            phase.counts[eventIdx] += delta[eventIdx];
+    }
+
+#ifdef __linux__
+    // open a counter for the calling thread
+    static int open_(int eventIdx)
+    {
+        static const std::uint64_t configs[numEvents] = {
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_CACHE_REFERENCES,
+            PERF_COUNT_HW_CACHE_MISSES
+        };
+
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[eventIdx];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr,
+                                        /*pid=*/0, /*cpu=*/-1, /*groupFd=*/-1, /*flags=*/0));
+    }
+#endif
+
+    void close_()
+    {
+#ifdef __linux__
+        for (int fd : fds_)
+            if (fd >= 0)
+                ::close(fd);
+#endif
+        fds_.clear();
+        active_ = false;
+    }
+
+    std::vector<int> fds_;
+    bool active_ = false;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, PhaseData> phases_;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,203 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::MemoryUsage
+ */
+#ifndef EWOMS_MEMORY_USAGE_HH
+#define EWOMS_MEMORY_USAGE_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Records the number of bytes held by the data structures of a simulation.
+ *
+ * The components of the simulation add an entry for each of their large data
+ * structures using their reportMemoryUsage() methods. The amounts are only estimates:
+ * the capacity of the containers is taken into account, but memory which is owned by
+ * the stored objects themselves and the overhead of the memory allocator is not.
+ */
+class MemoryUsage
+{
+public:
+    /*!
+     * \brief Add the number of bytes held by a data structure.
+     *
+     * If an entry with the same name exists already, the amount is added to it.
+     */
+    void add(const std::string& name, std::size_t numBytes)
+    {
+        for (auto& entry : entries_) {
+            if (entry.first == name) {
+                entry.second += numBytes;
+                return;
+            }
+        }
+        entries_.emplace_back(name, numBytes);
+    }
+
+    /*!
+     * \brief Returns the recorded entries in the order in which they were added.
+     */
+    const std::vector<std::pair<std::string, std::size_t>>& entries() const
+    { return entries_; }
+
+    /*!
+     * \brief Returns the total number of bytes of all entries.
+     */
+    std::size_t totalBytes() const
+    {
+        std::size_t result = 0;
+        for (const auto& entry : entries_)
+            result += entry.second;
+        return result;
+    }
+
+    /*!
+     * \brief Returns the number of bytes allocated by a std::vector.
+     */
+    template <class T, class Allocator>
+    static std::size_t bytesOf(const std::vector<T, Allocator>& v)
+    { return v.capacity()*sizeof(T); }
+
+    /*!
+     * \brief Returns the number of bytes allocated by a Dune::BlockVector.
+     */
+    template <class BlockVector>
+    static auto blockVectorBytes(const BlockVector& v)
+        -> decltype(v.N(), std::size_t())
+    { return v.N()*sizeof(typename BlockVector::block_type); }
+
+    /*!
+     * \brief Returns the number of bytes allocated by a Dune::BCRSMatrix.
+     *
+     * This accounts for the blocks, the column indices and the row descriptors.
+     */
+    template <class Matrix>
+    static std::size_t bcrsMatrixBytes(const Matrix& m)
+    {
+        return m.nonzeroes()*(sizeof(typename Matrix::block_type) + sizeof(typename Matrix::size_type))
+            + (m.N() + 1)*sizeof(typename Matrix::row_type);
+    }
+
+    /*!
+     * \brief Call obj.reportMemoryUsage(*this) if the object provides this method.
+     *
+     * This allows to account for components which can be replaced by user supplied
+     * classes, e.g., the linear solver.
+     */
+    template <class T>
+    void addFrom(const T& obj)
+    { addFrom_(obj, 0); }
+
+    /*!
+     * \brief Print the entries to an output stream.
+     *
+     * If a communicator is specified, the minimum, maximum and the sum of each entry
+     * over all processes is printed by the first process. Since this is a collective
+     * operation, all processes must have added the same entries in the same order.
+     */
+    template <class Communication>
+    void print(std::ostream& os, const Communication& comm) const
+    {
+        std::vector<double> minBytes;
+        std::vector<double> maxBytes;
+        std::vector<double> sumBytes;
+        for (const auto& entry : entries_)
+            minBytes.push_back(static_cast<double>(entry.second));
+        minBytes.push_back(static_cast<double>(totalBytes()));
+        maxBytes = minBytes;
+        sumBytes = minBytes;
+
+        comm.min(minBytes.data(), static_cast<int>(minBytes.size()));
+        comm.max(maxBytes.data(), static_cast<int>(maxBytes.size()));
+        comm.sum(sumBytes.data(), static_cast<int>(sumBytes.size()));
+
+        if (comm.rank() != 0)
+            return;
+
+        const auto mib = [](double numBytes)
+        { return numBytes/(1024.0*1024.0); };
+
+        std::size_t nameWidth = 5;
+        for (const auto& entry : entries_)
+            nameWidth = std::max(nameWidth, entry.first.size());
+
+        const auto oldFlags = os.flags();
+        const auto oldPrecision = os.precision();
+        os << std::fixed << std::setprecision(1)
+           << "Memory usage [MiB]";
+        if (comm.size() > 1)
+            os << " over " << comm.size() << " processes";
+        os << ":\n"
+           << "    " << std::left << std::setw(nameWidth) << "" << std::right;
+        if (comm.size() > 1)
+            os << std::setw(12) << "min" << std::setw(12) << "max" << std::setw(12) << "sum";
+        else
+            os << std::setw(12) << "size";
+        os << "\n";
+
+        for (std::size_t i = 0; i <= entries_.size(); ++i) {
+            const std::string& name = (i < entries_.size()) ? entries_[i].first : "Total";
+            os << "    " << std::left << std::setw(nameWidth) << name << std::right;
+            if (comm.size() > 1)
+                os << std::setw(12) << mib(minBytes[i])
+                   << std::setw(12) << mib(maxBytes[i])
+                   << std::setw(12) << mib(sumBytes[i]);
+            else
+                os << std::setw(12) << mib(sumBytes[i]);
+            os << "\n";
+        }
+        os << std::flush;
+
+        os.flags(oldFlags);
+        os.precision(oldPrecision);
+    }
+
+private:
+    template <class T>
+    auto addFrom_(const T& obj, int) -> decltype(obj.reportMemoryUsage(std::declval<MemoryUsage&>()))
+    { return obj.reportMemoryUsage(*this); }
+
+    template <class T>
+    void addFrom_(const T&, long)
+    { }
+
+    std::vector<std::pair<std::string, std::size_t>> entries_;
+};
+
+} // namespace Opm
+
+#endif
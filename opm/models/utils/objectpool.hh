@@ -0,0 +1,139 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::ObjectPool
+ */
+#ifndef EWOMS_OBJECT_POOL_HH
+#define EWOMS_OBJECT_POOL_HH
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief A per-thread pool of objects which are expensive to allocate, e.g., the
+ *        temporary vectors of the linear solvers.
+ *
+ * An object is acquired by specifying a prototype: a pooled object of the same size is
+ * assigned from the prototype, which does not require any allocations, and only if no
+ * such object is available a new one is copy constructed. The objects are returned to
+ * the pool when the handle goes out of scope, at most maxPooled objects are retained.
+ *
+ * The Object type must provide a copy constructor, a copy assignment operator and a
+ * size() method. Handles must be released by the thread which acquired them.
+ */
+template <class Object, std::size_t maxPooled = 16>
+class ObjectPool
+{
+public:
+    /*!
+     * \brief Provides access to an object taken from the pool and gives it back to
+     *        the pool on destruction.
+     */
+    class Handle
+    {
+    public:
+        Handle(ObjectPool& pool, std::unique_ptr<Object> obj)
+            : pool_(&pool)
+            , obj_(std::move(obj))
+        {}
+
+        Handle(Handle&& other) noexcept = default;
+        Handle& operator=(Handle&& other) = delete;
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+
+        ~Handle()
+        {
+            if (obj_)
+                pool_->release_(std::move(obj_));
+        }
+
+        Object& operator*() const
+        { return *obj_; }
+
+        Object* operator->() const
+        { return obj_.get(); }
+
+    private:
+        ObjectPool* pool_;
+        std::unique_ptr<Object> obj_;
+    };
+
+    /*!
+     * \brief Returns the pool of the calling thread.
+     */
+    static ObjectPool& threadLocal()
+    {
+        thread_local ObjectPool pool;
+        return pool;
+    }
+
+    /*!
+     * \brief Take an object from the pool which is a copy of a prototype.
+     */
+    Handle acquire(const Object& prototype)
+    {
+        for (std::size_t i = 0; i < free_.size(); ++i) {
+            if (free_[i]->size() != prototype.size())
+                continue;
+
+            std::unique_ptr<Object> obj = std::move(free_[i]);
+            free_[i] = std::move(free_.back());
+            free_.pop_back();
+            *obj = prototype;
+            return Handle(*this, std::move(obj));
+        }
+
+        return Handle(*this, std::make_unique<Object>(prototype));
+    }
+
+    /*!
+     * \brief Returns the number of objects which are currently not in use.
+     */
+    std::size_t numPooled() const
+    { return free_.size(); }
+
+    /*!
+     * \brief Free all objects which are currently not in use.
+     */
+    void clear()
+    { free_.clear(); }
+
+private:
+    void release_(std::unique_ptr<Object> obj)
+    {
+        if (free_.size() < maxPooled)
+            free_.push_back(std::move(obj));
+    }
+
+    std::vector<std::unique_ptr<Object>> free_;
+};
+
+} // namespace Opm
+
+#endif
@@ -41,10 +41,12 @@
 #include <dune/common/classname.hh>
 #include <dune/common/parametertree.hh>
 
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <list>
 #include <map>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <stdexcept>
@@ -153,12 +155,21 @@ struct ParameterMetaData<TypeTag, TTag::ParameterSystem>
     static bool& registrationOpen()
     { return storage_().registrationOpen; }
 
+    // incremented whenever the values of the parameters may have changed. this is
+    // used to invalidate the values cached by Parameters::getCached().
+    static unsigned generation()
+    { return storage_().generation.load(std::memory_order_acquire); }
+
+    static void invalidateCache()
+    { ++storage_().generation; }
+
     static void clear()
     {
         storage_().tree.reset(new Dune::ParameterTree());
         storage_().finalizers.clear();
         storage_().registrationOpen = true;
         storage_().registry.clear();
+        invalidateCache();
     }
 
 private:
@@ -177,6 +188,7 @@ private:
         std::map<std::string, ::Opm::Parameters::ParamInfo> registry;
         std::list<std::unique_ptr<::Opm::Parameters::ParamRegFinalizerBase_> > finalizers;
         bool registrationOpen;
+        std::atomic<unsigned> generation{1};
     };
     static Storage_& storage_() {
         static Storage_ obj;
@@ -573,6 +585,7 @@ std::string parseCommandLineOptions(int argc,
                                     const std::string& helpPreamble = "",
                                     const PositionalArgumentCallback& posArgCallback = noPositionalParameters_)
 {
+    GetProp<TypeTag, Properties::ParameterMetaData>::invalidateCache();
     Dune::ParameterTree& paramTree = GetProp<TypeTag, Properties::ParameterMetaData>::tree();
 
     // handle the "--help" parameter
@@ -678,6 +691,7 @@ std::string parseCommandLineOptions(int argc,
 template <class TypeTag>
 void parseParameterFile(const std::string& fileName, bool overwrite = true)
 {
+    GetProp<TypeTag, Properties::ParameterMetaData>::invalidateCache();
     Dune::ParameterTree& paramTree = GetProp<TypeTag, Properties::ParameterMetaData>::tree();
 
     std::set<std::string> seenKeys;
@@ -860,6 +874,50 @@ auto get(bool errorIfNotRegistered)
     return ParamsMeta::tree().template get<ParamType>(paramName, defaultValue);
 }
 
+/*!
+ * \brief Retrieve the value of a parameter and cache it for subsequent calls.
+ *
+ * This is equivalent to get(), but only the first call looks the parameter up and
+ * parses its value, later calls return a reference to the cached value. Thus it is
+ * suitable for code which is executed very often, e.g., for each degree of freedom.
+ * The cache is invalidated when the parameters are reset or read from the command
+ * line or a parameter file; code which modifies the parameter tree directly must call
+ * invalidateCache() afterwards.
+ *
+ * This method may be called by multiple threads concurrently.
+ */
+template <class TypeTag, template<class,class> class Param>
+const auto& getCached()
+{
+    using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
+    using ParamType = std::decay_t<decltype(get<TypeTag, Param>())>;
+
+    static std::atomic<unsigned> cachedGeneration{0};
+    static ParamType cachedValue{};
+    static std::mutex mutex;
+
+    const unsigned generation = ParamsMeta::generation();
+    if (cachedGeneration.load(std::memory_order_acquire) != generation) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cachedGeneration.load(std::memory_order_relaxed) != generation) {
+            cachedValue = get<TypeTag, Param>();
+            cachedGeneration.store(generation, std::memory_order_release);
+        }
+    }
+
+    return cachedValue;
+}
+
+/*!
+ * \brief Invalidate the parameter values cached by getCached().
+ */
+template <class TypeTag>
+void invalidateCache()
+{
+    using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
+    ParamsMeta::invalidateCache();
+}
+
 /*!
  * \brief Retrieves the lists of parameters specified at runtime and their values.
  *
@@ -1021,6 +1079,7 @@ void endParamRegistration()
                                "to close it once.");
 
     ParamsMeta::registrationOpen() = false;
+    ParamsMeta::invalidateCache();
 
     // loop over all parameters and retrieve their values to make sure
     // that there is no syntax error
@@ -27,11 +27,14 @@
 #ifndef EWOMS_PFF_GRID_VECTOR_HH
 #define EWOMS_PFF_GRID_VECTOR_HH
 
+#include <opm/models/parallel/threadedentityiterator.hh>
 #include <opm/models/utils/prefetch.hh>
 
 #include <dune/grid/common/mcmgmapper.hh>
 #include <dune/common/version.hh>
 
+#include <cstddef>
+#include <stdexcept>
 #include <vector>
 
 namespace Opm {
@@ -58,35 +61,77 @@ public:
         , dofMapper_(dofMapper)
     { }
 
+    /*!
+     * \brief Recompute the data of all degrees of freedom of the grid.
+     *
+     * The stencils of the elements are processed by all threads concurrently, i.e.,
+     * distFn must be safe to be called in parallel for different elements.
+     */
     template <class DistFn>
     void update(const DistFn& distFn)
     {
-        unsigned numElements = gridView_.size(/*codim=*/0);
-        unsigned numLocalDofs = computeNumLocalDofs_();
-
+        std::size_t numElements = gridView_.size(/*codim=*/0);
         elemData_.resize(numElements);
+        numElemDofs_.resize(numElements);
+
+        // first pass: determine the number of DOFs of each element. this only requires
+        // the topology of the stencils.
+        using ElementIterator = typename GridView::template Codim<0>::Iterator;
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedCountIt(gridView_);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Stencil stencil(gridView_, dofMapper_);
+            ElementIterator elemIt = threadedCountIt.beginParallel();
+            for (; !threadedCountIt.isFinished(elemIt); elemIt = threadedCountIt.increment()) {
+                const Element& elem = *elemIt;
+                stencil.updateTopology(elem);
+                numElemDofs_[elementMapper_.index(elem)] = stencil.numDof();
+            }
+        }
+
+        // the data of the element's DOFs is stored consecutively in the order of the
+        // element indices, so the offsets are the prefix sum of the number of DOFs
+        std::size_t numLocalDofs = 0;
+        for (std::size_t elemIdx = 0; elemIdx < numElements; ++elemIdx)
+            numLocalDofs += numElemDofs_[elemIdx];
         data_.resize(numLocalDofs);
 
-        // update the pointers for the element data: for this, we need to loop over the
-        // whole grid and update a stencil for each element
-        Data *curElemDataPtr = &data_[0];
-        Stencil stencil(gridView_, dofMapper_);
-        for (const auto& elem : elements(gridView_)) {
-            // set the DOF data pointer for the current element
-            unsigned elemIdx = elementMapper_.index(elem);
+        Data* curElemDataPtr = data_.data();
+        for (std::size_t elemIdx = 0; elemIdx < numElements; ++elemIdx) {
             elemData_[elemIdx] = curElemDataPtr;
+            curElemDataPtr += numElemDofs_[elemIdx];
+        }
 
-            stencil.update(elem);
-            unsigned numDof = stencil.numDof();
-            for (unsigned localDofIdx = 0; localDofIdx < numDof; ++ localDofIdx)
-                distFn(curElemDataPtr[localDofIdx], stencil, localDofIdx);
-
-            // update the element data pointer to make it point to the beginning of the
-            // data for DOFs of the next element
-            curElemDataPtr += numDof;
+        // second pass: fill the data of each DOF
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Stencil stencil(gridView_, dofMapper_);
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment())
+                updateElement_(stencil, *elemIt, distFn);
         }
     }
 
+    /*!
+     * \brief Recompute the data of the degrees of freedom of a subset of the elements.
+     *
+     * update() must have been called before and the number of DOFs of the stencils of
+     * the given elements must not have changed since then. This method is not thread
+     * parallel, distFn is always called sequentially.
+     */
+    template <class ElementRange, class DistFn>
+    void updateElements(const ElementRange& elems, const DistFn& distFn)
+    {
+        Stencil stencil(gridView_, dofMapper_);
+        for (const auto& elem : elems)
+            updateElement_(stencil, elem, distFn);
+    }
+
     void prefetch(const Element& elem) const
     {
         unsigned elemIdx = elementMapper_.index(elem);
@@ -103,18 +148,20 @@ public:
     }
 
 private:
-    unsigned computeNumLocalDofs_() const
+    template <class DistFn>
+    void updateElement_(Stencil& stencil, const Element& elem, const DistFn& distFn)
     {
-        unsigned result = 0;
+        unsigned elemIdx = elementMapper_.index(elem);
+        stencil.update(elem);
 
-        // loop over the whole grid and sum up the number of local DOFs of all Stencils
-        Stencil stencil(gridView_, dofMapper_);
-        for (const auto& elem : elements(gridView_)) {
-            stencil.update(elem);
-            result += stencil.numDof();
-        }
+        unsigned numDof = stencil.numDof();
+        if (numDof != numElemDofs_[elemIdx])
+            throw std::logic_error("The number of degrees of freedom of an element changed "
+                                   "without updating the whole PffGridVector");
 
-        return result;
+        Data* elemDataPtr = elemData_[elemIdx];
+        for (unsigned localDofIdx = 0; localDofIdx < numDof; ++ localDofIdx)
+            distFn(elemDataPtr[localDofIdx], stencil, localDofIdx);
     }
 
     GridView gridView_;
@@ -122,6 +169,7 @@ private:
     const DofMapper& dofMapper_;
     std::vector<Data> data_;
     std::vector<Data*> elemData_;
+    std::vector<unsigned> numElemDofs_;
 };
 
 } // namespace Opm
@@ -0,0 +1,110 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::PidTimeStepController
+ */
+#ifndef EWOMS_PID_TIME_STEP_CONTROLLER_HH
+#define EWOMS_PID_TIME_STEP_CONTROLLER_HH
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace Opm {
+
+/*!
+ * \brief Chooses the size of the next time step based on the change of the solution
+ *        within the last time steps.
+ *
+ * The relative change \f$ e_n \f$ of the solution of the time step n is controlled
+ * towards a given tolerance by a PID controller:
+ *
+ * \f[ \Delta t_{n+1} = \Delta t_n
+ *     \left(\frac{e_{n-1}}{e_n}\right)^{k_P}
+ *     \left(\frac{tol}{e_n}\right)^{k_I}
+ *     \left(\frac{e_{n-1}^2}{e_n e_{n-2}}\right)^{k_D} \f]
+ *
+ * using the coefficients proposed by Valli et al. As long as there are not enough
+ * previous time steps, only the integral term is used. Compared to a control of the
+ * number of Newton iterations, this reacts to the dynamics of the solution before the
+ * Newton method starts to fail.
+ */
+template <class Scalar>
+class PidTimeStepController
+{
+public:
+    /*!
+     * \param tolerance The targeted relative change of the solution per time step
+     * \param maxGrowth The maximum factor by which a time step may be larger than the
+     *                  previous one
+     */
+    explicit PidTimeStepController(Scalar tolerance = 0.1, Scalar maxGrowth = 3.0)
+        : tolerance_(tolerance)
+        , maxGrowth_(maxGrowth)
+    {}
+
+    /*!
+     * \brief Forget the history of the controller, e.g., at the start of an episode.
+     */
+    void reset()
+    { numErrors_ = 0; }
+
+    /*!
+     * \brief Returns the size of the next time step.
+     *
+     * \param dt The size of the time step which was just completed
+     * \param relativeChange The relative change of the solution during this time step
+     */
+    Scalar suggestTimeStepSize(Scalar dt, Scalar relativeChange)
+    {
+        constexpr Scalar kP = 0.075;
+        constexpr Scalar kI = 0.175;
+        constexpr Scalar kD = 0.01;
+        constexpr Scalar minChange = 1e-10;
+
+        errors_[2] = errors_[1];
+        errors_[1] = errors_[0];
+        errors_[0] = std::max(relativeChange, minChange);
+        numErrors_ = std::min(numErrors_ + 1, 3);
+
+        Scalar factor = std::pow(tolerance_/errors_[0], kI);
+        if (numErrors_ >= 3) {
+            factor *= std::pow(errors_[1]/errors_[0], kP)
+                * std::pow(errors_[1]*errors_[1]/(errors_[0]*errors_[2]), kD);
+        }
+
+        return dt*std::clamp(factor, Scalar{1.0}/maxGrowth_, maxGrowth_);
+    }
+
+private:
+    Scalar tolerance_;
+    Scalar maxGrowth_;
+    std::array<Scalar, 3> errors_{};
+    int numErrors_ = 0;
+};
+
+} // namespace Opm
+
+#endif
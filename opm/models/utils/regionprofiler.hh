@@ -0,0 +1,282 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief A hierarchical profiler for nested code regions.
+ *
+ * Regions are marked using the EWOMS_PROFILE_REGION() macro. The profiler is only
+ * compiled in if the EWOMS_ENABLE_REGION_PROFILER preprocessor symbol is defined to a
+ * non-zero value; otherwise, the macro expands to nothing.
+ */
+#ifndef EWOMS_REGION_PROFILER_HH
+#define EWOMS_REGION_PROFILER_HH
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifndef EWOMS_ENABLE_REGION_PROFILER
+#define EWOMS_ENABLE_REGION_PROFILER 0
+#endif
+
+namespace Opm {
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Collects the call counts and the inclusive and exclusive wall clock times of
+ *        nested code regions.
+ *
+ * Each thread records into its own tree of regions, so entering and leaving a region
+ * only requires two reads of the steady clock and no synchronization. The trees of
+ * all threads are merged by the region names when the report is printed. Two regions
+ * are considered to be the same if they have the same name and the same chain of
+ * parent regions. Since the nesting is tracked per thread, regions which are entered
+ * by the worker threads of a parallel loop show up at the top level of the report.
+ */
+class RegionProfiler
+{
+    struct Node
+    {
+        const char* name;
+        std::uint64_t numCalls;
+        std::int64_t inclusiveNs;
+        std::vector<std::size_t> children;
+    };
+
+    struct ThreadData
+    {
+        ThreadData()
+            : nodes(1, Node{"total", 0, 0, {}})
+            , current(0)
+        {}
+
+        std::vector<Node> nodes;
+        std::size_t current;
+    };
+
+    // the merged tree of all threads
+    struct MergedNode
+    {
+        const char* name;
+        std::uint64_t numCalls;
+        std::int64_t inclusiveNs;
+        int numThreads;
+        std::vector<MergedNode> children;
+    };
+
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /*!
+     * \brief Represents a region for the lifetime of the object.
+     */
+    class ScopedRegion
+    {
+    public:
+        explicit ScopedRegion(const char* name)
+            : threadData_(RegionProfiler::instance().threadData_())
+            , parent_(threadData_.current)
+        {
+            threadData_.current = RegionProfiler::child_(threadData_, parent_, name);
+            startTime_ = Clock::now();
+        }
+
+        ScopedRegion(const ScopedRegion&) = delete;
+        ScopedRegion& operator=(const ScopedRegion&) = delete;
+
+        ~ScopedRegion()
+        {
+            const auto dt = Clock::now() - startTime_;
+            Node& node = threadData_.nodes[threadData_.current];
+            ++node.numCalls;
+            node.inclusiveNs += std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count();
+            threadData_.current = parent_;
+        }
+
+    private:
+        ThreadData& threadData_;
+        std::size_t parent_;
+        Clock::time_point startTime_;
+    };
+
+    /*!
+     * \brief Returns the profiler of the process.
+     */
+    static RegionProfiler& instance()
+    {
+        static RegionProfiler profiler;
+        return profiler;
+    }
+
+    /*!
+     * \brief Returns true if the profiler has been compiled in.
+     */
+    static constexpr bool enabled()
+    { return EWOMS_ENABLE_REGION_PROFILER != 0; }
+
+    /*!
+     * \brief Discard all measurements.
+     *
+     * This must not be called while any region is active.
+     */
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& threadData : threads_)
+            *threadData = ThreadData();
+    }
+
+    /*!
+     * \brief Print the merged measurements of all threads.
+     *
+     * For each region, the number of calls, the inclusive and exclusive times and the
+     * number of threads which entered it are printed. The times of regions which are
+     * entered by several threads are summed over the threads. This must not be called
+     * while any region is active.
+     */
+    void print(std::ostream& os) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        MergedNode root{"total", 0, 0, 0, {}};
+        for (const auto& threadData : threads_) {
+            const auto& nodes = threadData->nodes;
+            for (std::size_t childIdx : nodes[0].children)
+                merge_(root, nodes, childIdx);
+        }
+        for (const auto& child : root.children)
+            root.inclusiveNs += child.inclusiveNs;
+
+        os << std::left << std::setw(40) << "region"
+           << std::right << std::setw(12) << "calls"
+           << std::setw(14) << "incl. [s]"
+           << std::setw(14) << "excl. [s]"
+           << std::setw(9) << "incl. %"
+           << std::setw(9) << "threads" << "\n";
+        for (const auto& child : root.children)
+            print_(os, child, root.inclusiveNs, /*depth=*/0);
+        os << std::flush;
+    }
+
+private:
+    RegionProfiler() = default;
+
+    ThreadData& threadData_()
+    {
+        thread_local ThreadData* threadData = nullptr;
+        if (!threadData) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            threads_.push_back(std::make_unique<ThreadData>());
+            threadData = threads_.back().get();
+        }
+        return *threadData;
+    }
+
+    // return the index of the child of a node with a given name, create it if necessary
+    static std::size_t child_(ThreadData& threadData, std::size_t parentIdx, const char* name)
+    {
+        for (std::size_t childIdx : threadData.nodes[parentIdx].children) {
+            const char* childName = threadData.nodes[childIdx].name;
+            if (childName == name || std::strcmp(childName, name) == 0)
+                return childIdx;
+        }
+
+        threadData.nodes.push_back(Node{name, 0, 0, {}});
+        const std::size_t childIdx = threadData.nodes.size() - 1;
+        threadData.nodes[parentIdx].children.push_back(childIdx);
+        return childIdx;
+    }
+
+    static void merge_(MergedNode& parent, const std::vector<Node>& nodes, std::size_t nodeIdx)
+    {
+        const Node& node = nodes[nodeIdx];
+        MergedNode* target = nullptr;
+        for (auto& child : parent.children) {
+            if (std::strcmp(child.name, node.name) == 0) {
+                target = &child;
+                break;
+            }
+        }
+        if (!target) {
+            parent.children.push_back(MergedNode{node.name, 0, 0, 0, {}});
+            target = &parent.children.back();
+        }
+
+        target->numCalls += node.numCalls;
+        target->inclusiveNs += node.inclusiveNs;
+        ++target->numThreads;
+        for (std::size_t childIdx : node.children)
+            merge_(*target, nodes, childIdx);
+    }
+
+    static void print_(std::ostream& os, const MergedNode& node, std::int64_t totalNs, int depth)
+    {
+        std::int64_t childrenNs = 0;
+        for (const auto& child : node.children)
+            childrenNs += child.inclusiveNs;
+
+        const std::string label = std::string(2*depth, ' ') + node.name;
+        os << std::left << std::setw(40) << label
+           << std::right << std::setw(12) << node.numCalls
+           << std::setw(14) << std::fixed << std::setprecision(6) << node.inclusiveNs*1e-9
+           << std::setw(14) << (node.inclusiveNs - childrenNs)*1e-9
+           << std::setw(9) << std::setprecision(2)
+           << (totalNs > 0 ? 100.0*node.inclusiveNs/totalNs : 0.0)
+           << std::setw(9) << node.numThreads << "\n"
+           << std::defaultfloat;
+
+        for (const auto& child : node.children)
+            print_(os, child, totalNs, depth + 1);
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadData>> threads_;
+};
+
+} // namespace Opm
+
+#define EWOMS_PROFILE_CONCAT_IMPL_(a, b) a ## b
+#define EWOMS_PROFILE_CONCAT_(a, b) EWOMS_PROFILE_CONCAT_IMPL_(a, b)
+
+/*!
+ * \brief Profile the remainder of the enclosing scope as a region of the given name.
+ *
+ * The name must be a string literal or another string which outlives the profiler.
+ */
+#if EWOMS_ENABLE_REGION_PROFILER
+#define EWOMS_PROFILE_REGION(name)                                      \
+    ::Opm::RegionProfiler::ScopedRegion EWOMS_PROFILE_CONCAT_(ewomsProfileRegion_, __LINE__)(name)
+#else
+#define EWOMS_PROFILE_REGION(name) do { } while (false)
+#endif
+
+#endif
@@ -0,0 +1,197 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::ResampledTabulated1DFunction
+ */
+#ifndef EWOMS_RESAMPLED_TABULATED_1D_FUNCTION_HH
+#define EWOMS_RESAMPLED_TABULATED_1D_FUNCTION_HH
+
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/Tabulated1DFunction.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief A tabulated function which can optionally be resampled on a uniform grid.
+ *
+ * After resample() succeeded, the function is evaluated within the range of the
+ * table by computing the interval of the uniform grid directly instead of using a
+ * binary search. Outside of the range, and if resampling is disabled or failed, the
+ * evaluation is left to Tabulated1DFunction.
+ *
+ * The resampled function is the linear interpolation of the values of the original
+ * function at the nodes of the uniform grid. Since the difference of two piecewise
+ * linear functions attains its maximum at one of their sampling points and since the
+ * difference vanishes at the uniform nodes, checking the sampling points of the
+ * original function is sufficient to bound the error of the resampled one.
+ */
+template <class Scalar>
+class ResampledTabulated1DFunction : public Tabulated1DFunction<Scalar>
+{
+    using ParentType = Tabulated1DFunction<Scalar>;
+
+public:
+    using ParentType::ParentType;
+
+    ResampledTabulated1DFunction() = default;
+
+    ResampledTabulated1DFunction(const ParentType& other)
+        : ParentType(other)
+    {}
+
+    /*!
+     * \brief Set the sampling points of the function.
+     *
+     * This discards a previous resampling.
+     */
+    template <class... Args>
+    void setXYContainers(Args&&... args)
+    {
+        uniformValues_.clear();
+        ParentType::setXYContainers(std::forward<Args>(args)...);
+    }
+
+    /*!
+     * \brief Set the sampling points of the function.
+     *
+     * This discards a previous resampling.
+     */
+    template <class... Args>
+    void setXYArrays(Args&&... args)
+    {
+        uniformValues_.clear();
+        ParentType::setXYArrays(std::forward<Args>(args)...);
+    }
+
+    /*!
+     * \brief Resample the function on a uniform grid.
+     *
+     * The number of intervals is doubled, starting at the number of intervals of the
+     * table, until the maximum deviation from the table is below the tolerance times
+     * the maximum absolute value of the table. Returns false and keeps using the
+     * original table if this requires more than maxIntervals intervals.
+     */
+    bool resample(Scalar tolerance, std::size_t maxIntervals = 4096)
+    {
+        uniformValues_.clear();
+
+        const std::size_t numSamples = this->numSamples();
+        if (numSamples < 2 || tolerance <= 0.0)
+            return false;
+
+        Scalar valueScale = 0.0;
+        for (std::size_t sampleIdx = 0; sampleIdx < numSamples; ++sampleIdx)
+            valueScale = std::max(valueScale, std::abs(this->valueAt(sampleIdx)));
+        const Scalar maxError = tolerance*std::max<Scalar>(valueScale, 1e-30);
+
+        xMin_ = this->xMin();
+        const Scalar width = this->xMax() - xMin_;
+        if (!(width > 0.0))
+            return false;
+
+        std::vector<Scalar> values;
+        for (std::size_t numIntervals = numSamples - 1;
+             numIntervals <= maxIntervals;
+             numIntervals *= 2)
+        {
+            const Scalar dx = width/numIntervals;
+            values.resize(numIntervals + 1);
+            for (std::size_t nodeIdx = 0; nodeIdx < numIntervals; ++nodeIdx)
+                values[nodeIdx] = ParentType::eval(xMin_ + nodeIdx*dx, /*extrapolate=*/true);
+            values[numIntervals] = this->valueAt(numSamples - 1);
+
+            invDx_ = 1.0/dx;
+            numIntervals_ = numIntervals;
+            bool accurate = true;
+            for (std::size_t sampleIdx = 0; sampleIdx < numSamples && accurate; ++sampleIdx) {
+                const Scalar x = this->xAt(sampleIdx);
+                const Scalar error = std::abs(evalUniform_(values, x) - this->valueAt(sampleIdx));
+                accurate = error <= maxError;
+            }
+
+            if (accurate) {
+                uniformValues_ = std::move(values);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /*!
+     * \brief Returns true if the function is evaluated on a uniform grid.
+     */
+    bool isResampled() const
+    { return !uniformValues_.empty(); }
+
+    /*!
+     * \brief Evaluate the function at a given position.
+     *
+     * \copydetails Tabulated1DFunction::eval
+     */
+    template <class Evaluation>
+    Evaluation eval(const Evaluation& x, bool extrapolate = false) const
+    {
+        if (uniformValues_.empty())
+            return ParentType::eval(x, extrapolate);
+
+        const Scalar xValue = scalarValue(x);
+        const Scalar offset = (xValue - xMin_)*invDx_;
+        if (!(offset >= 0.0 && offset <= static_cast<Scalar>(numIntervals_)))
+            return ParentType::eval(x, extrapolate);
+
+        const std::size_t intervalIdx =
+            std::min(static_cast<std::size_t>(offset), numIntervals_ - 1);
+        const Scalar y0 = uniformValues_[intervalIdx];
+        const Scalar slope = (uniformValues_[intervalIdx + 1] - y0)*invDx_;
+        const Scalar x0 = xMin_ + intervalIdx/invDx_;
+        return y0 + slope*(x - x0);
+    }
+
+private:
+    Scalar evalUniform_(const std::vector<Scalar>& values, Scalar x) const
+    {
+        const Scalar offset = (x - xMin_)*invDx_;
+        const std::size_t intervalIdx =
+            std::min(static_cast<std::size_t>(std::max<Scalar>(offset, 0.0)), numIntervals_ - 1);
+        const Scalar alpha = offset - intervalIdx;
+        return values[intervalIdx] + alpha*(values[intervalIdx + 1] - values[intervalIdx]);
+    }
+
+    std::vector<Scalar> uniformValues_;
+    Scalar xMin_ = 0.0;
+    Scalar invDx_ = 0.0;
+    std::size_t numIntervals_ = 0;
+};
+
+} // namespace Opm
+
+#endif
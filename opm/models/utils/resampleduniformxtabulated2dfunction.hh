@@ -0,0 +1,250 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::ResampledUniformXTabulated2DFunction
+ */
+#ifndef EWOMS_RESAMPLED_UNIFORM_X_TABULATED_2D_FUNCTION_HH
+#define EWOMS_RESAMPLED_UNIFORM_X_TABULATED_2D_FUNCTION_HH
+
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/UniformXTabulated2DFunction.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief A two-dimensional tabulated function which can optionally be resampled on a
+ *        regular grid.
+ *
+ * UniformXTabulated2DFunction needs to search for the interval in the x direction
+ * and for the intervals of the two neighboring columns in the y direction for each
+ * evaluation. After resample() succeeded, the function is evaluated within the
+ * bounding box of the sampling points by bilinear interpolation on a regular grid,
+ * whose cell is computed directly. Outside of the bounding box, and if resampling is
+ * disabled or failed, the evaluation is left to UniformXTabulated2DFunction.
+ *
+ * The values at the nodes of the regular grid are computed by the original function
+ * using extrapolation. The resampling is accepted if the deviation from the original
+ * function at its sampling points and at the centers of the regular grid cells is
+ * below the tolerance.
+ */
+template <class Scalar>
+class ResampledUniformXTabulated2DFunction : public UniformXTabulated2DFunction<Scalar>
+{
+    using ParentType = UniformXTabulated2DFunction<Scalar>;
+
+public:
+    using ParentType::ParentType;
+
+    ResampledUniformXTabulated2DFunction(const ParentType& other)
+        : ParentType(other)
+    {}
+
+    /*!
+     * \brief Append a sampling position in the x direction.
+     *
+     * This discards a previous resampling.
+     */
+    template <class... Args>
+    auto appendXPos(Args&&... args)
+    {
+        uniformValues_.clear();
+        return ParentType::appendXPos(std::forward<Args>(args)...);
+    }
+
+    /*!
+     * \brief Append a sampling point to a column of the table.
+     *
+     * This discards a previous resampling.
+     */
+    template <class... Args>
+    auto appendSamplePoint(Args&&... args)
+    {
+        uniformValues_.clear();
+        return ParentType::appendSamplePoint(std::forward<Args>(args)...);
+    }
+
+    /*!
+     * \brief Resample the function on a regular grid.
+     *
+     * The number of intervals in each direction is doubled, starting at the number of
+     * intervals of the table, until the maximum deviation from the table is below the
+     * tolerance times the maximum absolute value of the table. Returns false and keeps
+     * using the original table if this requires more than maxIntervals intervals in
+     * one of the directions.
+     */
+    bool resample(Scalar tolerance, std::size_t maxIntervals = 256)
+    {
+        uniformValues_.clear();
+
+        const std::size_t numX = this->numX();
+        if (numX < 2 || tolerance <= 0.0)
+            return false;
+
+        Scalar valueScale = 0.0;
+        std::size_t maxNumY = 0;
+        xMin_ = this->xAt(0);
+        yMin_ = 0.0;
+        Scalar xMax = this->xAt(numX - 1);
+        Scalar yMax = 0.0;
+        for (std::size_t i = 0; i < numX; ++i) {
+            const std::size_t numY = this->numY(i);
+            if (numY < 2)
+                return false;
+
+            maxNumY = std::max(maxNumY, numY);
+            yMin_ = (i == 0) ? this->yAt(i, 0) : std::min(yMin_, this->yAt(i, 0));
+            yMax = (i == 0) ? this->yAt(i, numY - 1) : std::max(yMax, this->yAt(i, numY - 1));
+            for (std::size_t j = 0; j < numY; ++j)
+                valueScale = std::max(valueScale, std::abs(this->valueAt(i, j)));
+        }
+        const Scalar maxError = tolerance*std::max<Scalar>(valueScale, 1e-30);
+
+        const Scalar width = xMax - xMin_;
+        const Scalar height = yMax - yMin_;
+        if (!(width > 0.0) || !(height > 0.0))
+            return false;
+
+        std::vector<Scalar> values;
+        std::size_t numIntervalsX = numX - 1;
+        std::size_t numIntervalsY = maxNumY - 1;
+        for (; numIntervalsX <= maxIntervals && numIntervalsY <= maxIntervals;
+             numIntervalsX *= 2, numIntervalsY *= 2)
+        {
+            const Scalar dx = width/numIntervalsX;
+            const Scalar dy = height/numIntervalsY;
+            values.resize((numIntervalsX + 1)*(numIntervalsY + 1));
+            for (std::size_t nodeI = 0; nodeI <= numIntervalsX; ++nodeI) {
+                const Scalar x = (nodeI == numIntervalsX) ? xMax : xMin_ + nodeI*dx;
+                for (std::size_t nodeJ = 0; nodeJ <= numIntervalsY; ++nodeJ) {
+                    const Scalar y = (nodeJ == numIntervalsY) ? yMax : yMin_ + nodeJ*dy;
+                    values[nodeI*(numIntervalsY + 1) + nodeJ] =
+                        ParentType::eval(x, y, /*extrapolate=*/true);
+                }
+            }
+
+            invDx_ = 1.0/dx;
+            invDy_ = 1.0/dy;
+            numIntervalsX_ = numIntervalsX;
+            numIntervalsY_ = numIntervalsY;
+
+            const auto deviates = [&](Scalar x, Scalar y, Scalar value)
+            { return std::abs(evalUniform_(values, x, y) - value) > maxError; };
+
+            bool accurate = true;
+            for (std::size_t i = 0; i < numX && accurate; ++i)
+                for (std::size_t j = 0; j < this->numY(i) && accurate; ++j)
+                    accurate = !deviates(this->xAt(i), this->yAt(i, j), this->valueAt(i, j));
+
+            for (std::size_t cellI = 0; cellI < numIntervalsX && accurate; ++cellI) {
+                const Scalar x = xMin_ + (cellI + 0.5)*dx;
+                for (std::size_t cellJ = 0; cellJ < numIntervalsY && accurate; ++cellJ) {
+                    const Scalar y = yMin_ + (cellJ + 0.5)*dy;
+                    accurate = !deviates(x, y, ParentType::eval(x, y, /*extrapolate=*/true));
+                }
+            }
+
+            if (accurate) {
+                uniformValues_ = std::move(values);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /*!
+     * \brief Returns true if the function is evaluated on a regular grid.
+     */
+    bool isResampled() const
+    { return !uniformValues_.empty(); }
+
+    /*!
+     * \brief Evaluate the function at a given position.
+     *
+     * \copydetails UniformXTabulated2DFunction::eval
+     */
+    template <class Evaluation>
+    Evaluation eval(const Evaluation& x, const Evaluation& y, bool extrapolate = false) const
+    {
+        if (uniformValues_.empty())
+            return ParentType::eval(x, y, extrapolate);
+
+        const Scalar offsetX = (scalarValue(x) - xMin_)*invDx_;
+        const Scalar offsetY = (scalarValue(y) - yMin_)*invDy_;
+        if (!(offsetX >= 0.0 && offsetX <= static_cast<Scalar>(numIntervalsX_)) ||
+            !(offsetY >= 0.0 && offsetY <= static_cast<Scalar>(numIntervalsY_)))
+        {
+            return ParentType::eval(x, y, extrapolate);
+        }
+
+        const std::size_t cellI = std::min(static_cast<std::size_t>(offsetX), numIntervalsX_ - 1);
+        const std::size_t cellJ = std::min(static_cast<std::size_t>(offsetY), numIntervalsY_ - 1);
+        const Evaluation alpha = (x - xMin_)*invDx_ - static_cast<Scalar>(cellI);
+        const Evaluation beta = (y - yMin_)*invDy_ - static_cast<Scalar>(cellJ);
+
+        const std::size_t stride = numIntervalsY_ + 1;
+        const Scalar* v = uniformValues_.data() + cellI*stride + cellJ;
+        const Evaluation lower = v[0] + (v[1] - v[0])*beta;
+        const Evaluation upper = v[stride] + (v[stride + 1] - v[stride])*beta;
+        return lower + (upper - lower)*alpha;
+    }
+
+private:
+    Scalar evalUniform_(const std::vector<Scalar>& values, Scalar x, Scalar y) const
+    {
+        const Scalar offsetX = (x - xMin_)*invDx_;
+        const Scalar offsetY = (y - yMin_)*invDy_;
+        const std::size_t cellI =
+            std::min(static_cast<std::size_t>(std::max<Scalar>(offsetX, 0.0)), numIntervalsX_ - 1);
+        const std::size_t cellJ =
+            std::min(static_cast<std::size_t>(std::max<Scalar>(offsetY, 0.0)), numIntervalsY_ - 1);
+        const Scalar alpha = offsetX - cellI;
+        const Scalar beta = offsetY - cellJ;
+
+        const std::size_t stride = numIntervalsY_ + 1;
+        const Scalar* v = values.data() + cellI*stride + cellJ;
+        const Scalar lower = v[0] + (v[1] - v[0])*beta;
+        const Scalar upper = v[stride] + (v[stride + 1] - v[stride])*beta;
+        return lower + (upper - lower)*alpha;
+    }
+
+    std::vector<Scalar> uniformValues_;
+    Scalar xMin_ = 0.0;
+    Scalar yMin_ = 0.0;
+    Scalar invDx_ = 0.0;
+    Scalar invDy_ = 0.0;
+    std::size_t numIntervalsX_ = 0;
+    std::size_t numIntervalsY_ = 0;
+};
+
+} // namespace Opm
+
+#endif
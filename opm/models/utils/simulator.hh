@@ -33,19 +33,26 @@
 
 #include <opm/models/utils/basicproperties.hh>
 #include <opm/models/utils/propertysystem.hh>
+#include <opm/models/parallel/threadloadstatistics.hh>
+#include <opm/models/utils/hardwarecounters.hh>
+#include <opm/models/utils/memoryusage.hh>
+#include <opm/models/utils/regionprofiler.hh>
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
 #include <opm/models/parallel/mpiutil.hh>
+#include <opm/models/parallel/tasklets.hh>
 #include <opm/models/discretization/common/fvbaseproperties.hh>
 
 #include <dune/common/parallel/mpihelper.hh>
 
+#include <exception>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
 #include <vector>
 #include <string>
 #include <memory>
+#include <utility>
 
 namespace Opm
 {
@@ -109,6 +116,30 @@ class Simulator
     using MPIComm = typename Dune::MPIHelper::MPICommunicator;
     using Communication = Dune::Communication<MPIComm>;
 
+    // writes a restart file which has been staged in memory to disk
+    class WriteRestartTasklet : public TaskletInterface
+    {
+    public:
+        WriteRestartTasklet(std::shared_ptr<Restart> restart, std::exception_ptr& error)
+            : restart_(std::move(restart))
+            , error_(error)
+        { }
+
+        void run() final
+        {
+            try {
+                restart_->writeStaged();
+            }
+            catch (...) {
+                error_ = std::current_exception();
+            }
+        }
+
+    private:
+        std::shared_ptr<Restart> restart_;
+        std::exception_ptr& error_;
+    };
+
 public:
     // do not allow to copy simulators around
     Simulator(const Simulator& ) = delete;
@@ -118,12 +149,31 @@ public:
     {  
     }
 
-    Simulator(Communication comm, bool verbose = true)
+    /*!
+     * \brief Set up a simulation on a given communicator.
+     *
+     * \param comm The communicator of the processes which take part in the simulation
+     * \param verbose Print the progress of the simulation to the terminal
+     * \param ensembleMemberIdx The index of the simulation if it is a member of an ensemble
+     * \param ensembleSize The number of members of the ensemble, 1 for a single simulation
+     */
+    Simulator(Communication comm,
+              bool verbose = true,
+              unsigned ensembleMemberIdx = 0,
+              unsigned ensembleSize = 1)
+        : ensembleMemberIdx_(ensembleMemberIdx)
+        , ensembleSize_(ensembleSize)
     {
+        assert(ensembleMemberIdx_ < ensembleSize_);
+
         TimerGuard setupTimerGuard(setupTimer_);
 
         setupTimer_.start();
 
+        // measures the individual phases of the setup
+        Timer phaseTimer;
+        phaseTimer.start();
+
         verbose_ = verbose && comm.rank() == 0;
 
         timeStepIdx_ = 0;
@@ -149,6 +199,9 @@ public:
 
         finished_ = false;
 
+        if (Parameters::get<TypeTag, Properties::EnableAsyncRestartOutput>())
+            restartTaskletRunner_ = std::make_unique<TaskletRunner>(/*numWorkers=*/1);
+
         if (verbose_)
             std::cout << "Allocating the simulation vanguard\n" << std::flush;
 
@@ -186,6 +239,7 @@ public:
         }
         checkParallelException("Allocating the simulation vanguard failed: ",
                                exceptionThrown, what);
+        recordSetupPhase_("Vanguard", phaseTimer);
 
         if (verbose_)
             std::cout << "Distributing the vanguard's data\n" << std::flush;
@@ -197,6 +251,7 @@ public:
         }
         checkParallelException("Could not distribute the vanguard data: ",
                                exceptionThrown, what);
+        recordSetupPhase_("Load balancing", phaseTimer);
 
         if (verbose_)
             std::cout << "Allocating the model\n" << std::flush;
@@ -208,6 +263,7 @@ public:
         }
         checkParallelException("Could not allocate model: ",
                                exceptionThrown, what);
+        recordSetupPhase_("Model allocation", phaseTimer);
 
         if (verbose_)
             std::cout << "Allocating the problem\n" << std::flush;
@@ -220,6 +276,7 @@ public:
         }
         checkParallelException("Could not allocate the problem: ",
                                exceptionThrown, what);
+        recordSetupPhase_("Problem allocation", phaseTimer);
 
         if (verbose_)
             std::cout << "Initializing the model\n" << std::flush;
@@ -231,6 +288,7 @@ public:
         }
         checkParallelException("Could not initialize the  model: ",
                                exceptionThrown, what);
+        recordSetupPhase_("Model initialization", phaseTimer);
 
         if (verbose_)
             std::cout << "Initializing the problem\n" << std::flush;
@@ -242,11 +300,19 @@ public:
         }
         checkParallelException("Could not initialize the problem: ",
                                exceptionThrown, what);
+        recordSetupPhase_("Problem initialization", phaseTimer);
 
         setupTimer_.stop();
 
-        if (verbose_)
-            std::cout << "Simulator successfully set up\n" << std::flush;
+        if (verbose_) {
+            std::cout << "Simulator successfully set up\n";
+            for (const auto& [name, seconds] : setupPhaseTimes_)
+                std::cout << "    " << name << ": " << seconds << " seconds\n";
+            std::cout << std::flush;
+        }
+
+        if (Parameters::get<TypeTag, Properties::PrintMemoryUsage>())
+            printMemoryUsage();
     }
 
     /*!
@@ -260,15 +326,60 @@ public:
             ("The size of the initial time step [s]");
         Parameters::registerParam<TypeTag, Properties::RestartTime>
             ("The simulation time at which a restart should be attempted [s]");
+        Parameters::registerParam<TypeTag, Properties::RestartFormat>
+            ("The format of the restart files. Possible values are 'text', 'binary' "
+             "and 'collective' (a single file for all processes)");
+        Parameters::registerParam<TypeTag, Properties::EnableRestartMmap>
+            ("Map binary restart files into memory instead of reading them");
+        Parameters::registerParam<TypeTag, Properties::EnableAsyncRestartOutput>
+            ("Serialize the simulation into memory and write the restart files to disk "
+             "while the simulation proceeds. This does not apply to collective restart "
+             "files");
         Parameters::registerParam<TypeTag, Properties::PredeterminedTimeStepsFile>
             ("A file with a list of predetermined time step sizes (one "
              "time step per line)");
+        Parameters::registerParam<TypeTag, Properties::EnableHardwareCounters>
+            ("Record the hardware performance counters of the phases of the simulation "
+             "(Linux only, requires access to perf events)");
+        Parameters::registerParam<TypeTag, Properties::PrintMemoryUsage>
+            ("Print the memory held by the data structures of the simulation after it "
+             "has been set up and after it has finished");
 
         Vanguard::registerParameters();
         Model::registerParameters();
         Problem::registerParameters();
     }
 
+    /*!
+     * \brief Print the number of bytes held by the data structures of the simulation.
+     *
+     * The amounts are reduced over all processes and printed by the first one, i.e.,
+     * this method must be called by all processes.
+     */
+    void printMemoryUsage(std::ostream& os = std::cout) const
+    {
+        MemoryUsage usage;
+        usage.addFrom(*model_);
+        usage.addFrom(*problem_);
+        usage.print(os, gridView().comm());
+    }
+
+    /*!
+     * \brief Return the index of the simulation within its ensemble.
+     *
+     * This is 0 if the simulation is not part of an ensemble. Problems may use the
+     * index to select the properties of the realisation which ought to be simulated.
+     */
+    unsigned ensembleMemberIdx() const
+    { return ensembleMemberIdx_; }
+
+    /*!
+     * \brief Return the number of members of the ensemble which the simulation is part
+     *        of.
+     */
+    unsigned ensembleSize() const
+    { return ensembleSize_; }
+
     /*!
      * \brief Return a reference to the grid manager of simulation
      */
@@ -380,6 +491,15 @@ public:
     const Timer& setupTimer() const
     { return setupTimer_; }
 
+    /*!
+     * \brief Returns the names and wall clock times [s] of the phases of the setup.
+     *
+     * The phases are listed in the order in which they were executed and add up to
+     * the time measured by setupTimer().
+     */
+    const std::vector<std::pair<std::string, double>>& setupPhaseTimes() const
+    { return setupPhaseTimes_; }
+
     /*!
      * \brief Returns a reference to the timer object which measures the time needed to
      *        run the simulation
@@ -649,12 +769,14 @@ public:
         TimerGuard writeTimerGuard(writeTimer_);
 
         setupTimer_.start();
+        Timer phaseTimer;
+        phaseTimer.start();
         Scalar restartTime = Parameters::get<TypeTag, Properties::RestartTime>();
         if (restartTime > -1e30) {
             // try to restart a previous simulation
             time_ = restartTime;
 
-            Restart res;
+            Restart res(restartFormat_(), Parameters::get<TypeTag, Properties::EnableRestartMmap>());
             EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(res.deserializeBegin(*this, time_));
             if (verbose_)
                 std::cout << "Deserialize from file '" << res.fileName() << "'\n" << std::flush;
@@ -662,6 +784,7 @@ public:
             EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(problem_->deserialize(res));
             EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(model_->deserialize(res));
             EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(res.deserializeEnd());
+            recordSetupPhase_("Restart", phaseTimer);
             if (verbose_)
                 std::cout << "Deserialization done."
                           << " Simulator time: " << time() << humanReadableTime(time())
@@ -688,9 +811,16 @@ public:
 
             timeStepSize_ = oldTimeStepSize;
             timeStepIdx_ = oldTimeStepIdx;
+            recordSetupPhase_("Initial solution", phaseTimer);
         }
         setupTimer_.stop();
 
+        if (Parameters::get<TypeTag, Properties::EnableHardwareCounters>()
+            && !HardwareCounters::instance().init()
+            && verbose_)
+            std::cout << "Warning: The hardware performance counters are not available "
+                      << "on this system\n" << std::flush;
+
         executionTimer_.start();
         bool episodeBegins = episodeIsOver() || (timeStepIdx_ == 0);
         // do the time steps
@@ -735,6 +865,7 @@ public:
 
             try {
                 // execute the time integration scheme
+                EWOMS_PROFILE_REGION("time integration");
                 problem_->timeIntegration();
             }
             catch (...) {
@@ -762,8 +893,11 @@ public:
 
             // write the result to disk
             writeTimer_.start();
-            if (problem_->shouldWriteOutput())
+            if (problem_->shouldWriteOutput()) {
+                EWOMS_PROFILE_REGION("write output");
+                HardwareCounters::Phase counterPhase("write output");
                 EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(problem_->writeOutput());
+            }
             writeTimer_.stop();
 
             // do the next time integration
@@ -808,9 +942,23 @@ public:
                 EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(serialize());
             writeTimer_.stop();
         }
+
+        writeTimer_.start();
+        EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(finishRestartOutput());
+        writeTimer_.stop();
         executionTimer_.stop();
 
         EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(problem_->finalize());
+        EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(model_->newtonMethod().writeIterationLog());
+
+        if (RegionProfiler::enabled() && verbose_)
+            RegionProfiler::instance().print(std::cout);
+        if (ThreadLoadStatistics::enabled() && verbose_)
+            ThreadLoadStatistics::printAll(std::cout);
+        if (HardwareCounters::instance().active() && verbose_)
+            HardwareCounters::instance().print(std::cout);
+        if (Parameters::get<TypeTag, Properties::PrintMemoryUsage>())
+            printMemoryUsage();
     }
 
     /*!
@@ -901,22 +1049,55 @@ public:
      * The file will start with the prefix returned by the name()
      * method, has the current time of the simulation clock in it's
      * name and uses the extension <tt>.ers</tt>. (Ewoms ReStart
-     * file.)  See Opm::Restart for details.
+     * file.) Binary restart files use the extension <tt>.erb</tt>.
+     * See Opm::Restart for details.
+     *
+     * If asynchronous restart output is enabled, the state is serialized into memory
+     * and the file is written by a background thread. Only a single restart file is
+     * staged at a time, i.e., this method waits for the previous one to be written.
      */
     void serialize()
     {
         using Restarter = Restart;
-        Restarter res;
-        res.serializeBegin(*this);
+
+        finishRestartOutput();
+
+        const Restart::Format format = restartFormat_();
+        const bool async = restartTaskletRunner_ && format != Restart::Format::Collective;
+        auto res = std::make_shared<Restarter>(format);
+        res->setStaged(async);
+        res->serializeBegin(*this);
         if (gridView().comm().rank() == 0)
-            std::cout << "Serialize to file '" << res.fileName() << "'"
+            std::cout << "Serialize to file '" << res->fileName() << "'"
                       << ", next time step size: " << timeStepSize()
                       << "\n" << std::flush;
 
-        this->serialize(res);
-        problem_->serialize(res);
-        model_->serialize(res);
-        res.serializeEnd();
+        this->serialize(*res);
+        problem_->serialize(*res);
+        model_->serialize(*res);
+        res->serializeEnd();
+
+        if (async)
+            restartTaskletRunner_->dispatch(std::make_shared<WriteRestartTasklet>(std::move(res),
+                                                                                  restartError_));
+    }
+
+    /*!
+     * \brief Wait until the restart file which is written in the background is complete.
+     *
+     * If writing the file failed, the exception is rethrown.
+     */
+    void finishRestartOutput()
+    {
+        if (!restartTaskletRunner_)
+            return;
+
+        restartTaskletRunner_->barrier();
+        if (restartError_) {
+            std::exception_ptr error = restartError_;
+            restartError_ = nullptr;
+            std::rethrow_exception(error);
+        }
     }
 
     /*!
@@ -976,6 +1157,19 @@ public:
     }
 
 private:
+    static Restart::Format restartFormat_()
+    { return Restart::parseFormat(Parameters::get<TypeTag, Properties::RestartFormat>()); }
+
+    void recordSetupPhase_(const std::string& name, Timer& phaseTimer)
+    {
+        setupPhaseTimes_.emplace_back(name, phaseTimer.stop());
+        phaseTimer.halt();
+        phaseTimer.start();
+    }
+
+    unsigned ensembleMemberIdx_;
+    unsigned ensembleSize_;
+
     std::unique_ptr<Vanguard> vanguard_;
     std::unique_ptr<Model> model_;
     std::unique_ptr<Problem> problem_;
@@ -985,6 +1179,7 @@ private:
     Scalar episodeLength_;
 
     Timer setupTimer_;
+    std::vector<std::pair<std::string, double>> setupPhaseTimes_;
     Timer executionTimer_;
     Timer prePostProcessTimer_;
     Timer linearizeTimer_;
@@ -1002,6 +1197,11 @@ private:
 
     bool finished_;
     bool verbose_;
+
+    // the error of writing a restart file in the background. the tasklet runner must
+    // be destroyed before, because its destructor waits for the pending tasklets
+    std::exception_ptr restartError_;
+    std::unique_ptr<TaskletRunner> restartTaskletRunner_;
 };
 
 namespace Properties {
@@ -34,6 +34,7 @@
 
 #include "parametersystem.hh"
 
+#include <opm/models/utils/ensemblerunner.hh>
 #include <opm/models/utils/simulator.hh>
 #include <opm/models/utils/timer.hh>
 
@@ -73,7 +74,7 @@ namespace Opm {
  * \brief Announce all runtime parameters to the registry but do not specify them yet.
  */
 template <class TypeTag>
-static inline void registerAllParameters_(bool finalizeRegistration = true)
+inline void registerAllParameters_(bool finalizeRegistration = true)
 {
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
     using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
@@ -89,6 +90,7 @@ static inline void registerAllParameters_(bool finalizeRegistration = true)
 
     Simulator::registerParameters();
     ThreadManager::registerParameters();
+    EnsembleRunner<TypeTag>::registerParameters();
 
     if (finalizeRegistration) {
         Parameters::endParamRegistration<TypeTag>();
@@ -105,7 +107,7 @@ static inline void registerAllParameters_(bool finalizeRegistration = true)
  *         a positive value for errors or 0 for success.
  */
 template <class TypeTag>
-static inline int setupParameters_(int argc,
+inline int setupParameters_(int argc,
                                    const char **argv,
                                    bool registerParams=true,
                                    bool allowUnused=false,
@@ -211,7 +213,7 @@ static inline int setupParameters_(int argc,
  *
  * This is intended to be called as part of a generic exception handler
  */
-static inline void resetTerminal_()
+inline void resetTerminal_()
 {
     // make sure stderr and stderr do not contain any unwritten data and make sure that
     // the TTY does not see any unfinished ANSI escape sequence.
@@ -236,7 +238,7 @@ static inline void resetTerminal_()
  * \brief Resets the current TTY to a usable state if the program was interrupted by
  *        SIGABRT or SIGINT.
  */
-static inline void resetTerminal_(int signum)
+inline void resetTerminal_(int signum)
 {
     // first thing to do when a nuke hits: restore the default signal handler
     signal(signum, SIG_DFL);
@@ -277,7 +279,7 @@ static inline void resetTerminal_(int signum)
  * \param argv The array of the command line arguments
  */
 template <class TypeTag>
-static inline int start(int argc, char **argv,  bool registerParams=true)
+int start(int argc, char **argv,  bool registerParams=true)
 {
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
@@ -387,8 +389,12 @@ static inline int start(int argc, char **argv,  bool registerParams=true)
         // instantiate and run the concrete problem. make sure to
         // deallocate the problem and before the time manager and the
         // grid
-        Simulator simulator;
-        simulator.run();
+        if (Parameters::get<TypeTag, Properties::EnsembleSize>() > 1)
+            EnsembleRunner<TypeTag>::run();
+        else {
+            Simulator simulator;
+            simulator.run();
+        }
 
         if (myRank == 0) {
             std::cout << "Simulation completed" << std::endl;                                 
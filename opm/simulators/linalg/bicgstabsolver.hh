@@ -30,13 +30,16 @@
 #include "convergencecriterion.hh"
 #include "residreductioncriterion.hh"
 #include "linearsolverreport.hh"
+#include "overlappingscalarproduct.hh"
 
+#include <opm/models/utils/objectpool.hh>
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
 
 #include <opm/common/Exceptions.hpp>
 
 #include <memory>
+#include <optional>
 
 namespace Opm {
 namespace Linear {
@@ -53,6 +56,7 @@ template <class LinearOperator, class Vector, class Preconditioner>
 class BiCGStabSolver
 {
     using ConvergenceCriterion = Opm::Linear::ConvergenceCriterion<Vector>;
+    using VectorPool = ObjectPool<Vector>;
     using Scalar = typename LinearOperator::field_type;
 
 public:
@@ -67,6 +71,8 @@ public:
         b_ = nullptr;
 
         maxIterations_ = 1000;
+        fuseReductions_ = false;
+        useInitialGuess_ = false;
     }
 
     /*!
@@ -83,6 +89,45 @@ public:
     unsigned maxIterations() const
     { return maxIterations_; }
 
+    /*!
+     * \brief Specify whether the scalar products of the second half of each iteration
+     *        should be computed using a single global reduction.
+     *
+     * If enabled, the scalar products (t, t), (t, s), (r0hat, s) and (r0hat, t) are
+     * computed at once, and rho of the next iteration is then given by
+     * (r0hat, s) - omega*(r0hat, t) instead of requiring a separate reduction. This
+     * saves one of the three global reductions per iteration of the method, but it
+     * changes the rounding errors slightly. This only has an effect if the scalar
+     * product is a MultiDotScalarProduct.
+     */
+    void setFuseReductions(bool value)
+    { fuseReductions_ = value; }
+
+    /*!
+     * \brief Returns whether the scalar products of each iteration are computed using
+     *        fused global reductions.
+     */
+    bool fuseReductions() const
+    { return fuseReductions_; }
+
+    /*!
+     * \brief Specify whether the vector passed to apply() is used as initial solution.
+     *
+     * If this is disabled, the solver starts with a zero vector. Otherwise, the
+     * reduction of the residual is measured relative to the residual of the zero vector
+     * as well, i.e., a good initial solution reduces the number of iterations instead
+     * of making the convergence criterion stricter. If the initial solution has a
+     * larger residual than the zero vector, it is discarded.
+     */
+    void setUseInitialGuess(bool value)
+    { useInitialGuess_ = value; }
+
+    /*!
+     * \brief Returns whether the vector passed to apply() is used as initial solution.
+     */
+    bool useInitialGuess() const
+    { return useInitialGuess_; }
+
     /*!
      * \brief Set the verbosity level of the linear solver
      *
@@ -127,6 +172,7 @@ public:
         // stopped in case exceptions are thrown as well as if the method returns
         // regularly.)
         report_.reset();
+        report_.incrementSolves();
         TimerGuard reportTimerGuard(report_.timer());
         report_.timer().start();
 
@@ -135,14 +181,25 @@ public:
         // See https://en.wikipedia.org/wiki/Biconjugate_gradient_stabilized_method,
         // (article date: December 19, 2016)
 
-        // set the initial solution to the zero vector
+        // the temporary vectors are taken from a pool which lives beyond the solver
+        // object, so consecutive linear solves do not need to allocate them again.
+        VectorPool& vectorPool = VectorPool::threadLocal();
+
+        // set the initial solution to the zero vector. if an initial guess is
+        // used, it is applied after the preconditioner has been prepared.
+        std::optional<typename VectorPool::Handle> guessHandle;
+        if (useInitialGuess_)
+            guessHandle.emplace(vectorPool.acquire(x));
         x = 0.0;
 
         // prepare the preconditioner. to allow some optimizations, we assume that the
         // preconditioner does not change the initial solution x if the initial solution
         // is a zero vector.
-        Vector r = *b_;
+        auto rHandle = vectorPool.acquire(*b_);
+        Vector& r = *rHandle;
+        report_.preconditionerSetupTimer().start();
         preconditioner_.pre(x, r);
+        report_.preconditionerSetupTimer().stop();
 
 #ifndef NDEBUG
         // ensure that the preconditioner does not change the initial solution. since
@@ -157,6 +214,9 @@ public:
 #endif // NDEBUG
 
         convergenceCriterion_.setInitial(x, r);
+        if (guessHandle)
+            applyInitialGuess_(x, r, **guessHandle);
+        report_.addResidual(convergenceCriterion_.accuracy());
         if (convergenceCriterion_.converged()) {
             report_.setConverged(true);
             return report_.converged();
@@ -167,8 +227,8 @@ public:
             convergenceCriterion_.printInitial();
         }
 
-        // r0 = b - Ax (i.e., r -= A*x_0 = b, because x_0 == 0)
-        //A_->applyscaleadd(/*alpha=*/-1.0, x, r);
+        // r0 = b - Ax. this has already been done if an initial guess is used, else
+        // r_0 = b because x_0 == 0
 
         // r0hat = r0
         const Vector& r0hat = *b_;
@@ -179,22 +239,34 @@ public:
         Scalar omega = 1.0;
 
         // v_0 = p_0 = 0;
-        Vector v(r);
+        auto vHandle = vectorPool.acquire(r);
+        Vector& v = *vHandle;
         v = 0.0;
-        Vector p(v);
+        auto pHandle = vectorPool.acquire(v);
+        Vector& p = *pHandle;
 
         // create all the temporary vectors which we need. Be aware that some of them
         // actually point to the same object because they are not needed at the same time!
-        Vector y(x);
+        auto yHandle = vectorPool.acquire(x);
+        Vector& y = *yHandle;
         Vector& h(x);
         Vector& s(r);
-        Vector z(x);
+        auto zHandle = vectorPool.acquire(x);
+        Vector& z = *zHandle;
         Vector& t(y);
         unsigned n = x.size();
 
+        const auto* multiDotProduct =
+            fuseReductions_
+            ? dynamic_cast<const MultiDotScalarProduct<Vector>*>(&scalarProduct_)
+            : nullptr;
+
+        // rho_1 = (r0hat,r_0)
+        Scalar nextRho = dot_(r0hat, r);
+
         for (; report_.iterations() < maxIterations_; report_.increment()) {
             // rho_i = (r0hat,r_(i-1))
-            Scalar rho_i = scalarProduct_.dot(r0hat, r);
+            Scalar rho_i = nextRho;
 
             // beta = (rho_i/rho_(i-1))*(alpha/omega_(i-1))
             if (std::abs(rho) <= breakdownEps || std::abs(omega) <= breakdownEps)
@@ -208,6 +280,9 @@ public:
             //
             // p_i = r_(i-1) + beta*(p_(i-1) - omega_(i-1)*v_(i-1))
             // y = p
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
             for (unsigned i = 0; i < n; ++i) {
                 // p_i = r_(i-1) + beta*(p_(i-1) - omega_(i-1)*v_(i-1))
                 auto tmp = v[i];
@@ -222,13 +297,13 @@ public:
             }
 
             // y = K^-1 * p_i
-            preconditioner_.apply(y, p);
+            applyPreconditioner_(y, p);
 
             // v_i = A*y
-            A_->apply(y, v);
+            applyOperator_(y, v);
 
             // alpha = rho_i/(r0hat,v_i)
-            Scalar denom = scalarProduct_.dot(r0hat, v);
+            Scalar denom = dot_(r0hat, v);
             if (std::abs(denom) <= breakdownEps)
                 throw NumericalProblem("Breakdown of the BiCGStab solver (division by zero)");
             alpha = rho_i/denom;
@@ -237,6 +312,9 @@ public:
 
             // h = x_(i-1) + alpha*y
             // s = r_(i-1) - alpha*v_i
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
             for (unsigned i = 0; i < n; ++i) {
                 auto tmp = y[i];
                 tmp *= alpha;
@@ -251,6 +329,7 @@ public:
 
             // do convergence check and print terminal output
             convergenceCriterion_.update(/*curSol=*/h, /*delta=*/y, s);
+            report_.addResidual(convergenceCriterion_.accuracy());
             if (convergenceCriterion_.converged()) {
                 if (verbosity_ > 0) {
                     convergenceCriterion_.print(report_.iterations() + 0.5);
@@ -277,26 +356,44 @@ public:
 
             // z = K^-1*s
             z = s;
-            preconditioner_.apply(z, s);
+            applyPreconditioner_(z, s);
 
-            // t = Az
-            t = z;
-            A_->apply(z, t);
+            // t = Az. the operator overwrites t, so it does not need to be initialized
+            applyOperator_(z, t);
 
             // omega_i = (t*s)/(t*t)
-            denom = scalarProduct_.dot(t, t);
+            Scalar ts;
+            Scalar r0hatS = 0.0;
+            Scalar r0hatT = 0.0;
+            if (multiDotProduct) {
+                const Vector* dotX[4] = { &t, &t, &r0hat, &r0hat };
+                const Vector* dotY[4] = { &t, &s, &s, &t };
+                Scalar dotResult[4];
+                report_.dotTimer().start();
+                multiDotProduct->dots(dotX, dotY, dotResult, /*n=*/4);
+                report_.dotTimer().stop();
+                denom = dotResult[0];
+                ts = dotResult[1];
+                r0hatS = dotResult[2];
+                r0hatT = dotResult[3];
+            }
+            else {
+                denom = dot_(t, t);
+                ts = dot_(t, s);
+            }
             if (std::abs(denom) <= breakdownEps)
                 throw NumericalProblem("Breakdown of the BiCGStab solver (division by zero)");
-            omega = scalarProduct_.dot(t, s)/denom;
+            omega = ts/denom;
             if (std::abs(omega) <= breakdownEps)
                 throw NumericalProblem("Breakdown of the BiCGStab solver (stagnation detected)");
 
             // x_i = h + omega_i*z
             // x = h; // not necessary because x and h are the same object
-            x.axpy(/*a=*/omega, /*y=*/z);
+            axpy_(x, omega, z);
 
             // do convergence check and print terminal output
             convergenceCriterion_.update(/*curSol=*/x, /*delta=*/z, r);
+            report_.addResidual(convergenceCriterion_.accuracy());
             if (convergenceCriterion_.converged()) {
                 if (verbosity_ > 0) {
                     convergenceCriterion_.print(1.0 + report_.iterations());
@@ -322,7 +419,13 @@ public:
 
             // r_i = s - omega*t
             // r = s; // not necessary because r and s are the same object
-            r.axpy(/*a=*/-omega, /*y=*/t);
+            axpy_(r, -omega, t);
+
+            // rho_(i+1) = (r0hat,r_i)
+            if (multiDotProduct)
+                nextRho = r0hatS - omega*r0hatT;
+            else
+                nextRho = dot_(r0hat, r);
         }
 
         report_.setConverged(false);
@@ -338,6 +441,65 @@ public:
     { return report_; }
 
 private:
+    // replace the zero initial solution by a guess. The convergence criterion keeps
+    // the residual of the zero vector as its reference, so the guess only counts as
+    // progress towards the requested reduction. If the guess increases the residual,
+    // the zero vector is kept.
+    void applyInitialGuess_(Vector& x, Vector& r, const Vector& guess)
+    {
+        x = guess;
+        report_.spmvTimer().start();
+        A_->applyscaleadd(/*alpha=*/-1.0, x, r);
+        report_.spmvTimer().stop();
+        convergenceCriterion_.update(/*curSol=*/x, /*delta=*/x, r);
+        if (convergenceCriterion_.accuracy() <= 1.0)
+            return;
+
+        report_.spmvTimer().start();
+        A_->applyscaleadd(/*alpha=*/1.0, x, r);
+        report_.spmvTimer().stop();
+        x = 0.0;
+        convergenceCriterion_.setInitial(x, r);
+    }
+
+    // the following methods record the time spent for the respective operation in
+    // the report
+    void applyPreconditioner_(Vector& x, const Vector& d)
+    {
+        report_.preconditionerApplyTimer().start();
+        preconditioner_.apply(x, d);
+        report_.preconditionerApplyTimer().stop();
+    }
+
+    void applyOperator_(const Vector& x, Vector& y)
+    {
+        report_.spmvTimer().start();
+        A_->apply(x, y);
+        report_.spmvTimer().stop();
+    }
+
+    Scalar dot_(const Vector& x, const Vector& y)
+    {
+        report_.dotTimer().start();
+        Scalar result = scalarProduct_.dot(x, y);
+        report_.dotTimer().stop();
+        return result;
+    }
+
+    // x += a*y, multi-threaded
+    static void axpy_(Vector& x, Scalar a, const Vector& y)
+    {
+        const unsigned n = x.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (unsigned i = 0; i < n; ++i) {
+            auto tmp = y[i];
+            tmp *= a;
+            x[i] += tmp;
+        }
+    }
+
     const LinearOperator* A_;
     const Vector* b_;
 
@@ -348,6 +510,8 @@ private:
 
     unsigned maxIterations_;
     unsigned verbosity_;
+    bool fuseReductions_;
+    bool useInitialGuess_;
 };
 
 } // namespace Linear
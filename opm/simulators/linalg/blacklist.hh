@@ -38,6 +38,7 @@
 
 #include <iostream>
 #include <algorithm>
+#include <vector>
 
 namespace Opm {
 namespace Linear {
@@ -61,19 +62,26 @@ public:
     BlackList(const BlackList&) = default;
 
     bool hasIndex(Index nativeIdx) const
-    { return nativeBlackListedIndices_.count(nativeIdx) > 0; }
+    {
+        return std::binary_search(nativeBlackListedIndices_.begin(),
+                                  nativeBlackListedIndices_.end(),
+                                  nativeIdx);
+    }
 
     void addIndex(Index nativeIdx)
-    { nativeBlackListedIndices_.insert(nativeIdx); }
-
-    Index nativeToDomestic(Index nativeIdx) const
     {
-        auto it = nativeToDomesticMap_.find(nativeIdx);
-        if (it == nativeToDomesticMap_.end())
-            return -1;
-        return it->second;
+        // the indices are usually added in ascending order, so keeping the array
+        // sorted is cheap
+        auto it = std::lower_bound(nativeBlackListedIndices_.begin(),
+                                   nativeBlackListedIndices_.end(),
+                                   nativeIdx);
+        if (it == nativeBlackListedIndices_.end() || *it != nativeIdx)
+            nativeBlackListedIndices_.insert(it, nativeIdx);
     }
 
+    Index nativeToDomestic(Index nativeIdx) const
+    { return nativeToDomesticMap_.find(nativeIdx); }
+
     void setPeerList(ProcessRank peerRank, const PeerBlackList& peerBlackList)
     { peerBlackLists_[peerRank] = peerBlackList; }
 
@@ -161,17 +169,19 @@ private:
 
         MpiBuffer<Index> globalIdxBuf(2*numIndices);
         globalIdxBuf.receive(peerRank);
+        nativeToDomesticMap_.reserve(nativeToDomesticMap_.size() + numIndices);
         for (unsigned i = 0; i < numIndices; ++i) {
             Index globalIdx = globalIdxBuf[2*i + 0];
             Index nativeIdx = globalIdxBuf[2*i + 1];
 
-            nativeToDomesticMap_[nativeIdx] = domesticOverlap.globalToDomestic(globalIdx);
+            nativeToDomesticMap_.set(nativeIdx, domesticOverlap.globalToDomestic(globalIdx));
         }
     }
 #endif // HAVE_MPI
 
-    std::set<Index> nativeBlackListedIndices_;
-    std::map<Index, Index> nativeToDomesticMap_;
+    // the black-listed native indices in ascending order
+    std::vector<Index> nativeBlackListedIndices_;
+    IndexMap nativeToDomesticMap_;
 #if HAVE_MPI
     std::map<ProcessRank, MpiBuffer<unsigned>> numGlobalIdxSendBuff_;
     std::map<ProcessRank, MpiBuffer<Index>> globalIdxSendBuff_;
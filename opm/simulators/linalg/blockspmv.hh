@@ -0,0 +1,139 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Multi-threaded sparse matrix-vector products for block compressed row
+ *        storage matrices.
+ *
+ * In contrast to the generic implementation of dune-istl, the rows are distributed
+ * to the threads of the process and the size of the blocks is a compile time
+ * constant, so that the compiler can unroll and vectorize the block products.
+ */
+#ifndef EWOMS_BLOCK_SPMV_HH
+#define EWOMS_BLOCK_SPMV_HH
+
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+namespace detail {
+
+// compute the product of a matrix row and a vector, i.e., \f$ \sum_j A_{ij} x_j \f$
+template <class Matrix, class DomainVector, class RangeBlock>
+inline void blockRowProduct(const Matrix& A, const DomainVector& x, std::size_t rowIdx,
+                            RangeBlock& result)
+{
+    using Block = typename Matrix::block_type;
+    constexpr int n = Block::rows;
+    constexpr int m = Block::cols;
+
+    for (int k = 0; k < n; ++k)
+        result[k] = 0.0;
+
+    const auto& row = A[rowIdx];
+    const auto endIt = row.end();
+    for (auto colIt = row.begin(); colIt != endIt; ++colIt) {
+        const Block& a = *colIt;
+        const auto& xj = x[colIt.index()];
+        for (int k = 0; k < n; ++k) {
+            typename RangeBlock::field_type tmp = 0.0;
+            for (int l = 0; l < m; ++l)
+                tmp += a[k][l]*xj[l];
+            result[k] += tmp;
+        }
+    }
+}
+
+} // namespace detail
+
+/*!
+ * \brief Compute \f$ y_i = (A x)_i \f$ for the rows i given by an index list.
+ */
+template <class Matrix, class DomainVector, class RangeVector, class RowIndex>
+void blockMv(const Matrix& A, const DomainVector& x, RangeVector& y,
+             const std::vector<RowIndex>& rows)
+{
+    const std::size_t numRows = rows.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (std::size_t k = 0; k < numRows; ++k)
+        detail::blockRowProduct(A, x, rows[k], y[rows[k]]);
+}
+
+/*!
+ * \brief Compute \f$ y = A x \f$.
+ */
+template <class Matrix, class DomainVector, class RangeVector>
+void blockMv(const Matrix& A, const DomainVector& x, RangeVector& y)
+{
+    const std::size_t numRows = A.N();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+        detail::blockRowProduct(A, x, rowIdx, y[rowIdx]);
+}
+
+/*!
+ * \brief Compute \f$ y_i = y_i + \alpha (A x)_i \f$ for the rows i given by an index
+ *        list.
+ */
+template <class Scalar, class Matrix, class DomainVector, class RangeVector, class RowIndex>
+void blockUsmv(Scalar alpha, const Matrix& A, const DomainVector& x, RangeVector& y,
+               const std::vector<RowIndex>& rows)
+{
+    const std::size_t numRows = rows.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (std::size_t k = 0; k < numRows; ++k) {
+        typename RangeVector::block_type tmp;
+        detail::blockRowProduct(A, x, rows[k], tmp);
+        y[rows[k]].axpy(alpha, tmp);
+    }
+}
+
+/*!
+ * \brief Compute \f$ y = y + \alpha A x \f$.
+ */
+template <class Scalar, class Matrix, class DomainVector, class RangeVector>
+void blockUsmv(Scalar alpha, const Matrix& A, const DomainVector& x, RangeVector& y)
+{
+    const std::size_t numRows = A.N();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        typename RangeVector::block_type tmp;
+        detail::blockRowProduct(A, x, rowIdx, tmp);
+        y[rowIdx].axpy(alpha, tmp);
+    }
+}
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
@@ -0,0 +1,240 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::Linear::CprPreconditioner
+ */
+#ifndef EWOMS_CPR_PRECONDITIONER_HH
+#define EWOMS_CPR_PRECONDITIONER_HH
+
+#include <opm/common/Exceptions.hpp>
+
+#include <opm/simulators/linalg/parallelilu0.hh>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioner.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/paamg/amg.hh>
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief A two-stage constrained pressure residual (CPR) preconditioner.
+ *
+ * The first stage solves an approximate pressure system using a V-cycle of an
+ * algebraic multi-grid method, the second stage applies a block ILU(0)
+ * decomposition of the complete system to the remaining defect:
+ *
+ * \f[ x_1 = P A_p^{-1} W^T d \qquad x = x_1 + M_{ILU}^{-1} (d - A x_1) \f]
+ *
+ * The pressure system \f$ A_p = W^T A P \f$ is obtained using quasi-IMPES weights,
+ * i.e., the weights \f$ w_i \f$ of row i solve \f$ A_{ii}^T w_i = e_p \f$ where
+ * \f$ A_{ii} \f$ is the diagonal block of the row and p the index of the pressure
+ * variable. P prolongates a pressure correction to the pressure variables.
+ *
+ * Like the other preconditioners, this is a sequential preconditioner which is
+ * applied to the domestic part of the overlapping matrix.
+ */
+template <class Matrix, class DomainVector, class RangeVector>
+class CprPreconditioner : public Dune::Preconditioner<DomainVector, RangeVector>
+{
+    using Block = typename Matrix::block_type;
+    using VectorBlock = typename DomainVector::block_type;
+    static constexpr int numEq = Block::rows;
+
+public:
+    using matrix_type = Matrix;
+    using domain_type = DomainVector;
+    using range_type = RangeVector;
+    using field_type = typename DomainVector::field_type;
+
+    using PressureMatrix = Dune::BCRSMatrix<Dune::FieldMatrix<field_type, 1, 1>>;
+    using PressureVector = Dune::BlockVector<Dune::FieldVector<field_type, 1>>;
+
+    CprPreconditioner(const Matrix& matrix,
+                      unsigned pressureVarIdx,
+                      int coarsenTarget,
+                      field_type relaxationFactor)
+        : matrix_(matrix)
+        , pressureVarIdx_(pressureVarIdx)
+        , smoother_(matrix, relaxationFactor)
+    {
+        if (pressureVarIdx_ >= static_cast<unsigned>(numEq))
+            throw std::invalid_argument("The index of the pressure variable of the CPR "
+                                        "preconditioner is out of range");
+
+        computeWeights_();
+        assemblePressureMatrix_();
+        setupAmg_(coarsenTarget);
+
+        pressureDefect_.resize(matrix.N());
+        pressureCorrection_.resize(matrix.N());
+    }
+
+    CprPreconditioner(const CprPreconditioner&) = delete;
+    CprPreconditioner& operator=(const CprPreconditioner&) = delete;
+
+    void pre(DomainVector&, RangeVector&) override
+    {
+        pressureCorrection_ = 0.0;
+        pressureDefect_ = 0.0;
+        amg_->pre(pressureCorrection_, pressureDefect_);
+    }
+
+    void apply(DomainVector& x, const RangeVector& d) override
+    {
+        const std::size_t numRows = matrix_.N();
+
+        // first stage: restrict the defect to the pressure system and solve it
+        // approximately
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            pressureDefect_[rowIdx] = weights_[rowIdx]*d[rowIdx];
+
+        pressureCorrection_ = 0.0;
+        amg_->apply(pressureCorrection_, pressureDefect_);
+
+        x = 0.0;
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            x[rowIdx][pressureVarIdx_] = pressureCorrection_[rowIdx][0];
+
+        // second stage: smooth the remaining defect of the complete system. the
+        // temporary vectors are copies of the arguments because the vectors of the
+        // linear solver may carry additional data, e.g. their overlap
+        if (!defect_) {
+            defect_ = std::make_unique<RangeVector>(d);
+            correction_ = std::make_unique<DomainVector>(x);
+        }
+        *defect_ = d;
+        matrix_.mmv(x, *defect_);
+
+        smoother_.apply(*correction_, *defect_);
+        x += *correction_;
+    }
+
+    void post(DomainVector&) override
+    { amg_->post(pressureCorrection_); }
+
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+private:
+    using PressureOperator = Dune::MatrixAdapter<PressureMatrix, PressureVector, PressureVector>;
+    using PressureSmoother = Dune::SeqSSOR<PressureMatrix, PressureVector, PressureVector>;
+    using PressureAmg = Dune::Amg::AMG<PressureOperator, PressureVector, PressureSmoother>;
+
+    void computeWeights_()
+    {
+        const std::size_t numRows = matrix_.N();
+        weights_.resize(numRows);
+
+        VectorBlock unitPressure(0.0);
+        unitPressure[pressureVarIdx_] = 1.0;
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            const auto& row = matrix_[rowIdx];
+            const auto diagIt = row.find(rowIdx);
+            if (diagIt == row.end())
+                throw NumericalProblem("The CPR preconditioner requires diagonal blocks");
+
+            Block diagTransposed;
+            for (int i = 0; i < numEq; ++i)
+                for (int j = 0; j < numEq; ++j)
+                    diagTransposed[i][j] = (*diagIt)[j][i];
+
+            diagTransposed.solve(weights_[rowIdx], unitPressure);
+        }
+    }
+
+    void assemblePressureMatrix_()
+    {
+        const std::size_t numRows = matrix_.N();
+        pressureMatrix_ = std::make_unique<PressureMatrix>(numRows, numRows,
+                                                           matrix_.nonzeroes(),
+                                                           PressureMatrix::row_wise);
+        for (auto rowIt = pressureMatrix_->createbegin(); rowIt != pressureMatrix_->createend(); ++rowIt) {
+            const auto& row = matrix_[rowIt.index()];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                rowIt.insert(colIt.index());
+        }
+
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            const auto& row = matrix_[rowIdx];
+            const auto& w = weights_[rowIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                field_type value = 0.0;
+                for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    value += w[eqIdx]*(*colIt)[eqIdx][pressureVarIdx_];
+                (*pressureMatrix_)[rowIdx][colIt.index()] = value;
+            }
+        }
+    }
+
+    void setupAmg_(int coarsenTarget)
+    {
+        using SmootherArgs = typename Dune::Amg::SmootherTraits<PressureSmoother>::Arguments;
+        SmootherArgs smootherArgs;
+        smootherArgs.iterations = 1;
+        smootherArgs.relaxationFactor = 1.0;
+
+        using CoarsenCriterion = Dune::Amg::
+            CoarsenCriterion<Dune::Amg::SymmetricCriterion<PressureMatrix, Dune::Amg::FirstDiagonal> >;
+        CoarsenCriterion coarsenCriterion(/*maxLevel=*/15, coarsenTarget);
+        coarsenCriterion.setDefaultValuesIsotropic(/*dim=*/3, /*aggregateSizePerDim=*/2);
+        coarsenCriterion.setDebugLevel(0);
+        coarsenCriterion.setMinCoarsenRate(1.05);
+        coarsenCriterion.setAccumulate(Dune::Amg::atOnceAccu);
+        coarsenCriterion.setSkipIsolated(false);
+
+        pressureOperator_ = std::make_unique<PressureOperator>(*pressureMatrix_);
+        amg_ = std::make_unique<PressureAmg>(*pressureOperator_, coarsenCriterion, smootherArgs);
+    }
+
+    const Matrix& matrix_;
+    unsigned pressureVarIdx_;
+
+    std::vector<VectorBlock> weights_;
+    std::unique_ptr<PressureMatrix> pressureMatrix_;
+    std::unique_ptr<PressureOperator> pressureOperator_;
+    std::unique_ptr<PressureAmg> amg_;
+    ParallelILU0<Matrix, DomainVector, RangeVector> smoother_;
+
+    PressureVector pressureDefect_;
+    PressureVector pressureCorrection_;
+    std::unique_ptr<RangeVector> defect_;
+    std::unique_ptr<DomainVector> correction_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
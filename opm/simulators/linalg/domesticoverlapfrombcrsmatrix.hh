@@ -373,6 +373,33 @@ public:
         return mapInternalToExternal_(internalIdx);
     }
 
+    /*!
+     * \brief Returns an estimate of the number of bytes held by the index structures
+     *        of the overlap.
+     *
+     * This accounts for the data which is stored for each domestic index, but not for
+     * the foreign overlap and the communication buffers.
+     */
+    size_t memoryUsage() const
+    {
+        // besides the value, each node of a std::map stores three pointers and a color
+        const size_t mapNodeOverhead = 4*sizeof(void*);
+
+        size_t result = domesticOverlapByIndex_.capacity()*sizeof(OverlapByIndex::value_type);
+        for (const auto& peerDistances : domesticOverlapByIndex_)
+            result += peerDistances.size()*(sizeof(std::pair<const ProcessRank, BorderDistance>)
+                                            + mapNodeOverhead);
+        for (const auto& peerOverlap : domesticOverlapWithPeer_)
+            result += peerOverlap.second.capacity()*sizeof(Index);
+        result += borderDistance_.capacity()*sizeof(BorderDistance);
+        result += masterRank_.capacity()*sizeof(ProcessRank);
+
+        // the global indices map each domestic index to its global one and back
+        result += numDomestic()*(3*sizeof(Index) + mapNodeOverhead);
+
+        return result;
+    }
+
 protected:
     void buildDomesticOverlap_()
     {
@@ -0,0 +1,536 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::FGMResSolver
+ */
+#ifndef EWOMS_FGMRES_SOLVER_HH
+#define EWOMS_FGMRES_SOLVER_HH
+
+#include "convergencecriterion.hh"
+#include "linearsolverreport.hh"
+
+#include <opm/models/utils/timer.hh>
+#include <opm/models/utils/timerguard.hh>
+
+#include <opm/common/Exceptions.hpp>
+
+#include <dune/istl/scalarproducts.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief The vectors which are kept by FGMResSolver between consecutive solves.
+ *
+ * Besides the recycled subspace, this contains the Krylov bases of the solver, so
+ * that they do not need to be allocated for each linear system. The object must be
+ * cleared if the size of the vectors changes.
+ */
+template <class Vector>
+struct FGMResRecycleSpace
+{
+    //! The recycled directions in the solution space
+    std::deque<Vector> u;
+
+    //! The images of the recycled directions, i.e., c_i = A*u_i, which are orthonormal
+    std::deque<Vector> c;
+
+    //! The Arnoldi basis of the last restart cycle
+    std::vector<Vector> v;
+
+    //! The preconditioned Arnoldi basis of the last restart cycle
+    std::vector<Vector> z;
+
+    void clear()
+    {
+        u.clear();
+        c.clear();
+        v.clear();
+        z.clear();
+    }
+};
+
+/*!
+ * \brief Implements a restarted flexible GMRES linear solver which recycles a
+ *        subspace between consecutive linear systems.
+ *
+ * This solves a linear system of equations Ax = b, where the matrix A is sparse and may
+ * be unsymmetric. The preconditioner is applied from the right and may change between
+ * iterations.
+ *
+ * The solver follows the GCRO approach: The residual is kept orthogonal to the span
+ * of the vectors c_i = A*u_i of a recycled subspace U, and the Arnoldi vectors of each
+ * restart cycle are orthogonalized against these vectors as well. At the end of each
+ * restart cycle, the correction of the solution is added to U, i.e., like for GCROT,
+ * U consists of the most recent outer correction directions. Since these directions
+ * approximate the slowly converging components of the error, they are kept for the
+ * next linear system; this pays off if consecutive systems only differ slightly, as
+ * it is the case for the linear systems of a Newton sequence. When a new linear
+ * system is solved, the vectors c_i are recomputed for the new matrix.
+ *
+ * See:
+ *
+ * E. de Sturler: "Truncation strategies for optimal Krylov subspace methods", SIAM
+ * Journal on Numerical Analysis, 36(3), pp. 864-889, 1999
+ *
+ * M. Parks et al.: "Recycling Krylov subspaces for sequences of linear systems", SIAM
+ * Journal on Scientific Computing, 28(5), pp. 1651-1674, 2006
+ */
+template <class LinearOperator, class Vector, class Preconditioner>
+class FGMResSolver
+{
+    using ConvergenceCriterion = Opm::Linear::ConvergenceCriterion<Vector>;
+    using RecycleSpace = FGMResRecycleSpace<Vector>;
+    using Scalar = typename LinearOperator::field_type;
+
+public:
+    FGMResSolver(Preconditioner& preconditioner,
+                 ConvergenceCriterion& convergenceCriterion,
+                 Dune::ScalarProduct<Vector>& scalarProduct,
+                 RecycleSpace& recycleSpace)
+        : preconditioner_(preconditioner)
+        , convergenceCriterion_(convergenceCriterion)
+        , scalarProduct_(scalarProduct)
+        , recycleSpace_(recycleSpace)
+    {
+        A_ = nullptr;
+        b_ = nullptr;
+
+        maxIterations_ = 1000;
+        restart_ = 30;
+        maxRecycledVectors_ = 5;
+        innerTolerance_ = 1e-3;
+        verbosity_ = 0;
+        useInitialGuess_ = false;
+    }
+
+    /*!
+     * \brief Set the maximum number of iterations before we give up without achieving
+     *        convergence.
+     */
+    void setMaxIterations(unsigned value)
+    { maxIterations_ = value; }
+
+    /*!
+     * \brief Return the maximum number of iterations before we give up without achieving
+     *        convergence.
+     */
+    unsigned maxIterations() const
+    { return maxIterations_; }
+
+    /*!
+     * \brief Set the number of iterations after which the solver is restarted.
+     */
+    void setRestart(unsigned value)
+    { restart_ = std::max(value, 1u); }
+
+    /*!
+     * \brief Set the maximum number of vectors of the recycled subspace.
+     *
+     * If this is zero, the solver is a plain restarted flexible GMRES method.
+     */
+    void setMaxRecycledVectors(unsigned value)
+    { maxRecycledVectors_ = value; }
+
+    /*!
+     * \brief Set the reduction of the two-norm of the residual after which a restart
+     *        cycle is finished early.
+     *
+     * The convergence criterion requires the residual vector, which is only available
+     * at the end of a restart cycle. This tolerance decides when it is worth to
+     * evaluate the criterion before the cycle is complete.
+     */
+    void setInnerTolerance(Scalar value)
+    { innerTolerance_ = value; }
+
+    /*!
+     * \brief Specify whether the vector passed to apply() is used as initial solution.
+     *
+     * \copydetails BiCGStabSolver::setUseInitialGuess()
+     */
+    void setUseInitialGuess(bool value)
+    { useInitialGuess_ = value; }
+
+    /*!
+     * \brief Set the verbosity level of the linear solver
+     *
+     * The levels correspont to those used by the dune-istl solvers:
+     *
+     * - 0: no output
+     * - 1: summary output at the end of the solution proceedure (if no exception was
+     *      thrown)
+     * - 2: detailed output after each restart cycle
+     */
+    void setVerbosity(unsigned value)
+    { verbosity_ = value; }
+
+    /*!
+     * \brief Return the verbosity level of the linear solver.
+     */
+    unsigned verbosity() const
+    { return verbosity_; }
+
+    /*!
+     * \brief Set the matrix "A" of the linear system.
+     */
+    void setLinearOperator(const LinearOperator* A)
+    { A_ = A; }
+
+    /*!
+     * \brief Set the right hand side "b" of the linear system.
+     */
+    void setRhs(const Vector* b)
+    { b_ = b; }
+
+    /*!
+     * \brief Run the solver and store the result into the "x" vector.
+     */
+    bool apply(Vector& x)
+    {
+        // epsilon used for detecting breakdowns
+        const Scalar breakdownEps = std::numeric_limits<Scalar>::min() * Scalar(1e10);
+
+        report_.reset();
+        report_.incrementSolves();
+        TimerGuard reportTimerGuard(report_.timer());
+        report_.timer().start();
+
+        std::optional<Vector> guess;
+        if (useInitialGuess_)
+            guess.emplace(x);
+        x = 0.0;
+
+        // like BiCGStabSolver, we assume that the preconditioner does not change the
+        // initial solution if it is a zero vector.
+        Vector rhs(*b_);
+        report_.preconditionerSetupTimer().start();
+        preconditioner_.pre(x, rhs);
+        report_.preconditionerSetupTimer().stop();
+
+        Vector r(rhs);
+        convergenceCriterion_.setInitial(x, r);
+        if (guess)
+            applyInitialGuess_(x, r, *guess);
+        report_.addResidual(convergenceCriterion_.accuracy());
+        if (convergenceCriterion_.converged()) {
+            report_.setConverged(true);
+            return report_.converged();
+        }
+
+        if (verbosity_ > 0) {
+            std::cout << "-------- FGMResSolver --------" << std::endl;
+            convergenceCriterion_.printInitial();
+        }
+
+        // the matrix has changed since the last solve, so the images of the recycled
+        // directions need to be recomputed
+        updateRecycleSpace_();
+
+        const unsigned m = restart_;
+        auto& V = recycleSpace_.v;
+        auto& Z = recycleSpace_.z;
+        if (V.size() != m + 1 || V.front().size() != x.size()) {
+            V.assign(m + 1, x);
+            Z.assign(m, x);
+        }
+
+        std::vector<std::vector<Scalar>> H(m + 1, std::vector<Scalar>(m, 0.0));
+        std::vector<std::vector<Scalar>> B;
+        std::vector<Scalar> cs(m), sn(m), g(m + 1), y(m);
+        Vector dx(x);
+        Vector rOld(r);
+
+        const Scalar initialNorm = scalarProduct_.norm(rhs);
+        while (report_.iterations() < maxIterations_) {
+            // make the residual orthogonal to the recycled subspace
+            const std::size_t k = recycleSpace_.c.size();
+            for (std::size_t i = 0; i < k; ++i) {
+                const Scalar alpha = dot_(recycleSpace_.c[i], r);
+                x.axpy(alpha, recycleSpace_.u[i]);
+                r.axpy(-alpha, recycleSpace_.c[i]);
+            }
+            rOld = r;
+
+            const Scalar beta = scalarProduct_.norm(r);
+            if (beta <= breakdownEps)
+                break;
+
+            // if the residual is already below the tolerance for the two-norm but the
+            // convergence criterion is not met, require a further reduction
+            Scalar cycleTolerance = innerTolerance_*initialNorm;
+            if (beta <= cycleTolerance)
+                cycleTolerance = innerTolerance_*beta;
+
+            V[0] = r;
+            V[0] *= 1.0/beta;
+            std::fill(g.begin(), g.end(), 0.0);
+            g[0] = beta;
+            B.assign(k, std::vector<Scalar>(m, 0.0));
+
+            // the Arnoldi process
+            unsigned j = 0;
+            while (j < m && report_.iterations() < maxIterations_) {
+                applyPreconditioner_(Z[j], V[j]);
+                Vector& w = V[j + 1];
+                applyOperator_(Z[j], w);
+
+                for (std::size_t i = 0; i < k; ++i) {
+                    B[i][j] = dot_(recycleSpace_.c[i], w);
+                    w.axpy(-B[i][j], recycleSpace_.c[i]);
+                }
+                for (unsigned i = 0; i <= j; ++i) {
+                    H[i][j] = dot_(V[i], w);
+                    w.axpy(-H[i][j], V[i]);
+                }
+                H[j + 1][j] = scalarProduct_.norm(w);
+                const bool breakdown = H[j + 1][j] <= breakdownEps;
+                if (!breakdown)
+                    w *= 1.0/H[j + 1][j];
+
+                // apply the previous Givens rotations to the new column and compute
+                // the one which eliminates its subdiagonal entry
+                for (unsigned i = 0; i < j; ++i) {
+                    const Scalar tmp = cs[i]*H[i][j] + sn[i]*H[i + 1][j];
+                    H[i + 1][j] = -sn[i]*H[i][j] + cs[i]*H[i + 1][j];
+                    H[i][j] = tmp;
+                }
+                const Scalar denom = std::hypot(H[j][j], H[j + 1][j]);
+                if (denom <= breakdownEps)
+                    throw NumericalProblem("Breakdown of the FGMRES solver (singular Hessenberg matrix)");
+                cs[j] = H[j][j]/denom;
+                sn[j] = H[j + 1][j]/denom;
+                H[j][j] = denom;
+                H[j + 1][j] = 0.0;
+                g[j + 1] = -sn[j]*g[j];
+                g[j] = cs[j]*g[j];
+
+                report_.increment();
+                ++j;
+
+                if (breakdown || std::abs(g[j]) <= cycleTolerance)
+                    break;
+            }
+
+            // solve the least squares problem, i.e., H*y = g, for the upper triangular
+            // matrix H
+            for (int i = static_cast<int>(j) - 1; i >= 0; --i) {
+                Scalar tmp = g[i];
+                for (unsigned l = i + 1; l < j; ++l)
+                    tmp -= H[i][l]*y[l];
+                y[i] = tmp/H[i][i];
+            }
+
+            // dx = Z*y - U*B*y. then, A*dx is in the span of the Arnoldi basis
+            dx = 0.0;
+            for (unsigned l = 0; l < j; ++l)
+                dx.axpy(y[l], Z[l]);
+            for (std::size_t i = 0; i < k; ++i) {
+                Scalar tmp = 0.0;
+                for (unsigned l = 0; l < j; ++l)
+                    tmp += B[i][l]*y[l];
+                dx.axpy(-tmp, recycleSpace_.u[i]);
+            }
+            x += dx;
+
+            // compute the true residual to avoid a drift of the recursively updated one
+            r = rhs;
+            report_.spmvTimer().start();
+            A_->applyscaleadd(/*alpha=*/-1.0, x, r);
+            report_.spmvTimer().stop();
+
+            // A*dx = rOld - r is the new direction of the recycled subspace
+            rOld -= r;
+            addRecycledVector_(dx, rOld);
+
+            convergenceCriterion_.update(/*curSol=*/x, /*delta=*/dx, r);
+            report_.addResidual(convergenceCriterion_.accuracy());
+            if (convergenceCriterion_.converged() || convergenceCriterion_.failed()) {
+                if (verbosity_ > 0) {
+                    convergenceCriterion_.print(report_.iterations());
+                    std::cout << "-------- /FGMResSolver --------" << std::endl;
+                }
+
+                report_.setConverged(convergenceCriterion_.converged());
+                if (report_.converged())
+                    preconditioner_.post(x);
+                return report_.converged();
+            }
+
+            if (verbosity_ > 1)
+                convergenceCriterion_.print(report_.iterations());
+        }
+
+        report_.setConverged(false);
+        return report_.converged();
+    }
+
+    const SolverReport& report() const
+    { return report_; }
+
+private:
+    // recompute c_i = A*u_i for the current matrix and make the c_i orthonormal. the
+    // same linear combinations are applied to the u_i, so that c_i = A*u_i still holds.
+    void updateRecycleSpace_()
+    {
+        auto& U = recycleSpace_.u;
+        auto& C = recycleSpace_.c;
+        if (maxRecycledVectors_ == 0 || (!U.empty() && U.front().size() != b_->size())) {
+            U.clear();
+            C.clear();
+            return;
+        }
+
+        for (std::size_t i = 0; i < U.size(); ++i)
+            applyOperator_(U[i], C[i]);
+
+        std::size_t i = 0;
+        while (i < C.size()) {
+            for (std::size_t l = 0; l < i; ++l) {
+                const Scalar alpha = dot_(C[l], C[i]);
+                C[i].axpy(-alpha, C[l]);
+                U[i].axpy(-alpha, U[l]);
+            }
+
+            const Scalar norm = scalarProduct_.norm(C[i]);
+            if (norm <= std::numeric_limits<Scalar>::epsilon()) {
+                // the direction is linearly dependent on the previous ones
+                C.erase(C.begin() + i);
+                U.erase(U.begin() + i);
+                continue;
+            }
+
+            C[i] *= 1.0/norm;
+            U[i] *= 1.0/norm;
+            ++i;
+        }
+    }
+
+    // add a direction u and its image c = A*u to the recycled subspace. the oldest
+    // direction is dropped if the maximum size of the subspace is exceeded.
+    void addRecycledVector_(const Vector& u, const Vector& c)
+    {
+        if (maxRecycledVectors_ == 0)
+            return;
+
+        auto& U = recycleSpace_.u;
+        auto& C = recycleSpace_.c;
+        if (U.size() >= maxRecycledVectors_) {
+            U.pop_front();
+            C.pop_front();
+        }
+
+        U.push_back(u);
+        C.push_back(c);
+        Vector& newU = U.back();
+        Vector& newC = C.back();
+        const Scalar initialNorm = scalarProduct_.norm(newC);
+        for (std::size_t l = 0; l + 1 < C.size(); ++l) {
+            const Scalar alpha = dot_(C[l], newC);
+            newC.axpy(-alpha, C[l]);
+            newU.axpy(-alpha, U[l]);
+        }
+
+        const Scalar norm = scalarProduct_.norm(newC);
+        if (norm <= std::sqrt(std::numeric_limits<Scalar>::epsilon())*initialNorm) {
+            U.pop_back();
+            C.pop_back();
+            return;
+        }
+
+        newC *= 1.0/norm;
+        newU *= 1.0/norm;
+    }
+
+    // replace the zero initial solution by a guess, see BiCGStabSolver
+    void applyInitialGuess_(Vector& x, Vector& r, const Vector& guess)
+    {
+        x = guess;
+        report_.spmvTimer().start();
+        A_->applyscaleadd(/*alpha=*/-1.0, x, r);
+        report_.spmvTimer().stop();
+        convergenceCriterion_.update(/*curSol=*/x, /*delta=*/x, r);
+        if (convergenceCriterion_.accuracy() <= 1.0)
+            return;
+
+        report_.spmvTimer().start();
+        A_->applyscaleadd(/*alpha=*/1.0, x, r);
+        report_.spmvTimer().stop();
+        x = 0.0;
+        convergenceCriterion_.setInitial(x, r);
+    }
+
+    // the following methods record the time spent for the respective operation in
+    // the report
+    void applyPreconditioner_(Vector& x, const Vector& d)
+    {
+        report_.preconditionerApplyTimer().start();
+        preconditioner_.apply(x, d);
+        report_.preconditionerApplyTimer().stop();
+    }
+
+    void applyOperator_(const Vector& x, Vector& y)
+    {
+        report_.spmvTimer().start();
+        A_->apply(x, y);
+        report_.spmvTimer().stop();
+    }
+
+    Scalar dot_(const Vector& x, const Vector& y)
+    {
+        report_.dotTimer().start();
+        Scalar result = scalarProduct_.dot(x, y);
+        report_.dotTimer().stop();
+        return result;
+    }
+
+    const LinearOperator* A_;
+    const Vector* b_;
+
+    Preconditioner& preconditioner_;
+    ConvergenceCriterion& convergenceCriterion_;
+    Dune::ScalarProduct<Vector>& scalarProduct_;
+    RecycleSpace& recycleSpace_;
+    SolverReport report_;
+
+    unsigned maxIterations_;
+    unsigned restart_;
+    unsigned maxRecycledVectors_;
+    Scalar innerTolerance_;
+    unsigned verbosity_;
+    bool useInitialGuess_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
@@ -40,6 +40,8 @@
 #include <algorithm>
 #include <iostream>
 #include <map>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #if HAVE_MPI
@@ -90,6 +92,7 @@ public:
 
         // calculate the set of local indices on the border (beware:
         // _not_ the native ones)
+        isLocalBorderIndex_.resize(numLocal_, 0);
         auto it = borderList.begin();
         const auto& endIt = borderList.end();
         for (; it != endIt; ++it) {
@@ -97,9 +100,16 @@ public:
             if (localIdx < 0)
                 continue;
 
-            localBorderIndices_.insert(localIdx);
+            isLocalBorderIndex_[static_cast<unsigned>(localIdx)] = 1;
         }
 
+        // the border indices sorted by their index and their peer rank, which allows
+        // to look up the index of a border index on a peer process
+        sortedBorderIndices_.assign(borderList.begin(), borderList.end());
+        std::stable_sort(sortedBorderIndices_.begin(), sortedBorderIndices_.end(),
+                         [](const BorderIndex& a, const BorderIndex& b)
+                         { return std::tie(a.localIdx, a.peerRank) < std::tie(b.localIdx, b.peerRank); });
+
         // compute the set of processes which are neighbors of the
         // local process ...
         neighborPeerSet_.update(borderList);
@@ -147,7 +157,11 @@ public:
      * \brief Returns true iff a local index is a border index.
      */
     bool isBorder(Index localIdx) const
-    { return localBorderIndices_.count(localIdx) > 0; }
+    {
+        return localIdx >= 0
+            && static_cast<std::size_t>(localIdx) < isLocalBorderIndex_.size()
+            && isLocalBorderIndex_[static_cast<unsigned>(localIdx)];
+    }
 
     /*!
      * \brief Returns true iff a local index is a border index shared with a
@@ -400,21 +414,8 @@ protected:
                 else if (foreignOverlapByLocalIndex_[static_cast<unsigned>(localColIdx)].count(peerRank) > 0)
                     continue;
 
-                // check whether the new index is already in the overlap
-                bool hasIndex = false;
-                typename SeedList::iterator sIt = nextSeedList.begin();
-                typename SeedList::iterator sEndIt = nextSeedList.end();
-                for (; sIt != sEndIt; ++sIt) {
-                    if (sIt->index == nativeColIdx && sIt->peerRank == peerRank) {
-                        hasIndex = true;
-                        break;
-                    }
-                }
-                if (hasIndex)
-                    continue; // we already have this index
-
                 // add the current processes to the seed list for the
-                // next overlap level
+                // next overlap level. duplicates are removed below
                 IndexRankDist newTuple;
                 newTuple.index = nativeColIdx;
                 newTuple.peerRank = peerRank;
@@ -423,6 +424,10 @@ protected:
             }
         }
 
+        // remove the duplicate (index, peer rank) pairs of the next seed list. the
+        // first occurrence of each pair is kept.
+        removeDuplicateSeeds_(nextSeedList);
+
         // clear the old seed list to save some memory
         seedList.clear();
 
@@ -453,14 +458,27 @@ protected:
 
     Index localToPeerIdx_(Index localIdx, ProcessRank peerRank) const
     {
-        auto it = borderList_.begin();
-        const auto& endIt = borderList_.end();
-        for (; it != endIt; ++it) {
-            if (it->localIdx == localIdx && it->peerRank == peerRank)
-                return it->peerIdx;
-        }
+        auto it = std::lower_bound(sortedBorderIndices_.begin(), sortedBorderIndices_.end(),
+                                   std::make_tuple(localIdx, peerRank),
+                                   [](const BorderIndex& a, const std::tuple<Index, ProcessRank>& b)
+                                   { return std::tie(a.localIdx, a.peerRank) < b; });
+        if (it == sortedBorderIndices_.end() || it->localIdx != localIdx || it->peerRank != peerRank)
+            return -1;
+
+        return it->peerIdx;
+    }
 
-        return -1;
+    // sort a seed list by index and peer rank and remove all but the first entry of
+    // each (index, peer rank) pair.
+    static void removeDuplicateSeeds_(SeedList& seedList)
+    {
+        const auto less = [](const IndexRankDist& a, const IndexRankDist& b)
+        { return std::tie(a.index, a.peerRank) < std::tie(b.index, b.peerRank); };
+        const auto equal = [](const IndexRankDist& a, const IndexRankDist& b)
+        { return a.index == b.index && a.peerRank == b.peerRank; };
+
+        std::stable_sort(seedList.begin(), seedList.end(), less);
+        seedList.erase(std::unique(seedList.begin(), seedList.end(), equal), seedList.end());
     }
 
     template <class BCRSMatrix>
@@ -542,7 +560,15 @@ protected:
             indicesSendBufs[neighborPeer].send(neighborPeer);
         }
 
+        // the (index, peer rank) pairs which are already in the seed list
+        std::vector<std::pair<Index, ProcessRank>> seedKeys;
+        seedKeys.reserve(seedList.size());
+        for (const auto& seed : seedList)
+            seedKeys.emplace_back(seed.index, seed.peerRank);
+        std::sort(seedKeys.begin(), seedKeys.end());
+
         // receive all data from the neighbors
+        SeedList newSeeds;
         std::map<ProcessRank, MpiBuffer<unsigned> > numIndicesRcvBufs;
         std::map<ProcessRank, MpiBuffer<BorderIndex> > indicesRcvBufs;
         peerIt = neighborPeerSet().begin();
@@ -576,29 +602,26 @@ protected:
                     continue;
 
                 // make sure the index is not already in the seed list
-                bool inSeedList = false;
-                auto seedIt = seedList.begin();
-                const auto& seedEndIt = seedList.end();
-                for (; seedIt != seedEndIt; ++seedIt) {
-                    if (seedIt->index == localIdx && seedIt->peerRank == peerRank) {
-                        inSeedList = true;
-                        break;
-                    }
-                }
-                if (inSeedList)
+                if (std::binary_search(seedKeys.begin(), seedKeys.end(),
+                                       std::make_pair(localIdx, peerRank)))
                     continue;
 
                 IndexRankDist seedEntry;
                 seedEntry.index = localIdx;
                 seedEntry.peerRank = peerRank;
                 seedEntry.borderDistance = borderDist;
-                seedList.push_back(seedEntry);
-
-                // update the peer set
-                peerSet_.insert(peerRank);
+                newSeeds.push_back(seedEntry);
             }
         }
 
+        // add the new indices to the seed list, but each of them only once, and
+        // update the peer set
+        removeDuplicateSeeds_(newSeeds);
+        for (const auto& seed : newSeeds) {
+            seedList.push_back(seed);
+            peerSet_.insert(seed.peerRank);
+        }
+
         // make sure all data was send
         peerIt = neighborPeerSet().begin();
         for (; peerIt != peerEndIt; ++peerIt) {
@@ -679,9 +702,12 @@ protected:
     // index
     std::vector<ProcessRank> masterRank_;
 
-    // set of all local indices which are on the border of some remote
+    // specifies for each local index whether it is on the border of some remote
     // process
-    std::set<Index> localBorderIndices_;
+    std::vector<unsigned char> isLocalBorderIndex_;
+
+    // the border list sorted by local index and peer rank
+    std::vector<BorderIndex> sortedBorderIndices_;
 
     // stores the set of process ranks which are in the overlap for a
     // given row index "owned" by the current rank. The second value
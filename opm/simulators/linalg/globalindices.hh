@@ -33,10 +33,10 @@
 #include <dune/istl/operators.hh>
 
 #include <algorithm>
-#include <set>
 #include <map>
 #include <iostream>
 #include <tuple>
+#include <vector>
 
 #if HAVE_MPI
 #include <mpi.h>
@@ -56,8 +56,11 @@ class GlobalIndices
 {
     GlobalIndices(const GlobalIndices& ) = delete;
 
-    using GlobalToDomesticMap = std::map<Index, Index>;
-    using DomesticToGlobalMap = std::map<Index, Index>;
+    // the domestic indices are dense, so the global index of each of them is stored
+    // in an array. the global indices are spread over all processes and are mapped to
+    // domestic ones by a hash table.
+    using GlobalToDomesticMap = IndexMap;
+    using DomesticToGlobalMap = std::vector<Index>;
 
 public:
     GlobalIndices(const ForeignOverlap& foreignOverlap)
@@ -87,23 +90,17 @@ public:
      */
     Index domesticToGlobal(Index domesticIdx) const
     {
-        assert(domesticToGlobal_.find(domesticIdx) != domesticToGlobal_.end());
+        assert(0 <= domesticIdx && domesticIdx < static_cast<Index>(domesticToGlobal_.size()));
+        assert(domesticToGlobal_[static_cast<unsigned>(domesticIdx)] >= 0);
 
-        return domesticToGlobal_.find(domesticIdx)->second;
+        return domesticToGlobal_[static_cast<unsigned>(domesticIdx)];
     }
 
     /*!
      * \brief Converts a global index to a domestic one.
      */
     Index globalToDomestic(Index globalIdx) const
-    {
-        const auto& tmp = globalToDomestic_.find(globalIdx);
-
-        if (tmp == globalToDomestic_.end())
-            return -1;
-
-        return tmp->second;
-    }
+    { return globalToDomestic_.find(globalIdx); }
 
     /*!
      * \brief Returns the number of indices which are in the interior or
@@ -126,11 +123,16 @@ public:
      */
     void addIndex(Index domesticIdx, Index globalIdx)
     {
-        domesticToGlobal_[domesticIdx] = globalIdx;
-        globalToDomestic_[globalIdx] = domesticIdx;
-        numDomestic_ = domesticToGlobal_.size();
+        if (static_cast<std::size_t>(domesticIdx) >= domesticToGlobal_.size())
+            domesticToGlobal_.resize(static_cast<std::size_t>(domesticIdx) + 1, -1);
+
+        Index& dest = domesticToGlobal_[static_cast<unsigned>(domesticIdx)];
+        if (dest < 0)
+            ++numDomestic_;
+        dest = globalIdx;
+        globalToDomestic_.set(globalIdx, domesticIdx);
 
-        assert(domesticToGlobal_.size() == globalToDomestic_.size());
+        assert(numDomestic_ == globalToDomestic_.size());
     }
 
     /*!
@@ -181,7 +183,7 @@ public:
      * \brief Return true iff a given global index already exists
      */
     bool hasGlobalIndex(Index globalIdx) const
-    { return globalToDomestic_.find(globalIdx) != globalToDomestic_.end(); }
+    { return globalToDomestic_.contains(globalIdx); }
 
     /*!
      * \brief Prints the global indices of all domestic indices
@@ -192,7 +194,7 @@ public:
         std::cout << "(domestic index, global index, domestic->global->domestic)"
                   << " list for rank " << myRank_ << "\n";
 
-        for (size_t domIdx = 0; domIdx < domesticToGlobal_.size(); ++domIdx)
+        for (size_t domIdx = 0; domIdx < numDomestic_; ++domIdx)
             std::cout << "(" << domIdx << ", " << domesticToGlobal(domIdx)
                       << ", " << globalToDomestic(domesticToGlobal(domIdx)) << ") ";
         std::cout << "\n" << std::flush;
@@ -210,25 +212,31 @@ protected:
 #endif
 
 #if HAVE_MPI
-        if (myRank_ == 0) {
-            // the first rank starts at index zero
-            domesticOffset_ = 0;
-        }
-        else {
-            // all other ranks retrieve their offset from the next
-            // lower rank
-            MPI_Recv(&domesticOffset_, // buffer
-                     1,                // count
-                     MPI_INT,          // data type
-                     static_cast<int>(myRank_ - 1), // peer rank
-                     0,                // tag
-                     MPI_COMM_WORLD,   // communicator
-                     MPI_STATUS_IGNORE);
+        // count the indices for which the current process is the master
+        int numMaster = 0;
+        for (unsigned i = 0; i < foreignOverlap_.numLocal(); ++i) {
+            if (foreignOverlap_.iAmMasterOf(static_cast<Index>(i)))
+                ++numMaster;
         }
 
+        // the offset of our master indices is the number of master indices of all
+        // lower ranks
+        domesticOffset_ = 0;
+        MPI_Exscan(&numMaster,      // send buffer
+                   &domesticOffset_, // receive buffer
+                   1,               // count
+                   MPI_INT,         // data type
+                   MPI_SUM,         // operation
+                   MPI_COMM_WORLD); // communicator
+        if (myRank_ == 0)
+            // the result of MPI_Exscan is undefined on the first rank
+            domesticOffset_ = 0;
+
         // create maps for all indices for which the current process
-        // is the master
-        int numMaster = 0;
+        // is the master. all local indices get a global one eventually
+        domesticToGlobal_.reserve(foreignOverlap_.numLocal());
+        globalToDomestic_.reserve(foreignOverlap_.numLocal());
+        numMaster = 0;
         for (unsigned i = 0; i < foreignOverlap_.numLocal(); ++i) {
             if (!foreignOverlap_.iAmMasterOf(static_cast<Index>(i)))
                 continue;
@@ -238,55 +246,57 @@ protected:
             ++numMaster;
         }
 
-        if (myRank_ < mpiSize_ - 1) {
-            // send the domestic offset plus the number of master
-            // indices to the process which is one rank higher
-            int tmp = domesticOffset_ + numMaster;
-            MPI_Send(&tmp,            // buff
-                     1,               // count
-                     MPI_INT,         // data type
-                     static_cast<int>(myRank_ + 1), // peer rank
-                     0,               // tag
-                     MPI_COMM_WORLD); // communicator
-        }
-
-        typename PeerSet::const_iterator peerIt;
-        typename PeerSet::const_iterator peerEndIt = peerSet_().end();
-        // receive the border indices from the lower ranks
-        peerIt = peerSet_().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            if (*peerIt < myRank_)
-                receiveBorderFrom_(*peerIt);
+        // exchange the global indices of the border indices with all peers at
+        // once. the global indices of the indices of which we are the master are
+        // known at this point, so there are no dependencies between the peers.
+        std::map<ProcessRank, std::vector<PeerIndexGlobalIndex> > sendBufs;
+        std::map<ProcessRank, std::vector<PeerIndexGlobalIndex> > recvBufs;
+        for (const auto peerRank : peerSet_()) {
+            sendBufs[peerRank] = borderIndicesFor_(peerRank);
+            recvBufs[peerRank].resize(numBorderIndicesFrom_(peerRank));
         }
 
-        // send the border indices to the higher ranks
-        peerIt = peerSet_().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            if (*peerIt > myRank_)
-                sendBorderTo_(*peerIt);
+        std::vector<MPI_Request> requests;
+        requests.reserve(2*peerSet_().size());
+        for (auto& [peerRank, recvBuf] : recvBufs) {
+            requests.emplace_back();
+            MPI_Irecv(recvBuf.data(),                                            // buff
+                      static_cast<int>(recvBuf.size()*sizeof(PeerIndexGlobalIndex)), // count
+                      MPI_BYTE,                                                  // data type
+                      static_cast<int>(peerRank),                                // peer process
+                      0,                                                         // tag
+                      MPI_COMM_WORLD,                                            // communicator
+                      &requests.back());                                         // request
         }
-
-        // receive the border indices from the higher ranks
-        peerIt = peerSet_().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            if (*peerIt > myRank_)
-                receiveBorderFrom_(*peerIt);
+        for (auto& [peerRank, sendBuf] : sendBufs) {
+            requests.emplace_back();
+            MPI_Isend(sendBuf.data(),                                            // buff
+                      static_cast<int>(sendBuf.size()*sizeof(PeerIndexGlobalIndex)), // count
+                      MPI_BYTE,                                                  // data type
+                      static_cast<int>(peerRank),                                // peer process
+                      0,                                                         // tag
+                      MPI_COMM_WORLD,                                            // communicator
+                      &requests.back());                                         // request
         }
-
-        // send the border indices to the lower ranks
-        peerIt = peerSet_().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            if (*peerIt < myRank_)
-                sendBorderTo_(*peerIt);
+        MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+
+        // add the border indices received from the peers to the translation maps
+        for (const auto& [peerRank, recvBuf] : recvBufs) {
+            for (const auto& recvEntry : recvBuf) {
+                Index domesticIdx = foreignOverlap_.nativeToLocal(recvEntry.peerIdx);
+                if (domesticIdx >= 0)
+                    addIndex(domesticIdx, recvEntry.globalIdx);
+            }
         }
 #endif // HAVE_MPI
     }
 
-    void sendBorderTo_([[maybe_unused]] ProcessRank peerRank)
+    // returns the (index on peer, global index) pairs of all border indices shared
+    // with a peer of which we are the master
+    std::vector<PeerIndexGlobalIndex> borderIndicesFor_([[maybe_unused]] ProcessRank peerRank) const
     {
+        std::vector<PeerIndexGlobalIndex> result;
 #if HAVE_MPI
-        // send (local index on myRank, global index) pairs to the
-        // peers
         BorderList::const_iterator borderIt = borderList_().begin();
         BorderList::const_iterator borderEndIt = borderList_().end();
         for (; borderIt != borderEndIt; ++borderIt) {
@@ -296,20 +306,24 @@ protected:
                 continue;
 
             Index localIdx = foreignOverlap_.nativeToLocal(borderIt->localIdx);
-            Index peerIdx = borderIt->peerIdx;
             assert(localIdx >= 0);
             if (foreignOverlap_.iAmMasterOf(localIdx)) {
-                sendBorderIndex(borderPeer, localIdx, peerIdx);
+                PeerIndexGlobalIndex entry;
+                entry.peerIdx = borderIt->peerIdx;
+                entry.globalIdx = domesticToGlobal(localIdx);
+                result.push_back(entry);
             }
         }
 #endif // HAVE_MPI
+        return result;
     }
 
-    void receiveBorderFrom_([[maybe_unused]] ProcessRank peerRank)
+    // returns the number of border indices shared with a peer of which the peer is
+    // the master, i.e., the number of indices which the peer sends to us
+    std::size_t numBorderIndicesFrom_([[maybe_unused]] ProcessRank peerRank) const
     {
+        std::size_t result = 0;
 #if HAVE_MPI
-        // retrieve the global indices for which we are not master
-        // from the processes with lower rank
         BorderList::const_iterator borderIt = borderList_().begin();
         BorderList::const_iterator borderEndIt = borderList_().end();
         for (; borderIt != borderEndIt; ++borderIt) {
@@ -321,9 +335,10 @@ protected:
             Index nativeIdx = borderIt->localIdx;
             Index localIdx = foreignOverlap_.nativeToLocal(nativeIdx);
             if (localIdx >= 0 && foreignOverlap_.masterRank(localIdx) == borderPeer)
-                receiveBorderIndex(borderPeer);
+                ++result;
         }
 #endif // HAVE_MPI
+        return result;
     }
 
     const PeerSet& peerSet_() const
@@ -40,6 +40,11 @@
  * - \c SOR: A successive overrelaxation (SOR) preconditioner
  * - \c ILUn: An ILU(n) preconditioner
  * - \c ILU0: A specialized (and optimized) ILU(0) preconditioner
+ * - \c MixedPrecisionILU: An ILU preconditioner which operates on a single precision
+ *                         copy of the matrix
+ * - \c ParallelILU0: An ILU(0) preconditioner which uses multiple threads
+ * - \c CPR: A two-stage preconditioner which solves a pressure system using AMG
+ *           followed by an ILU(0) smoother
  */
 #ifndef EWOMS_ISTL_PRECONDITIONER_WRAPPERS_HH
 #define EWOMS_ISTL_PRECONDITIONER_WRAPPERS_HH
@@ -48,6 +53,9 @@
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/simulators/linalg/linalgproperties.hh>
 #include <opm/simulators/linalg/ilufirstelement.hh> //definitions needed in next header
+#include <opm/simulators/linalg/mixedprecisionpreconditioner.hh>
+#include <opm/simulators/linalg/parallelilu0.hh>
+#include <opm/simulators/linalg/cprpreconditioner.hh>
 #include <dune/istl/preconditioners.hh>
 
 #include <dune/common/version.hh>
@@ -184,6 +192,142 @@ private:
     SequentialPreconditioner *seqPreCond_;
 };
 
+// an ILU preconditioner which is set up and applied in single precision while the
+// Krylov method still works in the precision of the linear system.
+template <class TypeTag>
+class PreconditionerWrapperMixedPrecisionILU
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
+    using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+
+    static constexpr int order = getPropValue<TypeTag, Properties::PreconditionerOrder>();
+
+    template <class Matrix, class DomainVector, class RangeVector>
+    using InnerILU = Dune::SeqILU<Matrix, DomainVector, RangeVector, order>;
+
+public:
+    using SequentialPreconditioner = MixedPrecisionPreconditioner<OverlappingMatrix,
+                                                                  OverlappingVector,
+                                                                  float,
+                                                                  InnerILU>;
+
+    PreconditionerWrapperMixedPrecisionILU()
+    {}
+
+    static void registerParameters()
+    {
+        Parameters::registerParam<TypeTag, Properties::PreconditionerRelaxation>
+            ("The relaxation factor of the preconditioner");
+    }
+
+    void prepare(OverlappingMatrix& matrix)
+    {
+        Scalar relaxationFactor = Parameters::get<TypeTag, Properties::PreconditionerRelaxation>();
+
+        // create the sequential preconditioner. this also creates the single
+        // precision copy of the matrix.
+        seqPreCond_ = new SequentialPreconditioner(matrix, static_cast<float>(relaxationFactor));
+    }
+
+    SequentialPreconditioner& get()
+    { return *seqPreCond_; }
+
+    void cleanup()
+    { delete seqPreCond_; }
+
+private:
+    SequentialPreconditioner *seqPreCond_;
+};
+
+// an ILU(0) preconditioner which is computed and applied using all threads of the
+// process.
+template <class TypeTag>
+class PreconditionerWrapperParallelILU0
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
+    using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+
+public:
+    using SequentialPreconditioner = ParallelILU0<OverlappingMatrix, OverlappingVector, OverlappingVector>;
+
+    PreconditionerWrapperParallelILU0()
+    {}
+
+    static void registerParameters()
+    {
+        Parameters::registerParam<TypeTag, Properties::PreconditionerRelaxation>
+            ("The relaxation factor of the preconditioner");
+    }
+
+    void prepare(OverlappingMatrix& matrix)
+    {
+        Scalar relaxationFactor = Parameters::get<TypeTag, Properties::PreconditionerRelaxation>();
+
+        // create the sequential preconditioner. the factorization is done here.
+        seqPreCond_ = new SequentialPreconditioner(matrix, relaxationFactor);
+    }
+
+    SequentialPreconditioner& get()
+    { return *seqPreCond_; }
+
+    void cleanup()
+    { delete seqPreCond_; }
+
+private:
+    SequentialPreconditioner *seqPreCond_;
+};
+
+// a constrained pressure residual (CPR) preconditioner which uses quasi-IMPES weights
+template <class TypeTag>
+class PreconditionerWrapperCPR
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
+    using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+
+public:
+    using SequentialPreconditioner = CprPreconditioner<OverlappingMatrix, OverlappingVector, OverlappingVector>;
+
+    PreconditionerWrapperCPR()
+    {}
+
+    static void registerParameters()
+    {
+        Parameters::registerParam<TypeTag, Properties::PreconditionerRelaxation>
+            ("The relaxation factor of the preconditioner");
+        Parameters::registerParam<TypeTag, Properties::CprPressureIndex>
+            ("The index of the pressure variable used by the CPR preconditioner");
+        Parameters::registerParam<TypeTag, Properties::CprCoarsenTarget>
+            ("The coarsening target of the AMG for the pressure system of the CPR "
+             "preconditioner");
+    }
+
+    void prepare(OverlappingMatrix& matrix)
+    {
+        Scalar relaxationFactor = Parameters::get<TypeTag, Properties::PreconditionerRelaxation>();
+        int pressureIdx = Parameters::get<TypeTag, Properties::CprPressureIndex>();
+        int coarsenTarget = Parameters::get<TypeTag, Properties::CprCoarsenTarget>();
+
+        // create the sequential preconditioner. this sets up the pressure system, its
+        // AMG hierarchy and the ILU(0) factorization
+        seqPreCond_ = new SequentialPreconditioner(matrix,
+                                                   static_cast<unsigned>(pressureIdx),
+                                                   coarsenTarget,
+                                                   relaxationFactor);
+    }
+
+    SequentialPreconditioner& get()
+    { return *seqPreCond_; }
+
+    void cleanup()
+    { delete seqPreCond_; }
+
+private:
+    SequentialPreconditioner *seqPreCond_;
+};
+
 #undef EWOMS_WRAP_ISTL_PRECONDITIONER
 }} // namespace Linear, Opm
 
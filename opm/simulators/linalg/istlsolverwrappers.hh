@@ -75,9 +75,9 @@ namespace Opm::Linear {
         template <class LinearOperator, class ScalarProduct, class Preconditioner> \
         std::shared_ptr<RawSolver> get(LinearOperator& parOperator,                \
                                        ScalarProduct& parScalarProduct,            \
-                                       Preconditioner& parPreCond)                 \
+                                       Preconditioner& parPreCond,                 \
+                                       Scalar tolerance)                           \
         {                                                                          \
-            Scalar tolerance = Parameters::get<TypeTag, Properties::LinearSolverTolerance>(); \
             int maxIter = Parameters::get<TypeTag, Properties::LinearSolverMaxIterations>();\
                                                                                    \
             int verbosity = 0;                                                     \
@@ -130,9 +130,9 @@ public:
     template <class LinearOperator, class ScalarProduct, class Preconditioner>
     std::shared_ptr<RawSolver> get(LinearOperator& parOperator,
                                    ScalarProduct& parScalarProduct,
-                                   Preconditioner& parPreCond)
+                                   Preconditioner& parPreCond,
+                                   Scalar tolerance)
     {
-        Scalar tolerance = Parameters::get<TypeTag, Properties::LinearSolverTolerance>();
         int maxIter = Parameters::get<TypeTag, Properties::LinearSolverMaxIterations>();
 
         int verbosity = 0;
@@ -46,6 +46,14 @@ struct PreconditionerWrapper { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct LinearSolverScalar { using type = UndefinedProperty; };
 
+//! The floating point type of the entries of the global Jacobian matrix
+//!
+//! The residual is always stored using the Scalar type of the model, so setting this
+//! to float halves the memory and the bandwidth required by the Jacobian while the
+//! convergence criteria are still evaluated in the precision of the model.
+template<class TypeTag, class MyTypeTag>
+struct JacobianScalar { using type = UndefinedProperty; };
+
 /*!
  * \brief The size of the algebraic overlap of the linear solver.
  *
@@ -56,6 +64,13 @@ struct LinearSolverScalar { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct LinearSolverOverlapSize { using type = UndefinedProperty; };
 
+/*!
+ * \brief Use MPI-3 neighborhood collectives to synchronize the overlapping vectors
+ *        of the linear solver.
+ */
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverNeighborhoodCollectives { using type = UndefinedProperty; };
+
 /*!
  * \brief Maximum accepted error of the solution of the linear solver.
  */
@@ -78,6 +93,30 @@ struct LinearSolverAbsTolerance { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct LinearSolverVerbosity { using type = UndefinedProperty; };
 
+/*!
+ * \brief The directory to which the linear systems of equations are written.
+ *
+ * If this is empty, the linear systems are not written.
+ */
+template<class TypeTag, class MyTypeTag>
+struct LinearSystemDumpDir { using type = UndefinedProperty; };
+
+//! The Newton iteration for which the linear systems are written (-1 means all)
+template<class TypeTag, class MyTypeTag>
+struct LinearSystemDumpNewtonIteration { using type = UndefinedProperty; };
+
+//! Also write the solution of the linear systems which are written
+template<class TypeTag, class MyTypeTag>
+struct LinearSystemDumpSolution { using type = UndefinedProperty; };
+
+/*!
+ * \brief Start the linear solver from an extrapolation of the previous Newton updates.
+ *
+ * This only has an effect for the linear solvers which support initial guesses.
+ */
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverWarmStart { using type = UndefinedProperty; };
+
 //! Maximum number of iterations eyecuted by the linear solver
 template<class TypeTag, class MyTypeTag>
 struct LinearSolverMaxIterations { using type = UndefinedProperty; };
@@ -90,10 +129,31 @@ struct PreconditionerOrder { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct PreconditionerRelaxation { using type = UndefinedProperty; };
 
+//! The index of the pressure variable used by the CPR preconditioner
+template<class TypeTag, class MyTypeTag>
+struct CprPressureIndex { using type = UndefinedProperty; };
+
+//! The coarsening target of the AMG for the pressure system of the CPR preconditioner
+template<class TypeTag, class MyTypeTag>
+struct CprCoarsenTarget { using type = UndefinedProperty; };
+
+//! Number of iterations of the Ruiz equilibration of the linear system (0 disables it)
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverEquilibration { using type = UndefinedProperty; };
+
+//! Add a coarse correction with one unknown per process and equation to the
+//! overlapping preconditioner
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverCoarseSpace { using type = UndefinedProperty; };
+
 //! number of iterations between solver restarts for the GMRES solver
 template<class TypeTag, class MyTypeTag>
 struct GMResRestart { using type = UndefinedProperty; };
 
+//! maximum number of vectors which the FGMRES solver recycles between linear solves
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverRecycleSize { using type = UndefinedProperty; };
+
 //! The class that allows to manipulate sparse matrices
 template<class TypeTag, class MyTypeTag>
 struct SparseMatrixAdapter { using type = UndefinedProperty; };
@@ -104,8 +164,17 @@ struct GlobalEqVector { using type = UndefinedProperty; };
 
 template<class TypeTag, class MyTypeTag>
 struct AmgCoarsenTarget { using type = UndefinedProperty; };
+//! Specifies which parts of the AMG hierarchy are kept between linear solves
+template<class TypeTag, class MyTypeTag>
+struct AmgReuseMode { using type = UndefinedProperty; };
+//! The maximum number of linear solves for which the AMG hierarchy is reused
+template<class TypeTag, class MyTypeTag>
+struct AmgReuseInterval { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct LinearSolverMaxError { using type = UndefinedProperty; };
+//! Compute the scalar products of each BiCGStab iteration using fused global reductions
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverFuseReductions { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct LinearSolverWrapper { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
@@ -32,11 +32,20 @@
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
 
+#include <vector>
+
 namespace Opm {
 namespace Linear {
 
 /*!
  * \brief Collects summary information about the execution of the linear solver.
+ *
+ * Besides the total time, the report breaks down the time spent for setting up and
+ * applying the preconditioner, for the sparse matrix-vector products and for the
+ * scalar products. The latter include the global reductions, i.e., they indicate the
+ * cost of the communication. The accuracy reached by each iteration is recorded as
+ * well. Reports of several solves can be combined using operator+=; in this case,
+ * the residual history of the last solve is kept.
  */
 class SolverReport
 {
@@ -47,7 +56,13 @@ public:
     void reset()
     {
         timer_.halt();
+        preconditionerSetupTimer_.halt();
+        preconditionerApplyTimer_.halt();
+        spmvTimer_.halt();
+        dotTimer_.halt();
+        residualHistory_.clear();
         iterations_ = 0;
+        numSolves_ = 0;
         converged_ = 0;
     }
 
@@ -57,24 +72,107 @@ public:
     Opm::Timer& timer()
     { return timer_; }
 
+    /*!
+     * \brief The time spent to set up the preconditioner.
+     */
+    const Opm::Timer& preconditionerSetupTimer() const
+    { return preconditionerSetupTimer_; }
+
+    Opm::Timer& preconditionerSetupTimer()
+    { return preconditionerSetupTimer_; }
+
+    /*!
+     * \brief The time spent to apply the preconditioner.
+     */
+    const Opm::Timer& preconditionerApplyTimer() const
+    { return preconditionerApplyTimer_; }
+
+    Opm::Timer& preconditionerApplyTimer()
+    { return preconditionerApplyTimer_; }
+
+    /*!
+     * \brief The time spent for the sparse matrix-vector products.
+     */
+    const Opm::Timer& spmvTimer() const
+    { return spmvTimer_; }
+
+    Opm::Timer& spmvTimer()
+    { return spmvTimer_; }
+
+    /*!
+     * \brief The time spent for the scalar products including their global reductions.
+     */
+    const Opm::Timer& dotTimer() const
+    { return dotTimer_; }
+
+    Opm::Timer& dotTimer()
+    { return dotTimer_; }
+
     unsigned iterations() const
     { return iterations_; }
 
-    void increment()
-    { ++iterations_; }
+    void increment(unsigned numIterations = 1)
+    { iterations_ += numIterations; }
 
     SolverReport& operator++()
     { ++iterations_; return *this; }
 
+    /*!
+     * \brief The number of linear solves which are covered by the report.
+     */
+    unsigned numSolves() const
+    { return numSolves_; }
+
+    void incrementSolves()
+    { ++numSolves_; }
+
     bool converged() const
     { return converged_; }
 
     void setConverged(bool value)
     { converged_ = value; }
 
+    /*!
+     * \brief Record the accuracy reached by an iteration of the linear solver.
+     */
+    void addResidual(double accuracy)
+    { residualHistory_.push_back(accuracy); }
+
+    /*!
+     * \brief The accuracy of the initial solution and the one reached after each
+     *        iteration.
+     */
+    const std::vector<double>& residualHistory() const
+    { return residualHistory_; }
+
+    /*!
+     * \brief Add the results of another report to this one.
+     */
+    SolverReport& operator+=(const SolverReport& other)
+    {
+        timer_ += other.timer_;
+        preconditionerSetupTimer_ += other.preconditionerSetupTimer_;
+        preconditionerApplyTimer_ += other.preconditionerApplyTimer_;
+        spmvTimer_ += other.spmvTimer_;
+        dotTimer_ += other.dotTimer_;
+        iterations_ += other.iterations_;
+        numSolves_ += other.numSolves_;
+        converged_ = other.converged_;
+        if (!other.residualHistory_.empty())
+            residualHistory_ = other.residualHistory_;
+
+        return *this;
+    }
+
 private:
     Opm::Timer timer_;
+    Opm::Timer preconditionerSetupTimer_;
+    Opm::Timer preconditionerApplyTimer_;
+    Opm::Timer spmvTimer_;
+    Opm::Timer dotTimer_;
+    std::vector<double> residualHistory_;
     unsigned iterations_;
+    unsigned numSolves_;
     bool converged_;
 };
 
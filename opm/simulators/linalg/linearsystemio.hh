@@ -0,0 +1,271 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Writes and reads linear systems of equations in a compact binary format.
+ *
+ * A file starts with an eight character magic string, a byte order mark and the
+ * dimensions of the blocks. Then, the matrix is stored in the compressed row format
+ * followed by the right hand side and, optionally, the solution. All values are
+ * written as double precision numbers in the byte order of the host which wrote the
+ * file; reading a file with a different byte order is refused.
+ *
+ * The files are intended to be used for benchmarking linear solvers outside of the
+ * simulator, see ParallelBaseBackend and tests/bench_linearsolver.cc.
+ */
+#ifndef EWOMS_LINEAR_SYSTEM_IO_HH
+#define EWOMS_LINEAR_SYSTEM_IO_HH
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm::Linear {
+
+namespace LinearSystemIODetail {
+
+constexpr char magic[8] = {'O', 'P', 'M', 'L', 'S', 'Y', 'S', '1'};
+constexpr std::uint32_t byteOrderMark = 0x01020304;
+
+template <class T>
+void write(std::ofstream& os, const T* values, std::size_t numValues)
+{
+    os.write(reinterpret_cast<const char*>(values),
+             static_cast<std::streamsize>(numValues*sizeof(T)));
+}
+
+template <class T>
+void write(std::ofstream& os, const T& value)
+{ write(os, &value, 1); }
+
+template <class T>
+void read(std::ifstream& is, T* values, std::size_t numValues)
+{
+    is.read(reinterpret_cast<char*>(values),
+            static_cast<std::streamsize>(numValues*sizeof(T)));
+}
+
+template <class T>
+T read(std::ifstream& is)
+{
+    T value{};
+    read(is, &value, 1);
+    return value;
+}
+
+template <class Vector>
+void writeVector(std::ofstream& os, const Vector& v)
+{
+    constexpr int blockSize = Vector::block_type::dimension;
+    std::vector<double> values(v.size()*blockSize);
+    for (std::size_t rowIdx = 0; rowIdx < v.size(); ++rowIdx)
+        for (int i = 0; i < blockSize; ++i)
+            values[rowIdx*blockSize + i] = static_cast<double>(v[rowIdx][i]);
+    write(os, values.data(), values.size());
+}
+
+template <class Vector>
+void readVector(std::ifstream& is, Vector& v, std::size_t numRows)
+{
+    constexpr int blockSize = Vector::block_type::dimension;
+    std::vector<double> values(numRows*blockSize);
+    read(is, values.data(), values.size());
+
+    v.resize(numRows);
+    for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+        for (int i = 0; i < blockSize; ++i)
+            v[rowIdx][i] = values[rowIdx*blockSize + i];
+}
+
+} // namespace LinearSystemIODetail
+
+/*!
+ * \brief Write a block-structured linear system of equations to a file.
+ *
+ * \param fileName The name of the file to be written
+ * \param matrix The matrix of the system (a Dune::BCRSMatrix)
+ * \param rhs The right hand side of the system (a Dune::BlockVector)
+ * \param solution The solution of the system or nullptr if it should not be written
+ */
+template <class Matrix, class Vector>
+void writeLinearSystem(const std::string& fileName,
+                       const Matrix& matrix,
+                       const Vector& rhs,
+                       const Vector* solution = nullptr)
+{
+    using namespace LinearSystemIODetail;
+    using MatrixBlock = typename Matrix::block_type;
+    constexpr int blockRows = MatrixBlock::rows;
+    constexpr int blockCols = MatrixBlock::cols;
+
+    std::ofstream os(fileName, std::ios::binary);
+    if (!os.good())
+        throw std::runtime_error("Could not open file '"+fileName+"' for writing");
+
+    const std::uint64_t numRows = matrix.N();
+    const std::uint64_t numNonZeros = matrix.nonzeroes();
+    write(os, magic, sizeof(magic));
+    write(os, byteOrderMark);
+    write(os, static_cast<std::uint32_t>(blockRows));
+    write(os, static_cast<std::uint32_t>(blockCols));
+    write(os, static_cast<std::uint32_t>(solution != nullptr));
+    write(os, numRows);
+    write(os, numNonZeros);
+
+    // the sparsity pattern
+    std::vector<std::uint64_t> rowStart(numRows + 1, 0);
+    std::vector<std::uint32_t> colIndices;
+    colIndices.reserve(numNonZeros);
+    for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        const auto& row = matrix[rowIdx];
+        for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+            colIndices.push_back(static_cast<std::uint32_t>(colIt.index()));
+        rowStart[rowIdx + 1] = colIndices.size();
+    }
+    write(os, rowStart.data(), rowStart.size());
+    write(os, colIndices.data(), colIndices.size());
+
+    // the values of the matrix in the same order
+    std::vector<double> values;
+    values.reserve(numNonZeros*blockRows*blockCols);
+    for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        const auto& row = matrix[rowIdx];
+        for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+            for (int i = 0; i < blockRows; ++i)
+                for (int j = 0; j < blockCols; ++j)
+                    values.push_back(static_cast<double>((*colIt)[i][j]));
+    }
+    write(os, values.data(), values.size());
+
+    writeVector(os, rhs);
+    if (solution)
+        writeVector(os, *solution);
+
+    if (!os.good())
+        throw std::runtime_error("Could not write the linear system to '"+fileName+"'");
+}
+
+/*!
+ * \brief Returns the number of rows of the matrix blocks of a linear system of
+ *        equations which was written by writeLinearSystem().
+ *
+ * This allows to choose the block type before the system is read.
+ */
+inline unsigned linearSystemBlockSize(const std::string& fileName)
+{
+    using namespace LinearSystemIODetail;
+
+    std::ifstream is(fileName, std::ios::binary);
+    char fileMagic[sizeof(magic)];
+    read(is, fileMagic, sizeof(fileMagic));
+    if (!is.good() || std::memcmp(fileMagic, magic, sizeof(magic)) != 0)
+        throw std::runtime_error("File '"+fileName+"' does not contain a linear system");
+    if (read<std::uint32_t>(is) != byteOrderMark)
+        throw std::runtime_error("The byte order of file '"+fileName+"' is not supported");
+
+    return read<std::uint32_t>(is);
+}
+
+/*!
+ * \brief Read a linear system of equations which was written by writeLinearSystem().
+ *
+ * The block sizes of the matrix and vector types must match the ones of the file.
+ *
+ * \return true if the file contains a solution of the system, else false. In this
+ *         case, the solution vector is not modified.
+ */
+template <class Matrix, class Vector>
+bool readLinearSystem(const std::string& fileName,
+                      Matrix& matrix,
+                      Vector& rhs,
+                      Vector& solution)
+{
+    using namespace LinearSystemIODetail;
+    using MatrixBlock = typename Matrix::block_type;
+    constexpr int blockRows = MatrixBlock::rows;
+    constexpr int blockCols = MatrixBlock::cols;
+
+    std::ifstream is(fileName, std::ios::binary);
+    if (!is.good())
+        throw std::runtime_error("Could not open file '"+fileName+"' for reading");
+
+    char fileMagic[sizeof(magic)];
+    read(is, fileMagic, sizeof(fileMagic));
+    if (!is.good() || std::memcmp(fileMagic, magic, sizeof(magic)) != 0)
+        throw std::runtime_error("File '"+fileName+"' does not contain a linear system");
+    if (read<std::uint32_t>(is) != byteOrderMark)
+        throw std::runtime_error("The byte order of file '"+fileName+"' is not supported");
+
+    const auto fileBlockRows = read<std::uint32_t>(is);
+    const auto fileBlockCols = read<std::uint32_t>(is);
+    if (fileBlockRows != blockRows || fileBlockCols != blockCols)
+        throw std::runtime_error("The linear system in file '"+fileName+"' uses "
+                                 +std::to_string(fileBlockRows)+"x"+std::to_string(fileBlockCols)
+                                 +" blocks, but "+std::to_string(blockRows)+"x"
+                                 +std::to_string(blockCols)+" blocks are required");
+    const bool hasSolution = read<std::uint32_t>(is) != 0;
+    const auto numRows = read<std::uint64_t>(is);
+    const auto numNonZeros = read<std::uint64_t>(is);
+    if (!is.good())
+        throw std::runtime_error("File '"+fileName+"' is corrupted");
+
+    std::vector<std::uint64_t> rowStart(numRows + 1);
+    std::vector<std::uint32_t> colIndices(numNonZeros);
+    read(is, rowStart.data(), rowStart.size());
+    read(is, colIndices.data(), colIndices.size());
+    if (!is.good() || rowStart.back() != numNonZeros)
+        throw std::runtime_error("File '"+fileName+"' is corrupted");
+
+    matrix = Matrix(numRows, numRows, numNonZeros, Matrix::row_wise);
+    for (auto rowIt = matrix.createbegin(); rowIt != matrix.createend(); ++rowIt)
+        for (auto k = rowStart[rowIt.index()]; k < rowStart[rowIt.index() + 1]; ++k)
+            rowIt.insert(colIndices[k]);
+
+    std::vector<double> values(numNonZeros*blockRows*blockCols);
+    read(is, values.data(), values.size());
+    std::size_t valueIdx = 0;
+    for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        auto& row = matrix[rowIdx];
+        for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+            for (int i = 0; i < blockRows; ++i)
+                for (int j = 0; j < blockCols; ++j)
+                    (*colIt)[i][j] = values[valueIdx++];
+    }
+
+    readVector(is, rhs, numRows);
+    if (hasSolution)
+        readVector(is, solution, numRows);
+
+    if (!is.good())
+        throw std::runtime_error("File '"+fileName+"' is corrupted");
+
+    return hasSolution;
+}
+
+} // namespace Opm::Linear
+
+#endif
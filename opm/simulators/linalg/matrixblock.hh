@@ -33,6 +33,10 @@
 
 #include <opm/common/Exceptions.hpp>
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
 #include <limits>
 
 namespace Opm {
@@ -220,8 +224,106 @@ static inline void invertMatrix(Dune::DynamicMatrix<K>& matrix)
      matrix.invert();
 }
 
+//! The number of blocks which are inverted simultaneously by invertMatrixBlocks()
+static constexpr std::size_t matrixBlockBatchSize = 8;
+
+/*!
+ * \brief Invert up to matrixBlockBatchSize square blocks simultaneously.
+ *
+ * The blocks are transposed into a structure of arrays layout where the innermost
+ * dimension corresponds to the blocks, so that the compiler can map each block to a
+ * SIMD lane. The inversion is done by Gauss-Jordan elimination without pivoting.
+ * If any pivot is too small relative to the entries of its block, nothing is
+ * written and false is returned.
+ */
+template <class Block>
+static inline bool invertMatrixBatch(Block* blocks, std::size_t count)
+{
+    using K = typename Block::field_type;
+    constexpr int n = Block::rows;
+    constexpr std::size_t w = matrixBlockBatchSize;
+    static_assert(static_cast<int>(Block::rows) == static_cast<int>(Block::cols),
+                  "Only square blocks can be inverted");
+    assert(count <= w);
+
+    // unused lanes are filled with the identity matrix
+    K a[n][n][w];
+    K inv[n][n][w];
+    K scale[w];
+    for (std::size_t l = 0; l < w; ++l)
+        scale[l] = 0.0;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            for (std::size_t l = 0; l < w; ++l) {
+                a[i][j][l] = (l < count) ? blocks[l][i][j] : K(i == j ? 1.0 : 0.0);
+                inv[i][j][l] = (i == j) ? 1.0 : 0.0;
+                scale[l] = std::max(scale[l], std::abs(a[i][j][l]));
+            }
+        }
+    }
+
+    for (int k = 0; k < n; ++k) {
+        int pivotsOk = 1;
+        for (std::size_t l = 0; l < w; ++l)
+            pivotsOk &= (std::abs(a[k][k][l]) > 1e-8*scale[l]);
+        if (!pivotsOk)
+            return false;
+
+        K pivotInv[w];
+        for (std::size_t l = 0; l < w; ++l)
+            pivotInv[l] = 1.0/a[k][k][l];
+        for (int j = 0; j < n; ++j) {
+            for (std::size_t l = 0; l < w; ++l) {
+                a[k][j][l] *= pivotInv[l];
+                inv[k][j][l] *= pivotInv[l];
+            }
+        }
+
+        for (int i = 0; i < n; ++i) {
+            if (i == k)
+                continue;
+
+            K factor[w];
+            for (std::size_t l = 0; l < w; ++l)
+                factor[l] = a[i][k][l];
+            for (int j = 0; j < n; ++j) {
+                for (std::size_t l = 0; l < w; ++l) {
+                    a[i][j][l] -= factor[l]*a[k][j][l];
+                    inv[i][j][l] -= factor[l]*inv[k][j][l];
+                }
+            }
+        }
+    }
+
+    for (std::size_t l = 0; l < count; ++l)
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                blocks[l][i][j] = inv[i][j][l];
+
+    return true;
+}
+
 } // namespace detail
 
+/*!
+ * \brief Invert a contiguous array of square matrix blocks in place.
+ *
+ * The blocks are processed in batches of detail::matrixBlockBatchSize, where the
+ * blocks of a batch are inverted simultaneously using SIMD instructions. Batches
+ * which contain a block that requires pivoting fall back to the invert() method of
+ * the individual blocks, i.e., singular blocks cause a NumericalProblem exception.
+ */
+template <class Block>
+void invertMatrixBlocks(Block* blocks, std::size_t numBlocks)
+{
+    for (std::size_t first = 0; first < numBlocks; first += detail::matrixBlockBatchSize) {
+        const std::size_t count = std::min(detail::matrixBlockBatchSize, numBlocks - first);
+        if (!detail::invertMatrixBatch(blocks + first, count))
+            for (std::size_t l = 0; l < count; ++l)
+                blocks[first + l].invert();
+    }
+}
+
 template <class Scalar, int n, int m>
 class MatrixBlock : public Dune::FieldMatrix<Scalar, n, m>
 {
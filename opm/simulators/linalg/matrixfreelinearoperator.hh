@@ -0,0 +1,188 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::Linear::MatrixFreeLinearOperator
+ */
+#ifndef EWOMS_MATRIX_FREE_LINEAR_OPERATOR_HH
+#define EWOMS_MATRIX_FREE_LINEAR_OPERATOR_HH
+
+#include <opm/models/utils/propertysystem.hh>
+
+#include <dune/istl/operators.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief A linear operator which computes the product of the Jacobian of the
+ *        residual with a vector without accessing the Jacobian matrix.
+ *
+ * The product is approximated by the directional difference quotient
+ *
+ * \f[ J v \approx \frac{F(x + \epsilon v) - F(x)}{\epsilon} \f]
+ *
+ * where the residual F is evaluated by the residual-only path of the linearizer,
+ * i.e., by the same flux and storage kernels which are used for the Jacobian. Each
+ * product thus costs one update of the intensive quantities and one evaluation of
+ * the residual. The step size follows the usual choice
+ * \f$ \epsilon = \sqrt{\epsilon_{mach}} (1 + \|x\|)/\|v\| \f$.
+ *
+ * The operator must be constructed after the system has been linearized, since it
+ * takes F(x) from the residual of the linearizer. The solution and the residual are
+ * restored after each product, the intensive quantities only by restore() (which is
+ * also called by the destructor), so that the update of the intensive quantities for
+ * the unperturbed solution is only required once per linear solve.
+ *
+ * The operator requires the TpfaLinearizer and works on the non-overlapping vectors
+ * of a sequential run. A preconditioner can still be built from an assembled
+ * Jacobian, e.g. one stored in reduced precision (see the JacobianScalar property).
+ */
+template <class TypeTag>
+class MatrixFreeLinearOperator
+    : public Dune::LinearOperator<GetPropType<TypeTag, Properties::GlobalEqVector>,
+                                  GetPropType<TypeTag, Properties::GlobalEqVector>>
+{
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
+    using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+
+public:
+    //! export types
+    using domain_type = GlobalEqVector;
+    using range_type = GlobalEqVector;
+    using field_type = Scalar;
+
+    explicit MatrixFreeLinearOperator(Simulator& simulator)
+        : simulator_(simulator)
+        , solution_(simulator.model().solution(/*timeIdx=*/0))
+        , residual_(simulator.model().linearizer().residual())
+        , perturbedSolution_(solution_)
+        , quantitiesPerturbed_(false)
+    {
+        if (simulator.gridView().comm().size() > 1)
+            throw std::invalid_argument("The matrix-free linear operator only supports "
+                                        "sequential runs");
+
+        solutionNorm_ = 0.0;
+        for (unsigned dofIdx = 0; dofIdx < solution_.size(); ++dofIdx)
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                solutionNorm_ += solution_[dofIdx][pvIdx]*solution_[dofIdx][pvIdx];
+        solutionNorm_ = std::sqrt(solutionNorm_);
+    }
+
+    ~MatrixFreeLinearOperator()
+    { restore(); }
+
+    //! the kind of computations supported by the operator
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+    //! apply operator to x:  \f$ y = J x \f$
+    void apply(const domain_type& x, range_type& y) const override
+    {
+        const Scalar xNorm = x.two_norm();
+        if (xNorm == 0.0) {
+            y = 0.0;
+            return;
+        }
+
+        const Scalar eps =
+            std::sqrt(std::numeric_limits<Scalar>::epsilon())*(1.0 + solutionNorm_)/xNorm;
+
+        for (unsigned dofIdx = 0; dofIdx < solution_.size(); ++dofIdx) {
+            perturbedSolution_[dofIdx] = solution_[dofIdx];
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                perturbedSolution_[dofIdx][pvIdx] += eps*x[dofIdx][pvIdx];
+        }
+
+        evaluateResidual_(perturbedSolution_);
+        quantitiesPerturbed_ = true;
+
+        auto& model = simulator_.model();
+        y = model.linearizer().residual();
+        y -= residual_;
+        y /= eps;
+
+        model.solution(/*timeIdx=*/0) = solution_;
+        model.linearizer().residual() = residual_;
+    }
+
+    //! apply operator to x, scale and add:  \f$ y = y + \alpha J x \f$
+    void applyscaleadd(field_type alpha, const domain_type& x, range_type& y) const override
+    {
+        range_type tmp(y.size());
+        apply(x, tmp);
+        y.axpy(alpha, tmp);
+    }
+
+    /*!
+     * \brief Update the intensive quantities for the unperturbed solution if they were
+     *        modified by apply().
+     */
+    void restore()
+    {
+        if (!quantitiesPerturbed_)
+            return;
+
+        auto& model = simulator_.model();
+        model.solution(/*timeIdx=*/0) = solution_;
+        model.invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0, simulator_.gridView());
+        quantitiesPerturbed_ = false;
+    }
+
+private:
+    void evaluateResidual_(const SolutionVector& solution) const
+    {
+        auto& model = simulator_.model();
+        model.solution(/*timeIdx=*/0) = solution;
+
+        // the variant for a grid view updates all intensive quantities regardless of
+        // the tolerance for unchanged primary variables, which would otherwise swallow
+        // the perturbation
+        model.invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0, simulator_.gridView());
+        model.linearizer().linearizePerturbedResidual();
+    }
+
+    Simulator& simulator_;
+    SolutionVector solution_;
+    GlobalEqVector residual_;
+    Scalar solutionNorm_;
+
+    mutable SolutionVector perturbedSolution_;
+    mutable bool quantitiesPerturbed_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
@@ -0,0 +1,152 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::MixedPrecisionPreconditioner
+ */
+#ifndef EWOMS_MIXED_PRECISION_PRECONDITIONER_HH
+#define EWOMS_MIXED_PRECISION_PRECONDITIONER_HH
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/preconditioner.hh>
+
+#include <utility>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief Applies a sequential preconditioner which operates on a lower precision
+ *        copy of the matrix.
+ *
+ * The matrix is converted to the scalar type LowScalar when the preconditioner is
+ * created, and the defect and the correction are converted in each application. The
+ * Krylov method which uses the preconditioner still works in the precision of the
+ * original linear system, so the accuracy of the solution is not affected, but the
+ * memory traffic of setting up and applying the preconditioner is roughly halved if
+ * single precision is used instead of double.
+ *
+ * \tparam Matrix The type of the original matrix
+ * \tparam Vector The type of the original vectors
+ * \tparam LowScalar The scalar type used by the preconditioner
+ * \tparam InnerPreconditionerT A template for the sequential preconditioner which is
+ *         instantiated for the low precision matrix and vector types, e.g., a
+ *         partially specialized Dune::SeqILU
+ */
+template <class Matrix,
+          class Vector,
+          class LowScalar,
+          template <class, class, class> class InnerPreconditionerT>
+class MixedPrecisionPreconditioner
+    : public Dune::Preconditioner<Vector, Vector>
+{
+    using MatrixBlock = typename Matrix::block_type;
+    using VectorBlock = typename Vector::block_type;
+
+public:
+    using LowMatrix = Dune::BCRSMatrix<Dune::FieldMatrix<LowScalar, MatrixBlock::rows, MatrixBlock::cols> >;
+    using LowVector = Dune::BlockVector<Dune::FieldVector<LowScalar, VectorBlock::dimension> >;
+    using InnerPreconditioner = InnerPreconditionerT<LowMatrix, LowVector, LowVector>;
+
+    using domain_type = Vector;
+    using range_type = Vector;
+    using field_type = typename Vector::field_type;
+
+    /*!
+     * \brief Create the preconditioner for a matrix.
+     *
+     * All arguments but the matrix are passed to the constructor of the inner
+     * preconditioner.
+     */
+    template <class... InnerArgs>
+    MixedPrecisionPreconditioner(const Matrix& matrix, InnerArgs&&... innerArgs)
+        : lowMatrix_(lowPrecisionCopy_(matrix))
+        , innerPreconditioner_(lowMatrix_, std::forward<InnerArgs>(innerArgs)...)
+        , lowX_(matrix.N())
+        , lowD_(matrix.N())
+    {}
+
+    MixedPrecisionPreconditioner(const MixedPrecisionPreconditioner&) = delete;
+    MixedPrecisionPreconditioner& operator=(const MixedPrecisionPreconditioner&) = delete;
+
+    void pre(Vector&, Vector&) override
+    {}
+
+    void apply(Vector& x, const Vector& d) override
+    {
+        const std::size_t n = d.size();
+        for (std::size_t i = 0; i < n; ++i)
+            for (int j = 0; j < VectorBlock::dimension; ++j)
+                lowD_[i][j] = static_cast<LowScalar>(d[i][j]);
+
+        lowX_ = 0.0;
+        innerPreconditioner_.apply(lowX_, lowD_);
+
+        for (std::size_t i = 0; i < n; ++i)
+            for (int j = 0; j < VectorBlock::dimension; ++j)
+                x[i][j] = static_cast<field_type>(lowX_[i][j]);
+    }
+
+    void post(Vector&) override
+    {}
+
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+private:
+    static LowMatrix lowPrecisionCopy_(const Matrix& matrix)
+    {
+        LowMatrix result(matrix.N(), matrix.M(), matrix.nonzeroes(), LowMatrix::row_wise);
+        for (auto rowIt = result.createbegin(); rowIt != result.createend(); ++rowIt) {
+            const auto& row = matrix[rowIt.index()];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                rowIt.insert(colIt.index());
+        }
+
+        for (std::size_t rowIdx = 0; rowIdx < matrix.N(); ++rowIdx) {
+            const auto& row = matrix[rowIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                const auto& block = *colIt;
+                auto& lowBlock = result[rowIdx][colIt.index()];
+                for (int i = 0; i < MatrixBlock::rows; ++i)
+                    for (int j = 0; j < MatrixBlock::cols; ++j)
+                        lowBlock[i][j] = static_cast<LowScalar>(block[i][j]);
+            }
+        }
+
+        return result;
+    }
+
+    LowMatrix lowMatrix_;
+    InnerPreconditioner innerPreconditioner_;
+    LowVector lowX_;
+    LowVector lowD_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
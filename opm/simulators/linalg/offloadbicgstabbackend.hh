@@ -0,0 +1,533 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::OffloadBiCGStabSolverBackend
+ */
+#ifndef EWOMS_OFFLOAD_BICGSTAB_BACKEND_HH
+#define EWOMS_OFFLOAD_BICGSTAB_BACKEND_HH
+
+#include "linalgproperties.hh"
+#include "parallelbasebackend.hh"
+#include "istlsparsematrixadapter.hh"
+#include "matrixblock.hh"
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace Opm::Linear {
+template <class TypeTag>
+class OffloadBiCGStabSolverBackend;
+} // namespace Opm::Linear
+
+namespace Opm::Properties {
+
+// Create new type tags
+namespace TTag {
+struct OffloadBiCGStabLinearSolver { using InheritsFrom = std::tuple<ParallelBaseLinearSolver>; };
+} // end namespace TTag
+
+template<class TypeTag>
+struct LinearSolverBackend<TypeTag, TTag::OffloadBiCGStabLinearSolver>
+{ using type = Opm::Linear::OffloadBiCGStabSolverBackend<TypeTag>; };
+
+} // namespace Opm::Properties
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief A block-Jacobi preconditioned BiCGStab solver which runs on an accelerator
+ *        device using OpenMP target offloading.
+ *
+ * The structure of the matrix, the workspace vectors and the inverse diagonal blocks
+ * are kept in the device memory until release() is called, i.e., for each linear
+ * system only the values of the matrix, its inverted diagonal blocks and the right hand
+ * side are transferred to the device. If the compiler does not support offloading or
+ * no device is available, the kernels are executed by the threads of the host.
+ */
+template <class Scalar, int blockSize>
+class OffloadBiCGStab
+{
+    static constexpr int bs = blockSize;
+    static constexpr int bs2 = blockSize*blockSize;
+
+public:
+    OffloadBiCGStab()
+        : numRows_(0)
+        , numBlocks_(0)
+        , isMapped_(false)
+    {}
+
+    OffloadBiCGStab(const OffloadBiCGStab&) = delete;
+    OffloadBiCGStab& operator=(const OffloadBiCGStab&) = delete;
+
+    ~OffloadBiCGStab()
+    { release(); }
+
+    bool hasStructure() const
+    { return isMapped_; }
+
+    /*!
+     * \brief Copy the sparsity pattern of a block matrix to the device.
+     */
+    template <class Matrix>
+    void setStructure(const Matrix& A)
+    {
+        release();
+
+        numRows_ = A.N();
+        numBlocks_ = A.nonzeroes();
+        rowPtr_.resize(numRows_ + 1);
+        colIdx_.resize(numBlocks_);
+        diagPos_.resize(numRows_);
+
+        std::size_t pos = 0;
+        for (auto rowIt = A.begin(); rowIt != A.end(); ++rowIt) {
+            rowPtr_[rowIt.index()] = pos;
+            diagPos_[rowIt.index()] = numBlocks_;
+            for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt, ++pos) {
+                colIdx_[pos] = colIt.index();
+                if (colIt.index() == rowIt.index())
+                    diagPos_[rowIt.index()] = pos;
+            }
+            if (diagPos_[rowIt.index()] == numBlocks_)
+                throw std::logic_error("OffloadBiCGStab: the matrix does not exhibit a "
+                                       "diagonal block in each row");
+        }
+        rowPtr_[numRows_] = pos;
+
+        values_.resize(numBlocks_*bs2);
+        diagBlocks_.resize(numRows_);
+        diagInv_.resize(numRows_*bs2);
+        workspace_.resize(numWorkspaceVectors*numRows_*bs);
+
+#ifdef _OPENMP
+        const std::size_t* rowPtr = rowPtr_.data();
+        const std::size_t* colIdx = colIdx_.data();
+        const Scalar* values = values_.data();
+        const Scalar* diagInv = diagInv_.data();
+        const Scalar* workspace = workspace_.data();
+        const std::size_t numValues = values_.size();
+        const std::size_t numDiagValues = diagInv_.size();
+        const std::size_t numWorkspaceValues = workspace_.size();
+#pragma omp target enter data map(to: rowPtr[0:numRows_+1], colIdx[0:numBlocks_]) \
+    map(alloc: values[0:numValues], diagInv[0:numDiagValues], workspace[0:numWorkspaceValues])
+#endif
+        isMapped_ = true;
+    }
+
+    /*!
+     * \brief Copy the values of a block matrix with the same structure as the one
+     *        passed to setStructure() to the device.
+     *
+     * The diagonal blocks are inverted on the host before they are transferred.
+     */
+    template <class Matrix>
+    void setValues(const Matrix& A)
+    {
+        std::size_t pos = 0;
+        for (auto rowIt = A.begin(); rowIt != A.end(); ++rowIt) {
+            for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt, ++pos) {
+                Scalar* dst = values_.data() + pos*bs2;
+                for (int i = 0; i < bs; ++i)
+                    for (int j = 0; j < bs; ++j)
+                        dst[i*bs + j] = (*colIt)[i][j];
+            }
+        }
+
+        for (std::size_t rowIdx = 0; rowIdx < numRows_; ++rowIdx)
+            for (int i = 0; i < bs; ++i)
+                for (int j = 0; j < bs; ++j)
+                    diagBlocks_[rowIdx][i][j] = values_[diagPos_[rowIdx]*bs2 + i*bs + j];
+        invertMatrixBlocks(diagBlocks_.data(), diagBlocks_.size());
+        for (std::size_t rowIdx = 0; rowIdx < numRows_; ++rowIdx)
+            for (int i = 0; i < bs; ++i)
+                for (int j = 0; j < bs; ++j)
+                    diagInv_[rowIdx*bs2 + i*bs + j] = diagBlocks_[rowIdx][i][j];
+
+#ifdef _OPENMP
+        const Scalar* values = values_.data();
+        const Scalar* diagInv = diagInv_.data();
+        const std::size_t numValues = values_.size();
+        const std::size_t numDiagValues = diagInv_.size();
+#pragma omp target update to(values[0:numValues], diagInv[0:numDiagValues])
+#endif
+    }
+
+    /*!
+     * \brief Release the device memory.
+     */
+    void release()
+    {
+        if (!isMapped_)
+            return;
+
+#ifdef _OPENMP
+        const std::size_t* rowPtr = rowPtr_.data();
+        const std::size_t* colIdx = colIdx_.data();
+        const Scalar* values = values_.data();
+        const Scalar* diagInv = diagInv_.data();
+        const Scalar* workspace = workspace_.data();
+        const std::size_t numValues = values_.size();
+        const std::size_t numDiagValues = diagInv_.size();
+        const std::size_t numWorkspaceValues = workspace_.size();
+#pragma omp target exit data map(delete: rowPtr[0:numRows_+1], colIdx[0:numBlocks_], \
+    values[0:numValues], diagInv[0:numDiagValues], workspace[0:numWorkspaceValues])
+#endif
+        isMapped_ = false;
+    }
+
+    /*!
+     * \brief Solve the linear system of equations.
+     *
+     * \param bHost The right hand side as a flat array of scalars
+     * \param xHost The solution as a flat array of scalars. On entry, it contains the
+     *              initial guess
+     * \param reduction The reduction of the residual norm which is required
+     * \param absTolerance The residual norm below which the solution is always accepted
+     * \param maxIterations The maximum number of iterations
+     * \param iterations Set to the number of iterations which were performed
+     *
+     * \return true if the solver converged
+     */
+    bool solve(const Scalar* bHost, Scalar* xHost,
+               Scalar reduction, Scalar absTolerance,
+               int maxIterations, int& iterations)
+    {
+        const std::size_t n = numRows_*bs;
+        Scalar* w = workspace_.data();
+        Scalar* x = w + xIdx*n;
+        Scalar* r = w + rIdx*n;
+        Scalar* r0 = w + r0Idx*n;
+        Scalar* p = w + pIdx*n;
+        Scalar* v = w + vIdx*n;
+        Scalar* s = w + sIdx*n;
+        Scalar* t = w + tIdx*n;
+        Scalar* y = w + yIdx*n;
+        Scalar* z = w + zIdx*n;
+
+        for (std::size_t i = 0; i < n; ++i) {
+            r[i] = bHost[i];
+            x[i] = xHost[i];
+        }
+#ifdef _OPENMP
+#pragma omp target update to(x[0:n], r[0:n])
+#endif
+
+        // r = b - A x, r0 = r, p = v = 0
+        spmv_(x, t);
+        axpy_(r, -1.0, t);
+        copy_(r0, r);
+        fill_(p, 0.0);
+        fill_(v, 0.0);
+
+        const Scalar initialResidual = std::sqrt(dot_(r, r));
+        const Scalar tolerance = std::max(reduction*initialResidual, absTolerance);
+        Scalar rho = 1.0;
+        Scalar alpha = 1.0;
+        Scalar omega = 1.0;
+
+        bool converged = initialResidual <= tolerance;
+        for (iterations = 0; !converged && iterations < maxIterations; ++iterations) {
+            const Scalar rhoNew = dot_(r0, r);
+            if (rhoNew == 0.0)
+                break;
+
+            // p = r + beta*(p - omega*v)
+            const Scalar beta = (rhoNew/rho)*(alpha/omega);
+            updateDirection_(p, r, v, beta, omega);
+
+            precondition_(p, y);
+            spmv_(y, v);
+            const Scalar r0v = dot_(r0, v);
+            if (r0v == 0.0)
+                break;
+            alpha = rhoNew/r0v;
+
+            // s = r - alpha*v
+            copy_(s, r);
+            axpy_(s, -alpha, v);
+            if (std::sqrt(dot_(s, s)) <= tolerance) {
+                axpy_(x, alpha, y);
+                converged = true;
+                ++iterations;
+                break;
+            }
+
+            precondition_(s, z);
+            spmv_(z, t);
+            const Scalar tt = dot_(t, t);
+            if (tt == 0.0)
+                break;
+            omega = dot_(t, s)/tt;
+
+            // x = x + alpha*y + omega*z, r = s - omega*t
+            axpy_(x, alpha, y);
+            axpy_(x, omega, z);
+            copy_(r, s);
+            axpy_(r, -omega, t);
+
+            rho = rhoNew;
+            converged = std::sqrt(dot_(r, r)) <= tolerance;
+        }
+
+#ifdef _OPENMP
+#pragma omp target update from(x[0:n])
+#endif
+        for (std::size_t i = 0; i < n; ++i)
+            xHost[i] = x[i];
+
+        return converged;
+    }
+
+private:
+    enum { xIdx, rIdx, r0Idx, pIdx, vIdx, sIdx, tIdx, yIdx, zIdx, numWorkspaceVectors };
+
+    // y = A x
+    void spmv_(const Scalar* x, Scalar* y) const
+    {
+        const std::size_t* rowPtr = rowPtr_.data();
+        const std::size_t* colIdx = colIdx_.data();
+        const Scalar* values = values_.data();
+        const std::size_t numRows = numRows_;
+#ifdef _OPENMP
+        const std::size_t n = numRows_*bs;
+        const std::size_t numValues = values_.size();
+#pragma omp target teams distribute parallel for \
+    map(to: rowPtr[0:numRows+1], colIdx[0:numBlocks_], values[0:numValues], x[0:n]) \
+    map(tofrom: y[0:n])
+#endif
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            Scalar tmp[bs];
+            for (int i = 0; i < bs; ++i)
+                tmp[i] = 0.0;
+            for (std::size_t k = rowPtr[rowIdx]; k < rowPtr[rowIdx + 1]; ++k) {
+                const Scalar* a = values + k*bs2;
+                const Scalar* xj = x + colIdx[k]*bs;
+                for (int i = 0; i < bs; ++i)
+                    for (int j = 0; j < bs; ++j)
+                        tmp[i] += a[i*bs + j]*xj[j];
+            }
+            for (int i = 0; i < bs; ++i)
+                y[rowIdx*bs + i] = tmp[i];
+        }
+    }
+
+    // y = D^-1 x
+    void precondition_(const Scalar* x, Scalar* y) const
+    {
+        const Scalar* diagInv = diagInv_.data();
+        const std::size_t numRows = numRows_;
+#ifdef _OPENMP
+        const std::size_t n = numRows_*bs;
+        const std::size_t numDiagValues = diagInv_.size();
+#pragma omp target teams distribute parallel for \
+    map(to: diagInv[0:numDiagValues], x[0:n]) map(tofrom: y[0:n])
+#endif
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            const Scalar* d = diagInv + rowIdx*bs2;
+            for (int i = 0; i < bs; ++i) {
+                Scalar tmp = 0.0;
+                for (int j = 0; j < bs; ++j)
+                    tmp += d[i*bs + j]*x[rowIdx*bs + j];
+                y[rowIdx*bs + i] = tmp;
+            }
+        }
+    }
+
+    Scalar dot_(const Scalar* x, const Scalar* y) const
+    {
+        const std::size_t n = numRows_*bs;
+        Scalar result = 0.0;
+#ifdef _OPENMP
+#pragma omp target teams distribute parallel for reduction(+:result) \
+    map(to: x[0:n], y[0:n]) map(tofrom: result)
+#endif
+        for (std::size_t i = 0; i < n; ++i)
+            result += x[i]*y[i];
+        return result;
+    }
+
+    // x = x + a*y
+    void axpy_(Scalar* x, Scalar a, const Scalar* y) const
+    {
+        const std::size_t n = numRows_*bs;
+#ifdef _OPENMP
+#pragma omp target teams distribute parallel for map(to: y[0:n]) map(tofrom: x[0:n])
+#endif
+        for (std::size_t i = 0; i < n; ++i)
+            x[i] += a*y[i];
+    }
+
+    void copy_(Scalar* x, const Scalar* y) const
+    {
+        const std::size_t n = numRows_*bs;
+#ifdef _OPENMP
+#pragma omp target teams distribute parallel for map(to: y[0:n]) map(tofrom: x[0:n])
+#endif
+        for (std::size_t i = 0; i < n; ++i)
+            x[i] = y[i];
+    }
+
+    void fill_(Scalar* x, Scalar value) const
+    {
+        const std::size_t n = numRows_*bs;
+#ifdef _OPENMP
+#pragma omp target teams distribute parallel for map(tofrom: x[0:n])
+#endif
+        for (std::size_t i = 0; i < n; ++i)
+            x[i] = value;
+    }
+
+    // p = r + beta*(p - omega*v)
+    void updateDirection_(Scalar* p, const Scalar* r, const Scalar* v,
+                          Scalar beta, Scalar omega) const
+    {
+        const std::size_t n = numRows_*bs;
+#ifdef _OPENMP
+#pragma omp target teams distribute parallel for map(to: r[0:n], v[0:n]) map(tofrom: p[0:n])
+#endif
+        for (std::size_t i = 0; i < n; ++i)
+            p[i] = r[i] + beta*(p[i] - omega*v[i]);
+    }
+
+    std::size_t numRows_;
+    std::size_t numBlocks_;
+    bool isMapped_;
+
+    std::vector<std::size_t> rowPtr_;
+    std::vector<std::size_t> colIdx_;
+    std::vector<std::size_t> diagPos_;
+    std::vector<Scalar> values_;
+    std::vector<Scalar> diagInv_;
+    std::vector<MatrixBlock<Scalar, blockSize, blockSize>> diagBlocks_;
+    std::vector<Scalar> workspace_;
+};
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief A linear solver backend which solves the linear systems of equations on an
+ *        accelerator device.
+ *
+ * The backend uses a block-Jacobi preconditioned BiCGStab solver which is offloaded
+ * to the device using OpenMP target directives, i.e., it does not depend on a
+ * vendor-specific programming model. The structure of the matrix is kept resident in
+ * the device memory as long as the overlapping matrix of the base backend is kept,
+ * so only the values are copied for each linear solve. Currently, this backend only
+ * supports sequential runs.
+ */
+template <class TypeTag>
+class OffloadBiCGStabSolverBackend : public ParallelBaseBackend<TypeTag>
+{
+    using ParentType = ParallelBaseBackend<TypeTag>;
+
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using LinearSolverScalar = GetPropType<TypeTag, Properties::LinearSolverScalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+    using Vector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+
+    static constexpr int numEq = getPropValue<TypeTag, Properties::NumEq>();
+
+    static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock> >::value,
+                  "The OffloadBiCGStabSolverBackend linear solver backend requires the IstlSparseMatrixAdapter");
+
+public:
+    OffloadBiCGStabSolverBackend(const Simulator& simulator)
+        : ParentType(simulator)
+    { }
+
+    /*!
+     * \brief Actually solve the linear system of equations.
+     *
+     * \return true if the residual reduction could be achieved, else false.
+     */
+    bool solve(Vector& x)
+    {
+        const auto& overlappingMatrix = *this->overlappingMatrix_;
+        if (!overlappingMatrix.overlap().peerSet().empty())
+            throw std::logic_error("The offloading linear solver backend currently only "
+                                   "supports sequential runs");
+
+        if (!solver_.hasStructure())
+            solver_.setStructure(overlappingMatrix);
+        solver_.setValues(overlappingMatrix);
+
+        Scalar tolerance = this->linearSolverTolerance();
+        Scalar absTolerance = Parameters::get<TypeTag, Properties::LinearSolverAbsTolerance>();
+        if (absTolerance < 0.0)
+            absTolerance = this->simulator_.model().newtonMethod().tolerance()/100.0;
+
+        const std::size_t n = overlappingMatrix.N()*numEq;
+        std::vector<LinearSolverScalar> b(n);
+        std::vector<LinearSolverScalar> xTmp(n, 0.0);
+        const auto& overlappingb = *this->overlappingb_;
+        for (std::size_t rowIdx = 0; rowIdx < overlappingMatrix.N(); ++rowIdx)
+            for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                b[rowIdx*numEq + eqIdx] = overlappingb[rowIdx][eqIdx];
+
+        int iterations = 0;
+        bool converged = solver_.solve(b.data(), xTmp.data(), tolerance, absTolerance,
+                                       Parameters::get<TypeTag, Properties::LinearSolverMaxIterations>(),
+                                       iterations);
+        this->lastIterations_ = iterations;
+
+        auto& overlappingx = *this->overlappingx_;
+        for (std::size_t rowIdx = 0; rowIdx < overlappingMatrix.N(); ++rowIdx)
+            for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                overlappingx[rowIdx][eqIdx] = xTmp[rowIdx*numEq + eqIdx];
+        overlappingx.assignTo(x);
+
+        if (Parameters::get<TypeTag, Properties::LinearSolverVerbosity>() > 0)
+            std::cout << "Offloaded BiCGStab " << (converged ? "converged" : "did not converge")
+                      << " after " << iterations << " iterations" << std::endl;
+
+        return converged;
+    }
+
+protected:
+    friend ParentType;
+
+    void cleanup_()
+    {
+        // the structure of the matrix changes, so the device memory must be released
+        solver_.release();
+
+        ParentType::cleanup_();
+    }
+
+    OffloadBiCGStab<LinearSolverScalar, numEq> solver_;
+};
+
+}} // namespace Linear, Opm
+
+#endif
@@ -37,7 +37,7 @@
 #include <dune/istl/scalarproducts.hh>
 #include <dune/istl/io.hh>
 #include <algorithm>
-#include <set>
+#include <cstddef>
 #include <map>
 #include <iostream>
 #include <vector>
@@ -58,7 +58,9 @@ public:
     using Overlap = Opm::Linear::DomesticOverlapFromBCRSMatrix;
 
 private:
-    using Entries = std::vector<std::set<Index> >;
+    // the column indices of each row. they may contain duplicates until the matrix
+    // structure is set up
+    using Entries = std::vector<std::vector<Index> >;
 
 public:
     using ColIterator = typename ParentType::ColIterator;
@@ -132,6 +134,21 @@ public:
     const Overlap& overlap() const
     { return *overlap_; }
 
+    /*!
+     * \brief Returns true if the overlapping matrix was built from a non-overlapping
+     *        matrix which seems to have the same sparsity pattern as a given one.
+     *
+     * This is a cheap test which only compares the number of rows and non-zero
+     * entries. It allows to reuse the overlap and the structure of the matrix as long
+     * as the sparsity pattern of the non-overlapping matrix does not change.
+     */
+    template <class NativeBCRSMatrix>
+    bool hasSameStructure(const NativeBCRSMatrix& nativeMatrix) const
+    {
+        return nativeMatrix.N() == nativeNumRows_
+            && nativeMatrix.nonzeroes() == nativeNumNonZeros_;
+    }
+
     /*!
      * \brief Assign and syncronize the overlapping matrix from a non-overlapping one.
      */
@@ -216,9 +233,40 @@ public:
                                 "row");
     }
 
+    /*!
+     * \brief Returns the number of bytes used by the table which maps the entries of
+     *        the non-overlapping matrix to the blocks of the overlapping one.
+     */
+    std::size_t assignmentTableBytes() const
+    {
+        return nativeEntryBlocks_.capacity()*sizeof(block_type*)
+            + nativeRowOffsets_.capacity()*sizeof(std::size_t)
+            + unassignedBlocks_.capacity()*sizeof(block_type*);
+    }
+
     template <class NativeBCRSMatrix>
     void assignFromNative(const NativeBCRSMatrix& nativeMatrix)
     {
+        if (!nativeEntryBlocks_.empty()) {
+            // the blocks which are not assigned from the native matrix are set to 0,
+            // all others are overwritten
+            const std::ptrdiff_t numUnassigned = unassignedBlocks_.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (std::ptrdiff_t i = 0; i < numUnassigned; ++i)
+                *unassignedBlocks_[i] = 0.0;
+
+            const std::ptrdiff_t numNativeRows = nativeMatrix.N();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (std::ptrdiff_t nativeRowIdx = 0; nativeRowIdx < numNativeRows; ++nativeRowIdx)
+                copyRowFromNative_(nativeMatrix, static_cast<unsigned>(nativeRowIdx));
+
+            return;
+        }
+
         // first, set everything to 0,
         BCRSMatrix::operator=(0.0);
 
@@ -229,41 +277,73 @@ public:
                 continue; // row corresponds to a black-listed entry
             }
 
-            auto nativeColIt = nativeMatrix[nativeRowIdx].begin();
-            const auto& nativeColEndIt = nativeMatrix[nativeRowIdx].end();
-            for (; nativeColIt != nativeColEndIt; ++nativeColIt) {
-                Index domesticColIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeColIt.index()));
-
-                // make sure to include all off-diagonal entries, even those which belong
-                // to DOFs which are managed by a peer process. For this, we have to
-                // re-map the column index of the black-listed index to a native one.
-                if (domesticColIdx < 0)
-                    domesticColIdx = overlap_->blackList().nativeToDomestic(static_cast<Index>(nativeColIt.index()));
+            copyRowFromNative_(nativeMatrix, nativeRowIdx, domesticRowIdx);
+        }
+    }
 
-                if (domesticColIdx < 0)
-                    // there is no domestic index which corresponds to a black-listed
-                    // one. this can happen if the grid overlap is larger than the
-                    // algebraic one...
-                    continue;
+    /*!
+     * \brief Update some rows of the overlapping matrix from a non-overlapping one and
+     *        synchronize the result with the peer processes.
+     *
+     * All other rows keep their current values. If none of the updated rows is in the
+     * overlap of any process, no matrix entries are exchanged. Otherwise, all rows in
+     * the overlap are re-assembled and exchanged, since their values are sums of the
+     * contributions of several processes. This method must be called on all
+     * processes, possibly with an empty set of rows.
+     */
+    template <class NativeBCRSMatrix, class NativeRowIndices>
+    void assignAddRows(const NativeBCRSMatrix& nativeMatrix, const NativeRowIndices& nativeRows)
+    {
+        int needsSync = 0;
+        for (const auto nativeRowIdx : nativeRows) {
+            Index domesticRowIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeRowIdx));
+            if (domesticRowIdx < 0)
+                continue; // row corresponds to a black-listed entry
 
-                // we need to copy the block matrices manually since it seems that (at
-                // least some versions of) Dune have an endless recursion bug when
-                // assigning dense matrices of different field type
-                const auto& src = *nativeColIt;
-                auto& dest = (*this)[static_cast<unsigned>(domesticRowIdx)][static_cast<unsigned>(domesticColIdx)];
-                for (unsigned i = 0; i < src.rows; ++i) {
-                    for (unsigned j = 0; j < src.cols; ++j) {
-                        dest[i][j] = static_cast<field_type>(src[i][j]);
-                    }
-                }
+            if (overlap_->isInOverlap(domesticRowIdx)) {
+                // overlapping rows are re-assembled below
+                needsSync = 1;
+                continue;
             }
+
+            (*this)[static_cast<unsigned>(domesticRowIdx)] = 0.0;
+            if (!nativeEntryBlocks_.empty())
+                copyRowFromNative_(nativeMatrix, static_cast<unsigned>(nativeRowIdx));
+            else
+                copyRowFromNative_(nativeMatrix, static_cast<unsigned>(nativeRowIdx), domesticRowIdx);
         }
+
+#if HAVE_MPI
+        MPI_Allreduce(MPI_IN_PLACE, &needsSync, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+#endif
+        if (!needsSync)
+            return;
+
+        for (Index domesticRowIdx = 0; static_cast<size_t>(domesticRowIdx) < overlap_->numDomestic(); ++domesticRowIdx)
+            if (overlap_->isInOverlap(domesticRowIdx))
+                (*this)[static_cast<unsigned>(domesticRowIdx)] = 0.0;
+
+        for (unsigned nativeRowIdx = 0; nativeRowIdx < nativeMatrix.N(); ++nativeRowIdx) {
+            Index domesticRowIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeRowIdx));
+            if (domesticRowIdx < 0 || !overlap_->isInOverlap(domesticRowIdx))
+                continue;
+
+            if (!nativeEntryBlocks_.empty())
+                copyRowFromNative_(nativeMatrix, nativeRowIdx);
+            else
+                copyRowFromNative_(nativeMatrix, nativeRowIdx, domesticRowIdx);
+        }
+
+        syncAdd();
     }
 
     // communicates and adds up the contents of overlapping rows
     void syncAdd()
     {
-        // first, send all entries to the peers
+        // post the receives of the entries from all peers
+        receiveEntriesBegin_();
+
+        // then, send all entries to the peers
         const PeerSet& peerSet = overlap_->peerSet();
         typename PeerSet::const_iterator peerIt = peerSet.begin();
         typename PeerSet::const_iterator peerEndIt = peerSet.end();
@@ -273,7 +353,8 @@ public:
             sendEntries_(peerRank);
         }
 
-        // then, receive entries from the peers
+        // then, wait for the entries of the peers and add them up
+        receiveEntriesEnd_();
         peerIt = peerSet.begin();
         for (; peerIt != peerEndIt; ++peerIt) {
             ProcessRank peerRank = *peerIt;
@@ -294,7 +375,10 @@ public:
     // the master
     void syncCopy()
     {
-        // first, send all entries to the peers
+        // post the receives of the entries from all peers
+        receiveEntriesBegin_();
+
+        // then, send all entries to the peers
         const PeerSet& peerSet = overlap_->peerSet();
         typename PeerSet::const_iterator peerIt = peerSet.begin();
         typename PeerSet::const_iterator peerEndIt = peerSet.end();
@@ -304,7 +388,8 @@ public:
             sendEntries_(peerRank);
         }
 
-        // then, receive entries from the peers
+        // then, wait for the entries of the peers and copy them
+        receiveEntriesEnd_();
         peerIt = peerSet.begin();
         for (; peerIt != peerEndIt; ++peerIt) {
             ProcessRank peerRank = *peerIt;
@@ -322,6 +407,123 @@ public:
     }
 
 private:
+    // copy the entries of a row of the native matrix to the blocks of the overlapping
+    // matrix given by the assignment table
+    template <class NativeBCRSMatrix>
+    void copyRowFromNative_(const NativeBCRSMatrix& nativeMatrix, unsigned nativeRowIdx)
+    {
+        block_type* const* destBlocks = nativeEntryBlocks_.data() + nativeRowOffsets_[nativeRowIdx];
+        auto nativeColIt = nativeMatrix[nativeRowIdx].begin();
+        const auto& nativeColEndIt = nativeMatrix[nativeRowIdx].end();
+        for (; nativeColIt != nativeColEndIt; ++nativeColIt, ++destBlocks) {
+            if (!*destBlocks)
+                continue;
+
+            const auto& src = *nativeColIt;
+            auto& dest = **destBlocks;
+            for (unsigned i = 0; i < src.rows; ++i) {
+                for (unsigned j = 0; j < src.cols; ++j) {
+                    dest[i][j] = static_cast<field_type>(src[i][j]);
+                }
+            }
+        }
+    }
+
+    // map each entry of the native matrix to the block of the overlapping matrix to
+    // which it is copied. this avoids looking up the domestic indices and searching
+    // the columns of the overlapping matrix each time the values are assigned.
+    template <class NativeBCRSMatrix>
+    void buildAssignmentTable_(const NativeBCRSMatrix& nativeMatrix)
+    {
+        nativeRowOffsets_.resize(nativeMatrix.N() + 1);
+        nativeEntryBlocks_.clear();
+        nativeEntryBlocks_.reserve(nativeMatrix.nonzeroes());
+
+        // the blocks of each row are stored contiguously, so the blocks can be
+        // identified by the position of the row and their offset within it
+        std::vector<std::size_t> rowBegin(this->N() + 1, 0);
+        for (unsigned rowIdx = 0; rowIdx < this->N(); ++rowIdx)
+            rowBegin[rowIdx + 1] = rowBegin[rowIdx] + (*this)[rowIdx].size();
+        std::vector<unsigned char> isAssigned(rowBegin.back(), 0);
+        const auto blockIdx = [this, &rowBegin](unsigned rowIdx, const block_type* block)
+        { return rowBegin[rowIdx] + static_cast<std::size_t>(block - &*(*this)[rowIdx].begin()); };
+
+        for (unsigned nativeRowIdx = 0; nativeRowIdx < nativeMatrix.N(); ++nativeRowIdx) {
+            nativeRowOffsets_[nativeRowIdx] = nativeEntryBlocks_.size();
+            const Index domesticRowIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeRowIdx));
+
+            auto nativeColIt = nativeMatrix[nativeRowIdx].begin();
+            const auto& nativeColEndIt = nativeMatrix[nativeRowIdx].end();
+            for (; nativeColIt != nativeColEndIt; ++nativeColIt) {
+                if (domesticRowIdx < 0) {
+                    // row corresponds to a black-listed entry
+                    nativeEntryBlocks_.push_back(nullptr);
+                    continue;
+                }
+
+                // the same mapping of the column indices as in copyRowFromNative_()
+                Index domesticColIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeColIt.index()));
+                if (domesticColIdx < 0)
+                    domesticColIdx = overlap_->blackList().nativeToDomestic(static_cast<Index>(nativeColIt.index()));
+                if (domesticColIdx < 0) {
+                    nativeEntryBlocks_.push_back(nullptr);
+                    continue;
+                }
+
+                block_type* block = &(*this)[static_cast<unsigned>(domesticRowIdx)][static_cast<unsigned>(domesticColIdx)];
+                nativeEntryBlocks_.push_back(block);
+                isAssigned[blockIdx(static_cast<unsigned>(domesticRowIdx), block)] = 1;
+            }
+        }
+        nativeRowOffsets_[nativeMatrix.N()] = nativeEntryBlocks_.size();
+
+        unassignedBlocks_.clear();
+        for (unsigned rowIdx = 0; rowIdx < this->N(); ++rowIdx) {
+            auto colIt = (*this)[rowIdx].begin();
+            const auto& colEndIt = (*this)[rowIdx].end();
+            for (; colIt != colEndIt; ++colIt)
+                if (!isAssigned[blockIdx(rowIdx, &*colIt)])
+                    unassignedBlocks_.push_back(&*colIt);
+        }
+    }
+
+    // copy the entries of a row of the native matrix to the corresponding row of the
+    // overlapping matrix
+    template <class NativeBCRSMatrix>
+    void copyRowFromNative_(const NativeBCRSMatrix& nativeMatrix,
+                            unsigned nativeRowIdx,
+                            Index domesticRowIdx)
+    {
+        auto nativeColIt = nativeMatrix[nativeRowIdx].begin();
+        const auto& nativeColEndIt = nativeMatrix[nativeRowIdx].end();
+        for (; nativeColIt != nativeColEndIt; ++nativeColIt) {
+            Index domesticColIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeColIt.index()));
+
+            // make sure to include all off-diagonal entries, even those which belong
+            // to DOFs which are managed by a peer process. For this, we have to
+            // re-map the column index of the black-listed index to a native one.
+            if (domesticColIdx < 0)
+                domesticColIdx = overlap_->blackList().nativeToDomestic(static_cast<Index>(nativeColIt.index()));
+
+            if (domesticColIdx < 0)
+                // there is no domestic index which corresponds to a black-listed
+                // one. this can happen if the grid overlap is larger than the
+                // algebraic one...
+                continue;
+
+            // we need to copy the block matrices manually since it seems that (at
+            // least some versions of) Dune have an endless recursion bug when
+            // assigning dense matrices of different field type
+            const auto& src = *nativeColIt;
+            auto& dest = (*this)[static_cast<unsigned>(domesticRowIdx)][static_cast<unsigned>(domesticColIdx)];
+            for (unsigned i = 0; i < src.rows; ++i) {
+                for (unsigned j = 0; j < src.cols; ++j) {
+                    dest[i][j] = static_cast<field_type>(src[i][j]);
+                }
+            }
+        }
+    }
+
     template <class NativeBCRSMatrix>
     void build_(const NativeBCRSMatrix& nativeMatrix)
     {
@@ -333,6 +535,11 @@ private:
 
         // communicate the entries
         buildIndices_(nativeMatrix);
+
+        nativeNumRows_ = nativeMatrix.N();
+        nativeNumNonZeros_ = nativeMatrix.nonzeroes();
+
+        buildAssignmentTable_(nativeMatrix);
     }
 
     template <class NativeBCRSMatrix>
@@ -362,7 +569,7 @@ private:
                 if (domesticColIdx < 0)
                     continue;
 
-                entries_[static_cast<unsigned>(domesticRowIdx)].insert(domesticColIdx);
+                entries_[static_cast<unsigned>(domesticRowIdx)].push_back(domesticColIdx);
             }
         }
 
@@ -406,8 +613,15 @@ private:
         // actually initialize the BCRS matrix structure
         /////////
 
-        // set the row sizes
+        // remove the duplicate column indices. this is much cheaper than maintaining
+        // a set for each row while the entries are collected.
         size_t numDomestic = overlap_->numDomestic();
+        for (auto& colIndices : entries_) {
+            std::sort(colIndices.begin(), colIndices.end());
+            colIndices.erase(std::unique(colIndices.begin(), colIndices.end()), colIndices.end());
+        }
+
+        // set the row sizes
         for (unsigned rowIdx = 0; rowIdx < numDomestic; ++rowIdx) {
             unsigned numCols = 0;
             const auto& colIndices = entries_[rowIdx];
@@ -443,6 +657,7 @@ private:
 
         // free the memory occupied by the array of the matrix entries
         entries_.clear();
+        entries_.shrink_to_fit();
     }
 
     // send the overlap indices to a peer
@@ -462,19 +677,16 @@ private:
         rowIndicesSendBuff_[peerRank] = new MpiBuffer<Index>(numOverlapRows);
         rowSizesSendBuff_[peerRank] = new MpiBuffer<unsigned>(numOverlapRows);
 
-        // compute the sets of the indices of the entries which need to be send to the peer
-        using ColumnIndexSet = std::set<int>;
-        using EntryTuples = std::map<int, ColumnIndexSet>;
-
-        EntryTuples entryIndices;
-        unsigned numEntries = 0; // <- total number of matrix entries to be send to the peer
+        // compute the global column indices of the entries which need to be send to the
+        // peer. the indices of all rows are stored in a single array, each row is sorted
+        // and its duplicates are removed afterwards.
+        std::vector<std::size_t> rowOffsets(numOverlapRows + 1, 0);
+        std::vector<Index> entryColIndices;
         for (unsigned overlapOffset = 0; overlapOffset < numOverlapRows; ++overlapOffset) {
             Index domesticRowIdx = overlap_->foreignOverlapOffsetToDomesticIdx(peerRank, overlapOffset);
             Index nativeRowIdx = overlap_->domesticToNative(domesticRowIdx);
-            Index globalRowIdx = overlap_->domesticToGlobal(domesticRowIdx);
-
-            ColumnIndexSet& colIndices = entryIndices[globalRowIdx];
 
+            const auto rowBegin = entryColIndices.size();
             auto nativeColIt = nativeMatrix[static_cast<unsigned>(nativeRowIdx)].begin();
             const auto& nativeColEndIt = nativeMatrix[static_cast<unsigned>(nativeRowIdx)].end();
             for (; nativeColIt != nativeColEndIt; ++nativeColIt) {
@@ -492,31 +704,29 @@ private:
                     // entry.
                     continue;
 
-                Index globalColIdx = overlap_->domesticToGlobal(domesticColIdx);
-                colIndices.insert(globalColIdx);
-                ++numEntries;
+                entryColIndices.push_back(overlap_->domesticToGlobal(domesticColIdx));
             }
-        };
+
+            auto rowBeginIt = entryColIndices.begin() + static_cast<std::ptrdiff_t>(rowBegin);
+            std::sort(rowBeginIt, entryColIndices.end());
+            entryColIndices.erase(std::unique(rowBeginIt, entryColIndices.end()), entryColIndices.end());
+            rowOffsets[overlapOffset + 1] = entryColIndices.size();
+        }
+        const std::size_t numEntries = entryColIndices.size(); // <- total number of matrix entries to be send to the peer
 
         // fill the send buffers
         entryColIndicesSendBuff_[peerRank] = new MpiBuffer<Index>(numEntries);
-        Index overlapEntryIdx = 0;
         for (unsigned overlapOffset = 0; overlapOffset < numOverlapRows; ++overlapOffset) {
             Index domesticRowIdx = overlap_->foreignOverlapOffsetToDomesticIdx(peerRank, overlapOffset);
             Index globalRowIdx = overlap_->domesticToGlobal(domesticRowIdx);
 
             (*rowIndicesSendBuff_[peerRank])[overlapOffset] = globalRowIdx;
 
-            const ColumnIndexSet& colIndexSet = entryIndices[globalRowIdx];
             auto* rssb = rowSizesSendBuff_[peerRank];
-            (*rssb)[overlapOffset] = static_cast<unsigned>(colIndexSet.size());
-            for (auto it = colIndexSet.begin(); it != colIndexSet.end(); ++it) {
-                int globalColIdx = *it;
-
-                (*entryColIndicesSendBuff_[peerRank])[static_cast<unsigned>(overlapEntryIdx)] = globalColIdx;
-                ++ overlapEntryIdx;
-            }
+            (*rssb)[overlapOffset] = static_cast<unsigned>(rowOffsets[overlapOffset + 1] - rowOffsets[overlapOffset]);
         }
+        for (std::size_t entryIdx = 0; entryIdx < numEntries; ++entryIdx)
+            (*entryColIndicesSendBuff_[peerRank])[entryIdx] = entryColIndices[entryIdx];
 
         // actually communicate with the peer
         rowSizesSendBuff_[peerRank]->send(peerRank);
@@ -559,6 +769,7 @@ private:
 
         // communicate with the peer
         entryColIndicesRecvBuff_[peerRank]->receive(peerRank);
+        entryValuesRecvBuffList_.push_back(entryValuesRecvBuff_[peerRank]);
 
         // convert the global indices in the receive buffers to
         // domestic ones
@@ -571,7 +782,7 @@ private:
             Index domRowIdx = (*rowIndicesRecvBuff_[peerRank])[i];
             for (unsigned j = 0; j < (*rowSizesRecvBuff_[peerRank])[i]; ++j) {
                 Index domColIdx = (*entryColIndicesRecvBuff_[peerRank])[k];
-                entries_[static_cast<unsigned>(domRowIdx)].insert(domColIdx);
+                entries_[static_cast<unsigned>(domRowIdx)].push_back(domColIdx);
                 ++k;
             }
         }
@@ -616,8 +827,6 @@ private:
         auto &mpiRowSizesRecvBuff = *rowSizesRecvBuff_[peerRank];
         auto &mpiColIndicesRecvBuff = *entryColIndicesRecvBuff_[peerRank];
 
-        mpiRecvBuff.receive(peerRank);
-
         // retrieve the values from the receive buffer
         unsigned k = 0;
         for (unsigned i = 0; i < mpiRowIndicesRecvBuff.size(); ++i) {
@@ -644,8 +853,6 @@ private:
         MpiBuffer<unsigned> &mpiRowSizesRecvBuff = *rowSizesRecvBuff_[peerRank];
         MpiBuffer<Index> &mpiColIndicesRecvBuff = *entryColIndicesRecvBuff_[peerRank];
 
-        mpiRecvBuff.receive(peerRank);
-
         // retrieve the values from the receive buffer
         unsigned k = 0;
         for (unsigned i = 0; i < mpiRowIndicesRecvBuff.size(); ++i) {
@@ -663,6 +870,22 @@ private:
 #endif // HAVE_MPI
     }
 
+    // start receiving the entries of all peers without blocking
+    void receiveEntriesBegin_()
+    {
+#if HAVE_MPI
+        for (const auto& [peerRank, entryValuesRecvBuff] : entryValuesRecvBuff_)
+            entryValuesRecvBuff->receiveBegin(static_cast<unsigned>(peerRank));
+#endif // HAVE_MPI
+    }
+
+    // wait until the entries of all peers have been received
+    void receiveEntriesEnd_()
+    {
+        MpiBuffer<block_type>::waitAll(entryValuesRecvBuffList_.begin(),
+                                       entryValuesRecvBuffList_.end());
+    }
+
     void globalToDomesticBuff_(MpiBuffer<Index>& idxBuff)
     {
         for (unsigned i = 0; i < idxBuff.size(); ++i)
@@ -671,6 +894,15 @@ private:
 
     int myRank_;
     Entries entries_;
+    // the size of the non-overlapping matrix from which the matrix was built
+    size_t nativeNumRows_ = 0;
+    size_t nativeNumNonZeros_ = 0;
+    // the block of the overlapping matrix for each entry of the non-overlapping one,
+    // null if the entry is not copied, the position of the first entry of each
+    // non-overlapping row, and the blocks which are not assigned from any entry
+    std::vector<block_type*> nativeEntryBlocks_;
+    std::vector<std::size_t> nativeRowOffsets_;
+    std::vector<block_type*> unassignedBlocks_;
     std::shared_ptr<Overlap> overlap_;
 
     std::map<ProcessRank, MpiBuffer<unsigned> *> numRowsSendBuff_;
@@ -684,6 +916,8 @@ private:
     std::map<ProcessRank, MpiBuffer<Index> *> rowIndicesRecvBuff_;
     std::map<ProcessRank, MpiBuffer<Index> *> entryColIndicesRecvBuff_;
     std::map<ProcessRank, MpiBuffer<block_type> *> entryValuesRecvBuff_;
+    // the buffers of entryValuesRecvBuff_, for completing their requests in one go
+    std::vector<MpiBuffer<block_type> *> entryValuesRecvBuffList_;
 };
 
 } // namespace Linear
@@ -38,6 +38,8 @@
 #include <memory>
 #include <map>
 #include <iostream>
+#include <type_traits>
+#include <vector>
 
 namespace Opm {
 namespace Linear {
@@ -70,6 +72,9 @@ public:
         , indicesRecvBuff_(obv.indicesRecvBuff_)
         , valuesSendBuff_(obv.valuesSendBuff_)
         , valuesRecvBuff_(obv.valuesRecvBuff_)
+        , valuesSendBuffList_(obv.valuesSendBuffList_)
+        , valuesRecvBuffList_(obv.valuesRecvBuffList_)
+        , neighborExchange_(obv.neighborExchange_)
         , overlap_(obv.overlap_)
     {}
 
@@ -97,6 +102,9 @@ public:
         indicesRecvBuff_ = obv.indicesRecvBuff_;
         valuesSendBuff_ = obv.valuesSendBuff_;
         valuesRecvBuff_ = obv.valuesRecvBuff_;
+        valuesSendBuffList_ = obv.valuesSendBuffList_;
+        valuesRecvBuffList_ = obv.valuesRecvBuffList_;
+        neighborExchange_ = obv.neighborExchange_;
         overlap_ = obv.overlap_;
         return *this;
     }
@@ -168,17 +176,73 @@ public:
         }
     }
 
+    /*!
+     * \brief Use MPI-3 neighborhood collectives instead of point-to-point messages to
+     *        exchange the overlapping rows with the peer processes.
+     *
+     * This creates a distributed graph communicator from the peers of the overlap and
+     * packs the rows which are exchanged with all peers into one contiguous buffer, so
+     * that each synchronization only requires a single (non-blocking) collective
+     * operation. The setting is shared with all vectors which are copies of this one
+     * and which are created afterwards.
+     */
+    void enableNeighborhoodCollectives()
+    {
+#if HAVE_MPI
+        if (!neighborExchange_)
+            neighborExchange_ = std::make_shared<NeighborExchange_>(*this);
+#endif // HAVE_MPI
+    }
+
     /*!
      * \brief Syncronize all values of the block vector from their
      *        master process.
      */
     void sync()
     {
+        syncBegin();
+        syncEnd();
+    }
+
+    /*!
+     * \brief Start to syncronize the values of the block vector from their master
+     *        process.
+     *
+     * This sends the rows which are in the overlap of the peer processes. Between
+     * this method and syncEnd(), the rows which are not sent may be modified, e.g.,
+     * to overlap the communication with computations on the interior of the grid.
+     */
+    void syncBegin()
+    {
+#if HAVE_MPI
+        if (neighborExchange_) {
+            neighborExchange_->begin(*this);
+            return;
+        }
+#endif // HAVE_MPI
+
+        // post the receives of the entries from all peers before sending anything
+        startReceives_();
+
         // send all entries to all peers
         for (const auto peerRank: overlap_->peerSet())
             sendEntries_(peerRank);
+    }
+
+    /*!
+     * \brief Finish the syncronization started by syncBegin().
+     */
+    void syncEnd()
+    {
+#if HAVE_MPI
+        if (neighborExchange_) {
+            neighborExchange_->end(*this, /*add=*/false);
+            return;
+        }
+#endif // HAVE_MPI
 
         // recieve all entries to the peers
+        MpiBuffer<FieldVector>::waitAll(valuesRecvBuffList_.begin(), valuesRecvBuffList_.end());
         for (const auto peerRank: overlap_->peerSet())
             receiveFromMaster_(peerRank);
 
@@ -192,11 +256,22 @@ public:
      */
     void syncAdd()
     {
+#if HAVE_MPI
+        if (neighborExchange_) {
+            neighborExchange_->begin(*this);
+            neighborExchange_->end(*this, /*add=*/true);
+            return;
+        }
+#endif // HAVE_MPI
+
+        startReceives_();
+
         // send all entries to all peers
         for (const auto peerRank: overlap_->peerSet())
             sendEntries_(peerRank);
 
         // recieve all entries to the peers
+        MpiBuffer<FieldVector>::waitAll(valuesRecvBuffList_.begin(), valuesRecvBuffList_.end());
         for (const auto peerRank: overlap_->peerSet())
             receiveAdd_(peerRank);
 
@@ -213,6 +288,110 @@ public:
     }
 
 private:
+    class NeighborExchange_;
+
+#if HAVE_MPI
+    // exchanges the overlapping rows with all peers using a single neighborhood
+    // collective on a distributed graph communicator. The rows sent to and received
+    // from the peers are stored contiguously in the order of the peers.
+    class NeighborExchange_
+    {
+        static_assert(std::is_trivially_copyable_v<FieldVector>,
+                      "The blocks of the vector must be trivially copyable to be "
+                      "exchanged using neighborhood collectives");
+
+    public:
+        explicit NeighborExchange_(const OverlappingBlockVector& vec)
+        {
+            const Overlap& overlap = *vec.overlap_;
+            for (const auto peerRank : overlap.peerSet()) {
+                peers_.push_back(static_cast<int>(peerRank));
+                const auto& sendIndices = *vec.indicesSendBuff_.at(peerRank);
+                const auto& recvIndices = *vec.indicesRecvBuff_.at(peerRank);
+
+                sendDispls_.push_back(static_cast<int>(sendRows_.size()*sizeof(FieldVector)));
+                sendCounts_.push_back(static_cast<int>(sendIndices.size()*sizeof(FieldVector)));
+                for (unsigned i = 0; i < sendIndices.size(); ++i)
+                    sendRows_.push_back(sendIndices[i]);
+
+                recvDispls_.push_back(static_cast<int>(recvRows_.size()*sizeof(FieldVector)));
+                recvCounts_.push_back(static_cast<int>(recvIndices.size()*sizeof(FieldVector)));
+                for (unsigned i = 0; i < recvIndices.size(); ++i) {
+                    recvRows_.push_back(recvIndices[i]);
+                    recvFromMaster_.push_back(overlap.masterRank(recvIndices[i]) == peerRank);
+                }
+            }
+            sendValues_.resize(sendRows_.size());
+            recvValues_.resize(recvRows_.size());
+
+            // the overlap is symmetric, i.e., we receive from the same processes to
+            // which we send
+            MPI_Dist_graph_create_adjacent(MPI_COMM_WORLD,
+                                           static_cast<int>(peers_.size()),
+                                           peers_.data(),
+                                           MPI_UNWEIGHTED,
+                                           static_cast<int>(peers_.size()),
+                                           peers_.data(),
+                                           MPI_UNWEIGHTED,
+                                           MPI_INFO_NULL,
+                                           /*reorder=*/0,
+                                           &graphComm_);
+        }
+
+        NeighborExchange_(const NeighborExchange_&) = delete;
+        NeighborExchange_& operator=(const NeighborExchange_&) = delete;
+
+        ~NeighborExchange_()
+        {
+            int finalized;
+            MPI_Finalized(&finalized);
+            if (!finalized)
+                MPI_Comm_free(&graphComm_);
+        }
+
+        void begin(const OverlappingBlockVector& vec)
+        {
+            for (std::size_t i = 0; i < sendRows_.size(); ++i)
+                sendValues_[i] = vec[static_cast<unsigned>(sendRows_[i])];
+
+            MPI_Ineighbor_alltoallv(sendValues_.data(), sendCounts_.data(), sendDispls_.data(), MPI_BYTE,
+                                    recvValues_.data(), recvCounts_.data(), recvDispls_.data(), MPI_BYTE,
+                                    graphComm_,
+                                    &request_);
+        }
+
+        void end(OverlappingBlockVector& vec, bool add)
+        {
+            MPI_Wait(&request_, MPI_STATUS_IGNORE);
+
+            for (std::size_t i = 0; i < recvRows_.size(); ++i) {
+                auto& row = vec[static_cast<unsigned>(recvRows_[i])];
+                if (add)
+                    row += recvValues_[i];
+                else if (recvFromMaster_[i])
+                    row = recvValues_[i];
+            }
+        }
+
+    private:
+        std::vector<int> peers_;
+        // the domestic indices of the rows which are sent/received, peer by peer
+        std::vector<Index> sendRows_;
+        std::vector<Index> recvRows_;
+        // whether the sending peer is the master of a received row
+        std::vector<bool> recvFromMaster_;
+        std::vector<FieldVector> sendValues_;
+        std::vector<FieldVector> recvValues_;
+        // the sizes and offsets of the data of each peer in bytes
+        std::vector<int> sendCounts_;
+        std::vector<int> sendDispls_;
+        std::vector<int> recvCounts_;
+        std::vector<int> recvDispls_;
+        MPI_Comm graphComm_;
+        MPI_Request request_;
+    };
+#endif // HAVE_MPI
+
     void createBuffers_()
     {
 #if HAVE_MPI
@@ -288,9 +467,26 @@ private:
                 indicesSendBuff[i] = overlap_->globalToDomestic(indicesSendBuff[i]);
             }
         }
+
+        // the values are exchanged with the same peers in each synchronization, so
+        // we use persistent requests for them
+        peerIt = overlap_->peerSet().begin();
+        for (; peerIt != peerEndIt; ++peerIt) {
+            ProcessRank peerRank = *peerIt;
+            valuesSendBuff_[peerRank]->initPersistentSend(peerRank);
+            valuesRecvBuff_[peerRank]->initPersistentReceive(peerRank);
+            valuesSendBuffList_.push_back(valuesSendBuff_[peerRank].get());
+            valuesRecvBuffList_.push_back(valuesRecvBuff_[peerRank].get());
+        }
 #endif // HAVE_MPI
     }
 
+    void startReceives_()
+    {
+        for (auto* values : valuesRecvBuffList_)
+            values->start();
+    }
+
     void sendEntries_(ProcessRank peerRank)
     {
         // copy the values into the send buffer
@@ -299,29 +495,18 @@ private:
         for (unsigned i = 0; i < indices.size(); ++i)
             values[i] = (*this)[static_cast<unsigned>(indices[i])];
 
-        values.send(peerRank);
+        values.start();
     }
 
     void waitSendFinished_()
     {
-        typename PeerSet::const_iterator peerIt;
-        typename PeerSet::const_iterator peerEndIt = overlap_->peerSet().end();
-
-        // send all entries to all peers
-        peerIt = overlap_->peerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            valuesSendBuff_[peerRank]->wait();
-        }
+        MpiBuffer<FieldVector>::waitAll(valuesSendBuffList_.begin(), valuesSendBuffList_.end());
     }
 
     void receiveFromMaster_(ProcessRank peerRank)
     {
         const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerRank];
-        MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
-
-        // receive the values from the peer
-        values.receive(peerRank);
+        const MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
 
         // copy them into the block vector
         for (unsigned j = 0; j < indices.size(); ++j) {
@@ -335,10 +520,7 @@ private:
     void receiveAdd_(ProcessRank peerRank)
     {
         const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerRank];
-        MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
-
-        // receive the values from the peer
-        values.receive(peerRank);
+        const MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
 
         // add up the values of rows on the shared boundary
         for (unsigned j = 0; j < indices.size(); ++j) {
@@ -352,6 +534,10 @@ private:
     std::map<ProcessRank, std::shared_ptr<MpiBuffer<Index> > > indicesRecvBuff_;
     std::map<ProcessRank, std::shared_ptr<MpiBuffer<FieldVector> > > valuesSendBuff_;
     std::map<ProcessRank, std::shared_ptr<MpiBuffer<FieldVector> > > valuesRecvBuff_;
+    // the value buffers of all peers, for completing their requests in one go
+    std::vector<MpiBuffer<FieldVector>*> valuesSendBuffList_;
+    std::vector<MpiBuffer<FieldVector>*> valuesRecvBuffList_;
+    std::shared_ptr<NeighborExchange_> neighborExchange_;
 
     const Overlap *overlap_;
 };
@@ -0,0 +1,196 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::OverlappingCoarseSpace
+ */
+#ifndef EWOMS_OVERLAPPING_COARSE_SPACE_HH
+#define EWOMS_OVERLAPPING_COARSE_SPACE_HH
+
+#include "overlaptypes.hh"
+
+#include <opm/common/Exceptions.hpp>
+
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <string>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief A coarse space with one degree of freedom per process and equation for the
+ *        overlapping Schwarz preconditioner.
+ *
+ * The overlapping preconditioner applies the sequential preconditioner to the rows of
+ * each process including its overlap and then keeps the values of the rows which the
+ * process is the master of, i.e., it is a restricted additive Schwarz method. Since
+ * information only travels by one subdomain per iteration, the number of iterations
+ * grows with the number of processes. This class adds a multiplicative coarse
+ * correction using the piecewise constant functions of each subdomain and equation
+ * (Nicolaides coarse space):
+ *
+ * \f[ x \leftarrow x + R_0^T A_0^{-1} R_0 (d - A x)\;, \quad A_0 = R_0 A R_0^T\;, \f]
+ *
+ * where \f$R_0\f$ sums the rows of each equation over the master rows of a process.
+ * The coarse matrix has the size number of processes times number of equations. It is
+ * gathered on all processes and inverted redundantly, so it is intended for moderate
+ * process counts.
+ */
+template <class OverlappingMatrix, class OverlappingVector>
+class OverlappingCoarseSpace
+{
+    using Overlap = typename OverlappingMatrix::Overlap;
+    using Scalar = typename OverlappingVector::field_type;
+    using CollectiveCommunication = typename Dune::Communication<typename Dune::MPIHelper::MPICommunicator>;
+
+    static constexpr int numEq = OverlappingVector::block_type::dimension;
+
+public:
+    explicit OverlappingCoarseSpace(const OverlappingMatrix& matrix)
+        : matrix_(matrix)
+        , overlap_(matrix.overlap())
+        , comm_(Dune::MPIHelper::getCommunication())
+    {
+        const unsigned n = size();
+        coarseMatrixInverse_.resize(n, n);
+        coarseRhs_.resize(n);
+        coarseSol_.resize(n);
+    }
+
+    /*!
+     * \brief Returns the number of degrees of freedom of the coarse space.
+     */
+    unsigned size() const
+    { return overlap_.worldSize()*numEq; }
+
+    /*!
+     * \brief Assemble and invert the coarse matrix.
+     *
+     * This must be called on all processes whenever the values of the matrix have
+     * changed.
+     */
+    void update()
+    {
+        const unsigned n = size();
+
+        // the rows of the coarse matrix which belong to the local process
+        std::vector<Scalar> localRows(numEq*n, 0.0);
+        const unsigned numLocal = static_cast<unsigned>(overlap_.numLocal());
+        for (unsigned rowIdx = 0; rowIdx < numLocal; ++rowIdx) {
+            if (!overlap_.iAmMasterOf(static_cast<Index>(rowIdx)))
+                continue;
+
+            const auto& row = matrix_[rowIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                const unsigned coarseColIdx =
+                    overlap_.masterRank(static_cast<Index>(colIt.index()))*numEq;
+                for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    for (int pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                        localRows[eqIdx*n + coarseColIdx + pvIdx] += (*colIt)[eqIdx][pvIdx];
+            }
+        }
+
+        std::vector<Scalar> rows(n*n);
+        comm_.allgather(localRows.data(), static_cast<int>(localRows.size()), rows.data());
+
+        for (unsigned i = 0; i < n; ++i) {
+            bool isZero = true;
+            for (unsigned j = 0; j < n; ++j) {
+                coarseMatrixInverse_[i][j] = rows[i*n + j];
+                isZero = isZero && rows[i*n + j] == 0.0;
+            }
+
+            // processes without any rows of their own do not contribute to the coarse
+            // space
+            if (isZero)
+                coarseMatrixInverse_[i][i] = 1.0;
+        }
+
+        // all processes invert the same matrix, so they either all succeed or all fail
+        try {
+            coarseMatrixInverse_.invert();
+        }
+        catch (const Dune::FMatrixError& e) {
+            throw NumericalProblem(std::string("The coarse matrix of the overlapping "
+                                               "preconditioner is singular: ")+e.what());
+        }
+    }
+
+    /*!
+     * \brief Apply the coarse correction to the result of the overlapping
+     *        preconditioner.
+     *
+     * The values of x must be consistent on all processes, i.e., they must have been
+     * synchronized. This is the case after the correction as well.
+     */
+    void correct(OverlappingVector& x, const OverlappingVector& d)
+    {
+        // restrict the residual of the master rows to the coarse space. since the
+        // overlap is at least one layer wide, the rows of the master indices are
+        // complete.
+        Scalar localResidual[numEq] = {};
+        typename OverlappingVector::block_type r;
+        const unsigned numLocal = static_cast<unsigned>(overlap_.numLocal());
+        for (unsigned rowIdx = 0; rowIdx < numLocal; ++rowIdx) {
+            if (!overlap_.iAmMasterOf(static_cast<Index>(rowIdx)))
+                continue;
+
+            r = d[rowIdx];
+            const auto& row = matrix_[rowIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                colIt->mmv(x[colIt.index()], r);
+
+            for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                localResidual[eqIdx] += r[eqIdx];
+        }
+
+        comm_.allgather(localResidual, numEq, &coarseRhs_[0]);
+        coarseMatrixInverse_.mv(coarseRhs_, coarseSol_);
+
+        // prolongate the coarse solution to all domestic rows
+        const unsigned numDomestic = static_cast<unsigned>(overlap_.numDomestic());
+        for (unsigned rowIdx = 0; rowIdx < numDomestic; ++rowIdx) {
+            const unsigned coarseIdx = overlap_.masterRank(static_cast<Index>(rowIdx))*numEq;
+            for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                x[rowIdx][eqIdx] += coarseSol_[coarseIdx + eqIdx];
+        }
+    }
+
+private:
+    const OverlappingMatrix& matrix_;
+    const Overlap& overlap_;
+    CollectiveCommunication comm_;
+
+    Dune::DynamicMatrix<Scalar> coarseMatrixInverse_;
+    Dune::DynamicVector<Scalar> coarseRhs_;
+    Dune::DynamicVector<Scalar> coarseSol_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
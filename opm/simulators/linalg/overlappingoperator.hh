@@ -27,14 +27,22 @@
 #ifndef EWOMS_OVERLAPPING_OPERATOR_HH
 #define EWOMS_OVERLAPPING_OPERATOR_HH
 
+#include <opm/simulators/linalg/blockspmv.hh>
+
 #include <dune/istl/operators.hh>
 #include <dune/common/version.hh>
 
+#include <cstddef>
+#include <vector>
+
 namespace Opm {
 namespace Linear {
 
 /*!
  * \brief An overlap aware linear operator usable by ISTL.
+ *
+ * The matrix-vector products are computed by the multi-threaded kernels of
+ * blockspmv.hh.
  */
 template <class OverlappingMatrix, class DomainVector, class RangeVector>
 class OverlappingOperator
@@ -57,16 +65,36 @@ public:
     //! apply operator to x:  \f$ y = A(x) \f$
     virtual void apply(const DomainVector& x, RangeVector& y) const override
     {
-        A_.mv(x, y);
-        y.sync();
+        if (overlap().peerSet().empty()) {
+            blockMv(A_, x, y);
+            y.sync();
+            return;
+        }
+
+        // first compute the rows which need to be sent to the peer processes, then
+        // compute the remaining ones while the messages are in flight
+        updateRowPartition_();
+        blockMv(A_, x, y, sendRows_);
+        y.syncBegin();
+        blockMv(A_, x, y, otherRows_);
+        y.syncEnd();
     }
 
     //! apply operator to x, scale and add:  \f$ y = y + \alpha A(x) \f$
     virtual void applyscaleadd(field_type alpha, const DomainVector& x,
                                RangeVector& y) const override
     {
-        A_.usmv(alpha, x, y);
-        y.sync();
+        if (overlap().peerSet().empty()) {
+            blockUsmv(alpha, A_, x, y);
+            y.sync();
+            return;
+        }
+
+        updateRowPartition_();
+        blockUsmv(alpha, A_, x, y, sendRows_);
+        y.syncBegin();
+        blockUsmv(alpha, A_, x, y, otherRows_);
+        y.syncEnd();
     }
 
     //! returns the matrix
@@ -77,7 +105,34 @@ public:
     { return A_.overlap(); }
 
 private:
+    // split the rows into the ones which are sent to some peer process when the range
+    // vector is synchronized and the remaining ones
+    void updateRowPartition_() const
+    {
+        const std::size_t numRows = A_.N();
+        if (sendRows_.size() + otherRows_.size() == numRows)
+            return;
+
+        std::vector<bool> isSendRow(numRows, false);
+        for (const auto peerRank : overlap().peerSet()) {
+            const std::size_t numEntries = overlap().foreignOverlapSize(peerRank);
+            for (unsigned i = 0; i < numEntries; ++i)
+                isSendRow[overlap().foreignOverlapOffsetToDomesticIdx(peerRank, i)] = true;
+        }
+
+        sendRows_.clear();
+        otherRows_.clear();
+        for (unsigned rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            if (isSendRow[rowIdx])
+                sendRows_.push_back(rowIdx);
+            else
+                otherRows_.push_back(rowIdx);
+        }
+    }
+
     const OverlappingMatrix& A_;
+    mutable std::vector<unsigned> sendRows_;
+    mutable std::vector<unsigned> otherRows_;
 };
 
 } // namespace Linear
@@ -35,11 +35,21 @@
 
 #include <dune/common/version.hh>
 
+#include <functional>
+#include <utility>
+
 namespace Opm {
 namespace Linear {
 
 /*!
  * \brief An overlap aware preconditioner for any ISTL linear solver.
+ *
+ * The sequential preconditioner is applied to all rows of the process including its
+ * overlap, afterwards the values of the rows for which the process is not the master
+ * are overwritten by the ones of their master processes (restricted additive
+ * Schwarz). The width of the overlap is determined by the overlapping matrix. An
+ * optional coarse correction, e.g., OverlappingCoarseSpace, can be applied after
+ * each application.
  */
 template <class SeqPreCond, class Overlap>
 class OverlappingPreconditioner
@@ -58,6 +68,16 @@ public:
         : seqPreCond_(seqPreCond), overlap_(&overlap)
     {}
 
+    /*!
+     * \brief Set a function which corrects the result of each application of the
+     *        preconditioner.
+     *
+     * The function is called with the synchronized result x and the defect d. It must
+     * be called on all processes and keep x synchronized.
+     */
+    void setCoarseCorrection(std::function<void(domain_type&, const range_type&)> fn)
+    { coarseCorrection_ = std::move(fn); }
+
     void pre(domain_type& x, range_type& y) override
     {
 #if HAVE_MPI
@@ -138,6 +158,9 @@ public:
         else
 #endif // HAVE_MPI
             seqPreCond_.apply(x, d);
+
+        if (coarseCorrection_)
+            coarseCorrection_(x, d);
     }
 
     void post(domain_type& x) override
@@ -180,6 +203,7 @@ public:
 private:
     SeqPreCond& seqPreCond_;
     const Overlap *overlap_;
+    std::function<void(domain_type&, const range_type&)> coarseCorrection_;
 };
 
 } // namespace Linear
@@ -33,12 +33,34 @@
 namespace Opm {
 namespace Linear {
 
+/*!
+ * \brief An ISTL scalar product which is able to compute several scalar products
+ *        using a single global reduction.
+ */
+template <class Vector>
+class MultiDotScalarProduct : public Dune::ScalarProduct<Vector>
+{
+public:
+    using field_type = typename Vector::field_type;
+
+    /*!
+     * \brief Compute the scalar products result[i] = (x[i], y[i]) for i < n.
+     *
+     * In parallel, this only requires a single collective communication operation
+     * instead of one for each scalar product.
+     */
+    virtual void dots(const Vector* const* x,
+                      const Vector* const* y,
+                      field_type* result,
+                      unsigned n) const = 0;
+};
+
 /*!
  * \brief An overlap aware ISTL scalar product.
  */
 template <class OverlappingBlockVector, class Overlap>
 class OverlappingScalarProduct
-    : public Dune::ScalarProduct<OverlappingBlockVector>
+    : public MultiDotScalarProduct<OverlappingBlockVector>
 {
 public:
     using field_type = typename OverlappingBlockVector::field_type;
@@ -58,21 +80,47 @@ public:
     field_type dot(const OverlappingBlockVector& x,
                    const OverlappingBlockVector& y) const override
     {
-        field_type sum = 0;
+        // return the global sum
+        return comm_.sum( localDot_(x, y) );
+    }
+
+    void dots(const OverlappingBlockVector* const* x,
+              const OverlappingBlockVector* const* y,
+              field_type* result,
+              unsigned n) const override
+    {
+        // compute the local contributions in a single pass over the rows
+        for (unsigned i = 0; i < n; ++i)
+            result[i] = 0.0;
         size_t numLocal = overlap_.numLocal();
         for (unsigned localIdx = 0; localIdx < numLocal; ++localIdx) {
-            if (overlap_.iAmMasterOf(static_cast<int>(localIdx)))
-                sum += x[localIdx] * y[localIdx];
+            if (!overlap_.iAmMasterOf(static_cast<int>(localIdx)))
+                continue;
+
+            for (unsigned i = 0; i < n; ++i)
+                result[i] += (*x[i])[localIdx] * (*y[i])[localIdx];
         }
 
-        // return the global sum
-        return comm_.sum( sum );
+        // compute all global sums at once
+        comm_.sum(result, static_cast<int>(n));
     }
 
     real_type norm(const OverlappingBlockVector& x) const override
     { return std::sqrt(dot(x, x)); }
 
 private:
+    field_type localDot_(const OverlappingBlockVector& x,
+                         const OverlappingBlockVector& y) const
+    {
+        field_type sum = 0;
+        size_t numLocal = overlap_.numLocal();
+        for (unsigned localIdx = 0; localIdx < numLocal; ++localIdx) {
+            if (overlap_.iAmMasterOf(static_cast<int>(localIdx)))
+                sum += x[localIdx] * y[localIdx];
+        }
+        return sum;
+    }
+
     const Overlap& overlap_;
     const CollectiveCommunication comm_;
 };
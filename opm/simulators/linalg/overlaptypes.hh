@@ -30,6 +30,7 @@
 #define EWOMS_OVERLAP_TYPES_HH
 
 #include <cstddef>
+#include <cstdint>
 #include <list>
 #include <map>
 #include <set>
@@ -122,7 +123,7 @@ using BorderList = std::list<BorderIndex>;
 /*!
  * \brief The list of indices which are on the process boundary.
  */
-class SeedList : public std::list<IndexRankDist>
+class SeedList : public std::vector<IndexRankDist>
 {
 public:
     void update(const BorderList& borderList)
@@ -142,6 +143,116 @@ public:
     }
 };
 
+/*!
+ * \brief A map between indices which stores its entries in a flat array.
+ *
+ * The keys must be non-negative. Collisions are resolved by linear probing, so in
+ * contrast to std::map, inserting an entry only allocates memory if the table needs to
+ * grow.
+ */
+class IndexMap
+{
+    struct Slot
+    {
+        Index key;
+        Index value;
+    };
+
+public:
+    /*!
+     * \brief Make sure that a given number of entries can be inserted without
+     *        growing the table.
+     */
+    void reserve(std::size_t numEntries)
+    {
+        if (2*numEntries > slots_.size())
+            rehash_(numEntries);
+    }
+
+    /*!
+     * \brief Returns the number of entries of the map.
+     */
+    std::size_t size() const
+    { return size_; }
+
+    /*!
+     * \brief Returns true iff the map contains an entry for a given key.
+     */
+    bool contains(Index key) const
+    { return findSlot_(key) != npos_; }
+
+    /*!
+     * \brief Returns the value of a key or -1 if the map does not contain the key.
+     */
+    Index find(Index key) const
+    {
+        const std::size_t slotIdx = findSlot_(key);
+        return slotIdx == npos_ ? -1 : slots_[slotIdx].value;
+    }
+
+    /*!
+     * \brief Set the value of a key, i.e., insert the key if necessary.
+     */
+    void set(Index key, Index value)
+    {
+        if (2*(size_ + 1) > slots_.size())
+            rehash_(size_ + 1);
+
+        const std::size_t mask = slots_.size() - 1;
+        std::size_t slotIdx = hash_(key) & mask;
+        while (slots_[slotIdx].key != emptyKey_ && slots_[slotIdx].key != key)
+            slotIdx = (slotIdx + 1) & mask;
+
+        if (slots_[slotIdx].key == emptyKey_) {
+            slots_[slotIdx].key = key;
+            ++size_;
+        }
+        slots_[slotIdx].value = value;
+    }
+
+private:
+    static constexpr Index emptyKey_ = -1;
+    static constexpr std::size_t npos_ = static_cast<std::size_t>(-1);
+
+    static std::size_t hash_(Index key)
+    { return static_cast<std::size_t>((static_cast<std::uint64_t>(key)*0x9E3779B97F4A7C15ull) >> 32); }
+
+    std::size_t findSlot_(Index key) const
+    {
+        if (slots_.empty())
+            return npos_;
+
+        const std::size_t mask = slots_.size() - 1;
+        std::size_t slotIdx = hash_(key) & mask;
+        while (slots_[slotIdx].key != emptyKey_) {
+            if (slots_[slotIdx].key == key)
+                return slotIdx;
+            slotIdx = (slotIdx + 1) & mask;
+        }
+        return npos_;
+    }
+
+    // grow the table such that it is at most half full with the given number of
+    // entries and re-insert all existing entries
+    void rehash_(std::size_t numEntries)
+    {
+        std::size_t capacity = 16;
+        while (capacity < 2*numEntries)
+            capacity *= 2;
+
+        std::vector<Slot> oldSlots(capacity, Slot{emptyKey_, -1});
+        oldSlots.swap(slots_);
+        size_ = 0;
+        for (const auto& slot : oldSlots) {
+            if (slot.key != emptyKey_)
+                set(slot.key, slot.value);
+        }
+    }
+
+    std::vector<Slot> slots_;
+    std::size_t size_ = 0;
+};
+
 /*!
  * \brief A set of process ranks
  */
@@ -39,6 +39,8 @@
 #include <dune/istl/owneroverlapcopy.hh>
 
 #include <memory>
+#include <stdexcept>
+#include <string>
 #include <tuple>
 #include <utility>
 
@@ -59,6 +61,13 @@ struct ParallelAmgLinearSolver { using InheritsFrom = std::tuple<ParallelBaseLin
 template<class TypeTag>
 struct AmgCoarsenTarget<TypeTag, TTag::ParallelAmgLinearSolver> { static constexpr int value = 5000; };
 
+//! By default, the AMG hierarchy is completely rebuilt for each linear solve
+template<class TypeTag>
+struct AmgReuseMode<TypeTag, TTag::ParallelAmgLinearSolver> { static constexpr auto value = "none"; };
+
+template<class TypeTag>
+struct AmgReuseInterval<TypeTag, TTag::ParallelAmgLinearSolver> { static constexpr int value = 5; };
+
 template<class TypeTag>
 struct LinearSolverMaxError<TypeTag, TTag::ParallelAmgLinearSolver>
 {
@@ -79,6 +88,17 @@ namespace Linear {
  *
  * \brief Provides a linear solver backend using the parallel
  *        algebraic multi-grid (AMG) linear solver from DUNE-ISTL.
+ *
+ * Setting up the AMG hierarchy is expensive. Depending on the AmgReuseMode
+ * parameter, parts of it can thus be kept for up to AmgReuseInterval consecutive
+ * linear solves:
+ * - \c none: The hierarchy is rebuilt for each linear solve
+ * - \c coarsening: The aggregates are kept and only the Galerkin products of the
+ *                  coarse level operators are recomputed from the current matrix
+ * - \c hierarchy: The complete hierarchy is kept, i.e., only the fine level
+ *                 operator and smoother use the current matrix
+ *
+ * The hierarchy is always rebuilt if the structure of the linear system changes.
  */
 template <class TypeTag>
 class ParallelAmgBackend : public ParallelBaseBackend<TypeTag>
@@ -141,10 +161,26 @@ class ParallelAmgBackend : public ParallelBaseBackend<TypeTag>
     static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock> >::value,
                   "The ParallelAmgBackend linear solver backend requires the IstlSparseMatrixAdapter");
 
+    enum class ReuseMode { None, Coarsening, Hierarchy };
+
 public:
     ParallelAmgBackend(const Simulator& simulator)
         : ParentType(simulator)
-    { }
+        , reuseInterval_(Parameters::get<TypeTag, Properties::AmgReuseInterval>())
+        , numReuses_(0)
+        , amgIsCurrent_(false)
+    {
+        const std::string reuseMode = Parameters::get<TypeTag, Properties::AmgReuseMode>();
+        if (reuseMode == "none")
+            reuseMode_ = ReuseMode::None;
+        else if (reuseMode == "coarsening")
+            reuseMode_ = ReuseMode::Coarsening;
+        else if (reuseMode == "hierarchy")
+            reuseMode_ = ReuseMode::Hierarchy;
+        else
+            throw std::invalid_argument("Unknown reuse mode for the AMG hierarchy: '"
+                                        +reuseMode+"'");
+    }
 
     static void registerParameters()
     {
@@ -156,13 +192,45 @@ public:
         Parameters::registerParam<TypeTag, Properties::AmgCoarsenTarget>
             ("The coarsening target for the agglomerations of "
              "the AMG preconditioner");
+        Parameters::registerParam<TypeTag, Properties::AmgReuseMode>
+            ("The parts of the AMG hierarchy which are kept between linear solves. "
+             "Possible values: 'none', 'coarsening' and 'hierarchy'");
+        Parameters::registerParam<TypeTag, Properties::AmgReuseInterval>
+            ("The maximum number of consecutive linear solves for which the AMG "
+             "hierarchy is reused");
     }
 
 protected:
     friend ParentType;
 
+    void cleanup_()
+    {
+        // the AMG references the overlapping matrix, so it must be rebuilt
+        amg_.reset();
+        fineOperator_.reset();
+#if HAVE_MPI
+        istlComm_.reset();
+#endif
+
+        ParentType::cleanup_();
+    }
+
     std::shared_ptr<AMG> preparePreconditioner_()
     {
+        // the matrix did not change since the AMG was set up
+        if (amg_ && amgIsCurrent_)
+            return amg_;
+
+        if (amg_ && reuseMode_ != ReuseMode::None && numReuses_ < reuseInterval_) {
+            ++numReuses_;
+            if (reuseMode_ == ReuseMode::Coarsening)
+                amg_->recalculateHierarchy();
+
+            amgIsCurrent_ = true;
+            return amg_;
+        }
+        numReuses_ = 0;
+
 #if HAVE_MPI
         // create and initialize DUNE's OwnerOverlapCopyCommunication
         // using the domestic overlap
@@ -179,12 +247,13 @@ protected:
 #endif
 
         setupAmg_();
+        amgIsCurrent_ = true;
 
         return amg_;
     }
 
     void cleanupPreconditioner_()
-    { /* nothing to do */ }
+    { amgIsCurrent_ = false; }
 
     std::shared_ptr<RawLinearSolver> prepareSolver_(ParallelOperator& parOperator,
                                                     ParallelScalarProduct& parScalarProduct,
@@ -193,7 +262,7 @@ protected:
         const auto& gridView = this->simulator_.gridView();
         using CCC = CombinedCriterion<OverlappingVector, decltype(gridView.comm())>;
 
-        Scalar linearSolverTolerance = Parameters::get<TypeTag, Properties::LinearSolverTolerance>();
+        Scalar linearSolverTolerance = this->linearSolverTolerance();
         Scalar linearSolverAbsTolerance = Parameters::get<TypeTag, Properties::LinearSolverAbsTolerance>();
         if(linearSolverAbsTolerance < 0.0)
             linearSolverAbsTolerance = this->simulator_.model().newtonMethod().tolerance()/100.0;
@@ -223,6 +292,11 @@ protected:
         return std::make_pair(converged, int(solver->report().iterations()));
     }
 
+    void updateReport_(const std::shared_ptr<RawLinearSolver>& solver,
+                       const std::pair<bool, int>&,
+                       const Timer&)
+    { this->report_ += solver->report(); }
+
     void cleanupSolver_()
     { /* nothing to do */ }
 
@@ -318,6 +392,11 @@ protected:
     std::shared_ptr<FineOperator> fineOperator_;
     std::shared_ptr<AMG> amg_;
 
+    ReuseMode reuseMode_;
+    int reuseInterval_;
+    int numReuses_;
+    bool amgIsCurrent_;
+
 #if HAVE_MPI
     std::shared_ptr<OwnerOverlapCopyCommunication> istlComm_;
 #endif
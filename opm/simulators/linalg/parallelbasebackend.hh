@@ -32,13 +32,19 @@
 #include <opm/simulators/linalg/istlsparsematrixadapter.hh>
 #include <opm/simulators/linalg/overlappingbcrsmatrix.hh>
 #include <opm/simulators/linalg/overlappingblockvector.hh>
+#include <opm/simulators/linalg/overlappingcoarsespace.hh>
 #include <opm/simulators/linalg/overlappingpreconditioner.hh>
 #include <opm/simulators/linalg/overlappingscalarproduct.hh>
+#include <opm/simulators/linalg/ruizequilibration.hh>
 #include <opm/simulators/linalg/overlappingoperator.hh>
 #include <opm/simulators/linalg/parallelbasebackend.hh>
 #include <opm/simulators/linalg/istlpreconditionerwrappers.hh>
+#include <opm/simulators/linalg/linearsolverreport.hh>
+#include <opm/simulators/linalg/linearsystemio.hh>
 
-#include <opm/models/utils/genericguard.hh>
+#include <opm/models/utils/memoryusage.hh>
+#include <opm/models/utils/timer.hh>
+#include <opm/models/utils/timerguard.hh>
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/simulators/linalg/matrixblock.hh>
@@ -49,9 +55,14 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
 #include <sstream>
 #include <memory>
 #include <iostream>
+#include <optional>
+#include <string>
 
 namespace Opm::Properties {
 
@@ -65,9 +76,9 @@ template<class TypeTag>
 struct SparseMatrixAdapter<TypeTag, TTag::ParallelBaseLinearSolver>
 {
 private:
-    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using JacobianScalar = GetPropType<TypeTag, Properties::JacobianScalar>;
     enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
-    using Block = Opm::MatrixBlock<Scalar, numEq, numEq>;
+    using Block = Opm::MatrixBlock<JacobianScalar, numEq, numEq>;
 
 public:
     using type = typename Opm::Linear::IstlSparseMatrixAdapter<Block>;
@@ -103,6 +114,11 @@ namespace Linear {
  *            that it is computationally cheaper because it does not
  *            need to consider things which are only required for
  *            higher orders
+ * - \c MixedPrecisionILU: An ILU preconditioner which is set up and
+ *            applied on a single precision copy of the matrix while
+ *            the Krylov method works in the precision of the system
+ * - \c ParallelILU0: An ILU(0) preconditioner which is computed and
+ *            applied using all threads of the process
  */
 template <class TypeTag>
 class ParallelBaseBackend
@@ -126,6 +142,8 @@ protected:
     using SequentialPreconditioner = typename PreconditionerWrapper::SequentialPreconditioner;
 
     using ParallelPreconditioner = Opm::Linear::OverlappingPreconditioner<SequentialPreconditioner, Overlap>;
+    using CoarseSpace = Opm::Linear::OverlappingCoarseSpace<OverlappingMatrix, OverlappingVector>;
+    using Equilibration = Opm::Linear::RuizEquilibration<OverlappingMatrix, OverlappingVector>;
     using ParallelScalarProduct = Opm::Linear::OverlappingScalarProduct<OverlappingVector, Overlap>;
     using ParallelOperator = Opm::Linear::OverlappingOperator<OverlappingMatrix,
                                                               OverlappingVector,
@@ -138,10 +156,21 @@ public:
         : simulator_(simulator)
         , gridSequenceNumber_( -1 )
         , lastIterations_( -1 )
+        , linearSolverTolerance_( -1.0 )
+        , preconditionerIsPrepared_( false )
     {
         overlappingMatrix_ = nullptr;
         overlappingb_ = nullptr;
         overlappingx_ = nullptr;
+
+        lastUpdate_ = nullptr;
+        firstUpdate_ = nullptr;
+        curRhsNorm_ = 0.0;
+        lastRhsNorm_ = 0.0;
+        firstUpdateDt_ = 0.0;
+        lastTimeStepIdx_ = -1;
+        hasInitialGuess_ = false;
+        matrixIsScaled_ = false;
     }
 
     ~ParallelBaseBackend()
@@ -158,34 +187,80 @@ public:
             ("The maximum accepted error of the norm of the residual");
         Parameters::registerParam<TypeTag, Properties::LinearSolverOverlapSize>
             ("The size of the algebraic overlap for the linear solver");
+        Parameters::registerParam<TypeTag, Properties::LinearSolverEquilibration>
+            ("The number of iterations of the Ruiz equilibration which scales the rows and "
+             "columns of the linear system before it is solved (0 disables scaling)");
+        Parameters::registerParam<TypeTag, Properties::LinearSolverCoarseSpace>
+            ("Add a coarse correction with one unknown per process and equation to the "
+             "overlapping preconditioner");
+        Parameters::registerParam<TypeTag, Properties::LinearSolverNeighborhoodCollectives>
+            ("Use MPI neighborhood collectives to exchange the overlapping rows of "
+             "the vectors of the linear solver");
         Parameters::registerParam<TypeTag, Properties::LinearSolverMaxIterations>
             ("The maximum number of iterations of the linear solver");
         Parameters::registerParam<TypeTag, Properties::LinearSolverVerbosity>
             ("The verbosity level of the linear solver");
+        Parameters::registerParam<TypeTag, Properties::LinearSolverWarmStart>
+            ("Start the linear solver from an extrapolation of the previous Newton "
+             "updates instead of the zero vector, if the solver supports it");
+        Parameters::registerParam<TypeTag, Properties::LinearSystemDumpDir>
+            ("The directory to which the linear systems of equations are written for "
+             "benchmarking the linear solvers offline. Nothing is written if this is empty");
+        Parameters::registerParam<TypeTag, Properties::LinearSystemDumpNewtonIteration>
+            ("The Newton iteration for which the linear systems are written (-1 means all)");
+        Parameters::registerParam<TypeTag, Properties::LinearSystemDumpSolution>
+            ("Also write the solution of the linear systems of equations");
 
         PreconditionerWrapper::registerParameters();
     }
 
+    /*!
+     * \brief Set the reduction of the residual which the linear solver needs to achieve.
+     *
+     * This overwrites the value of the LinearSolverTolerance parameter, e.g., for
+     * inexact Newton methods. Passing a negative value restores the parameter.
+     */
+    void setLinearSolverTolerance(Scalar value)
+    { linearSolverTolerance_ = value; }
+
+    /*!
+     * \brief Returns the reduction of the residual which the linear solver needs to
+     *        achieve.
+     */
+    Scalar linearSolverTolerance() const
+    {
+        if (linearSolverTolerance_ < 0.0)
+            return Parameters::get<TypeTag, Properties::LinearSolverTolerance>();
+        return linearSolverTolerance_;
+    }
+
     /*!
      * \brief Causes the solve() method to discared the structure of the linear system of
      *        equations the next time it is called.
      */
     void eraseMatrix()
-    { cleanup_(); }
+    { asImp_().cleanup_(); }
 
     /*!
      * \brief Set up the internal data structures required for the linear solver.
      *
      * This only specified the topology of the linear system of equations; it does does
      * *not* assign the values of the residual vector and its Jacobian matrix.
+     *
+     * The overlap and the structure of the overlapping matrix are kept until the grid
+     * or the sparsity pattern of the Jacobian matrix changes, or until eraseMatrix() is
+     * called, i.e., in the common case only the values of the matrix are assigned and
+     * synchronized by setMatrix().
      */
     void prepare(const SparseMatrixAdapter& M, const Vector& )
     {
         // if grid has changed the sequence number has changed too
         int curSeqNum = simulator_.vanguard().gridSequenceNumber();
-        if (gridSequenceNumber_ == curSeqNum && overlappingMatrix_)
-            // the grid has not changed since the overlappingMatrix_has been created, so
-            // there's noting to do
+        if (gridSequenceNumber_ == curSeqNum
+            && overlappingMatrix_
+            && overlappingMatrix_->hasSameStructure(M.istlMatrix()))
+            // neither the grid nor the sparsity pattern have changed since the
+            // overlappingMatrix_has been created, so there's noting to do
             return;
 
         asImp_().cleanup_();
@@ -204,11 +279,37 @@ public:
         // create the overlapping vectors for the residual and the
         // solution
         overlappingb_ = new OverlappingVector(overlappingMatrix_->overlap());
+        if (Parameters::get<TypeTag, Properties::LinearSolverNeighborhoodCollectives>())
+            overlappingb_->enableNeighborhoodCollectives();
         overlappingx_ = new OverlappingVector(*overlappingb_);
 
+        // the parallel scalar product and operator only refer to the overlap and the
+        // overlapping matrix, so they are kept as long as the structure is unchanged
+        parScalarProduct_ = std::make_unique<ParallelScalarProduct>(overlappingMatrix_->overlap());
+        parOperator_ = std::make_unique<ParallelOperator>(*overlappingMatrix_);
+
         // writeOverlapToVTK_();
     }
 
+    /*!
+     * \brief Add the number of bytes held by the linear solver to a memory usage report.
+     */
+    void reportMemoryUsage(MemoryUsage& usage) const
+    {
+        if (!overlappingMatrix_)
+            return;
+
+        usage.add("Overlapping matrix", MemoryUsage::bcrsMatrixBytes(*overlappingMatrix_)
+                  + overlappingMatrix_->assignmentTableBytes());
+        usage.add("Overlap indices", overlappingMatrix_->overlap().memoryUsage());
+
+        std::size_t vectorBytes = 0;
+        for (const OverlappingVector* v : {overlappingb_, overlappingx_, lastUpdate_, firstUpdate_})
+            if (v)
+                vectorBytes += MemoryUsage::blockVectorBytes(*v);
+        usage.add("Linear solver vectors", vectorBytes);
+    }
+
     /*!
      * \brief Assign values to the internal data structure for the residual vector.
      *
@@ -236,14 +337,41 @@ public:
      * \brief Sets the values of the residual's Jacobian matrix.
      *
      * This method also synchronizes the data structure across the processes which are
-     * involved in the simulation run.
+     * involved in the simulation run. The preconditioner is rebuilt by the next call to
+     * solve(), i.e., solve() reuses the last preconditioner as long as setMatrix() is
+     * not called.
      */
     void setMatrix(const SparseMatrixAdapter& M)
     {
+        asImp_().cleanupPreconditioner_();
+        matrixIsScaled_ = false;
         overlappingMatrix_->assignFromNative(M.istlMatrix());
         overlappingMatrix_->syncAdd();
     }
 
+    /*!
+     * \brief Update some rows of the residual's Jacobian matrix.
+     *
+     * This is intended for the case where only the rows of a subdomain have been
+     * re-linearized, e.g. by TpfaLinearizer::linearizeDomain(). The remaining rows keep
+     * the values of the last call to setMatrix(), and the rows are only exchanged with
+     * the peer processes if some of them are in the overlap. This method must be called
+     * on all processes.
+     */
+    template <class NativeRowIndices>
+    void setMatrix(const SparseMatrixAdapter& M, const NativeRowIndices& nativeRows)
+    {
+        asImp_().cleanupPreconditioner_();
+
+        // the remaining rows need to be unscaled if the last solve equilibrated the
+        // matrix. the scaling is then recomputed by the next solve.
+        if (matrixIsScaled_) {
+            equilibration_->unscaleMatrix(*overlappingMatrix_);
+            matrixIsScaled_ = false;
+        }
+        overlappingMatrix_->assignAddRows(M.istlMatrix(), nativeRows);
+    }
+
     /*!
      * \brief Actually solve the linear system of equations.
      *
@@ -251,30 +379,81 @@ public:
      */
     bool solve(Vector& x)
     {
-        (*overlappingx_) = 0.0;
+        ParallelScalarProduct& parScalarProduct = *parScalarProduct_;
+        ParallelOperator& parOperator = *parOperator_;
+
+        const bool warmStart =
+            asImp_().acceptsInitialGuess_()
+            && Parameters::get<TypeTag, Properties::LinearSolverWarmStart>();
+        if (warmStart)
+            hasInitialGuess_ = prepareInitialGuess_(parScalarProduct);
+        else {
+            hasInitialGuess_ = false;
+            (*overlappingx_) = 0.0;
+        }
 
-        auto parPreCond = asImp_().preparePreconditioner_();
-        auto precondCleanupFn = [this]() -> void
-                                { this->asImp_().cleanupPreconditioner_(); };
-        auto precondCleanupGuard = Opm::make_guard(precondCleanupFn);
-        // create the parallel scalar product and the parallel operator
-        ParallelScalarProduct parScalarProduct(overlappingMatrix_->overlap());
-        ParallelOperator parOperator(*overlappingMatrix_);
+        // scale the linear system. The matrix stays scaled until its values are
+        // changed, so the scaling factors are also kept for solves which reuse it.
+        const unsigned equilibrationIters =
+            static_cast<unsigned>(std::max(0, Parameters::get<TypeTag, Properties::LinearSolverEquilibration>()));
+        if (equilibrationIters > 0) {
+            if (!matrixIsScaled_) {
+                asImp_().cleanupPreconditioner_();
+                if (!equilibration_)
+                    equilibration_ = std::make_unique<Equilibration>(*overlappingb_);
+                equilibration_->scaleMatrix(*overlappingMatrix_, equilibrationIters);
+                matrixIsScaled_ = true;
+            }
+            equilibration_->scaleRhs(*overlappingb_);
+            if (hasInitialGuess_)
+                equilibration_->scaleSolution(*overlappingx_);
+        }
+
+        // the solver may modify the right hand side, so it needs to be copied if the
+        // system is written to disk
+        const std::string dumpFileName = dumpFileName_();
+        std::optional<OverlappingVector> dumpRhs;
+        if (!dumpFileName.empty())
+            dumpRhs.emplace(*overlappingb_);
+
+        // the preconditioner is kept until the matrix changes
+        decltype(asImp_().preparePreconditioner_()) parPreCond;
+        {
+            TimerGuard setupTimerGuard(report_.preconditionerSetupTimer());
+            report_.preconditionerSetupTimer().start();
+            parPreCond = asImp_().preparePreconditioner_();
+        }
 
-        // retrieve the linear solver
+        // retrieve the linear solver. since the operator, the scalar product and the
+        // preconditioner are kept, the backends may keep the solver as well until
+        // cleanupSolver_() is called.
         auto solver = asImp_().prepareSolver_(parOperator,
                                               parScalarProduct,
                                               *parPreCond);
 
-        auto cleanupSolverFn =
-            [this]() -> void
-            { this->asImp_().cleanupSolver_(); };
-        GenericGuard<decltype(cleanupSolverFn)> solverGuard(cleanupSolverFn);
-
         // run the linear solver and have some fun
+        Timer solveTimer;
+        solveTimer.start();
         auto result = asImp_().runSolver_(solver);
+        solveTimer.stop();
         // store number of iterations used
         lastIterations_ = result.second;
+        asImp_().updateReport_(solver, result, solveTimer);
+
+        // if the system is scaled, the scaled one is written
+        if (dumpRhs) {
+            const bool dumpSolution = Parameters::get<TypeTag, Properties::LinearSystemDumpSolution>();
+            writeLinearSystem(dumpFileName, *overlappingMatrix_, *dumpRhs,
+                              dumpSolution ? overlappingx_ : nullptr);
+        }
+
+        if (equilibrationIters > 0) {
+            equilibration_->unscaleSolution(*overlappingx_);
+            equilibration_->unscaleRhs(*overlappingb_);
+        }
+
+        if (warmStart && result.first)
+            recordUpdate_();
 
         // copy the result back to the non-overlapping vector
         overlappingx_->assignTo(x);
@@ -289,6 +468,16 @@ public:
     size_t iterations () const
     { return lastIterations_; }
 
+    /*!
+     * \brief Returns the report of the linear solver accumulated over all solves.
+     *
+     * The breakdown of the time into the application of the preconditioner, the
+     * matrix-vector products and the scalar products is only available for the
+     * solvers which record it, i.e., for the BiCGStab solver of opm-models.
+     */
+    const SolverReport& report() const
+    { return report_; }
+
 protected:
     Implementation& asImp_()
     { return *static_cast<Implementation *>(this); }
@@ -296,8 +485,28 @@ protected:
     const Implementation& asImp_() const
     { return *static_cast<const Implementation *>(this); }
 
+    /*!
+     * \brief Returns whether the linear solver can start from the current value of
+     *        the overlapping solution vector.
+     *
+     * Backends whose solvers support initial guesses need to overwrite this method and
+     * tell their solver whether hasInitialGuess_ is set.
+     */
+    bool acceptsInitialGuess_() const
+    { return false; }
+
     void cleanup_()
     {
+        // backends which keep their solvers need to release them before, see
+        // cleanupSolver_()
+        cleanupPreconditioner_();
+        parPreCond_.reset();
+        parOperator_.reset();
+        parScalarProduct_.reset();
+        coarseSpace_.reset();
+        equilibration_.reset();
+        matrixIsScaled_ = false;
+
         // create the overlapping Jacobian matrix and vectors
         delete overlappingMatrix_;
         delete overlappingb_;
@@ -306,35 +515,151 @@ protected:
         overlappingMatrix_ = 0;
         overlappingb_ = 0;
         overlappingx_ = 0;
+
+        // the previous updates are only valid for the current overlap
+        delete lastUpdate_;
+        delete firstUpdate_;
+        lastUpdate_ = 0;
+        firstUpdate_ = 0;
+        lastTimeStepIdx_ = -1;
+    }
+
+    // set the overlapping solution vector to the initial guess. Within a Newton
+    // sequence, the previous update is scaled by the reduction of the right hand side
+    // since the last solve. For the first Newton iteration of a time step, the first
+    // update of the previous time step is scaled by the ratio of the time step sizes.
+    bool prepareInitialGuess_(const ParallelScalarProduct& parScalarProduct)
+    {
+        const int newtonIterIdx = simulator_.model().newtonMethod().numIterations();
+        curRhsNorm_ = parScalarProduct.norm(*overlappingb_);
+
+        (*overlappingx_) = 0.0;
+        if (newtonIterIdx > 0) {
+            if (!lastUpdate_ || lastTimeStepIdx_ != simulator_.timeStepIndex() || lastRhsNorm_ <= 0.0)
+                return false;
+
+            (*overlappingx_).axpy(curRhsNorm_/lastRhsNorm_, *lastUpdate_);
+            return true;
+        }
+
+        if (!firstUpdate_ || firstUpdateDt_ <= 0.0)
+            return false;
+
+        (*overlappingx_).axpy(simulator_.timeStepSize()/firstUpdateDt_, *firstUpdate_);
+        return true;
+    }
+
+    // remember the solution of a successful linear solve for the next initial guess
+    void recordUpdate_()
+    {
+        if (!lastUpdate_)
+            lastUpdate_ = new OverlappingVector(*overlappingx_);
+        else
+            *lastUpdate_ = *overlappingx_;
+        lastRhsNorm_ = curRhsNorm_;
+        lastTimeStepIdx_ = simulator_.timeStepIndex();
+
+        if (simulator_.model().newtonMethod().numIterations() == 0) {
+            if (!firstUpdate_)
+                firstUpdate_ = new OverlappingVector(*overlappingx_);
+            else
+                *firstUpdate_ = *overlappingx_;
+            firstUpdateDt_ = simulator_.timeStepSize();
+        }
     }
 
     std::shared_ptr<ParallelPreconditioner> preparePreconditioner_()
     {
-        int preconditionerIsReady = 1;
-        try {
-            // update sequential preconditioner
-            precWrapper_.prepare(*overlappingMatrix_);
+        if (!preconditionerIsPrepared_) {
+            int preconditionerIsReady = 1;
+            try {
+                // update sequential preconditioner
+                precWrapper_.prepare(*overlappingMatrix_);
+            }
+            catch (const Dune::Exception& e) {
+                std::cout << "Preconditioner threw exception \"" << e.what()
+                          << " on rank " << overlappingMatrix_->overlap().myRank()
+                          << "\n"  << std::flush;
+                preconditionerIsReady = 0;
+            }
+
+            // make sure that the preconditioner is also ready on all peer
+            // ranks.
+            preconditionerIsReady = simulator_.gridView().comm().min(preconditionerIsReady);
+            if (!preconditionerIsReady)
+                throw NumericalProblem("Creating the preconditioner failed");
+
+            // the coarse matrix is assembled on all processes, so it is done after
+            // the sequential preconditioners are known to be fine
+            if (Parameters::get<TypeTag, Properties::LinearSolverCoarseSpace>()) {
+                if (!coarseSpace_)
+                    coarseSpace_ = std::make_unique<CoarseSpace>(*overlappingMatrix_);
+                coarseSpace_->update();
+            }
+            preconditionerIsPrepared_ = true;
+
+            // the parallel preconditioner refers to the sequential one, so it is
+            // re-created together with the solvers which use it
+            asImp_().cleanupSolver_();
+            parPreCond_.reset();
         }
-        catch (const Dune::Exception& e) {
-            std::cout << "Preconditioner threw exception \"" << e.what()
-                      << " on rank " << overlappingMatrix_->overlap().myRank()
-                      << "\n"  << std::flush;
-            preconditionerIsReady = 0;
+
+        if (!parPreCond_) {
+            parPreCond_ =
+                std::make_shared<ParallelPreconditioner>(precWrapper_.get(), overlappingMatrix_->overlap());
+            if (coarseSpace_) {
+                CoarseSpace* coarseSpace = coarseSpace_.get();
+                parPreCond_->setCoarseCorrection(
+                    [coarseSpace](OverlappingVector& x, const OverlappingVector& d)
+                    { coarseSpace->correct(x, d); });
+            }
         }
 
-        // make sure that the preconditioner is also ready on all peer
-        // ranks.
-        preconditionerIsReady = simulator_.gridView().comm().min(preconditionerIsReady);
-        if (!preconditionerIsReady)
-            throw NumericalProblem("Creating the preconditioner failed");
+        return parPreCond_;
+    }
 
-        // create the parallel preconditioner
-        return std::make_shared<ParallelPreconditioner>(precWrapper_.get(), overlappingMatrix_->overlap());
+    // add the result of a linear solve to the accumulated report. the solver
+    // backends which provide a more detailed report overwrite this method.
+    template <class LinearSolverPtr>
+    void updateReport_(const LinearSolverPtr&,
+                       const std::pair<bool, int>& result,
+                       const Timer& solveTimer)
+    {
+        SolverReport solveReport;
+        solveReport.incrementSolves();
+        solveReport.increment(static_cast<unsigned>(result.second));
+        solveReport.setConverged(result.first);
+        solveReport.timer() += solveTimer;
+        report_ += solveReport;
     }
 
     void cleanupPreconditioner_()
     {
-        precWrapper_.cleanup();
+        if (preconditionerIsPrepared_)
+            precWrapper_.cleanup();
+        preconditionerIsPrepared_ = false;
+    }
+
+    // returns the name of the file to which the current linear system is written or an
+    // empty string if it is not written
+    std::string dumpFileName_() const
+    {
+        const std::string dumpDir = Parameters::get<TypeTag, Properties::LinearSystemDumpDir>();
+        if (dumpDir.empty())
+            return "";
+
+        const int newtonIterIdx = simulator_.model().newtonMethod().numIterations();
+        const int dumpIterIdx = Parameters::get<TypeTag, Properties::LinearSystemDumpNewtonIteration>();
+        if (dumpIterIdx >= 0 && dumpIterIdx != newtonIterIdx)
+            return "";
+
+        std::ostringstream oss;
+        oss << dumpDir << "/linsys"
+            << "-t" << simulator_.timeStepIndex()
+            << "-n" << newtonIterIdx
+            << "-r" << simulator_.gridView().comm().rank()
+            << ".bin";
+        return oss.str();
     }
 
     void writeOverlapToVTK_()
@@ -377,12 +702,33 @@ protected:
     const Simulator& simulator_;
     int gridSequenceNumber_;
     size_t lastIterations_;
+    Scalar linearSolverTolerance_;
 
     OverlappingMatrix *overlappingMatrix_;
     OverlappingVector *overlappingb_;
     OverlappingVector *overlappingx_;
 
+    // the objects which are kept between the solves for the same overlapping matrix
+    std::unique_ptr<ParallelScalarProduct> parScalarProduct_;
+    std::unique_ptr<ParallelOperator> parOperator_;
+    std::shared_ptr<ParallelPreconditioner> parPreCond_;
+
     PreconditionerWrapper precWrapper_;
+    std::unique_ptr<CoarseSpace> coarseSpace_;
+    std::unique_ptr<Equilibration> equilibration_;
+    bool matrixIsScaled_;
+    bool preconditionerIsPrepared_;
+
+    // the previous solutions used for the initial guesses of the linear solver
+    OverlappingVector *lastUpdate_;
+    OverlappingVector *firstUpdate_;
+    Scalar curRhsNorm_;
+    Scalar lastRhsNorm_;
+    Scalar firstUpdateDt_;
+    int lastTimeStepIdx_;
+    bool hasInitialGuess_;
+
+    SolverReport report_;
 };
 }} // namespace Linear, Opm
 
@@ -404,12 +750,24 @@ struct PreconditionerRelaxation<TypeTag, TTag::ParallelBaseLinearSolver>
 template<class TypeTag>
 struct PreconditionerOrder<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 0; };
 
+//! by default, the first primary variable is assumed to be the pressure
+template<class TypeTag>
+struct CprPressureIndex<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 0; };
+
+template<class TypeTag>
+struct CprCoarsenTarget<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 1000; };
+
 //! by default use the same kind of floating point values for the linearization and for
 //! the linear solve
 template<class TypeTag>
 struct LinearSolverScalar<TypeTag, TTag::ParallelBaseLinearSolver>
 { using type = GetPropType<TypeTag, Properties::Scalar>; };
 
+//! by default the Jacobian matrix is stored in the precision of the linearization
+template<class TypeTag>
+struct JacobianScalar<TypeTag, TTag::ParallelBaseLinearSolver>
+{ using type = GetPropType<TypeTag, Properties::Scalar>; };
+
 template<class TypeTag>
 struct OverlappingMatrix<TypeTag, TTag::ParallelBaseLinearSolver>
 {
@@ -462,6 +820,32 @@ struct PreconditionerWrapper<TypeTag, TTag::ParallelBaseLinearSolver>
 template<class TypeTag>
 struct LinearSolverOverlapSize<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr unsigned value = 2; };
 
+//! do not scale the linear system by default
+template<class TypeTag>
+struct LinearSolverEquilibration<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 0; };
+
+//! do not use a coarse correction for the overlapping preconditioner by default
+template<class TypeTag>
+struct LinearSolverCoarseSpace<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr bool value = false; };
+
+//! exchange the overlapping rows using point-to-point messages by default
+template<class TypeTag>
+struct LinearSolverNeighborhoodCollectives<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr bool value = false; };
+
+//! do not write the linear systems of equations by default
+template<class TypeTag>
+struct LinearSystemDumpDir<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr auto value = ""; };
+
+template<class TypeTag>
+struct LinearSystemDumpNewtonIteration<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = -1; };
+
+template<class TypeTag>
+struct LinearSystemDumpSolution<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr bool value = false; };
+
+//! start the linear solver from the zero vector by default
+template<class TypeTag>
+struct LinearSolverWarmStart<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr bool value = false; };
+
 //! set the default number of maximum iterations for the linear solver
 template<class TypeTag>
 struct LinearSolverMaxIterations<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 1000; };
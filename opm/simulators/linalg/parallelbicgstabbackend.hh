@@ -58,6 +58,10 @@ struct LinearSolverMaxError<TypeTag, TTag::ParallelBiCGStabLinearSolver>
     static constexpr type value = 1e7;
 };
 
+template<class TypeTag>
+struct LinearSolverFuseReductions<TypeTag, TTag::ParallelBiCGStabLinearSolver>
+{ static constexpr bool value = false; };
+
 } // namespace Opm::Properties
 
 namespace Opm {
@@ -88,6 +92,11 @@ namespace Linear {
  *            that it is computationally cheaper because it does not
  *            need to consider things which are only required for
  *            higher orders
+ * - \c MixedPrecisionILU: An ILU preconditioner which is set up and
+ *            applied on a single precision copy of the matrix while
+ *            the Krylov method works in the precision of the system
+ * - \c ParallelILU0: An ILU(0) preconditioner which is computed and
+ *            applied using all threads of the process
  */
 template <class TypeTag>
 class ParallelBiCGStabSolverBackend : public ParallelBaseBackend<TypeTag>
@@ -124,6 +133,9 @@ public:
         Parameters::registerParam<TypeTag, Properties::LinearSolverMaxError>
             ("The maximum residual error which the linear solver tolerates"
              " without giving up");
+        Parameters::registerParam<TypeTag, Properties::LinearSolverFuseReductions>
+            ("Compute the scalar products of each iteration of the linear solver using "
+             "fewer, fused global reductions");
     }
 
 protected:
@@ -136,28 +148,39 @@ protected:
         const auto& gridView = this->simulator_.gridView();
         using CCC = CombinedCriterion<OverlappingVector, decltype(gridView.comm())>;
 
-        Scalar linearSolverTolerance = Parameters::get<TypeTag, Properties::LinearSolverTolerance>();
+        Scalar linearSolverTolerance = this->linearSolverTolerance();
         Scalar linearSolverAbsTolerance = Parameters::get<TypeTag, Properties::LinearSolverAbsTolerance>();
         if(linearSolverAbsTolerance < 0.0)
             linearSolverAbsTolerance = this->simulator_.model().newtonMethod().tolerance() / 100.0;
 
-        convCrit_.reset(new CCC(gridView.comm(),
-                                /*residualReductionTolerance=*/linearSolverTolerance,
-                                /*absoluteResidualTolerance=*/linearSolverAbsTolerance,
-                                Parameters::get<TypeTag, Properties::LinearSolverMaxError>()));
-
-        auto bicgstabSolver =
-            std::make_shared<RawLinearSolver>(parPreCond, *convCrit_, parScalarProduct);
-
-        int verbosity = 0;
-        if (parOperator.overlap().myRank() == 0)
-            verbosity = Parameters::get<TypeTag, Properties::LinearSolverVerbosity>();
-        bicgstabSolver->setVerbosity(verbosity);
-        bicgstabSolver->setMaxIterations(Parameters::get<TypeTag, Properties::LinearSolverMaxIterations>());
-        bicgstabSolver->setLinearOperator(&parOperator);
-        bicgstabSolver->setRhs(this->overlappingb_);
-
-        return bicgstabSolver;
+        // the solver is kept until the preconditioner or the overlap change, only the
+        // tolerances and the initial guess may differ between solves
+        if (!solver_) {
+            convCrit_.reset(new CCC(gridView.comm(),
+                                    /*residualReductionTolerance=*/linearSolverTolerance,
+                                    /*absoluteResidualTolerance=*/linearSolverAbsTolerance,
+                                    Parameters::get<TypeTag, Properties::LinearSolverMaxError>()));
+
+            solver_ = std::make_shared<RawLinearSolver>(parPreCond, *convCrit_, parScalarProduct);
+
+            int verbosity = 0;
+            if (parOperator.overlap().myRank() == 0)
+                verbosity = Parameters::get<TypeTag, Properties::LinearSolverVerbosity>();
+            solver_->setVerbosity(verbosity);
+            solver_->setMaxIterations(Parameters::get<TypeTag, Properties::LinearSolverMaxIterations>());
+            solver_->setFuseReductions(Parameters::get<TypeTag, Properties::LinearSolverFuseReductions>());
+        }
+        else {
+            auto& convCrit = static_cast<CCC&>(*convCrit_);
+            convCrit.setResidualReductionTolerance(linearSolverTolerance);
+            convCrit.setAbsResidualTolerance(linearSolverAbsTolerance);
+        }
+
+        solver_->setUseInitialGuess(this->hasInitialGuess_);
+        solver_->setLinearOperator(&parOperator);
+        solver_->setRhs(this->overlappingb_);
+
+        return solver_;
     }
 
     std::pair<bool,int> runSolver_(std::shared_ptr<RawLinearSolver> solver)
@@ -166,10 +189,28 @@ protected:
         return std::make_pair(converged, int(solver->report().iterations()));
     }
 
+    void updateReport_(const std::shared_ptr<RawLinearSolver>& solver,
+                       const std::pair<bool, int>&,
+                       const Timer&)
+    { this->report_ += solver->report(); }
+
+    bool acceptsInitialGuess_() const
+    { return true; }
+
     void cleanupSolver_()
-    { /* nothing to do */ }
+    {
+        solver_.reset();
+        convCrit_.reset();
+    }
+
+    void cleanup_()
+    {
+        cleanupSolver_();
+        ParentType::cleanup_();
+    }
 
     std::unique_ptr<ConvergenceCriterion<OverlappingVector> > convCrit_;
+    std::shared_ptr<RawLinearSolver> solver_;
 };
 
 }} // namespace Linear, Opm
@@ -0,0 +1,214 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::ParallelFGMResSolverBackend
+ */
+#ifndef EWOMS_PARALLEL_FGMRES_BACKEND_HH
+#define EWOMS_PARALLEL_FGMRES_BACKEND_HH
+
+#include "linalgproperties.hh"
+#include "parallelbasebackend.hh"
+#include "fgmressolver.hh"
+#include "combinedcriterion.hh"
+#include "istlsparsematrixadapter.hh"
+
+#include <algorithm>
+#include <memory>
+
+namespace Opm::Linear {
+template <class TypeTag>
+class ParallelFGMResSolverBackend;
+} // namespace Opm::Linear
+
+namespace Opm::Properties {
+
+// Create new type tags
+namespace TTag {
+struct ParallelFGMResLinearSolver { using InheritsFrom = std::tuple<ParallelBaseLinearSolver>; };
+} // end namespace TTag
+
+template<class TypeTag>
+struct LinearSolverBackend<TypeTag, TTag::ParallelFGMResLinearSolver>
+{ using type = Opm::Linear::ParallelFGMResSolverBackend<TypeTag>; };
+
+template<class TypeTag>
+struct LinearSolverMaxError<TypeTag, TTag::ParallelFGMResLinearSolver>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1e7;
+};
+
+template<class TypeTag>
+struct GMResRestart<TypeTag, TTag::ParallelFGMResLinearSolver>
+{ static constexpr int value = 30; };
+
+template<class TypeTag>
+struct LinearSolverRecycleSize<TypeTag, TTag::ParallelFGMResLinearSolver>
+{ static constexpr int value = 5; };
+
+} // namespace Opm::Properties
+
+namespace Opm {
+namespace Linear {
+/*!
+ * \ingroup Linear
+ *
+ * \brief Implements a linear solver backend which uses a flexible GMRES solver that
+ *        recycles a Krylov subspace between consecutive linear systems.
+ *
+ * The recycled subspace is kept by the backend and thus survives the solves of a
+ * Newton sequence and of subsequent time steps. It is discarded if the structure of
+ * the linear system changes, i.e., if the grid or the sparsity pattern are modified.
+ * The preconditioner is chosen in the same way as for ParallelBiCGStabSolverBackend.
+ */
+template <class TypeTag>
+class ParallelFGMResSolverBackend : public ParallelBaseBackend<TypeTag>
+{
+    using ParentType = ParallelBaseBackend<TypeTag>;
+
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+
+    using ParallelOperator = typename ParentType::ParallelOperator;
+    using OverlappingVector = typename ParentType::OverlappingVector;
+    using ParallelPreconditioner = typename ParentType::ParallelPreconditioner;
+    using ParallelScalarProduct = typename ParentType::ParallelScalarProduct;
+
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+
+    using RawLinearSolver = FGMResSolver<ParallelOperator,
+                                         OverlappingVector,
+                                         ParallelPreconditioner>;
+
+    static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock> >::value,
+                  "The ParallelFGMResSolverBackend linear solver backend requires the IstlSparseMatrixAdapter");
+
+public:
+    ParallelFGMResSolverBackend(const Simulator& simulator)
+        : ParentType(simulator)
+    { }
+
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+
+        Parameters::registerParam<TypeTag, Properties::LinearSolverMaxError>
+            ("The maximum residual error which the linear solver tolerates"
+             " without giving up");
+        Parameters::registerParam<TypeTag, Properties::GMResRestart>
+            ("Number of iterations after which the GMRES linear solver is restarted");
+        Parameters::registerParam<TypeTag, Properties::LinearSolverRecycleSize>
+            ("The maximum number of vectors which the GMRES linear solver recycles "
+             "between linear solves (0 disables recycling)");
+    }
+
+protected:
+    friend ParentType;
+
+    std::shared_ptr<RawLinearSolver> prepareSolver_(ParallelOperator& parOperator,
+                                                    ParallelScalarProduct& parScalarProduct,
+                                                    ParallelPreconditioner& parPreCond)
+    {
+        const auto& gridView = this->simulator_.gridView();
+        using CCC = CombinedCriterion<OverlappingVector, decltype(gridView.comm())>;
+
+        Scalar linearSolverTolerance = this->linearSolverTolerance();
+        Scalar linearSolverAbsTolerance = Parameters::get<TypeTag, Properties::LinearSolverAbsTolerance>();
+        if(linearSolverAbsTolerance < 0.0)
+            linearSolverAbsTolerance = this->simulator_.model().newtonMethod().tolerance() / 100.0;
+
+        // the solver is kept until the preconditioner or the overlap change, only the
+        // tolerances and the initial guess may differ between solves
+        if (!solver_) {
+            convCrit_.reset(new CCC(gridView.comm(),
+                                    /*residualReductionTolerance=*/linearSolverTolerance,
+                                    /*absoluteResidualTolerance=*/linearSolverAbsTolerance,
+                                    Parameters::get<TypeTag, Properties::LinearSolverMaxError>()));
+
+            solver_ = std::make_shared<RawLinearSolver>(parPreCond, *convCrit_, parScalarProduct, recycleSpace_);
+
+            int verbosity = 0;
+            if (parOperator.overlap().myRank() == 0)
+                verbosity = Parameters::get<TypeTag, Properties::LinearSolverVerbosity>();
+            solver_->setVerbosity(verbosity);
+            solver_->setMaxIterations(Parameters::get<TypeTag, Properties::LinearSolverMaxIterations>());
+            solver_->setRestart(static_cast<unsigned>(Parameters::get<TypeTag, Properties::GMResRestart>()));
+            const int recycleSize = Parameters::get<TypeTag, Properties::LinearSolverRecycleSize>();
+            solver_->setMaxRecycledVectors(static_cast<unsigned>(std::max(0, recycleSize)));
+        }
+        else {
+            auto& convCrit = static_cast<CCC&>(*convCrit_);
+            convCrit.setResidualReductionTolerance(linearSolverTolerance);
+            convCrit.setAbsResidualTolerance(linearSolverAbsTolerance);
+        }
+
+        // end the restart cycles early once the two-norm of the residual is reduced
+        // by the tolerance, then the convergence criterion decides based on the true
+        // residual
+        solver_->setInnerTolerance(linearSolverTolerance);
+        solver_->setUseInitialGuess(this->hasInitialGuess_);
+        solver_->setLinearOperator(&parOperator);
+        solver_->setRhs(this->overlappingb_);
+
+        return solver_;
+    }
+
+    std::pair<bool,int> runSolver_(std::shared_ptr<RawLinearSolver> solver)
+    {
+        bool converged = solver->apply(*this->overlappingx_);
+        return std::make_pair(converged, int(solver->report().iterations()));
+    }
+
+    void updateReport_(const std::shared_ptr<RawLinearSolver>& solver,
+                       const std::pair<bool, int>&,
+                       const Timer&)
+    { this->report_ += solver->report(); }
+
+    bool acceptsInitialGuess_() const
+    { return true; }
+
+    void cleanupSolver_()
+    {
+        solver_.reset();
+        convCrit_.reset();
+    }
+
+    void cleanup_()
+    {
+        cleanupSolver_();
+        ParentType::cleanup_();
+
+        // the vectors of the recycled subspace are only valid for the current overlap
+        recycleSpace_.clear();
+    }
+
+    std::unique_ptr<ConvergenceCriterion<OverlappingVector> > convCrit_;
+    std::shared_ptr<RawLinearSolver> solver_;
+    FGMResRecycleSpace<OverlappingVector> recycleSpace_;
+};
+
+}} // namespace Linear, Opm
+
+#endif
@@ -0,0 +1,284 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::ParallelILU0
+ */
+#ifndef EWOMS_PARALLEL_ILU0_HH
+#define EWOMS_PARALLEL_ILU0_HH
+
+#include <opm/common/Exceptions.hpp>
+
+#include <opm/simulators/linalg/matrixblock.hh>
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/preconditioner.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief A block ILU(0) preconditioner which uses multiple threads for the
+ *        factorization and the triangular solves.
+ *
+ * The rows of the matrix are grouped into levels such that each row only depends
+ * on rows of lower levels: for the factorization and the forward substitution a row
+ * depends on the rows of its strictly lower triangular part, for the backward
+ * substitution on those of its strictly upper triangular part. All rows of a level
+ * are then processed concurrently using OpenMP, i.e., the number of threads is the
+ * one specified by the ThreadsPerProcess parameter. The result is the same as the
+ * one of the sequential ILU(0) decomposition.
+ */
+template <class Matrix, class DomainVector, class RangeVector>
+class ParallelILU0 : public Dune::Preconditioner<DomainVector, RangeVector>
+{
+    using Block = typename Matrix::block_type;
+    using Factor = Dune::BCRSMatrix<Block>;
+
+public:
+    using matrix_type = Matrix;
+    using domain_type = DomainVector;
+    using range_type = RangeVector;
+    using field_type = typename DomainVector::field_type;
+
+    ParallelILU0(const Matrix& matrix, field_type relaxationFactor)
+        : ilu_(matrix)
+        , relaxationFactor_(relaxationFactor)
+    {
+        createLevels_();
+        factorize_();
+    }
+
+    void pre(DomainVector&, RangeVector&) override
+    {}
+
+    void apply(DomainVector& v, const RangeVector& d) override
+    {
+        // forward substitution with the unit lower triangular factor
+        const std::size_t numLowerLevels = lowerLevelOffsets_.size() - 1;
+        for (std::size_t levelIdx = 0; levelIdx < numLowerLevels; ++levelIdx) {
+            const std::size_t rowBegin = lowerLevelOffsets_[levelIdx];
+            const std::size_t rowEnd = lowerLevelOffsets_[levelIdx + 1];
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (std::size_t k = rowBegin; k < rowEnd; ++k) {
+                const std::size_t rowIdx = lowerLevelRows_[k];
+                auto tmp = d[rowIdx];
+                const auto& row = ilu_[rowIdx];
+                for (auto colIt = row.begin(); colIt.index() < rowIdx; ++colIt)
+                    colIt->mmv(v[colIt.index()], tmp);
+                v[rowIdx] = tmp;
+            }
+        }
+
+        // backward substitution with the upper triangular factor
+        const std::size_t numUpperLevels = upperLevelOffsets_.size() - 1;
+        for (std::size_t levelIdx = 0; levelIdx < numUpperLevels; ++levelIdx) {
+            const std::size_t rowBegin = upperLevelOffsets_[levelIdx];
+            const std::size_t rowEnd = upperLevelOffsets_[levelIdx + 1];
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (std::size_t k = rowBegin; k < rowEnd; ++k) {
+                const std::size_t rowIdx = upperLevelRows_[k];
+                auto tmp = v[rowIdx];
+                const auto& row = ilu_[rowIdx];
+                auto colIt = row.find(rowIdx);
+                for (++colIt; colIt != row.end(); ++colIt)
+                    colIt->mmv(v[colIt.index()], tmp);
+                diagInv_[diagPos_[rowIdx]].mv(tmp, v[rowIdx]);
+            }
+        }
+
+        v *= relaxationFactor_;
+    }
+
+    void post(DomainVector&) override
+    {}
+
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+private:
+    // group the rows into the levels of the lower and the upper triangular part
+    void createLevels_()
+    {
+        const std::size_t numRows = ilu_.N();
+        std::vector<std::size_t> level(numRows);
+
+        std::size_t numLevels = 0;
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            std::size_t rowLevel = 0;
+            const auto& row = ilu_[rowIdx];
+            for (auto colIt = row.begin(); colIt != row.end() && colIt.index() < rowIdx; ++colIt)
+                rowLevel = std::max(rowLevel, level[colIt.index()] + 1);
+            level[rowIdx] = rowLevel;
+            numLevels = std::max(numLevels, rowLevel + 1);
+        }
+        sortByLevel_(level, numLevels, lowerLevelOffsets_, lowerLevelRows_);
+
+        // the inverse diagonal blocks are stored in the order of the lower levels so
+        // that the blocks of each level can be inverted as a contiguous batch
+        diagPos_.resize(numRows);
+        for (std::size_t k = 0; k < numRows; ++k)
+            diagPos_[lowerLevelRows_[k]] = k;
+
+        numLevels = 0;
+        for (std::size_t rowIdx = numRows; rowIdx-- > 0; ) {
+            std::size_t rowLevel = 0;
+            const auto& row = ilu_[rowIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                if (colIt.index() > rowIdx)
+                    rowLevel = std::max(rowLevel, level[colIt.index()] + 1);
+            level[rowIdx] = rowLevel;
+            numLevels = std::max(numLevels, rowLevel + 1);
+        }
+        sortByLevel_(level, numLevels, upperLevelOffsets_, upperLevelRows_);
+    }
+
+    static void sortByLevel_(const std::vector<std::size_t>& level,
+                             std::size_t numLevels,
+                             std::vector<std::size_t>& levelOffsets,
+                             std::vector<std::size_t>& levelRows)
+    {
+        levelOffsets.assign(numLevels + 1, 0);
+        for (const std::size_t rowLevel : level)
+            ++levelOffsets[rowLevel + 1];
+        for (std::size_t levelIdx = 0; levelIdx < numLevels; ++levelIdx)
+            levelOffsets[levelIdx + 1] += levelOffsets[levelIdx];
+
+        std::vector<std::size_t> nextPos(levelOffsets.begin(), levelOffsets.end() - 1);
+        levelRows.resize(level.size());
+        for (std::size_t rowIdx = 0; rowIdx < level.size(); ++rowIdx)
+            levelRows[nextPos[level[rowIdx]]++] = rowIdx;
+    }
+
+    // compute the ILU(0) decomposition in place, level by level. the inverses of
+    // the diagonal blocks of the upper factor are stored separately and are computed
+    // in batches once all rows of a level have been eliminated.
+    void factorize_()
+    {
+        const std::size_t numRows = ilu_.N();
+        diagInv_.resize(numRows);
+
+        bool singular = false;
+        const std::size_t numLevels = lowerLevelOffsets_.size() - 1;
+        for (std::size_t levelIdx = 0; levelIdx < numLevels && !singular; ++levelIdx) {
+            const std::size_t rowBegin = lowerLevelOffsets_[levelIdx];
+            const std::size_t rowEnd = lowerLevelOffsets_[levelIdx + 1];
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (std::size_t k = rowBegin; k < rowEnd; ++k) {
+                if (!factorizeRow_(lowerLevelRows_[k])) {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+                    singular = true;
+                }
+            }
+
+            const std::size_t batchSize = detail::matrixBlockBatchSize;
+            const std::size_t numBatches = (rowEnd - rowBegin + batchSize - 1)/batchSize;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (std::size_t batchIdx = 0; batchIdx < numBatches; ++batchIdx) {
+                const std::size_t first = rowBegin + batchIdx*batchSize;
+                try {
+                    invertMatrixBlocks(&diagInv_[first], std::min(batchSize, rowEnd - first));
+                }
+                catch (...) {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+                    singular = true;
+                }
+            }
+        }
+
+        if (singular)
+            throw NumericalProblem("ParallelILU0: the matrix does not exhibit a non-singular "
+                                   "diagonal block in each row");
+    }
+
+    bool factorizeRow_(std::size_t rowIdx)
+    {
+        auto& row = ilu_[rowIdx];
+        auto ikIt = row.begin();
+        const auto rowEndIt = row.end();
+        for (; ikIt != rowEndIt && ikIt.index() < rowIdx; ++ikIt) {
+            const std::size_t k = ikIt.index();
+
+            // a_ik = a_ik * a_kk^-1
+            ikIt->rightmultiply(diagInv_[diagPos_[k]]);
+
+            // a_ij -= a_ik * a_kj for all j > k which are in the pattern of row i
+            const auto& rowK = ilu_[k];
+            auto kjIt = rowK.find(k);
+            ++kjIt;
+            auto ijIt = ikIt;
+            ++ijIt;
+            while (kjIt != rowK.end() && ijIt != rowEndIt) {
+                if (kjIt.index() < ijIt.index())
+                    ++kjIt;
+                else if (ijIt.index() < kjIt.index())
+                    ++ijIt;
+                else {
+                    Block tmp(*ikIt);
+                    tmp.rightmultiply(*kjIt);
+                    *ijIt -= tmp;
+                    ++kjIt;
+                    ++ijIt;
+                }
+            }
+        }
+
+        if (ikIt == rowEndIt || ikIt.index() != rowIdx)
+            return false;
+
+        diagInv_[diagPos_[rowIdx]] = *ikIt;
+        return true;
+    }
+
+    Factor ilu_;
+    std::vector<Block> diagInv_;
+    std::vector<std::size_t> diagPos_;
+    field_type relaxationFactor_;
+
+    // the rows of each level of the lower and upper triangular parts
+    std::vector<std::size_t> lowerLevelOffsets_;
+    std::vector<std::size_t> lowerLevelRows_;
+    std::vector<std::size_t> upperLevelOffsets_;
+    std::vector<std::size_t> upperLevelRows_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
@@ -120,16 +120,31 @@ protected:
                                                     ParallelScalarProduct& parScalarProduct,
                                                     ParallelPreconditioner& parPreCond)
     {
-        return solverWrapper_.get(parOperator,
-                                  parScalarProduct,
-                                  parPreCond);
+        // the ISTL solvers are configured by their constructor, so they are only kept
+        // as long as the tolerance does not change
+        const Scalar tolerance = this->linearSolverTolerance();
+        if (!solver_ || tolerance != solverTolerance_) {
+            solver_ = solverWrapper_.get(parOperator,
+                                         parScalarProduct,
+                                         parPreCond,
+                                         tolerance);
+            solverTolerance_ = tolerance;
+        }
+        return solver_;
     }
 
     void cleanupSolver_()
     {
+        solver_.reset();
         solverWrapper_.cleanup();
     }
 
+    void cleanup_()
+    {
+        cleanupSolver_();
+        ParentType::cleanup_();
+    }
+
     std::pair<bool, int> runSolver_(std::shared_ptr<RawLinearSolver> solver)
     {
         Dune::InverseOperatorResult result;
@@ -138,6 +153,8 @@ protected:
     }
 
     LinearSolverWrapper solverWrapper_;
+    std::shared_ptr<RawLinearSolver> solver_;
+    Scalar solverTolerance_ = 0.0;
 };
 
 } // namespace Opm::Linear
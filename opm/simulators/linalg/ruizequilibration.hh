@@ -0,0 +1,216 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::RuizEquilibration
+ */
+#ifndef EWOMS_RUIZ_EQUILIBRATION_HH
+#define EWOMS_RUIZ_EQUILIBRATION_HH
+
+#include <algorithm>
+#include <cmath>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief Scales the rows and columns of an overlapping matrix so that the largest
+ *        entry of each scalar row and column is close to one.
+ *
+ * The scaled system \f$(R A C) y = R b\f$ is solved instead of \f$A x = b\f$, where
+ * \f$R\f$ and \f$C\f$ are diagonal and \f$x = C y\f$. The scaling factors are computed
+ * iteratively by dividing the rows and columns by the square roots of their maximum
+ * absolute entries, see
+ *
+ * D. Ruiz: "A scaling algorithm to equilibrate both rows and columns norms in
+ * matrices", Technical Report RAL-TR-2001-034, Rutherford Appleton Laboratory, 2001
+ *
+ * Compared to scaling the primary variables manually, this does not require any
+ * knowledge about the model. The scaling factors of each row are computed by the
+ * process which is its master and then communicated to its peers, so all processes
+ * use the same factors.
+ */
+template <class OverlappingMatrix, class OverlappingVector>
+class RuizEquilibration
+{
+    using Scalar = typename OverlappingVector::field_type;
+    static constexpr int numEq = OverlappingVector::block_type::dimension;
+
+public:
+    /*!
+     * \brief Create the scaling vectors.
+     *
+     * \param prototype A vector which is consistent with the overlap of the matrix
+     */
+    explicit RuizEquilibration(const OverlappingVector& prototype)
+        : rowScale_(prototype)
+        , colScale_(prototype)
+        , rowFactor_(prototype)
+        , colFactor_(prototype)
+    {
+        rowScale_ = 1.0;
+        colScale_ = 1.0;
+    }
+
+    /*!
+     * \brief Compute the scaling factors and scale the matrix in place.
+     *
+     * The matrix must not be scaled already.
+     */
+    void scaleMatrix(OverlappingMatrix& A, unsigned numIterations)
+    {
+        rowScale_ = 1.0;
+        colScale_ = 1.0;
+
+        const unsigned numRows = static_cast<unsigned>(A.N());
+        for (unsigned iterIdx = 0; iterIdx < numIterations; ++iterIdx) {
+            rowFactor_ = 0.0;
+            colFactor_ = 0.0;
+            for (unsigned rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+                const auto& row = A[rowIdx];
+                for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                    const auto& block = *colIt;
+                    auto& colMax = colFactor_[colIt.index()];
+                    for (int i = 0; i < numEq; ++i) {
+                        for (int j = 0; j < numEq; ++j) {
+                            const Scalar a = std::abs(block[i][j]);
+                            rowFactor_[rowIdx][i] = std::max(rowFactor_[rowIdx][i], a);
+                            colMax[j] = std::max(colMax[j], a);
+                        }
+                    }
+                }
+            }
+
+            for (unsigned rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+                for (int i = 0; i < numEq; ++i) {
+                    rowFactor_[rowIdx][i] = invSqrt_(rowFactor_[rowIdx][i]);
+                    colFactor_[rowIdx][i] = invSqrt_(colFactor_[rowIdx][i]);
+                }
+            }
+
+            // the rows in the overlap may be incomplete, so use the factors of their
+            // master processes
+            rowFactor_.sync();
+            colFactor_.sync();
+
+            scale_(A, rowFactor_, colFactor_);
+            for (unsigned rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+                for (int i = 0; i < numEq; ++i) {
+                    rowScale_[rowIdx][i] *= rowFactor_[rowIdx][i];
+                    colScale_[rowIdx][i] *= colFactor_[rowIdx][i];
+                }
+            }
+        }
+    }
+
+    /*!
+     * \brief Undo the scaling of the matrix.
+     */
+    void unscaleMatrix(OverlappingMatrix& A)
+    {
+        const unsigned numRows = static_cast<unsigned>(A.N());
+        for (unsigned rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            for (int i = 0; i < numEq; ++i) {
+                rowFactor_[rowIdx][i] = 1.0/rowScale_[rowIdx][i];
+                colFactor_[rowIdx][i] = 1.0/colScale_[rowIdx][i];
+            }
+        }
+        scale_(A, rowFactor_, colFactor_);
+    }
+
+    /*!
+     * \brief Transform a right hand side to the scaled system, i.e., b <- R b.
+     */
+    void scaleRhs(OverlappingVector& b) const
+    { multiply_(b, rowScale_, /*invert=*/false); }
+
+    /*!
+     * \brief Transform a right hand side of the scaled system back.
+     */
+    void unscaleRhs(OverlappingVector& b) const
+    { multiply_(b, rowScale_, /*invert=*/true); }
+
+    /*!
+     * \brief Transform a solution to the scaled system, i.e., x <- C^-1 x.
+     */
+    void scaleSolution(OverlappingVector& x) const
+    { multiply_(x, colScale_, /*invert=*/true); }
+
+    /*!
+     * \brief Transform a solution of the scaled system back, i.e., y <- C y.
+     */
+    void unscaleSolution(OverlappingVector& x) const
+    { multiply_(x, colScale_, /*invert=*/false); }
+
+private:
+    static Scalar invSqrt_(Scalar value)
+    {
+        if (value <= 0.0 || !std::isfinite(value))
+            return 1.0;
+        return 1.0/std::sqrt(value);
+    }
+
+    static void scale_(OverlappingMatrix& A,
+                       const OverlappingVector& rowFactor,
+                       const OverlappingVector& colFactor)
+    {
+        const int numRows = static_cast<int>(A.N());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            auto& row = A[rowIdx];
+            const auto& r = rowFactor[rowIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                const auto& c = colFactor[colIt.index()];
+                auto& block = *colIt;
+                for (int i = 0; i < numEq; ++i)
+                    for (int j = 0; j < numEq; ++j)
+                        block[i][j] *= r[i]*c[j];
+            }
+        }
+    }
+
+    static void multiply_(OverlappingVector& x, const OverlappingVector& scale, bool invert)
+    {
+        const int n = static_cast<int>(x.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int rowIdx = 0; rowIdx < n; ++rowIdx)
+            for (int i = 0; i < numEq; ++i)
+                x[rowIdx][i] = invert ? x[rowIdx][i]/scale[rowIdx][i] : x[rowIdx][i]*scale[rowIdx][i];
+    }
+
+    OverlappingVector rowScale_;
+    OverlappingVector colScale_;
+
+    // temporary vectors for the factors of a single iteration
+    OverlappingVector rowFactor_;
+    OverlappingVector colFactor_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
@@ -39,18 +39,27 @@
 #include <dune/common/fmatrix.hh>
 #include <dune/common/version.hh>
 
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
 namespace Opm::Properties::TTag {
 struct SuperLULinearSolver {};
 } // namespace Opm::Properties::TTag
 
 namespace Opm {
 namespace Linear {
-template <class Scalar, class TypeTag, class Matrix, class Vector>
-class SuperLUSolve_;
+template <class Matrix, class Vector>
+class SuperLUFactorization_;
 
 /*!
  * \ingroup Linear
  * \brief A linear solver backend for the SuperLU sparse matrix library.
+ *
+ * The column permutation and the elimination tree of the matrix are computed by the
+ * first solve and are reused by all subsequent ones until eraseMatrix() is called or
+ * the structure of the matrix changes, i.e., only the numerical factorization is
+ * redone for each linear system of equations.
  */
 template <class TypeTag>
 class SuperLUBackend
@@ -58,9 +67,11 @@ class SuperLUBackend
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
     using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
-    using Matrix = typename SparseMatrixAdapter::block_type;
+    using Vector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+    using Matrix = typename SparseMatrixAdapter::IstlMatrix;
 
-    static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock>::value,
+    static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock> >::value,
                   "The SuperLU linear solver backend requires the IstlSparseMatrixAdapter");
 
 public:
@@ -77,14 +88,30 @@ public:
      * \brief Causes the solve() method to discared the structure of the linear system of
      *        equations the next time it is called.
      *
-     * Since the SuperLU backend does not create any internal matrices, this is a no-op.
+     * This drops the symbolic analysis of the matrix.
      */
     void eraseMatrix()
+    { factorization_.clear(); }
+
+    void prepare(const SparseMatrixAdapter&, const Vector&)
     { }
 
-    void prepare(const SparseMatrixAdapter& M, const Vector& b)
+    /*!
+     * \brief Set the reduction of the residual which the linear solver needs to achieve.
+     *
+     * Since SuperLU is a direct solver, this is a no-op.
+     */
+    void setLinearSolverTolerance(Scalar)
     { }
 
+    /*!
+     * \brief Return number of iterations used during last solve.
+     *
+     * Since SuperLU is a direct solver, this is always 0.
+     */
+    size_t iterations() const
+    { return 0; }
+
     void setResidual(const Vector& b)
     { b_ = &b; }
 
@@ -92,81 +119,230 @@ public:
     { b = *b_; }
 
     void setMatrix(const SparseMatrixAdapter& M)
-    { M_ = &M; }
+    { M_ = &M.istlMatrix(); }
 
     bool solve(Vector& x)
-    { return SuperLUSolve_<Scalar, TypeTag, Matrix, Vector>::solve_(*M_, x, *b_); }
+    {
+        int verbosity = Parameters::get<TypeTag, Properties::LinearSolverVerbosity>();
+        return factorization_.solve(*M_, x, *b_, verbosity);
+    }
 
 private:
     const Matrix* M_;
-    Vector* b_;
+    const Vector* b_;
+    SuperLUFactorization_<Matrix, Vector> factorization_;
 };
 
-template <class Scalar, class TypeTag, class Matrix, class Vector>
-class SuperLUSolve_
+/*!
+ * \brief Solves linear systems of equations with SuperLU while keeping the symbolic
+ *        analysis of the matrix.
+ *
+ * The matrix is copied into a scalar compressed column matrix whose structure is
+ * built once. The first factorization computes the column permutation and the
+ * elimination tree, the subsequent ones use SuperLU's SamePattern mode, i.e., only the
+ * row permutation and the numerical factors are recomputed.
+ *
+ * Since SuperLU handles at most double precision, the linear systems of equations are
+ * always solved in double precision, regardless of the scalar type of the matrix.
+ */
+template <class Matrix, class Vector>
+class SuperLUFactorization_
 {
+    static constexpr int blockSize = Matrix::block_type::rows;
+
 public:
-    static bool solve_(const Matrix& A, Vector& x, const Vector& b)
+    SuperLUFactorization_()
+        : haveStructure_(false)
+        , haveFactors_(false)
     {
-        Vector bTmp(b);
+        set_default_options(&options_);
+        StatInit(&stat_);
+    }
 
-        int verbosity = Parameters::get<TypeTag, Properties::LinearSolverVerbosity>();
-        Dune::InverseOperatorResult result;
-        Dune::SuperLU<Matrix> solver(A, verbosity > 0);
-        solver.apply(x, bTmp, result);
-
-        if (result.converged) {
-            // make sure that the result only contains finite values.
-            Scalar tmp = 0;
-            for (unsigned i = 0; i < x.size(); ++i) {
-                const auto& xi = x[i];
-                for (unsigned j = 0; j < Vector::block_type::dimension; ++j)
-                    tmp += xi[j];
+    SuperLUFactorization_(const SuperLUFactorization_&) = delete;
+    SuperLUFactorization_& operator=(const SuperLUFactorization_&) = delete;
+
+    ~SuperLUFactorization_()
+    {
+        clear();
+        StatFree(&stat_);
+    }
+
+    /*!
+     * \brief Drop the structure of the matrix and its factorization.
+     */
+    void clear()
+    {
+        destroyFactors_();
+        if (haveStructure_)
+            Destroy_SuperMatrix_Store(&A_);
+        haveStructure_ = false;
+    }
+
+    bool solve(const Matrix& M, Vector& x, const Vector& b, int verbosity)
+    {
+        if (!haveStructure_ || M.N() != numBlockRows_ || M.nonzeroes() != numBlocks_)
+            createStructure_(M);
+        assignValues_(M);
+
+        // SuperLU may scale the right hand side, so it is copied for each solve
+        const int n = static_cast<int>(numBlockRows_*blockSize);
+        for (std::size_t i = 0; i < numBlockRows_; ++i)
+            for (int k = 0; k < blockSize; ++k)
+                bValues_[i*blockSize + k] = static_cast<double>(b[i][k]);
+
+        SuperMatrix B;
+        SuperMatrix X;
+        dCreate_Dense_Matrix(&B, n, /*nrhs=*/1, bValues_.data(), n, SLU_DN, SLU_D, SLU_GE);
+        dCreate_Dense_Matrix(&X, n, /*nrhs=*/1, xValues_.data(), n, SLU_DN, SLU_D, SLU_GE);
+
+        // the L and U factors of a previous factorization need to be released by the
+        // caller if the pattern is reused
+        options_.Fact = haveFactors_ ? SamePattern : DOFACT;
+        options_.PrintStat = (verbosity > 0) ? YES : NO;
+        destroyFactors_();
+
+        char equed[1];
+        double recipPivotGrowth;
+        double rcond;
+        double ferr;
+        double berr;
+        mem_usage_t memUsage;
+        int info = 0;
+        dgssvx(&options_, &A_, permC_.data(), permR_.data(), etree_.data(), equed,
+               R_.data(), C_.data(), &L_, &U_, /*work=*/nullptr, /*lwork=*/0, &B, &X,
+               &recipPivotGrowth, &rcond, &ferr, &berr,
+#if SUPERLU_MIN_VERSION_5
+               &glu_,
+#endif
+               &memUsage, &stat_, &info);
+
+        Destroy_SuperMatrix_Store(&B);
+        Destroy_SuperMatrix_Store(&X);
+
+        // for info values larger than n + 1, allocating the factors failed; else the
+        // L and U factors have been (at least partially) computed
+        haveFactors_ = (info <= n + 1);
+        if (options_.PrintStat == YES)
+            StatPrint(&stat_);
+
+        // info == n + 1 means that the matrix is singular to working precision, but
+        // the solution has been computed nevertheless
+        if (info != 0 && info != n + 1)
+            return false;
+
+        // make sure that the result only contains finite values.
+        double tmp = 0;
+        for (std::size_t i = 0; i < numBlockRows_; ++i) {
+            for (int k = 0; k < blockSize; ++k) {
+                x[i][k] = xValues_[i*blockSize + k];
+                tmp += xValues_[i*blockSize + k];
+            }
+        }
+        return std::isfinite(tmp);
+    }
+
+private:
+    // create the compressed column structure of the scalar matrix
+    void createStructure_(const Matrix& M)
+    {
+        clear();
+
+        numBlockRows_ = M.N();
+        numBlocks_ = M.nonzeroes();
+        const std::size_t n = numBlockRows_*blockSize;
+        const std::size_t nnz = numBlocks_*blockSize*blockSize;
+
+        colPtr_.assign(n + 1, 0);
+        for (auto rowIt = M.begin(); rowIt != M.end(); ++rowIt)
+            for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt)
+                for (int l = 0; l < blockSize; ++l)
+                    colPtr_[colIt.index()*blockSize + l + 1] += blockSize;
+        for (std::size_t j = 0; j < n; ++j)
+            colPtr_[j + 1] += colPtr_[j];
+
+        // the position of each scalar entry of the BCRS matrix in the value array of
+        // the compressed column matrix. the entries are traversed row by row, so the
+        // row indices of each column are sorted.
+        std::vector<int> nextPos(colPtr_.begin(), colPtr_.end() - 1);
+        rowIdx_.resize(nnz);
+        valuePos_.clear();
+        valuePos_.reserve(nnz);
+        for (auto rowIt = M.begin(); rowIt != M.end(); ++rowIt) {
+            for (int k = 0; k < blockSize; ++k) {
+                for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt) {
+                    for (int l = 0; l < blockSize; ++l) {
+                        const int pos = nextPos[colIt.index()*blockSize + l]++;
+                        rowIdx_[pos] = static_cast<int>(rowIt.index()*blockSize + k);
+                        valuePos_.push_back(pos);
+                    }
+                }
             }
-            result.converged = std::isfinite(tmp);
         }
 
-        return result.converged;
+        values_.resize(nnz);
+        bValues_.resize(n);
+        xValues_.resize(n);
+        permC_.resize(n);
+        permR_.resize(n);
+        etree_.resize(n);
+        R_.resize(n);
+        C_.resize(n);
+
+        dCreate_CompCol_Matrix(&A_, static_cast<int>(n), static_cast<int>(n),
+                               static_cast<int>(nnz), values_.data(), rowIdx_.data(),
+                               colPtr_.data(), SLU_NC, SLU_D, SLU_GE);
+        haveStructure_ = true;
     }
-};
 
-// the following is required to make the SuperLU adapter of dune-istl happy with
-// quadruple precision math on Dune 2.4. this is because the most which SuperLU can
-// handle is double precision (i.e., the linear systems of equations are always solved
-// with at most double precision if chosing SuperLU as the linear solver...)
-#if HAVE_QUAD
-template <class TypeTag, class Matrix, class Vector>
-class SuperLUSolve_<__float128, TypeTag, Matrix, Vector>
-{
-public:
-    static bool solve_(const Matrix& A,
-                       Vector& x,
-                       const Vector& b)
+    void assignValues_(const Matrix& M)
     {
-        static const int numEq = getPropValue<TypeTag, Properties::NumEq>();
-        using DoubleEqVector = Dune::FieldVector<double, numEq>;
-        using DoubleEqMatrix = Dune::FieldMatrix<double, numEq, numEq>;
-        using DoubleVector = Dune::BlockVector<DoubleEqVector>;
-        using DoubleMatrix = Dune::BCRSMatrix<DoubleEqMatrix>;
-
-        // copy the inputs into the double precision data structures
-        DoubleVector bDouble(b);
-        DoubleVector xDouble(x);
-        DoubleMatrix ADouble(A);
-
-        bool res =
-            SuperLUSolve_<double, TypeTag, Matrix, Vector>::solve_(ADouble,
-                                                                   xDouble,
-                                                                   bDouble);
-
-        // copy the result back into the quadruple precision vector.
-        x = xDouble;
-
-        return res;
+        std::size_t k = 0;
+        for (auto rowIt = M.begin(); rowIt != M.end(); ++rowIt)
+            for (int i = 0; i < blockSize; ++i)
+                for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt)
+                    for (int j = 0; j < blockSize; ++j)
+                        values_[valuePos_[k++]] = static_cast<double>((*colIt)[i][j]);
     }
-};
+
+    void destroyFactors_()
+    {
+        if (!haveFactors_)
+            return;
+
+        Destroy_SuperNode_Matrix(&L_);
+        Destroy_CompCol_Matrix(&U_);
+        haveFactors_ = false;
+    }
+
+    superlu_options_t options_;
+    SuperLUStat_t stat_;
+#if SUPERLU_MIN_VERSION_5
+    GlobalLU_t glu_;
 #endif
 
+    SuperMatrix A_;
+    SuperMatrix L_;
+    SuperMatrix U_;
+    bool haveStructure_;
+    bool haveFactors_;
+
+    std::size_t numBlockRows_;
+    std::size_t numBlocks_;
+    std::vector<double> values_;
+    std::vector<int> rowIdx_;
+    std::vector<int> colPtr_;
+    std::vector<std::size_t> valuePos_;
+    std::vector<double> bValues_;
+    std::vector<double> xValues_;
+
+    std::vector<int> permC_;
+    std::vector<int> permR_;
+    std::vector<int> etree_;
+    std::vector<double> R_;
+    std::vector<double> C_;
+};
+
 } // namespace Linear
 } // namespace Opm
 
@@ -0,0 +1,320 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Benchmark for the halo exchanges and the reductions of the parallel code.
+ *
+ * The benchmark partitions a structured three-dimensional cube created by the
+ * CubeGridVanguard amongst the MPI processes and builds the algebraic overlap of the
+ * linear solver from the element based border list, i.e., in the same way as the
+ * simulators do. It then times the synchronization of overlapping block vectors
+ * (sync() and syncAdd(), both point-to-point and using neighborhood collectives),
+ * the synchronization of the overlapping matrix (syncAdd()), the exchanges of the
+ * grid using the GridCommHandle* data handles and the global scalar product for
+ * several block sizes. The number of processes is determined by the MPI launcher,
+ * the size of the cube via --cells-x, --cells-y and --cells-z, the size of the
+ * algebraic overlap via --linear-solver-overlap-size and the number of timed
+ * repetitions via --benchmark-repetitions. Each process times all repetitions
+ * individually; the reported times are the maximum over all processes.
+ */
+#include "config.h"
+
+#include "problems/powerinjectionproblem.hh"
+
+#include <opm/models/immiscible/immisciblemodel.hh>
+#include <opm/models/parallel/gridcommhandles.hh>
+#include <opm/models/utils/start.hh>
+#include <opm/models/utils/timer.hh>
+#include <opm/simulators/linalg/elementborderlistfromgrid.hh>
+#include <opm/simulators/linalg/matrixblock.hh>
+#include <opm/simulators/linalg/overlappingbcrsmatrix.hh>
+#include <opm/simulators/linalg/overlappingblockvector.hh>
+#include <opm/simulators/linalg/overlappingscalarproduct.hh>
+#include <opm/simulators/linalg/parallelbicgstabbackend.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/grid/common/gridenums.hh>
+#include <dune/grid/yaspgrid.hh>
+#include <dune/istl/bcrsmatrix.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace Opm::Properties {
+
+namespace TTag {
+struct CommunicationBenchmark
+{ using InheritsFrom = std::tuple<PowerInjectionBaseProblem, ImmiscibleTwoPhaseModel>; };
+} // end namespace TTag
+
+template<class TypeTag, class MyTypeTag>
+struct BenchmarkRepetitions { using type = UndefinedProperty; };
+
+template<class TypeTag>
+struct FluxModule<TypeTag, TTag::CommunicationBenchmark> { using type = Opm::DarcyFluxModule<TypeTag>; };
+
+// the benchmark uses a three-dimensional cube
+template<class TypeTag>
+struct Grid<TypeTag, TTag::CommunicationBenchmark> { using type = Dune::YaspGrid<3>; };
+
+template<class TypeTag>
+struct CellsX<TypeTag, TTag::CommunicationBenchmark> { static constexpr unsigned value = 64; };
+template<class TypeTag>
+struct CellsY<TypeTag, TTag::CommunicationBenchmark> { static constexpr unsigned value = 64; };
+template<class TypeTag>
+struct CellsZ<TypeTag, TTag::CommunicationBenchmark> { static constexpr unsigned value = 64; };
+
+template<class TypeTag>
+struct BenchmarkRepetitions<TypeTag, TTag::CommunicationBenchmark> { static constexpr unsigned value = 20; };
+
+// do not write any output
+template<class TypeTag>
+struct EnableVtkOutput<TypeTag, TTag::CommunicationBenchmark> { static constexpr bool value = false; };
+
+} // namespace Opm::Properties
+
+namespace {
+
+using TypeTag = Opm::Properties::TTag::CommunicationBenchmark;
+
+using Simulator = Opm::GetPropType<TypeTag, Opm::Properties::Simulator>;
+using GridView = Opm::GetPropType<TypeTag, Opm::Properties::GridView>;
+using ElementMapper = Opm::GetPropType<TypeTag, Opm::Properties::ElementMapper>;
+using BorderListCreator = Opm::Linear::ElementBorderListFromGrid<GridView, ElementMapper>;
+using CollectiveCommunication = Dune::Communication<Dune::MPIHelper::MPICommunicator>;
+
+/*!
+ * \brief Time a communication kernel and print the results.
+ *
+ * The kernel is executed once before the measurement starts in order to set up its
+ * buffers. All processes are synchronized before each repetition so that the time
+ * of a repetition is not affected by the load imbalance of the previous one. The
+ * reported times are the maximum over all processes.
+ */
+template <class Kernel>
+void runKernel_(const CollectiveCommunication& comm,
+                const std::string& name,
+                unsigned blockSize,
+                unsigned numRepetitions,
+                Kernel&& kernel)
+{
+    kernel();
+
+    double minTime = std::numeric_limits<double>::max();
+    double totalTime = 0.0;
+    for (unsigned repIdx = 0; repIdx < numRepetitions; ++repIdx) {
+        comm.barrier();
+        Opm::Timer timer;
+        timer.start();
+        kernel();
+        timer.stop();
+
+        const double time = comm.max(timer.realTimeElapsed());
+        minTime = std::min(minTime, time);
+        totalTime += time;
+    }
+
+    if (comm.rank() == 0)
+        std::cout << std::left << std::setw(40) << name
+                  << std::right << std::setw(8) << blockSize
+                  << std::setw(14) << minTime
+                  << std::setw(14) << totalTime/numRepetitions << "\n" << std::flush;
+}
+
+/*!
+ * \brief Create the non-overlapping matrix of a cell centered finite volume scheme.
+ *
+ * Each process owns a row for each of its elements including the overlap and ghost
+ * elements. The row of an element has entries for the element and its neighbors.
+ */
+template <class Matrix>
+Matrix createNativeMatrix_(const GridView& gridView, const ElementMapper& elementMapper)
+{
+    const std::size_t numElements = static_cast<std::size_t>(gridView.size(/*codim=*/0));
+    std::vector<std::set<unsigned>> neighbors(numElements);
+    for (const auto& elem : elements(gridView)) {
+        const unsigned elemIdx = static_cast<unsigned>(elementMapper.index(elem));
+        neighbors[elemIdx].insert(elemIdx);
+        for (const auto& intersection : intersections(gridView, elem)) {
+            if (intersection.neighbor())
+                neighbors[elemIdx].insert(static_cast<unsigned>(elementMapper.index(intersection.outside())));
+        }
+    }
+
+    Matrix matrix(numElements, numElements, Matrix::random);
+    for (std::size_t rowIdx = 0; rowIdx < numElements; ++rowIdx)
+        matrix.setrowsize(rowIdx, neighbors[rowIdx].size());
+    matrix.endrowsizes();
+    for (std::size_t rowIdx = 0; rowIdx < numElements; ++rowIdx)
+        for (unsigned colIdx : neighbors[rowIdx])
+            matrix.addindex(rowIdx, colIdx);
+    matrix.endindices();
+    matrix = 1.0;
+
+    return matrix;
+}
+
+template <int blockSize>
+void benchmarkBlockSize_(const Simulator& simulator,
+                         const BorderListCreator& borderListCreator,
+                         unsigned overlapSize,
+                         unsigned numRepetitions)
+{
+    using NativeMatrix = Dune::BCRSMatrix<Opm::MatrixBlock<double, blockSize, blockSize>>;
+    using OverlappingMatrix = Opm::Linear::OverlappingBCRSMatrix<NativeMatrix>;
+    using Overlap = typename OverlappingMatrix::Overlap;
+    using VectorBlock = Dune::FieldVector<double, blockSize>;
+    using OverlappingVector = Opm::Linear::OverlappingBlockVector<VectorBlock, Overlap>;
+    using ScalarProduct = Opm::Linear::OverlappingScalarProduct<OverlappingVector, Overlap>;
+    using ElementVector = std::vector<VectorBlock>;
+
+    const auto& gridView = simulator.gridView();
+    const auto& elementMapper = simulator.model().elementMapper();
+    const auto comm = Dune::MPIHelper::getCommunication();
+
+    const NativeMatrix nativeMatrix = createNativeMatrix_<NativeMatrix>(gridView, elementMapper);
+    OverlappingMatrix overlappingMatrix(nativeMatrix,
+                                       borderListCreator.borderList(),
+                                       borderListCreator.blackList(),
+                                       overlapSize);
+    const Overlap& overlap = overlappingMatrix.overlap();
+
+    OverlappingVector x(overlap);
+    x = 1.0;
+    OverlappingVector xCollective(x);
+    xCollective.enableNeighborhoodCollectives();
+    const OverlappingVector y(x);
+    const ScalarProduct scalarProduct(overlap);
+
+    // the overlapping vectors and matrix
+    runKernel_(comm, "OverlappingBlockVector::sync()", blockSize, numRepetitions,
+               [&x]() { x.sync(); });
+    runKernel_(comm, "OverlappingBlockVector::syncAdd()", blockSize, numRepetitions,
+               [&x]() { x.syncAdd(); });
+    runKernel_(comm, "OverlappingBlockVector::sync() [nbcoll]", blockSize, numRepetitions,
+               [&xCollective]() { xCollective.sync(); });
+    runKernel_(comm, "OverlappingBlockVector::syncAdd() [nbcoll]", blockSize, numRepetitions,
+               [&xCollective]() { xCollective.syncAdd(); });
+    runKernel_(comm, "OverlappingBCRSMatrix::syncAdd()", blockSize, numRepetitions,
+               [&overlappingMatrix]() { overlappingMatrix.syncAdd(); });
+
+    // the exchanges of the grid, which are used for the solution and the
+    // intensive quantities
+    ElementVector elemValues(static_cast<std::size_t>(gridView.size(/*codim=*/0)), VectorBlock(1.0));
+    runKernel_(comm, "GridCommHandleGhostSync", blockSize, numRepetitions,
+               [&]()
+               {
+                   Opm::GridCommHandleGhostSync<VectorBlock, ElementVector, ElementMapper, /*commCodim=*/0>
+                       handle(elemValues, elementMapper);
+                   gridView.communicate(handle, Dune::InteriorBorder_All_Interface,
+                                        Dune::ForwardCommunication);
+               });
+    runKernel_(comm, "GridCommHandleSum", blockSize, numRepetitions,
+               [&]()
+               {
+                   Opm::GridCommHandleSum<VectorBlock, ElementVector, ElementMapper, /*commCodim=*/0>
+                       handle(elemValues, elementMapper);
+                   gridView.communicate(handle, Dune::InteriorBorder_All_Interface,
+                                        Dune::ForwardCommunication);
+               });
+    runKernel_(comm, "GridCommHandleMax", blockSize, numRepetitions,
+               [&]()
+               {
+                   Opm::GridCommHandleMax<VectorBlock, ElementVector, ElementMapper, /*commCodim=*/0>
+                       handle(elemValues, elementMapper);
+                   gridView.communicate(handle, Dune::InteriorBorder_All_Interface,
+                                        Dune::ForwardCommunication);
+               });
+
+    // the global reduction
+    runKernel_(comm, "OverlappingScalarProduct::dot()", blockSize, numRepetitions,
+               [&]() { scalarProduct.dot(x, y); });
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    using ThreadManager = Opm::GetPropType<TypeTag, Opm::Properties::ThreadManager>;
+
+    Dune::MPIHelper::instance(argc, argv);
+
+    Opm::registerAllParameters_<TypeTag>(/*finalizeRegistration=*/false);
+    Opm::Parameters::registerParam<TypeTag, Opm::Properties::BenchmarkRepetitions>
+        ("The number of timed repetitions of each kernel");
+    Opm::Parameters::endParamRegistration<TypeTag>();
+
+    const int status = Opm::setupParameters_<TypeTag>(argc,
+                                                      const_cast<const char**>(argv),
+                                                      /*registerParams=*/false);
+    if (status != 0)
+        return status < 0 ? 0 : status;
+
+    ThreadManager::init();
+
+    Simulator simulator;
+    const auto comm = Dune::MPIHelper::getCommunication();
+
+    const unsigned numRepetitions =
+        Opm::Parameters::get<TypeTag, Opm::Properties::BenchmarkRepetitions>();
+    const unsigned overlapSize =
+        Opm::Parameters::get<TypeTag, Opm::Properties::LinearSolverOverlapSize>();
+    const BorderListCreator borderListCreator(simulator.gridView(),
+                                              simulator.model().elementMapper());
+
+    double numInterior = 0.0;
+    double numElements = 0.0;
+    for (const auto& elem : elements(simulator.gridView())) {
+        numElements += 1.0;
+        if (elem.partitionType() == Dune::InteriorEntity)
+            numInterior += 1.0;
+    }
+    numInterior = comm.sum(numInterior);
+    numElements = comm.sum(numElements);
+    if (comm.rank() == 0)
+        std::cout << "Benchmarking the communication of " << comm.size() << " process(es) on "
+                  << numInterior << " cells (" << numElements
+                  << " including overlap and ghost cells) using an algebraic"
+                  << " overlap of size " << overlapSize << " and " << numRepetitions
+                  << " repetition(s)\n\n"
+                  << std::left << std::setw(40) << "kernel"
+                  << std::right << std::setw(8) << "block"
+                  << std::setw(14) << "min [s]"
+                  << std::setw(14) << "avg [s]" << "\n";
+
+    benchmarkBlockSize_<1>(simulator, borderListCreator, overlapSize, numRepetitions);
+    benchmarkBlockSize_<2>(simulator, borderListCreator, overlapSize, numRepetitions);
+    benchmarkBlockSize_<3>(simulator, borderListCreator, overlapSize, numRepetitions);
+    benchmarkBlockSize_<4>(simulator, borderListCreator, overlapSize, numRepetitions);
+    benchmarkBlockSize_<6>(simulator, borderListCreator, overlapSize, numRepetitions);
+
+    return 0;
+}
@@ -0,0 +1,213 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Benchmark for the hot spots of the linearization.
+ *
+ * The benchmark sets up the lens problem for the immiscible model on a structured
+ * three-dimensional cube and times the update of the intensive quantities, the
+ * evaluation of the fluxes over all faces and the linearization of the whole domain.
+ * The size of the cube is specified via --cells-x, --cells-y and --cells-z, the
+ * number of threads via --threads-per-process and the number of timed repetitions
+ * of each kernel via --benchmark-repetitions. For each kernel, the throughput is
+ * reported in cells per second and as an estimate of the memory bandwidth, which is
+ * based on the size of the data that each kernel needs to read and write at least.
+ */
+#include "config.h"
+
+#include "lens_immiscible_ecfv_ad.hh"
+
+#include <opm/models/utils/start.hh>
+#include <opm/models/utils/timer.hh>
+#include <opm/models/parallel/threadedentityiterator.hh>
+#include <opm/simulators/linalg/parallelbicgstabbackend.hh>
+
+#include <dune/grid/yaspgrid.hh>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+
+namespace Opm::Properties {
+
+namespace TTag {
+struct LinearizationBenchmark { using InheritsFrom = std::tuple<LensProblemEcfvAd>; };
+} // end namespace TTag
+
+template<class TypeTag, class MyTypeTag>
+struct BenchmarkRepetitions { using type = UndefinedProperty; };
+
+// the benchmark uses a three-dimensional cube
+template<class TypeTag>
+struct Grid<TypeTag, TTag::LinearizationBenchmark> { using type = Dune::YaspGrid<3>; };
+
+template<class TypeTag>
+struct CellsX<TypeTag, TTag::LinearizationBenchmark> { static constexpr unsigned value = 64; };
+template<class TypeTag>
+struct CellsY<TypeTag, TTag::LinearizationBenchmark> { static constexpr unsigned value = 64; };
+template<class TypeTag>
+struct CellsZ<TypeTag, TTag::LinearizationBenchmark> { static constexpr unsigned value = 64; };
+
+template<class TypeTag>
+struct BenchmarkRepetitions<TypeTag, TTag::LinearizationBenchmark> { static constexpr unsigned value = 10; };
+
+// do not write any output
+template<class TypeTag>
+struct EnableVtkOutput<TypeTag, TTag::LinearizationBenchmark> { static constexpr bool value = false; };
+
+} // namespace Opm::Properties
+
+namespace {
+
+using TypeTag = Opm::Properties::TTag::LinearizationBenchmark;
+
+using Simulator = Opm::GetPropType<TypeTag, Opm::Properties::Simulator>;
+using GridView = Opm::GetPropType<TypeTag, Opm::Properties::GridView>;
+using ElementContext = Opm::GetPropType<TypeTag, Opm::Properties::ElementContext>;
+using IntensiveQuantities = Opm::GetPropType<TypeTag, Opm::Properties::IntensiveQuantities>;
+using PrimaryVariables = Opm::GetPropType<TypeTag, Opm::Properties::PrimaryVariables>;
+using RateVector = Opm::GetPropType<TypeTag, Opm::Properties::RateVector>;
+
+/*!
+ * \brief Time a kernel and print its throughput.
+ *
+ * The kernel is executed once before the measurement starts in order to initialize
+ * its data structures. The fastest repetition is reported, because it is the least
+ * affected by noise.
+ */
+template <class Kernel>
+void runKernel_(const std::string& name,
+                unsigned numRepetitions,
+                double numCells,
+                double bytesPerIteration,
+                Kernel&& kernel)
+{
+    kernel();
+
+    double minTime = std::numeric_limits<double>::max();
+    double totalTime = 0.0;
+    for (unsigned repIdx = 0; repIdx < numRepetitions; ++repIdx) {
+        Opm::Timer timer;
+        timer.start();
+        kernel();
+        timer.stop();
+
+        minTime = std::min(minTime, timer.realTimeElapsed());
+        totalTime += timer.realTimeElapsed();
+    }
+
+    std::cout << std::left << std::setw(32) << name
+              << std::right << std::setw(14) << minTime
+              << std::setw(14) << totalTime/numRepetitions
+              << std::setw(16) << numCells/minTime
+              << std::setw(12) << bytesPerIteration/minTime/1e9 << "\n" << std::flush;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    using ThreadManager = Opm::GetPropType<TypeTag, Opm::Properties::ThreadManager>;
+
+    Dune::MPIHelper::instance(argc, argv);
+
+    Opm::registerAllParameters_<TypeTag>(/*finalizeRegistration=*/false);
+    Opm::Parameters::registerParam<TypeTag, Opm::Properties::BenchmarkRepetitions>
+        ("The number of timed repetitions of each kernel");
+    Opm::Parameters::endParamRegistration<TypeTag>();
+
+    const int status = Opm::setupParameters_<TypeTag>(argc,
+                                                      const_cast<const char**>(argv),
+                                                      /*registerParams=*/false);
+    if (status != 0)
+        return status < 0 ? 0 : status;
+
+    ThreadManager::init();
+
+    Simulator simulator;
+    auto& model = simulator.model();
+    model.applyInitialSolution();
+
+    const unsigned numRepetitions =
+        Opm::Parameters::get<TypeTag, Opm::Properties::BenchmarkRepetitions>();
+    const double numCells = static_cast<double>(model.numGridDof());
+    const double solutionBytes = numCells*sizeof(PrimaryVariables);
+    const double intQuantsBytes = numCells*sizeof(IntensiveQuantities);
+
+    std::cout << "Benchmarking the linearization kernels on " << numCells << " cells using "
+              << ThreadManager::maxThreads() << " thread(s) and " << numRepetitions
+              << " repetition(s)\n\n"
+              << std::left << std::setw(32) << "kernel"
+              << std::right << std::setw(14) << "min [s]"
+              << std::setw(14) << "avg [s]"
+              << std::setw(16) << "cells/s"
+              << std::setw(12) << "GB/s" << "\n";
+
+    // the intensive quantities: read the solution, write the cached quantities
+    runKernel_("update intensive quantities", numRepetitions, numCells,
+               solutionBytes + intQuantsBytes,
+               [&model]() { model.invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0); });
+
+    // the fluxes: read the cached intensive quantities of both sides of each face
+    const GridView& gridView = simulator.gridView();
+    runKernel_("compute fluxes", numRepetitions, numCells,
+               2*intQuantsBytes,
+               [&simulator, &gridView]()
+               {
+                   Opm::ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+                   {
+                       ElementContext elemCtx(simulator);
+                       const auto& localResidual = simulator.model().localResidual(ThreadManager::threadId());
+                       RateVector flux;
+                       auto elemIt = threadedElemIt.beginParallel();
+                       for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                           elemCtx.updateStencil(*elemIt);
+                           elemCtx.updateAllIntensiveQuantities();
+                           elemCtx.updateAllExtensiveQuantities();
+
+                           const unsigned numFaces = elemCtx.numInteriorFaces(/*timeIdx=*/0);
+                           for (unsigned scvfIdx = 0; scvfIdx < numFaces; ++scvfIdx)
+                               localResidual.computeFlux(flux, elemCtx, scvfIdx, /*timeIdx=*/0);
+                       }
+                   }
+               });
+
+    // the linearization: read the intensive quantities, write the Jacobian matrix and
+    // the residual
+    auto& linearizer = model.linearizer();
+    linearizer.linearizeDomain();
+    const double numNonZeros = static_cast<double>(linearizer.jacobian().istlMatrix().nonzeroes());
+    using MatrixBlock = typename std::decay_t<decltype(linearizer.jacobian().istlMatrix())>::block_type;
+    using VectorBlock = typename std::decay_t<decltype(linearizer.residual())>::block_type;
+    runKernel_("linearize domain", numRepetitions, numCells,
+               intQuantsBytes + numNonZeros*sizeof(MatrixBlock) + numCells*sizeof(VectorBlock),
+               [&linearizer]() { linearizer.linearizeDomain(); });
+
+    return 0;
+}
@@ -0,0 +1,278 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Benchmark for the linear solvers using linear systems written by a simulator.
+ *
+ * The linear systems are written by the simulators if the --linear-system-dump-dir
+ * parameter is specified. This program reads the files passed on the command line and
+ * solves each of them using all combinations of the available Krylov solvers and
+ * preconditioners. For each combination, the time required to set up the
+ * preconditioner, the time of the solve, the number of iterations and the achieved
+ * reduction of the residual are reported. The options --reduction=$VALUE,
+ * --max-iterations=$VALUE and --repetitions=$VALUE control the convergence criterion
+ * and the number of timed repetitions of each combination.
+ */
+#include "config.h"
+
+#include <opm/models/utils/timer.hh>
+#include <opm/simulators/linalg/linearsystemio.hh>
+#include <opm/simulators/linalg/matrixblock.hh>
+#include <opm/simulators/linalg/mixedprecisionpreconditioner.hh>
+#include <opm/simulators/linalg/parallelilu0.hh>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvers.hh>
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Settings
+{
+    double reduction = 1e-5;
+    int maxIterations = 1000;
+    unsigned repetitions = 3;
+};
+
+template <int blockSize>
+struct Types
+{
+    using Matrix = Dune::BCRSMatrix<Opm::MatrixBlock<double, blockSize, blockSize>>;
+    using Vector = Dune::BlockVector<Dune::FieldVector<double, blockSize>>;
+    using Preconditioner = Dune::Preconditioner<Vector, Vector>;
+    using PreconditionerFactory = std::function<std::unique_ptr<Preconditioner>(const Matrix&)>;
+    using Operator = Dune::MatrixAdapter<Matrix, Vector, Vector>;
+    using Solver = Dune::InverseOperator<Vector, Vector>;
+    using SolverFactory = std::function<std::unique_ptr<Solver>(Operator&, Preconditioner&,
+                                                                const Settings&)>;
+};
+
+template <class Matrix, class DomainVector, class RangeVector>
+using SeqILU0 = Dune::SeqILU<Matrix, DomainVector, RangeVector>;
+
+template <int blockSize>
+std::vector<std::pair<std::string, typename Types<blockSize>::PreconditionerFactory>>
+preconditioners_()
+{
+    using Matrix = typename Types<blockSize>::Matrix;
+    using Vector = typename Types<blockSize>::Vector;
+    using Preconditioner = typename Types<blockSize>::Preconditioner;
+    using Result = std::unique_ptr<Preconditioner>;
+
+    return {
+        {"Jacobi", [](const Matrix& m) -> Result
+         { return std::make_unique<Dune::SeqJac<Matrix, Vector, Vector>>(m, 1, 1.0); }},
+        {"GaussSeidel", [](const Matrix& m) -> Result
+         { return std::make_unique<Dune::SeqGS<Matrix, Vector, Vector>>(m, 1, 1.0); }},
+        {"SSOR", [](const Matrix& m) -> Result
+         { return std::make_unique<Dune::SeqSSOR<Matrix, Vector, Vector>>(m, 1, 1.0); }},
+        {"ILU0", [](const Matrix& m) -> Result
+         { return std::make_unique<Dune::SeqILU<Matrix, Vector, Vector>>(m, 0, 1.0); }},
+        {"ILU1", [](const Matrix& m) -> Result
+         { return std::make_unique<Dune::SeqILU<Matrix, Vector, Vector>>(m, 1, 1.0); }},
+        {"ParallelILU0", [](const Matrix& m) -> Result
+         { return std::make_unique<Opm::Linear::ParallelILU0<Matrix, Vector, Vector>>(m, 1.0); }},
+        {"MixedPrecisionILU0", [](const Matrix& m) -> Result
+         {
+             using Prec = Opm::Linear::MixedPrecisionPreconditioner<Matrix, Vector, float, SeqILU0>;
+             return std::make_unique<Prec>(m, 0, 1.0f);
+         }},
+    };
+}
+
+template <int blockSize>
+std::vector<std::pair<std::string, typename Types<blockSize>::SolverFactory>>
+solvers_()
+{
+    using Vector = typename Types<blockSize>::Vector;
+    using Operator = typename Types<blockSize>::Operator;
+    using Preconditioner = typename Types<blockSize>::Preconditioner;
+    using Result = std::unique_ptr<typename Types<blockSize>::Solver>;
+
+    return {
+        {"BiCGStab", [](Operator& op, Preconditioner& prec, const Settings& settings) -> Result
+         {
+             return std::make_unique<Dune::BiCGSTABSolver<Vector>>(op, prec, settings.reduction,
+                                                                   settings.maxIterations,
+                                                                   /*verbose=*/0);
+         }},
+        {"GMRes(30)", [](Operator& op, Preconditioner& prec, const Settings& settings) -> Result
+         {
+             return std::make_unique<Dune::RestartedGMResSolver<Vector>>(op, prec, settings.reduction,
+                                                                         /*restart=*/30,
+                                                                         settings.maxIterations,
+                                                                         /*verbose=*/0);
+         }},
+    };
+}
+
+template <int blockSize>
+void benchmarkFile_(const std::string& fileName, const Settings& settings)
+{
+    using Matrix = typename Types<blockSize>::Matrix;
+    using Vector = typename Types<blockSize>::Vector;
+    using Operator = typename Types<blockSize>::Operator;
+
+    Matrix matrix;
+    Vector rhs;
+    Vector refSolution;
+    const bool hasSolution = Opm::Linear::readLinearSystem(fileName, matrix, rhs, refSolution);
+
+    std::cout << "\n" << fileName << ": " << matrix.N() << " rows, " << matrix.nonzeroes()
+              << " non-zero blocks of size " << blockSize << "x" << blockSize << "\n"
+              << std::left << std::setw(20) << "solver"
+              << std::setw(20) << "preconditioner"
+              << std::right << std::setw(14) << "setup [s]"
+              << std::setw(14) << "solve [s]"
+              << std::setw(8) << "iters"
+              << std::setw(14) << "reduction";
+    if (hasSolution)
+        std::cout << std::setw(14) << "max diff";
+    std::cout << "\n";
+
+    Operator op(matrix);
+    for (const auto& [precName, createPrec] : preconditioners_<blockSize>()) {
+        for (const auto& [solverName, createSolver] : solvers_<blockSize>()) {
+            std::cout << std::left << std::setw(20) << solverName
+                      << std::setw(20) << precName << std::right << std::flush;
+
+            double minSetupTime = std::numeric_limits<double>::max();
+            double minSolveTime = std::numeric_limits<double>::max();
+            Dune::InverseOperatorResult result;
+            Vector x(rhs.size());
+            try {
+                for (unsigned repIdx = 0; repIdx < settings.repetitions; ++repIdx) {
+                    Opm::Timer setupTimer;
+                    setupTimer.start();
+                    auto prec = createPrec(matrix);
+                    setupTimer.stop();
+
+                    auto solver = createSolver(op, *prec, settings);
+                    Vector b(rhs);
+                    x = 0.0;
+                    Opm::Timer solveTimer;
+                    solveTimer.start();
+                    solver->apply(x, b, result);
+                    solveTimer.stop();
+
+                    minSetupTime = std::min(minSetupTime, setupTimer.realTimeElapsed());
+                    minSolveTime = std::min(minSolveTime, solveTimer.realTimeElapsed());
+                }
+            }
+            catch (const Dune::Exception& e) {
+                std::cout << "  failed: " << e.what() << "\n";
+                continue;
+            }
+
+            std::cout << std::setw(14) << minSetupTime
+                      << std::setw(14) << minSolveTime
+                      << std::setw(8) << result.iterations
+                      << std::setw(14) << result.reduction;
+            if (hasSolution) {
+                Vector diff(x);
+                diff -= refSolution;
+                std::cout << std::setw(14) << diff.infinity_norm();
+            }
+            if (!result.converged)
+                std::cout << "  (not converged)";
+            std::cout << "\n";
+        }
+    }
+}
+
+void benchmarkFile(const std::string& fileName, const Settings& settings)
+{
+    const unsigned blockSize = Opm::Linear::linearSystemBlockSize(fileName);
+    switch (blockSize) {
+    case 1: benchmarkFile_<1>(fileName, settings); break;
+    case 2: benchmarkFile_<2>(fileName, settings); break;
+    case 3: benchmarkFile_<3>(fileName, settings); break;
+    case 4: benchmarkFile_<4>(fileName, settings); break;
+    case 5: benchmarkFile_<5>(fileName, settings); break;
+    case 6: benchmarkFile_<6>(fileName, settings); break;
+    default:
+        std::cerr << fileName << ": blocks of size " << blockSize << " are not supported\n";
+    }
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    Settings settings;
+    std::vector<std::string> fileNames;
+    for (int argIdx = 1; argIdx < argc; ++argIdx) {
+        const std::string arg(argv[argIdx]);
+        const auto value = [&arg]() { return arg.substr(arg.find('=') + 1); };
+        if (arg.rfind("--reduction=", 0) == 0)
+            settings.reduction = std::stod(value());
+        else if (arg.rfind("--max-iterations=", 0) == 0)
+            settings.maxIterations = std::stoi(value());
+        else if (arg.rfind("--repetitions=", 0) == 0)
+            settings.repetitions = static_cast<unsigned>(std::max(1, std::stoi(value())));
+        else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Unknown option '" << arg << "'\n"
+                      << "Usage: " << argv[0] << " [--reduction=VALUE] [--max-iterations=VALUE]"
+                      << " [--repetitions=VALUE] FILE...\n";
+            return 1;
+        }
+        else
+            fileNames.push_back(arg);
+    }
+
+    if (fileNames.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--reduction=VALUE] [--max-iterations=VALUE]"
+                  << " [--repetitions=VALUE] FILE...\n";
+        return 1;
+    }
+
+    for (const auto& fileName : fileNames) {
+        try {
+            benchmarkFile(fileName, settings);
+        }
+        catch (const std::exception& e) {
+            std::cerr << fileName << ": " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
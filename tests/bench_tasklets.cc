@@ -0,0 +1,264 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Benchmark for the overhead and the scalability of the tasklet runner.
+ *
+ * For each number of worker threads from one up to the value of --max-workers, the
+ * benchmark measures
+ *
+ * - the latency of dispatching a single tasklet and waiting for it,
+ * - the cost of a barrier if no work is pending,
+ * - the throughput of tiny tasklets which are dispatched by the main thread,
+ * - the throughput of tiny tasklets which are dispatched by the worker threads
+ *   themselves, i.e., which need to be stolen by the other workers, and
+ * - the parallel efficiency for tasklets with a fixed amount of work, whose size is
+ *   specified in microseconds via --large-tasklet-us.
+ *
+ * The number of tasklets per measurement is specified via --tasklets and the number of
+ * timed repetitions via --repetitions. The best time of the repetitions is reported.
+ * Every measurement also checks that all invocations have been run exactly once.
+ */
+#include "config.h"
+
+#include <opm/models/parallel/tasklets.hh>
+#include <opm/models/utils/timer.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+struct Settings
+{
+    unsigned maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+    unsigned numTasklets = 100000;
+    unsigned repetitions = 5;
+    unsigned largeTaskletUs = 200;
+};
+
+// counts the invocations of all tasklets of a measurement
+std::atomic<unsigned> numInvocations{0};
+
+// a tasklet which does nothing but count its invocation
+class EmptyTasklet : public Opm::TaskletInterface
+{
+public:
+    explicit EmptyTasklet(int numInvocations = 1)
+        : Opm::TaskletInterface(numInvocations)
+    {}
+
+    void run() override
+    { numInvocations.fetch_add(1, std::memory_order_relaxed); }
+};
+
+// a tasklet which keeps its worker thread busy for a given duration
+class BusyTasklet : public Opm::TaskletInterface
+{
+public:
+    BusyTasklet(int numInvocations, unsigned durationUs)
+        : Opm::TaskletInterface(numInvocations)
+        , duration_(durationUs)
+    {}
+
+    void run() override
+    {
+        const auto end = std::chrono::steady_clock::now() + duration_;
+        while (std::chrono::steady_clock::now() < end)
+            ;
+        numInvocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    std::chrono::microseconds duration_;
+};
+
+// a tasklet which is run once by a worker thread and dispatches a number of empty
+// tasklets from there
+class SpawnTasklet : public Opm::TaskletInterface
+{
+public:
+    SpawnTasklet(Opm::TaskletRunner& runner, unsigned numChildren)
+        : runner_(runner)
+        , numChildren_(numChildren)
+    {}
+
+    void run() override
+    {
+        for (unsigned i = 0; i < numChildren_; ++i)
+            runner_.dispatch(std::make_shared<EmptyTasklet>());
+    }
+
+private:
+    Opm::TaskletRunner& runner_;
+    unsigned numChildren_;
+};
+
+// returns the minimum run time of a measurement in seconds and verifies the number of
+// invocations
+double timeBest_(const Settings& settings,
+                 unsigned expectedInvocations,
+                 const std::function<void()>& measurement)
+{
+    double bestTime = std::numeric_limits<double>::max();
+    for (unsigned repIdx = 0; repIdx < settings.repetitions; ++repIdx) {
+        numInvocations = 0;
+        Opm::Timer timer;
+        timer.start();
+        measurement();
+        timer.stop();
+        bestTime = std::min(bestTime, timer.realTimeElapsed());
+
+        if (numInvocations != expectedInvocations)
+            throw std::logic_error("Expected " + std::to_string(expectedInvocations)
+                                   + " tasklet invocations, but "
+                                   + std::to_string(numInvocations.load()) + " were run");
+    }
+    return bestTime;
+}
+
+void benchmarkWorkers(unsigned numWorkers, const Settings& settings)
+{
+    Opm::TaskletRunner runner(numWorkers);
+    const unsigned n = settings.numTasklets;
+
+    // dispatch a single tasklet and wait until it is completed
+    const unsigned numRoundTrips = std::max(1u, n / 100);
+    const double latency = timeBest_(settings, numRoundTrips, [&]() {
+        for (unsigned i = 0; i < numRoundTrips; ++i) {
+            auto tasklet = std::make_shared<EmptyTasklet>();
+            runner.dispatch(tasklet);
+            runner.wait(*tasklet);
+        }
+    }) / numRoundTrips;
+
+    // barriers without any pending work
+    const double barrierCost = timeBest_(settings, 0, [&]() {
+        for (unsigned i = 0; i < n; ++i)
+            runner.barrier();
+    }) / n;
+
+    // tiny tasklets dispatched by the main thread
+    const double mainTime = timeBest_(settings, n, [&]() {
+        for (unsigned i = 0; i < n; ++i)
+            runner.dispatch(std::make_shared<EmptyTasklet>());
+        runner.barrier();
+    });
+
+    // a single tasklet with many invocations
+    const double invocationTime = timeBest_(settings, n, [&]() {
+        runner.dispatch(std::make_shared<EmptyTasklet>(static_cast<int>(n)));
+        runner.barrier();
+    });
+
+    // tiny tasklets dispatched by a single worker, i.e., all other workers need to
+    // steal them
+    const double stealTime = timeBest_(settings, n, [&]() {
+        runner.dispatch(std::make_shared<SpawnTasklet>(runner, n));
+        runner.barrier();
+    });
+
+    // tasklets with a fixed amount of work. the ideal time assumes that the work is
+    // distributed evenly over the workers
+    const unsigned numLarge = 8*numWorkers;
+    const double largeTime = timeBest_(settings, numLarge, [&]() {
+        runner.dispatch(std::make_shared<BusyTasklet>(static_cast<int>(numLarge),
+                                                      settings.largeTaskletUs));
+        runner.barrier();
+    });
+    const double idealLargeTime = 8*settings.largeTaskletUs*1e-6;
+
+    std::cout << std::setw(8) << numWorkers
+              << std::setw(14) << latency*1e6
+              << std::setw(14) << barrierCost*1e6
+              << std::setw(14) << n/mainTime
+              << std::setw(14) << n/invocationTime
+              << std::setw(14) << n/stealTime
+              << std::setw(14) << 100*idealLargeTime/largeTime
+              << "\n" << std::flush;
+}
+
+void usage_(const char* progName)
+{
+    std::cerr << "Usage: " << progName << " [--max-workers=VALUE] [--tasklets=VALUE]"
+              << " [--repetitions=VALUE] [--large-tasklet-us=VALUE]\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    Settings settings;
+    for (int argIdx = 1; argIdx < argc; ++argIdx) {
+        const std::string arg(argv[argIdx]);
+        const auto value = [&arg]() {
+            return static_cast<unsigned>(std::max(1, std::stoi(arg.substr(arg.find('=') + 1))));
+        };
+        if (arg.rfind("--max-workers=", 0) == 0)
+            settings.maxWorkers = value();
+        else if (arg.rfind("--tasklets=", 0) == 0)
+            settings.numTasklets = value();
+        else if (arg.rfind("--repetitions=", 0) == 0)
+            settings.repetitions = value();
+        else if (arg.rfind("--large-tasklet-us=", 0) == 0)
+            settings.largeTaskletUs = value();
+        else {
+            std::cerr << "Unknown option '" << arg << "'\n";
+            usage_(argv[0]);
+            return 1;
+        }
+    }
+
+    std::cout << std::setw(8) << "workers"
+              << std::setw(14) << "latency [us]"
+              << std::setw(14) << "barrier [us]"
+              << std::setw(14) << "main [1/s]"
+              << std::setw(14) << "invoc. [1/s]"
+              << std::setw(14) << "steal [1/s]"
+              << std::setw(14) << "large [%]"
+              << "\n";
+
+    try {
+        for (unsigned numWorkers = 1; numWorkers <= settings.maxWorkers; numWorkers *= 2)
+            benchmarkWorkers(numWorkers, settings);
+        if (settings.maxWorkers & (settings.maxWorkers - 1))
+            benchmarkWorkers(settings.maxWorkers, settings);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -30,15 +30,18 @@
  * The only difference is that it uses multiple compile units in order to ensure that
  * eWoms code can be used within libraries that use the same type tag within multiple
  * compile units. This file represents the first compile unit and just defines an startup
- * function for the simulator.
+ * function for the simulator. The simulator itself is explicitly instantiated by the
+ * second compile unit.
  */
 #include "config.h"
 
 #include "lens_immiscible_ecfv_ad.hh"
 
-#include <opm/models/utils/start.hh>
+#include <opm/models/utils/explicitinstantiation.hh>
 #include <opm/simulators/linalg/parallelbicgstabbackend.hh>
 
+EWOMS_EXTERN_SIMULATOR(Opm::Properties::TTag::LensProblemEcfvAd);
+
 // fake forward declaration to prevent esoteric compiler warning
 int mainCU1(int argc, char **argv);
 
@@ -29,16 +29,18 @@
  *
  * The only difference is that it uses multiple compile units in order to ensure that
  * eWoms code can be used within libraries that use the same type tag within multiple
- * compile units. This file represents the second compile unit and just defines an
- * startup function for the simulator.
+ * compile units. This file represents the second compile unit. It defines an startup
+ * function and explicitly instantiates the simulator.
  */
 #include "config.h"
 
 #include "lens_immiscible_ecfv_ad.hh"
 
-#include <opm/models/utils/start.hh>
+#include <opm/models/utils/explicitinstantiation.hh>
 #include <opm/simulators/linalg/parallelbicgstabbackend.hh>
 
+EWOMS_INSTANTIATE_SIMULATOR(Opm::Properties::TTag::LensProblemEcfvAd);
+
 // fake forward declaration to prevent esoteric compiler warning
 int mainCU2(int argc, char **argv);
 
@@ -29,6 +29,7 @@
 #define EWOMS_RESERVOIR_PROBLEM_HH
 
 #include <opm/models/blackoil/blackoilproperties.hh>
+#include <opm/models/common/regionalmateriallawparams.hh>
 
 #include <opm/material/fluidmatrixinteractions/LinearMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
@@ -395,6 +396,8 @@ public:
         fineMaterialParams_.finalize();
         coarseMaterialParams_.finalize();
 
+        const auto fineRegionIdx = materialParams_.addRegion(fineMaterialParams_);
+        const auto coarseRegionIdx = materialParams_.addRegion(coarseMaterialParams_);
         materialParams_.resize(this->model().numGridDof());
         ElementContext elemCtx(this->simulator());
         auto eIt = this->simulator().gridView().template begin<0>();
@@ -407,9 +410,9 @@ public:
                 const GlobalPosition& pos = elemCtx.pos(dofIdx, /*timeIdx=*/0);
 
                 if (isFineMaterial_(pos))
-                    materialParams_[globalDofIdx] = &fineMaterialParams_;
+                    materialParams_.setRegion(globalDofIdx, fineRegionIdx);
                 else
-                    materialParams_[globalDofIdx] = &coarseMaterialParams_;
+                    materialParams_.setRegion(globalDofIdx, coarseRegionIdx);
             }
         }
 
@@ -510,11 +513,17 @@ public:
                                                unsigned spaceIdx, unsigned timeIdx) const
     {
         unsigned globalIdx = context.globalSpaceIndex(spaceIdx, timeIdx);
-        return *materialParams_[globalIdx];
+        return materialParams_[globalIdx];
     }
 
     const MaterialLawParams& materialLawParams(unsigned globalIdx) const
-    { return *materialParams_[globalIdx]; }
+    { return materialParams_[globalIdx]; }
+
+    /*!
+     * \copydoc MultiPhaseBaseProblem::prefetchMaterialLawParams
+     */
+    void prefetchMaterialLawParams(std::size_t dofBegin, std::size_t dofEnd) const
+    { materialParams_.prefetch(dofBegin, dofEnd); }
 
     /*!
      * \name Problem parameters
@@ -780,7 +789,7 @@ private:
 
     MaterialLawParams fineMaterialParams_;
     MaterialLawParams coarseMaterialParams_;
-    std::vector<const MaterialLawParams*> materialParams_;
+    RegionalMaterialLawParams<MaterialLawParams> materialParams_;
 
     InitialFluidState initialFluidState_;
     InitialFluidState injectorFluidState_;
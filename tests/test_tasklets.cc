@@ -96,6 +96,17 @@ int main()
     runner->dispatchFunction(sleepAndPrintFunction);
     runner->dispatchFunction(sleepAndPrintFunction, /*numInvokations=*/6);
 
+    // a pipeline of tasklets which depend on each other
+    auto first = std::make_shared<SleepTasklet>(200);
+    auto second = std::make_shared<SleepTasklet>(100);
+    auto third = std::make_shared<SleepTasklet>(100);
+    runner->then(runner->then(first, second), third);
+    runner->dispatch(first);
+    runner->wait(*second);
+    assert(first->isFinished());
+    runner->wait(*third);
+    std::cout << "pipeline completed" << std::endl;
+
     delete runner;
 
     return 0;